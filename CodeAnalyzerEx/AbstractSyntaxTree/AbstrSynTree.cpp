@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 //  AbstrSynTree.cpp - Represents an Abstract Syntax Tree          //
-//  ver 1.4                                                        //
+//  ver 1.6                                                        //
 //  Language:      Visual C++ 2015                                 //
 //  Platform:      Dell XPS 8900, Windows 10                       //
 //  Application:   Used to support parsing source code             //
@@ -10,23 +10,162 @@
 
 #include "AbstrSynTree.h"
 #include "../Utilities/Utilities.h"
+#include <deque>
+#include <mutex>
 
 using namespace CodeAnalysis;
 
+//----< names of NodeType enumerators, in declaration order >--------
+
+namespace
+{
+  const std::string typeNames[] = {
+    "anonymous", "namespace", "class", "struct",
+    "interface", "function", "lambda", "control"
+  };
+}
+//----< display name of node type >----------------------------------
+
+const std::string& CodeAnalysis::typeName(NodeType type)
+{
+  return typeNames[type];
+}
+//----< node type with display name, anonymousType if none >---------
+
+NodeType CodeAnalysis::typeFromName(const std::string& name)
+{
+  for (size_t i = 0; i < sizeof(typeNames) / sizeof(typeNames[0]); ++i)
+  {
+    if (typeNames[i] == name)
+      return static_cast<NodeType>(i);
+  }
+  return anonymousType;
+}
+//----< symbol pool shared by all threads >--------------------------
+/*
+*  - names live in a deque, so references returned by lookup stay
+*    valid as the pool grows
+*  - id 0 is the empty string, the value of a default Symbol
+*/
+namespace
+{
+  struct SymbolPool
+  {
+    SymbolPool() : names(1) { ids[""] = 0; }
+    std::mutex lock;
+    std::unordered_map<std::string, Symbol::Id> ids;
+    std::deque<std::string> names;
+  };
+
+  SymbolPool& symbolPool()
+  {
+    static SymbolPool pool;
+    return pool;
+  }
+}
+//----< id of name, adding it to the pool if new >-------------------
+
+Symbol::Id Symbol::intern(const std::string& name)
+{
+  SymbolPool& pool = symbolPool();
+  std::lock_guard<std::mutex> guard(pool.lock);
+  auto iter = pool.ids.find(name);
+  if (iter != pool.ids.end())
+    return iter->second;
+  Id id = static_cast<Id>(pool.names.size());
+  pool.names.push_back(name);
+  pool.ids[name] = id;
+  return id;
+}
+//----< pooled string for id >---------------------------------------
+
+const std::string& Symbol::lookup(Id id)
+{
+  SymbolPool& pool = symbolPool();
+  std::lock_guard<std::mutex> guard(pool.lock);
+  return pool.names[id];
+}
+//----< number of distinct symbols, including the empty one >--------
+
+size_t Symbol::count()
+{
+  SymbolPool& pool = symbolPool();
+  std::lock_guard<std::mutex> guard(pool.lock);
+  return pool.names.size();
+}
+
 //----< default initialization for ASTNodes >------------------------
 
 ASTNode::ASTNode() 
-  : type_("anonymous"), parentType_("namespace"), name_("none"), startLineCount_(0), endLineCount_(0), complexity_(0) {}
+  : type_(anonymousType), parentType_(namespaceType), name_("none"), startLineCount_(0), endLineCount_(0), complexity_(0) {}
 
 //----< initialization accepting type and name >---------------------
 
 ASTNode::ASTNode(const Type& type, const Name& name) 
-  : type_(type), parentType_("namespace"), name_(name), startLineCount_(0), endLineCount_(0), complexity_(0) {}
+  : type_(type), parentType_(namespaceType), name_(name), startLineCount_(0), endLineCount_(0), complexity_(0) {}
 
-//----< destructor deletes children, statements, declarations >------
+//----< create arena, first block is allocated on first use >-------
+
+ASTArena::ASTArena(size_t blockSize) : blockSize_(blockSize) {}
+
+//----< destroy objects, newest first, then release blocks >--------
+
+ASTArena::~ASTArena()
+{
+  for (auto iter = finalizers_.rbegin(); iter != finalizers_.rend(); ++iter)
+    iter->second(iter->first);
+  for (auto pBlock : blocks_)
+    delete[] pBlock;
+}
+//----< bump allocate from current block, start new block if full >---
+
+void* ASTArena::allocate(size_t size, size_t align)
+{
+  size_t pad = (align - (reinterpret_cast<size_t>(pNext_) % align)) % align;
+  if (pNext_ == nullptr || pad + size > remaining_)
+  {
+    size_t blockSize = size + align > blockSize_ ? size + align : blockSize_;
+    pNext_ = new char[blockSize];
+    blocks_.push_back(pNext_);
+    remaining_ = blockSize;
+    pad = (align - (reinterpret_cast<size_t>(pNext_) % align)) % align;
+  }
+  void* pMem = pNext_ + pad;
+  pNext_ += pad + size;
+  remaining_ -= pad + size;
+  size_ += size;
+  return pMem;
+}
+//----< take over other arena's blocks and objects >----------------
+/*
+*  - used to keep nodes built by a parse thread alive after its
+*    AST is destroyed; other is left empty
+*/
+void ASTArena::splice(ASTArena& other)
+{
+  blocks_.insert(blocks_.end(), other.blocks_.begin(), other.blocks_.end());
+  finalizers_.insert(finalizers_.end(), other.finalizers_.begin(), other.finalizers_.end());
+  size_ += other.size_;
+  other.blocks_.clear();
+  other.finalizers_.clear();
+  other.pNext_ = nullptr;
+  other.remaining_ = 0;
+  other.size_ = 0;
+}
+//----< bytes of objects held by arena >----------------------------
 
+size_t ASTArena::size() const
+{
+  return size_;
+}
+//----< destructor deletes children, statements, declarations >------
+/*
+*  - pooled nodes own nothing, their arena destroys everything
+*/
 ASTNode::~ASTNode()
 {
+  if (pooled_)
+    return;
   for (auto pNode : children_)
     delete pNode;
   for (auto pNode : statements_)
@@ -36,6 +175,38 @@ ASTNode::~ASTNode()
     delete node.pTc;
   }
 }
+//----< frees statements and declaration tokens, returns count freed >---
+/*
+*  - the statement count and the text of public data declarations stay,
+*    they are all that displays and metrics use once a file is parsed
+*  - pooled tokens belong to the arena, they are only forgotten here
+*/
+size_t ASTNode::releaseTokens()
+{
+  size_t count = statements_.size();
+  releasedStatements_ += statements_.size();
+  if (!pooled_)
+  {
+    for (auto pTc : statements_)
+      delete pTc;
+  }
+  std::vector<Scanner::ITokCollection*>().swap(statements_);
+  for (auto& decl : decl_)
+  {
+    if (decl.pTc == nullptr)
+      continue;
+    if (decl.access_ == Access::publ && decl.declType_ == DeclType::dataDecl)
+    {
+      for (size_t i = 0; i < decl.pTc->length(); ++i)
+        decl.text_ += (*decl.pTc)[i] + " ";
+    }
+    if (!pooled_)
+      delete decl.pTc;
+    decl.pTc = nullptr;
+    ++count;
+  }
+  return count;
+}
 //----< returns string with ASTNode description >--------------------
 
 std::string ASTNode::show(bool details)
@@ -46,12 +217,12 @@ std::string ASTNode::show(bool details)
   temp << parentType_ << ", ";
   if(name_ != "none")
     temp << name_ << ", ";
-  if(type_ == "namespace" || type_ == "class" || type_ == "interface" || type_ == "struct" || type_ == "function")
+  if(type_ == namespaceType || type_ == classType || type_ == interfaceType || type_ == structType || type_ == functionType)
     temp << package_ << ", ";
   if (details)
   {
     temp << "num children: " << children_.size() << ", ";
-    temp << "num statements: " << statements_.size() << ", ";
+    temp << "num statements: " << statementCount() << ", ";
   }
   temp << "line: " << startLineCount_ << ", ";
   temp << "size: " << endLineCount_ - startLineCount_ + 1 << ", ";
@@ -67,7 +238,7 @@ std::string ASTNode::show(bool details)
 */
 AbstrSynTree::AbstrSynTree(ScopeStack<ASTNode*>& stack) : stack_(stack)
 {
-  pGlobalNamespace_ = new ASTNode("namespace", "Global Namespace");
+  pGlobalNamespace_ = new ASTNode(namespaceType, "Global Namespace");
   pGlobalNamespace_->startLineCount_ = 1;
   pGlobalNamespace_->endLineCount_ = 1;
   stack_.push(pGlobalNamespace_);
@@ -80,7 +251,48 @@ AbstrSynTree::AbstrSynTree(ScopeStack<ASTNode*>& stack) : stack_(stack)
 */
 AbstrSynTree::~AbstrSynTree()
 {
-  delete pGlobalNamespace_;
+  if (pArena_ != nullptr)
+    delete pArena_;
+  else
+    delete pGlobalNamespace_;
+}
+//----< switch to pooled nodes, only while the tree is still empty >--
+/*
+*  - replaces heap allocated global namespace with one from the arena
+*  - nodes must then be created with makeNode(...) and statements
+*    placed in arena(), never with new
+*/
+bool AbstrSynTree::enablePool()
+{
+  if (pArena_ != nullptr)
+    return true;
+  ASTNode* pOld = pGlobalNamespace_;
+  if (stack_.size() != 1 || pOld->children_.size() > 0 || pOld->statements_.size() > 0 || pOld->decl_.size() > 0)
+    return false;
+  pArena_ = new ASTArena;
+  pGlobalNamespace_ = makeNode(pOld->type_, pOld->name_);
+  pGlobalNamespace_->startLineCount_ = pOld->startLineCount_;
+  pGlobalNamespace_->endLineCount_ = pOld->endLineCount_;
+  stack_.pop();
+  stack_.push(pGlobalNamespace_);
+  delete pOld;
+  return true;
+}
+//----< create node in arena when pooled, otherwise on heap >--------
+
+ASTNode* AbstrSynTree::makeNode(const ASTNode::Type& type, const ASTNode::Name& name)
+{
+  if (pArena_ == nullptr)
+    return new ASTNode(type, name);
+  ASTNode* pNode = pArena_->create<ASTNode>(type, name);
+  pNode->pooled_ = true;
+  return pNode;
+}
+//----< arena holding pooled nodes, nullptr if tree is not pooled >--
+
+ASTArena* AbstrSynTree::arena()
+{
+  return pArena_;
 }
 //----< return or accept pointer to global namespace >---------------
 
@@ -104,9 +316,10 @@ AbstrSynTree::TypeMap& AbstrSynTree::typeMap()
 void AbstrSynTree::add(ASTNode* pNode)
 {
   pNode->parentType_ = stack_.top()->type_;
+  pNode->pParent_ = stack_.top();
   stack_.top()->children_.push_back(pNode);  // add as child of stack top
   stack_.push(pNode);                        // push onto stack
-  if (pNode->type_ == "class" || pNode->type_ == "struct" || pNode->type_ == "interface")
+  if (pNode->type_ == classType || pNode->type_ == structType || pNode->type_ == interfaceType)
     typeMap_[pNode->name_] = pNode;
 }
 //----< pop stack's top element >------------------------------------
@@ -150,15 +363,15 @@ int main()
 
   ScopeStack<ASTNode*> stack;
   AbstrSynTree ast(stack);
-  ASTNode* pX = new ASTNode("class", "X");
+  ASTNode* pX = new ASTNode(classType, "X");
   ast.add(pX);                                        // add X scope
-  ASTNode* pf1 = new ASTNode("function", "f1");
+  ASTNode* pf1 = new ASTNode(functionType, "f1");
   ast.add(pf1);                                       // add f1 scope
-  ASTNode* pc1 = new ASTNode("control", "if");
+  ASTNode* pc1 = new ASTNode(controlType, "if");
   ast.add(pc1);                                       // add c1 scope
   ast.pop();                                          // end c1 scope
   ast.pop();                                          // end f1 scope
-  ASTNode* pf2 = new ASTNode("function", "f2");
+  ASTNode* pf2 = new ASTNode(functionType, "f2");
   ast.add(pf2);                                       // add f2 scope
   ast.pop();                                          // end f2 scope
   ast.pop();                                          // end X scope
@@ -179,6 +392,50 @@ int main()
   else
     std::cout << "\n  could not find ASTNode for class X";
 
+  Utils::title("testing complexityClose");
+
+  ScopeStack<ASTNode*> closeStack;
+  AbstrSynTree closeAst(closeStack);
+  ASTNode* pZ = new ASTNode(classType, "Z");
+  closeAst.add(pZ);                                   // add Z scope
+  complexityClose(closeAst.pop());                    // end Z scope
+  ASTNode* pg = new ASTNode(functionType, "g");
+  closeAst.add(pg);                                   // add Z::g scope, after Z has ended
+  closeAst.root()->children_.pop_back();              // relink g to Z
+  pZ->children_.push_back(pg);
+  complexityReparent(pg, pZ);
+  closeAst.add(new ASTNode(controlType, "for"));      // add for scope in g
+  complexityClose(closeAst.pop());                    // end for scope
+  complexityClose(closeAst.pop());                    // end g scope
+  complexityClose(closeAst.root());
+  size_t incremental = pZ->complexity_;
+  complexityEval(closeAst.root());
+  std::cout << "\n  Z's complexity as scopes end: " << incremental << ", from complexityEval: " << pZ->complexity_;
+
+  Utils::title("testing pooled AbstrSynTree");
+
+  ScopeStack<ASTNode*> poolStack;
+  AbstrSynTree pooledAst(poolStack);
+  pooledAst.enablePool();
+  ASTNode* pY = pooledAst.makeNode(classType, "Y");
+  pooledAst.add(pY);                                  // add Y scope
+  for (size_t i = 0; i < 1000; ++i)
+  {
+    pooledAst.add(pooledAst.makeNode(functionType, "f" + Utilities::Converter<size_t>::toString(i)));
+    pooledAst.pop();
+  }
+  pooledAst.pop();                                    // end Y scope
+  std::cout << "\n  " << pY->show(true);
+  std::cout << "\n  arena holds " << pooledAst.arena()->size() << " bytes of nodes";
+
+  Utils::title("testing Symbol interning");
+
+  Symbol s1 = "AbstrSynTree.cpp";
+  Symbol s2 = std::string("AbstrSynTree") + ".cpp";
+  std::cout << "\n  " << s1 << " has id " << s1.id() << ", " << s2 << " has id " << s2.id();
+  std::cout << "\n  equal: " << std::boolalpha << (s1 == s2) << ", symbols in pool: " << Symbol::count();
+  std::cout << "\n  typeFromName(\"struct\") is " << typeFromName("struct");
+
   std::cout << "\n\n";
 }
 
@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////
 //  AbstrSynTree.h - Represents an Abstract Syntax Tree            //
-//  ver 1.4                                                        //
+//  ver 1.9                                                        //
 //  Language:      Visual C++ 2015                                 //
 //  Platform:      Dell XPS 8900, Windows 10                       //
 //  Application:   Used to support parsing source code             //
@@ -22,6 +22,31 @@
   ast.add(pNode);                     // add ASTNode to tree, linked to current scope
   ASTNode* pNode = ast.find(myType);  // retrieve ptr to ASTNode representing myType
   ast.pop();                          // close current scope by poping top of scopeStack
+  ast.enablePool();                   // allocate nodes from an ASTArena, tree must be empty
+  ASTNode* pNode = ast.makeNode(type, name);  // new node, pooled if the tree is pooled
+  ASTArena* pArena = ast.arena();     // arena holding pooled nodes, nullptr if not pooled
+
+  NodeType t = classType;             // kind of scope an ASTNode represents
+  std::string s = typeName(t);        // "class", typeFromName(s) converts back
+  Symbol sym = "Executive.cpp";       // intern string, equal strings share one id
+  sym == other; sym.str(); sym.id();  // compare ids, get pooled string, get id
+
+  ASTWalk(pNode, co);                 // co(pNode, depth) for each node, preorder, explicit stack
+  ASTWalkNoIndent(pNode, co);         // co(pNode) for each node, preorder
+  complexityEval(pNode);              // complexity_ of each node is the size of its subtree
+  complexityClose(pNode);             // complexity_ of a node whose scope just ended, from its children
+  complexityReparent(pNode, pParent); // move a node's complexity to the scopes of its new parent
+  std::vector<ASTNode*> spine;        // namespaces above the subtrees, preorder
+  std::vector<ASTNode*> subtrees = ASTSubtrees(pRoot, &spine);  // independent subtrees, preorder
+  ASTForEachParallel(subtrees, fn, n);  // fn(subtrees[i], i) on n workers, 0 for all cores
+  ASTWalkParallel(subtrees, co, n);   // co(pNode, i) for each node of subtrees[i]
+  complexityEvalParallel(pRoot, n);   // same complexities as complexityEval, on n workers
+  pNode->releaseTokens();             // free node's statements and declaration tokens
+  ASTReleaseTokens(pNode);            // same for every node under pNode, returns count freed
+
+  ASTArena arena;                     // region allocator, objects destroyed with arena
+  T* pT = arena.create<T>(args);      // construct T in arena
+  arena.splice(other);                // take ownership of other arena's objects
 
   Build Process:
   ==============
@@ -32,8 +57,41 @@
   - devenv CodeAnalysis.sln
   - cl /EHsc /DTEST_ABSTRSYNTREE AbstrSynTree.cpp Utilities.cpp /link setargv.obj
 
+  complexityClose is called as each scope ends, when its children have
+  theirs, so a parse leaves every closed node with its complexity and
+  complexityEval is only needed to check them.  A member function whose
+  class has already ended is added to the class and the class's closed
+  ancestors, found with pParent_, when the function ends.  That is also
+  how complexityReparent moves a function relinked to its class after both
+  have ended.  complexity_ is 0 until a node's scope ends.
+
   Maintenance History:
   ====================
+  ver 1.9 : 14 Oct 2026
+  - added ASTNode::pParent_, complexityClose and complexityReparent, which
+    keep complexities up to date as scopes end and functions are relinked
+  ver 1.8 : 14 Oct 2026
+  - added ASTNode::releaseTokens and ASTReleaseTokens: once a file is
+    parsed its cloned statements and declaration tokens can be freed,
+    the node keeps its statement count and the text of public data
+    declarations, so a large repository's AST stays small
+  ver 1.7 : 14 Oct 2026
+  - ASTWalk, ASTWalkNoIndent and complexityWalk use an explicit stack
+    instead of recursion, so deeply nested code can't overflow the
+    call stack, and ASTWalk keeps its depth per call instead of in a
+    function static, so walks on different threads don't interfere
+  - added ASTSubtrees, ASTForEachParallel, ASTWalkParallel and
+    complexityEvalParallel, which spread the classes, functions and
+    other subtrees below the namespaces over a pool of workers
+  ver 1.6 : 14 Oct 2026
+  - ASTNode::type_ and parentType_ are NodeType enumerators instead of
+    strings, so tree walks compare integers
+  - package and path names are interned as Symbols in a global pool, so
+    nodes share one copy of each name and compare them by id
+  ver 1.5 : 14 Oct 2026
+  - added ASTArena and pooled mode: ASTNodes and cloned statements are
+    placed in large blocks and destroyed together with the tree instead
+    of by a recursive delete of every node
   ver 1.4 : 26 Feb 2017
   - added parentType_ member to support better grammar analysis
   ver 1.3 : 29 Oct 2016
@@ -54,6 +112,12 @@
 #include <sstream>
 #include <unordered_map>
 #include <functional>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <thread>
+#include <atomic>
+#include <ostream>
 #include "../SemiExp/itokcollection.h"
 #include "../ScopeStack/ScopeStack.h"
 
@@ -69,21 +133,105 @@ namespace CodeAnalysis
     dataDecl, functionDecl, lambdaDecl, usingDecl 
   };
 
+  enum NodeType
+  {
+    anonymousType, namespaceType, classType, structType,
+    interfaceType, functionType, lambdaType, controlType
+  };
+
+  const std::string& typeName(NodeType type);
+  NodeType typeFromName(const std::string& name);
+
+  inline std::ostream& operator<<(std::ostream& out, NodeType type)
+  {
+    return out << typeName(type);
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // Symbol - string interned in a global, thread safe pool
+  // - equal strings get the same small integer id, so symbols are
+  //   compared by id and each name is stored once
+
+  class Symbol
+  {
+  public:
+    using Id = unsigned;
+    Symbol() : id_(0) {}
+    Symbol(const std::string& name) : id_(intern(name)) {}
+    Symbol(const char* name) : id_(intern(name)) {}
+    const std::string& str() const { return lookup(id_); }
+    operator const std::string&() const { return str(); }
+    Id id() const { return id_; }
+    static Id intern(const std::string& name);
+    static const std::string& lookup(Id id);
+    static size_t count();
+  private:
+    Id id_;
+  };
+
+  inline bool operator==(const Symbol& s1, const Symbol& s2) { return s1.id() == s2.id(); }
+  inline bool operator!=(const Symbol& s1, const Symbol& s2) { return s1.id() != s2.id(); }
+
+  inline std::ostream& operator<<(std::ostream& out, const Symbol& sym)
+  {
+    return out << sym.str();
+  }
+
+  ///////////////////////////////////////////////////////////////////
+  // ASTArena - region allocator for ASTNodes and cloned statements
+  // - objects are constructed in large blocks and destroyed, in
+  //   reverse order of creation, when the arena is destroyed
+
+  class ASTArena
+  {
+  public:
+    ASTArena(size_t blockSize = 64 * 1024);
+    ~ASTArena();
+    ASTArena(const ASTArena&) = delete;
+    ASTArena& operator=(const ASTArena&) = delete;
+    template <typename T, typename... Args>
+    T* create(Args&&... args);
+    void splice(ASTArena& other);
+    size_t size() const;
+  private:
+    using Finalizer = std::pair<void*, void(*)(void*)>;
+    template <typename T>
+    static void destroy(void* pObj) { static_cast<T*>(pObj)->~T(); }
+    void* allocate(size_t size, size_t align);
+    std::vector<char*> blocks_;
+    std::vector<Finalizer> finalizers_;
+    char* pNext_ = nullptr;
+    size_t remaining_ = 0;
+    size_t blockSize_;
+    size_t size_ = 0;
+  };
+  //----< construct T in arena, it lives until the arena is destroyed >--
+
+  template <typename T, typename... Args>
+  T* ASTArena::create(Args&&... args)
+  {
+    T* pT = new (allocate(sizeof(T), alignof(T))) T(std::forward<Args>(args)...);
+    if (!std::is_trivially_destructible<T>::value)
+      finalizers_.push_back(Finalizer(pT, &destroy<T>));
+    return pT;
+  }
+
   struct DeclarationNode
   {
     Scanner::ITokCollection* pTc = nullptr;
+    std::string text_;     // public data declaration's tokens, kept when pTc is released
     Access access_;
     DeclType declType_;
-    std::string package_;
+    Symbol package_;
     size_t line_;
   };
 
   struct ASTNode
   {
-    using Type = std::string;
+    using Type = NodeType;
     using Name = std::string;
-    using Package = std::string;
-    using Path = std::string;
+    using Package = Symbol;
+    using Path = Symbol;
 
     ASTNode();
     ASTNode(const Type& type, const Name& name);
@@ -96,9 +244,14 @@ namespace CodeAnalysis
     size_t startLineCount_;
     size_t endLineCount_;
     size_t complexity_;
+    ASTNode* pParent_ = nullptr;  // scope this node is a child of, nullptr for the root
+    bool pooled_ = false;  // owned by an ASTArena, children not deleted by node
     std::vector<ASTNode*> children_;
     std::vector<DeclarationNode> decl_;
     std::vector<Scanner::ITokCollection*> statements_;
+    size_t releasedStatements_ = 0;
+    size_t statementCount() const { return statements_.size() + releasedStatements_; }
+    size_t releaseTokens();
     std::string show(bool details = false);
   };
 
@@ -115,52 +268,79 @@ namespace CodeAnalysis
     ASTNode* find(const ClassName& type);
     ASTNode* pop();
     TypeMap& typeMap();
+    bool enablePool();
+    ASTNode* makeNode(const ASTNode::Type& type = anonymousType, const ASTNode::Name& name = "none");
+    ASTArena* arena();
   private:
     TypeMap typeMap_;
     ScopeStack<ASTNode*>& stack_;
     ASTNode* pGlobalNamespace_;
+    ASTArena* pArena_ = nullptr;
   };
   //----< traverse AST and execute callobj on every node >-------------
-
+  /*
+  *  co(pNode, depth), depth is 0 for pItem, nodes are visited in the
+  *  same order as a recursive preorder walk
+  */
   template <typename CallObj>
   void ASTWalk(ASTNode* pItem, CallObj co)
   {
-    static size_t indentLevel = 0;
-    co(pItem, indentLevel);
-    auto iter = pItem->children_.begin();
-    ++indentLevel;
-    while (iter != pItem->children_.end())
+    std::vector<std::pair<ASTNode*, size_t>> stack(1, std::make_pair(pItem, (size_t)0));
+    while (!stack.empty())
     {
-      ASTWalk(*iter, co);
-      ++iter;
+      ASTNode* pNode = stack.back().first;
+      size_t indentLevel = stack.back().second;
+      stack.pop_back();
+      co(pNode, indentLevel);
+      for (auto iter = pNode->children_.rbegin(); iter != pNode->children_.rend(); ++iter)
+        stack.push_back(std::make_pair(*iter, indentLevel + 1));
     }
-    --indentLevel;
   }
   //----< traverse AST and execute callobj on every node >-------------
 
   template <typename CallObj>
   void ASTWalkNoIndent(ASTNode* pItem, CallObj co)
   {
-    co(pItem);
-    auto iter = pItem->children_.begin();
-    while (iter != pItem->children_.end())
+    std::vector<ASTNode*> stack(1, pItem);
+    while (!stack.empty())
     {
-      ASTWalkNoIndent(*iter, co);
-      ++iter;
+      ASTNode* pNode = stack.back();
+      stack.pop_back();
+      co(pNode);
+      for (auto iter = pNode->children_.rbegin(); iter != pNode->children_.rend(); ++iter)
+        stack.push_back(*iter);
     }
   }
-  //----< compute complexities for each ASTNode >--------------------
+  //----< release tokens of every node under pItem >-----------------
 
+  inline size_t ASTReleaseTokens(ASTNode* pItem)
+  {
+    size_t count = 0;
+    ASTWalkNoIndent(pItem, [&count](ASTNode* pNode) { count += pNode->releaseTokens(); });
+    return count;
+  }
+  //----< compute complexities for each ASTNode >--------------------
+  /*
+  *  count is advanced once per node, each node's complexity_ is the
+  *  number of nodes in its subtree, itself included
+  */
   inline void complexityWalk(ASTNode* pItem, size_t& count)
   {
-    size_t inCount = ++count;
-    auto iter = pItem->children_.begin();
-    while (iter != pItem->children_.end())
+    struct Frame { ASTNode* pNode; size_t next; size_t inCount; };
+    std::vector<Frame> stack;
+    stack.push_back(Frame{ pItem, 0, ++count });
+    while (!stack.empty())
     {
-      complexityWalk(*iter, count);
-      ++iter;
+      Frame& top = stack.back();
+      if (top.next < top.pNode->children_.size())
+      {
+        ASTNode* pChild = top.pNode->children_[top.next++];
+        stack.push_back(Frame{ pChild, 0, ++count });
+        continue;
+      }
+      top.pNode->complexity_ = count - top.inCount + 1;
+      stack.pop_back();
     }
-    pItem->complexity_ = count - inCount + 1;
   }
   //----< compute complexities for each ASTNode >--------------------
 
@@ -169,6 +349,124 @@ namespace CodeAnalysis
     size_t initialCount = 0;
     complexityWalk(pNode, initialCount);
   }
+  //----< add or take delta from the ended scopes pNode is in >--------
+  /*
+  *  stops at the first scope still open, it sums its children when it ends
+  */
+  inline void complexityShift(ASTNode* pNode, size_t delta, bool add)
+  {
+    for (; pNode != nullptr && pNode->complexity_ != 0; pNode = pNode->pParent_)
+    {
+      if (add)
+        pNode->complexity_ += delta;
+      else
+        pNode->complexity_ -= delta;
+    }
+  }
+  //----< complexity of a node whose scope just ended >----------------
+  /*
+  *  - its children have ended, so have their complexities
+  *  - a parent that has already ended, the class of a member function
+  *    defined after it, gets the node's complexity added now
+  */
+  inline void complexityClose(ASTNode* pNode)
+  {
+    pNode->complexity_ = 1;
+    for (auto pChild : pNode->children_)
+      pNode->complexity_ += pChild->complexity_;
+    complexityShift(pNode->pParent_, pNode->complexity_, true);
+  }
+  //----< pNode is now a child of pParent, caller moves it in children_ >--
+
+  inline void complexityReparent(ASTNode* pNode, ASTNode* pParent)
+  {
+    complexityShift(pNode->pParent_, pNode->complexity_, false);
+    pNode->pParent_ = pParent;
+    complexityShift(pParent, pNode->complexity_, true);
+  }
+  //----< subtrees below pRoot's namespaces, which share no nodes >----
+  /*
+  *  pRoot and the namespaces nested in it, through namespaces only,
+  *  are the spine, every other child of a spine node roots a subtree.
+  *  Both are in preorder, so results kept per subtree and merged in
+  *  order come out as a serial walk would make them.
+  */
+  inline std::vector<ASTNode*> ASTSubtrees(ASTNode* pRoot, std::vector<ASTNode*>* pSpine = nullptr)
+  {
+    std::vector<ASTNode*> subtrees;
+    std::vector<ASTNode*> stack(1, pRoot);
+    while (!stack.empty())
+    {
+      ASTNode* pNode = stack.back();
+      stack.pop_back();
+      if (pNode != pRoot && pNode->type_ != namespaceType)
+      {
+        subtrees.push_back(pNode);
+        continue;
+      }
+      if (pSpine != nullptr)
+        pSpine->push_back(pNode);
+      for (auto iter = pNode->children_.rbegin(); iter != pNode->children_.rend(); ++iter)
+        stack.push_back(*iter);
+    }
+    return subtrees;
+  }
+  //----< call fn(subtrees[i], i) for each subtree on numThreads workers >---
+  /*
+  *  numThreads 0 uses every core.  Workers take the next subtree when
+  *  they finish one, so a few large classes don't leave others idle.
+  *  fn runs on several threads at once, so it should only change
+  *  state belonging to its subtree or to index i.
+  */
+  template <typename Fn>
+  void ASTForEachParallel(const std::vector<ASTNode*>& subtrees, Fn fn, size_t numThreads = 0)
+  {
+    if (numThreads == 0)
+      numThreads = std::thread::hardware_concurrency();
+    if (numThreads > subtrees.size())
+      numThreads = subtrees.size();
+    if (numThreads <= 1)
+    {
+      for (size_t i = 0; i < subtrees.size(); ++i)
+        fn(subtrees[i], i);
+      return;
+    }
+    std::atomic<size_t> next(0);
+    auto work = [&]() {
+      for (size_t i = next++; i < subtrees.size(); i = next++)
+        fn(subtrees[i], i);
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < numThreads; ++i)
+      workers.push_back(std::thread(work));
+    work();
+    for (auto& worker : workers)
+      worker.join();
+  }
+  //----< call co(pNode, i) for every node of each subtrees[i], in parallel >---
+
+  template <typename CallObj>
+  void ASTWalkParallel(const std::vector<ASTNode*>& subtrees, CallObj co, size_t numThreads = 0)
+  {
+    ASTForEachParallel(subtrees, [&](ASTNode* pSubtree, size_t i) {
+      ASTWalkNoIndent(pSubtree, [&](ASTNode* pNode) { co(pNode, i); });
+    }, numThreads);
+  }
+  //----< complexityEval with subtrees evaluated on numThreads workers >---
+
+  inline void complexityEvalParallel(ASTNode* pRoot, size_t numThreads = 0)
+  {
+    std::vector<ASTNode*> spine;
+    std::vector<ASTNode*> subtrees = ASTSubtrees(pRoot, &spine);
+    ASTForEachParallel(subtrees, [](ASTNode* pSubtree, size_t) { complexityEval(pSubtree); }, numThreads);
+    for (auto iter = spine.rbegin(); iter != spine.rend(); ++iter)
+    {
+      ASTNode* pNode = *iter;
+      pNode->complexity_ = 1;
+      for (auto pChild : pNode->children_)
+        pNode->complexity_ += pChild->complexity_;
+    }
+  }
 }
 
 struct foobar {
@@ -0,0 +1,490 @@
+///////////////////////////////////////////////////////////////////
+// ASTCache.cpp: Keeps each file's AST fragment between runs     //
+// ver 1.2                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "ASTCache.h"
+#include "Executive.h"
+#include "../AbstractSyntaxTree/AbstrSynTree.h"
+#include "../FileSystem/FileSystem.h"
+#include <fstream>
+
+using namespace CodeAnalysis;
+
+namespace
+{
+  const char Magic[] = "ASTC2";
+  const unsigned NoNode = ~0u;
+  const size_t MinNodeBytes = 44;   // node record with empty strings, no declarations
+
+  ///////////////////////////////////////////////////////////////////
+  // Writer appends numbers and strings to a byte string
+
+  class Writer
+  {
+  public:
+    Writer(std::string& bytes) : bytes_(bytes) {}
+    void number(size_t value)
+    {
+      for (size_t i = 0; i < 4; ++i)
+        bytes_ += static_cast<char>((value >> (8 * i)) & 0xff);
+    }
+    void text(const std::string& str)
+    {
+      number(str.size());
+      bytes_ += str;
+    }
+  private:
+    std::string& bytes_;
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  // Reader takes numbers and strings from a byte string
+  // - once a read runs past the end, ok() is false and reads return 0
+
+  class Reader
+  {
+  public:
+    Reader(const std::string& bytes) : bytes_(bytes) {}
+    size_t number()
+    {
+      if (!ok_ || bytes_.size() - pos_ < 4)
+        return fail();
+      size_t value = 0;
+      for (size_t i = 0; i < 4; ++i)
+        value |= static_cast<size_t>(static_cast<unsigned char>(bytes_[pos_ + i])) << (8 * i);
+      pos_ += 4;
+      return value;
+    }
+    std::string text()
+    {
+      size_t size = number();
+      if (!ok_ || bytes_.size() - pos_ < size)
+      {
+        fail();
+        return std::string();
+      }
+      std::string str = bytes_.substr(pos_, size);
+      pos_ += size;
+      return str;
+    }
+    //----< count of records, each at least minSize bytes, that fit >--
+    size_t count(size_t minSize)
+    {
+      size_t value = number();
+      if (ok_ && value > (bytes_.size() - pos_) / minSize)
+        return fail();
+      return value;
+    }
+    bool ok() const { return ok_; }
+    bool atEnd() const { return pos_ == bytes_.size(); }
+  private:
+    size_t fail() { ok_ = false; return 0; }
+    const std::string& bytes_;
+    size_t pos_ = 0;
+    bool ok_ = true;
+  };
+  //----< text kept for a declaration, as ASTNode::releaseTokens keeps it >--
+
+  std::string declText(const DeclarationNode& decl)
+  {
+    if (decl.pTc == nullptr)
+      return decl.text_;
+    std::string text;
+    if (decl.access_ == Access::publ && decl.declType_ == DeclType::dataDecl)
+    {
+      for (size_t i = 0; i < decl.pTc->length(); ++i)
+        text += (*decl.pTc)[i] + " ";
+    }
+    return text;
+  }
+
+  void writeDecls(Writer& out, const std::vector<DeclarationNode>& decls)
+  {
+    out.number(decls.size());
+    for (auto& decl : decls)
+    {
+      out.number(decl.access_);
+      out.number(decl.declType_);
+      out.text(decl.package_);
+      out.number(decl.line_);
+      out.text(declText(decl));
+    }
+  }
+
+  bool readDecls(Reader& in, std::vector<DeclarationNode>& decls)
+  {
+    size_t count = in.count(16);
+    for (size_t i = 0; i < count && in.ok(); ++i)
+    {
+      DeclarationNode decl;
+      size_t access = in.number(), declType = in.number();
+      decl.package_ = in.text();
+      decl.line_ = in.number();
+      decl.text_ = in.text();
+      if (access > Access::priv || declType > DeclType::usingDecl)
+        return false;
+      decl.access_ = static_cast<Access>(access);
+      decl.declType_ = static_cast<DeclType>(declType);
+      decls.push_back(decl);
+    }
+    return in.ok();
+  }
+  //----< write roots' subtrees in preorder, numbering nodes as written >--
+
+  void writeNodes(Writer& out, const std::vector<ASTNode*>& roots, std::unordered_map<const ASTNode*, size_t>& index)
+  {
+    out.number(roots.size());
+    for (auto pRoot : roots)
+    {
+      std::vector<ASTNode*> stack(1, pRoot);
+      while (!stack.empty())
+      {
+        ASTNode* pNode = stack.back();
+        stack.pop_back();
+        size_t number = index.size();
+        index[pNode] = number;
+        out.number(pNode->type_);
+        out.number(pNode->parentType_);
+        out.text(pNode->name_);
+        out.text(pNode->package_);
+        out.text(pNode->path_);
+        out.number(pNode->startLineCount_);
+        out.number(pNode->endLineCount_);
+        out.number(pNode->complexity_);
+        out.number(pNode->statementCount());
+        writeDecls(out, pNode->decl_);
+        out.number(pNode->children_.size());
+        for (auto iter = pNode->children_.rbegin(); iter != pNode->children_.rend(); ++iter)
+          stack.push_back(*iter);
+      }
+    }
+  }
+  //----< one node, made by ast, nullptr if the record is bad >--------
+
+  ASTNode* readNode(Reader& in, AbstrSynTree& ast, size_t& childCount)
+  {
+    size_t type = in.number(), parentType = in.number();
+    std::string name = in.text(), package = in.text(), path = in.text();
+    size_t start = in.number(), end = in.number(), complexity = in.number(), statements = in.number();
+    std::vector<DeclarationNode> decls;
+    if (!readDecls(in, decls))
+      return nullptr;
+    childCount = in.count(MinNodeBytes);
+    if (!in.ok() || type > controlType || parentType > controlType)
+      return nullptr;
+    ASTNode* pNode = ast.makeNode(static_cast<NodeType>(type), name);
+    pNode->parentType_ = static_cast<NodeType>(parentType);
+    pNode->package_ = package;
+    if (path.size() > 0)
+      pNode->path_ = path;
+    pNode->startLineCount_ = start;
+    pNode->endLineCount_ = end;
+    pNode->complexity_ = complexity;
+    pNode->releasedStatements_ = statements;
+    pNode->decl_.swap(decls);
+    return pNode;
+  }
+  //----< rebuild one root's subtree, appending its nodes to index >---
+
+  ASTNode* readTree(Reader& in, AbstrSynTree& ast, std::vector<ASTNode*>& index)
+  {
+    struct Open { ASTNode* pNode; size_t remaining; };
+    size_t childCount = 0;
+    ASTNode* pRoot = readNode(in, ast, childCount);
+    if (pRoot == nullptr)
+      return nullptr;
+    index.push_back(pRoot);
+    std::vector<Open> open;
+    if (childCount > 0)
+      open.push_back(Open{ pRoot, childCount });
+    while (!open.empty())
+    {
+      ASTNode* pNode = readNode(in, ast, childCount);
+      if (pNode == nullptr)
+        break;
+      index.push_back(pNode);
+      Open& top = open.back();
+      pNode->pParent_ = top.pNode;
+      top.pNode->children_.push_back(pNode);
+      if (--top.remaining == 0)
+        open.pop_back();
+      if (childCount > 0)
+        open.push_back(Open{ pNode, childCount });
+    }
+    if (open.empty())
+      return pRoot;
+    if (!pRoot->pooled_)
+      delete pRoot;
+    return nullptr;
+  }
+  //----< give nodes and decls restored from another file file's path and package >--
+
+  void rename(std::vector<ASTNode*>& nodes, std::vector<DeclarationNode>& decls, const std::string& from, const std::string& file)
+  {
+    Symbol fromPath(from), toPath(file);
+    Symbol fromPackage(FileSystem::Path::getName(from)), toPackage(FileSystem::Path::getName(file));
+    auto renameDecls = [&](std::vector<DeclarationNode>& list) {
+      for (auto& decl : list)
+      {
+        if (decl.package_ == fromPackage)
+          decl.package_ = toPackage;
+      }
+    };
+    renameDecls(decls);
+    for (auto pNode : nodes)
+    {
+      if (pNode->path_ == fromPath)
+        pNode->path_ = toPath;
+      if (pNode->package_ == fromPackage)
+        pNode->package_ = toPackage;
+      renameDecls(pNode->decl_);
+    }
+  }
+}
+//----< read cache written by an earlier run >-----------------------
+/*
+*  - a missing, foreign, or truncated file leaves the cache empty
+*/
+bool ASTCache::load(const File& fileSpec)
+{
+  entries_.clear();
+  std::ifstream in(fileSpec, std::ios::binary);
+  if (!in.good())
+    return false;
+  std::string bytes((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  if (bytes.compare(0, sizeof(Magic) - 1, Magic) != 0)
+    return false;
+  std::string body = bytes.substr(sizeof(Magic) - 1);
+  Reader reader(body);
+  size_t count = reader.count(12);
+  for (size_t i = 0; i < count && reader.ok(); ++i)
+  {
+    File file = reader.text();
+    Entry entry;
+    entry.hash = reader.text();
+    entry.bytes = reader.text();
+    entries_[file] = std::move(entry);
+  }
+  if (!reader.ok() || !reader.atEnd())
+  {
+    entries_.clear();
+    byHash_.clear();
+    return false;
+  }
+  reindex();
+  return true;
+}
+//----< remember a file cached with each hash >----------------------
+
+void ASTCache::reindex()
+{
+  byHash_.clear();
+  for (auto& item : entries_)
+    byHash_.emplace(item.second.hash, item.first);
+}
+//----< write the cache >--------------------------------------------
+
+bool ASTCache::save(const File& fileSpec) const
+{
+  std::string bytes(Magic);
+  Writer writer(bytes);
+  writer.number(entries_.size());
+  for (auto& item : entries_)
+  {
+    writer.text(item.first);
+    writer.text(item.second.hash);
+    writer.text(item.second.bytes);
+  }
+  std::ofstream out(fileSpec, std::ios::binary);
+  out.write(bytes.data(), bytes.size());
+  return out.good();
+}
+//----< keep fragment of a file just parsed >------------------------
+/*
+*  - frag's types and relocations must refer to frag's own nodes,
+*    a relocation's pParent is nullptr for the global scope
+*  - statement tokens are not kept, only their counts
+*/
+bool ASTCache::store(const File& file, const Hash& hash, const ParseFragment& frag)
+{
+  Entry entry;
+  entry.hash = hash;
+  Writer out(entry.bytes);
+  out.number(frag.slocs);
+  out.number(frag.semiExps);
+  out.number(frag.statements.size() + frag.releasedStatements);
+  writeDecls(out, frag.decls);
+  std::unordered_map<const ASTNode*, size_t> index;
+  writeNodes(out, frag.nodes, index);
+
+  out.number(frag.types.size());
+  for (auto& type : frag.types)
+  {
+    auto iter = index.find(type.second);
+    if (iter == index.end())
+      return false;
+    out.text(type.first);
+    out.number(iter->second);
+  }
+  out.number(frag.relocations.size());
+  for (auto& reloc : frag.relocations)
+  {
+    auto parent = reloc.pParent ? index.find(reloc.pParent) : index.end();
+    auto function = index.find(reloc.pFunction);
+    if ((reloc.pParent && parent == index.end()) || function == index.end())
+      return false;
+    out.text(reloc.className);
+    out.number(reloc.pParent ? parent->second : NoNode);
+    out.number(function->second);
+  }
+  entries_[file] = std::move(entry);
+  byHash_[hash] = file;
+  return true;
+}
+//----< rebuild fragment of file, if it or a copy was cached with this hash >--
+/*
+*  - nodes are made by ast, so they come from its arena when pooled
+*  - a copy's nodes and declarations are renamed to file's path and package
+*  - on failure frag is left empty and no nodes are kept
+*/
+bool ASTCache::restore(const File& file, const Hash& hash, ParseFragment& frag, AbstrSynTree& ast) const
+{
+  auto found = entries_.find(file);
+  if (found == entries_.end() || found->second.hash != hash)
+  {
+    auto copy = byHash_.find(hash);
+    found = (copy != byHash_.end()) ? entries_.find(copy->second) : entries_.end();
+    if (found == entries_.end() || found->second.hash != hash)
+      return false;
+  }
+  Reader in(found->second.bytes);
+  ParseFragment result;
+  result.slocs = in.number();
+  result.semiExps = in.number();
+  result.releasedStatements = in.number();
+  bool ok = readDecls(in, result.decls);
+  std::vector<ASTNode*> index;
+  size_t roots = ok ? in.count(MinNodeBytes) : 0;
+  for (size_t i = 0; i < roots && ok; ++i)
+  {
+    ASTNode* pRoot = readTree(in, ast, index);
+    ok = pRoot != nullptr;
+    if (ok)
+      result.nodes.push_back(pRoot);
+  }
+  size_t types = ok ? in.count(8) : 0;
+  for (size_t i = 0; i < types && ok; ++i)
+  {
+    std::string name = in.text();
+    size_t node = in.number();
+    ok = in.ok() && node < index.size();
+    if (ok)
+      result.types[name] = index[node];
+  }
+  size_t relocations = ok ? in.count(12) : 0;
+  for (size_t i = 0; i < relocations && ok; ++i)
+  {
+    Repository::Relocation reloc;
+    reloc.className = in.text();
+    size_t parent = in.number(), function = in.number();
+    ok = in.ok() && (parent == NoNode || parent < index.size()) && function < index.size();
+    if (!ok)
+      break;
+    reloc.pParent = parent == NoNode ? nullptr : index[parent];
+    reloc.pFunction = index[function];
+    result.relocations.push_back(reloc);
+  }
+  if (!ok || !in.ok() || !in.atEnd())
+  {
+    for (auto pRoot : result.nodes)
+    {
+      if (!pRoot->pooled_)
+        delete pRoot;
+    }
+    return false;
+  }
+  if (found->first != file)
+    rename(index, result.decls, found->first, file);
+  result.opened = true;
+  frag = std::move(result);
+  return true;
+}
+//----< forget files no longer analyzed >----------------------------
+
+size_t ASTCache::keepOnly(const std::function<bool(const File&)>& keep)
+{
+  size_t count = 0;
+  for (auto iter = entries_.begin(); iter != entries_.end();)
+  {
+    if (!keep(iter->first))
+    {
+      iter = entries_.erase(iter);
+      ++count;
+    }
+    else
+      ++iter;
+  }
+  if (count > 0)
+    reindex();
+  return count;
+}
+
+#ifdef TEST_ASTCACHE
+
+//----< test stub >--------------------------------------------------
+
+#include <iostream>
+
+int main()
+{
+  std::cout << "\n  Testing ASTCache";
+  std::cout << "\n ==================";
+
+  ScopeStack<ASTNode*> stack;
+  AbstrSynTree parsed(stack);
+  ParseFragment frag;
+  ASTNode* pClass = parsed.makeNode(classType, "Widget");
+  pClass->package_ = "Widget.h";
+  pClass->startLineCount_ = 3;
+  pClass->endLineCount_ = 20;
+  ASTNode* pFunc = parsed.makeNode(functionType, "draw");
+  pFunc->parentType_ = classType;
+  pFunc->startLineCount_ = 5;
+  pFunc->endLineCount_ = 9;
+  pClass->children_.push_back(pFunc);
+  frag.nodes.push_back(pClass);
+  frag.types["Widget"] = pClass;
+  frag.slocs = 20;
+  frag.opened = true;
+
+  ASTCache cache;
+  cache.store("Widget.h", "1234", frag);
+  cache.save("ast.cache");
+
+  ASTCache warm;
+  warm.load("ast.cache");
+  ScopeStack<ASTNode*> stack2;
+  AbstrSynTree restored(stack2);
+  ParseFragment copy;
+  std::cout << "\n  stale hash restored: " << std::boolalpha << warm.restore("Widget.h", "5678", copy, restored);
+  std::cout << "\n  same hash restored:  " << warm.restore("Widget.h", "1234", copy, restored);
+  for (auto pNode : copy.nodes)
+    ASTWalk(pNode, [](ASTNode* pItem, size_t depth) { std::cout << "\n  " << std::string(2 * depth, ' ') << pItem->show(); });
+  std::cout << "\n  Widget type restored: " << (copy.types["Widget"] == copy.nodes[0]);
+  ParseFragment branch;
+  std::cout << "\n  copy restored:       " << warm.restore("branch/Gadget.h", "1234", branch, restored);
+  std::cout << "\n  copy's package:      " << branch.nodes[0]->package_;
+  for (auto pNode : frag.nodes)
+    delete pNode;
+  for (auto pNode : copy.nodes)
+    delete pNode;
+  for (auto pNode : branch.nodes)
+    delete pNode;
+  std::cout << "\n\n";
+}
+#endif
@@ -0,0 +1,98 @@
+#pragma once
+///////////////////////////////////////////////////////////////////
+// ASTCache.h: Keeps each file's AST fragment between runs       //
+// ver 1.2                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  ===================
+*  ASTCache holds the AST fragment of each file analyzed, in a compact
+*  binary form, keyed by the file's name and the hash of its text.  A
+*  fragment is the file's top level nodes with their subtrees, its
+*  global declarations, the types it defines, and the member functions
+*  waiting to be relinked to classes defined in other files.  Nodes keep
+*  their kind, name, package, path, lines, complexity, statement count,
+*  and declarations, which is all that metrics, displays, and type
+*  analysis use.  Statement tokens are not kept, as in bounded memory
+*  mode.
+*
+*  A later run restores the fragment of every file whose text hashes
+*  the same, instead of parsing the file again.  A file is restored from
+*  the fragment of any file cached with the same hash, so the copies of
+*  one file uploaded for many branches are parsed once; the restored
+*  nodes and declarations are given the file's own path and package.
+*
+*  File format:
+*  ------------
+*  "ASTC2", entry count, then for each entry the file name, the hash,
+*  and the fragment's bytes.  Numbers are 4 byte little endian unsigned
+*  integers, strings are a number of bytes followed by the bytes.
+*
+*  Public Interface:
+*  -----------------
+*  bool load(fileSpec)                      //reads cache written by an earlier run, false if none
+*  bool save(fileSpec)                      //writes the cache
+*  bool restore(file, hash, frag, ast)      //rebuilds file's fragment, or a same content file's, false if none
+*  bool store(file, hash, frag)             //keeps a fragment just parsed, false if it can't be kept
+*  size_t keepOnly(keep)                    //forgets files keep(file) is false for, returns number forgotten
+*  size_t size()                            //number of files cached
+*  size_t contents()                        //number of distinct hashes cached
+*
+*  Required Files:
+*  ---------------
+*  - ASTCache.h, ASTCache.cpp, Executive.h, Executive.cpp
+*  - AbstrSynTree.h, AbstrSynTree.cpp
+*
+*  Build Process:
+*  --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.2 : 14 Oct 2026
+*  - restore falls back to a fragment cached for another file with the
+*    same hash, renamed to the file's path and package
+*  ver 1.1 : 14 Oct 2026
+*  - fragments are stored with the complexities set as their scopes
+*    ended, so restored nodes keep them, format is now "ASTC2"
+*  ver 1.0 : 14 Oct 2026
+*  - first release
+*/
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <functional>
+
+namespace CodeAnalysis
+{
+  struct ParseFragment;
+  class AbstrSynTree;
+
+  class ASTCache
+  {
+  public:
+    using File = std::string;
+    using Hash = std::string;
+
+    bool load(const File& fileSpec);
+    bool save(const File& fileSpec) const;
+    bool restore(const File& file, const Hash& hash, ParseFragment& frag, AbstrSynTree& ast) const;
+    bool store(const File& file, const Hash& hash, const ParseFragment& frag);
+    size_t keepOnly(const std::function<bool(const File&)>& keep);
+    size_t size() const { return entries_.size(); }
+    size_t contents() const { return byHash_.size(); }
+  private:
+    struct Entry
+    {
+      Hash hash;
+      std::string bytes;
+    };
+    void reindex();
+    std::unordered_map<File, Entry> entries_;
+    std::unordered_map<Hash, File> byHash_;   // a file cached with each hash
+  };
+}
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////
 // DepenAnal.h: Creates Dependency Information by Scanning AST   //
-// ver 1.0                                                       //
+// ver 1.1                                                       //
 // Application: Type Based Dependency Analysis, Spring 2017      //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project2             //
@@ -25,13 +25,108 @@
 *  using CodeAnalysis                     //Namespace used to check coding standards of the project
 *  doTypeAnal()                           //Implements type analysis by scanning the AST 
 *  DependencyTable()                      //Traveres Directories in current path specified and invokes dependency table 
+*  quickPublish(argc, argv)               //plain pages and include edges before the parse, dependencyTable upgrades them
 *  DFS()                                  //scans Abstract Syntax tree 
+*  buildTypeTable()                       //adds the AST's types to the type table, in parallel
+*  setIncremental(bool)                   //publish only files changed since the last run
+*  setSharedAssets(bool)                  //link every page to one content hashed CSS/JS pair
+*  setScanTypeNames(bool)                 //find type names with DependencyAnalysis's TypeNameScanner
+*  setPrecompress(bool)                   //also write large pages gzip compressed, page.html.gz
+*  setPacked(bool)                        //publish into one PagePack, pages.index, not a file per page
+*  setGenerations(bool)                   //stage pages as a generation, swapped in when all are written
+*  setSearchIndex(bool)                   //keep search.index of sources and symbols for the server's SEARCH
+*  setTokenCache(const TokenCache*)       //reuse text and tokens cached by the parse pass
+*  setContentHashes(const ContentHashes*) //scan files with the same text once for dependencies
+*  setInventory(const FileInventory*)     //reuse the executive's inventory of the repository
+*  preparePublishing(root)                //write CSS/JS and fix page links before pages are rendered
+*  publishes(file)                        //would dependencyTable publish file?
+*  renderPage(file, scopes)               //publish one page while the AST is still being built
+*  setPrerendered(files, waitRendered)    //pages rendered elsewhere, and the barrier they finish at
+*  buildTypes(), typeTable()              //the AST's types, without displaying them, e.g., a worker's shard
+*  analyzeShard(root, shard, all, global) //publish and analyze a shard with every worker's merged types
 * Build Process:
 * --------------
 *   devenv CodeAnalyzerEx.sln /debug rebuild
 *
 * Maintenance History:
 * --------------------
+* Ver 1.26 : 14 Oct 2026
+* - dependencyTable saves the dependency database as deps.snapshot under the root, swapped
+*   in whole, so the server answers QUERY messages for dependency subgraphs from it
+* Ver 1.25 : 14 Oct 2026
+* - added quickPublish: before the parse, pages are rendered without scopes or type
+*   links and NoSqlDb gets each file's #include edges, read by a line scan, as a batch
+*   of its own; dependencyTable then replaces the pages and the edges
+* Ver 1.24 : 14 Oct 2026
+* - added buildTypes, typeTable and analyzeShard, so distributed workers build the type
+*   table of their shard, and publish and analyze it with the table merged from all workers
+* Ver 1.23 : 14 Oct 2026
+* - allocations building the type table, saving dependencies to NoSqlDb and updating
+*   the search index are counted as those subsystems' in MemoryProfile
+* Ver 1.22 : 14 Oct 2026
+* - added setSearchIndex: dependencyTable updates the trigram SearchIndex under the root,
+*   reading only files whose stamp moved, with the symbols of the files the AST holds
+* Ver 1.21 : 14 Oct 2026
+* - dependencyTable gives the publisher an anchor for each type, the first line of its
+*   class, struct or interface node in the AST, or, for types of files not parsed this
+*   run, its file from the type table, so pages link type names to definitions
+* Ver 1.20 : 14 Oct 2026
+* - added setGenerations: preparePublishing begins a PageGenerations generation the
+*   pages are written into, and dependencyTable commits it once every page is written,
+*   so a server serves the last run's pages, whole, until then
+* Ver 1.19 : 14 Oct 2026
+* - added setPacked: pages go into a PagePack under the root, opened by preparePublishing,
+*   with shared assets, and committed by dependencyTable once every page is written
+* Ver 1.18 : 14 Oct 2026
+* - added setPrecompress, for the executive's /z option
+* Ver 1.17 : 14 Oct 2026
+* - added setContentHashes, dependencies are found once for each distinct file text
+* Ver 1.16 : 14 Oct 2026
+* - TypeAnal is constructed with the Repository whose AST it analyzes
+* Ver 1.15 : 14 Oct 2026
+* - added setScanTypeNames, for the executive's /w option
+* Ver 1.14 : 14 Oct 2026
+* - buildTypeTable adds every definition, with its namespace, to the multi-index
+*   TypeTable instead of inserting only the first one
+* - in incremental mode the type table is saved as types.index; the next run loads
+*   it, removes the files it parsed again or that are gone, and merges the rest
+* Ver 1.13 : 14 Oct 2026
+* - added preparePublishing, publishes, renderPage and setPrerendered, so the executive's
+*   pipeline renders pages as files are parsed; dependencyTable publishes the rest and
+*   waits for them before it raises PublishSignal
+* Ver 1.12 : 14 Oct 2026
+* - dependencyTable publishes with Publisher::publishParallel and signals PublishSignal
+*   as each page is written, so the server streams pages while the rest render
+* Ver 1.11 : 14 Oct 2026
+* - DFS walks with an explicit stack and only displays, doTypeAnal builds the type
+*   table with buildTypeTable, which gathers the types of independent subtrees on all cores
+* Ver 1.10 : 14 Oct 2026
+* - dependencyTable collects the first and last lines of each file's scopes from the AST
+*   and gives them to the publisher, for the scope tables of pages rendered on demand
+* Ver 1.9 : 14 Oct 2026
+* - setListing is replaced by setInventory: directories, files, extensions and the
+*   stamps the manifest compares come from the executive's FileInventory
+* Ver 1.8 : 14 Oct 2026
+* - added setListing: dependencyTable takes the repository's directories and files from
+*   the listing the executive's search made, instead of reading them again
+* Ver 1.7 : 14 Oct 2026
+* - dependencyTable times its publish and dependency passes with RunProfile
+* Ver 1.6 : 14 Oct 2026
+* - added setTokenCache: dependency analysis and publishing use the text and tokens
+*   the parse pass cached, files the parser didn't see are read as before
+* Ver 1.5 : 14 Oct 2026
+* - dependencyTable raises PublishSignal when a batch is published, callingPublisher
+*   no longer spins before iterating the repository
+* Ver 1.4 : 14 Oct 2026
+* - node types are compared as NodeType enumerators, paths as interned Symbols
+* Ver 1.3 : 14 Oct 2026
+* - added setSharedAssets: CSS/JS are written once under the repository's assets directory
+* Ver 1.2 : 14 Oct 2026
+* - added incremental mode, setIncremental(true): a PublishManifest saved in the
+*   repository remembers content hashes, dependencies and types of each file, and
+*   only changed files and their reverse dependents are published again
+* Ver 1.1 : 14 Oct 2026
+* - dependencyTable analyzes files with DependencyAnalysis::parallelDependencyTable
 * Ver 1.0 : 11 March 2017
 * - first release
 *
@@ -43,7 +138,17 @@
 #include "../DependencyAnalysis/DependencyAnalysis.h"
 #include "../FileSystem/FileSystem.h"
 #include "../CodePublisher/publisher.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../CodePublisher/PagePack.h"
+#include "../CodePublisher/PageGenerations.h"
+#include "../CodePublisher/SearchIndex.h"
+#include "../CodePublisher/PublishSignal.h"
+#include "../HelpSession/NoSqlDb/Snapshot.h"
+#include "../Utilities/RunProfile.h"
+#include "../Utilities/MemoryProfile.h"
+#include "../FileMgr/FileInventory.h"
 #include <set>
+#include <memory>
 
 
 using Keys = std::vector<std::string>;
@@ -57,13 +162,43 @@ namespace CodeAnalysis
 	{
 	public:
 		using SPtr = std::shared_ptr<ASTNode*>;
+		static const size_t PrecompressBytes = 1024;   // smaller pages are sent as they are
 
-		TypeAnal();
+		TypeAnal(Repository& repo);
 		void doTypeAnal();
 		std::unordered_map<std::string, std::vector<std::string>> dependencyTable(int argc, char* argv[]);
+		std::unordered_map<std::string, std::vector<std::string>> quickPublish(int argc, char* argv[]);
 		void callingPublisher();
+		void setIncremental(bool incremental) { incremental_ = incremental; }
+		void setSharedAssets(bool shared) { sharedAssets_ = shared; }
+		void setScanTypeNames(bool scan) { dep.scanTypeNames(scan); }
+		void setPrecompress(bool precompress) { p.precompress(precompress ? PrecompressBytes : 0); }
+		void setPacked(bool packed) { packed_ = packed; }
+		void setGenerations(bool generations) { generational_ = generations; }
+		void setSearchIndex(bool index) { searchIndex_ = index; }
+		void setTokenCache(const Scanner::TokenCache* pCache) { dep.useTokenCache(pCache); p.useTokenCache(pCache); }
+		void setContentHashes(const DependencyAnalysis::ContentHashes* pHashes) { dep.useContentHashes(pHashes); }
+		void setInventory(const FileManager::FileInventory* pInventory);
+		void preparePublishing(const std::string& root);
+		bool publishes(const std::string& file);
+		void renderPage(const std::string& file, const std::vector<Publisher::Scope>& scopes);
+		void setPrerendered(const std::vector<std::string>& files, const std::function<void()>& waitRendered);
+		void buildTypes() { if (ASTref_.root() != nullptr) buildTypeTable(ASTref_.root()); }
+		const TypeTable& typeTable() const { return TT; }
+		std::unordered_map<std::string, std::vector<std::string>> analyzeShard(const std::string& root,
+			const std::vector<std::string>& shard, const std::vector<std::string>& all, const TypeTable& global);
 	private:
+		bool fileExists(const std::string& file) { return pInventory_ ? pInventory_->exists(file) : FileSystem::File::exists(file); }
+		std::vector<std::string> repositoryFiles(const std::string& root, bool showDirectories);
 		void DFS(ASTNode* pNode);
+		void collectScopes(ASTNode* pRoot);
+		Publisher::AnchorIndex collectAnchors(const std::vector<std::string>& files);
+		void updateSearchIndex(const std::string& root, const std::vector<std::string>& files);
+		void saveDependencies(const std::string& root);
+		void buildTypeTable(ASTNode* pRoot);
+		void mergeManifestTypes(const std::vector<std::string>& files, const std::set<std::string>& parsed);
+		bool mergeSavedTypes(const std::string& indexFile, const std::vector<std::string>& files, const std::set<std::string>& parsed);
+		void recordManifest(const std::vector<std::string>& files, const std::vector<std::string>& analyzed);
 		AbstrSynTree& ASTref_;
 		ScopeStack<ASTNode*> scopeStack_;
 		Scanner::Toker& toker_;
@@ -75,13 +210,26 @@ namespace CodeAnalysis
 		FileSystem::Path  path;
 
 		Publisher p;
-
+		Publisher::ScopeIndex scopes_;
+		bool incremental_ = false;
+		bool sharedAssets_ = false;
+		bool packed_ = false;
+		bool generational_ = false;
+		bool searchIndex_ = false;
+		std::unique_ptr<PagePack> pack_;
+		std::unique_ptr<PageGenerations> generations_;
+		PublishManifest manifest_;
+		const FileManager::FileInventory* pInventory_ = nullptr;
+		std::string preparedRoot_;
+		std::set<std::string> prerendered_;   // full file specs
+		std::function<void()> waitRendered_;
+		std::vector<std::string> quickFiles_;   // files whose include edges a quick batch saved
 	};
 
-	inline TypeAnal::TypeAnal() :
-		ASTref_(Repository::getInstance()->AST()),
-		scopeStack_(Repository::getInstance()->scopeStack()),
-		toker_(*(Repository::getInstance()->Toker()))
+	inline TypeAnal::TypeAnal(Repository& repo) :
+		ASTref_(repo.AST()),
+		scopeStack_(repo.scopeStack()),
+		toker_(*(repo.Toker()))
 	{
 		//directory()
 		std::function<void()> test = [] { int x; };  // This is here to test detection of lambdas.
@@ -89,80 +237,511 @@ namespace CodeAnalysis
 
 	inline bool doDisplay(ASTNode* pNode)
 	{
-		static std::string toDisplay[] = {
-		  "function", "lambda", "class", "struct", "enum", "alias", "typedef"
+		static NodeType toDisplay[] = {
+		  functionType, lambdaType, classType, structType
 		};
-		for (std::string type : toDisplay)
+		for (NodeType type : toDisplay)
 		{
 			if (pNode->type_ == type)
 				return true;
 		}
 		return false;
 	}
+	//shows the types and functions of each file, walking the AST with an explicit stack
 	inline void TypeAnal::DFS(ASTNode* pNode)
 	{
-		static std::string path = "";
-		if (pNode->path_ != path){
-			std::cout << "\n    -- " << pNode->path_ << "\\" << pNode->package_;
-			path = pNode->path_;
-		}
-		if (doDisplay(pNode)) {
-			std::cout << "\n  " << pNode->name_;
-			std::cout << ", " << pNode->type_;
-			//std::cout << " ," << pNode->parentType_;
-		}
+		Symbol path;
+		ASTWalkNoIndent(pNode, [&path](ASTNode* pItem) {
+			if (pItem->path_ != path) {
+				std::cout << "\n    -- " << pItem->path_ << "\\" << pItem->package_;
+				path = pItem->path_;
+			}
+			if (doDisplay(pItem)) {
+				std::cout << "\n  " << pItem->name_;
+				std::cout << ", " << pItem->type_;
+				//std::cout << " ," << pItem->parentType_;
+			}
+		});
+	}
 
-		if ((pNode->type_ == "struct") || (pNode->type_ == "class") || (pNode->type_ == "interface")) {
-			std::vector<std::pair<std::string, std::string>> KeyPair;
-			KeyPair.push_back(std::make_pair(pNode->type_, pNode->package_));
-			TT.getTypeTable().insert(std::make_pair(pNode->name_, KeyPair));
+	//adds the classes, structs and interfaces under pRoot to TT, subtrees on all cores
+	/*
+	*  Each subtree's types are kept apart and added in order, so definitions
+	*  of a name are listed as a serial walk finds them, the first one first.
+	*  A subtree's namespace is the path of namespaces above it, e.g., "A::B".
+	*/
+	inline void TypeAnal::buildTypeTable(ASTNode* pRoot)
+	{
+		Utilities::MemoryProfile::Subsystem tag("typeTable");
+		std::unordered_map<ASTNode*, std::string> namespaces;
+		std::vector<std::pair<ASTNode*, std::string>> stack(1, std::make_pair(pRoot, std::string()));
+		while (!stack.empty()) {
+			ASTNode* pNode = stack.back().first;
+			std::string name = stack.back().second;
+			stack.pop_back();
+			for (ASTNode* pChild : pNode->children_) {
+				if (pChild->type_ == namespaceType)
+					stack.push_back(std::make_pair(pChild, name.empty() ? pChild->name_ : name + "::" + pChild->name_));
+				else
+					namespaces[pChild] = name;
+			}
 		}
-
-		for (auto pChild : pNode->children_)
-			DFS(pChild);
+		std::vector<ASTNode*> subtrees = ASTSubtrees(pRoot);
+		std::vector<std::string> subtreeNamespaces;
+		for (ASTNode* pSubtree : subtrees)
+			subtreeNamespaces.push_back(namespaces[pSubtree]);
+		std::vector<TypeTable::Definitions> found(subtrees.size());
+		ASTWalkParallel(subtrees, [&](ASTNode* pNode, size_t i) {
+			if ((pNode->type_ == structType) || (pNode->type_ == classType) || (pNode->type_ == interfaceType)) {
+				Utilities::MemoryProfile::Subsystem walker("typeTable");
+				TypeTable::Definition def = { pNode->name_, typeName(pNode->type_), pNode->package_.str(), subtreeNamespaces[i] };
+				found[i].push_back(def);
+			}
+		});
+		for (auto& defs : found)
+			for (auto& def : defs)
+				TT.add(def.name, def.type, def.file, def.nameSpace);
 	}
 
 	inline void TypeAnal::doTypeAnal()
 	{
 		ASTNode* pRoot = ASTref_.root();
 		DFS(pRoot);
+		buildTypeTable(pRoot);
 	}
 
-	//function to iterate through all files in repository by accepting command line arguments
-	inline std::unordered_map<std::string, std::vector<std::string>> TypeAnal::dependencyTable(int argc, char* argv[]) {
+	//adds the lines each node spans to its file's scopes
+	inline void TypeAnal::collectScopes(ASTNode* pRoot)
+	{
+		ASTWalkNoIndent(pRoot, [this](ASTNode* pNode) {
+			if (pNode->endLineCount_ > pNode->startLineCount_ && !pNode->path_.str().empty())
+				scopes_[pNode->path_.str()].push_back(Publisher::Scope(pNode->startLineCount_, pNode->endLineCount_));
+		});
+	}
+
+	//anchor of each type defined in files: its first definition the AST holds, else its type table file
+	/*
+	*  Types of files not parsed this run, e.g., unchanged files of an incremental
+	*  run, are only in the type table, which knows their file, not the line.
+	*/
+	inline Publisher::AnchorIndex TypeAnal::collectAnchors(const std::vector<std::string>& files) {
+		Publisher::AnchorIndex anchors;
+		std::set<std::string> published;
+		std::unordered_map<std::string, std::string> byName;   // first of files with each name
+		for (auto& file : files) {
+			published.insert(path.toLower(path.getFullFileSpec(file)));
+			byName.emplace(path.getName(file), file);
+		}
+		if (ASTref_.root() != nullptr) {
+			ASTWalkNoIndent(ASTref_.root(), [&](ASTNode* pNode) {
+				if (pNode->type_ != classType && pNode->type_ != structType && pNode->type_ != interfaceType)
+					return;
+				if (anchors.find(pNode->name_) != anchors.end() || pNode->path_.str().empty() ||
+					published.find(path.toLower(path.getFullFileSpec(pNode->path_.str()))) == published.end())
+					return;
+				Publisher::Anchor anchor = { pNode->path_.str(), pNode->startLineCount_ };
+				anchors[pNode->name_] = anchor;
+			});
+		}
+		for (auto& item : TT.getTypeTable()) {
+			if (item.second.empty() || anchors.find(item.first) != anchors.end())
+				continue;
+			auto iter = byName.find(item.second.front().second);
+			if (iter == byName.end())
+				continue;
+			Publisher::Anchor anchor = { iter->second, 0 };
+			anchors[item.first] = anchor;
+		}
+		return anchors;
+	}
+
+	//indexes files whose stamp moved for searching, with the symbols of files the AST holds
+	/*
+	*  Files not parsed this run keep the symbols the last run recorded.
+	*/
+	inline void TypeAnal::updateSearchIndex(const std::string& root, const std::vector<std::string>& files) {
+		Utilities::MemoryProfile::Subsystem tag("searchIndex");
+		std::string indexFile = root + "/search.index";
+		SearchIndex index;
+		index.load(indexFile);
+		size_t read = 0;
+		for (auto& file : files) {
+			const FileManager::FileInventory::Item* pItem = pInventory_ ? pInventory_->find(file) : nullptr;
+			if (index.update(file, pItem ? pItem->stamp() : PublishManifest::stamp(file)))
+				++read;
+		}
+		index.retain(files);
+		if (ASTref_.root() != nullptr) {
+			std::unordered_map<std::string, SearchIndex::Symbols> symbols;
+			ASTWalkNoIndent(ASTref_.root(), [&symbols](ASTNode* pNode) {
+				if (pNode->path_.str().empty() || pNode->type_ == anonymousType || pNode->type_ == lambdaType || pNode->type_ == controlType)
+					return;
+				SearchIndex::Symbol symbol;
+				symbol.name = pNode->name_;
+				symbol.kind = typeName(pNode->type_);
+				symbol.line = pNode->startLineCount_;
+				symbols[pNode->path_.str()].push_back(symbol);
+			});
+			for (auto& item : symbols)
+				index.setSymbols(item.first, item.second);
+		}
+		if (!index.save(indexFile))
+			std::cout << "\n  can't save the search index, the last one is still searched\n";
+		else
+			std::cout << "\n  search index: " << read << " of " << files.size() << " files indexed again\n";
+	}
+
+	//saves the dependency database for the server's QUERY, the last snapshot stays until this one is written
+	inline void TypeAnal::saveDependencies(const std::string& root) {
+		Utilities::MemoryProfile::Subsystem tag("NoSqlDb");
+		std::string snapshotFile = root + "/deps.snapshot";
+		std::string temp = snapshotFile + ".tmp";
+		if (!Snapshot<std::string>::save(dep.dbInst, temp) || !PagePack::swapIn(temp, snapshotFile)) {
+			FileSystem::File::remove(temp);
+			std::cout << "\n  can't save the dependency snapshot, the last one is still queried\n";
+		}
+	}
+
+	//adds types of files that were not parsed this run, recorded by the last run, to the type table
+	inline void TypeAnal::mergeManifestTypes(const std::vector<std::string>& files, const std::set<std::string>& parsed) {
+		for (auto file : files) {
+			PublishManifest::Entry* pEntry = manifest_.find(file);
+			if (pEntry == nullptr || parsed.find(file) != parsed.end())
+				continue;
+			std::string package = path.getName(file);
+			for (auto type : pEntry->types)
+				TT.add(type.first, type.second, package);
+		}
+	}
+
+	//adds types of files that were not parsed this run from the type index saved by the last run
+	/*
+	*  Files parsed again, files whose types the AST already gave, and files no longer
+	*  in the repository are removed from the saved index first, so only definitions
+	*  of unchanged files are merged.
+	*/
+	inline bool TypeAnal::mergeSavedTypes(const std::string& indexFile, const std::vector<std::string>& files, const std::set<std::string>& parsed) {
+		TypeTable saved;
+		if (!saved.load(indexFile))
+			return false;
+		std::set<std::string> unchanged;
+		for (auto file : files)
+			if (parsed.find(file) == parsed.end())
+				unchanged.insert(path.getName(file));
+		for (auto package : saved.files())
+			if (unchanged.find(package) == unchanged.end() || !TT.inFile(package).empty())
+				saved.removeFile(package);
+		TT.merge(saved);
+		return true;
+	}
+
+	//records dependencies and defined types of analyzed files for the next run, forgets removed files
+	inline void TypeAnal::recordManifest(const std::vector<std::string>& files, const std::vector<std::string>& analyzed) {
+		for (auto file : analyzed) {
+			std::vector<PublishManifest::TypeRecord> types;
+			for (auto& def : TT.inFile(path.getName(file)))
+				types.push_back(std::make_pair(def.name, def.type));
+			manifest_.record(file, dep.depResult[file], types);
+		}
+		std::set<std::string> present;
+		for (auto file : files)
+			present.insert(path.getFullFileSpec(file));
+		for (auto iter = manifest_.entries().begin(); iter != manifest_.entries().end();) {
+			if (present.find(iter->first) == present.end())
+				iter = manifest_.entries().erase(iter);
+			else
+				++iter;
+		}
+	}
+
+	//directories, files and manifest stamps come from pInventory, publishing too
+	inline void TypeAnal::setInventory(const FileManager::FileInventory* pInventory) {
+		pInventory_ = pInventory;
+		p.useInventory(pInventory);
+		if (pInventory == nullptr) {
+			manifest_.useStamps(nullptr);
+			return;
+		}
+		manifest_.useStamps([pInventory](const std::string& file) {
+			const FileManager::FileInventory::Item* pItem = pInventory->find(file);
+			return pItem ? pItem->stamp() : std::string();
+		});
+	}
+
+	//writes CSS/JS, shared or per directory, so page links are fixed before any page is rendered
+	inline void TypeAnal::preparePublishing(const std::string& root) {
+		if (preparedRoot_ == root)
+			return;
+		preparedRoot_ = root;
+		if (packed_) {
+			pack_.reset(new PagePack(root));
+			if (pack_->open()) {
+				p.usePack(pack_.get());
+				PagePack* pPack = pack_.get();
+				manifest_.usePublished([pPack](const std::string& file) { return pPack->has(pPack->nameOf(file + ".html")); });
+			}
+			else {
+				std::cout << "\n  can't open the page pack, writing a file per page\n";
+				pack_.reset();
+			}
+		}
+		//a pack is already swapped in whole, generations are for pages written as files
+		if (generational_ && !pack_) {
+			generations_.reset(new PageGenerations(root));
+			if (generations_->begin()) {
+				p.useGenerations(generations_.get());
+				PageGenerations* pGenerations = generations_.get();
+				manifest_.usePublished([pGenerations](const std::string& file) { return pGenerations->published(file + ".html"); });
+			}
+			else {
+				std::cout << "\n  can't stage a page generation, writing pages in place\n";
+				generations_.reset();
+			}
+		}
+		if ((sharedAssets_ || pack_) && !p.useSharedAssets(root))
+			std::cout << "\n  can't write shared assets, styling each directory\n";
+		std::vector<std::string> directories = pInventory_ ? pInventory_->getDirectories(root) : directory.getDirectories(root);
+		for (size_t i = 0; i < directories.size(); i++) {
+			std::string temp = root + "/" + directories[i] + "/";
+			if (!incremental_ || !fileExists(temp + "cssStyleFile.css"))
+				p.StylingPublisherCSS(temp);
+			if (!incremental_ || !fileExists(temp + "ScopeHandler.Js"))
+				p.StylingPublisherJS(temp);
+		}
+	}
+
+	//dependencyTable publishes the .h and .cpp files one directory below the prepared root
+	inline bool TypeAnal::publishes(const std::string& file) {
+		std::string ext = path.getExt(file);
+		if (preparedRoot_.empty() || (ext != "h" && ext != "cpp"))
+			return false;
+		std::string dir = path.getPath(path.getFullFileSpec(file));
+		std::string parent = path.getPath(dir.substr(0, dir.size() - 1));
+		return path.toLower(parent) == path.toLower(path.getFullFileSpec(preparedRoot_) + "\\");
+	}
+
+	//publishes one page from the scope lines of its file's own AST nodes, and tells the server
+	/*
+	*  Safe on several threads once preparePublishing has run, publisher state isn't changed.
+	*/
+	inline void TypeAnal::renderPage(const std::string& file, const std::vector<Publisher::Scope>& scopes) {
+		p.publishCode(file, scopes);
+		PublishSignal::pageDone();
+	}
+
+	//files whose pages are rendered elsewhere, waitRendered returns when they are all written
+	inline void TypeAnal::setPrerendered(const std::vector<std::string>& files, const std::function<void()>& waitRendered) {
+		prerendered_.clear();
+		for (auto& file : files)
+			prerendered_.insert(path.getFullFileSpec(file));
+		waitRendered_ = waitRendered;
+	}
+
+	//publishes the shard's pages and finds their dependencies, one worker's part of a distributed run
+	/*
+	*  global is the type table merged from every worker, so dependencies and type
+	*  links reach files parsed on other nodes; all is every file of the run, for the
+	*  anchors of those types.  The AST holds the shard's files only.
+	*/
+	inline std::unordered_map<std::string, std::vector<std::string>> TypeAnal::analyzeShard(const std::string& root,
+		const std::vector<std::string>& shard, const std::vector<std::string>& all, const TypeTable& global) {
+		TT = global;
+		if (ASTref_.root() != nullptr)
+			collectScopes(ASTref_.root());
+		p.useScopes(std::move(scopes_));
+		scopes_.clear();
+		preparePublishing(root);
+		p.useAnchors(collectAnchors(all));
+		std::vector<std::string> toPublish;
+		for (auto& file : shard)
+			if (publishes(file))
+				toPublish.push_back(file);
+		{
+			Utilities::RunProfile::Scope phase("shard/publish");
+			p.publishParallel(toPublish, 0, [](const std::string&) {});
+		}
+		{
+			Utilities::RunProfile::Scope phase("shard/dependencies");
+			dep.depResult = dep.parallelDependencyTable(TT, toPublish);
+		}
+		return dep.depResult;
+	}
+
+	//the .h and .cpp files one directory below root, the files dependencyTable publishes
+	inline std::vector<std::string> TypeAnal::repositoryFiles(const std::string& root, bool showDirectories) {
 		std::vector<std::string> filecontainer;
-		std::vector<std::string> currentFiles;
-		std::string dirpath_ = argv[1];
-		std::string openInBrowser = argv[4];
-		std::vector<std::string> currentDirectories = directory.getDirectories(dirpath_);
-		for (size_t i = 0; i < currentDirectories.size(); i++) {
+		std::vector<std::string> currentDirectories = pInventory_ ? pInventory_->getDirectories(root) : directory.getDirectories(root);
+		for (size_t i = 0; showDirectories && i < currentDirectories.size(); i++) {
 			std::cout << currentDirectories[i]<<"\n";
 		}
 		for (size_t i = 0; i < currentDirectories.size(); i++) {
-			std::string appendpath = dirpath_ + "/" + currentDirectories[i];
-			std::string temp = dirpath_ + "/" + currentDirectories[i] + "/";
-			p.StylingPublisherCSS(temp);
-			p.StylingPublisherJS(temp);
+			std::string appendpath = root + "/" + currentDirectories[i];
+			std::string temp = root + "/" + currentDirectories[i] + "/";
+			//listed directories have their extensions already, others are read as before
+			std::vector<const FileManager::FileInventory::Item*> items;
+			if (pInventory_ != nullptr && pInventory_->itemsIn(appendpath, items)) {
+				for (auto pItem : items) {
+					if (pItem->ext == "h" || pItem->ext == "cpp")
+						filecontainer.push_back(temp + pItem->name);
+				}
+				continue;
+			}
 			std::vector<std::string> temporaryFiles = directory.getFiles(appendpath);
 			for (size_t k = 0; k < temporaryFiles.size(); k++) {
-				currentFiles.push_back(dirpath_ + "/" + currentDirectories[i] + "/" + temporaryFiles[k]);
+				std::string file = temp + temporaryFiles[k];
+				if ((path.getExt(file) == "h") || (path.getExt(file) == "cpp"))
+					filecontainer.push_back(file);
 			}
 		}
-		for (size_t temp = 0; temp < currentFiles.size(); temp++) {
-			if ((path.getExt(currentFiles[temp]) == "h") || (path.getExt(currentFiles[temp]) == "cpp"))
-				filecontainer.push_back(currentFiles[temp]);
+		return filecontainer;
+	}
+
+	//publishes plain pages and include edges before anything is parsed, the quick batch
+	/*
+	*  Pages have include links and escaped text, but no scope tables or type links,
+	*  and NoSqlDb holds each file's quoted #include edges.  The batch is committed and
+	*  PublishSignal raised, so a server sends it, and the next preparePublishing begins
+	*  again, so dependencyTable's pages replace these as a second batch.
+	*/
+	inline std::unordered_map<std::string, std::vector<std::string>> TypeAnal::quickPublish(int argc, char* argv[]) {
+		std::string dirpath_ = argv[1];
+		if (incremental_)
+			manifest_.load(dirpath_ + "/publish.manifest");
+		preparePublishing(dirpath_);
+		std::vector<std::string> filecontainer = repositoryFiles(dirpath_, false);
+		std::set<std::string> dirty(filecontainer.begin(), filecontainer.end());
+		if (incremental_)
+			dirty = manifest_.dirtyFiles(filecontainer);
+		{
+			Utilities::RunProfile::Scope phase("quickPublish/publish");
+			std::vector<std::string> toPublish;
+			for (auto& file : filecontainer)
+				if (dirty.find(file) != dirty.end())
+					toPublish.push_back(file);
+			p.publishParallel(toPublish, 0, [](const std::string&) { PublishSignal::pageDone(); });
+		}
+		std::unordered_map<std::string, std::vector<std::string>> includes;
+		{
+			Utilities::RunProfile::Scope phase("quickPublish/includes");
+			includes = dep.includeTable(filecontainer);
+		}
+		quickFiles_ = filecontainer;
+		if (pack_ && !pack_->commit())
+			std::cout << "\n  can't commit the page pack, the last index is still served\n";
+		if (generations_ && !generations_->commit())
+			std::cout << "\n  can't commit the page generation, the last one is still served\n";
+		pack_.reset();
+		generations_.reset();
+		p.usePack(nullptr);
+		p.useGenerations(nullptr);
+		manifest_.usePublished(nullptr);
+		preparedRoot_.clear();
+		PublishSignal::raise();
+		std::cout << "\n\n  quick publish: " << dirty.size() << " pages and the include edges of "
+			<< filecontainer.size() << " files, full analysis follows\n";
+		return includes;
+	}
+
+	//function to iterate through all files in repository by accepting command line arguments
+	inline std::unordered_map<std::string, std::vector<std::string>> TypeAnal::dependencyTable(int argc, char* argv[]) {
+		std::vector<std::string> filecontainer;
+		std::string dirpath_ = argv[1];
+		std::string openInBrowser = argv[4];
+		std::string manifestFile = dirpath_ + "/publish.manifest";
+		std::string indexFile = dirpath_ + "/types.index";
+		if (incremental_)
+			manifest_.load(manifestFile);
+		if (ASTref_.root() != nullptr)
+			collectScopes(ASTref_.root());
+		p.useScopes(std::move(scopes_));
+		scopes_.clear();
+		preparePublishing(dirpath_);
+		filecontainer = repositoryFiles(dirpath_, true);
+		//in incremental mode only changed files and their reverse dependents are dirty
+		std::set<std::string> dirty(filecontainer.begin(), filecontainer.end());
+		std::vector<std::string> toAnalyze = filecontainer;
+		if (incremental_) {
+			std::set<std::string> oldTypes;
+			for (auto& entry : manifest_.entries())
+				for (auto& type : entry.second.types)
+					oldTypes.insert(type.first);
+			std::set<std::string> parsed;
+			for (auto file : filecontainer)
+				if (manifest_.changed(file))
+					parsed.insert(file);
+			dirty = manifest_.dirtyFiles(filecontainer);
+			Utilities::MemoryProfile::Subsystem tag("typeTable");
+			if (!mergeSavedTypes(indexFile, filecontainer, parsed))
+				mergeManifestTypes(filecontainer, parsed);
+			std::set<std::string> newTypes;
+			for (auto& item : TT.getTypeTable())
+				newTypes.insert(item.first);
+			//a new or removed type may change dependencies of any file, so rescan them all
+			if (oldTypes == newTypes)
+				toAnalyze.assign(dirty.begin(), dirty.end());
+			std::cout << "\n\n  incremental publish: " << dirty.size() << " of " << filecontainer.size() << " files changed or depend on changed files\n";
 		}
+		p.useAnchors(collectAnchors(filecontainer));
 		//print the result 
 		std::cout << "\n\n  List of files checked into Repository check\n\n";
-		for (size_t t = 0; t < filecontainer.size(); t++) {
-			std::cout << filecontainer[t] << "\n";
-			std::string path = filecontainer[t];
-			p.publishCode(path);
+		//pages are rendered on all cores, each one announced to the server as it's written
+		{
+			Utilities::RunProfile::Scope phase("dependencyTable/publish");
+			std::vector<std::string> toPublish;
+			for (size_t t = 0; t < filecontainer.size(); t++) {
+				std::cout << filecontainer[t] << "\n";
+				bool rendered = !prerendered_.empty() && prerendered_.count(path.getFullFileSpec(filecontainer[t])) > 0;
+				if (dirty.find(filecontainer[t]) != dirty.end() && !rendered)
+					toPublish.push_back(filecontainer[t]);
+			}
+			p.publishParallel(toPublish, 0, [](const std::string&) { PublishSignal::pageDone(); });
 		}
-		for (auto t : filecontainer) {
-			std::string refTTString = t;
-			dep.depResult = dep.DependencyAnalysistable(TT, refTTString);
+		//type dependencies replace the include edges of a quick batch
+		for (auto& file : quickFiles_)
+			dep.dbInst.remove(file);
+		quickFiles_.clear();
+		//files are independent once TT is built, so analyze them on a worker pool
+		if (incremental_) {
+			Utilities::MemoryProfile::Subsystem tag("NoSqlDb");
+			for (auto file : filecontainer) {
+				PublishManifest::Entry* pEntry = manifest_.find(file);
+				if (pEntry == nullptr)
+					continue;
+				dep.depResult[file] = pEntry->deps;
+				Element<std::string> elem;
+				elem.name = file;
+				elem.children = pEntry->deps;
+				dep.dbInst.save(file, elem);
+			}
+		}
+		{
+			Utilities::RunProfile::Scope phase("dependencyTable/dependencies");
+			dep.depResult = dep.parallelDependencyTable(TT, toAnalyze);
+		}
+		if (incremental_) {
+			recordManifest(filecontainer, toAnalyze);
+			manifest_.save(manifestFile);
+			TT.save(indexFile);
+		}
+		{
+			Utilities::RunProfile::Scope phase("dependencyTable/snapshot");
+			saveDependencies(dirpath_);
 		}
+		if (searchIndex_) {
+			Utilities::RunProfile::Scope phase("dependencyTable/searchIndex");
+			updateSearchIndex(dirpath_, filecontainer);
+		}
+		//every page of this batch is written, let a waiting server send them
+		if (waitRendered_) {
+			Utilities::RunProfile::Scope phase("dependencyTable/waitRendered");
+			waitRendered_();
+		}
+		//a packed batch becomes visible all at once, as its index is swapped in
+		if (pack_ && !pack_->commit())
+			std::cout << "\n  can't commit the page pack, the last index is still served\n";
+		if (generations_ && !generations_->commit())
+			std::cout << "\n  can't commit the page generation, the last one is still served\n";
+		PublishSignal::raise();
 		std::string temp1 =  openInBrowser;
 		std::cout <<"\n\n -------------------File to be opened in browser path -->"<< temp1 << std::endl<<"\n\n\n\n";
 		std::wstring temp2= std::wstring(temp1.begin(), temp1.end());
@@ -173,11 +752,6 @@ namespace CodeAnalysis
 
 	//calls the fileIteration package in Publisher package
 	inline void TypeAnal::callingPublisher() {
-		for (int i = 0; i < 100; i++) {
-			for (int j = 0; j < 100; j++) {
-
-			}
-		}
 		p.FileIteration();
 	}
 }
\ No newline at end of file
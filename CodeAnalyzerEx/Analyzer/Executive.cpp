@@ -14,22 +14,35 @@
 #include <vector>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
 #include <functional>
 #include <algorithm>
 #include <exception>
 #include <iomanip>
 #include <chrono>
 #include <ctime>
+#include <thread>
+#include <atomic>
+#include <mutex>
+#include <memory>
 
 #include "../Parser/Parser.h"
 #include "../FileSystem/FileSystem.h"
 #include "../FileMgr/FileMgr.h"
+#include "../FileMgr/DirWatcher.h"
 #include "../Parser/ActionsAndRules.h"
 #include "../Parser/ConfigureParser.h"
 #include "../AbstractSyntaxTree/AbstrSynTree.h"
 #include "../Logger/Logger.h"
 #include "../Utilities/Utilities.h"
+#include "../Utilities/RunProfile.h"
+#include "../Utilities/Trace.h"
+#include "../Utilities/MemoryProfile.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
 #include "DepAnal.h"
+#include "LineCounter.h"
+#include "ReadAhead.h"
+#include "../CodePublisher/PublishManifest.h"
 #include "../HelpSession/NoSqlDb/NoSqlDb.h"
 
 using Rslt = Logging::StaticLogger<0>;  // use for application results
@@ -115,7 +128,8 @@ CodeAnalysisExecutive::CodeAnalysisExecutive()
   {
     throw std::exception("couldn't create parser");
   }
-  pRepo_ = Repository::getInstance();
+  configure_.useTokenCache(&tokenCache_);
+  pRepo_ = configure_.repository();
 }
 //----< cleanup >----------------------------------------------------
 
@@ -132,7 +146,10 @@ CodeAnalysisExecutive::~CodeAnalysisExecutive()
    *    to do.
    *  - This is here to present these comments and to make this
    *    base destructor virtual.
+   *  - Renderers left running by processSourceCodePipelined are
+   *    joined, so no thread outlives the files it renders.
    */
+  finishRendering();
 }
 //----< usage message >----------------------------------------------
 
@@ -152,6 +169,25 @@ void showUsage()
   out << "\n    - d : set logger to display demo outputs";
   out << "\n    - b : set logger to display debug outputs";
   out << "\n    - f : write all logs to logfile.txt";
+  out << "\n    - p : parse files on a pool of threads";
+  out << "\n    - o : pipelined, render pages while files are parsed and analyzed, show stage occupancy";
+  out << "\n    - i : incremental, only parse and publish files changed since the last run";
+  out << "\n    - h : write CSS/JS once, content hashed, to the repository's assets directory";
+  out << "\n    - w : find type names in each file's text with one automaton pass, not the tokenizer";
+  out << "\n    - n : allocate AST nodes and statements from a pool, freed in bulk";
+  out << "\n    - c : bounded memory, free each file's statement tokens once it is parsed";
+  out << "\n    - x : keep each file's AST in ast.cache, only parse files changed since the last run";
+  out << "\n    - u : keep running, analyze and publish again whenever files matching the patterns change";
+  out << "\n    - v : check the complexities found while parsing against a walk of the whole AST";
+  out << "\n    - t : time phases, count work per file, write profile.json and profile.csv";
+  out << "\n    - l : like t, and show each phase's time as it ends";
+  out << "\n    - z : also write each large page gzip compressed, page.html.gz, for the server";
+  out << "\n    - k : publish pages into one indexed pack, pages.index, instead of a file per page";
+  out << "\n    - g : write each run's pages as a new generation, served once all of them are written";
+  out << "\n    - q : keep a trigram index of sources and symbols, search.index, for MsgServer's SEARCH";
+  out << "\n    - e : record spans of every thread's work, written as trace.json, a Chrome trace";
+  out << "\n    - y : count allocations per phase and subsystem, write memory.json and memory.csv";
+  out << "\n    - j : only count each file's lines, memory mapped on all cores, and show file sizes";
   out << "\n  A metrics summary is always shown, independent of any options used or not used";
   out << "\n\n";
   std::cout << out.str();
@@ -232,16 +268,72 @@ FileMap& CodeAnalysisExecutive::getFileMap()
  * - Searches entire diretory tree rooted at path_, evaluated 
  *   from a command line argument.
  * - Saves found files in FileMap.
+ * - Directories are listed on a pool of threads, the listing is kept
+ *   for later phases as a FileInventory, see inventory().
  */
 void CodeAnalysisExecutive::getSourceFiles()
 {
   AnalFileMgr fm(path_, fileMap_);
   for (auto patt : patterns_)
     fm.addPattern(patt);
-  fm.search();
+  fm.searchParallel();
+  inventory_.build(std::move(fm.listing()));
   numFiles_ = fm.numFiles();
   numDirs_ = fm.numDirs();
 }
+//----< remove files whose content matches the publish manifest >---
+/*
+ * - Used with option /i, types and dependencies of the removed files
+ *   are taken from the manifest by TypeAnal.
+ */
+void CodeAnalysisExecutive::dropUnchangedFiles(const File& manifestFile)
+{
+  PublishManifest manifest;
+  if (!manifest.load(manifestFile))
+    return;
+  const FileManager::FileInventory& inventory = inventory_;
+  manifest.useStamps([&inventory](const File& file) {
+    const FileManager::FileInventory::Item* pItem = inventory.find(file);
+    return pItem ? pItem->stamp() : std::string();
+  });
+  size_t dropped = 0;
+  for (auto& item : fileMap_)
+  {
+    Files changed;
+    for (auto file : item.second)
+    {
+      if (manifest.changed(file))
+        changed.push_back(file);
+      else
+        ++dropped;
+    }
+    item.second = changed;
+  }
+  std::ostringstream out;
+  out << "\n  incremental: skipping " << dropped << " unchanged files";
+  Rslt::write(out.str());
+}
+//----< leave only the files keep accepts, returns how many are left >---
+/*
+ * - used by distributed workers, which parse their shard of the files
+ *   getSourceFiles found; the inventory still lists them all
+ */
+size_t CodeAnalysisExecutive::keepFiles(const FileFilter& keep)
+{
+  size_t kept = 0;
+  for (auto& item : fileMap_)
+  {
+    Files shard;
+    for (auto file : item.second)
+    {
+      if (keep(file))
+        shard.push_back(file);
+    }
+    item.second = shard;
+    kept += shard.size();
+  }
+  return kept;
+}
 //----< helper: is text a substring of str? >--------------------
 
 bool contains(const std::string& str, const std::string& text)
@@ -358,103 +450,806 @@ void CodeAnalysisExecutive::setLanguage(const File& file)
   else if (ext == "cs")
     pRepo_->language() = Language::CSharp;
 }
+//----< time parser's rules while profiling, order them with /R >---
+/*
+* - ordering times rules too, period is the SemiExps between orderings
+*/
+static void configureRules(Parser* pParser, size_t orderPeriod)
+{
+  if (orderPeriod > 0)
+    pParser->adaptiveOrder(orderPeriod);
+  else if (Utilities::RunProfile::instance().enabled())
+    pParser->timeRules();
+}
+//----< add parser's rule tests, skips, matches and ms to the profile >--
 
+static void profileRules(const Parser& parser)
+{
+  Utilities::RunProfile& profile = Utilities::RunProfile::instance();
+  if (!profile.enabled())
+    return;
+  for (auto& ruleStats : parser.ruleStats())
+    profile.rule(ruleStats.rule, ruleStats.tests, ruleStats.skips, ruleStats.matches, ruleStats.millis);
+}
+
+//----< attach file's text read ahead, or open it if it wasn't >----
+
+static bool attachNext(ConfigParseForCodeAnal& configure, ReadAhead& readAhead, const File& file)
+{
+  std::string text;
+  if (readAhead.take(file, text))
+    return configure.Attach(file, std::move(text));
+  return configure.Attach(file);
+}
+//----< parse every source file, in order, into the AST >------------
+/*
+* - in the serial loops below the next files are read by a ReadAhead
+*   while one is parsed, so the parse waits on the disk only when it
+*   catches up with the reader
+*/
 void CodeAnalysisExecutive::processSourceCode(bool showProc){
+  Utilities::MemoryProfile::Subsystem tag("parser");
+  if (pooledAST_ && !pRepo_->AST().enablePool())
+    Rslt::write("\n  AST already has nodes, not pooling");
+  if (cachedAST_){
+    processSourceCodeCached(showProc);
+    return;}
+  if (parallelParse_){
+    processSourceCodeParallel(showProc);
+    return;}
+  configureRules(pParser_, ruleOrderPeriod_);
+  ReadAhead readAhead(allSourceFiles());
   for (auto file : cppHeaderFiles()){
     if (showProc)
     showActivity(file);
     pRepo_->package() = FileSystem::Path::getName(file);
-    if (!configure_.Attach(file)){
+    if (!attachNext(configure_, readAhead, file)){
       std::ostringstream out;out << "\n  could not open file " << file << "\n";Rslt::write(out.str()); Rslt::flush();continue;}Rslt::flush();Demo::flush();Dbug::flush();
     if(!Rslt::running())
-      Demo::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Demo, "\n\n  opening file \"" + pRepo_->package() + "\"");
     if(!Demo::running() && !Rslt::running())
-      Dbug::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Dbug, "\n\n  opening file \"" + pRepo_->package() + "\"");
     pRepo_->language() = Language::Cpp;pRepo_->currentPath() = file;
+    Utilities::RunProfile::Scope timer("parse", file);
+    size_t firstNode = pRepo_->getGlobalScope()->children_.size(), semiExps = 0;
     while (pParser_->next()){
-      pParser_->parse();}
+      ++semiExps;pParser_->parse();}
+    profileFile(file, semiExps, pRepo_->getGlobalScope()->children_, firstNode);
+    releaseFileTokens(firstNode);
     Slocs slocs = pRepo_->Toker()->currentLineCount();slocMap_[pRepo_->package()] = slocs;}
   for (auto file : cppImplemFiles()){
     if (showProc)
       showActivity(file);
     pRepo_->package() = FileSystem::Path::getName(file);
-    if (!configure_.Attach(file)){
+    if (!attachNext(configure_, readAhead, file)){
       std::ostringstream out;out << "\n  could not open file " << file << "\n";
       Rslt::write(out.str());Rslt::flush();
       continue;}
     if (!Rslt::running())
-      Demo::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Demo, "\n\n  opening file \"" + pRepo_->package() + "\"");
     if (!Demo::running() && !Rslt::running())
-      Dbug::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Dbug, "\n\n  opening file \"" + pRepo_->package() + "\"");
     pRepo_->language() = Language::Cpp;pRepo_->currentPath() = file;
-    while (pParser_->next())
-      pParser_->parse();
+    Utilities::RunProfile::Scope timer("parse", file);
+    size_t firstNode = pRepo_->getGlobalScope()->children_.size(), semiExps = 0;
+    while (pParser_->next()){
+      ++semiExps;pParser_->parse();}
+    profileFile(file, semiExps, pRepo_->getGlobalScope()->children_, firstNode);
+    releaseFileTokens(firstNode);
     Slocs slocs = pRepo_->Toker()->currentLineCount();
     slocMap_[pRepo_->package()] = slocs;}
   for (auto file : csharpFiles()){
     if (showProc)
       showActivity(file);
     pRepo_->package() = FileSystem::Path::getName(file);
-    if (!configure_.Attach(file)){
+    if (!attachNext(configure_, readAhead, file)){
       std::ostringstream out;out << "\n  could not open file " << file << "\n";Rslt::write(out.str());continue;}
     if (!Rslt::running())
-      Demo::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Demo, "\n\n  opening file \"" + pRepo_->package() + "\"");
     if (!Demo::running() && !Rslt::running())
-      Dbug::write("\n\n  opening file \"" + pRepo_->package() + "\"");
+      LOG_WRITE(Dbug, "\n\n  opening file \"" + pRepo_->package() + "\"");
     pRepo_->language() = Language::CSharp; pRepo_->currentPath() = file;
-    while (pParser_->next())
-      pParser_->parse();
+    Utilities::RunProfile::Scope timer("parse", file);
+    size_t firstNode = pRepo_->getGlobalScope()->children_.size(), semiExps = 0;
+    while (pParser_->next()){
+      ++semiExps;pParser_->parse();}
+    profileFile(file, semiExps, pRepo_->getGlobalScope()->children_, firstNode);
+    releaseFileTokens(firstNode);
     Slocs slocs = pRepo_->Toker()->currentLineCount();slocMap_[pRepo_->package()] = slocs;}
+  profileRules(*pParser_);
   if (showProc)
     clearActivity();
   std::ostringstream out;out << std::left << "\r  " << std::setw(77) << " ";Rslt::write(out.str());
 }
-//----< evaluate complexities of each AST node >---------------------
+//----< number of nodes in the AST rooted at pNode >-----------------
 
-void CodeAnalysisExecutive::complexityAnalysis()
+static size_t countNodes(ASTNode* pNode)
 {
-  ASTNode* pGlobalScope = pRepo_->getGlobalScope();
-  CodeAnalysis::complexityEval(pGlobalScope);
+  size_t count = 1;
+  for (auto pChild : pNode->children_)
+    count += countNodes(pChild);
+  return count;
 }
-//----< comparison functor for sorting FileToNodeCollection >----
+//----< record counters of a file just parsed, when profiling >------
 /*
-* - supports stable sort on extension values
-* - displayMetrics(...) uses to organize metrics display
+* - nodes[firstNode] onward are the file's top level nodes
+* - bytes and tokens come from the file's tokenCache() entry
+*/
+void CodeAnalysisExecutive::profileFile(const File& file, size_t semiExps, const std::vector<ASTNode*>& nodes, size_t firstNode)
+{
+  Utilities::RunProfile& profile = Utilities::RunProfile::instance();
+  if (!profile.enabled())
+    return;
+  const Scanner::TokenCache::Entry* pEntry = tokenCache_.find(file);
+  if (pEntry != nullptr)
+  {
+    profile.count(file, Utilities::RunProfile::Bytes, pEntry->source.size());
+    profile.count(file, Utilities::RunProfile::Tokens, pEntry->tokens.size());
+  }
+  profile.count(file, Utilities::RunProfile::SemiExps, semiExps);
+  size_t count = 0;
+  for (size_t i = firstNode; i < nodes.size(); ++i)
+    count += countNodes(nodes[i]);
+  profile.count(file, Utilities::RunProfile::AstNodes, count);
+}
+//----< in bounded memory mode, free tokens of the file just parsed >---
+/*
+* - the file's top level nodes are children_[firstNode] onward, and
+*   statements at global scope are the global scope's own
+* - lines, complexity, names and public data text stay in the nodes
+*/
+void CodeAnalysisExecutive::releaseFileTokens(size_t firstNode)
+{
+  if (!boundedMemory_)
+    return;
+  ASTNode* pGlobal = pRepo_->getGlobalScope();
+  for (size_t i = firstNode; i < pGlobal->children_.size(); ++i)
+    ASTReleaseTokens(pGlobal->children_[i]);
+  pGlobal->releaseTokens();
+}
+//----< parse worker: claims files and builds one fragment per file >---
+/*
+* - builds its own parser, whose rules and actions share only this
+*   worker's Repository
+* - after each file the worker's global scope is emptied into the
+*   file's fragment, leaving the worker's AST ready for the next file
+* - if pKeep is not null the worker's AST is pooled and its arena is
+*   spliced into pKeep, so nodes outlive the worker's Repository
+* - text and tokens of each file go to pCache, which is thread safe
+* - with releaseTokens, each file's statement and declaration tokens are
+*   freed before its fragment is handed on
+* - if parsed is callable, each fragment gets the lines of its scopes
+*   and parsed(index) is called once the worker is done with the file
+* - ruleOrderPeriod > 0 orders the worker's rules by cost, and its rule
+*   stats are added to the profile when it's done
+*/
+static void parseFiles(const Files& files, std::vector<ParseFragment>& fragments, std::atomic<size_t>& next, ASTArena* pKeep,
+  Scanner::TokenCache* pCache, bool releaseTokens, size_t ruleOrderPeriod, const std::function<void(size_t)>& parsed = nullptr)
+{
+  Utilities::Trace::instance().nameThread("parse worker");
+  Utilities::MemoryProfile::Subsystem tag("parser");
+  ConfigParseForCodeAnal configure;
+  Parser* pParser = configure.Build();
+  if (pParser == nullptr)
+    return;
+  configure.useTokenCache(pCache);
+  configureRules(pParser, ruleOrderPeriod);
+  Repository* pRepo = configure.repository();
+  if (pKeep != nullptr)
+    pRepo->AST().enablePool();
+  ASTNode* pGlobal = pRepo->getGlobalScope();
+  size_t index;
+  while ((index = next++) < files.size())
+  {
+    const File& file = files[index];
+    ParseFragment& frag = fragments[index];
+    pRepo->package() = FileSystem::Path::getName(file);
+    if (!configure.Attach(file))
+    {
+      if (parsed)
+        parsed(index);
+      continue;
+    }
+    frag.opened = true;
+    std::string ext = FileSystem::Path::getExt(file);
+    pRepo->language() = (ext == "cs") ? Language::CSharp : Language::Cpp;
+    pRepo->currentPath() = file;
+    Utilities::RunProfile::Scope timer("parse", file);
+    while (pParser->next())
+    {
+      ++frag.semiExps;
+      pParser->parse();
+    }
+    frag.slocs = pRepo->Toker()->currentLineCount();
+
+    while (pRepo->scopeStack().size() > 1)
+      complexityClose(pRepo->scopeStack().pop());  // scopes the file didn't close
+    if (releaseTokens)
+      ASTReleaseTokens(pGlobal);
+    frag.nodes.swap(pGlobal->children_);
+    frag.decls.swap(pGlobal->decl_);
+    frag.statements.swap(pGlobal->statements_);
+    frag.types.swap(pRepo->AST().typeMap());
+    frag.relocations.swap(pRepo->relocations());
+    for (auto& reloc : frag.relocations)
+    {
+      if (reloc.pParent == pGlobal)
+        reloc.pParent = nullptr;  // will be relinked under executive's global scope
+    }
+    if (parsed)
+    {
+      std::vector<ASTNode*> stack(frag.nodes.begin(), frag.nodes.end());
+      while (!stack.empty())
+      {
+        ASTNode* pNode = stack.back();
+        stack.pop_back();
+        if (pNode->endLineCount_ > pNode->startLineCount_ && !pNode->path_.str().empty())
+          frag.scopes.push_back(std::make_pair(pNode->startLineCount_, pNode->endLineCount_));
+        stack.insert(stack.end(), pNode->children_.begin(), pNode->children_.end());
+      }
+      parsed(index);
+    }
+  }
+  profileRules(*pParser);
+  if (pKeep != nullptr)
+    pKeep->splice(*pRepo->AST().arena());
+}
+//----< parses files on worker threads and grafts results into AST >--
+/*
+* - same files, in the same order, as processSourceCode(...)
+* - fragments are grafted in that order so the AST and typeMap match
+*   what the serial loops produce
+* - member functions whose class lived in another file are relinked
+*   once every fragment's types are in the typeMap
+*/
+void CodeAnalysisExecutive::processSourceCodeParallel(bool showProc, size_t numThreads)
+{
+  Files files = allSourceFiles();
+  std::vector<ParseFragment> fragments(files.size());
+  parseOnWorkers(files, fragments, numThreads, showProc);
+  graftFragments(files, fragments);
+  if (showProc)
+    clearActivity();
+  std::ostringstream out; out << std::left << "\r  " << std::setw(77) << " "; Rslt::write(out.str());
+}
+//----< parses files into fragments on numThreads workers, 0 for all cores >--
+/*
+* - fragments has one element per file, filled in files' order
+* - when the AST is pooled, workers' arenas are spliced into its arena
+*/
+void CodeAnalysisExecutive::parseOnWorkers(const Files& files, std::vector<ParseFragment>& fragments, size_t numThreads, bool showProc)
+{
+  if (numThreads == 0)
+    numThreads = std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 1;
+  if (numThreads > files.size())
+    numThreads = files.size() > 0 ? files.size() : 1;
+  if (showProc)
+    showActivity("parsing " + Utilities::Converter<size_t>::toString(files.size()) + " files on "
+      + Utilities::Converter<size_t>::toString(numThreads) + " threads");
+
+  std::atomic<size_t> next(0);
+  ASTArena* pArena = pRepo_->AST().arena();
+  std::vector<std::unique_ptr<ASTArena>> keep;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < numThreads; ++i)
+  {
+    keep.push_back(std::unique_ptr<ASTArena>(pArena != nullptr ? new ASTArena : nullptr));
+    workers.push_back(std::thread(parseFiles, std::cref(files), std::ref(fragments), std::ref(next), keep.back().get(), &tokenCache_, boundedMemory_, ruleOrderPeriod_, nullptr));
+  }
+  for (auto& worker : workers)
+    worker.join();
+  for (auto& pKeep : keep)
+  {
+    if (pKeep)
+      pArena->splice(*pKeep);
+  }
+}
+//----< restores unchanged files' fragments from ast.cache, parses the rest >--
+/*
+* - a file is unchanged if its text hashes as it did when it was cached,
+*   or as another cached file does, e.g., its copy in another branch
+* - of changed files with the same text only the first is parsed, the
+*   others are restored from its fragment once it is cached
+* - changed and new files are parsed on all cores with /p, else on one
+*   worker, and their fragments are cached before grafting relinks
+*   member functions across fragments
+* - the cache keeps files in this run, and with /i files that weren't
+*   changed and so aren't in the run, but are still in the repository
 */
-struct CompExts
+void CodeAnalysisExecutive::processSourceCodeCached(bool showProc)
 {
-  bool operator()(const std::pair<File, ASTNode*>& first, const std::pair<File, ASTNode*>& second)
+  Files files = allSourceFiles();
+  File cacheFile = getAnalysisPath() + "\\ast.cache";
+  astCache_.load(cacheFile);
+  std::vector<ParseFragment> fragments(files.size());
+  std::vector<std::string> hashes(files.size());
+  Files changed;
+  std::vector<size_t> where, copies;
+  std::unordered_set<std::string> parsing;
+  contentHashes_.clear();
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    std::string text;
+    if (Scanner::Toker::readFile(files[i], text))
+    {
+      hashes[i] = PublishManifest::textHash(text);
+      contentHashes_[Scanner::TokenCache::key(files[i])] = hashes[i];
+      if (astCache_.restore(files[i], hashes[i], fragments[i], pRepo_->AST()))
+        continue;
+      if (!parsing.insert(hashes[i]).second)
+      {
+        copies.push_back(i);
+        continue;
+      }
+    }
+    changed.push_back(files[i]);
+    where.push_back(i);
+  }
+  std::ostringstream restored;
+  restored << "\n  AST cache: " << files.size() - changed.size() - copies.size() << " of " << files.size()
+    << " files restored, " << copies.size() << " share the text of a file parsed";
+  Rslt::write(restored.str());
+
+  for (size_t round = 0; round < 2 && changed.size() > 0; ++round)
   {
-    return FileSystem::Path::getExt(first.first) > FileSystem::Path::getExt(second.first);
+    std::vector<ParseFragment> parsed(changed.size());
+    parseOnWorkers(changed, parsed, parallelParse_ ? 0 : 1, showProc);
+    for (size_t j = 0; j < changed.size(); ++j)
+    {
+      if (parsed[j].opened && hashes[where[j]] != "")
+        astCache_.store(changed[j], hashes[where[j]], parsed[j]);
+      fragments[where[j]] = std::move(parsed[j]);
+    }
+    changed.clear();
+    where.clear();
+    for (size_t i : copies)
+    {
+      if (!astCache_.restore(files[i], hashes[i], fragments[i], pRepo_->AST()))
+      {
+        changed.push_back(files[i]);
+        where.push_back(i);
+      }
+    }
+    copies.clear();
   }
+  graftFragments(files, fragments);
+  std::unordered_set<File> inRun(files.begin(), files.end());
+  astCache_.keepOnly([&](const File& file) {
+    return inRun.count(file) > 0 || (incremental_ && inventory_.exists(file));
+  });
+  if (!astCache_.save(cacheFile))
+    Rslt::write("\n  could not write " + cacheFile);
+  if (showProc)
+    clearActivity();
+  std::ostringstream out; out << std::left << "\r  " << std::setw(77) << " "; Rslt::write(out.str());
+}
+//----< fill slocMap_ with each file's line count, without parsing >--
+/*
+* - the same counts, by file name, that the parse loops take from the
+*   tokenizer, which counts the newlines it reads
+* - files are memory mapped and counted on numThreads workers, 0 for
+*   all cores, a file that can't be opened counts 0 lines, as displaySlocs
+*   shows a file the parse loops couldn't open
+*/
+void CodeAnalysisExecutive::countSourceLines(bool showProc, size_t numThreads)
+{
+  Files files = allSourceFiles();
+  if (showProc)
+    showActivity("counting lines of " + Utilities::Converter<size_t>::toString(files.size()) + " files");
+  std::vector<size_t> lines;
+  size_t failed = LineCounter::countFiles(files, lines, numThreads);
+  for (size_t i = 0; i < files.size(); ++i)
+    slocMap_[FileSystem::Path::getName(files[i])] = lines[i];
+  if (showProc)
+    clearActivity();
+  if (failed > 0)
+  {
+    std::ostringstream out;
+    out << "\n  could not open " << failed << " files\n";
+    Rslt::write(out.str());
+  }
+}
+//----< headers, then implementations, then C# files >---------------
+
+Files CodeAnalysisExecutive::allSourceFiles()
+{
+  Files files;
+  for (auto file : cppHeaderFiles())
+    files.push_back(file);
+  for (auto file : cppImplemFiles())
+    files.push_back(file);
+  for (auto file : csharpFiles())
+    files.push_back(file);
+  return files;
+}
+//----< add fragments to the AST in file order, then relink members >--
+
+void CodeAnalysisExecutive::graftFragments(const Files& files, std::vector<ParseFragment>& fragments)
+{
+  Utilities::MemoryProfile::Subsystem tag("AST");
+  ASTNode* pGlobal = pRepo_->getGlobalScope();
+  Repository::Relocations relocations;
+  for (size_t i = 0; i < files.size(); ++i)
+  {
+    ParseFragment& frag = fragments[i];
+    if (!frag.opened)
+    {
+      std::ostringstream out; out << "\n  could not open file " << files[i] << "\n";
+      Rslt::write(out.str());
+      continue;
+    }
+    for (auto pNode : frag.nodes)
+    {
+      pNode->pParent_ = pGlobal;
+      pGlobal->children_.push_back(pNode);
+    }
+    for (auto& decl : frag.decls)
+      pGlobal->decl_.push_back(decl);
+    for (auto pTc : frag.statements)
+      pGlobal->statements_.push_back(pTc);
+    pGlobal->releasedStatements_ += frag.releasedStatements;
+    for (auto& type : frag.types)
+      pRepo_->AST().typeMap()[type.first] = type.second;
+    for (auto& reloc : frag.relocations)
+    {
+      if (reloc.pParent == nullptr)
+        reloc.pParent = pGlobal;
+      relocations.push_back(reloc);
+    }
+    slocMap_[FileSystem::Path::getName(files[i])] = frag.slocs;
+    profileFile(files[i], frag.semiExps, frag.nodes, 0);
+  }
+  for (auto& reloc : relocations)
+  {
+    ASTNode* pClassNode = pRepo_->AST().find(reloc.className);
+    if (pClassNode == nullptr)
+      continue;
+    std::vector<ASTNode*>& siblings = reloc.pParent->children_;
+    auto iter = std::find(siblings.begin(), siblings.end(), reloc.pFunction);
+    if (iter == siblings.end())
+      continue;
+    siblings.erase(iter);                            // unlink function
+    pClassNode->children_.push_back(reloc.pFunction); // relink function
+    complexityReparent(reloc.pFunction, pClassNode);
+  }
+}
+
+namespace
+{
+  using Clock = std::chrono::steady_clock;
+
+  const size_t StopRendering = static_cast<size_t>(-1);
+
+  double millis(Clock::time_point from, Clock::time_point to)
+  {
+    return std::chrono::duration<double, std::milli>(to - from).count();
+  }
+
+  double percent(double part, double whole)
+  {
+    return whole > 0 ? 100.0 * part / whole : 0.0;
+  }
+  //----< what the workers of one pipeline stage spent their time on >--
+  /*
+  * - each worker reports once, when it is done
+  * - busy is a worker's active time less its waits, blocked is time
+  *   waiting for room in the next stage's queue, and starved is the rest
+  *   of workers x wall, waiting for input or for the stage to end
+  */
+  class StageMeter
+  {
+  public:
+    void start(size_t workers) { workers_ = workers; start_ = Clock::now(); }
+    void stop() { wall_ = millis(start_, Clock::now()); }
+    void report(double active, double starved, double blocked, size_t items)
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      busy_ += active - starved - blocked;
+      blocked_ += blocked;
+      items_ += items;
+    }
+    size_t workers() const { return workers_; }
+    size_t items() const { return items_; }
+    double wall() const { return wall_; }
+    double busy() const { return busy_; }
+    double blocked() const { return blocked_; }
+    double starved() const { return (std::max)(0.0, wall_ * workers_ - busy_ - blocked_); }
+  private:
+    std::mutex mtx_;
+    Clock::time_point start_;
+    size_t workers_ = 0;
+    size_t items_ = 0;
+    double wall_ = 0;
+    double busy_ = 0;
+    double blocked_ = 0;
+  };
+}
+
+struct CodeAnalysisExecutive::Pipeline
+{
+  explicit Pipeline(size_t capacity) : renderQ(capacity), grafted(Clock::now()) {}
+  Files files;
+  std::vector<ParseFragment> fragments;
+  Async::BlockingQueue<size_t> renderQ;   // indices of parsed files to render
+  std::vector<std::thread> renderers;
+  StageMeter parse;
+  StageMeter render;
+  Clock::time_point grafted;              // when the parse barrier was passed
 };
-//----< comparison functor for sorting FileToNodeCollection >----
+//----< parse and render at the same time, analysis after a barrier >--
 /*
-* - supports stable sort on name values
-* - displayMetrics(...) uses these functions to organize metrics display
+* - parse workers hand each file publishes(file) accepts, with the
+*   lines of its scopes, to render workers through a bounded queue, so
+*   parsing waits when rendering falls behind instead of queueing every
+*   file
+* - the type table needs every file's types, so fragments are grafted
+*   only when all parse workers are done
+* - renderers are still running on return, analysis of the AST overlaps
+*   them until finishRendering()
+* - returns the files handed to the renderers
 */
+Files CodeAnalysisExecutive::processSourceCodePipelined(bool showProc, const PageFilter& publishes, const PageRenderer& render, size_t numThreads)
+{
+  finishRendering();
+  if (pooledAST_ && !pRepo_->AST().enablePool())
+    Rslt::write("\n  AST already has nodes, not pooling");
+  if (numThreads == 0)
+    numThreads = std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 1;
+  size_t renderThreads = (std::max)(numThreads / 2, (size_t)1);
+  pPipeline_.reset(new Pipeline(2 * renderThreads));
+  Pipeline& pipe = *pPipeline_;
+  pipe.files = allSourceFiles();
+  pipe.fragments.resize(pipe.files.size());
+  if (numThreads > pipe.files.size())
+    numThreads = pipe.files.size() > 0 ? pipe.files.size() : 1;
+
+  Files pages;
+  std::vector<char> isPage(pipe.files.size(), 0);
+  for (size_t i = 0; i < pipe.files.size(); ++i)
+  {
+    if (!publishes(pipe.files[i]))
+      continue;
+    isPage[i] = 1;
+    pages.push_back(pipe.files[i]);
+  }
+  if (showProc)
+    showActivity("parsing " + Utilities::Converter<size_t>::toString(pipe.files.size()) + " files on "
+      + Utilities::Converter<size_t>::toString(numThreads) + " threads, rendering on "
+      + Utilities::Converter<size_t>::toString(renderThreads));
+
+  pipe.render.start(renderThreads);
+  for (size_t i = 0; i < renderThreads; ++i)
+  {
+    pipe.renderers.push_back(std::thread([&pipe, render]() {
+      Utilities::Trace::instance().nameThread("renderer");
+      Clock::time_point begin = Clock::now();
+      double starved = 0;
+      size_t items = 0;
+      while (true)
+      {
+        Clock::time_point wait = Clock::now();
+        size_t index = pipe.renderQ.deQ();
+        Clock::time_point woke = Clock::now();
+        starved += millis(wait, woke);
+        Utilities::Trace::instance().record("queue", "render queue wait", wait, woke);
+        if (index == StopRendering)
+          break;
+        render(pipe.files[index], pipe.fragments[index].scopes);
+        ++items;
+      }
+      pipe.render.report(millis(begin, Clock::now()), starved, 0, items);
+    }));
+  }
+
+  pipe.parse.start(numThreads);
+  std::atomic<size_t> next(0);
+  ASTArena* pArena = pRepo_->AST().arena();
+  std::vector<std::unique_ptr<ASTArena>> keep;
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < numThreads; ++i)
+  {
+    keep.push_back(std::unique_ptr<ASTArena>(pArena != nullptr ? new ASTArena : nullptr));
+    ASTArena* pKeep = keep.back().get();
+    workers.push_back(std::thread([this, &pipe, &next, &isPage, pKeep]() {
+      Clock::time_point begin = Clock::now();
+      double blocked = 0;
+      size_t items = 0;
+      std::function<void(size_t)> handOff = [&](size_t index) {
+        ++items;
+        if (!isPage[index])
+          return;
+        Clock::time_point wait = Clock::now();
+        pipe.renderQ.enQ(index);
+        Clock::time_point queued = Clock::now();
+        blocked += millis(wait, queued);
+        Utilities::Trace::instance().record("queue", "render queue full", wait, queued);
+      };
+      parseFiles(pipe.files, pipe.fragments, next, pKeep, &tokenCache_, boundedMemory_, ruleOrderPeriod_, handOff);
+      pipe.parse.report(millis(begin, Clock::now()), 0, blocked, items);
+    }));
+  }
+  for (auto& worker : workers)
+    worker.join();
+  pipe.parse.stop();
+  for (size_t i = 0; i < renderThreads; ++i)
+    pipe.renderQ.enQ(StopRendering);
+
+  for (auto& pKeep : keep)
+  {
+    if (pKeep)
+      pArena->splice(*pKeep);
+  }
+  graftFragments(pipe.files, pipe.fragments);
+  pipe.grafted = Clock::now();
+  if (showProc)
+    clearActivity();
+  std::ostringstream out; out << std::left << "\r  " << std::setw(77) << " "; Rslt::write(out.str());
+  return pages;
+}
+//----< wait for the renderers, then show how busy each stage was >--
+/*
+* - analysis is the time from the parse barrier to this call, spent
+*   on complexity, the type table and dependencies while pages render
+* - barrier wait is how long analysis then waited for the renderers
+*/
+void CodeAnalysisExecutive::finishRendering()
+{
+  if (!pPipeline_)
+    return;
+  Pipeline& pipe = *pPipeline_;
+  Clock::time_point arrived = Clock::now();
+  for (auto& renderer : pipe.renderers)
+    renderer.join();
+  pipe.render.stop();
+  double analysis = millis(pipe.grafted, arrived);
+  double barrier = millis(arrived, Clock::now());
+
+  std::ostringstream out;
+  out << std::fixed << std::setprecision(1);
+  out << "\n  pipeline stage   workers    items     wall ms    busy  starved  blocked";
+  auto show = [&out](const std::string& name, const StageMeter& stage) {
+    double whole = stage.wall() * stage.workers();
+    out << "\n  " << std::left << std::setw(14) << name << std::right
+      << std::setw(10) << stage.workers() << std::setw(9) << stage.items() << std::setw(12) << stage.wall()
+      << std::setw(7) << percent(stage.busy(), whole) << "%"
+      << std::setw(8) << percent(stage.starved(), whole) << "%"
+      << std::setw(8) << percent(stage.blocked(), whole) << "%";
+  };
+  show("parse", pipe.parse);
+  show("render", pipe.render);
+  out << "\n  " << std::left << std::setw(14) << "analysis" << std::right
+    << std::setw(10) << 1 << std::setw(9) << "-" << std::setw(12) << analysis;
+  out << "\n  waited " << barrier << " ms at the render barrier\n";
+  std::cout << out.str();
+
+  Utilities::RunProfile& profile = Utilities::RunProfile::instance();
+  if (profile.enabled())
+  {
+    profile.time("pipeline/parse", pipe.parse.wall());
+    profile.time("pipeline/parse/busy", pipe.parse.busy());
+    profile.time("pipeline/parse/blocked", pipe.parse.blocked());
+    profile.time("pipeline/render", pipe.render.wall());
+    profile.time("pipeline/render/busy", pipe.render.busy());
+    profile.time("pipeline/render/starved", pipe.render.starved());
+    profile.time("pipeline/analysis", analysis);
+    profile.time("pipeline/barrier", barrier);
+  }
+  pPipeline_.reset();
+}
+//----< finish complexities of each AST node >-----------------------
+/*
+*  - scopes get their complexities as they end during the parse, those
+*    still on the scope stack, the global scope and any a file left
+*    open, get theirs now
+*  - with /v, every complexity is evaluated again with a walk of the
+*    whole AST and the nodes that differ are reported
+*/
+void CodeAnalysisExecutive::complexityAnalysis()
+{
+  ASTNode* pGlobalScope = pRepo_->getGlobalScope();
+  ScopeStack<ASTNode*>& stack = pRepo_->scopeStack();
+  for (auto iter = stack.end(); iter != stack.begin(); )
+  {
+    if (*--iter != pGlobalScope)
+      complexityClose(*iter);
+  }
+  complexityClose(pGlobalScope);
+  if (!checkComplexity_)
+    return;
+
+  std::unordered_map<ASTNode*, size_t> incremental;
+  ASTWalkNoIndent(pGlobalScope, [&incremental](ASTNode* pNode) { incremental[pNode] = pNode->complexity_; });
+  if (parallelParse_)
+    CodeAnalysis::complexityEvalParallel(pGlobalScope);
+  else
+    CodeAnalysis::complexityEval(pGlobalScope);
+  size_t differ = 0;
+  for (auto& item : incremental)
+  {
+    if (item.first->complexity_ != item.second)
+      ++differ;
+  }
+  std::ostringstream out;
+  out << "\n  complexity check: " << differ << " of " << incremental.size() << " nodes differ from a full walk";
+  Rslt::write(out.str());
+}
+//----< remove extension from a file name >-------------------------
+
 static void removeExt(std::string& name)
 {
   size_t extStartIndex = name.find_last_of('.');
   name = name.substr(0, extStartIndex);
 }
-
-struct CompNames
+//----< order nodes by file name, then extension descending >--------
+/*
+* - displayMetrics(...) uses to organize metrics display
+* - same order as stable sorts on extension, then on name without
+*   extension, but the names are split once per package instead of
+*   on every comparison: packages are ranked, then the nodes are
+*   placed by rank with a counting sort, which keeps nodes of one
+*   package in walk order
+*/
+static void sortByFile(std::vector<ASTNode*>& nodes)
 {
-  bool operator()(const std::pair<File, ASTNode*>& first, const std::pair<File, ASTNode*>& second)
+  struct Package { Symbol symbol; std::string name; std::string ext; size_t rank; };
+  std::unordered_map<Symbol::Id, size_t> index;
+  std::vector<Package> packages;
+  for (auto pNode : nodes)
   {
-    std::string fnm = FileSystem::Path::getName(first.first);
-    removeExt(fnm);
-    std::string snm = FileSystem::Path::getName(second.first);
-    removeExt(snm);
-    return fnm < snm;
+    if (index.find(pNode->package_.id()) != index.end())
+      continue;
+    index[pNode->package_.id()] = packages.size();
+    const std::string& file = pNode->package_.str();
+    std::string name = FileSystem::Path::getName(file);
+    removeExt(name);
+    packages.push_back(Package{ pNode->package_, name, FileSystem::Path::getExt(file), 0 });
   }
-};
+  std::vector<size_t> order(packages.size());
+  for (size_t i = 0; i < order.size(); ++i)
+    order[i] = i;
+  std::sort(order.begin(), order.end(), [&packages](size_t first, size_t second) {
+    const Package& p1 = packages[first];
+    const Package& p2 = packages[second];
+    if (p1.name != p2.name)
+      return p1.name < p2.name;
+    if (p1.ext != p2.ext)
+      return p1.ext > p2.ext;
+    return first < second;
+  });
+  for (size_t i = 0; i < order.size(); ++i)
+    packages[order[i]].rank = i;
+
+  std::vector<size_t> starts(packages.size() + 1, 0);
+  std::vector<size_t> ranks(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i)
+  {
+    ranks[i] = packages[index[nodes[i]->package_.id()]].rank;
+    ++starts[ranks[i] + 1];
+  }
+  for (size_t i = 1; i < starts.size(); ++i)
+    starts[i] += starts[i - 1];
+  std::vector<ASTNode*> sorted(nodes.size());
+  for (size_t i = 0; i < nodes.size(); ++i)
+    sorted[starts[ranks[i]]++] = nodes[i];
+  nodes.swap(sorted);
+}
+//----< hand a report's buffered lines to the logger in large pieces >--
+
+static void writeReport(std::ostringstream& out, bool done)
+{
+  if (!done && out.tellp() < std::streamoff(64 * 1024))
+    return;
+  Rslt::write(out.str());
+  out.str("");
+}
 //----< display header line for displayMmetrics() >------------------
 
-void CodeAnalysisExecutive::displayHeader()
+void CodeAnalysisExecutive::displayHeader(std::ostream& out)
 {
-  std::ostringstream out;
   out << std::right;
   out << "\n ";
   out << std::setw(25) << "file name";
@@ -471,28 +1266,20 @@ void CodeAnalysisExecutive::displayHeader()
   out << std::setw(8) << "------";
   out << std::setw(8) << "------";
   out << std::setw(8) << "------";
-  Rslt::write(out.str());
 }
 //----< display single line for displayMetrics() >-------------------
 
-void CodeAnalysisExecutive::displayMetricsLine(const File& file, ASTNode* pNode)
+void CodeAnalysisExecutive::displayMetricsLine(std::ostream& out, ASTNode* pNode)
 {
-  std::function<std::string(std::string, size_t)> trunc = [](std::string in, size_t count)
-  {
-    return in.substr(0, count);
-  };
-  std::ostringstream out;
+  const File& file = pNode->package_.str();
   out << std::right;
   out << "\n ";
-  out << std::setw(25) << trunc(file, 23);
+  out << std::setw(25) << file.substr(0, 23);
   out << std::setw(12) << pNode->type_;
-  out << std::setw(35) << trunc(pNode->name_, 33);
+  out << std::setw(35) << pNode->name_.substr(0, 33);
   out << std::setw(8) << pNode->startLineCount_;
   out << std::setw(8) << pNode->endLineCount_ - pNode->startLineCount_ + 1;
-  size_t debug1 = pNode->startLineCount_;
-  size_t debug2 = pNode->endLineCount_;
   out << std::setw(8) << pNode->complexity_;
-  Rslt::write(out.str());
 }
 //----< display lines containing public data declaration >-----------
 
@@ -504,17 +1291,16 @@ std::string CodeAnalysisExecutive::showData(const Scanner::ITokCollection* pTc)
   return semiExpStr;
 }
 
-void CodeAnalysisExecutive::displayDataLines(ASTNode* pNode, bool isSummary)
+void CodeAnalysisExecutive::displayDataLines(std::ostream& out, ASTNode* pNode, bool isSummary)
 {
   for (auto datum : pNode->decl_)
   {
-    if (pNode->parentType_ == "namespace" || pNode->parentType_ == "class" || pNode->parentType_ == "struct")
+    if (pNode->parentType_ == namespaceType || pNode->parentType_ == classType || pNode->parentType_ == structType)
     {
-      if (pNode->type_ == "function" || pNode->parentType_ == "function")
+      if (pNode->type_ == functionType || pNode->parentType_ == functionType)
         continue;
       if (datum.access_ == Access::publ && datum.declType_ == DeclType::dataDecl)
       {
-        std::ostringstream out;
         out << std::right;
         out << "\n ";
         out << std::setw(25) << "public data:" << " ";
@@ -523,8 +1309,7 @@ void CodeAnalysisExecutive::displayDataLines(ASTNode* pNode, bool isSummary)
           out << datum.package_ << " : " << datum.line_ << " - "
             << pNode->type_ << " " << pNode->name_ << "\n " << std::setw(15) << " ";
         }
-        out << showData(datum.pTc);
-        Rslt::write(out.str());
+        out << (datum.pTc ? showData(datum.pTc) : datum.text_);
       }
     }
   }
@@ -545,34 +1330,36 @@ void CodeAnalysisExecutive::displayMetrics(ASTNode* root)
 
   std::function<void(ASTNode* pNode)> co = [&](ASTNode* pNode) {
     if (
-      pNode->type_ == "namespace" ||
-      pNode->type_ == "function" ||
-      pNode->type_ == "class" ||
-      pNode->type_ == "interface" ||
-      pNode->type_ == "struct" ||
-      pNode->type_ == "lambda"
+      pNode->type_ == namespaceType ||
+      pNode->type_ == functionType ||
+      pNode->type_ == classType ||
+      pNode->type_ == interfaceType ||
+      pNode->type_ == structType ||
+      pNode->type_ == lambdaType
       )
-      fileNodes_.push_back(std::pair<File, ASTNode*>(pNode->package_, pNode));
+      fileNodes_.push_back(pNode);
   };
   ASTWalkNoIndent(root, co);
-  std::stable_sort(fileNodes_.begin(), fileNodes_.end(), CompExts());
-  std::stable_sort(fileNodes_.begin(), fileNodes_.end(), CompNames());
+  sortByFile(fileNodes_);
 
-  displayHeader();
+  out.str("");
+  displayHeader(out);
 
-  std::string prevFile;
-  for (auto item : fileNodes_)
+  Symbol prevFile;
+  for (auto pNode : fileNodes_)
   {
-    if (item.first != prevFile)
+    if (pNode->package_ != prevFile)
     {
-      Rslt::write("\n");
-      displayHeader();
+      out << "\n";
+      displayHeader(out);
     }
-    displayMetricsLine(item.first, item.second);
-    displayDataLines(item.second);
-    prevFile = item.first;
+    displayMetricsLine(out, pNode);
+    displayDataLines(out, pNode);
+    prevFile = pNode->package_;
+    writeReport(out, false);
   }
-  Rslt::write("\n");
+  out << "\n";
+  writeReport(out, true);
 }
 //----< display metrics results of code analysis >---------------
 
@@ -587,23 +1374,16 @@ template<typename element>
 void TreeWalk(element* pItem, bool details = false)
 {
   static std::string path;
-  if (path != pItem->path_ && details == true)
+  if (path != pItem->path_.str() && details == true)
   {
-    path = pItem->path_;
+    path = pItem->path_.str();
     Rslt::write("\n" + path);
   }
-  static size_t indentLevel = 0;
-  std::ostringstream out;
-  out << "\n  " << std::string(2 * indentLevel, ' ') << pItem->show();
-  Rslt::write(out.str());
-  auto iter = pItem->children_.begin();
-  ++indentLevel;
-  while (iter != pItem->children_.end())
-  {
-    TreeWalk(*iter);
-    ++iter;
-  }
-  --indentLevel;
+  ASTWalk(pItem, [](element* pNode, size_t indentLevel) {
+    std::ostringstream out;
+    out << "\n  " << std::string(2 * indentLevel, ' ') << pNode->show();
+    Rslt::write(out.str());
+  });
 }
 //----< display the AbstrSynTree build in processSourceCode() >------
 
@@ -623,34 +1403,37 @@ void CodeAnalysisExecutive::displayMetricSummary(size_t sMax, size_t cMax)
   std::ostringstream out;
   Utils::sTitle("Functions Exceeding Metric Limits and Public Data", 3, 92, out, '=');
   Rslt::write(out.str());
-  displayHeader();
+  out.str("");
+  displayHeader(out);
 
   if (fileNodes_.size() == 0)  // only build fileNodes_ if displayMetrics hasn't been called
   {
     std::function<void(ASTNode* pNode)> co = [&](ASTNode* pNode) {
-      fileNodes_.push_back(std::pair<File, ASTNode*>(pNode->package_, pNode));
+      fileNodes_.push_back(pNode);
     };
     ASTNode* pGlobalNamespace = pRepo_->getGlobalScope();
     ASTWalkNoIndent(pGlobalNamespace, co);
-    std::stable_sort(fileNodes_.begin(), fileNodes_.end(), CompExts());
-    std::stable_sort(fileNodes_.begin(), fileNodes_.end(), CompNames());
+    sortByFile(fileNodes_);
   }
-  for (auto item : fileNodes_)
+  for (auto pNode : fileNodes_)
   {
-    if (item.second->type_ == "function")
+    if (pNode->type_ == functionType)
     {
-      size_t size = item.second->endLineCount_ - item.second->startLineCount_ + 1;
-      size_t cmpl = item.second->complexity_;
+      size_t size = pNode->endLineCount_ - pNode->startLineCount_ + 1;
+      size_t cmpl = pNode->complexity_;
       if (size > sMax || cmpl > cMax)
-        displayMetricsLine(item.first, item.second);
+        displayMetricsLine(out, pNode);
     }
+    writeReport(out, false);
   }
-  Rslt::write("\n");
-  for (auto item : fileNodes_)
+  out << "\n";
+  for (auto pNode : fileNodes_)
   {
-    displayDataLines(item.second, true);
+    displayDataLines(out, pNode, true);
+    writeReport(out, false);
   }
-  Rslt::write("\n");
+  out << "\n";
+  writeReport(out, true);
 }
 //----< comparison functor for sorting SLOC display >----------------
 
@@ -745,8 +1528,75 @@ void CodeAnalysisExecutive::setDisplayModes()
     case 'f':
       setLogFile("logFile.txt");
       break;
+    case 'p':
+      parallelParse_ = true;
+      break;
+    case 'o':
+      pipelined_ = true;
+      break;
+    case 'i':
+      incremental_ = true;
+      break;
+    case 'h':
+      sharedAssets_ = true;
+      break;
+    case 'w':
+      scanTypeNames_ = true;
+      break;
+    case 'z':
+      precompress_ = true;
+      break;
+    case 'k':
+      packed_ = true;
+      break;
+    case 'g':
+      generations_ = true;
+      break;
+    case 'q':
+      searchIndex_ = true;
+      break;
+    case 'y':
+      Utilities::MemoryProfile::instance().enable();
+      break;
+    case 'e':
+      Utilities::Trace::instance().enable();
+      Utilities::Trace::instance().nameThread("main");
+      break;
+    case 'n':
+      pooledAST_ = true;
+      break;
+    case 'c':
+      boundedMemory_ = true;
+      break;
+    case 'x':
+      cachedAST_ = true;
+      break;
+    case 'v':
+      checkComplexity_ = true;
+      break;
+    case 'j':
+      slocsOnly_ = true;
+      break;
+    case 'R':
+      ruleOrderPeriod_ = 256;
+      break;
+    case 'Q':
+      quickPublish_ = true;
+      break;
+    case 't':
+      Utilities::RunProfile::instance().enable();
+      break;
+    case 'l':
+      Utilities::RunProfile::instance().enable();
+      Utilities::RunProfile::instance().live([](const std::string& line) {
+        if (Rslt::running())
+          Rslt::write(line);
+        else
+          std::cout << line;
+      });
+      break;
     default:
-      if (opt != 'a' && opt != 'b' && opt != 'd' && opt != 'f' && opt != 'm' && opt != 'r' && opt != 's')
+      if (opt != 'a' && opt != 'b' && opt != 'c' && opt != 'd' && opt != 'e' && opt != 'f' && opt != 'g' && opt != 'h' && opt != 'i' && opt != 'j' && opt != 'k' && opt != 'l' && opt != 'm' && opt != 'n' && opt != 'o' && opt != 'p' && opt != 'q' && opt != 'r' && opt != 's' && opt != 't' && opt != 'u' && opt != 'v' && opt != 'w' && opt != 'x' && opt != 'y' && opt != 'z' && opt != 'R' && opt != 'Q')
       {
         std::cout << "\n\n  unknown option " << opt << "\n\n";
       }
@@ -773,11 +1623,10 @@ void CodeAnalysisExecutive::flushLogger()
   Dbug::flush();
 }
 
+//----< stop loggers, each writes and flushes what it holds first >---
+
 void CodeAnalysisExecutive::stopLogger()
 {
-  Rslt::flush();
-  Demo::flush();
-  Dbug::flush();
   Rslt::stop();
   Demo::stop();
   Dbug::stop();
@@ -823,6 +1672,66 @@ void DemonstarteRequirements2(){
 	
 }
 
+//----< write profile.json and profile.csv to the analysis path >----
+/*
+* - does nothing unless option /t or /l enabled profiling
+*/
+bool CodeAnalysisExecutive::writeProfile()
+{
+  Utilities::RunProfile& profile = Utilities::RunProfile::instance();
+  if (!profile.enabled())
+    return false;
+  std::string path = getAnalysisPath();
+  bool ok = profile.writeJson(path + "\\profile.json");
+  ok = profile.writeCsv(path + "\\profile.csv") && ok;
+  std::cout << "\n  " << (ok ? "wrote" : "couldn't write") << " profile.json and profile.csv in \"" << path << "\"\n";
+  return ok;
+}
+//----< write trace.json, a Chrome trace, to the analysis path >-----
+/*
+* - does nothing unless option /e enabled tracing
+* - spans are cleared once written, so each run of /u has its own trace
+*/
+bool CodeAnalysisExecutive::writeTrace()
+{
+  Utilities::Trace& trace = Utilities::Trace::instance();
+  if (!trace.enabled())
+    return false;
+  std::string path = getAnalysisPath();
+  bool ok = trace.writeChromeJson(path + "\\trace.json", "CodeAnalyzer", 1);
+  std::cout << "\n  " << (ok ? "wrote" : "couldn't write") << " trace.json in \"" << path << "\"";
+  if (trace.dropped() > 0)
+    std::cout << ", " << trace.dropped() << " spans dropped";
+  std::cout << "\n";
+  trace.clear();
+  return ok;
+}
+
+//----< write memory.json and memory.csv to the analysis path >------
+/*
+* - does nothing unless option /y enabled allocation counting
+* - the summary table is also shown, so nightly logs hold it
+* - counts are cleared once written, so each run of /u has its own
+*/
+bool CodeAnalysisExecutive::writeMemory()
+{
+  Utilities::MemoryProfile& memory = Utilities::MemoryProfile::instance();
+  if (!memory.enabled())
+    return false;
+  if (!memory.hooked())
+  {
+    std::cout << "\n  no allocations counted, this program doesn't link MemoryHooks.cpp\n";
+    return false;
+  }
+  std::string path = getAnalysisPath();
+  std::cout << memory.summary() << "\n";
+  bool ok = memory.writeJson(path + "\\memory.json");
+  ok = memory.writeCsv(path + "\\memory.csv") && ok;
+  std::cout << "\n  " << (ok ? "wrote" : "couldn't write") << " memory.json and memory.csv in \"" << path << "\"\n";
+  memory.clear();
+  return ok;
+}
+
 std::string CodeAnalysisExecutive::systemTime(){ 
   time_t sysTime = time(&sysTime);
   char buffer[27];
@@ -834,9 +1743,15 @@ std::string CodeAnalysisExecutive::systemTime(){
 //----< conduct code analysis >--------------------------------------
 
 #include <fstream>
-//entry point of the application
-int main(int argc, char* argv[]){
-  using namespace CodeAnalysis;
+//----< run one analysis, as main does, reporting each phase >-------
+/*
+* - progress, if callable, is called with each phase's name as it starts,
+*   and with "failed: " and the reason if the analysis throws
+* - used by main and by the resident AnalysisService, which calls it
+*   once per request on its own thread
+*/
+int CodeAnalysis::runAnalysis(int argc, char* argv[], const std::function<void(const std::string&)>& progress){
+  auto phaseStarts = [&progress](const std::string& phase) { if (progress) progress(phase); };
   CodeAnalysisExecutive exec;
   try {
     bool succeeded = exec.ProcessCommandLine(argc, argv);
@@ -844,25 +1759,157 @@ int main(int argc, char* argv[]){
     exec.setDisplayModes();
     exec.startLogger(std::cout);
     exec.showCommandLineArguments(argc, argv);Rslt::write("\n");
-    exec.getSourceFiles();
-    exec.processSourceCode(true);exec.complexityAnalysis();
+    {
+      phaseStarts("scan");
+      Utilities::RunProfile::Scope phase("scan");
+      exec.getSourceFiles();
+      if (exec.incremental())
+        exec.dropUnchangedFiles(exec.getAnalysisPath() + "\\publish.manifest");
+    }
+    if (exec.slocsOnly())
+    {
+      {
+        phaseStarts("count");
+        Utilities::RunProfile::Scope phase("count");
+        exec.countSourceLines(true);
+      }
+      if (!Rslt::running())
+        Rslt::start();
+      exec.displaySlocs();
+      exec.flushLogger();
+      exec.stopLogger();
+      exec.writeProfile();
+      exec.writeTrace();
+      exec.writeMemory();
+      return 0;
+    }
+    TypeAnal ta(*exec.repository());
+    ta.setIncremental(exec.incremental());
+    ta.setSharedAssets(exec.sharedAssets());
+    ta.setScanTypeNames(exec.scanTypeNames());
+    ta.setPrecompress(exec.precompress());
+    ta.setPacked(exec.packed());
+    ta.setGenerations(exec.generations());
+    ta.setSearchIndex(exec.searchIndex());
+    ta.setTokenCache(&exec.tokenCache());
+    ta.setContentHashes(&exec.contentHashes());
+    ta.setInventory(&exec.inventory());
+    if (exec.quickPublish())
+    {
+      phaseStarts("quickPublish");
+      Utilities::RunProfile::Scope phase("quickPublish");
+      ta.quickPublish(argc, argv);
+    }
+    {
+      phaseStarts("parse");
+      Utilities::RunProfile::Scope phase("parse");
+      if (exec.pipelined())
+      {
+        ta.preparePublishing(argv[1]);
+        Files pages = exec.processSourceCodePipelined(true,
+          [&ta](const File& file) { return ta.publishes(file); },
+          [&ta](const File& file, const std::vector<Publisher::Scope>& scopes) { ta.renderPage(file, scopes); });
+        ta.setPrerendered(pages, [&exec]() { exec.finishRendering(); });
+      }
+      else
+        exec.processSourceCode(true);
+    }
+    {
+      phaseStarts("complexity");
+      Utilities::RunProfile::Scope phase("complexity");
+      exec.complexityAnalysis();
+    }
     exec.flushLogger();Rslt::write("\n");
     exec.stopLogger();
 
-    TypeAnal ta;
 	DependencyAnalysis  dep;
-	dep.depResult=ta.dependencyTable(argc, argv);
+	{
+		phaseStarts("dependencyTable");
+		Utilities::RunProfile::Scope phase("dependencyTable");
+		dep.depResult = ta.dependencyTable(argc, argv);
+	}
 	
 	//std::this_thread::sleep_for(std::chrono::seconds(1000));
-	ta.callingPublisher();
-	DemonstraingRequirements();
-	getchar();
+	{
+		phaseStarts("publish");
+		Utilities::RunProfile::Scope phase("publish");
+		ta.callingPublisher();
+	}
+	exec.writeProfile();
+	exec.writeTrace();
+	exec.writeMemory();
   }
   catch (std::exception& except){
     exec.flushLogger();
     std::cout << "\n\n  caught exception in Executive::main: " + std::string(except.what()) + "\n\n";
     exec.stopLogger();
+    phaseStarts("failed: " + std::string(except.what()));
     return 1;
   }
   return 0;
-}
\ No newline at end of file
+}
+//----< analyze and publish again each time files in the path change >--
+/*
+* - the watcher is started first, so changes made during an analysis
+*   are seen by the next wait
+* - one analysis runs at once, to catch up with changes made while no
+*   analyzer was running, then one after each burst of changes
+* - every run has /i, so only files changed since the last run, by their
+*   publish.manifest stamps, are parsed and published
+* - a burst ends debounceMs after its last change, and at most four
+*   windows after its first, so a steady stream still gets published
+*/
+int CodeAnalysis::runDaemon(int argc, char* argv[], size_t debounceMs){
+  if (argc < 3)
+    return runAnalysis(argc, argv);   // shows usage
+  std::vector<std::string> args(argv, argv + argc);
+  std::vector<std::string> patterns;
+  for (size_t i = 2; i < args.size(); ++i)
+  {
+    if (args[i].size() > 0 && args[i][0] != '/')
+      patterns.push_back(args[i]);
+  }
+  if (std::find(args.begin(), args.end(), "/i") == args.end())
+    args.push_back("/i");
+  std::vector<char*> runArgv;
+  for (auto& arg : args)
+    runArgv.push_back(&arg[0]);
+  runArgv.push_back(nullptr);
+  int runArgc = static_cast<int>(args.size());
+
+  FileManager::DirWatcher watcher(FileSystem::Path::getFullFileSpec(argv[1]), patterns);
+  if (!watcher.start())
+  {
+    std::cout << "\n\n  can't watch \"" << argv[1] << "\" for changes\n\n";
+    return 1;
+  }
+  int result = runAnalysis(runArgc, runArgv.data());
+  FileManager::DirWatcher::Changes changes;
+  while (watcher.wait(changes, debounceMs, 4 * debounceMs))
+  {
+    std::cout << "\n\n  " << (changes.overflowed ? std::string("many") : Utilities::Converter<size_t>::toString(changes.files.size()))
+      << " files changed, analyzing again\n";
+    result = runAnalysis(runArgc, runArgv.data());
+  }
+  return result;
+}
+
+#ifndef ANALYSIS_SERVICE
+//entry point of the application
+int main(int argc, char* argv[]){
+  for (int i = 2; i < argc; ++i)
+  {
+    if (std::string(argv[i]) == "/u")
+      return CodeAnalysis::runDaemon(argc, argv);
+    if (std::string(argv[i]) == "/j")
+      return CodeAnalysis::runAnalysis(argc, argv);   // sizes only, nothing to demonstrate
+  }
+  int result = CodeAnalysis::runAnalysis(argc, argv);
+  if (result == 0)
+  {
+    DemonstraingRequirements();
+    getchar();
+  }
+  return result;
+}
+#endif
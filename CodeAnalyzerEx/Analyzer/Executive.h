@@ -38,6 +38,107 @@
 *  - a list of all functions which exceed specified function size and/or
 *    complexity.
 *
+*  With the /p option, files are parsed on a pool of threads.  Each thread
+*  owns its own Toker, SemiExp, Parser, and Repository, and produces one
+*  AST fragment per file.  Fragments are grafted under the Global Namespace
+*  in the same order the serial loops use, then C++ member functions whose
+*  classes were defined in other files are relinked to their class nodes.
+*
+*  With the /o option the phases overlap.  Parse workers hand each file
+*  that will be published, with the scope lines of its AST fragment, to
+*  renderer workers through a bounded queue, so pages are written, and
+*  sent by a waiting server, while other files are still being parsed.
+*  The type table needs every file's types, so grafting waits at a
+*  barrier for all parse workers; type and dependency analysis then run
+*  while the renderers finish, and finishRendering is the barrier before
+*  the batch is announced.  It reports how busy each stage was, and how
+*  long its workers waited for input or for room downstream.
+*
+*  With the /x option, each file's AST fragment is kept in ast.cache in
+*  the analysis path, keyed by the hash of the file's text.  The next run
+*  hashes each file and restores the fragments of unchanged files from
+*  the cache, so only changed files are parsed, on a pool of threads if
+*  /p is given as well.  Restored nodes have their lines, complexities,
+*  statement counts, and declarations, but no statement tokens, as with
+*  /c.  Pipelined runs, /o, don't use the cache.  Files with the same text,
+*  e.g., one file uploaded for several branches, are parsed once, and
+*  dependency analysis scans each distinct text once.
+*
+*  With the /u option, main becomes a daemon.  runDaemon watches the path
+*  with a DirWatcher and, after each burst of changes to files matching
+*  the command line's patterns, e.g. uploads the server wrote into the
+*  Repository, runs the analysis again with /i, so only the files changed
+*  since the last run are parsed and published.  Published pages don't
+*  match the patterns, so they don't start another run.
+*
+*  Complexities are set by the parser as each scope ends.  With the /v
+*  option, complexityAnalysis checks them against a walk of the whole AST
+*  and reports how many nodes differ.
+*
+*  With the /t option, main times each phase and each file's parse, and
+*  counts bytes, tokens, SemiExps, AST nodes, and html bytes written per
+*  file, then writes profile.json and profile.csv to the analysis path.
+*  The /l option does the same and shows each phase's time as it ends.
+*
+*  With the /z option, pages of 1 KB or more are also written
+*  gzip compressed, page.html.gz, so MsgServer sends browsers that accept
+*  gzip the compressed page without compressing it per request.
+*
+*  With the /k option, pages are published into one PagePack under the
+*  path, pages.N.pack and its index pages.index, instead of a file beside
+*  each source, and MsgServer serves them from the mapped pack.
+*
+*  With the /g option, each run's pages are written into a new generation,
+*  generations/N under the path, and pages.current is switched to it once
+*  every page is written, so MsgServer keeps serving the last run's pages
+*  meanwhile.  Pages that weren't rendered again are hard linked forward.
+*
+*  With the /q option, a trigram index of the sources and the symbols the
+*  AST found is kept in search.index under the path, files whose stamp
+*  moved are indexed again each run, and MsgServer answers SEARCH requests
+*  from it without reading every file.
+*
+*  With the /e option, each thread records spans of its work, phases,
+*  each file's parse, scan and page, and its waits on the render queue,
+*  and main writes them to trace.json in the analysis path, which
+*  chrome://tracing and Perfetto show as one row per thread.
+*
+*  With the /y option, heap allocations are counted, bytes allocated,
+*  allocation counts, live bytes and their peak, for each phase main
+*  times and for each subsystem, parser, AST, typeTable, dependencies,
+*  NoSqlDb, publisher and searchIndex, shown as a table at the end of the
+*  run and written to memory.json and memory.csv in the analysis path.
+*
+*  With the /j option, only file sizes are found.  Each file is memory
+*  mapped and its newlines counted by LineCounter, on a pool of threads,
+*  giving the same slocMap_ the tokenizer's line counts do, then the
+*  sizes are shown and the run ends, with no parse, AST, or publishing.
+*
+*  With the /t option, each parser's rule tests are timed too, and each
+*  rule's tests, skips, matches, hit rate and test time go in the profile
+*  with the phases.  With the /R option, upper case as every lower case
+*  letter is in use, each parser orders the rules it may reorder by test
+*  ms per match every 256 SemiExps, see ConfigureParser.cpp for which
+*  rules may move.
+*
+*  The serial parse reads the next source files on a ReadAhead thread, a
+*  few files and a few MB ahead, while the current one is parsed, so the
+*  parser's Toker scans text already in memory instead of waiting on each
+*  open and read, which matters most when the tree is on a network share.
+*
+*  With the /Q option, main publishes a quick batch before anything is
+*  parsed: TypeAnal::quickPublish renders every page without scope tables
+*  or type links, saves each file's quoted #include edges, found by a
+*  line scan, to NoSqlDb, and raises PublishSignal, so a server sends
+*  pages within a scan of the sources.  The full parse and type analysis
+*  then run as before, and their pages and dependencies replace the
+*  quick ones as a second batch.
+*
+*  The Distributed package runs the analysis on several nodes.  Each
+*  worker's executive lists the whole tree, then keepFiles leaves only
+*  its shard to parse, and TypeAnal::analyzeShard publishes the shard
+*  with the type table merged from every worker.
+*
 *  Because much of the important static structure information is contained
 *  in the AST, it is relatively easy to extend the application to evaluate
 *  additional information, such as class relationships, dependency network,
@@ -59,11 +160,91 @@
 *  - ConfigureParser.h, ConfigureParser.cpp
 *  - ScopeStack.h, ScopeStack.cpp, AbstrSynTree.h, AbstrSynTree.cpp
 *  - ITokenCollection.h, SemiExp.h, SemiExp.cpp, Tokenizer.h, Tokenizer.cpp
-*  - IFileMgr.h, FileMgr.h, FileMgr.cpp, FileSystem.h, FileSystem.cpp
-*  - Logger.h, Logger.cpp, Utilities.h, Utilities.cpp
+*  - IFileMgr.h, FileMgr.h, FileMgr.cpp, DirWalker.h, DirWalker.cpp
+*  - DirWatcher.h, DirWatcher.cpp
+*  - FileInventory.h, FileInventory.cpp
+*  - FileSystem.h, FileSystem.cpp
+*  - Logger.h, Logger.cpp, Utilities.h, Utilities.cpp, RunProfile.h, Trace.h
+*  - MemoryProfile.h, MemoryHooks.cpp
+*  - ASTCache.h, ASTCache.cpp, PublishManifest.h, PublishManifest.cpp
+*  - LineCounter.h, LineCounter.cpp, ReadAhead.h, ReadAhead.cpp
 *
 *  Maintanence History:
 *  --------------------
+*  ver 1.27 : 14 Oct 2026
+*  - processSourceCode reads files ahead of the serial parse with ReadAhead
+*  ver 1.26 : 14 Oct 2026
+*  - added the /Q option, a quick batch of pages and include edges before the parse
+*  ver 1.25 : 14 Oct 2026
+*  - rule stats are written to the profile, and the /R option orders rules by cost
+*  ver 1.24 : 14 Oct 2026
+*  - added countSourceLines and the /j option, which counts lines without parsing
+*  ver 1.23 : 14 Oct 2026
+*  - added keepFiles, which leaves the files one node parses in a distributed run
+*  ver 1.22 : 14 Oct 2026
+*  - added the /y option, which counts allocations per phase and subsystem
+*  ver 1.21 : 14 Oct 2026
+*  - added the /e option, which writes a Chrome trace of every thread's work
+*  ver 1.20 : 14 Oct 2026
+*  - added the /q option, which keeps a search index for MsgServer's SEARCH
+*  ver 1.19 : 14 Oct 2026
+*  - added the /g option, which publishes each run as a generation swapped in whole
+*  ver 1.18 : 14 Oct 2026
+*  - added the /k option, which publishes pages into one indexed pack
+*  ver 1.17 : 14 Oct 2026
+*  - added the /z option, which writes page.html.gz beside each large page
+*  ver 1.16 : 14 Oct 2026
+*  - /x runs parse one file of each distinct text: copies restore the
+*    fragment cached for it, and contentHashes() lets dependency analysis
+*    scan each text once
+*  ver 1.15 : 14 Oct 2026
+*  - pRepo_ is the Repository of the executive's own parser, found with
+*    ConfigParseForCodeAnal::repository, and handed to TypeAnal
+*  ver 1.14 : 14 Oct 2026
+*  - metrics displays sort nodes by file with keys made once per package
+*    and a counting sort, fileNodes_ holds node pointers, and report lines
+*    are written to one buffer handed to the logger in large pieces
+*  ver 1.13 : 14 Oct 2026
+*  - complexities are set by the parser as each scope ends, complexityAnalysis
+*    only finishes the scopes left open, the /v option checks them with the
+*    full walk complexityAnalysis used to make
+*  ver 1.12 : 14 Oct 2026
+*  - added the /u option and runDaemon, which analyze and publish again
+*    whenever files in the path change, a debounce window after the last change
+*  ver 1.11 : 14 Oct 2026
+*  - added the /x option, a per file AST cache: fragments of files whose text
+*    hasn't changed are restored from ast.cache instead of being parsed
+*  - the workers of processSourceCodeParallel are started by parseOnWorkers,
+*    which the cached path uses for the files it has to parse
+*  ver 1.10 : 14 Oct 2026
+*  - added the /c option, bounded memory: each file's statement and declaration
+*    tokens are released once the file is parsed, on every parse path
+*  ver 1.9 : 14 Oct 2026
+*  - added the /w option, dependency analysis finds type names with one
+*    automaton pass over each file's text instead of tokenizing it
+*  ver 1.8 : 14 Oct 2026
+*  - moved the body of main into runAnalysis, which reports phases as they
+*    start, so the resident AnalysisService can run analyses in-process.
+*    Building with ANALYSIS_SERVICE defined leaves main out.
+*  ver 1.7 : 14 Oct 2026
+*  - added processSourceCodePipelined, finishRendering and the /o option,
+*    which render pages as files are parsed and report stage occupancy
+*  ver 1.6 : 14 Oct 2026
+*  - added processSourceCodeParallel and the /p option
+*  - added the /i option, which skips parsing files unchanged since the last publish
+*  - added the /h option, which publishes with shared, content hashed CSS/JS
+*  - added the /n option, which builds the AST from a pooled ASTArena
+*  - metrics walks compare NodeType enumerators instead of type strings
+*  - the parse pass fills tokenCache(), so dependency analysis and publishing
+*    don't read and tokenize each file again
+*  - added the /t and /l options, which profile phases and files with RunProfile
+*  - getSourceFiles lists the tree on a pool of threads and keeps the listing,
+*    which TypeAnal reuses instead of reading the repository's directories again
+*  - the listing is kept as a FileInventory, with extension, size and stamp of each
+*    file, shared by dropUnchangedFiles, TypeAnal and Publisher
+*  - "opening file" messages are built only for loggers that are running, with LOG_WRITE
+*  - stopLogger relies on Logger::stop to write and flush pending messages
+*  - with /p complexities are evaluated on all cores, displayAST walks with an explicit stack
 *  Ver 1.5: 11 March 2017 
 *  ver 1.4 : 26 Feb 2016
 *  - added annunciation of version number
@@ -87,12 +268,16 @@
 #include <string>
 #include <vector>
 #include <unordered_map>
+#include <functional>
+#include <memory>
 #include <iosfwd>
 
 #include "../Parser/Parser.h"
 #include "../FileMgr/FileMgr.h"
+#include "../FileMgr/FileInventory.h"
 #include "../Parser/ConfigureParser.h"
 #include "../Utilities/Utilities.h"
+#include "ASTCache.h"
 
 namespace CodeAnalysis
 {
@@ -126,6 +311,25 @@ namespace CodeAnalysis
     size_t numDirs_;
   };
 
+  ///////////////////////////////////////////////////////////////////
+  // ParseFragment holds the results of parsing one file on a worker
+  // - nodes, decls, and statements are detached from the worker's
+  //   global scope so they can be grafted into the executive's AST
+
+  struct ParseFragment
+  {
+    std::vector<ASTNode*> nodes;
+    std::vector<DeclarationNode> decls;
+    std::vector<Scanner::ITokCollection*> statements;
+    AbstrSynTree::TypeMap types;
+    Repository::Relocations relocations;
+    std::vector<std::pair<size_t, size_t>> scopes;   // first and last lines, pipelined runs only
+    size_t slocs = 0;
+    size_t semiExps = 0;
+    size_t releasedStatements = 0;   // global statements already freed, e.g. restored from an ASTCache
+    bool opened = false;
+  };
+
   ///////////////////////////////////////////////////////////////////
   // CodeAnalysisExecutive class directs C++ and C# code analysis
 
@@ -140,9 +344,14 @@ namespace CodeAnalysis
     using Ext = std::string;
     using Options = std::vector<char>;
     using FileMap = std::unordered_map<Pattern, Files>;
-    using FileNodes = std::vector<std::pair<File, ASTNode*>>;
+    using FileNodes = std::vector<ASTNode*>;
     using Slocs = size_t;
     using SlocMap = std::unordered_map<File, Slocs>;
+    using ContentHashes = std::unordered_map<File, std::string>;
+    using Scope = std::pair<size_t, size_t>;
+    using PageFilter = std::function<bool(const File&)>;
+    using FileFilter = std::function<bool(const File&)>;
+    using PageRenderer = std::function<void(const File&, const std::vector<Scope>&)>;
 
     CodeAnalysisExecutive();
     virtual ~CodeAnalysisExecutive();
@@ -155,7 +364,27 @@ namespace CodeAnalysis
     FileMap& getFileMap();
     std::string getAnalysisPath();
     virtual void getSourceFiles();
+    void dropUnchangedFiles(const File& manifestFile);
+    size_t keepFiles(const FileFilter& keep);
+    bool incremental() { return incremental_; }
+    bool sharedAssets() { return sharedAssets_; }
+    bool scanTypeNames() { return scanTypeNames_; }
+    bool precompress() { return precompress_; }
+    bool packed() { return packed_; }
+    bool generations() { return generations_; }
+    bool searchIndex() { return searchIndex_; }
+    bool slocsOnly() { return slocsOnly_; }
+    bool quickPublish() { return quickPublish_; }
+    Scanner::TokenCache& tokenCache() { return tokenCache_; }
+    const ContentHashes& contentHashes() { return contentHashes_; }
+    Repository* repository() { return pRepo_; }
+    const FileManager::FileInventory& inventory() { return inventory_; }
     virtual void processSourceCode(bool showActivity);
+    virtual void processSourceCodeParallel(bool showActivity, size_t numThreads = 0);
+    Files processSourceCodePipelined(bool showActivity, const PageFilter& publishes, const PageRenderer& render, size_t numThreads = 0);
+    void finishRendering();
+    void countSourceLines(bool showActivity, size_t numThreads = 0);
+    bool pipelined() { return pipelined_; }
     void complexityAnalysis();
     std::vector<File>& cppHeaderFiles();
     std::vector<File>& cppImplemFiles();
@@ -175,21 +404,36 @@ namespace CodeAnalysis
     void flushLogger();
     void stopLogger();
     void setLogFile(const File& file);
+    bool writeProfile();
+    bool writeTrace();
+    bool writeMemory();
   private:
     void setLanguage(const File& file);
     void showActivity(const File& file);
     void clearActivity();
-    virtual void displayHeader();
-    virtual void displayMetricsLine(const File& file, ASTNode* pNode);
-    virtual void displayDataLines(ASTNode* pNode, bool isSummary = false);
+    virtual void displayHeader(std::ostream& out);
+    virtual void displayMetricsLine(std::ostream& out, ASTNode* pNode);
+    virtual void displayDataLines(std::ostream& out, ASTNode* pNode, bool isSummary = false);
     std::string showData(const Scanner::ITokCollection* ptc);
+    void profileFile(const File& file, size_t semiExps, const std::vector<ASTNode*>& nodes, size_t firstNode);
+    void releaseFileTokens(size_t firstNode);
+    Files allSourceFiles();
+    void graftFragments(const Files& files, std::vector<ParseFragment>& fragments);
+    void parseOnWorkers(const Files& files, std::vector<ParseFragment>& fragments, size_t numThreads, bool showProc);
+    void processSourceCodeCached(bool showProc);
+    struct Pipeline;
+    std::unique_ptr<Pipeline> pPipeline_;   // renderers still running after processSourceCodePipelined
     Parser* pParser_;
     ConfigParseForCodeAnal configure_;
+    Scanner::TokenCache tokenCache_;
+    ASTCache astCache_;
+    ContentHashes contentHashes_;   // text hash by TokenCache::key of each file, /x runs only
     Repository* pRepo_;
     Path path_;
     Patterns patterns_;
     Options options_;
     FileMap fileMap_;
+    FileManager::FileInventory inventory_;
     FileNodes fileNodes_;
     std::vector<File> cppHeaderFiles_;
     std::vector<File> cppImplemFiles_;
@@ -198,6 +442,25 @@ namespace CodeAnalysis
     size_t numDirs_;
     SlocMap slocMap_;
     bool displayProc_ = false;
+    bool parallelParse_ = false;
+    bool incremental_ = false;
+    bool sharedAssets_ = false;
+    bool scanTypeNames_ = false;
+    bool precompress_ = false;
+    bool packed_ = false;
+    bool generations_ = false;
+    bool searchIndex_ = false;
+    bool boundedMemory_ = false;
+    bool pooledAST_ = false;
+    bool pipelined_ = false;
+    bool cachedAST_ = false;
+    bool checkComplexity_ = false;
+    bool slocsOnly_ = false;
+    bool quickPublish_ = false;     // /Q, publish pages and include edges before the parse
+    size_t ruleOrderPeriod_ = 0;    // SemiExps between rule orderings, /R, 0 for order added
     std::ofstream* pLogStrm_ = nullptr;
   };
+
+  int runAnalysis(int argc, char* argv[], const std::function<void(const std::string&)>& progress = nullptr);
+  int runDaemon(int argc, char* argv[], size_t debounceMs = 250);
 }
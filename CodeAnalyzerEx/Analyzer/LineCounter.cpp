@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////////
+// LineCounter.cpp: Counts source lines without parsing          //
+// ver 1.0                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "LineCounter.h"
+#include <windows.h>
+#include <algorithm>
+#include <atomic>
+#include <thread>
+
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define LINECOUNTER_SSE2
+#include <emmintrin.h>
+#endif
+
+using namespace CodeAnalysis;
+
+//----< number of '\n' chars in size bytes of text >-----------------
+/*
+* - each lane's byte counter takes one block of 16 bytes per step, so
+*   the counters are summed into the total every 255 blocks, before
+*   any can wrap
+*/
+size_t LineCounter::countNewlines(const char* text, size_t size)
+{
+  size_t count = 0;
+  const char* p = text;
+  const char* end = text + size;
+#ifdef LINECOUNTER_SSE2
+  const __m128i vNewline = _mm_set1_epi8('\n');
+  const __m128i vZero = _mm_setzero_si128();
+  while (end - p >= 16)
+  {
+    size_t blocks = std::min<size_t>((end - p) / 16, 255);
+    __m128i counters = _mm_setzero_si128();
+    for (size_t i = 0; i < blocks; ++i, p += 16)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      counters = _mm_sub_epi8(counters, _mm_cmpeq_epi8(chunk, vNewline));   // matches are -1
+    }
+    __m128i sums = _mm_sad_epu8(counters, vZero);
+    count += (size_t)_mm_cvtsi128_si32(sums) + (size_t)_mm_cvtsi128_si32(_mm_srli_si128(sums, 8));
+  }
+#endif
+  return count + (size_t)std::count(p, end, '\n');
+}
+//----< map file and count its lines, false if it can't be read >----
+
+bool LineCounter::countFile(const File& file, size_t& lines)
+{
+  lines = 0;
+  HANDLE hFile = ::CreateFileA(file.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+    NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+  LARGE_INTEGER size;
+  if (!::GetFileSizeEx(hFile, &size))
+  {
+    ::CloseHandle(hFile);
+    return false;
+  }
+  if (size.QuadPart == 0)
+  {
+    ::CloseHandle(hFile);   // an empty file can't be mapped, and has no lines
+    return true;
+  }
+  bool counted = false;
+  HANDLE hMapping = ::CreateFileMappingA(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (hMapping != NULL)
+  {
+    const char* view = (const char*)::MapViewOfFile(hMapping, FILE_MAP_READ, 0, 0, 0);
+    if (view != nullptr)
+    {
+      lines = countNewlines(view, (size_t)size.QuadPart);
+      ::UnmapViewOfFile(view);
+      counted = true;
+    }
+    ::CloseHandle(hMapping);
+  }
+  ::CloseHandle(hFile);
+  return counted;
+}
+//----< count files on numThreads workers, returns files not read >--
+/*
+* - lines has one element per file, 0 for files that can't be read
+*/
+size_t LineCounter::countFiles(const Files& files, std::vector<size_t>& lines, size_t numThreads)
+{
+  lines.assign(files.size(), 0);
+  if (numThreads == 0)
+    numThreads = std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 1;
+  if (numThreads > files.size())
+    numThreads = files.size() > 0 ? files.size() : 1;
+
+  std::atomic<size_t> next(0);
+  std::atomic<size_t> failed(0);
+  auto count = [&]() {
+    for (size_t index = next++; index < files.size(); index = next++)
+    {
+      if (!countFile(files[index], lines[index]))
+        ++failed;
+    }
+  };
+  std::vector<std::thread> workers;
+  for (size_t i = 1; i < numThreads; ++i)
+    workers.push_back(std::thread(count));
+  count();
+  for (auto& worker : workers)
+    worker.join();
+  return failed;
+}
+
+#ifdef TEST_LINECOUNTER
+
+//----< test stub >--------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+
+int main()
+{
+  std::cout << "\n  Testing LineCounter";
+  std::cout << "\n =====================";
+
+  std::string text;
+  for (size_t i = 0; i < 10000; ++i)
+    text += (i % 7 == 0) ? "\n" : "int x;\r\n";
+  size_t expected = (size_t)std::count(text.begin(), text.end(), '\n');
+  std::cout << "\n  buffer: " << LineCounter::countNewlines(text.data(), text.size()) << " newlines, expected " << expected;
+
+  std::ofstream("lines.txt", std::ios::binary) << text;
+  std::ofstream("empty.txt", std::ios::binary);
+  LineCounter::Files files = { "lines.txt", "empty.txt", "missing.txt" };
+  std::vector<size_t> lines;
+  size_t failed = LineCounter::countFiles(files, lines, 2);
+  for (size_t i = 0; i < files.size(); ++i)
+    std::cout << "\n  " << files[i] << ": " << lines[i];
+  std::cout << "\n  " << failed << " file not read\n\n";
+  return 0;
+}
+#endif
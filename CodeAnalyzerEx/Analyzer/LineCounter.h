@@ -0,0 +1,59 @@
+#pragma once
+///////////////////////////////////////////////////////////////////
+// LineCounter.h: Counts source lines without parsing            //
+// ver 1.0                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  ===================
+*  LineCounter gives each file's line count as the parser's tokenizer
+*  reports it, the number of newlines in the file, without tokenizing
+*  or building an AST.  Files are memory mapped, so their bytes aren't
+*  copied, and newlines are counted 16 bytes at a time with SSE2,
+*  a byte counter per lane summed every 255 blocks, and a scalar loop,
+*  std::count, for what's left or when SSE2 isn't available.
+*
+*  countFiles counts a list of files on a pool of threads, each taking
+*  the next file uncounted, so a whole repository is counted at close
+*  to the rate its files can be read.
+*
+*  Public Interface:
+*  -----------------
+*  size_t n = LineCounter::countNewlines(text, size)   //newlines in a buffer
+*  bool ok = LineCounter::countFile(file, lines)        //false if file can't be read
+*  size_t failed = LineCounter::countFiles(files, lines, numThreads)
+*                                                       //lines[i] for files[i], 0 threads for all cores
+*
+*  Required Files:
+*  ---------------
+*  - LineCounter.h, LineCounter.cpp
+*
+*  Build Process:
+*  --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 14 Oct 2026
+*  - first release
+*/
+#include <string>
+#include <vector>
+
+namespace CodeAnalysis
+{
+  class LineCounter
+  {
+  public:
+    using File = std::string;
+    using Files = std::vector<File>;
+
+    static size_t countNewlines(const char* text, size_t size);
+    static bool countFile(const File& file, size_t& lines);
+    static size_t countFiles(const Files& files, std::vector<size_t>& lines, size_t numThreads = 0);
+  };
+}
@@ -0,0 +1,130 @@
+///////////////////////////////////////////////////////////////////
+// ReadAhead.cpp: Reads source files ahead of the parse          //
+// ver 1.0                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "ReadAhead.h"
+#include "../Tokenizer/Tokenizer.h"
+#include "../Utilities/Trace.h"
+
+using namespace CodeAnalysis;
+
+//----< start reading files, in order >------------------------------
+
+ReadAhead::ReadAhead(const Files& files, size_t maxFiles, size_t budget)
+  : files_(files), maxFiles_(maxFiles > 0 ? maxFiles : 1), budget_(budget)
+{
+  if (!files_.empty())
+    thread_ = std::thread([this] { run(); });
+}
+//----< stop reading, files not taken are dropped >------------------
+
+ReadAhead::~ReadAhead()
+{
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    stop_ = true;
+  }
+  cv_.notify_all();
+  if (thread_.joinable())
+    thread_.join();
+}
+//----< reader: reads each file once there's room for it >-----------
+/*
+* - the file is read without the lock, so the parser takes files
+*   already read while the next one is on its way
+*/
+void ReadAhead::run()
+{
+  Utilities::Trace::instance().nameThread("read ahead");
+  for (size_t index = 0; index < files_.size(); ++index)
+  {
+    {
+      std::unique_lock<std::mutex> lock(mtx_);
+      cv_.wait(lock, [this] { return stop_ || ready_.empty() || (ready_.size() < maxFiles_ && bytes_ < budget_); });
+      if (stop_)
+        return;
+    }
+    Buffer buffer;
+    buffer.read = Scanner::Toker::readFile(files_[index], buffer.text);
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      bytes_ += buffer.text.size();
+      ready_.push_back(std::move(buffer));
+    }
+    cv_.notify_all();
+  }
+}
+//----< text of file, if it's the next file and could be read >------
+/*
+* - files are taken in the order given; a file taken out of order,
+*   or one that can't be read, is left to the caller to open, so the
+*   caller reports it as it would without read ahead
+* - waits while the reader is still reading file
+*/
+bool ReadAhead::take(const File& file, std::string& text)
+{
+  std::unique_lock<std::mutex> lock(mtx_);
+  if (taken_ >= files_.size() || files_[taken_] != file)
+    return false;
+  if (ready_.empty())
+  {
+    ++waits_;
+    cv_.wait(lock, [this] { return !ready_.empty(); });
+  }
+  Buffer buffer = std::move(ready_.front());
+  ready_.pop_front();
+  bytes_ -= buffer.text.size();
+  ++taken_;
+  lock.unlock();
+  cv_.notify_all();
+  if (!buffer.read)
+    return false;
+  text = std::move(buffer.text);
+  return true;
+}
+//----< number of takes that waited for their file to be read >------
+
+size_t ReadAhead::waits() const
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return waits_;
+}
+
+#ifdef TEST_READAHEAD
+
+//----< test stub >--------------------------------------------------
+
+#include <iostream>
+#include <fstream>
+
+int main()
+{
+  std::cout << "\n  Testing ReadAhead";
+  std::cout << "\n ===================";
+
+  ReadAhead::Files files;
+  for (size_t i = 0; i < 8; ++i)
+  {
+    files.push_back("ahead" + std::to_string(i) + ".txt");
+    std::ofstream(files.back(), std::ios::binary) << "int x" << i << ";\r\n";
+  }
+  files.insert(files.begin() + 4, "missing.txt");
+  ReadAhead ahead(files, 2, 16);
+  for (auto& file : files)
+  {
+    std::string text, direct;
+    bool taken = ahead.take(file, text);
+    bool read = Scanner::Toker::readFile(file, direct);
+    std::cout << "\n  " << file << ": " << (taken ? "read ahead" : "not read") << (taken == read && text == direct ? ", same" : ", different");
+  }
+  std::string text;
+  std::cout << "\n  taken out of order: " << (ahead.take(files[0], text) ? "yes" : "no");
+  std::cout << "\n  " << ahead.waits() << " takes waited\n\n";
+  return 0;
+}
+#endif
@@ -0,0 +1,92 @@
+#pragma once
+///////////////////////////////////////////////////////////////////
+// ReadAhead.h: Reads source files ahead of the parse            //
+// ver 1.0                                                       //
+// Application: Type Based Dependency Analysis, Spring 2017      //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project2             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  ===================
+*  ReadAhead reads a list of files, in order, on a thread of its own,
+*  into buffers the parser takes as it reaches each file, so opening
+*  and reading the next files overlaps parsing the current one.  The
+*  serial parse no longer waits on each open and first read, which is
+*  most of its time on a network share.
+*
+*  Text is read with Toker::readFile, CR LF read as LF, and moved into
+*  the Toker with ConfigParseForCodeAnal::Attach(file, text), so tokens
+*  and line counts are those of a file the parser reads itself.
+*
+*  The reader stays at most maxFiles files, and budget bytes, ahead of
+*  the parser; it starts a file while fewer bytes are held, so one file
+*  larger than the budget is still read, and held memory stays below
+*  budget + the largest file.
+*
+*  Public Interface:
+*  -----------------
+*  ReadAhead ahead(files, maxFiles, budget);   //starts reading files[0]
+*  std::string text;
+*  if (ahead.take(file, text))                 //waits for file, false if it
+*    configure.Attach(file, std::move(text));  //isn't the next one or can't be read
+*  size_t n = ahead.waits();                   //takes that waited for a read
+*
+*  Required Files:
+*  ---------------
+*  - ReadAhead.h, ReadAhead.cpp, Tokenizer.h, Tokenizer.cpp
+*
+*  Build Process:
+*  --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 14 Oct 2026
+*  - first release
+*/
+#include <string>
+#include <vector>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+
+namespace CodeAnalysis
+{
+  class ReadAhead
+  {
+  public:
+    using File = std::string;
+    using Files = std::vector<File>;
+    static const size_t DefaultFiles = 16;                   // files read ahead of the parser
+    static const size_t DefaultBudget = 32 * 1024 * 1024;    // bytes held ahead of the parser
+
+    ReadAhead(const Files& files, size_t maxFiles = DefaultFiles, size_t budget = DefaultBudget);
+    ReadAhead(const ReadAhead&) = delete;
+    ReadAhead& operator=(const ReadAhead&) = delete;
+    ~ReadAhead();
+    bool take(const File& file, std::string& text);
+    size_t waits() const;
+  private:
+    struct Buffer
+    {
+      std::string text;
+      bool read = false;   // readFile opened and read the file
+    };
+    void run();
+
+    Files files_;
+    size_t maxFiles_;
+    size_t budget_;
+    mutable std::mutex mtx_;
+    std::condition_variable cv_;
+    std::deque<Buffer> ready_;   // files_[taken_] onward, as read
+    size_t taken_ = 0;
+    size_t bytes_ = 0;           // text held in ready_
+    size_t waits_ = 0;
+    bool stop_ = false;
+    std::thread thread_;
+  };
+}
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // TypeAnalysis.cpp:  It is used to create a type table            //
-// ver 1.0                                                       //
+// ver 1.4                                                       //
 // Application: Type Based Dependency Analysis, Spring 2017      //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project2             //
@@ -8,10 +8,12 @@
 ///////////////////////////////////////////////////////////////////
 
 #include "TypeAnalysis.h"
+#include <fstream>
+#include <algorithm>
 class TypeTable TT;
 
 void TypeTable::showTypeTable() {
-	for (auto iteration = TT.getTypeTable().begin(); iteration != TT.getTypeTable().end(); iteration++) {
+	for (auto iteration = maptypeanal.begin(); iteration != maptypeanal.end(); iteration++) {
 		std::cout << iteration->first << "\t\t\t\t";
 		std::vector<std::pair<std::string, std::string>> KeyPair = iteration->second;
 		for (auto temp : KeyPair) {
@@ -20,6 +22,151 @@ void TypeTable::showTypeTable() {
 	}
 
 }
+//----< adds a definition, after any earlier definitions of name >---------
+
+void TypeTable::add(const std::string& name, const TypeName& type, const FileType& file, const Namespace& nameSpace) {
+	maptypeanal[name].push_back(std::make_pair(type, file));
+	Definition def = { name, type, file, nameSpace };
+	byFile_[file].push_back(def);
+	++byNamespace_[nameSpace][file];
+}
+//----< removes every definition made in file, returns how many >---------
+
+size_t TypeTable::removeFile(const FileType& file) {
+	auto iter = byFile_.find(file);
+	if (iter == byFile_.end())
+		return 0;
+	for (auto& def : iter->second) {
+		auto entry = maptypeanal.find(def.name);
+		if (entry != maptypeanal.end()) {
+			TypeEntries& entries = entry->second;
+			entries.erase(std::remove_if(entries.begin(), entries.end(),
+				[&file](const std::pair<TypeName, FileType>& item) { return item.second == file; }), entries.end());
+			if (entries.empty())
+				maptypeanal.erase(entry);
+		}
+		auto ns = byNamespace_.find(def.nameSpace);
+		if (ns != byNamespace_.end()) {
+			ns->second.erase(file);
+			if (ns->second.empty())
+				byNamespace_.erase(ns);
+		}
+	}
+	size_t removed = iter->second.size();
+	byFile_.erase(iter);
+	return removed;
+}
+//----< adds other's definitions, file by file, after ours >---------------
+
+void TypeTable::merge(const TypeTable& other) {
+	for (auto& file : other.files())
+		for (auto& def : other.inFile(file))
+			add(def.name, def.type, def.file, def.nameSpace);
+}
+
+const TypeTable::Definitions& TypeTable::inFile(const FileType& file) const {
+	static const Definitions none;
+	auto iter = byFile_.find(file);
+	return iter == byFile_.end() ? none : iter->second;
+}
+
+TypeTable::Definitions TypeTable::inNamespace(const Namespace& nameSpace) const {
+	Definitions result;
+	auto ns = byNamespace_.find(nameSpace);
+	if (ns == byNamespace_.end())
+		return result;
+	for (auto& item : ns->second)
+		for (auto& def : inFile(item.first))
+			if (def.nameSpace == nameSpace)
+				result.push_back(def);
+	return result;
+}
+//----< files with definitions, sorted so saved indexes are repeatable >---
+
+std::vector<TypeTable::FileType> TypeTable::files() const {
+	std::vector<FileType> result;
+	for (auto& item : byFile_)
+		result.push_back(item.first);
+	std::sort(result.begin(), result.end());
+	return result;
+}
+
+void TypeTable::clear() {
+	maptypeanal.clear();
+	byFile_.clear();
+	byNamespace_.clear();
+}
+//----< writes "file <file>" then "type <type> <name> <namespace>" lines >---
+
+bool TypeTable::save(const std::string& fileSpec) const {
+	std::ofstream out(fileSpec);
+	if (!out.good())
+		return false;
+	return save(out);
+}
+
+bool TypeTable::save(std::ostream& out) const {
+	for (auto& file : files()) {
+		out << "file " << file << "\n";
+		for (auto& def : inFile(file))
+			out << "type " << def.type << " " << def.name << " " << def.nameSpace << "\n";
+	}
+	return out.good();
+}
+//----< replaces the table with one written by save >----------------------
+
+bool TypeTable::load(const std::string& fileSpec) {
+	std::ifstream in(fileSpec);
+	if (!in.good())
+		return false;
+	return load(in);
+}
+
+bool TypeTable::load(std::istream& in) {
+	clear();
+	std::string line, file;
+	while (std::getline(in, line)) {
+		if (line.compare(0, 5, "file ") == 0) {
+			file = line.substr(5);
+			continue;
+		}
+		size_t split1 = line.find(' ', 5), split2 = line.find(' ', split1 + 1);
+		if (line.compare(0, 5, "type ") != 0 || file.empty() || split1 == std::string::npos || split2 == std::string::npos)
+			continue;
+		add(line.substr(split1 + 1, split2 - split1 - 1), line.substr(5, split1 - 5), file, line.substr(split2 + 1));
+	}
+	return true;
+}
+
+#ifdef TEST_TYPETABLE
+
+#include <sstream>
+
+//----< test stub >--------------------------------------------------------
+
+int main() {
+	TypeTable tt;
+	tt.add("Toker", "class", "Tokenizer.h", "Scanner");
+	tt.add("TokenCache", "class", "Tokenizer.h", "Scanner");
+	tt.add("SemiExp", "class", "SemiExp.h", "Scanner");
+	tt.add("Toker", "class", "OldTokenizer.h", "Scanner");
+	std::cout << "\n  definitions of Toker: " << tt.find("Toker")->size();
+	std::cout << "\n  in Scanner: " << tt.inNamespace("Scanner").size();
+	tt.save("../TestFiles/types.index");
+	TypeTable reloaded;
+	reloaded.load("../TestFiles/types.index");
+	std::cout << "\n  removed from Tokenizer.h: " << reloaded.removeFile("Tokenizer.h");
+	std::cout << "\n  Toker now in: " << reloaded.find("Toker")->begin()->second;
+	std::cout << "\n  TokenCache known: " << std::boolalpha << (reloaded.find("TokenCache") != nullptr);
+	std::cout << "\n  in Scanner: " << reloaded.inNamespace("Scanner").size();
+	std::stringstream sent;
+	reloaded.save(sent);
+	TypeTable received;
+	received.load(sent);
+	std::cout << "\n  received from a stream: " << received.files().size() << " files\n\n";
+}
+
+#endif
 
 #ifdef TYPE_Analysis
 
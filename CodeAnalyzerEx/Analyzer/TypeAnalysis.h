@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // TypeAnalysis.h:  It is used to create a Type Table            //
-// ver 1.0                                                       //
+// ver 1.4                                                       //
 // Application: Type Based Dependency Analysis, Spring 2017      //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project2             //
@@ -18,8 +18,16 @@
 * using TypeName = std::string;           //used to form a pair for value part of unorderedmap 
   using FileType = std::string;           //used to form a pair for value part of unorderedmap 
 * using MapTypeAnalysis                   //unordered map of string as key and a pair of strings as value
-* MapTypeAnalysis& getTypeTable()         //used to return the instance of unordered map
+* MapTypeAnalysis& getTypeTable()         //used to return the instance of unordered map, also const
+* const TypeEntries* find(const std::string& tok) //hashed lookup of a token, nullptr if it is not a type
 * void showTypeTable();                   //function to display values of type table
+* void add(name, type, file, nameSpace)   //adds a definition to the by name, file and namespace indexes
+* size_t removeFile(file)                 //removes every definition of file, e.g., when it changed
+* void merge(const TypeTable& other)      //adds other's definitions after ours
+* const Definitions& inFile(file)         //definitions of one file, in the order they were added
+* Definitions inNamespace(nameSpace)      //definitions in one namespace
+* bool save(fileSpec), load(fileSpec)     //keeps the index on disk between runs
+* bool save(out), load(in)                //the same on streams, e.g., to send a table to another node
 *
 *
 * Required Files:
@@ -32,6 +40,19 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.4 : 14 Oct 2026
+* - added save and load on streams, so distributed analysis sends tables as message bodies
+* Ver 1.3 : 14 Oct 2026
+* - the table is a multi-index: every definition of a name is kept, the first one
+*   first, and definitions are also indexed by file and by namespace
+* - added removeFile, so a changed file's definitions can be replaced, merge, and
+*   save and load, so an index written by one run is reused by the next
+* - showTypeTable shows this table, not the global one
+* Ver 1.2 : 14 Oct 2026
+* - added const getTypeTable, for readers sharing the table across threads
+* Ver 1.1 : 14 Oct 2026
+* - added find(tok) so that dependency analysis can do a single hashed
+*   lookup per token instead of scanning the whole table
 * Ver 1.0 : 11 March 2017
 * - first release
 *
@@ -43,6 +64,7 @@
 #include <iostream>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 
 class TypeTable {
@@ -51,14 +73,47 @@ public:
 	using TypeName = std::string;
 	using FileType = std::string;
 	 
-	using MapTypeAnalysis = std::unordered_map<std::string, std::vector<std::pair<TypeName, FileType>>>;
+	using Namespace = std::string;
+	using TypeEntries = std::vector<std::pair<TypeName, FileType>>;
+	using MapTypeAnalysis = std::unordered_map<std::string, TypeEntries>;
+	struct Definition {
+		std::string name;
+		TypeName type;
+		FileType file;
+		Namespace nameSpace;
+	};
+	using Definitions = std::vector<Definition>;
 	void showTypeTable();
 	~TypeTable() { maptypeanal; }
+	//getTypeTable's map is the by name index, add and removeFile keep the other indexes with it
 	MapTypeAnalysis& getTypeTable() {
 		return maptypeanal;
 	}
+	const MapTypeAnalysis& getTypeTable() const {
+		return maptypeanal;
+	}
+	//hashed lookup of a token, returns nullptr when the token is not a known type
+	const TypeEntries* find(const std::string& tok) const {
+		auto iter = maptypeanal.find(tok);
+		if (iter == maptypeanal.end() || iter->second.empty())
+			return nullptr;
+		return &iter->second;
+	}
+	void add(const std::string& name, const TypeName& type, const FileType& file, const Namespace& nameSpace = "");
+	size_t removeFile(const FileType& file);
+	void merge(const TypeTable& other);
+	const Definitions& inFile(const FileType& file) const;
+	Definitions inNamespace(const Namespace& nameSpace) const;
+	std::vector<FileType> files() const;
+	bool save(const std::string& fileSpec) const;
+	bool load(const std::string& fileSpec);
+	bool save(std::ostream& out) const;
+	bool load(std::istream& in);
+	void clear();
 
 private:
 	MapTypeAnalysis  maptypeanal;
+	std::unordered_map<FileType, Definitions> byFile_;
+	std::unordered_map<Namespace, std::unordered_map<FileType, size_t>> byNamespace_;   // files with definitions in each namespace, and how many
 
 };
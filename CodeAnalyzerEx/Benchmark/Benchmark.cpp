@@ -0,0 +1,480 @@
+///////////////////////////////////////////////////////////////////////////
+// Benchmark.cpp - Times analysis, publishing and transfer as trees grow //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "../MsgClient/MsgClient.h"
+#include "Benchmark.h"
+#include "SyntheticRepo.h"
+#include "LoadGenerator.h"
+#include "../Utilities/MemoryProfile.h"
+#include <windows.h>
+#include <psapi.h>
+#include <iostream>
+#include <iomanip>
+#include <sstream>
+#include <fstream>
+#include <chrono>
+
+#pragma comment(lib, "psapi.lib")
+
+using Utilities::MemoryProfile;
+
+//----< collect arguments from argv[first] on >----------------------
+
+BenchOptions::BenchOptions(int argc, char* argv[], int first)
+{
+	for (int i = first; i < argc; ++i)
+	{
+		std::string arg = argv[i];
+		if (arg.size() < 2 || arg[0] != '/')
+			continue;
+		size_t colon = arg.find(':');
+		if (colon == std::string::npos)
+			values_[arg.substr(1)] = "";
+		else
+			values_[arg.substr(1, colon - 1)] = arg.substr(colon + 1);
+	}
+}
+
+bool BenchOptions::has(const std::string& name) const
+{
+	return values_.find(name) != values_.end();
+}
+
+std::string BenchOptions::get(const std::string& name, const std::string& otherwise) const
+{
+	auto iter = values_.find(name);
+	return (iter == values_.end() || iter->second == "") ? otherwise : iter->second;
+}
+
+size_t BenchOptions::number(const std::string& name, size_t otherwise) const
+{
+	std::string value = get(name, "");
+	return value == "" ? otherwise : (size_t)std::stoul(value);
+}
+//----< a comma separated list of numbers, e.g., /files:100,1000 >---
+
+std::vector<size_t> BenchOptions::numbers(const std::string& name, const std::vector<size_t>& otherwise) const
+{
+	std::string value = get(name, "");
+	if (value == "")
+		return otherwise;
+	std::vector<size_t> list;
+	std::istringstream in(value);
+	std::string item;
+	while (std::getline(in, item, ','))
+	{
+		if (item != "")
+			list.push_back((size_t)std::stoul(item));
+	}
+	return list;
+}
+
+namespace
+{
+	double millisSince(std::chrono::steady_clock::time_point start)
+	{
+		return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+	}
+	//----< peak live bytes while phase ran, 0 if nothing was counted >--
+
+	long long phasePeak(const std::string& phase)
+	{
+		for (auto& record : MemoryProfile::instance().phases())
+		{
+			if (record.name == phase)
+				return record.usage.peak;
+		}
+		return 0;
+	}
+	//----< files in directory and their bytes >---------------------------
+
+	size_t directoryBytes(const std::string& directory, std::vector<std::string>& files)
+	{
+		files = FileSystem::Directory::getFiles(directory, "*.*");
+		size_t bytes = 0;
+		for (auto& file : files)
+		{
+			FileSystem::FileInfo fi(directory + file);
+			if (fi.good())
+				bytes += fi.size();
+		}
+		return bytes;
+	}
+}
+
+ScaleBenchmark::ScaleBenchmark(const BenchOptions& options)
+	: options_(options), out_(options.get("out", "../Benchmark/results"))
+{
+}
+//----< run every size, then write scaling.csv >---------------------
+
+int ScaleBenchmark::run()
+{
+	MemoryProfile::instance().enable();
+	FileSystem::Directory::create(out_);
+	FileSystem::Directory::create("../Benchmark/synthetic");
+	std::vector<size_t> sizes = options_.numbers("files", { 100, 1000, 10000 });
+	bool ok = true;
+	for (size_t size : sizes)
+	{
+		ok = runSize(size) && ok;
+		show(size);
+	}
+	std::string csv = out_ + "/scaling.csv";
+	bool wrote = writeCsv(csv);
+	std::cout << "\n\n  " << (wrote ? "wrote " : "couldn't write ") << csv << "\n\n";
+	return (ok && wrote) ? 0 : 1;
+}
+//----< generate one tree, analyze it, and transfer it >-------------
+
+bool ScaleBenchmark::runSize(size_t size)
+{
+	SyntheticRepo::Shape shape;
+	shape.files = size;
+	shape.classesPerFile = options_.number("classes", shape.classesPerFile);
+	shape.fanOut = options_.number("fanout", shape.fanOut);
+	shape.depth = options_.number("depth", shape.depth);
+	shape.csharpPercent = options_.number("cs", shape.csharpPercent);
+	shape.seed = (unsigned)options_.number("seed", shape.seed);
+	std::string root = "../Benchmark/synthetic/" + std::to_string(size);
+
+	std::cout << "\n  generating " << size << " files in " << root;
+	SyntheticRepo::Stats stats;
+	auto start = std::chrono::steady_clock::now();
+	{
+		MemoryProfile::Phase memory("generate");
+		SyntheticRepo repo(shape);
+		stats = repo.generate(root);
+	}
+	Result generated;
+	generated.size = size;
+	generated.phase = "generate";
+	generated.millis = millisSince(start);
+	generated.files = stats.files;
+	generated.bytes = stats.bytes;
+	generated.peakBytes = phasePeak("generate");
+	add(generated);
+	if (!stats.ok)
+	{
+		std::cout << "\n  couldn't write every file of " << root;
+		return false;
+	}
+	bool ok = analyze(size, root, stats.files, stats.bytes);
+	if (ok && options_.has("transfer"))
+		ok = transfer(size, root, stats.packages);
+	if (!options_.has("keep"))
+		SyntheticRepo::removeTree(root);
+	return ok;
+}
+//----< run CodeAnalyzer on root, add its phases from its reports >---
+
+bool ScaleBenchmark::analyze(size_t size, const std::string& root, size_t files, size_t bytes)
+{
+	bool csharp = options_.number("cs", 0) > 0;
+	std::string commandLine = "\"" + options_.get("analyzer", "CodeAnalyzer.exe") + "\" \"" + root +
+		"\" *.h *.cpp bench.none" + (csharp ? " *.cs" : "") + " /t /y " + options_.get("analyze", "");
+	std::string log = out_ + "/analyze" + std::to_string(size) + ".log";
+	FileSystem::File::remove(root + "/profile.csv");
+	FileSystem::File::remove(root + "/memory.csv");
+
+	std::cout << "\n  analyzing: " << commandLine;
+	Child child = runChild(commandLine, log);
+	if (!child.started)
+	{
+		std::cout << "\n  couldn't start " << options_.get("analyzer", "CodeAnalyzer.exe");
+		return false;
+	}
+	Result whole;
+	whole.size = size;
+	whole.phase = "analyze";
+	whole.millis = child.millis;
+	whole.files = files;
+	whole.bytes = bytes;
+	whole.peakBytes = child.peakWorkingSet;
+	add(whole);
+	if (child.exitCode != 0)
+	{
+		std::cout << "\n  analyzer exited with " << child.exitCode << ", see " << log;
+		return false;
+	}
+
+	std::map<std::string, long long> peaks;
+	for (auto& row : readCsvSection(root + "/memory.csv", "phase,calls,"))
+	{
+		if (row.size() >= 8)
+			peaks[row[0]] = std::stoll(row[7]);
+	}
+	for (auto& row : readCsvSection(root + "/profile.csv", "phase,ms,calls"))
+	{
+		if (row.size() < 3)
+			continue;
+		Result phase;
+		phase.size = size;
+		phase.phase = row[0];
+		phase.millis = std::stod(row[1]);
+		phase.files = files;
+		phase.bytes = bytes;
+		phase.peakBytes = peaks[row[0]];
+		add(phase);
+	}
+	return true;
+}
+//----< upload each package to MsgServer, then download its pages >---
+/*
+*  Packages are uploaded one directory at a time, as MsgClient sends
+*  files by name from its local directory.
+*/
+bool ScaleBenchmark::transfer(size_t size, const std::string& root, size_t packages)
+{
+	MsgClient client(options_.get("host", "localhost"), options_.number("port", 8080));
+	client.setStreams(options_.number("streams", 4));
+
+	Result upload;
+	upload.size = size;
+	upload.phase = "upload";
+	bool ok = true;
+	auto start = std::chrono::steady_clock::now();
+	{
+		MemoryProfile::Phase memory("upload");
+		for (size_t package = 0; package < packages && ok; ++package)
+		{
+			std::string directory = root + "/Pkg" + std::to_string(package) + "/";
+			std::vector<std::string> files;
+			upload.bytes += directoryBytes(directory, files);
+			upload.files += files.size();
+			client.setLocalDir(directory);
+			ok = client.upload(files, options_.number("streams", 4));
+		}
+	}
+	upload.millis = millisSince(start);
+	upload.peakBytes = phasePeak("upload");
+	add(upload);
+	if (!ok)
+	{
+		std::cout << "\n  upload to " << options_.get("host", "localhost") << ":" << options_.number("port", 8080)
+			<< " failed, is MsgServer running?";
+		client.close();
+		return false;
+	}
+
+	std::string downloads = out_ + "/download/";
+	SyntheticRepo::removeTree(downloads);
+	FileSystem::Directory::create(downloads);
+	client.setLocalDir(downloads);
+	Async::BlockingQueue<HttpMessage> msgQ;
+	Result download;
+	download.size = size;
+	download.phase = "download";
+	start = std::chrono::steady_clock::now();
+	{
+		MemoryProfile::Phase memory("download");
+		ok = client.download(msgQ);
+	}
+	download.millis = millisSince(start);
+	std::vector<std::string> files;
+	download.bytes = directoryBytes(downloads, files);
+	download.files = files.size();
+	download.peakBytes = phasePeak("download");
+	add(download);
+	client.close();
+	return ok;
+}
+//----< run commandLine, stdin from NUL, stdout to logFile >---------
+/*
+*  Peak working set is read before the process handle is closed, so it
+*  is the child's, not this process's.
+*/
+ScaleBenchmark::Child ScaleBenchmark::runChild(const std::string& commandLine, const std::string& logFile)
+{
+	Child child;
+	SECURITY_ATTRIBUTES inherit = { sizeof(SECURITY_ATTRIBUTES), nullptr, TRUE };
+	HANDLE hIn = CreateFileA("NUL", GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE, &inherit, OPEN_EXISTING, 0, nullptr);
+	HANDLE hOut = CreateFileA(logFile.c_str(), GENERIC_WRITE, FILE_SHARE_READ, &inherit, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (hIn == INVALID_HANDLE_VALUE || hOut == INVALID_HANDLE_VALUE)
+	{
+		if (hIn != INVALID_HANDLE_VALUE)
+			CloseHandle(hIn);
+		if (hOut != INVALID_HANDLE_VALUE)
+			CloseHandle(hOut);
+		return child;
+	}
+	STARTUPINFOA startup = { sizeof(STARTUPINFOA) };
+	startup.dwFlags = STARTF_USESTDHANDLES;
+	startup.hStdInput = hIn;
+	startup.hStdOutput = hOut;
+	startup.hStdError = hOut;
+	PROCESS_INFORMATION process = {};
+	std::vector<char> command(commandLine.begin(), commandLine.end());
+	command.push_back('\0');
+
+	auto start = std::chrono::steady_clock::now();
+	if (CreateProcessA(nullptr, &command[0], nullptr, nullptr, TRUE, 0, nullptr, nullptr, &startup, &process))
+	{
+		child.started = true;
+		WaitForSingleObject(process.hProcess, INFINITE);
+		child.millis = millisSince(start);
+		GetExitCodeProcess(process.hProcess, &child.exitCode);
+		PROCESS_MEMORY_COUNTERS counters = { sizeof(PROCESS_MEMORY_COUNTERS) };
+		if (GetProcessMemoryInfo(process.hProcess, &counters, sizeof(counters)))
+			child.peakWorkingSet = (long long)counters.PeakWorkingSetSize;
+		CloseHandle(process.hThread);
+		CloseHandle(process.hProcess);
+	}
+	CloseHandle(hIn);
+	CloseHandle(hOut);
+	return child;
+}
+//----< rows of the table that starts with header, up to a blank line >--
+
+std::vector<std::vector<std::string>> ScaleBenchmark::readCsvSection(const std::string& file, const std::string& header)
+{
+	std::vector<std::vector<std::string>> rows;
+	std::ifstream in(file);
+	std::string line;
+	bool inSection = false;
+	while (std::getline(in, line))
+	{
+		if (!inSection)
+		{
+			inSection = line.compare(0, header.size(), header) == 0;
+			continue;
+		}
+		if (line == "")
+			break;
+		std::vector<std::string> row;
+		std::string cell;
+		bool quoted = false;
+		for (char ch : line)
+		{
+			if (ch == '"')
+				quoted = !quoted;
+			else if (ch == ',' && !quoted)
+			{
+				row.push_back(cell);
+				cell.clear();
+			}
+			else
+				cell += ch;
+		}
+		row.push_back(cell);
+		rows.push_back(row);
+	}
+	return rows;
+}
+
+void ScaleBenchmark::add(const Result& result)
+{
+	results_.push_back(result);
+}
+//----< table of the phases of one size >----------------------------
+
+void ScaleBenchmark::show(size_t size) const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	out << "\n\n  " << size << " files";
+	out << "\n  " << std::left << std::setw(18) << "phase" << std::right << std::setw(12) << "ms"
+		<< std::setw(12) << "files/s" << std::setw(12) << "KB/s" << std::setw(12) << "peak KB";
+	for (auto& result : results_)
+	{
+		if (result.size != size)
+			continue;
+		double seconds = result.millis / 1000.0;
+		out << "\n  " << std::left << std::setw(18) << result.phase << std::right << std::setw(12) << result.millis
+			<< std::setw(12) << (seconds > 0 ? result.files / seconds : 0.0)
+			<< std::setw(12) << (seconds > 0 ? result.bytes / 1024.0 / seconds : 0.0)
+			<< std::setw(12) << result.peakBytes / 1024.0;
+	}
+	std::cout << out.str();
+}
+//----< every result, one row each, for comparing runs >-------------
+
+bool ScaleBenchmark::writeCsv(const std::string& file) const
+{
+	std::ofstream out(file);
+	if (!out.good())
+		return false;
+	out << std::fixed << std::setprecision(3);
+	out << "size,phase,ms,files,bytes,files/s,KB/s,peak bytes\n";
+	for (auto& result : results_)
+	{
+		double seconds = result.millis / 1000.0;
+		out << result.size << "," << result.phase << "," << result.millis << "," << result.files << "," << result.bytes
+			<< "," << (seconds > 0 ? result.files / seconds : 0.0)
+			<< "," << (seconds > 0 ? result.bytes / 1024.0 / seconds : 0.0)
+			<< "," << result.peakBytes << "\n";
+	}
+	return out.good();
+}
+
+//----< run a LoadGenerator against MsgServer, write load.csv >------
+
+int runLoad(const BenchOptions& options)
+{
+	LoadGenerator::Settings settings;
+	settings.host = options.get("host", settings.host);
+	settings.port = options.number("port", settings.port);
+	settings.connections = options.number("connections", settings.connections);
+	settings.rate = std::stod(options.get("rate", std::to_string(settings.rate)));
+	settings.seconds = std::stod(options.get("seconds", std::to_string(settings.seconds)));
+	std::vector<size_t> mix = options.numbers("mix", { settings.mix.small, settings.mix.upload, settings.mix.fetch });
+	mix.resize(3, 0);
+	settings.mix.small = mix[0];
+	settings.mix.upload = mix[1];
+	settings.mix.fetch = mix[2];
+	settings.smallBytes = options.number("small", settings.smallBytes);
+	settings.uploadBytes = options.number("uploadKB", settings.uploadBytes / 1024) * 1024;
+	std::istringstream pages(options.get("pages", ""));
+	std::string page;
+	while (std::getline(pages, page, ','))
+	{
+		if (page != "")
+			settings.pages.push_back(page);
+	}
+
+	std::cout << "\n  " << settings.connections << " connections to " << settings.host << ":" << settings.port << ", "
+		<< settings.rate << " requests a second for " << settings.seconds << " seconds";
+	LoadGenerator load(settings);
+	std::vector<LoadGenerator::Summary> summaries = load.run();
+	std::cout << "\n  " << load.connected() << " of " << settings.connections << " connections opened";
+	std::cout << LoadGenerator::table(summaries);
+	std::string out = options.get("out", "../Benchmark/results");
+	FileSystem::Directory::create(out);
+	bool wrote = LoadGenerator::writeCsv(out + "/load.csv", summaries);
+	std::cout << "\n\n  " << (wrote ? "wrote " : "couldn't write ") << out << "/load.csv\n\n";
+	return (wrote && load.connected() == settings.connections) ? 0 : 1;
+}
+
+void showUsage()
+{
+	std::cout << "\n  Usage: Benchmark scale [/files:100,1000,10000] [/classes:4] [/fanout:3] [/depth:2]";
+	std::cout << "\n                         [/cs:0] [/seed:1] [/analyze:\"/p /o\"] [/analyzer:CodeAnalyzer.exe]";
+	std::cout << "\n                         [/transfer] [/host:localhost] [/port:8080] [/streams:4]";
+	std::cout << "\n                         [/out:../Benchmark/results] [/keep]";
+	std::cout << "\n         Benchmark load [/connections:8] [/rate:200] [/seconds:10] [/mix:70,20,10]";
+	std::cout << "\n                        [/small:64] [/uploadKB:64] [/pages:a.html,b.html]";
+	std::cout << "\n                        [/host:localhost] [/port:8080] [/out:../Benchmark/results]";
+	std::cout << "\n  - scale: generate trees of each size, time analysis, publishing and, with /transfer,";
+	std::cout << "\n    upload and download through a running MsgServer, write scaling.csv";
+	std::cout << "\n  - load: small messages, uploads and page fetches, mixed by /mix, sent to a running";
+	std::cout << "\n    MsgServer at /rate, write each kind's latency percentiles to load.csv\n\n";
+}
+
+int main(int argc, char* argv[])
+{
+	std::string mode = argc > 1 ? argv[1] : "";
+	BenchOptions options(argc, argv, 2);
+	if (mode == "scale")
+	{
+		ScaleBenchmark bench(options);
+		return bench.run();
+	}
+	if (mode == "load")
+		return runLoad(options);
+	showUsage();
+	return 1;
+}
@@ -0,0 +1,154 @@
+#ifndef BENCHMARK_H
+#define BENCHMARK_H
+///////////////////////////////////////////////////////////////////////////
+// Benchmark.h - Times analysis, publishing and transfer as trees grow   //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* Benchmark.exe runs benchmarks named by its first argument.
+*
+* "scale" measures how each stage scales with the size of the tree it
+* works on.  For each size in /files, SyntheticRepo writes a tree of
+* that many files into ../Benchmark/synthetic/<size>, then:
+* - CodeAnalyzer.exe analyzes and publishes it, in a process of its own,
+*   with /t and /y, so its profile.csv and memory.csv give the time and
+*   peak live heap bytes of each phase: scan, parse, complexity,
+*   dependencyTable and publish; options in /analyze, e.g., "/p /o", are
+*   passed on, and its output goes to analyze<size>.log
+* - the analyzer run as a whole is timed, with the process's peak working
+*   set, so memory outside the heap, e.g., thread stacks, is counted too
+* - with /transfer, each package's sources and pages are uploaded to a
+*   running MsgServer with MsgClient, then the server's published pages
+*   are downloaded into download/ of the results directory
+*
+* Every phase of every size is shown as a table of its time, files and
+* KB a second, and peak KB, and written to scaling.csv in the results
+* directory, so runs before and after a change can be compared.
+*
+* The analyzer is passed bench.none as the 4th argument, the page it
+* opens when done, so no browser is started, and as a file pattern it
+* matches nothing.  Its standard input is NUL, so it doesn't wait for a
+* key when finished.
+*
+* Uploads are synced, so files the server already holds, by content
+* hash, aren't sent again; start MsgServer with an empty Repository to
+* time every byte.
+*
+* "load" runs a LoadGenerator against a running MsgServer: /connections
+* connections send /rate requests a second between them for /seconds,
+* small messages, uploads of /uploadKB and page fetches, in the
+* proportions of /mix, and each kind's latency percentiles and
+* throughput are shown and written to load.csv in the results directory.
+*
+* Command line:
+* -------------
+* Benchmark scale [/files:100,1000,10000] [/classes:4] [/fanout:3] [/depth:2]
+*                 [/cs:0] [/seed:1] [/analyze:"/p /o"] [/analyzer:CodeAnalyzer.exe]
+*                 [/transfer] [/host:localhost] [/port:8080] [/streams:4]
+*                 [/out:../Benchmark/results] [/keep]
+* - /cs is the percent of units written in C#
+* - /keep leaves the synthetic trees in place, they're removed otherwise
+* Benchmark load [/connections:8] [/rate:200] [/seconds:10] [/mix:70,20,10]
+*                [/small:64] [/uploadKB:64] [/pages:a.html,b.html]
+*                [/host:localhost] [/port:8080] [/out:../Benchmark/results]
+* - /mix weighs small messages, uploads and fetches
+* - /pages are fetched, those in ../Repository if not given
+*
+* Public Interface
+* --------------------
+* BenchOptions options(argc, argv, 2);                  //"/name:value" arguments
+* ScaleBenchmark bench(options);
+* int result = bench.run();                             //0 if every size ran
+* int result = runLoad(options);                        //0 if every connection opened
+*
+* Required Files:
+* ---------------
+*   Benchmark.h, Benchmark.cpp, SyntheticRepo.h, SyntheticRepo.cpp
+*   LoadGenerator.h, LoadGenerator.cpp
+*   MsgClient.h, MsgClient.cpp, PublishManifest.h, PublishManifest.cpp
+*   HttpMessage.h, HttpMessage.cpp, Sockets.h, Sockets.cpp
+*   Compression.h, Compression.cpp, FileSystem.h, FileSystem.cpp
+*   Logger.h, Logger.cpp, Utilities.h, Utilities.cpp
+*   MemoryProfile.h, MemoryHooks.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.1 : 14 Oct 2026
+* - added the load benchmark, run by LoadGenerator
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+
+///////////////////////////////////////////////////////////////////////////
+// BenchOptions holds "/name:value" and "/name" arguments
+
+class BenchOptions
+{
+public:
+	BenchOptions(int argc, char* argv[], int first);
+	bool has(const std::string& name) const;
+	std::string get(const std::string& name, const std::string& otherwise) const;
+	size_t number(const std::string& name, size_t otherwise) const;
+	std::vector<size_t> numbers(const std::string& name, const std::vector<size_t>& otherwise) const;
+private:
+	std::map<std::string, std::string> values_;
+};
+
+///////////////////////////////////////////////////////////////////////////
+// ScaleBenchmark times every stage on synthetic trees of growing size
+
+class ScaleBenchmark
+{
+public:
+	struct Result
+	{
+		size_t size = 0;        // files asked for
+		std::string phase;
+		double millis = 0;
+		size_t files = 0;       // files the phase worked on
+		size_t bytes = 0;
+		long long peakBytes = 0;
+	};
+
+	ScaleBenchmark(const BenchOptions& options);
+	int run();
+	const std::vector<Result>& results() const { return results_; }
+private:
+	struct Child
+	{
+		bool started = false;
+		unsigned long exitCode = 0;
+		double millis = 0;
+		long long peakWorkingSet = 0;
+	};
+	bool runSize(size_t size);
+	bool analyze(size_t size, const std::string& root, size_t files, size_t bytes);
+	bool transfer(size_t size, const std::string& root, size_t packages);
+	Child runChild(const std::string& commandLine, const std::string& logFile);
+	static std::vector<std::vector<std::string>> readCsvSection(const std::string& file, const std::string& header);
+	void add(const Result& result);
+	void show(size_t size) const;
+	bool writeCsv(const std::string& file) const;
+
+	const BenchOptions& options_;
+	std::string out_;
+	std::vector<Result> results_;
+};
+
+int runLoad(const BenchOptions& options);
+
+#endif
@@ -0,0 +1,254 @@
+///////////////////////////////////////////////////////////////////////////
+// LoadGenerator.cpp - Loads MsgServer from many connections, timing each//
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "../MsgClient/MsgClient.h"
+#include "LoadGenerator.h"
+#include <thread>
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+using Clock = std::chrono::steady_clock;
+
+LoadGenerator::LoadGenerator(const Settings& settings) : settings_(settings)
+{
+	settings_.connections = (std::max)(settings_.connections, (size_t)1);
+	if (settings_.pages.empty())
+		settings_.pages = FileSystem::Directory::getFiles("../Repository/", "*.html");
+}
+
+std::string LoadGenerator::kindName(Kind kind)
+{
+	switch (kind)
+	{
+	case Small: return "small";
+	case Upload: return "upload";
+	case Fetch: return "fetch";
+	default: return "all";
+	}
+}
+//----< pick a kind of request by the mix's weights >----------------
+
+LoadGenerator::Kind LoadGenerator::choose(unsigned& state) const
+{
+	size_t fetch = settings_.pages.empty() ? 0 : settings_.mix.fetch;
+	size_t total = settings_.mix.small + settings_.mix.upload + fetch;
+	if (total == 0)
+		return Small;
+	state = state * 1103515245u + 12345u;
+	size_t pick = (state >> 8) % total;
+	if (pick < settings_.mix.small)
+		return Small;
+	return (pick < settings_.mix.small + settings_.mix.upload) ? Upload : Fetch;
+}
+//----< file of uploadBytes for a connection to post >---------------
+
+bool LoadGenerator::writeUploadFile(const std::string& file) const
+{
+	std::ofstream out(settings_.workDir + file, std::ios::binary | std::ios::trunc);
+	unsigned state = 1;
+	for (size_t i = 0; i < settings_.uploadBytes; ++i)
+	{
+		state = state * 1103515245u + 12345u;
+		out.put((char)(state >> 16));
+	}
+	return out.good();
+}
+//----< hold a connection until every one is ready, all start as one >--
+
+void LoadGenerator::waitForStart()
+{
+	std::unique_lock<std::mutex> lock(mutex_);
+	++waiting_;
+	if (waiting_ == settings_.connections)
+	{
+		start_ = Clock::now();
+		started_ = true;
+		ready_.notify_all();
+		return;
+	}
+	ready_.wait(lock, [this]() { return started_; });
+}
+//----< one connection's requests, each timed from its scheduled start >--
+
+void LoadGenerator::drive(size_t index, Connection& connection)
+{
+	MsgClient client(settings_.host, settings_.port);
+	client.setLocalDir(settings_.workDir);
+	std::string uploadFile = "load" + std::to_string(index) + ".bin";
+	bool prepared = writeUploadFile(uploadFile);
+	connection.connected = prepared && client.post("load generator connection " + std::to_string(index), true);
+	waitForStart();
+	if (!connection.connected)
+		return;
+
+	std::string small(settings_.smallBytes, 'x');
+	unsigned state = (unsigned)index + 1;
+	double rate = settings_.rate > 0 ? settings_.rate : 1;
+	auto interval = std::chrono::duration_cast<Clock::duration>(
+		std::chrono::duration<double>(settings_.connections / rate));
+	auto end = start_ + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(settings_.seconds));
+	auto scheduled = start_ + interval * (long long)index / (long long)settings_.connections;
+	for (; scheduled < end; scheduled += interval)
+	{
+		Clock::time_point now = Clock::now();
+		if (now >= end)
+			break;
+		if (now < scheduled)
+			std::this_thread::sleep_until(scheduled);
+		Sample sample;
+		sample.kind = choose(state);
+		sample.bytes = 0;
+		switch (sample.kind)
+		{
+		case Small:
+			sample.ok = client.post(small, true);
+			sample.bytes = small.size();
+			break;
+		case Upload:
+			sample.ok = client.postFile(uploadFile, true);
+			sample.bytes = settings_.uploadBytes;
+			break;
+		default:
+		{
+			const std::string& page = settings_.pages[(state >> 8) % settings_.pages.size()];
+			size_t received = 0;
+			sample.ok = client.fetch(page, "", [&received](size_t, const std::string& bytes, size_t) { received += bytes.size(); });
+			sample.bytes = received;
+		}
+		}
+		sample.millis = std::chrono::duration<double, std::milli>(Clock::now() - scheduled).count();
+		connection.samples.push_back(sample);
+	}
+	for (; scheduled < end; scheduled += interval)
+		++connection.late;
+	client.close();
+}
+//----< run every connection, then summarize each kind and all >-----
+
+std::vector<LoadGenerator::Summary> LoadGenerator::run()
+{
+	FileSystem::Directory::create(settings_.workDir);
+	std::vector<Connection> connections(settings_.connections);
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < connections.size(); ++i)
+		threads.push_back(std::thread([this, i, &connections]() { drive(i, connections[i]); }));
+	for (auto& thread : threads)
+		thread.join();
+	double seconds = std::chrono::duration<double>(Clock::now() - start_).count();
+
+	connected_ = 0;
+	std::vector<const Sample*> all, byKind[NumKinds];
+	size_t late = 0;
+	for (auto& connection : connections)
+	{
+		connected_ += connection.connected ? 1 : 0;
+		late += connection.late;
+		for (auto& sample : connection.samples)
+		{
+			all.push_back(&sample);
+			byKind[sample.kind].push_back(&sample);
+		}
+	}
+	std::vector<Summary> summaries;
+	for (int kind = 0; kind < NumKinds; ++kind)
+		summaries.push_back(summarize(kindName(Kind(kind)), byKind[kind], 0, seconds));
+	summaries.push_back(summarize("all", all, late, seconds));
+	return summaries;
+}
+//----< nearest rank percentile of sorted latencies >----------------
+
+double LoadGenerator::percentile(const std::vector<double>& sorted, double fraction)
+{
+	if (sorted.empty())
+		return 0;
+	size_t rank = (size_t)std::ceil(fraction * sorted.size());
+	return sorted[(std::min)((std::max)(rank, (size_t)1), sorted.size()) - 1];
+}
+//----< counts, rates and latency percentiles of answered requests >--
+
+LoadGenerator::Summary LoadGenerator::summarize(const std::string& kind, std::vector<const Sample*>& samples,
+	size_t late, double seconds) const
+{
+	Summary summary;
+	summary.kind = kind;
+	summary.late = late;
+	std::vector<double> millis;
+	size_t bytes = 0;
+	for (auto pSample : samples)
+	{
+		if (!pSample->ok)
+		{
+			++summary.failed;
+			continue;
+		}
+		millis.push_back(pSample->millis);
+		bytes += pSample->bytes;
+	}
+	std::sort(millis.begin(), millis.end());
+	summary.count = millis.size();
+	if (seconds > 0)
+	{
+		summary.perSecond = summary.count / seconds;
+		summary.kbPerSecond = bytes / 1024.0 / seconds;
+	}
+	summary.p50 = percentile(millis, 0.50);
+	summary.p99 = percentile(millis, 0.99);
+	summary.p999 = percentile(millis, 0.999);
+	summary.max = millis.empty() ? 0 : millis.back();
+	return summary;
+}
+
+std::string LoadGenerator::table(const std::vector<Summary>& summaries)
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(2);
+	out << "\n  " << std::left << std::setw(8) << "kind" << std::right << std::setw(9) << "count" << std::setw(8) << "failed"
+		<< std::setw(7) << "late" << std::setw(10) << "req/s" << std::setw(11) << "KB/s" << std::setw(10) << "p50 ms"
+		<< std::setw(10) << "p99 ms" << std::setw(10) << "p999 ms" << std::setw(10) << "max ms";
+	for (auto& s : summaries)
+	{
+		out << "\n  " << std::left << std::setw(8) << s.kind << std::right << std::setw(9) << s.count << std::setw(8) << s.failed
+			<< std::setw(7) << s.late << std::setw(10) << s.perSecond << std::setw(11) << s.kbPerSecond << std::setw(10) << s.p50
+			<< std::setw(10) << s.p99 << std::setw(10) << s.p999 << std::setw(10) << s.max;
+	}
+	return out.str();
+}
+
+bool LoadGenerator::writeCsv(const std::string& file, const std::vector<Summary>& summaries)
+{
+	std::ofstream out(file);
+	if (!out.good())
+		return false;
+	out << std::fixed << std::setprecision(3);
+	out << "kind,count,failed,late,req/s,KB/s,p50 ms,p99 ms,p999 ms,max ms\n";
+	for (auto& s : summaries)
+	{
+		out << s.kind << "," << s.count << "," << s.failed << "," << s.late << "," << s.perSecond << "," << s.kbPerSecond
+			<< "," << s.p50 << "," << s.p99 << "," << s.p999 << "," << s.max << "\n";
+	}
+	return out.good();
+}
+
+#ifdef TEST_LOADGENERATOR
+
+#include <iostream>
+
+int main()
+{
+	LoadGenerator::Settings settings;
+	settings.connections = 4;
+	settings.rate = 50;
+	settings.seconds = 2;
+	LoadGenerator load(settings);
+	std::vector<LoadGenerator::Summary> summaries = load.run();
+	std::cout << "\n  " << load.connected() << " of " << settings.connections << " connections opened";
+	std::cout << LoadGenerator::table(summaries) << "\n\n";
+}
+#endif
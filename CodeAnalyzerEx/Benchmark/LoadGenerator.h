@@ -0,0 +1,146 @@
+#ifndef LOADGENERATOR_H
+#define LOADGENERATOR_H
+///////////////////////////////////////////////////////////////////////////
+// LoadGenerator.h - Loads MsgServer from many connections, timing each  //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* LoadGenerator opens a number of connections to a running MsgServer,
+* each a MsgClient on a thread of its own, and has them send requests
+* at a target rate, all connections together, for a number of seconds.
+* Each request is one of:
+* - small, a message of a few bytes, posted with ack: yes
+* - upload, a file of the chosen size, posted with ack: yes, so the
+*   server answers once it has stored it
+* - fetch, a whole published page, answered with its FETCH chunks
+* chosen at random in the proportions of the mix.
+*
+* Requests are sent open loop: each connection has a schedule, one
+* request every connections / rate seconds, and a request's latency is
+* timed from its scheduled start to its answer.  A server that falls
+* behind is charged the time requests waited to be sent, instead of
+* being offered less load, so slow answers show in the percentiles.
+* A connection sends its next request when the last is answered, so
+* set enough connections for the rate; requests not yet sent when the
+* run ends are counted as late.
+*
+* Each connection first posts one message, untimed, so connecting and
+* its OPTIONS exchange aren't counted.  Results are summarized per kind
+* of request and in all: count, failures, requests and KB a second, and
+* p50, p99, p999 and max latency in ms.
+*
+* Pages fetched are the ones named, or otherwise those in ../Repository,
+* i.e., when run beside the server.  With no pages fetches are left out.
+*
+* Public Interface
+* --------------------
+* LoadGenerator::Settings settings;                     //8 connections, 200/s
+* settings.connections = 32;
+* settings.mix.upload = 50;
+* LoadGenerator load(settings);
+* std::vector<LoadGenerator::Summary> summaries = load.run();
+* size_t opened = load.connected();                     //connections that could connect
+* std::string table = LoadGenerator::table(summaries);
+* bool ok = LoadGenerator::writeCsv("load.csv", summaries);
+*
+* Required Files:
+* ---------------
+*   LoadGenerator.h, LoadGenerator.cpp
+*   MsgClient.h, MsgClient.cpp, and the files they need
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+
+class LoadGenerator
+{
+public:
+	enum Kind { Small, Upload, Fetch, NumKinds };
+	struct Mix
+	{
+		size_t small = 70;          // relative weights, percent if they sum to 100
+		size_t upload = 20;
+		size_t fetch = 10;
+	};
+	struct Settings
+	{
+		std::string host = "localhost";
+		size_t port = 8080;
+		size_t connections = 8;
+		double rate = 200;          // requests a second, all connections together
+		double seconds = 10;
+		Mix mix;
+		size_t smallBytes = 64;
+		size_t uploadBytes = 64 * 1024;
+		std::vector<std::string> pages;   // empty for those in ../Repository
+		std::string workDir = "../Benchmark/load/";   // upload files are written here
+	};
+	struct Summary
+	{
+		std::string kind;
+		size_t count = 0;
+		size_t failed = 0;
+		size_t late = 0;            // still waiting to be sent when the run ended
+		double perSecond = 0;
+		double kbPerSecond = 0;
+		double p50 = 0;             // ms
+		double p99 = 0;
+		double p999 = 0;
+		double max = 0;
+	};
+
+	LoadGenerator(const Settings& settings);
+	std::vector<Summary> run();
+	size_t connected() const { return connected_; }
+	static std::string kindName(Kind kind);
+	static double percentile(const std::vector<double>& sorted, double fraction);
+	static std::string table(const std::vector<Summary>& summaries);
+	static bool writeCsv(const std::string& file, const std::vector<Summary>& summaries);
+private:
+	struct Sample
+	{
+		Kind kind;
+		bool ok;
+		double millis;
+		size_t bytes;
+	};
+	struct Connection
+	{
+		bool connected = false;
+		std::vector<Sample> samples;
+		size_t late = 0;
+	};
+	void drive(size_t index, Connection& connection);
+	void waitForStart();
+	Kind choose(unsigned& state) const;
+	bool writeUploadFile(const std::string& file) const;
+	Summary summarize(const std::string& kind, std::vector<const Sample*>& samples, size_t late, double seconds) const;
+
+	Settings settings_;
+	std::mutex mutex_;
+	std::condition_variable ready_;
+	size_t waiting_ = 0;        // connections ready to start
+	bool started_ = false;
+	size_t connected_ = 0;
+	std::chrono::steady_clock::time_point start_;
+};
+
+#endif
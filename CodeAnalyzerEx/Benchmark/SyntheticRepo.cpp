@@ -0,0 +1,284 @@
+///////////////////////////////////////////////////////////////////////////
+// SyntheticRepo.cpp - Writes C++ and C# source trees of a chosen shape  //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "SyntheticRepo.h"
+#include "../FileSystem/FileSystem.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cmath>
+
+//----< next of the shape's pseudo random numbers >------------------
+
+unsigned SyntheticRepo::next()
+{
+	state_ = state_ * 1103515245u + 12345u;
+	return state_ >> 8;
+}
+//----< choose each unit's package, language and the units it uses >--
+
+std::vector<SyntheticRepo::Unit> SyntheticRepo::plan()
+{
+	state_ = shape_.seed == 0 ? 1 : shape_.seed;
+	std::vector<Unit> units;
+	std::vector<size_t> written[2];   // ids of C++ and C# units so far
+	size_t files = 0;
+	while (files < shape_.files)
+	{
+		Unit unit;
+		unit.id = units.size();
+		unit.csharp = next() % 100 < shape_.csharpPercent;
+		std::vector<size_t>& earlier = written[unit.csharp ? 1 : 0];
+		size_t uses = (std::min)(shape_.fanOut, earlier.size());
+		while (unit.uses.size() < uses)
+		{
+			size_t used = earlier[next() % earlier.size()];
+			if (std::find(unit.uses.begin(), unit.uses.end(), used) == unit.uses.end())
+				unit.uses.push_back(used);
+		}
+		earlier.push_back(unit.id);
+		files += unit.csharp ? 1 : 2;
+		units.push_back(unit);
+	}
+	size_t packages = shape_.packages;
+	if (packages == 0)
+		packages = (size_t)std::sqrt((double)units.size());
+	packages = (std::max)(packages, (size_t)1);
+	for (auto& unit : units)
+		unit.package = unit.id % packages;
+	return units;
+}
+
+std::string SyntheticRepo::unitName(size_t id)
+{
+	return "Unit" + std::to_string(id);
+}
+
+std::string SyntheticRepo::className(size_t unit, size_t cls) const
+{
+	return unitName(unit) + "Class" + std::to_string(cls);
+}
+//----< Pkg3::Level1::Level2 for depth 3, with separator "::" >------
+
+std::string SyntheticRepo::namespaceOf(size_t package, const std::string& separator) const
+{
+	std::string name = "Pkg" + std::to_string(package);
+	for (size_t level = 1; level < shape_.depth; ++level)
+		name += separator + "Level" + std::to_string(level);
+	return name;
+}
+//----< qualified name of a class of the use'th unit this unit uses >--
+
+std::string SyntheticRepo::usedClass(const Unit& unit, size_t use, const std::string& separator) const
+{
+	const Unit& used = units_[unit.uses[use]];
+	size_t classes = (std::max)(shape_.classesPerFile, (size_t)1);
+	return namespaceOf(used.package, separator) + separator + className(used.id, (unit.id + use) % classes);
+}
+//----< a member function's body, nested depth blocks deep >---------
+/*
+*  Calls the classes the unit uses, so their names appear as a caller's
+*  would, and nests loops and conditions as real functions do.
+*/
+std::string SyntheticRepo::body(const Unit& unit, size_t cls, const std::string& indent, bool csharp) const
+{
+	std::ostringstream out;
+	out << indent << "int total = " << cls << ";\n";
+	std::string inner = indent;
+	size_t depth = (std::max)(shape_.depth, (size_t)1);
+	for (size_t level = 0; level < depth; ++level)
+	{
+		std::string i = "i" + std::to_string(level);
+		if (level % 2 == 0)
+			out << inner << "for (int " << i << " = 0; " << i << " < n; ++" << i << ")\n";
+		else
+			out << inner << "if (total % " << (level + 1) << " == 0)\n";
+		out << inner << "{\n";
+		inner += "  ";
+	}
+	for (size_t use = 0; use < unit.uses.size(); ++use)
+		out << inner << "total += uses" << use << "_" << (csharp ? ".Run(n - 1);\n" : ".run(n - 1);\n");
+	out << inner << "total += " << (cls + 1) << ";\n";
+	for (size_t level = depth; level > 0; --level)
+	{
+		inner.resize(inner.size() - 2);
+		out << inner << "}\n";
+	}
+	out << indent << "return total;\n";
+	return out.str();
+}
+//----< UnitN.h: its classes, holding members of classes it uses >--
+
+std::string SyntheticRepo::header(const Unit& unit) const
+{
+	std::ostringstream out;
+	out << "#pragma once\n";
+	out << "// " << unitName(unit.id) << ".h - synthetic source written by Benchmark\n\n";
+	for (size_t used : unit.uses)
+		out << "#include \"../Pkg" << units_[used].package << "/" << unitName(used) << ".h\"\n";
+	out << "#include <string>\n#include <vector>\n\n";
+	size_t levels = (std::max)(shape_.depth, (size_t)1);
+	out << "namespace Pkg" << unit.package << " {\n";
+	for (size_t level = 1; level < levels; ++level)
+		out << "namespace Level" << level << " {\n";
+	for (size_t cls = 0; cls < shape_.classesPerFile; ++cls)
+	{
+		out << "\n  class " << className(unit.id, cls) << "\n  {\n  public:\n";
+		out << "    " << className(unit.id, cls) << "();\n";
+		out << "    int run(int n);\n";
+		out << "    const std::string& name() const { return name_; }\n";
+		std::string indent = "    ";
+		for (size_t level = 1; level < levels; ++level)
+		{
+			out << indent << "struct Inner" << level << "\n" << indent << "{\n";
+			indent += "  ";
+			out << indent << "int value" << level << " = " << level << ";\n";
+		}
+		for (size_t level = levels; level > 1; --level)
+		{
+			indent.resize(indent.size() - 2);
+			out << indent << "};\n";
+		}
+		out << "  private:\n";
+		for (size_t use = 0; use < unit.uses.size(); ++use)
+			out << "    " << usedClass(unit, use, "::") << " uses" << use << "_;\n";
+		out << "    std::string name_;\n    std::vector<int> values_;\n  };\n";
+	}
+	for (size_t level = 0; level < levels; ++level)
+		out << "}\n";
+	return out.str();
+}
+//----< UnitN.cpp: the member functions of its classes >-------------
+
+std::string SyntheticRepo::implementation(const Unit& unit) const
+{
+	std::ostringstream out;
+	out << "// " << unitName(unit.id) << ".cpp - synthetic source written by Benchmark\n\n";
+	out << "#include \"" << unitName(unit.id) << ".h\"\n\n";
+	out << "using namespace " << namespaceOf(unit.package, "::") << ";\n";
+	for (size_t cls = 0; cls < shape_.classesPerFile; ++cls)
+	{
+		std::string name = className(unit.id, cls);
+		out << "\n" << name << "::" << name << "() : name_(\"" << name << "\")\n{\n}\n";
+		out << "\nint " << name << "::run(int n)\n{\n";
+		out << "  if (n <= 0)\n    return 0;\n";
+		out << body(unit, cls, "  ", false);
+		out << "}\n";
+	}
+	return out.str();
+}
+//----< UnitN.cs: its classes, holding members of classes it uses >-
+
+std::string SyntheticRepo::csharp(const Unit& unit) const
+{
+	std::ostringstream out;
+	out << "// " << unitName(unit.id) << ".cs - synthetic source written by Benchmark\n\n";
+	out << "using System;\nusing System.Collections.Generic;\n\n";
+	out << "namespace " << namespaceOf(unit.package, ".") << "\n{\n";
+	for (size_t cls = 0; cls < shape_.classesPerFile; ++cls)
+	{
+		std::string name = className(unit.id, cls);
+		out << "  public class " << name << "\n  {\n";
+		for (size_t use = 0; use < unit.uses.size(); ++use)
+			out << "    private " << usedClass(unit, use, ".") << " uses" << use << "_ = new "
+			<< usedClass(unit, use, ".") << "();\n";
+		out << "    private List<int> values_ = new List<int>();\n";
+		out << "    public string Name { get { return \"" << name << "\"; } }\n";
+		out << "    public int Run(int n)\n    {\n";
+		out << "      if (n <= 0)\n        return 0;\n";
+		out << body(unit, cls, "      ", true);
+		out << "    }\n  }\n";
+	}
+	out << "}\n";
+	return out.str();
+}
+//----< write one file, counting it >--------------------------------
+
+bool SyntheticRepo::write(const std::string& file, const std::string& text, Stats& stats)
+{
+	std::ofstream out(file, std::ios::binary | std::ios::trunc);
+	out << text;
+	if (!out.good())
+	{
+		stats.ok = false;
+		return false;
+	}
+	++stats.files;
+	stats.bytes += text.size();
+	stats.lines += std::count(text.begin(), text.end(), '\n');
+	return true;
+}
+//----< write the shape's tree under root, replacing one there >-----
+
+SyntheticRepo::Stats SyntheticRepo::generate(const std::string& root)
+{
+	Stats stats;
+	units_ = plan();
+	removeTree(root);
+	FileSystem::Directory::create(root);
+	size_t packages = 0;
+	for (auto& unit : units_)
+		packages = (std::max)(packages, unit.package + 1);
+	for (size_t package = 0; package < packages; ++package)
+		FileSystem::Directory::create(root + "/Pkg" + std::to_string(package));
+	stats.packages = packages;
+	for (auto& unit : units_)
+	{
+		std::string base = root + "/Pkg" + std::to_string(unit.package) + "/" + unitName(unit.id);
+		if (unit.csharp)
+			write(base + ".cs", csharp(unit), stats);
+		else
+		{
+			write(base + ".h", header(unit), stats);
+			write(base + ".cpp", implementation(unit), stats);
+		}
+		stats.classes += shape_.classesPerFile;
+	}
+	return stats;
+}
+//----< delete root, its files, and its directories' files >---------
+/*
+*  Every directory below root is emptied, so pages the analyzer writes
+*  into a tree, e.g., under generations/N/, are removed with it.
+*/
+bool SyntheticRepo::removeTree(const std::string& root)
+{
+	std::vector<std::string> directories(1, root);
+	for (size_t i = 0; i < directories.size(); ++i)
+	{
+		for (auto& sub : FileSystem::Directory::getDirectories(directories[i]))
+		{
+			if (sub != "." && sub != "..")
+				directories.push_back(directories[i] + "/" + sub);
+		}
+	}
+	for (size_t i = directories.size(); i > 0; --i)
+	{
+		const std::string& directory = directories[i - 1];
+		for (auto& file : FileSystem::Directory::getFiles(directory))
+			FileSystem::File::remove(directory + "/" + file);
+		FileSystem::Directory::remove(directory);
+	}
+	return !FileSystem::Directory::exists(root);
+}
+
+#ifdef TEST_SYNTHETICREPO
+
+#include <iostream>
+
+int main()
+{
+	SyntheticRepo::Shape shape;
+	shape.files = 20;
+	shape.csharpPercent = 25;
+	SyntheticRepo repo(shape);
+	SyntheticRepo::Stats stats = repo.generate("../TestFiles/synthetic");
+	std::cout << "\n  wrote " << stats.files << " files, " << stats.bytes << " bytes, " << stats.lines << " lines, "
+		<< stats.classes << " classes in " << stats.packages << " packages";
+	std::cout << "\n  removed: " << std::boolalpha << SyntheticRepo::removeTree("../TestFiles/synthetic") << "\n\n";
+}
+#endif
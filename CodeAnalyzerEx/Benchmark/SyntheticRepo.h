@@ -0,0 +1,112 @@
+#ifndef SYNTHETICREPO_H
+#define SYNTHETICREPO_H
+///////////////////////////////////////////////////////////////////////////
+// SyntheticRepo.h - Writes C++ and C# source trees of a chosen shape    //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* The TestFiles and Repository directories hold a few dozen small files,
+* too few to show how the analyzer scales.  SyntheticRepo writes a tree
+* of any size, laid out as the analyzer and publisher expect, root/Pkg0/,
+* root/Pkg1/, ..., each holding units: a C++ header and implementation,
+* UnitN.h and UnitN.cpp, or, for the share of units chosen, one C# file,
+* UnitN.cs.
+*
+* The Shape chooses:
+* - files, the number of files written, about, as a C++ unit is two
+* - classesPerFile, the classes each unit defines
+* - fanOut, the units whose classes each unit uses, as members and in
+*   calls, so found by dependency analysis; C++ headers include theirs
+* - depth, how deeply namespaces, nested classes and control blocks in
+*   member functions are nested
+* - packages, the directories, 0 for about the square root of the units
+* - csharpPercent, the share of units written in C#
+* - seed, so a shape always writes the same tree
+*
+* A unit only uses units written before it, of its own language, so
+* the dependency graph has no cycles and every unit but the first few
+* has the full fan out.
+*
+* Public Interface
+* --------------------
+* SyntheticRepo::Shape shape;                           //defaults: 100 files
+* shape.files = 10000;
+* SyntheticRepo repo(shape);
+* SyntheticRepo::Stats stats = repo.generate("../Benchmark/synthetic/10000");
+* bool ok = SyntheticRepo::removeTree("../Benchmark/synthetic/10000");
+*
+* Required Files:
+* ---------------
+*   SyntheticRepo.h, SyntheticRepo.cpp, FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <vector>
+
+class SyntheticRepo
+{
+public:
+	struct Shape
+	{
+		size_t files = 100;
+		size_t classesPerFile = 4;
+		size_t fanOut = 3;
+		size_t depth = 2;
+		size_t packages = 0;        // 0 for about the square root of the units
+		size_t csharpPercent = 0;
+		unsigned seed = 1;
+	};
+	struct Stats
+	{
+		size_t files = 0;
+		size_t bytes = 0;
+		size_t lines = 0;
+		size_t classes = 0;
+		size_t packages = 0;
+		bool ok = true;             // false if a file couldn't be written
+	};
+
+	SyntheticRepo(const Shape& shape) : shape_(shape) {}
+	Stats generate(const std::string& root);
+	static bool removeTree(const std::string& root);
+private:
+	struct Unit
+	{
+		size_t id;
+		size_t package;
+		bool csharp;
+		std::vector<size_t> uses;   // ids of earlier units of the same language
+	};
+	std::vector<Unit> plan();
+	unsigned next();
+	std::string header(const Unit& unit) const;
+	std::string implementation(const Unit& unit) const;
+	std::string csharp(const Unit& unit) const;
+	std::string usedClass(const Unit& unit, size_t use, const std::string& scope) const;
+	std::string body(const Unit& unit, size_t cls, const std::string& indent, bool csharp) const;
+	static std::string unitName(size_t id);
+	std::string className(size_t unit, size_t cls) const;
+	std::string namespaceOf(size_t package, const std::string& separator) const;
+	bool write(const std::string& file, const std::string& text, Stats& stats);
+
+	Shape shape_;
+	std::vector<Unit> units_;
+	unsigned state_ = 1;
+};
+
+#endif
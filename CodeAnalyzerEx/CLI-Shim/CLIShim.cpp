@@ -4,26 +4,44 @@
 // Note:                                                               //
 //   - build as a dll so C# can load                                   //
 //   - link to MockChannel static library                              //
+//   - Analyze and GetEvent drive the resident AnalysisService         //
+//   - Shim(host, port) talks to a MsgServer instead of MockChannel    //
+//   - strings cross as UTF-8 <-> UTF-16, converted in one pass        //
+//     from pinned characters; batches cross in one call               //
 //                                                                     //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2017           //
 /////////////////////////////////////////////////////////////////////////
 
 #include "CLIShim.h"
+#include <vcclr.h>
 #include <iostream>
 
-//----< convert std::string to System.String >---------------------------
+using namespace System::Text;
 
+//----< convert UTF-8 std::string to System.String >---------------------
+/*
+*  The String constructor decodes the bytes straight into the new string.
+*/
 String^ Shim::stdStrToSysStr(const std::string& str)
 {
-  return gcnew String(str.c_str());
+  if (str.empty())
+    return String::Empty;
+  return gcnew String(reinterpret_cast<const signed char*>(str.data()), 0, static_cast<int>(str.size()), Encoding::UTF8);
 }
-//----< convert System.String to std::string >---------------------------
-
+//----< convert System.String to UTF-8 std::string >---------------------
+/*
+*  The string's characters are pinned, not copied, and encoded once into
+*  a std::string sized for them, so non-ASCII text survives the trip.
+*/
 std::string Shim::sysStrToStdStr(String^ str)
 {
-  std::string temp;
-  for (int i = 0; i < str->Length; ++i)
-    temp += char(str[i]);
+  if (String::IsNullOrEmpty(str))
+    return std::string();
+  pin_ptr<const wchar_t> pinned = PtrToStringChars(str);
+  wchar_t* pChars = const_cast<wchar_t*>(static_cast<const wchar_t*>(pinned));
+  int size = Encoding::UTF8->GetByteCount(pChars, str->Length);
+  std::string temp(size, '\0');
+  Encoding::UTF8->GetBytes(pChars, str->Length, reinterpret_cast<unsigned char*>(&temp[0]), size);
   return temp;
 }
 //----< Constructor sets up sender and receiver >------------------------
@@ -34,6 +52,28 @@ Shim::Shim(){
   pRecvr = factory.createRecvr();
   pMockChan = factory.createMockChannel(pSendr, pRecvr);
   pMockChan->start();
+  pService = factory.createAnalysisService();
+}
+//----< Constructor connects the channel to a MsgServer >----------------
+/*
+*  Requests and replies are described in MockChannel/CommChannel.cpp.
+*/
+Shim::Shim(String^ host, int port){
+  ObjectFactory factory;
+  pSendr = factory.createCommSendr();
+  pRecvr = factory.createCommRecvr();
+  pMockChan = factory.createCommChannel(pSendr, pRecvr, sysStrToStdStr(host), static_cast<size_t>(port));
+  pMockChan->start();
+  pService = factory.createAnalysisService();
+}
+//----< stop the analysis service, after the analysis it is running >---
+
+Shim::~Shim()
+{
+  pMockChan->stop();
+  pService->stop();
+  delete pService;
+  pService = nullptr;
 }
 //----< put message into channel >---------------------------------------
 
@@ -47,6 +87,39 @@ String^ Shim::GetMessage(){
   std::string msg = pRecvr->getMessage();
   return stdStrToSysStr(msg);
 }
+//----< put a batch of messages into channel with one native call >------
+
+void Shim::PostMessages(array<Message^>^ msgs)
+{
+  std::vector<std::string> batch;
+  batch.reserve(msgs->Length);
+  for each (Message^ msg in msgs)
+    batch.push_back(sysStrToStdStr(msg));
+  pSendr->postMessages(batch);
+}
+//----< wait for a message, then take up to maxCount in one call >-------
+
+array<Shim::Message^>^ Shim::GetMessages(int maxCount)
+{
+  std::vector<std::string> batch;
+  pRecvr->getMessages(batch, maxCount > 0 ? static_cast<size_t>(maxCount) : 0);
+  array<Message^>^ msgs = gcnew array<Message^>(static_cast<int>(batch.size()));
+  for (int i = 0; i < msgs->Length; ++i)
+    msgs[i] = stdStrToSysStr(batch[i]);
+  return msgs;
+}
+//----< queue an analysis, cmdLine as CodeAnalyzer.exe takes it >--------
+
+void Shim::Analyze(String^ cmdLine)
+{
+  pService->post(sysStrToStdStr(cmdLine));
+}
+//----< next analysis progress event, blocks until there is one >--------
+
+String^ Shim::GetEvent()
+{
+  return stdStrToSysStr(pService->getEvent());
+}
 
 #ifdef TEST_CLISHIM
 
@@ -57,6 +130,17 @@ int main(){
   pShim->PostMessage(msg);
   String^ pReply = pShim->GetMessage();
   std::cout << "\n  received message \"" << pShim->sysStrToStdStr(pReply) << "\"";
+
+  array<String^>^ batch = gcnew array<String^>{ "first", L"caf\u00e9 \u00fcber", "third" };
+  pShim->PostMessages(batch);
+  int received = 0;
+  while (received < batch->Length)
+  {
+    array<String^>^ replies = pShim->GetMessages(10);
+    for each (String^ reply in replies)
+      std::cout << "\n  batch reply \"" << pShim->sysStrToStdStr(reply) << "\", round trip "
+                << (String::Equals(reply, batch[received++]) ? "ok" : "changed");
+  }
   std::cout << "\n\n";
 }
 #endif
@@ -5,6 +5,10 @@
 // Note:                                                             //
 //   - build as a dll so C# can load                                 //
 //   - link to MockChannel static library                            //
+//   - Analyze and GetEvent drive the resident AnalysisService       //
+//   - Shim(host, port) talks to a MsgServer instead of MockChannel  //
+//   - strings cross as UTF-8 <-> UTF-16, converted in one pass      //
+//     from pinned characters; batches cross in one call             //
 //                                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2017         //
 ///////////////////////////////////////////////////////////////////////
@@ -19,14 +23,21 @@ public:
   using Message = String;
 
   Shim();
+  Shim(String^ host, int port);
+  ~Shim();
   void PostMessage(Message^ msg);
   String^ GetMessage();
+  void PostMessages(array<Message^>^ msgs);
+  array<Message^>^ GetMessages(int maxCount);
+  void Analyze(String^ cmdLine);
+  String^ GetEvent();
   String^ stdStrToSysStr(const std::string& str);
   std::string sysStrToStdStr(String^ str);
 private:
   ISendr* pSendr;
   IRecvr* pRecvr;
   IMockChannel* pMockChan;
+  IAnalysisService* pService;
 };
 
 
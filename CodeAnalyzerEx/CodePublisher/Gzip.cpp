@@ -0,0 +1,393 @@
+///////////////////////////////////////////////////////////////////
+// Gzip.cpp: Compresses published pages into gzip files          //
+// ver 1.0                                                       //
+// Application: Dependency Based Code Publisher, Spring 2017     //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project3             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "Gzip.h"
+#include <vector>
+#include <queue>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+
+using namespace std;
+
+namespace {
+	const size_t WindowSize = 32768;
+	const size_t MinMatch = 3;
+	const size_t MaxMatch = 258;
+	const unsigned HashBits = 15;
+	const size_t MaxChain = 128;          // candidates tried for each match
+	const size_t NiceMatch = 128;         // a match this long is taken at once
+	const size_t BlockTokens = 65536;     // literals and matches coded with one set of codes
+	const size_t None = SIZE_MAX;
+
+	const unsigned short lengthBase[29] = { 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+		35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+	const unsigned char lengthExtra[29] = { 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+		3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+	const unsigned short distBase[30] = { 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+		257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+	const unsigned char distExtra[30] = { 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+		7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+	const unsigned char lengthOrder[19] = { 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+	//length code of every match length and the CRC-32 of every byte value, made once
+	struct Tables {
+		unsigned char lengthCode[MaxMatch + 1];
+		uint32_t crc[256];
+		Tables() {
+			for (size_t code = 0; code < 29; ++code) {
+				size_t last = (code == 28) ? MaxMatch : lengthBase[code + 1] - 1;
+				for (size_t len = lengthBase[code]; len <= last; ++len)
+					lengthCode[len] = (unsigned char)code;
+			}
+			lengthCode[MaxMatch] = 28;
+			for (uint32_t byte = 0; byte < 256; ++byte) {
+				uint32_t value = byte;
+				for (int bit = 0; bit < 8; ++bit)
+					value = (value & 1) ? 0xedb88320u ^ (value >> 1) : value >> 1;
+				crc[byte] = value;
+			}
+		}
+	};
+	const Tables tables;
+
+	size_t distCode(size_t dist) {
+		return (upper_bound(distBase, distBase + 30, dist) - distBase) - 1;
+	}
+
+	//a literal, dist 0, or a match of length bytes dist back
+	struct Token {
+		unsigned short value;
+		unsigned short dist;
+	};
+
+	//writes bits from the least significant end, as deflate packs them
+	class BitWriter {
+	public:
+		BitWriter(string& out) : out_(out) {}
+		void put(uint32_t value, unsigned bits) {
+			buffer_ |= (uint64_t)value << count_;
+			count_ += bits;
+			while (count_ >= 8) {
+				out_ += (char)(buffer_ & 0xff);
+				buffer_ >>= 8;
+				count_ -= 8;
+			}
+		}
+		void flush() {
+			if (count_ > 0)
+				out_ += (char)(buffer_ & 0xff);
+			buffer_ = 0;
+			count_ = 0;
+		}
+	private:
+		string& out_;
+		uint64_t buffer_ = 0;
+		unsigned count_ = 0;
+	};
+
+	//Huffman code lengths of symbols with the given frequencies, none longer than maxBits
+	/*
+	*  At least two symbols get codes, so every code is complete.  While the
+	*  tree is too deep the frequencies are halved, which flattens it.
+	*/
+	vector<unsigned char> codeLengths(vector<size_t> freq, unsigned maxBits) {
+		size_t count = freq.size();
+		size_t used = (size_t)count_if(freq.begin(), freq.end(), [](size_t f) { return f != 0; });
+		for (size_t i = 0; used < 2 && i < count; ++i) {
+			if (freq[i] == 0) {
+				freq[i] = 1;
+				++used;
+			}
+		}
+		vector<unsigned char> lengths(count, 0);
+		for (;;) {
+			using Node = pair<size_t, size_t>;   // weight, node
+			priority_queue<Node, vector<Node>, greater<Node>> heap;
+			vector<size_t> parent(2 * count, None);
+			for (size_t i = 0; i < count; ++i) {
+				if (freq[i] != 0)
+					heap.push(Node(freq[i], i));
+			}
+			size_t next = count;
+			while (heap.size() > 1) {
+				Node a = heap.top();
+				heap.pop();
+				Node b = heap.top();
+				heap.pop();
+				parent[a.second] = parent[b.second] = next;
+				heap.push(Node(a.first + b.first, next++));
+			}
+			// a parent is made after its children, so depths are found from the root down
+			vector<unsigned> depth(next, 0);
+			unsigned deepest = 0;
+			for (size_t i = next; i-- > 0;) {
+				if (parent[i] != None)
+					depth[i] = depth[parent[i]] + 1;
+			}
+			for (size_t i = 0; i < count; ++i) {
+				lengths[i] = (unsigned char)(freq[i] != 0 ? depth[i] : 0);
+				deepest = max(deepest, (unsigned)lengths[i]);
+			}
+			if (deepest <= maxBits)
+				return lengths;
+			for (auto& f : freq) {
+				if (f != 0)
+					f = f / 2 + 1;
+			}
+		}
+	}
+
+	//canonical codes for the lengths, bit reversed for BitWriter
+	vector<uint32_t> canonicalCodes(const vector<unsigned char>& lengths) {
+		unsigned lengthCount[16] = { 0 };
+		for (auto len : lengths)
+			++lengthCount[len];
+		lengthCount[0] = 0;
+		uint32_t nextCode[16] = { 0 };
+		uint32_t code = 0;
+		for (unsigned bits = 1; bits < 16; ++bits) {
+			code = (code + lengthCount[bits - 1]) << 1;
+			nextCode[bits] = code;
+		}
+		vector<uint32_t> codes(lengths.size(), 0);
+		for (size_t i = 0; i < lengths.size(); ++i) {
+			unsigned len = lengths[i];
+			if (len == 0)
+				continue;
+			uint32_t value = nextCode[len]++;
+			uint32_t reversed = 0;
+			for (unsigned bit = 0; bit < len; ++bit)
+				reversed |= ((value >> bit) & 1) << (len - 1 - bit);
+			codes[i] = reversed;
+		}
+		return codes;
+	}
+
+	//one deflate block with dynamic Huffman codes, RFC 1951 section 3.2.7
+	void writeBlock(BitWriter& bits, const vector<Token>& tokens, bool last) {
+		vector<size_t> litFreq(286, 0), distFreq(30, 0);
+		for (auto& token : tokens) {
+			if (token.dist == 0)
+				++litFreq[token.value];
+			else {
+				++litFreq[257 + tables.lengthCode[token.value]];
+				++distFreq[distCode(token.dist)];
+			}
+		}
+		litFreq[256] = 1;
+		vector<unsigned char> litLen = codeLengths(litFreq, 15);
+		vector<unsigned char> distLen = codeLengths(distFreq, 15);
+		size_t litCount = 286, distCount = 30;
+		while (litCount > 257 && litLen[litCount - 1] == 0)
+			--litCount;
+		while (distCount > 1 && distLen[distCount - 1] == 0)
+			--distCount;
+
+		// both sets of lengths, run length coded with symbols 16, 17 and 18
+		vector<unsigned char> all(litLen.begin(), litLen.begin() + litCount);
+		all.insert(all.end(), distLen.begin(), distLen.begin() + distCount);
+		vector<pair<unsigned char, unsigned char>> runs;   // symbol, repeat bits
+		for (size_t i = 0; i < all.size();) {
+			size_t run = 1;
+			while (i + run < all.size() && all[i + run] == all[i])
+				++run;
+			if (all[i] == 0 && run >= 3) {
+				run = min(run, (size_t)138);
+				runs.push_back(run >= 11 ? make_pair((unsigned char)18, (unsigned char)(run - 11))
+					: make_pair((unsigned char)17, (unsigned char)(run - 3)));
+				i += run;
+			}
+			else if (all[i] != 0 && run >= 4) {
+				size_t repeat = min(run - 1, (size_t)6);
+				runs.push_back(make_pair(all[i], (unsigned char)0));
+				runs.push_back(make_pair((unsigned char)16, (unsigned char)(repeat - 3)));
+				i += 1 + repeat;
+			}
+			else {
+				runs.push_back(make_pair(all[i], (unsigned char)0));
+				++i;
+			}
+		}
+		vector<size_t> runFreq(19, 0);
+		for (auto& run : runs)
+			++runFreq[run.first];
+		vector<unsigned char> runLen = codeLengths(runFreq, 7);
+		vector<uint32_t> runCodes = canonicalCodes(runLen);
+		size_t orderCount = 19;
+		while (orderCount > 4 && runLen[lengthOrder[orderCount - 1]] == 0)
+			--orderCount;
+
+		bits.put(last ? 1 : 0, 1);
+		bits.put(2, 2);
+		bits.put((uint32_t)(litCount - 257), 5);
+		bits.put((uint32_t)(distCount - 1), 5);
+		bits.put((uint32_t)(orderCount - 4), 4);
+		for (size_t i = 0; i < orderCount; ++i)
+			bits.put(runLen[lengthOrder[i]], 3);
+		for (auto& run : runs) {
+			bits.put(runCodes[run.first], runLen[run.first]);
+			if (run.first == 16)
+				bits.put(run.second, 2);
+			else if (run.first == 17)
+				bits.put(run.second, 3);
+			else if (run.first == 18)
+				bits.put(run.second, 7);
+		}
+
+		vector<uint32_t> litCodes = canonicalCodes(litLen);
+		vector<uint32_t> distCodes = canonicalCodes(distLen);
+		for (auto& token : tokens) {
+			if (token.dist == 0) {
+				bits.put(litCodes[token.value], litLen[token.value]);
+				continue;
+			}
+			size_t code = tables.lengthCode[token.value];
+			bits.put(litCodes[257 + code], litLen[257 + code]);
+			bits.put(token.value - lengthBase[code], lengthExtra[code]);
+			size_t dcode = distCode(token.dist);
+			bits.put(distCodes[dcode], distLen[dcode]);
+			bits.put(token.dist - distBase[dcode], distExtra[dcode]);
+		}
+		bits.put(litCodes[256], litLen[256]);
+	}
+
+	//finds repeated strings through chains of earlier positions with the same three byte hash
+	class Matcher {
+	public:
+		Matcher(const string& bytes) : in_((const unsigned char*)bytes.data()), size_(bytes.size()),
+			head_((size_t)1 << HashBits, None), prev_(WindowSize, None) {}
+		void insert(size_t pos) {
+			if (pos + MinMatch > size_)
+				return;
+			size_t& first = head_[hash(pos)];
+			prev_[pos & (WindowSize - 1)] = first;
+			first = pos;
+		}
+		size_t find(size_t pos, size_t& dist) const {
+			if (pos + MinMatch > size_)
+				return 0;
+			size_t limit = min(MaxMatch, size_ - pos);
+			size_t best = 0;
+			size_t chain = MaxChain;
+			for (size_t cand = head_[hash(pos)]; cand != None && cand < pos && pos - cand <= WindowSize && chain-- > 0;) {
+				if (in_[cand + best] == in_[pos + best]) {
+					size_t len = 0;
+					while (len < limit && in_[cand + len] == in_[pos + len])
+						++len;
+					if (len > best) {
+						best = len;
+						dist = pos - cand;
+						if (len >= limit || len >= NiceMatch)
+							break;
+					}
+				}
+				size_t next = prev_[cand & (WindowSize - 1)];
+				if (next == None || next >= cand)
+					break;
+				cand = next;
+			}
+			return best >= MinMatch ? best : 0;
+		}
+	private:
+		size_t hash(size_t pos) const {
+			uint32_t key = in_[pos] | (in_[pos + 1] << 8) | (in_[pos + 2] << 16);
+			return (key * 2654435761u) >> (32 - HashBits);
+		}
+		const unsigned char* in_;
+		size_t size_;
+		vector<size_t> head_;
+		vector<size_t> prev_;
+	};
+
+	void putBytes(string& out, uint32_t value, size_t count) {
+		for (size_t i = 0; i < count; ++i, value >>= 8)
+			out += (char)(value & 0xff);
+	}
+}
+
+//----< gzip file, RFC 1952, of bytes, deflated >------------------
+/*
+*  A match found at a position is held back while the next position is
+*  tried; if that one starts a longer match the held byte goes out as a
+*  literal instead.
+*/
+string Gzip::compress(const string& bytes) {
+	string out;
+	out.reserve(bytes.size() / 3 + 64);
+	const char header[10] = { '\x1f', '\x8b', 8, 0, 0, 0, 0, 0, 0, 11 };   // deflate, no name or time, NTFS
+	out.append(header, sizeof(header));
+	BitWriter bits(out);
+	Matcher matcher(bytes);
+	vector<Token> tokens;
+	tokens.reserve(BlockTokens);
+	auto emit = [&](unsigned short value, unsigned short dist) {
+		tokens.push_back(Token{ value, dist });
+		if (tokens.size() == BlockTokens) {
+			writeBlock(bits, tokens, false);
+			tokens.clear();
+		}
+	};
+	size_t held = 0, heldDist = 0;   // length and distance of a match at pos - 1
+	for (size_t pos = 0; pos < bytes.size();) {
+		size_t dist = 0;
+		size_t len = (held >= NiceMatch) ? 0 : matcher.find(pos, dist);
+		if (held != 0 && len <= held) {
+			emit((unsigned short)held, (unsigned short)heldDist);
+			size_t end = pos - 1 + held;
+			for (; pos < end; ++pos)
+				matcher.insert(pos);
+			held = 0;
+			continue;
+		}
+		if (held != 0)
+			emit((unsigned char)bytes[pos - 1], 0);
+		matcher.insert(pos);
+		if (len != 0) {
+			held = len;
+			heldDist = dist;
+		}
+		else
+			emit((unsigned char)bytes[pos], 0);
+		++pos;
+	}
+	if (held != 0)
+		emit((unsigned short)held, (unsigned short)heldDist);
+	writeBlock(bits, tokens, true);
+	bits.flush();
+	putBytes(out, crc32(bytes.data(), bytes.size()), 4);
+	putBytes(out, (uint32_t)bytes.size(), 4);
+	return out;
+}
+
+//----< CRC-32 of a buffer, the check gzip stores >----------------
+unsigned long Gzip::crc32(const char* bytes, size_t count) {
+	uint32_t crc = 0xffffffffu;
+	for (size_t i = 0; i < count; ++i)
+		crc = tables.crc[(crc ^ (unsigned char)bytes[i]) & 0xff] ^ (crc >> 8);
+	return crc ^ 0xffffffffu;
+}
+
+#ifdef TEST_GZIP
+
+#include <iostream>
+#include <fstream>
+
+int main() {
+	std::ifstream in("../CodePublisher/publisher.cpp", std::ios::binary);
+	std::string page((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::string zipped = Gzip::compress(page);
+	std::cout << "\n  " << page.size() << " bytes compressed to " << zipped.size();
+	std::cout << "\n  crc32 of \"123456789\": " << std::hex << Gzip::crc32("123456789", 9) << " (cbf43926)";
+	std::ofstream out("../TestFiles/publisher.cpp.gz", std::ios::binary);
+	out << zipped;
+	std::cout << "\n  wrote ../TestFiles/publisher.cpp.gz, gunzip it to compare\n\n";
+}
+
+#endif
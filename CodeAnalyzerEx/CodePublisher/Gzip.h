@@ -0,0 +1,50 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// Gzip.h: Compresses published pages into gzip files browsers decode                  //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package makes a gzip file, RFC 1952, of a string of bytes, so the publisher can
+* write each page's compressed variant once, when the page is rendered, and a server
+* sends it with Content-Encoding: gzip, compressing nothing per request
+* The data is deflated, RFC 1951: repeated strings within the last 32 KB are found
+* through hash chains, with one step of lazy matching, and each block of up to 64K
+* literals and matches gets its own Huffman codes
+* Escaped source text repeats a lot, its keywords, indentation and entities, so pages
+* shrink several times
+*
+*
+* Public Interface
+* --------------------
+*  static std::string compress(const std::string& bytes);        //gzip file holding bytes
+*  static unsigned long crc32(const char* bytes, size_t count);  //CRC-32 of a buffer, as gzip checks it
+*
+*
+* Required Files:
+* ---------------
+*   -Gzip.h, Gzip.cpp
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include <string>
+
+class Gzip {
+public:
+	static std::string compress(const std::string& bytes);
+	static unsigned long crc32(const char* bytes, size_t count);
+};
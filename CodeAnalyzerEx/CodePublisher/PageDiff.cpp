@@ -0,0 +1,224 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PageDiff.cpp: Line patches between two versions of a published page                 //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+
+#include "PageDiff.h"
+#include <vector>
+#include <algorithm>
+
+namespace {
+	struct Line {
+		size_t pos;
+		size_t size;                // with its '\n'
+		unsigned long long hash;    // FNV-1a of its bytes
+	};
+	enum Op : char { Keep, Delete, Insert };
+
+	void splitLines(const std::string& text, std::vector<Line>& lines) {
+		size_t pos = 0;
+		while (pos < text.size()) {
+			size_t end = text.find('\n', pos);
+			end = (end == std::string::npos) ? text.size() : end + 1;
+			unsigned long long hash = 14695981039346656037ULL;
+			for (size_t i = pos; i < end; ++i) {
+				hash ^= (unsigned char)text[i];
+				hash *= 1099511628211ULL;
+			}
+			Line line = { pos, end - pos, hash };
+			lines.push_back(line);
+			pos = end;
+		}
+	}
+
+	inline bool sameLine(const std::string& a, const Line& x, const std::string& b, const Line& y) {
+		return x.hash == y.hash && x.size == y.size && a.compare(x.pos, x.size, b, y.pos, y.size) == 0;
+	}
+
+	//shortest edit of a's lines first to first + n into b's first to first + m, Myers' greedy walk
+	/*
+	*  trace[d] keeps the furthest x on each diagonal -d to d after d edits, so the
+	*  walk back from the end finds the edit taken at each step.  The ops are
+	*  appended to ops, and none are when more than maxEdits are needed, false.
+	*/
+	bool shortestEdit(const std::string& from, const std::vector<Line>& a, const std::string& to, const std::vector<Line>& b,
+		size_t first, int n, int m, int maxEdits, std::vector<char>& ops) {
+		int limit = (std::min)(n + m, maxEdits);
+		int off = limit + 1;
+		std::vector<int> v(2 * limit + 3, 0);
+		std::vector<std::vector<int>> trace;
+		size_t start = ops.size();
+		int found = -1;
+		for (int d = 0; d <= limit && found < 0; ++d) {
+			for (int k = -d; k <= d; k += 2) {
+				int x = (k == -d || (k != d && v[off + k - 1] < v[off + k + 1])) ? v[off + k + 1] : v[off + k - 1] + 1;
+				int y = x - k;
+				while (x < n && y < m && sameLine(from, a[first + x], to, b[first + y])) {
+					++x;
+					++y;
+				}
+				v[off + k] = x;
+				if (x >= n && y >= m)
+					found = d;
+			}
+			trace.push_back(std::vector<int>(v.begin() + off - d, v.begin() + off + d + 1));
+		}
+		if (found < 0)
+			return false;
+		int x = n, y = m;
+		for (int d = found; d > 0; --d) {
+			const std::vector<int>& prev = trace[d - 1];
+			auto at = [&prev, d](int k) { return prev[k + d - 1]; };
+			int k = x - y;
+			bool down = (k == -d || (k != d && at(k - 1) < at(k + 1)));
+			int prevK = down ? k + 1 : k - 1;
+			int prevX = at(prevK);
+			int prevY = prevX - prevK;
+			int startX = down ? prevX : prevX + 1;
+			for (; x > startX; --x, --y)
+				ops.push_back(Keep);
+			ops.push_back(down ? Insert : Delete);
+			x = prevX;
+			y = prevY;
+		}
+		for (; x > 0; --x)
+			ops.push_back(Keep);
+		std::reverse(ops.begin() + start, ops.end());
+		return true;
+	}
+
+	void appendRun(std::string& patch, char op, size_t count) {
+		patch += op;
+		patch += std::to_string(count);
+		patch += '\n';
+	}
+}
+
+//----< patch turning from into to >---------------------------------
+/*
+*  - runs of ops of one kind become one operation, an insert run's bytes are
+*    the lines of to it covers, contiguous in to
+*/
+std::string PageDiff::make(const std::string& from, const std::string& to) {
+	std::vector<Line> a, b;
+	splitLines(from, a);
+	splitLines(to, b);
+	size_t prefix = 0;
+	while (prefix < a.size() && prefix < b.size() && sameLine(from, a[prefix], to, b[prefix]))
+		++prefix;
+	size_t suffix = 0;
+	while (suffix < a.size() - prefix && suffix < b.size() - prefix &&
+		sameLine(from, a[a.size() - 1 - suffix], to, b[b.size() - 1 - suffix]))
+		++suffix;
+	int n = (int)(a.size() - prefix - suffix);
+	int m = (int)(b.size() - prefix - suffix);
+
+	std::vector<char> ops(prefix, Keep);
+	if (!shortestEdit(from, a, to, b, prefix, n, m, (int)MaxEdits, ops)) {
+		ops.insert(ops.end(), n, Delete);
+		ops.insert(ops.end(), m, Insert);
+	}
+	ops.insert(ops.end(), suffix, Keep);
+
+	std::string patch;
+	size_t bi = 0;
+	for (size_t i = 0; i < ops.size();) {
+		size_t j = i;
+		while (j < ops.size() && ops[j] == ops[i])
+			++j;
+		size_t count = j - i;
+		if (ops[i] == Insert) {
+			size_t begin = b[bi].pos;
+			size_t end = b[bi + count - 1].pos + b[bi + count - 1].size;
+			appendRun(patch, '+', end - begin);
+			patch.append(to, begin, end - begin);
+		}
+		else
+			appendRun(patch, ops[i] == Keep ? '=' : '-', count);
+		if (ops[i] != Delete)
+			bi += count;
+		i = j;
+	}
+	return patch;
+}
+//----< to is from with patch applied, false if patch doesn't fit from >---
+/*
+*  - every operation's counts are checked against from's lines and the patch's
+*    bytes, and the patch must use all of from's lines
+*/
+bool PageDiff::apply(const std::string& from, const std::string& patch, std::string& to) {
+	std::vector<size_t> starts;
+	for (size_t pos = 0; pos < from.size();) {
+		starts.push_back(pos);
+		size_t end = from.find('\n', pos);
+		pos = (end == std::string::npos) ? from.size() : end + 1;
+	}
+	starts.push_back(from.size());
+	size_t lines = starts.size() - 1;
+	to.clear();
+	size_t next = 0;
+	size_t pos = 0;
+	while (pos < patch.size()) {
+		char op = patch[pos];
+		size_t eol = patch.find('\n', pos);
+		if (eol == std::string::npos || eol == pos + 1)
+			return false;
+		size_t count = 0;
+		for (size_t i = pos + 1; i < eol; ++i) {
+			if (patch[i] < '0' || patch[i] > '9')
+				return false;
+			count = count * 10 + (patch[i] - '0');
+		}
+		pos = eol + 1;
+		switch (op) {
+		case '=':
+			if (count > lines - next)
+				return false;
+			to.append(from, starts[next], starts[next + count] - starts[next]);
+			next += count;
+			break;
+		case '-':
+			if (count > lines - next)
+				return false;
+			next += count;
+			break;
+		case '+':
+			if (count > patch.size() - pos)
+				return false;
+			to.append(patch, pos, count);
+			pos += count;
+			break;
+		default:
+			return false;
+		}
+	}
+	return next == lines;
+}
+
+#ifdef TEST_PAGEDIFF
+
+#include <iostream>
+#include <fstream>
+
+int main() {
+	std::ifstream in("../CodePublisher/publisher.cpp", std::ios::binary);
+	std::string page((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	std::string edited = page;
+	size_t line = edited.find('\n', edited.size() / 2);
+	edited.insert(line + 1, "//one line added\n");
+	edited.erase(0, edited.find('\n') + 1);
+	std::string patch = PageDiff::make(page, edited);
+	std::string patched;
+	bool applied = PageDiff::apply(page, patch, patched);
+	std::cout << "\n  " << page.size() << " byte page, " << patch.size() << " byte patch, applied: "
+		<< (applied && patched == edited ? "same" : "different");
+	std::string whole = PageDiff::make("", edited);
+	std::cout << "\n  patch from nothing applied: " << (PageDiff::apply("", whole, patched) && patched == edited ? "same" : "different");
+	std::cout << "\n  patch refused by another page: " << (PageDiff::apply(page.substr(0, line), patch, patched) ? "no" : "yes") << "\n\n";
+}
+
+#endif
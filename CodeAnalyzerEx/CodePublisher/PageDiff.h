@@ -0,0 +1,57 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PageDiff.h: Line patches between two versions of a published page                   //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package makes a patch that turns one version of a page into another, line by
+* line, so a server can send a client holding the old version only what changed
+* Pages are rendered a source line to a line, so a small edit leaves most lines alike
+* Lines the two versions begin and end with are matched first, and the lines left
+* between are compared with Myers' O(ND) difference, lines compared by hash first
+* A middle part with more than MaxEdits inserted and deleted lines is replaced whole
+* The patch is a list of operations, each a header line and, for inserts, bytes:
+*   =N    copy the next N lines of the old version
+*   -N    skip the next N lines of the old version
+*   +B    B bytes follow, whole lines of the new version
+* A line holds its '\n', the last one may not have one, so CR LF pages are kept whole
+* apply checks the operations against the old version, the caller checks the etag of
+* the result, so a patch applied to any other version is refused
+*
+*
+* Public Interface
+* --------------------
+*  static std::string make(const std::string& from, const std::string& to);   //patch from from to to
+*  static bool apply(const std::string& from, const std::string& patch, std::string& to);
+*                                                                              //false if patch doesn't fit from
+*
+*
+* Required Files:
+* ---------------
+*   -PageDiff.h, PageDiff.cpp
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include <string>
+
+class PageDiff {
+public:
+	static const size_t MaxEdits = 4096;   // more inserted and deleted lines replace the middle whole
+	static std::string make(const std::string& from, const std::string& to);
+	static bool apply(const std::string& from, const std::string& patch, std::string& to);
+};
@@ -0,0 +1,280 @@
+///////////////////////////////////////////////////////////////////
+// PageGenerations.cpp: Publishes each run as one generation     //
+// ver 1.0                                                       //
+// Application: Dependency Based Code Publisher, Spring 2017     //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project3             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "PageGenerations.h"
+#include "PagePack.h"
+#include <windows.h>
+#include <fstream>
+#include <cstdlib>
+#include <cstring>
+
+using namespace std;
+
+namespace {
+	const char* PointerName = "pages.current";
+	const char* GenerationsName = "generations";
+
+	//the page a compressed variant belongs to, name itself for a page
+	string pageOf(const string& name) {
+		for (const char* suffix : { ".gz", ".br" }) {
+			size_t size = strlen(suffix);
+			if (name.size() > size && name.compare(name.size() - size, size, suffix) == 0)
+				return name.substr(0, name.size() - size);
+		}
+		return name;
+	}
+
+	bool isDot(const string& directory) {
+		return directory == "." || directory == "..";
+	}
+}
+
+PageGenerations::PageGenerations(const string& root)
+	: root_(PagePack::withSlash(root)), fullRoot_(PagePack::fullRootOf(root)) {}
+
+//----< start the generation after the committed one >-------------
+/*
+*  A directory left by a run that stopped before its commit is emptied
+*  first, so none of its pages are served as this run's.
+*/
+bool PageGenerations::begin() {
+	lock_guard<mutex> lock(mtx_);
+	current_ = readCurrent(root_);
+	committed_ = current_ ? namesIn(directoryOf(root_, current_)) : set<string>();
+	staged_.clear();
+	next_ = current_ + 1;
+	removeGeneration(next_);
+	string directory = directoryOf(root_, next_);
+	FileSystem::Directory::create(root_ + GenerationsName);
+	FileSystem::Directory::create(directory.substr(0, directory.size() - 1));
+	if (!FileSystem::Directory::exists(directory.substr(0, directory.size() - 1))) {
+		next_ = 0;
+		return false;
+	}
+	return true;
+}
+
+//----< file in the staged generation a page under the root is written to >---
+/*
+*  Pages are published in the root or one directory below it; other
+*  files, and any file before begin, are written where they are, "".
+*  Safe on the publisher's renderer threads.
+*/
+string PageGenerations::stage(const string& fileSpec) {
+	string name = PagePack::nameUnder(fullRoot_, fileSpec);
+	size_t slash = name.find('/');
+	if (name == "" || (slash != string::npos && name.find('/', slash + 1) != string::npos))
+		return "";
+	lock_guard<mutex> lock(mtx_);
+	if (next_ == 0)
+		return "";
+	string directory = directoryOf(root_, next_);
+	if (slash != string::npos && staged_.find(name) == staged_.end())
+		FileSystem::Directory::create(directory + name.substr(0, slash));
+	staged_.insert(name);
+	return directory + name;
+}
+
+//----< is the page staged this run, or in the committed generation? >---
+bool PageGenerations::published(const string& fileSpec) {
+	string name = PagePack::nameUnder(fullRoot_, fileSpec);
+	lock_guard<mutex> lock(mtx_);
+	return name != "" && (staged_.find(name) != staged_.end() || committed_.find(name) != committed_.end());
+}
+
+//----< link unchanged pages forward and swap in pages.current >---
+/*
+*  A page that can't be linked or copied is left out of the generation,
+*  so the next incremental run, finding it unpublished, renders it again.
+*  The generation just replaced is kept for readers still sending its
+*  files, older ones are removed.
+*/
+bool PageGenerations::commit() {
+	lock_guard<mutex> lock(mtx_);
+	if (next_ == 0)
+		return false;
+	set<string> held = staged_;
+	for (auto& name : committed_) {
+		if (staged_.find(pageOf(name)) == staged_.end() && linkForward(name))
+			held.insert(name);
+	}
+	string pointer = root_ + PointerName;
+	string temp = pointer + ".tmp";
+	{
+		ofstream out(temp, ios::binary | ios::trunc);
+		out << "generation " << next_ << "\n";
+		if (!out.good()) {
+			out.close();
+			FileSystem::File::remove(temp);
+			return false;
+		}
+	}
+	if (!PagePack::swapIn(temp, pointer))
+		return false;
+	for (auto& directory : FileSystem::Directory::getDirectories(root_ + GenerationsName)) {
+		unsigned long generation = strtoul(directory.c_str(), nullptr, 10);
+		if (generation != 0 && generation < current_)
+			removeGeneration(generation);
+	}
+	current_ = next_;
+	committed_.swap(held);
+	staged_.clear();
+	next_ = 0;
+	return true;
+}
+
+//----< hard link a committed page into the staged generation >----
+bool PageGenerations::linkForward(const string& name) {
+	string from = directoryOf(root_, current_) + name;
+	string to = directoryOf(root_, next_) + name;
+	size_t slash = name.find('/');
+	if (slash != string::npos)
+		FileSystem::Directory::create(directoryOf(root_, next_) + name.substr(0, slash));
+	return ::CreateHardLinkA(to.c_str(), from.c_str(), NULL) || FileSystem::File::copy(from, to);
+}
+
+//----< delete a generation's files and directories, best effort >--
+void PageGenerations::removeGeneration(unsigned long generation) {
+	string directory = directoryOf(root_, generation);
+	for (auto& sub : FileSystem::Directory::getDirectories(directory)) {
+		if (isDot(sub))
+			continue;
+		for (auto& file : FileSystem::Directory::getFiles(directory + sub))
+			FileSystem::File::remove(directory + sub + "/" + file);
+		FileSystem::Directory::remove(directory + sub);
+	}
+	for (auto& file : FileSystem::Directory::getFiles(directory))
+		FileSystem::File::remove(directory + file);
+	FileSystem::Directory::remove(directory.substr(0, directory.size() - 1));
+}
+
+//----< generation pages.current names, 0 if there is none >-------
+/*
+*  The file is opened sharing delete, so a commit can rename over it
+*  while it is read.
+*/
+unsigned long PageGenerations::readCurrent(const string& root) {
+	string pointer = PagePack::withSlash(root) + PointerName;
+	HANDLE hFile = ::CreateFileA(pointer.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return 0;
+	char text[64] = { 0 };
+	DWORD got = 0;
+	BOOL read = ::ReadFile(hFile, text, sizeof(text) - 1, &got, NULL);
+	::CloseHandle(hFile);
+	const char* key = "generation ";
+	if (!read || strncmp(text, key, strlen(key)) != 0)
+		return 0;
+	return strtoul(text + strlen(key), nullptr, 10);
+}
+
+string PageGenerations::directoryOf(const string& root, unsigned long generation) {
+	return PagePack::withSlash(root) + GenerationsName + "/" + to_string(generation) + "/";
+}
+
+//----< names of the files in a generation and its directories >---
+set<string> PageGenerations::namesIn(const string& directory) {
+	set<string> names;
+	for (auto& file : FileSystem::Directory::getFiles(directory))
+		names.insert(file);
+	for (auto& sub : FileSystem::Directory::getDirectories(directory)) {
+		if (isDot(sub))
+			continue;
+		for (auto& file : FileSystem::Directory::getFiles(directory + sub))
+			names.insert(sub + "/" + file);
+	}
+	return names;
+}
+
+/////////////////////////////////////////////////////////////////////
+// GenerationReader
+
+GenerationReader::GenerationReader(const string& root) : root_(PagePack::withSlash(root)) {}
+
+//----< the committed generation, listed again when pages.current moves >---
+/*
+*  A pointer that can't be read, e.g., while it is being replaced,
+*  leaves the last snapshot in use.
+*/
+shared_ptr<const GenerationReader::Snapshot> GenerationReader::current() {
+	FileSystem::FileInfo now(root_ + PointerName);
+	bool committed = now.good();
+	lock_guard<mutex> lock(mtx_);
+	if (!committed) {
+		snapshot_.reset();
+		return snapshot_;
+	}
+	if (snapshot_ && !snapshot_->committed.earlier(now) && !now.earlier(snapshot_->committed) &&
+		snapshot_->committed.size() == now.size())
+		return snapshot_;
+	unsigned long generation = PageGenerations::readCurrent(root_);
+	if (generation == 0)
+		return snapshot_;
+	shared_ptr<Snapshot> loaded = make_shared<Snapshot>(root_ + PointerName);
+	loaded->directory = PageGenerations::directoryOf(root_, generation);
+	loaded->names = PageGenerations::namesIn(loaded->directory);
+	snapshot_ = loaded;
+	return snapshot_;
+}
+
+//----< file serving name: its committed copy, or the root's file >---
+/*
+*  A loose page written after the commit, e.g., by a later run that
+*  didn't stage a generation, is served from the root.
+*/
+string GenerationReader::find(const string& name) {
+	if (name == "" || name.find("..") != string::npos)
+		return "";
+	shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot || snapshot->names.find(name) == snapshot->names.end())
+		return root_ + name;
+	FileSystem::FileInfo loose(root_ + name);
+	if (loose.good() && !loose.earlier(snapshot->committed))
+		return root_ + name;
+	return snapshot->directory + name;
+}
+
+//----< committed names ending with ending, in name order >--------
+vector<string> GenerationReader::names(const string& ending) {
+	vector<string> found;
+	shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot)
+		return found;
+	for (auto& name : snapshot->names) {
+		if (name.size() >= ending.size() && name.compare(name.size() - ending.size(), ending.size(), ending) == 0)
+			found.push_back(name);
+	}
+	return found;
+}
+
+#ifdef TEST_PAGEGENERATIONS
+
+#include <iostream>
+
+int main() {
+	FileSystem::Directory::create("../TestFiles/gens");
+	PageGenerations gens("../TestFiles/gens");
+	GenerationReader reader("../TestFiles/gens/");
+	std::cout << "\n  began: " << std::boolalpha << gens.begin();
+	std::ofstream(gens.stage("../TestFiles/gens/A/Parent.h.html")) << "<html>parent</html>\n";
+	std::ofstream(gens.stage("../TestFiles/gens/A/Child.h.html")) << "<html>child</html>\n";
+	std::cout << "\n  before the commit A/Parent.h.html is served from: " << reader.find("A/Parent.h.html");
+	std::cout << "\n  committed: " << gens.commit();
+	std::cout << "\n  A/Parent.h.html is served from: " << reader.find("A/Parent.h.html");
+	gens.begin();
+	std::ofstream(gens.stage("../TestFiles/gens/A/Child.h.html")) << "<html>child, again</html>\n";
+	std::cout << "\n  while staging A/Child.h.html is served from: " << reader.find("A/Child.h.html");
+	gens.commit();
+	for (auto& name : reader.names(".html"))
+		std::cout << "\n  " << name << ": " << reader.find(name);
+	std::cout << "\n";
+}
+
+#endif
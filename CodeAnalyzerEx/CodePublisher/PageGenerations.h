@@ -0,0 +1,108 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PageGenerations.h: Publishes each run's pages as a generation swapped in at once    //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* A publish that rewrites pages in place lets a server read a page half written, or
+* send some pages of the new run with others of the last one.  This package renders
+* each run into its own directory, root/generations/N/, with the same layout as the
+* root, e.g., generations/4/Parser/Parser.cpp.html, and names the generation served in
+* one small file, root/pages.current, which is replaced in one rename when every page
+* of the run is written.  Until then the last generation is served, untouched
+*
+* PageGenerations is the publisher's side.  begin starts generation N+1, stage gives
+* the file a page of the root is written to in it, and commit hard links each page of
+* generation N that wasn't rendered again into N+1, so unchanged pages are shared, not
+* copied or rewritten, and then swaps pages.current.  Generations before N are removed,
+* best effort, as a reader may still have a file of generation N open
+*
+* GenerationReader is the server's side.  find gives the file that serves a page name,
+* in the committed generation, or under the root as before when the generation doesn't
+* hold it, e.g., CSS and JavaScript, or when a loose page was written after the commit.
+* It reads pages.current again only when its write time or size moves, and lists the
+* generation's names once per commit
+*
+*
+* Public Interface
+* --------------------
+*  PageGenerations gens("../Repository");             //publisher side
+*  bool ok = gens.begin();                            //start the next generation
+*  std::string file = gens.stage(fileSpec);           //where a page under the root is written, "" if outside
+*  bool held = gens.published(fileSpec);              //staged this run, or in the committed generation?
+*  bool ok = gens.commit();                           //link unchanged pages forward and swap pages.current
+*  GenerationReader reader("../Repository/");         //server side
+*  std::string file = reader.find(name);              //file serving name, e.g., Parser/Parser.cpp.html
+*  std::vector<std::string> names = reader.names(".html"); //committed names ending with .html
+*
+*
+* Required Files:
+* ---------------
+*   -PageGenerations.h, PageGenerations.cpp, PagePack.h, PagePack.cpp, FileSystem.h
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include "../FileSystem/FileSystem.h"
+#include <string>
+#include <vector>
+#include <set>
+#include <memory>
+#include <mutex>
+
+class PageGenerations {
+public:
+	PageGenerations(const std::string& root);
+	bool begin();
+	std::string stage(const std::string& fileSpec);
+	bool published(const std::string& fileSpec);
+	bool commit();
+
+	static unsigned long readCurrent(const std::string& root);
+	static std::string directoryOf(const std::string& root, unsigned long generation);
+	static std::set<std::string> namesIn(const std::string& directory);
+private:
+	bool linkForward(const std::string& name);
+	void removeGeneration(unsigned long generation);
+
+	std::string root_;       // ends with '/'
+	std::string fullRoot_;   // full path, ends with '\'
+	unsigned long current_ = 0;   // committed generation, 0 for none
+	unsigned long next_ = 0;      // generation being staged, 0 before begin
+	std::set<std::string> committed_;   // page names in current_
+	std::set<std::string> staged_;      // page names written into next_
+	std::mutex mtx_;
+};
+
+class GenerationReader {
+public:
+	GenerationReader(const std::string& root);
+	std::string find(const std::string& name);
+	std::vector<std::string> names(const std::string& ending);
+private:
+	struct Snapshot {
+		Snapshot(const std::string& pointer) : committed(pointer) {}
+		FileSystem::FileInfo committed;   // pages.current, as it was when read
+		std::string directory;            // the generation's directory, ends with '/'
+		std::set<std::string> names;
+	};
+	std::shared_ptr<const Snapshot> current();
+
+	std::string root_;   // ends with '/'
+	std::mutex mtx_;
+	std::shared_ptr<const Snapshot> snapshot_;
+};
@@ -0,0 +1,415 @@
+///////////////////////////////////////////////////////////////////
+// PagePack.cpp: Keeps published pages in one indexed pack file  //
+// ver 1.0                                                       //
+// Application: Dependency Based Code Publisher, Spring 2017     //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project3             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "PagePack.h"
+#include "PublishManifest.h"
+#include "../FileSystem/FileSystem.h"
+#include <windows.h>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+	const char* IndexName = "pages.index";
+}
+
+PagePack::PagePack(const string& root) : root_(withSlash(root)), fullRoot_(fullRootOf(root)) {}
+
+//----< root with a trailing separator, so file names can be appended >---
+string PagePack::withSlash(const string& root) {
+	if (root == "")
+		return "./";
+	char last = root.back();
+	return (last == '/' || last == '\\') ? root : root + "/";
+}
+
+//----< full path of root with a trailing separator >--------------
+string PagePack::fullRootOf(const string& root) {
+	string full = FileSystem::Path::getFullFileSpec(withSlash(root));
+	if (full.size() > 0 && full.back() != '\\' && full.back() != '/')
+		full += '\\';
+	return full;
+}
+
+//----< load the last index and open its pack for appending >------
+/*
+*  Starts the next pack, copying the live pages, when there is no pack
+*  yet, when it is shorter than its index says, or when replaced pages
+*  outweigh live ones by more than CompactBytes.
+*/
+bool PagePack::open() {
+	lock_guard<mutex> lock(mtx_);
+	out_.close();
+	out_.clear();
+	old_ = "";
+	string pack;
+	if (!readIndex(root_ + IndexName, pack, dead_, index_)) {
+		pack = "";
+		dead_ = 0;
+		index_.clear();
+	}
+	size_t live = 0, packed = 0;
+	for (auto& item : index_) {
+		live += item.second.size;
+		packed = max(packed, item.second.offset + item.second.size);
+	}
+	if (pack == "")
+		return startPack(pack);
+	FileSystem::FileInfo info(root_ + pack);
+	if (!info.good() || info.size() < packed || (dead_ > live && dead_ > CompactBytes))
+		return startPack(pack);
+	pack_ = pack;
+	end_ = info.size();
+	out_.open(root_ + pack_, ios::binary | ios::app);
+	removeStalePacks();
+	return out_.good();
+}
+
+//----< start the pack after old, with old's live pages copied in >---
+/*
+*  A page that can't be read back whole from old is dropped, so it is
+*  published again.  old is deleted by the next commit that swaps in an
+*  index no longer naming it, if no reader still maps it.
+*/
+bool PagePack::startPack(const string& old) {
+	unsigned long generation = 0;
+	if (old.compare(0, 6, "pages.") == 0)
+		generation = strtoul(old.c_str() + 6, nullptr, 10);
+	pack_ = "pages." + to_string(generation + 1) + ".pack";
+	out_.open(root_ + pack_, ios::binary | ios::trunc);
+	if (!out_.good())
+		return false;
+	end_ = 0;
+	Index live;
+	ifstream in;
+	if (old != "")
+		in.open(root_ + old, ios::binary);
+	string bytes;
+	for (auto& item : index_) {
+		const Entry& entry = item.second;
+		bytes.resize(entry.size);
+		if (!in.is_open() || !in.seekg(entry.offset) || (entry.size > 0 && !in.read(&bytes[0], entry.size))) {
+			in.clear();
+			continue;
+		}
+		if (PublishManifest::textHash(bytes) != entry.etag)
+			continue;
+		out_.write(bytes.data(), bytes.size());
+		Entry& copied = live[item.first];
+		copied = entry;
+		copied.offset = end_;
+		end_ += entry.size;
+	}
+	index_.swap(live);
+	dead_ = 0;
+	old_ = old;
+	removeStalePacks();
+	return out_.good();
+}
+
+//----< delete packs left by earlier publishes, best effort >------
+void PagePack::removeStalePacks() {
+	for (auto& file : FileSystem::Directory::getFiles(root_, "pages.*.pack")) {
+		if (file != pack_ && file != old_)
+			FileSystem::File::remove(root_ + file);
+	}
+}
+
+//----< name of a page file under the root, "" if it isn't under it >---
+string PagePack::nameOf(const string& fileSpec) const {
+	return nameUnder(fullRoot_, fileSpec);
+}
+
+//----< name of a file under fullRoot, as fullRootOf makes it, with '/' separators >---
+string PagePack::nameUnder(const string& fullRoot, const string& fileSpec) {
+	string full = FileSystem::Path::getFullFileSpec(fileSpec);
+	if (full.size() <= fullRoot.size() ||
+		FileSystem::Path::toLower(full.substr(0, fullRoot.size())) != FileSystem::Path::toLower(fullRoot))
+		return "";
+	string name = full.substr(fullRoot.size());
+	replace(name.begin(), name.end(), '\\', '/');
+	return name;
+}
+
+//----< append a page, unless the packed one has the same content >---
+/*
+*  Safe on the publisher's renderer threads, the page is hashed before
+*  the lock is taken.
+*/
+bool PagePack::add(const string& name, const string& bytes) {
+	string etag = PublishManifest::textHash(bytes);
+	lock_guard<mutex> lock(mtx_);
+	if (!out_.is_open() || name == "")
+		return false;
+	auto iter = index_.find(name);
+	if (iter != index_.end() && iter->second.etag == etag && iter->second.size == bytes.size())
+		return true;
+	out_.write(bytes.data(), bytes.size());
+	if (!out_.good())
+		return false;
+	if (iter != index_.end())
+		dead_ += iter->second.size;
+	Entry& entry = index_[name];
+	entry.offset = end_;
+	entry.size = bytes.size();
+	entry.etag = etag;
+	end_ += bytes.size();
+	return true;
+}
+
+//----< drop a page, e.g., a compressed variant no longer written >---
+void PagePack::remove(const string& name) {
+	lock_guard<mutex> lock(mtx_);
+	auto iter = index_.find(name);
+	if (iter == index_.end())
+		return;
+	dead_ += iter->second.size;
+	index_.erase(iter);
+}
+
+bool PagePack::has(const string& name) {
+	lock_guard<mutex> lock(mtx_);
+	return index_.find(name) != index_.end();
+}
+
+//----< write the index and rename it over pages.index >-----------
+/*
+*  The pack is flushed first, so every page the new index names is in
+*  the file when a reader maps it.
+*/
+bool PagePack::commit() {
+	lock_guard<mutex> lock(mtx_);
+	if (!out_.is_open())
+		return false;
+	out_.flush();
+	if (!out_.good())
+		return false;
+	string indexName = root_ + IndexName;
+	string temp = indexName + ".tmp";
+	{
+		ofstream out(temp, ios::binary | ios::trunc);
+		out << "pack " << pack_ << "\n";
+		out << "dead " << dead_ << "\n";
+		for (auto& item : index_)
+			out << "page " << item.second.offset << " " << item.second.size << " " << item.second.etag << " " << item.first << "\n";
+		if (!out.good()) {
+			out.close();
+			FileSystem::File::remove(temp);
+			return false;
+		}
+	}
+	if (!swapIn(temp, indexName))
+		return false;
+	if (old_ != "" && FileSystem::File::remove(root_ + old_))
+		old_ = "";
+	return true;
+}
+
+//----< rename temp over target, removing temp if it can't >------
+/*
+*  A reader that has target open, for a moment, can keep the rename
+*  from replacing it, so it is tried again a few times.
+*/
+bool PagePack::swapIn(const string& temp, const string& target) {
+	for (int attempt = 0; attempt < 5; ++attempt) {
+		if (::MoveFileExA(temp.c_str(), target.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH) != 0)
+			return true;
+		::Sleep(20);
+	}
+	FileSystem::File::remove(temp);
+	return false;
+}
+
+//----< read an index, as commit writes it >-----------------------
+/*
+*    pack pages.3.pack
+*    dead 18220
+*    page 0 5713 8c2a61e2f09b1d47 Sockets/Sockets.h.html
+*  The file is opened sharing delete, so a commit can rename over it
+*  while it is read.
+*/
+bool PagePack::readIndex(const string& fileSpec, string& pack, size_t& dead, Index& index) {
+	HANDLE hFile = ::CreateFileA(fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+		NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	if (hFile == INVALID_HANDLE_VALUE)
+		return false;
+	string text;
+	vector<char> block(64 * 1024);
+	DWORD got = 0;
+	while (::ReadFile(hFile, &block[0], (DWORD)block.size(), &got, NULL) && got > 0)
+		text.append(&block[0], got);
+	::CloseHandle(hFile);
+	pack = "";
+	dead = 0;
+	index.clear();
+	istringstream in(text);
+	string line;
+	while (getline(in, line)) {
+		istringstream fields(line);
+		string key;
+		fields >> key;
+		if (key == "pack")
+			fields >> pack;
+		else if (key == "dead")
+			fields >> dead;
+		else if (key == "page") {
+			Entry entry;
+			string name;
+			if (!(fields >> entry.offset >> entry.size >> entry.etag))
+				continue;
+			fields.get();
+			getline(fields, name);
+			if (name != "")
+				index[name] = entry;
+		}
+	}
+	return pack != "" && pack.find_first_of("/\\") == string::npos && pack.find("..") == string::npos;
+}
+
+/////////////////////////////////////////////////////////////////////
+// PackReader
+
+//one committed index and the pack it names, mapped read only
+struct PackReader::Snapshot {
+	Snapshot(const string& indexName) : committed(indexName) {}
+	~Snapshot() {
+		if (view != nullptr)
+			::UnmapViewOfFile(view);
+		if (mapping != NULL)
+			::CloseHandle(mapping);
+		if (file != INVALID_HANDLE_VALUE)
+			::CloseHandle(file);
+	}
+	FileSystem::FileInfo committed;   // the index file, as it was when read
+	HANDLE file = INVALID_HANDLE_VALUE;
+	HANDLE mapping = NULL;
+	const char* view = nullptr;
+	size_t mapped = 0;
+	PagePack::Index index;
+};
+
+PackReader::PackReader(const string& root) : root_(PagePack::withSlash(root)) {}
+
+//----< snapshot of the current index, mapped again when it's replaced >---
+/*
+*  A snapshot that fails to load, e.g., for an index naming a pack
+*  that isn't there, leaves the last one in use.
+*/
+shared_ptr<const PackReader::Snapshot> PackReader::current() {
+	FileSystem::FileInfo now(root_ + IndexName);
+	bool indexed = now.good();
+	lock_guard<mutex> lock(mtx_);
+	if (!indexed) {
+		snapshot_.reset();
+		return snapshot_;
+	}
+	if (snapshot_ && !snapshot_->committed.earlier(now) && !now.earlier(snapshot_->committed) &&
+		snapshot_->committed.size() == now.size())
+		return snapshot_;
+	shared_ptr<const Snapshot> loaded = load();
+	if (loaded)
+		snapshot_ = loaded;
+	return snapshot_;
+}
+
+//----< read the index and map its pack >--------------------------
+shared_ptr<const PackReader::Snapshot> PackReader::load() {
+	shared_ptr<Snapshot> snapshot = make_shared<Snapshot>(root_ + IndexName);
+	string pack;
+	size_t dead = 0;
+	if (!PagePack::readIndex(root_ + IndexName, pack, dead, snapshot->index))
+		return nullptr;
+	snapshot->file = ::CreateFileA((root_ + pack).c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE,
+		NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+	LARGE_INTEGER size;
+	if (snapshot->file == INVALID_HANDLE_VALUE || !::GetFileSizeEx(snapshot->file, &size))
+		return nullptr;
+	snapshot->mapped = (size_t)size.QuadPart;
+	if (snapshot->mapped > 0) {
+		snapshot->mapping = ::CreateFileMappingA(snapshot->file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (snapshot->mapping == NULL)
+			return nullptr;
+		snapshot->view = (const char*)::MapViewOfFile(snapshot->mapping, FILE_MAP_READ, 0, 0, 0);
+		if (snapshot->view == nullptr)
+			return nullptr;
+	}
+	for (auto iter = snapshot->index.begin(); iter != snapshot->index.end();) {
+		const PagePack::Entry& entry = iter->second;
+		if (entry.offset > snapshot->mapped || entry.size > snapshot->mapped - entry.offset)
+			iter = snapshot->index.erase(iter);
+		else
+			++iter;
+	}
+	return snapshot;
+}
+
+//----< committed page, not found if a loose file is newer >-------
+/*
+*  A loose page written after the index was committed, e.g., by a
+*  later run that didn't pack, is left for the caller to read.
+*/
+PackReader::Page PackReader::find(const string& name) {
+	Page page;
+	if (name == "" || name.find("..") != string::npos)
+		return page;
+	shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot)
+		return page;
+	auto iter = snapshot->index.find(name);
+	if (iter == snapshot->index.end())
+		return page;
+	FileSystem::FileInfo loose(root_ + name);
+	if (loose.good() && !loose.earlier(snapshot->committed))
+		return page;
+	page.found = true;
+	page.bytes = (snapshot->view != nullptr) ? snapshot->view + iter->second.offset : "";
+	page.size = iter->second.size;
+	page.etag = iter->second.etag;
+	page.hold = snapshot;
+	return page;
+}
+
+//----< committed page names ending with ending, in name order >---
+vector<string> PackReader::names(const string& ending) {
+	vector<string> found;
+	shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot)
+		return found;
+	for (auto& item : snapshot->index) {
+		const string& name = item.first;
+		if (name.size() >= ending.size() && name.compare(name.size() - ending.size(), ending.size(), ending) == 0)
+			found.push_back(name);
+	}
+	return found;
+}
+
+#ifdef TEST_PAGEPACK
+
+#include <iostream>
+
+int main() {
+	FileSystem::Directory::create("../TestFiles/pack");
+	PagePack pack("../TestFiles/pack");
+	std::cout << "\n  opened: " << std::boolalpha << pack.open();
+	pack.add(pack.nameOf("../TestFiles/pack/A/Parent.h.html"), "<html>parent</html>\n");
+	pack.add("A/Child.h.html", "<html>child</html>\n");
+	std::cout << "\n  committed: " << pack.commit();
+	PackReader reader("../TestFiles/pack/");
+	PackReader::Page page = reader.find("A/Parent.h.html");
+	std::cout << "\n  found A/Parent.h.html: " << page.found << ", " << std::string(page.bytes, page.size);
+	pack.add("A/Child.h.html", "<html>child, again</html>\n");
+	pack.commit();
+	for (auto& name : reader.names(".html"))
+		std::cout << "\n  " << name << ": " << reader.find(name).size << " bytes";
+	std::cout << "\n  the page found first still reads: " << std::string(page.bytes, page.size) << "\n";
+}
+
+#endif
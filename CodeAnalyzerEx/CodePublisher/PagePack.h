@@ -0,0 +1,133 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PagePack.h: Keeps published pages in one indexed pack file instead of a file each  //
+// ver 1.1                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package stores the pages the publisher renders in one append-only pack file,
+* root/pages.N.pack, with an index, root/pages.index, of each page's name, offset, size
+* and content hash.  Making, listing and opening tens of thousands of small html files
+* costs a Windows file server far more than their bytes; a pack is one file, written
+* sequentially, and its index is read once
+* Pages are named as the server names them, relative to the root with '/' separators,
+* e.g., Parser/Parser.cpp.html
+*
+* PagePack is the publisher's side.  open loads the last index, so pages not rendered
+* again keep their entries, add appends a page, unless the packed page already has the
+* same content, and commit writes the index to a temporary file and renames it over
+* pages.index, so readers see all of a publish or none of it.  Replaced pages stay in
+* the pack as dead bytes; when they outweigh the live pages open copies the live ones
+* into the next pack, pages.N+1.pack, and the old one is deleted once no reader maps it
+*
+* PackReader is the server's side.  It maps the pack named by the current index into
+* memory and hands out pages as pointers into the mapping, which each Page holds, so a
+* page being sent stays valid when a new index is committed and mapped.  find checks
+* the index's write time on each call, like PageCache checks a page's stamp.  A loose
+* page file written after the index, e.g., by a run without packing, is newer than the
+* packed page, so find leaves it to the caller
+*
+*
+* Public Interface
+* --------------------
+*  PagePack pack("../Repository");                      //publisher side
+*  bool ok = pack.open();                               //load pages.index, open its pack to append
+*  std::string name = pack.nameOf(fileSpec);            //page name of a file under the root, "" if outside
+*  bool ok = pack.add(name, bytes);                     //append a page, replacing one of the same name
+*  pack.remove(name);                                   //drop a page from the index
+*  bool packed = pack.has(name);                        //is name in the index?
+*  bool ok = pack.commit();                             //write the index and swap it in
+*  PackReader packs("../Repository/");                  //server side
+*  PackReader::Page page = packs.find(name);            //page.found, page.bytes, page.size, page.etag
+*  std::vector<std::string> names = packs.names(".html"); //committed names ending with .html
+*
+*
+* Required Files:
+* ---------------
+*   -PagePack.h, PagePack.cpp, PublishManifest.h, PublishManifest.cpp, FileSystem.h
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.1 : 14 Oct 2026
+* - nameOf and the index swap are static, nameUnder and swapIn, for PageGenerations
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <fstream>
+
+class PagePack {
+public:
+	struct Entry {
+		size_t offset = 0;
+		size_t size = 0;
+		std::string etag;   // PublishManifest::textHash of the page
+	};
+	using Index = std::map<std::string, Entry>;   // by page name
+	static const size_t CompactBytes = 16 * 1024 * 1024;   // dead bytes worth copying the live pages away from
+
+	PagePack(const std::string& root);
+	bool open();
+	std::string nameOf(const std::string& fileSpec) const;
+	bool add(const std::string& name, const std::string& bytes);
+	void remove(const std::string& name);
+	bool has(const std::string& name);
+	bool commit();
+
+	static std::string withSlash(const std::string& root);
+	static std::string fullRootOf(const std::string& root);
+	static std::string nameUnder(const std::string& fullRoot, const std::string& fileSpec);
+	static bool swapIn(const std::string& temp, const std::string& target);
+	static bool readIndex(const std::string& fileSpec, std::string& pack, size_t& dead, Index& index);
+private:
+	bool startPack(const std::string& old);
+	void removeStalePacks();
+
+	std::string root_;       // ends with '/'
+	std::string fullRoot_;   // full path, ends with '\'
+	std::string pack_;       // file name of the pack appended to, in root_
+	std::string old_;        // pack copied from, deleted after the next commit
+	std::ofstream out_;
+	size_t end_ = 0;
+	size_t dead_ = 0;
+	Index index_;
+	std::mutex mtx_;
+};
+
+class PackReader {
+public:
+	struct Page {
+		bool found = false;
+		const char* bytes = nullptr;
+		size_t size = 0;
+		std::string etag;
+		std::shared_ptr<const void> hold;   // keeps the mapping bytes point into
+	};
+
+	PackReader(const std::string& root);
+	Page find(const std::string& name);
+	std::vector<std::string> names(const std::string& ending);
+private:
+	struct Snapshot;
+	std::shared_ptr<const Snapshot> current();
+	std::shared_ptr<const Snapshot> load();
+
+	std::string root_;   // ends with '/'
+	std::mutex mtx_;
+	std::shared_ptr<const Snapshot> snapshot_;
+};
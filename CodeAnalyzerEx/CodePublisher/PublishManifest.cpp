@@ -0,0 +1,227 @@
+///////////////////////////////////////////////////////////////////
+// PublishManifest.cpp: Remembers what was published             //
+// ver 1.0                                                       //
+// Application: Dependency Based Code Publisher, Spring 2017     //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project3             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "PublishManifest.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "../FileSystem/FileSystem.h"
+
+using namespace std;
+
+//----< read manifest saved by an earlier run >--------------------
+/*
+*  Each record starts with a "file" line followed by its stamp, hash,
+*  dep and type lines, e.g.:
+*    file C:\\CodeAnalyzerEx\\Repository\\Sockets\\Sockets.h
+*    stamp 10/14/2026 9:30:5 10433
+*    hash 8c2a61e2f09b1d47
+*    dep Logger.h
+*    type class Socket
+*/
+bool PublishManifest::load(const string& fileSpec) {
+	ifstream in(fileSpec);
+	if (!in.good())
+		return false;
+	entries_.clear();
+	Entry* pEntry = nullptr;
+	string line;
+	while (getline(in, line)) {
+		size_t pos = line.find(' ');
+		if (pos == string::npos)
+			continue;
+		string key = line.substr(0, pos);
+		string value = line.substr(pos + 1);
+		if (key == "file")
+			pEntry = &entries_[value];
+		else if (pEntry == nullptr)
+			continue;
+		else if (key == "stamp")
+			pEntry->stamp = value;
+		else if (key == "hash")
+			pEntry->hash = value;
+		else if (key == "dep")
+			pEntry->deps.push_back(value);
+		else if (key == "type") {
+			size_t split = value.find(' ');
+			if (split != string::npos)
+				pEntry->types.push_back(make_pair(value.substr(split + 1), value.substr(0, split)));
+		}
+	}
+	return true;
+}
+
+//----< write manifest for the next run >--------------------------
+bool PublishManifest::save(const string& fileSpec) {
+	ofstream out(fileSpec);
+	if (!out.good())
+		return false;
+	for (auto& item : entries_) {
+		out << "file " << item.first << "\n";
+		out << "stamp " << item.second.stamp << "\n";
+		out << "hash " << item.second.hash << "\n";
+		for (auto& dep : item.second.deps)
+			out << "dep " << dep << "\n";
+		for (auto& type : item.second.types)
+			out << "type " << type.second << " " << type.first << "\n";
+	}
+	return out.good();
+}
+
+//----< last write time and size, cheap test for unchanged files >---
+string PublishManifest::stamp(const File& file) {
+	FileSystem::FileInfo fi(file);
+	if (!fi.good())
+		return "";
+	ostringstream out;
+	out << fi.date() << " " << fi.size();
+	return out.str();
+}
+
+//----< fold bytes into a 64 bit FNV-1a hash >----------------------
+unsigned long long PublishManifest::hashBytes(unsigned long long hash, const char* bytes, size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		hash ^= (unsigned char)bytes[i];
+		hash *= 1099511628211ULL;
+	}
+	return hash;
+}
+
+//----< hash as 16 hex digits >------------------------------------
+string PublishManifest::hashString(unsigned long long hash) {
+	ostringstream out;
+	out << hex << setw(16) << setfill('0') << hash;
+	return out.str();
+}
+
+//----< 64 bit FNV-1a hash of file contents >----------------------
+string PublishManifest::contentHash(const File& file) {
+	ifstream in(file, ios::binary);
+	unsigned long long hash = 14695981039346656037ULL;
+	const size_t BlockSize = 64 * 1024;
+	vector<char> block(BlockSize);
+	while (in.good()) {
+		in.read(&block[0], BlockSize);
+		hash = hashBytes(hash, &block[0], (size_t)in.gcount());
+	}
+	return hashString(hash);
+}
+
+//----< 64 bit FNV-1a hash of a string >---------------------------
+string PublishManifest::textHash(const string& text) {
+	return bytesHash(text.data(), text.size());
+}
+
+//----< 64 bit FNV-1a hash of count bytes >------------------------
+string PublishManifest::bytesHash(const char* bytes, size_t count) {
+	return hashString(hashBytes(14695981039346656037ULL, bytes, count));
+}
+
+//----< is file new, or has its content changed since it was recorded? >---
+/*
+*  Compares stamps first and only hashes the file when the stamp moved,
+*  so touching a file without editing it doesn't make it dirty.
+*/
+bool PublishManifest::changed(const File& file) {
+	Entry* pEntry = find(file);
+	if (pEntry == nullptr)
+		return true;
+	string current = currentStamp(file);
+	if (current == pEntry->stamp)
+		return false;
+	if (contentHash(file) != pEntry->hash)
+		return true;
+	pEntry->stamp = current;
+	return false;
+}
+
+//----< files to re-publish: changed files and files that depend on them >---
+set<PublishManifest::File> PublishManifest::dirtyFiles(const vector<File>& files) {
+	set<File> dirty;
+	set<Package> dirtyPackages;
+	set<File> present;
+	for (auto& file : files)
+		present.insert(key(file));
+	for (auto& file : files) {
+		bool published = published_ ? published_(file) : FileSystem::File::exists(file + ".html");
+		if (changed(file) || !published) {
+			dirty.insert(file);
+			dirtyPackages.insert(FileSystem::Path::getName(file));
+		}
+	}
+	// files removed from the repository make their dependents dirty too
+	for (auto& item : entries_) {
+		if (present.find(item.first) == present.end())
+			dirtyPackages.insert(FileSystem::Path::getName(item.first));
+	}
+	for (auto& file : files) {
+		Entry* pEntry = find(file);
+		if (pEntry == nullptr || dirty.find(file) != dirty.end())
+			continue;
+		for (auto& dep : pEntry->deps) {
+			if (dirtyPackages.find(dep) != dirtyPackages.end()) {
+				dirty.insert(file);
+				break;
+			}
+		}
+	}
+	return dirty;
+}
+
+//----< store current state of a file that has just been published >---
+void PublishManifest::record(const File& file, const vector<Package>& deps, const vector<TypeRecord>& types) {
+	Entry& entry = entries_[key(file)];
+	entry.stamp = currentStamp(file);
+	entry.hash = contentHash(file);
+	entry.deps = deps;
+	entry.types = types;
+}
+
+//----< stored entry for file, nullptr if file has not been published >---
+PublishManifest::Entry* PublishManifest::find(const File& file) {
+	auto iter = entries_.find(key(file));
+	if (iter == entries_.end())
+		return nullptr;
+	return &iter->second;
+}
+
+//----< stamp from the stamp source, else from the file system >---
+string PublishManifest::currentStamp(const File& file) {
+	string result;
+	if (stamps_)
+		result = stamps_(file);
+	return result.empty() ? stamp(file) : result;
+}
+
+//----< full path of file, so all spellings of a file share one entry >---
+PublishManifest::File PublishManifest::key(const File& file) {
+	return FileSystem::Path::getFullFileSpec(file);
+}
+
+#ifdef TEST_PUBLISHMANIFEST
+
+#include <iostream>
+
+int main() {
+	std::string file = "../TestFiles/Parent.h";
+	PublishManifest manifest;
+	std::cout << "\n  new file changed: " << std::boolalpha << manifest.changed(file);
+	manifest.record(file, { "FileSystem.h" }, { { "Parent", "class" } });
+	std::cout << "\n  recorded file changed: " << manifest.changed(file);
+	manifest.save("../TestFiles/test.manifest");
+
+	PublishManifest reloaded;
+	reloaded.load("../TestFiles/test.manifest");
+	std::cout << "\n  reloaded file changed: " << reloaded.changed(file);
+	std::cout << "\n  reloaded deps: " << reloaded.find(file)->deps.size();
+	std::cout << "\n  reloaded types: " << reloaded.find(file)->types.size() << "\n\n";
+	FileSystem::File::remove("../TestFiles/test.manifest");
+}
+
+#endif
@@ -0,0 +1,104 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PublishManifest.h: Remembers what was published so unchanged files can be skipped   //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package keeps a manifest of every file the publisher has processed
+* For each file it stores a stamp (last write time and size), a content hash, the packages
+* the file depends on and the types the file defines
+* A file is dirty when it is new, its content hash changed, or it depends on a dirty file
+* The manifest is saved as a plain text file next to the repository files
+* Files are keyed by full path, so relative and absolute names of a file match
+*
+*
+* Public Interface
+* --------------------
+*  bool load(const std::string& fileSpec);                               //read manifest, false if none
+*  bool save(const std::string& fileSpec);                               //write manifest
+*  bool changed(const std::string& file);                                //is file new or is its content changed?
+*  std::set<std::string> dirtyFiles(const std::vector<std::string>& files) //changed files and their reverse dependents
+*  void record(file, deps, types)                                        //store current state of a published file
+*  Entry* find(const std::string& file)                                  //stored entry, nullptr if none
+*  void useStamps(StampSource source)                                    //take current stamps from source, e.g. a FileInventory
+*  void usePublished(PublishedTest test)                                 //ask test if a file's page exists, e.g. in a PagePack
+*  static std::string contentHash(const std::string& fileSpec);          //FNV-1a hash of file contents
+*  static std::string textHash(const std::string& text);                 //FNV-1a hash of a string
+*  static std::string bytesHash(const char* bytes, size_t count);        //FNV-1a hash of a buffer
+*
+*
+* Required Files:
+* ---------------
+*   -FileSystem.h
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.4 : 14 Oct 2026
+* - added usePublished: dirtyFiles asks it whether a file's page exists, instead of
+*   looking for file.html, so pages kept in a pack aren't all published again
+* Ver 1.3 : 14 Oct 2026
+* - added bytesHash, used to check chunks of resumable uploads
+* Ver 1.2 : 14 Oct 2026
+* - added useStamps: changed and record ask a stamp source, such as the executive's
+*   FileInventory, before reading a file's stamp from the file system
+* Ver 1.1 : 14 Oct 2026
+* - added textHash, used by Publisher to name shared assets by content
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include <string>
+#include <vector>
+#include <set>
+#include <unordered_map>
+#include <functional>
+
+class PublishManifest {
+public:
+	using File = std::string;
+	using Package = std::string;
+	using TypeRecord = std::pair<std::string, std::string>;   // type name, type kind
+	using StampSource = std::function<std::string(const File&)>;  // empty result if unknown
+	using PublishedTest = std::function<bool(const File&)>;       // does file have a page?
+
+	struct Entry {
+		std::string stamp;
+		std::string hash;
+		std::vector<Package> deps;
+		std::vector<TypeRecord> types;
+	};
+	using Entries = std::unordered_map<File, Entry>;
+
+	bool load(const std::string& fileSpec);
+	bool save(const std::string& fileSpec);
+	bool changed(const File& file);
+	std::set<File> dirtyFiles(const std::vector<File>& files);
+	void record(const File& file, const std::vector<Package>& deps, const std::vector<TypeRecord>& types);
+	Entry* find(const File& file);
+	Entries& entries() { return entries_; }
+	void useStamps(StampSource source) { stamps_ = source; }
+	void usePublished(PublishedTest test) { published_ = test; }
+	static std::string stamp(const File& file);
+	static std::string contentHash(const File& file);
+	static std::string textHash(const std::string& text);
+	static std::string bytesHash(const char* bytes, size_t count);
+private:
+	static unsigned long long hashBytes(unsigned long long hash, const char* bytes, size_t count);
+	static std::string hashString(unsigned long long hash);
+	static File key(const File& file);
+	std::string currentStamp(const File& file);
+	Entries entries_;
+	StampSource stamps_;
+	PublishedTest published_;
+};
@@ -0,0 +1,91 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// PublishSignal.h: Tells other processes that a publish batch has finished            //
+// ver 1.1                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package wraps a named Win32 auto reset event shared by the analyzer and the server
+* The analyzer raises it when every html file of a batch has been written
+* The server waits on it before sending published files, instead of spinning for a while
+* and hoping publishing is done
+* The signal stays set until one waiter takes it, so a raise before the wait isn't lost,
+* as long as the waiting process has opened the event first
+* The analyzer also releases a named semaphore as each page is written, so the server can
+* send finished pages while the rest of the batch is still rendering.  waitAny returns
+* Batch before Page when both are set, and clearPages takes page counts a waiter has
+* already handled by looking at the repository
+*
+*
+* Public Interface
+* --------------------
+*  static void open();                              //create or open the event, keeps it for the process lifetime
+*  static void raise();                             //a publish batch is complete
+*  static bool wait(unsigned long timeoutMs);       //true if a batch completed, false on timeout
+*  static void pageDone();                          //one page of the batch is written
+*  static Event waitAny(unsigned long timeoutMs);   //Batch, Page, or None on timeout
+*  static void clearPages();                        //forget pages signaled so far
+*
+*
+* Required Files:
+* ---------------
+*   -none, header only
+
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.1 : 14 Oct 2026
+* - added pageDone, waitAny and clearPages, a semaphore per written page
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include <windows.h>
+
+class PublishSignal {
+public:
+	enum Event { None, Page, Batch };
+	static void open() { handle(); pages(); }
+	static void raise() {
+		if (handle() != NULL)
+			::SetEvent(handle());
+	}
+	static bool wait(unsigned long timeoutMs) {
+		return handle() != NULL && ::WaitForSingleObject(handle(), timeoutMs) == WAIT_OBJECT_0;
+	}
+	static void pageDone() {
+		if (pages() != NULL)
+			::ReleaseSemaphore(pages(), 1, NULL);
+	}
+	static Event waitAny(unsigned long timeoutMs) {
+		if (handle() == NULL || pages() == NULL)
+			return wait(timeoutMs) ? Batch : None;
+		HANDLE handles[] = { handle(), pages() };
+		DWORD result = ::WaitForMultipleObjects(2, handles, FALSE, timeoutMs);
+		if (result == WAIT_OBJECT_0)
+			return Batch;
+		return (result == WAIT_OBJECT_0 + 1) ? Page : None;
+	}
+	static void clearPages() {
+		while (pages() != NULL && ::WaitForSingleObject(pages(), 0) == WAIT_OBJECT_0)
+			;
+	}
+private:
+	static HANDLE handle() {
+		static HANDLE event = ::CreateEventA(NULL, FALSE, FALSE, "RemoteCodePublisher.BatchPublished");
+		return event;
+	}
+	static HANDLE pages() {
+		static HANDLE semaphore = ::CreateSemaphoreA(NULL, 0, 0x7fffffff, "RemoteCodePublisher.PagePublished");
+		return semaphore;
+	}
+};
@@ -0,0 +1,539 @@
+///////////////////////////////////////////////////////////////////
+// SearchIndex.cpp: Trigram index of sources and symbols         //
+// ver 1.0                                                       //
+// Application: Dependency Based Code Publisher, Spring 2017     //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
+// Author:      Chandra Harsha Jupalli, OOD Project3             //
+//              cjupalli@syr.edu                                 //
+///////////////////////////////////////////////////////////////////
+
+#include "SearchIndex.h"
+#include "PagePack.h"
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <algorithm>
+#include <iterator>
+#include <set>
+#include <cctype>
+#include <cstdlib>
+
+using namespace std;
+
+namespace {
+	string lowered(const string& text) {
+		string result(text);
+		for (auto& c : result)
+			c = (char)tolower((unsigned char)c);
+		return result;
+	}
+
+	//index of the ')' or ']' closing the group or class opened at start
+	size_t closing(const string& text, size_t start) {
+		char open = text[start];
+		char close = (open == '(') ? ')' : ']';
+		size_t depth = 0;
+		for (size_t i = start; i < text.size(); ++i) {
+			if (text[i] == '\\') {
+				++i;
+				continue;
+			}
+			if (open == '[') {
+				if (i > start && text[i] == ']' && !(i == start + 1 || (i == start + 2 && text[start + 1] == '^')))
+					return i;
+				continue;
+			}
+			if (text[i] == '[') {
+				i = closing(text, i);
+				continue;
+			}
+			if (text[i] == open)
+				++depth;
+			else if (text[i] == close && --depth == 0)
+				return i;
+		}
+		return text.size();
+	}
+
+	//the top level alternatives of a regex, split at '|' outside groups and classes
+	vector<string> alternativesOf(const string& text) {
+		vector<string> alternatives;
+		size_t begin = 0;
+		for (size_t i = 0; i < text.size(); ++i) {
+			if (text[i] == '\\')
+				++i;
+			else if (text[i] == '(' || text[i] == '[')
+				i = closing(text, i);
+			else if (text[i] == '|') {
+				alternatives.push_back(text.substr(begin, i - begin));
+				begin = i + 1;
+			}
+		}
+		alternatives.push_back(text.substr(begin));
+		return alternatives;
+	}
+
+	//runs of literal characters every match of a regex alternative holds
+	/*
+	*  Groups, classes, escapes such as \w, and anchors end a run; a character
+	*  a *, ? or {} makes optional is dropped, and + ends the run after it.
+	*/
+	vector<string> literalRuns(const string& text) {
+		vector<string> runs(1);
+		auto endRun = [&runs]() {
+			if (!runs.back().empty())
+				runs.push_back("");
+		};
+		for (size_t i = 0; i < text.size(); ++i) {
+			char c = text[i];
+			if (c == '\\' && i + 1 < text.size()) {
+				char next = text[++i];
+				if (isalnum((unsigned char)next)) {
+					if (next == 'x')
+						i += 2;
+					else if (next == 'u')
+						i += 4;
+					else if (next == 'c')
+						i += 1;
+					endRun();
+				}
+				else
+					runs.back() += next;
+			}
+			else if (c == '(' || c == '[') {
+				endRun();
+				i = closing(text, i);
+			}
+			else if (c == '*' || c == '?' || c == '{') {
+				if (!runs.back().empty())
+					runs.back().pop_back();
+				endRun();
+				if (c == '{')
+					i = (std::min)(text.find('}', i), text.size());
+			}
+			else if (c == '+')
+				endRun();
+			else if (c == '.' || c == '^' || c == '$' || c == ')' || c == ']' || c == '}')
+				endRun();
+			else
+				runs.back() += c;
+		}
+		return runs;
+	}
+
+	//sorted union of two ascending id lists
+	vector<unsigned int> unionOf(const vector<unsigned int>& a, const vector<unsigned int>& b) {
+		vector<unsigned int> result;
+		set_union(a.begin(), a.end(), b.begin(), b.end(), back_inserter(result));
+		return result;
+	}
+}
+
+//----< key files are known by: full path, lower cased >-----------
+string SearchIndex::key(const string& file) {
+	return FileSystem::Path::toLower(FileSystem::Path::getFullFileSpec(file));
+}
+
+//----< distinct trigrams of text, lower cased, none across a line end >---
+void SearchIndex::gramsOf(const string& text, vector<Gram>& grams) {
+	grams.clear();
+	for (size_t i = 0; i + 3 <= text.size(); ++i) {
+		unsigned char a = (unsigned char)text[i], b = (unsigned char)text[i + 1], c = (unsigned char)text[i + 2];
+		if (c == '\n' || c == '\r') {
+			i += 2;
+			continue;
+		}
+		if (b == '\n' || b == '\r') {
+			++i;
+			continue;
+		}
+		if (a == '\n' || a == '\r')
+			continue;
+		grams.push_back(((Gram)tolower(a) << 16) | ((Gram)tolower(b) << 8) | (Gram)tolower(c));
+	}
+	sort(grams.begin(), grams.end());
+	grams.erase(unique(grams.begin(), grams.end()), grams.end());
+}
+
+//----< trigrams each alternative of a regex needs, false if one needs none >---
+bool SearchIndex::literalGrams(const string& text, vector<vector<Gram>>& alternatives) {
+	alternatives.clear();
+	for (auto& alternative : alternativesOf(text)) {
+		vector<Gram> needed, grams;
+		for (auto& run : literalRuns(alternative)) {
+			gramsOf(run, grams);
+			needed.insert(needed.end(), grams.begin(), grams.end());
+		}
+		if (needed.empty())
+			return false;
+		sort(needed.begin(), needed.end());
+		needed.erase(unique(needed.begin(), needed.end()), needed.end());
+		alternatives.push_back(needed);
+	}
+	return true;
+}
+
+//----< read the index saved by the last run >--------------------
+/*
+*  Files are numbered in the order they are listed, e.g.:
+*    search index 1
+*    file C:\CodeAnalyzerEx\Repository\Sockets\Sockets.h
+*    stamp 10/14/2026 9:30:5 10433
+*    symbol 112 class Socket
+*    gram 736f63 0 3 1
+*  A gram line lists the ids of the files holding it, each after the
+*  first as its distance from the one before.
+*/
+bool SearchIndex::load(const string& fileSpec) {
+	ifstream in(fileSpec);
+	string line;
+	if (!in.good() || !getline(in, line) || line != "search index 1")
+		return false;
+	files_.clear();
+	ids_.clear();
+	postings_.clear();
+	while (getline(in, line)) {
+		size_t pos = line.find(' ');
+		if (pos == string::npos)
+			continue;
+		string key = line.substr(0, pos);
+		string value = line.substr(pos + 1);
+		if (key == "file") {
+			ids_[SearchIndex::key(value)] = (unsigned int)files_.size();
+			files_.push_back(File());
+			files_.back().path = value;
+		}
+		else if (files_.empty())
+			continue;
+		else if (key == "stamp")
+			files_.back().stamp = value;
+		else if (key == "symbol") {
+			istringstream fields(value);
+			Symbol symbol;
+			if (fields >> symbol.line >> symbol.kind && getline(fields >> ws, symbol.name))
+				files_.back().symbols.push_back(symbol);
+		}
+		else if (key == "gram") {
+			istringstream fields(value);
+			string digits;
+			fields >> digits;
+			Postings& postings = postings_[(Gram)strtoul(digits.c_str(), nullptr, 16)];
+			unsigned int id = 0, step = 0;
+			for (bool first = true; fields >> step; first = false) {
+				id = first ? step : id + step;
+				if (id < files_.size())
+					postings.push_back(id);
+			}
+		}
+	}
+	return true;
+}
+
+//----< drop dead files and number the live ones again >-----------
+void SearchIndex::compact() {
+	if (ids_.size() == files_.size())
+		return;
+	vector<unsigned int> renumbered(files_.size());
+	vector<File> live;
+	for (size_t id = 0; id < files_.size(); ++id) {
+		if (!files_[id].live)
+			continue;
+		renumbered[id] = (unsigned int)live.size();
+		live.push_back(std::move(files_[id]));
+	}
+	for (auto iter = postings_.begin(); iter != postings_.end();) {
+		Postings kept;
+		for (unsigned int id : iter->second) {
+			if (files_[id].live)
+				kept.push_back(renumbered[id]);
+		}
+		if (kept.empty())
+			iter = postings_.erase(iter);
+		else {
+			iter->second.swap(kept);
+			++iter;
+		}
+	}
+	files_.swap(live);
+	ids_.clear();
+	for (size_t id = 0; id < files_.size(); ++id)
+		ids_[key(files_[id].path)] = (unsigned int)id;
+}
+
+//----< write live files to a temporary file and swap it in >------
+bool SearchIndex::save(const string& fileSpec) {
+	compact();
+	string temp = fileSpec + ".tmp";
+	{
+		ofstream out(temp, ios::trunc);
+		out << "search index 1\n";
+		for (auto& file : files_) {
+			out << "file " << file.path << "\n";
+			out << "stamp " << file.stamp << "\n";
+			for (auto& symbol : file.symbols)
+				out << "symbol " << symbol.line << " " << symbol.kind << " " << symbol.name << "\n";
+		}
+		for (auto& item : postings_) {
+			out << "gram " << hex << setw(6) << setfill('0') << item.first << dec;
+			unsigned int last = 0;
+			for (size_t i = 0; i < item.second.size(); ++i) {
+				out << " " << (i == 0 ? item.second[i] : item.second[i] - last);
+				last = item.second[i];
+			}
+			out << "\n";
+		}
+		if (!out.good()) {
+			out.close();
+			FileSystem::File::remove(temp);
+			return false;
+		}
+	}
+	return PagePack::swapIn(temp, fileSpec);
+}
+
+//----< index file again if its stamp moved, true if it was read >---
+/*
+*  A file indexed again gets a new id, so its postings stay ascending,
+*  and loses its symbols until setSymbols gives those of its new text.
+*  A file that can't be read, or is too large, is left out.
+*/
+bool SearchIndex::update(const string& file, const string& stamp) {
+	string fileKey = key(file);
+	auto iter = ids_.find(fileKey);
+	if (iter != ids_.end() && stamp != "" && files_[iter->second].stamp == stamp)
+		return false;
+	remove(file);
+	ifstream in(file, ios::binary);
+	if (!in.good())
+		return false;
+	in.seekg(0, ios::end);
+	streamoff size = in.tellg();
+	if (size < 0 || (size_t)size > MaxFileBytes)
+		return false;
+	string text((size_t)size, '\0');
+	in.seekg(0);
+	if (size > 0 && !in.read(&text[0], size))
+		return false;
+	unsigned int id = (unsigned int)files_.size();
+	files_.push_back(File());
+	files_.back().path = FileSystem::Path::getFullFileSpec(file);
+	files_.back().stamp = stamp;
+	ids_[fileKey] = id;
+	vector<Gram> grams;
+	gramsOf(text, grams);
+	for (Gram gram : grams)
+		postings_[gram].push_back(id);
+	return true;
+}
+
+//----< forget a file, its postings are dropped by the next save >---
+void SearchIndex::remove(const string& file) {
+	auto iter = ids_.find(key(file));
+	if (iter == ids_.end())
+		return;
+	files_[iter->second].live = false;
+	files_[iter->second].symbols.clear();
+	ids_.erase(iter);
+}
+
+//----< forget every file not in files, e.g., removed from the repository >---
+void SearchIndex::retain(const vector<string>& files) {
+	set<string> present;
+	for (auto& file : files)
+		present.insert(key(file));
+	vector<string> gone;
+	for (auto& item : ids_) {
+		if (present.find(item.first) == present.end())
+			gone.push_back(files_[item.second].path);
+	}
+	for (auto& file : gone)
+		remove(file);
+}
+
+//----< replace the symbols of an indexed file >-------------------
+void SearchIndex::setSymbols(const string& file, const Symbols& symbols) {
+	auto iter = ids_.find(key(file));
+	if (iter != ids_.end())
+		files_[iter->second].symbols = symbols;
+}
+
+//----< ids of the live files holding every one of grams >---------
+/*
+*  Starts from the shortest list, so each step checks the fewest ids.
+*/
+SearchIndex::Postings SearchIndex::candidates(const vector<Gram>& grams) const {
+	vector<const Postings*> lists;
+	for (Gram gram : grams) {
+		auto iter = postings_.find(gram);
+		if (iter == postings_.end())
+			return Postings();
+		lists.push_back(&iter->second);
+	}
+	if (lists.empty())
+		return allFiles();
+	sort(lists.begin(), lists.end(), [](const Postings* a, const Postings* b) { return a->size() < b->size(); });
+	Postings result = *lists[0];
+	for (size_t i = 1; i < lists.size() && !result.empty(); ++i) {
+		Postings both;
+		set_intersection(result.begin(), result.end(), lists[i]->begin(), lists[i]->end(), back_inserter(both));
+		result.swap(both);
+	}
+	return result;
+}
+
+SearchIndex::Postings SearchIndex::allFiles() const {
+	Postings all;
+	for (size_t id = 0; id < files_.size(); ++id)
+		all.push_back((unsigned int)id);
+	return all;
+}
+
+//----< does text match query, lowered is its text, lower cased? >---
+bool SearchIndex::matches(const string& text, const Query& query, const string& lower, const regex* pRegex) {
+	if (pRegex != nullptr)
+		return regex_search(text, *pRegex);
+	if (query.ignoreCase)
+		return lowered(text).find(lower) != string::npos;
+	return text.find(query.text) != string::npos;
+}
+
+//----< symbols, then lines of files, matching query >-------------
+/*
+*  Only the files holding every trigram a match needs are read, a line at
+*  a time.  A file changed since it was indexed is read as it is now.
+*/
+bool SearchIndex::search(const Query& query, Hits& hits) const {
+	hits.clear();
+	if (query.text.empty())
+		return true;
+	string lower = lowered(query.text);
+	regex pattern;
+	if (query.regex) {
+		try {
+			pattern.assign(query.text, query.ignoreCase ? regex::ECMAScript | regex::icase : regex::ECMAScript);
+		}
+		catch (regex_error&) {
+			return false;
+		}
+	}
+	const regex* pRegex = query.regex ? &pattern : nullptr;
+	for (auto& file : files_) {
+		for (size_t i = 0; file.live && i < file.symbols.size() && hits.size() < query.limit; ++i) {
+			if (!matches(file.symbols[i].name, query, lower, pRegex))
+				continue;
+			Hit hit;
+			hit.file = file.path;
+			hit.line = file.symbols[i].line;
+			hit.text = file.symbols[i].kind;
+			hit.symbol = file.symbols[i].name;
+			hits.push_back(hit);
+		}
+	}
+	Postings ids;
+	vector<vector<Gram>> alternatives;
+	if (!query.regex) {
+		vector<Gram> grams;
+		gramsOf(query.text, grams);
+		ids = candidates(grams);
+	}
+	else if (literalGrams(query.text, alternatives)) {
+		for (auto& grams : alternatives)
+			ids = unionOf(ids, candidates(grams));
+	}
+	else
+		ids = allFiles();
+	for (size_t i = 0; i < ids.size() && hits.size() < query.limit; ++i) {
+		const File& file = files_[ids[i]];
+		if (!file.live)
+			continue;
+		ifstream in(file.path, ios::binary);
+		string line;
+		for (size_t count = 1; getline(in, line) && hits.size() < query.limit; ++count) {
+			if (!line.empty() && line.back() == '\r')
+				line.pop_back();
+			if (!matches(line, query, lower, pRegex))
+				continue;
+			Hit hit;
+			hit.file = file.path;
+			hit.line = count;
+			hit.text = line.substr(0, MaxLineBytes);
+			hits.push_back(hit);
+		}
+	}
+	return true;
+}
+
+/////////////////////////////////////////////////////////////////////
+// SearchReader
+
+SearchReader::SearchReader(const string& root)
+	: file_(PagePack::withSlash(root) + "search.index"), fullRoot_(PagePack::fullRootOf(root)) {}
+
+//----< the saved index, loaded again when search.index moves >----
+/*
+*  An index that can't be read, e.g., while it is being replaced, leaves
+*  the last one loaded in use.
+*/
+shared_ptr<const SearchReader::Snapshot> SearchReader::current() {
+	FileSystem::FileInfo now(file_);
+	lock_guard<mutex> lock(mtx_);
+	if (!now.good() || (snapshot_ && !snapshot_->saved.earlier(now) && !now.earlier(snapshot_->saved) &&
+		snapshot_->saved.size() == now.size()))
+		return snapshot_;
+	shared_ptr<Snapshot> loaded = make_shared<Snapshot>(file_);
+	if (!loaded->index.load(file_))
+		return snapshot_;
+	snapshot_ = loaded;
+	return snapshot_;
+}
+
+//----< search the saved index, files named as pages are, e.g., Parser/Parser.cpp >---
+bool SearchReader::search(const SearchIndex::Query& query, SearchIndex::Hits& hits) {
+	hits.clear();
+	shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot)
+		return true;
+	if (!snapshot->index.search(query, hits))
+		return false;
+	for (auto& hit : hits) {
+		string name = PagePack::nameUnder(fullRoot_, hit.file);
+		if (name != "")
+			hit.file = name;
+	}
+	return true;
+}
+
+#ifdef TEST_SEARCHINDEX
+
+#include "PublishManifest.h"
+#include <iostream>
+
+int main() {
+	SearchIndex index;
+	std::vector<std::string> files = FileSystem::Directory::getFiles("../CodePublisher", "*.h");
+	for (auto& file : files) {
+		file = "../CodePublisher/" + file;
+		index.update(file, PublishManifest::stamp(file));
+	}
+	SearchIndex::Symbols symbols(1);
+	symbols[0].name = "SearchIndex";
+	symbols[0].kind = "class";
+	symbols[0].line = 69;
+	index.setSymbols("../CodePublisher/SearchIndex.h", symbols);
+	index.save("../TestFiles/search.index");
+	SearchIndex loaded;
+	std::cout << "\n  loaded: " << std::boolalpha << loaded.load("../TestFiles/search.index") << ", " << loaded.files() << " files";
+	SearchIndex::Query query;
+	SearchIndex::Hits hits;
+	for (const char* text : { "SearchIndex", "swapIn(", "class Page(Pack|Generations)" }) {
+		query.text = text;
+		query.regex = (std::string(text).find('|') != std::string::npos);
+		loaded.search(query, hits);
+		std::cout << "\n\n  " << text << ": " << hits.size() << " hits";
+		for (auto& hit : hits)
+			std::cout << "\n    " << hit.file << ":" << hit.line << " " << (hit.symbol != "" ? hit.text + " " + hit.symbol : hit.text);
+	}
+	std::cout << "\n\n";
+}
+
+#endif
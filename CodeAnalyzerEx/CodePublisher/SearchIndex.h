@@ -0,0 +1,139 @@
+/////////////////////////////////////////////////////////////////////////////////////////
+// SearchIndex.h: Trigram index of repository sources and symbols for fast searches    //
+// ver 1.0                                                                             //
+// Application: Dependency Based Code Publisher, Spring 2017                           //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
+// Author:      Chandra Harsha Jupalli, OOD Project3                                   //
+//              cjupalli@syr.edu                                                       //
+/////////////////////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* Searching the repository for a string, or a regular expression, by reading every
+* source is slow once it holds thousands of files.  This package keeps an inverted
+* index, root/search.index, of the trigrams, each run of three bytes, lower cased, in
+* every source, with the files holding each one, and the names of the namespaces,
+* classes, structs, interfaces and functions the AST found, with their file and line
+*
+* A search finds the trigrams a match must contain, e.g., "soc", "ock", "cke" and "ket"
+* for "Socket", intersects their file lists, and reads only the files left to find the lines
+* that match.  A regex's trigrams come from the literal runs every match must hold, so
+* "Parse(r|rs)\(" reads only the files holding "parse".  A query with no such run,
+* e.g., "ab" or ".*", checks every indexed file, as a scan would
+*
+* The publisher updates the index at publish time: update indexes a file again only
+* when its stamp moved, retain forgets files no longer in the repository, and symbols
+* are replaced per file parsed.  Files re-indexed leave their old postings dead until
+* save, which writes only live files, numbered again, to a temporary file and renames
+* it over search.index.  SearchReader is the server's side, it loads the index again
+* when the file's write time or size moves, and searches the loaded copy
+*
+*
+* Public Interface
+* --------------------
+*  SearchIndex index;                                     //publisher side
+*  bool ok = index.load("../Repository/search.index");    //index saved by the last run, false if none
+*  bool read = index.update(file, stamp);                 //index file again if stamp moved, true if it was read
+*  index.retain(files);                                   //forget files not in files
+*  index.setSymbols(file, symbols);                       //replace the symbols defined in file
+*  bool ok = index.save("../Repository/search.index");    //write live files and swap the index in
+*  bool ok = index.search(query, hits);                   //symbols and lines matching query.text, false for a bad regex
+*  SearchReader reader("../Repository/");                 //server side
+*  bool ok = reader.search(query, hits);                  //searched in the saved index, files named under the root
+*
+*
+* Required Files:
+* ---------------
+*   -SearchIndex.h, SearchIndex.cpp, PagePack.h, PagePack.cpp, FileSystem.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#pragma once
+#include "../FileSystem/FileSystem.h"
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include <regex>
+#include <memory>
+#include <mutex>
+
+class SearchIndex {
+public:
+	struct Symbol {
+		std::string name;
+		std::string kind;   // typeName of its AST node, e.g., "class"
+		size_t line = 0;
+	};
+	using Symbols = std::vector<Symbol>;
+	struct Query {
+		std::string text;
+		bool regex = false;         // text is an ECMAScript regular expression
+		bool ignoreCase = false;
+		size_t limit = 200;         // hits returned at most
+	};
+	struct Hit {
+		std::string file;           // full path of the source
+		size_t line = 0;            // counts from 1, 0 for a type known only by its file
+		std::string text;           // the matching line, or a symbol's kind
+		std::string symbol;         // the symbol's name, "" for a line of text
+	};
+	using Hits = std::vector<Hit>;
+	static const size_t MaxFileBytes = 8 * 1024 * 1024;   // larger files aren't indexed
+	static const size_t MaxLineBytes = 256;               // longer matching lines are cut
+
+	bool load(const std::string& fileSpec);
+	bool save(const std::string& fileSpec);
+	bool update(const std::string& file, const std::string& stamp);
+	void remove(const std::string& file);
+	void retain(const std::vector<std::string>& files);
+	void setSymbols(const std::string& file, const Symbols& symbols);
+	bool search(const Query& query, Hits& hits) const;
+	size_t files() const { return ids_.size(); }
+private:
+	using Gram = unsigned int;   // three lower cased bytes, the first in the high byte
+	using Postings = std::vector<unsigned int>;   // ascending file ids
+	struct File {
+		std::string path;
+		std::string stamp;
+		bool live = true;
+		Symbols symbols;
+	};
+	static std::string key(const std::string& file);
+	static void gramsOf(const std::string& text, std::vector<Gram>& grams);
+	static bool literalGrams(const std::string& text, std::vector<std::vector<Gram>>& alternatives);
+	static bool matches(const std::string& text, const Query& query, const std::string& lowered, const std::regex* pRegex);
+	Postings candidates(const std::vector<Gram>& grams) const;
+	Postings allFiles() const;
+	void compact();
+
+	std::vector<File> files_;                          // by id, dead ones until save
+	std::unordered_map<std::string, unsigned int> ids_;   // live file ids by key
+	std::unordered_map<Gram, Postings> postings_;
+};
+
+class SearchReader {
+public:
+	SearchReader(const std::string& root);
+	bool search(const SearchIndex::Query& query, SearchIndex::Hits& hits);
+private:
+	struct Snapshot {
+		Snapshot(const std::string& file) : saved(file) {}
+		FileSystem::FileInfo saved;   // search.index, as it was when loaded
+		SearchIndex index;
+	};
+	std::shared_ptr<const Snapshot> current();
+
+	std::string file_;       // root's search.index
+	std::string fullRoot_;   // full path, ends with '\'
+	std::mutex mtx_;
+	std::shared_ptr<const Snapshot> snapshot_;
+};
@@ -8,71 +8,612 @@
 ///////////////////////////////////////////////////////////////////
 
 #include "publisher.h"
+#include "PublishManifest.h"
+#include "Gzip.h"
+#include "PagePack.h"
+#include "PageGenerations.h"
+#include "../Utilities/RunProfile.h"
+#include "../Utilities/MemoryProfile.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
 #include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+#include <thread>
+#include <cstdio>
+#include <map>
+#include <cctype>
 
 using namespace std;
 
+//table of characters the renderer has to replace, all others are copied in runs
+namespace {
+	struct SpecialChars {
+		bool table[256];
+		SpecialChars() {
+			for (size_t i = 0; i < 256; ++i)
+				table[i] = false;
+			table[(unsigned char)'<'] = table[(unsigned char)'>'] = true;
+			table[(unsigned char)'{'] = table[(unsigned char)'}'] = true;
+		}
+	};
+	const SpecialChars special;
+	const size_t ReadBlockSize = 64 * 1024;
+}
+
+//reads the whole file in large blocks instead of one character at a time
+static bool readSource(const string& path, string& source) {
+	ifstream in(path);
+	if (!in.is_open())
+		return false;
+	vector<char> block(ReadBlockSize);
+	while (in.good()) {
+		in.read(&block[0], block.size());
+		source.append(&block[0], (size_t)in.gcount());
+	}
+	return true;
+}
+
+//one scan over the lines of source appending a link for every quoted #include
+static void appendIncludeLinks(const string& source, string& out) {
+	size_t lineStart = 0;
+	while (lineStart < source.size()) {
+		size_t lineEnd = source.find('\n', lineStart);
+		if (lineEnd == string::npos)
+			lineEnd = source.size();
+		string line = source.substr(lineStart, lineEnd - lineStart);
+		lineStart = lineEnd + 1;
+		if (line.find("if") != string::npos || line.find("#include") == string::npos)
+			continue;
+		size_t begin = line.find('"');
+		size_t end = line.find_last_of('"');
+		if (begin == string::npos)
+			continue;
+		string name = line.substr(begin + 1, end - begin - 1);
+		out += "<a href = \"" + name + ".html\">" + name + "</a>\n";
+	}
+}
+
+//escapes markup of source from from to to, copying runs of ordinary characters in one append
+static void appendEscaped(const string& source, size_t from, size_t to, string& out, int& count) {
+	const char* text = source.data();
+	size_t size = to;
+	size_t run = from;
+	for (size_t i = from; i < size; ++i) {
+		if (!special.table[(unsigned char)text[i]])
+			continue;
+		out.append(text + run, i - run);
+		run = i + 1;
+		switch (text[i]) {
+		case '<':
+			out += "&lt;"; break;
+		case '>':
+			out += "&gt;"; break;
+		case '{':
+			count++;
+			out += "<input type='button' value='-' id='bt" + to_string(count) + "' onclick='scopeHandle(this);'//>{<div id='dbt" + to_string(count) + "'>"; break;
+		case '}':
+			out += "}</div>"; break;
+		}
+	}
+	out.append(text + run, size - run);
+}
+
+static bool isNameStart(char ch) {
+	return isalpha((unsigned char)ch) || ch == '_';
+}
+
+static bool isNameChar(char ch) {
+	return isalnum((unsigned char)ch) || ch == '_';
+}
+
+//one pass over the code of source from from: onName(begin, end, line) for each name outside
+//comments and literals, onLine(line, at) as each line starts
+template <typename OnName, typename OnLine>
+static void scanNames(const string& source, size_t from, OnName onName, OnLine onLine) {
+	enum { Code, LineComment, BlockComment, Quoted } state = Code;
+	const char* text = source.data();
+	size_t size = source.size();
+	size_t line = 1 + (size_t)std::count(source.begin(), source.begin() + from, '\n');
+	char quote = 0;
+	for (size_t i = from; i < size; ++i) {
+		char ch = text[i];
+		if (ch == '\n') {
+			if (state != BlockComment)
+				state = Code;
+			onLine(++line, i + 1);
+			continue;
+		}
+		char next = (i + 1 < size) ? text[i + 1] : 0;
+		switch (state) {
+		case LineComment:
+			break;
+		case BlockComment:
+			if (ch == '*' && next == '/') {
+				state = Code;
+				++i;
+			}
+			break;
+		case Quoted:
+			if (ch == '\\' && next != '\n')
+				++i;
+			else if (ch == quote)
+				state = Code;
+			break;
+		case Code:
+			if (ch == '/' && (next == '/' || next == '*')) {
+				state = (next == '/') ? LineComment : BlockComment;
+				++i;
+			}
+			else if (ch == '"' || ch == '\'') {
+				state = Quoted;
+				quote = ch;
+			}
+			else if (isNameStart(ch) && (i == 0 || !isNameChar(text[i - 1]))) {
+				size_t end = i + 1;
+				while (end < size && isNameChar(text[end]))
+					++end;
+				onName(i, end, line);
+				i = end - 1;
+			}
+			break;
+		}
+	}
+}
+
+//name of the directory holding a file, pages of one directory link each other by file name
+static string folderOf(const string& fullFile) {
+	string directory = FileSystem::Path::getPath(fullFile);
+	if (directory.size() > 1)
+		directory.erase(directory.size() - 1);
+	return FileSystem::Path::getName(directory);
+}
+
+//escapes text for a lazy page, which the script reads back as text, so & too
+static void appendText(const string& source, string& out) {
+	size_t run = 0;
+	for (size_t i = 0; i < source.size(); ++i) {
+		const char* entity;
+		switch (source[i]) {
+		case '<': entity = "&lt;"; break;
+		case '>': entity = "&gt;"; break;
+		case '&': entity = "&amp;"; break;
+		default: continue;
+		}
+		out.append(source, run, i - run);
+		out += entity;
+		run = i + 1;
+	}
+	out.append(source, run, string::npos);
+}
+
+//scopes of source from matching braces, for files the AST has no scopes of
+static vector<Publisher::Scope> braceScopes(const string& source) {
+	vector<Publisher::Scope> scopes;
+	vector<size_t> open;
+	size_t line = 1;
+	for (char ch : source) {
+		if (ch == '\n')
+			++line;
+		else if (ch == '{')
+			open.push_back(line);
+		else if (ch == '}' && !open.empty()) {
+			if (line > open.back())
+				scopes.push_back(Publisher::Scope(open.back(), line));
+			open.pop_back();
+		}
+	}
+	return scopes;
+}
+
+//keeps scopes by full path, so publishCode finds them whatever form its path has
+void Publisher::useScopes(ScopeIndex&& scopes) {
+	scopes_.clear();
+	for (auto& item : scopes)
+		scopes_[FileSystem::Path::getFullFileSpec(item.first)] = std::move(item.second);
+}
+
+//keeps a link for each anchored type name, and the lines to mark in each defining file
+/*
+*  Links are made here, once, so rendering a page only looks names up.
+*/
+void Publisher::useAnchors(const AnchorIndex& anchors) {
+	links_.clear();
+	anchorLines_.clear();
+	longestLink_ = 0;
+	for (bool& start : linkStart_)
+		start = false;
+	for (auto& item : anchors) {
+		const string& name = item.first;
+		if (name.empty() || item.second.file.empty())
+			continue;
+		string full = FileSystem::Path::getFullFileSpec(item.second.file);
+		string folder = folderOf(full);
+		Link& link = links_[name];
+		link.file = FileSystem::Path::toLower(full);
+		link.folder = FileSystem::Path::toLower(folder);
+		link.line = item.second.line;
+		link.page = FileSystem::Path::getName(full) + ".html" + (link.line != 0 ? "#L" + to_string(link.line) : "");
+		link.href = "../" + folder + "/" + link.page;
+		if (link.line != 0)
+			anchorLines_[link.file].push_back(link.line);
+		linkStart_[(unsigned char)name[0]] = true;
+		longestLink_ = max(longestLink_, name.size());
+	}
+	for (auto& item : anchorLines_) {
+		sort(item.second.begin(), item.second.end());
+		item.second.erase(unique(item.second.begin(), item.second.end()), item.second.end());
+	}
+}
+
+//link of the name source holds from begin to end, nullptr if it has no anchor
+const Publisher::Link* Publisher::linkOf(const string& source, size_t begin, size_t end) const {
+	if (end - begin > longestLink_ || !linkStart_[(unsigned char)source[begin]])
+		return nullptr;
+	auto iter = links_.find(source.substr(begin, end - begin));
+	return (iter != links_.end()) ? &iter->second : nullptr;
+}
+
+//escapes source from from, linking anchored type names and marking the lines types are defined on
+/*
+*  A type's name where it is defined isn't linked to itself.  Marks are
+*  empty anchors, id='L<line>', at the start of the line.
+*/
+void Publisher::appendLinked(const string& path, const string& source, size_t from, string& out, int& count) const {
+	string file = FileSystem::Path::toLower(FileSystem::Path::getFullFileSpec(path));
+	string folder = folderOf(file);
+	auto defined = anchorLines_.find(file);
+	const vector<size_t>* pLines = (defined != anchorLines_.end()) ? &defined->second : nullptr;
+	size_t mark = 0;
+	size_t run = from;
+	auto markLine = [&](size_t line, size_t at) {
+		if (pLines == nullptr)
+			return;
+		while (mark < pLines->size() && (*pLines)[mark] < line)
+			++mark;
+		if (mark == pLines->size() || (*pLines)[mark] != line)
+			return;
+		appendEscaped(source, run, at, out, count);
+		out += "<a id='L" + to_string(line) + "'></a>";
+		run = at;
+	};
+	markLine(1 + (size_t)std::count(source.begin(), source.begin() + from, '\n'), from);
+	scanNames(source, from, [&](size_t begin, size_t end, size_t line) {
+		const Link* pLink = linkOf(source, begin, end);
+		if (pLink == nullptr || (pLink->line == line && pLink->file == file))
+			return;
+		appendEscaped(source, run, begin, out, count);
+		out += "<a href='" + (pLink->folder == folder ? pLink->page : pLink->href) + "'>";
+		out.append(source, begin, end - begin);
+		out += "</a>";
+		run = end;
+	}, markLine);
+	appendEscaped(source, run, source.size(), out, count);
+}
+
+//the links of the anchored names in source, as ScopeHandler.js's table of name and href
+void Publisher::appendLinkTable(const string& path, const string& source, string& out) const {
+	string folder = folderOf(FileSystem::Path::toLower(FileSystem::Path::getFullFileSpec(path)));
+	std::map<string, const Link*> used;
+	scanNames(source, 0, [&](size_t begin, size_t end, size_t) {
+		const Link* pLink = linkOf(source, begin, end);
+		if (pLink != nullptr)
+			used.emplace(source.substr(begin, end - begin), pLink);
+	}, [](size_t, size_t) {});
+	out += ",{";
+	for (auto iter = used.begin(); iter != used.end(); ++iter) {
+		if (iter != used.begin())
+			out += ",";
+		out += "\"" + iter->first + "\":\"" + (iter->second->folder == folder ? iter->second->page : iter->second->href) + "\"";
+	}
+	out += "}";
+}
+
+//body of a page rendered on demand: include links, the escaped text, and its scope table
+/*
+*  Only text is in the page's DOM until it loads.  scopeInit, in ScopeHandler.js,
+*  then shows the rows in view and adds a control to the first line of each scope.
+*/
+void Publisher::appendLazyBody(const string& path, const string& source, const vector<Scope>* pScopes, bool linked, string& out) {
+	if (pScopes == nullptr) {
+		auto iter = scopes_.find(FileSystem::Path::getFullFileSpec(path));
+		pScopes = (iter != scopes_.end()) ? &iter->second : nullptr;
+	}
+	vector<Scope> scopes = (pScopes != nullptr && !pScopes->empty()) ? *pScopes : braceScopes(source);
+	sort(scopes.begin(), scopes.end());
+	out += "<body>";
+	out += "<pre>";
+	appendIncludeLinks(source, out);
+	out += "</pre>";
+	out += "<pre id='code'>";
+	appendText(source, out);
+	out += "</pre>\n";
+	out += "<script>scopeInit([";
+	for (size_t i = 0; i < scopes.size(); ++i) {
+		if (i > 0)
+			out += ",";
+		out += to_string(scopes[i].first) + "," + to_string(scopes[i].second);
+	}
+	out += "]";
+	if (linked && !links_.empty())
+		appendLinkTable(path, source, out);
+	out += ");</script>\n";
+	out += "</body>\n";
+}
+
 //Function to publish HTML files 
+/*
+*  The page is built in one string and written with a single call.
+*  Include links follow the first character of the source, where the
+*  earlier character-by-character renderer emitted them.
+*  Text the parse pass cached is used instead of reading the file.
+*  Files with more than lazyOver_ braces get a lazy body instead.
+*  Type names the anchors given to useAnchors know are linked to their
+*  definitions, in the same pass that escapes the text.
+*/
 void Publisher::publishCode(string path) {
-	std::string loc = "../"; string link, name; size_t t = string::npos;
-	ifstream myReadFile; ofstream myWriteFile; string getLine;//string TargetPath = "Target";
-	int count = 0; char output = NULL; int begin, end;
-	myReadFile.open(path);
-	myWriteFile.open(path+".html");
-	std::ifstream input(path);
-	if (myReadFile.is_open()) {
-		myWriteFile << "<html>\n";
-		myWriteFile << "<head>\n";
-		myWriteFile << "<link rel=\"stylesheet\" href=\"cssStyleFile.css\">\n";
-		myWriteFile << "<script src=\"ScopeHandler.js\"></script>\n";
-		myWriteFile << "</head>\n";
-		myWriteFile << "<body>";
-		myWriteFile << "<pre>";
-		while ((!myReadFile.eof()) && (myReadFile.get(output))) {
-			switch (output) {
-			case '<':
-				myWriteFile << "&lt;"; break;
-			case '>':
-				myWriteFile << "&gt;"; break;
-			case '{':
-				count++;
-				myWriteFile << "<input type='button' value='-' id='bt" << count << "' onclick='scopeHandle(this);'//>{<div id='dbt" << count << "'>"; break;
-			case '}':
-				myWriteFile <<"}</div>"; break;
-			default:
-				myWriteFile << output;
-				break;
-			}
-			while (getline(input, getLine)) {
-				if ((getLine.find("if") != t)) {
-				}
-				else if (getLine.find("#include") != t && (getLine.find("\"") != t)) {
-					begin = getLine.find('"');
-					end = getLine.find_last_of('"');
-					link = getLine.substr(begin + 1, end - begin - 1);
-					name = getLine.substr(begin + 1, end - begin - 1);
-					myWriteFile << "<a href = \"" << link << ".html\">" << name << "</a>\n";
-				}}
+	render(path, nullptr);
+}
+
+//Publishes with the file's scope lines given, scopes_ is not read
+/*
+*  Used while the AST is being built, so useScopes and useAnchors may run
+*  at the same time; the page's type names aren't linked.
+*/
+void Publisher::publishCode(const string& path, const vector<Scope>& scopes) {
+	render(path, &scopes);
+}
+
+void Publisher::render(const string& path, const vector<Scope>* pScopes) {
+	using Utilities::RunProfile;
+	Utilities::MemoryProfile::Subsystem tag("publisher");
+	bool timed = RunProfile::instance().enabled() || Utilities::Trace::instance().enabled();
+	string profiled = timed ? FileSystem::Path::getFullFileSpec(path) : "";
+	RunProfile::Scope timer("publish", profiled);
+	string source;
+	const Scanner::TokenCache::Entry* pEntry = pCache_ ? pCache_->find(path) : nullptr;
+	if (pEntry != nullptr)
+		source = pEntry->source;
+	else if (!readSource(path, source)) {
+		writePage(path + ".html", "");
+		return;
+	}
+	string out;
+	out.reserve(source.size() + source.size() / 4 + 256);
+	out += "<html>\n";
+	out += "<head>\n";
+	out += "<link rel=\"stylesheet\" href=\"" + cssHref_ + "\">\n";
+	out += "<script src=\"" + jsHref_ + "\"></script>\n";
+	out += "</head>\n";
+	if (lazyOver_ != 0 && (size_t)std::count(source.begin(), source.end(), '{') > lazyOver_)
+		appendLazyBody(path, source, pScopes, pScopes == nullptr, out);
+	else {
+		out += "<body>";
+		out += "<pre>";
+		int count = 0;
+		if (!source.empty()) {
+			appendEscaped(source, 0, 1, out, count);
+			appendIncludeLinks(source, out);
+			if (pScopes == nullptr && !links_.empty())
+				appendLinked(path, source, 1, out, count);
+			else
+				appendEscaped(source, 1, source.size(), out, count);
 		}
-		myWriteFile << "</pre>";
-		myWriteFile << "</body>\n";
-		myWriteFile << "</html>\n";
+		out += "</pre>";
+		out += "</body>\n";
 	}
-	myReadFile.close();
-	myWriteFile.close();
+	out += "</html>\n";
+	writePage(path + ".html", out);
+	RunProfile::instance().count(profiled, RunProfile::HtmlBytes, out.size());
+}
+
+//writes a page and its compressed variant, into the pack when one is used
+/*
+*  A page outside the pack's root, or one the pack can't take, is
+*  written as a file.  A packed page that is no longer compressed has
+*  its old variant dropped from the pack.
+*/
+void Publisher::writePage(const string& page, const string& html) {
+	bool compress = precompressOver_ != 0 && html.size() >= precompressOver_;
+	string name = pPack_ ? pPack_->nameOf(page) : "";
+	if (name != "" && pPack_->add(name, html)) {
+		if (compress)
+			pPack_->add(name + ".gz", Gzip::compress(html));
+		else
+			pPack_->remove(name + ".gz");
+		return;
+	}
+	string staged = pGenerations_ ? pGenerations_->stage(page) : "";
+	string file = (staged != "") ? staged : page;
+	FileSystem::File::remove(file + ".gz");
+	{
+		ofstream myWriteFile(file);
+		myWriteFile.write(html.data(), html.size());
+	}
+	if (compress)
+		writeCompressed(file, html);
+}
+
+//writes page.gz, the page gzip compressed, after the page itself
+/*
+*  The old page.gz is removed before a page is written and the new one is
+*  written under a temporary name and renamed, so a page.gz only ever
+*  holds the page it sits beside, whole, and is never older than it.
+*/
+void Publisher::writeCompressed(const string& page, const string& html) {
+	string zipped = Gzip::compress(html);
+	string temp = page + ".gz.tmp";
+	{
+		ofstream out(temp, ios::binary);
+		out.write(zipped.data(), zipped.size());
+		if (!out.good()) {
+			out.close();
+			FileSystem::File::remove(temp);
+			return;
+		}
+	}
+	if (std::rename(temp.c_str(), (page + ".gz").c_str()) != 0)
+		FileSystem::File::remove(temp);
+}
+
+//Publishes paths on renderer workers fed through a bounded queue
+/*
+*  A producer thread feeds the paths into a queue holding two per worker,
+*  so renderers don't wait for work and little is queued ahead of them.
+*  A page depends only on its own source and on state set before the
+*  call, the scopes, token cache and asset links, which workers only read.
+*  done(path) is called on the worker that wrote the page, after its file
+*  is closed, e.g., to tell a server the page can be sent.
+*/
+void Publisher::publishParallel(const vector<string>& paths, size_t workers, const PageDone& done) {
+	if (paths.empty())
+		return;
+	if (workers == 0)
+		workers = std::thread::hardware_concurrency();
+	workers = (std::max)((size_t)1, (std::min)(workers, paths.size()));
+	Async::BlockingQueue<const string*> queue(2 * workers);
+	std::thread producer([&]() {
+		for (auto& path : paths)
+			queue.enQ(&path);
+		for (size_t i = 0; i < workers; ++i)
+			queue.enQ(nullptr);   // one stop per renderer
+	});
+	vector<std::thread> renderers;
+	for (size_t i = 0; i < workers; ++i) {
+		renderers.push_back(std::thread([&]() {
+			for (const string* pPath = queue.deQ(); pPath != nullptr; pPath = queue.deQ()) {
+				publishCode(*pPath);
+				if (done)
+					done(*pPath);
+			}
+		}));
+	}
+	producer.join();
+	for (auto& renderer : renderers)
+		renderer.join();
+}
+
+//Contents of the style sheet linked from every published file
+string Publisher::cssContent() {
+	string css;
+	css += "body {\n margin:20px; \n color:black; \n background-color:#eee; \n font-family:Consolas; \n";
+	css += "font-weight: 600; \n font-size: 110%;\n ";
+	css += "}";
+	css += ".indent {\n margin-left:20px; \n margin-right:20px; \n }";
+	css += "h4 { \n margin-bottom:3px; \n margin-top:3px; \n}";
+	css += "div { display: inline}";
+	css += "#code { line-height: 1.25em; }";
+	css += ".scope { display: inline-block; width: 1.5em; cursor: pointer; }";
+	return css;
+}
+
+//Contents of the script that expands and collapses scopes
+string Publisher::jsContent() {
+	string js;
+	js += "function scopeHandle(object)\n{\n";
+	js += "var temp=\"d\"+object.id;\n";
+	js += "var div = document.getElementById(temp);\n";
+	js += "var button = document.getElementById(object.id);\n";
+	js += "if(div.style.display != 'none'){\n";
+	js += "\t div.style.display = 'none';\n";
+	js += "button.value = '+';\n";
+	js += "}\n else {\n";
+	js += "div.style.display = 'inline';\n";
+	js += "button.value = '-';\n";
+	js += "}";
+	js += "};\n";
+	js += lazyJsContent();
+	return js;
+}
+
+//Script of lazy pages: rows of #code are rendered from its text as they scroll into view
+/*
+*  scopeInit takes the page's scope table, pairs of first and last line.
+*  Only the rows in and near the viewport are in the DOM, padding stands
+*  in for the rest, so a page of any size lays out like a short one.
+*  The first line of each scope gets a control hiding the lines inside it.
+*  An optional second table maps type names to their definitions' pages,
+*  rows link them as they are rendered, and a #L<line> fragment scrolls
+*  to its line.
+*/
+string Publisher::lazyJsContent() {
+	string js;
+	js += "var scopeLines = [], scopeEnds = {}, scopeClosed = {}, scopeShown = [], scopeLineHeight = 16, scopePending = false, scopeLinks = null;\n";
+	js += "function scopeInit(index, links)\n{\n";
+	js += "scopeLinks = links || null;\n";
+	js += "var pre = document.getElementById('code');\n";
+	js += "scopeLines = pre.textContent.split('\\n');\n";
+	js += "for (var i = 0; i + 1 < index.length; i += 2)\n";
+	js += "\tif (!(index[i] in scopeEnds) || scopeEnds[index[i]] < index[i + 1]) scopeEnds[index[i]] = index[i + 1];\n";
+	js += "pre.textContent = 'X';\n";
+	js += "var one = pre.getBoundingClientRect().height;\n";
+	js += "pre.textContent = 'X\\nX';\n";
+	js += "scopeLineHeight = (pre.getBoundingClientRect().height - one) || scopeLineHeight;\n";
+	js += "scopeRows();\n";
+	js += "scopeRender();\n";
+	js += "scopeJump();\n";
+	js += "window.addEventListener('scroll', scopeSchedule);\n";
+	js += "window.addEventListener('resize', scopeSchedule);\n";
+	js += "window.addEventListener('hashchange', scopeJump);\n";
+	js += "};\n";
+	js += "function scopeJump()\n{\n";
+	js += "var target = /^#L(\\d+)$/.exec(window.location.hash);\n";
+	js += "var r = target ? scopeShown.indexOf(Number(target[1])) : -1;\n";
+	js += "if (r < 0) return;\n";
+	js += "var pre = document.getElementById('code');\n";
+	js += "window.scrollTo(0, pre.getBoundingClientRect().top + window.pageYOffset + r * scopeLineHeight);\n";
+	js += "scopeRender();\n";
+	js += "};\n";
+	js += "function scopeLinked(line)\n{\n";
+	js += "return line.replace(/[A-Za-z_]\\w*|[^A-Za-z_]+/g, function (t) {\n";
+	js += "\tif (scopeLinks.hasOwnProperty(t)) return \"<a href='\" + scopeLinks[t] + \"'>\" + t + '</a>';\n";
+	js += "\treturn t.replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');\n";
+	js += "});\n";
+	js += "};\n";
+	js += "function scopeRows()\n{\n";
+	js += "scopeShown = [];\n";
+	js += "for (var n = 1; n <= scopeLines.length; ++n) {\n";
+	js += "\tscopeShown.push(n);\n";
+	js += "\tif (scopeClosed[n] && scopeEnds[n] > n + 1) n = scopeEnds[n] - 1;\n";
+	js += "}\n";
+	js += "};\n";
+	js += "function scopeSchedule()\n{\n";
+	js += "if (scopePending) return;\n";
+	js += "scopePending = true;\n";
+	js += "window.requestAnimationFrame(function () { scopePending = false; scopeRender(); });\n";
+	js += "};\n";
+	js += "function scopeRender()\n{\n";
+	js += "var pre = document.getElementById('code');\n";
+	js += "var first = Math.max(0, Math.floor(-pre.getBoundingClientRect().top / scopeLineHeight) - 50);\n";
+	js += "first = Math.min(first, scopeShown.length);\n";
+	js += "var last = Math.min(scopeShown.length, first + Math.ceil(window.innerHeight / scopeLineHeight) + 100);\n";
+	js += "var rows = [];\n";
+	js += "for (var r = first; r < last; ++r) {\n";
+	js += "\tvar n = scopeShown[r];\n";
+	js += "\tvar text = scopeLinks ? scopeLinked(scopeLines[n - 1]) : scopeLines[n - 1].replace(/&/g, '&amp;').replace(/</g, '&lt;').replace(/>/g, '&gt;');\n";
+	js += "\tif (scopeEnds[n] > n + 1) rows.push(\"<span class='scope' onclick='scopeToggle(\" + n + \")'>\" + (scopeClosed[n] ? '+' : '-') + '</span>' + text);\n";
+	js += "\telse rows.push(\"<span class='scope'></span>\" + text);\n";
+	js += "}\n";
+	js += "pre.style.paddingTop = (first * scopeLineHeight) + 'px';\n";
+	js += "pre.style.height = ((scopeShown.length - first) * scopeLineHeight) + 'px';\n";
+	js += "pre.innerHTML = rows.join('\\n');\n";
+	js += "};\n";
+	js += "function scopeToggle(n)\n{\n";
+	js += "scopeClosed[n] = !scopeClosed[n];\n";
+	js += "scopeRows();\n";
+	js += "scopeRender();\n";
+	js += "};";
+	return js;
 }
 
 //Function to Style HTML files generated
 void Publisher::StylingPublisherCSS(string temp) {
+	if (sharedAssets())
+		return;
 	ofstream cssStyling;
 	cssStyling.open(temp + "cssStyleFile.css");
 	if (cssStyling.is_open()){
-		cssStyling << "body {\n margin:20px; \n color:black; \n background-color:#eee; \n font-family:Consolas; \n";
-		cssStyling << "font-weight: 600; \n font-size: 110%;\n ";
-		cssStyling << "}";
-		cssStyling << ".indent {\n margin-left:20px; \n margin-right:20px; \n }";
-		cssStyling << "h4 { \n margin-bottom:3px; \n margin-top:3px; \n}";
-		cssStyling << "div { display: inline}";
+		cssStyling << cssContent();
 		cssStyling.close();
 	}
 	else cout << "Issue openeing the file";
@@ -80,39 +621,69 @@ void Publisher::StylingPublisherCSS(string temp) {
 
 //Function to provide scope handling on mouse clicks
 void Publisher::StylingPublisherJS(string temp) {
+	if (sharedAssets())
+		return;
 	ofstream ScopeHandling;
 	ScopeHandling.open(temp + "ScopeHandler.Js");
 	if (ScopeHandling.is_open()){
-		ScopeHandling << "function scopeHandle(object)\n{\n";
-		ScopeHandling << "var temp=\"d\"+object.id;\n";
-		ScopeHandling << "var div = document.getElementById(temp);\n";
-		ScopeHandling << "var button = document.getElementById(object.id);\n";
-		ScopeHandling << "if(div.style.display != 'none'){\n";
-		ScopeHandling << "\t div.style.display = 'none';\n";
-		ScopeHandling << "button.value = '+';\n";
-		ScopeHandling << "}\n else {\n";
-		ScopeHandling << "div.style.display = 'inline';\n";
-		ScopeHandling << "button.value = '-';\n";
-		ScopeHandling << "}";
-		ScopeHandling << "};";
+		ScopeHandling << jsContent();
 	}
 	ScopeHandling.close();
 }
 
+//Writes CSS and JS once to root/assets, named by content hash, and links them from every page
+/*
+*  Published files live one directory below root, so pages reach the
+*  assets through "../assets/".  A hashed name only ever holds one
+*  content, so an existing asset is not written again and clients may
+*  cache it indefinitely.  Per directory styling calls do nothing in
+*  this mode.
+*/
+bool Publisher::useSharedAssets(const string& root) {
+	string dir = root + "/assets";
+	if (!FileSystem::Directory::exists(dir) && !FileSystem::Directory::create(dir))
+		return false;
+	string css = cssContent();
+	string js = jsContent();
+	string cssName = "cssStyleFile." + PublishManifest::textHash(css) + ".css";
+	string jsName = "ScopeHandler." + PublishManifest::textHash(js) + ".js";
+	if (!writeAsset(dir + "/" + cssName, css) || !writeAsset(dir + "/" + jsName, js))
+		return false;
+	cssHref_ = "../assets/" + cssName;
+	jsHref_ = "../assets/" + jsName;
+	return true;
+}
+
+//writes an asset unless a file with its content hashed name already exists
+bool Publisher::writeAsset(const string& fileSpec, const string& content) {
+	if (FileSystem::File::exists(fileSpec))
+		return true;
+	ofstream out(fileSpec);
+	if (!out.is_open())
+		return false;
+	out << content;
+	return out.good();
+}
+
+//are pages linked to shared, content hashed assets?
+bool Publisher::sharedAssets() const {
+	return cssHref_ != "cssStyleFile.css";
+}
+
 //Function to Iterate through all files in repository and to invoke publishing HTML Files and display Executive information on console
 void Publisher::FileIteration() {
 	cout << "\n\n---------Requirement 1 and 2 can be verifired from the code----------------------------------- \n\n";
 	cout << "\n\n---------Requirement 3 can be demonstrated by Publisher Package which publishes HTML files in the same location(specified by command line) where the .h and .cpp files are present----------------------\n\n";
 	cout << "\n\n---------Requirement 5 of Styling HTML Files using CSS file named (cssStylefile.css) and Using JavaScipt file named (ScopeHandler.Js) to Handle Mouse clicks can be demonstrated by clicking .h and .cpp files which are displayed using index.html file upon executing run.bat--------------\n\n";
 	std::string dirpath_ = "../Repository";
-    currentDirectories = directory.getDirectories(dirpath_);
+    currentDirectories = pInventory_ ? pInventory_->getDirectories(dirpath_) : directory.getDirectories(dirpath_);
 	cout << "\n\n---------Requirement 6 of providing links in Head Section to (cssStylefile.css) file and to JavaScript file (ScopeHandler.Js) is implemented in publishCode function of Publisher.cpp file of publisher package--------------\n\n";
 	for (size_t i = 0; i < currentDirectories.size(); i++) {
 		std::string appendpath = dirpath_ + "/" + currentDirectories[i];
 		string temp = dirpath_ + "/" + currentDirectories[i] + "/";
 		StylingPublisherCSS(temp);
 		StylingPublisherJS(temp);
-		std::vector<std::string> temporaryFiles = directory.getFiles(appendpath);
+		std::vector<std::string> temporaryFiles = pInventory_ ? pInventory_->getFiles(appendpath) : directory.getFiles(appendpath);
 		for (size_t k = 0; k < temporaryFiles.size(); k++) {
 			currentFiles.push_back(dirpath_ + "/" + currentDirectories[i] + "/" + temporaryFiles[k]);
 			fileCollection.push_back(temporaryFiles[k]);
@@ -18,8 +18,20 @@
 * Public Interface
 * --------------------
 *  void publishCode(std::string path);                //Function  to create HTML File
+*  void publishParallel(paths, workers, done);        //Function  to publish files on workers, done(path) per page
+*  void publishCode(path, scopes);                    //Function  to create HTML File with the given scope lines
 *  void StylingPublisherCSS(std::string pat);         //Function  to apply styling on published files
 *  void StylingPublisherJS(std::string t);            //Function  to handle scope handling functionality 
+*  bool useSharedAssets(const std::string& root);     //Function  to write CSS/JS once, content hashed, to root/assets
+*  bool sharedAssets() const;                         //Function  to check if pages link to shared assets
+*  void useTokenCache(const Scanner::TokenCache* p);  //Function  to render from text the parser already read
+*  void useInventory(const FileInventory* p);         //Function  to list the repository from an inventory made once
+*  void useScopes(ScopeIndex&& scopes);               //Function  to take each file's scope lines from the AST
+*  void useAnchors(const AnchorIndex& anchors);       //Function  to link type names to their definitions' lines
+*  void lazyOver(size_t braces);                      //Function  to render pages with more braces on demand, 0 never
+*  void precompress(size_t bytes);                    //Function  to also write page.html.gz for pages this large, 0 never
+*  void usePack(PagePack* p);                         //Function  to write pages into one indexed pack, nullptr a file each
+*  void useGenerations(PageGenerations* p);           //Function  to write pages into the generation p stages, nullptr in place
 *  void FileIteration();                              //Function to iterate through files 
 *  std::vector<std::string> currentDirectories,       //variables to access repository
 *  std::vector<std::string> currentFiles;             //variables to access repository
@@ -31,7 +43,7 @@
 *
 * Required Files:
 * ---------------
-*   -FileSystem.h,DependencyAnalysis.h
+*   -FileSystem.h,DependencyAnalysis.h,RunProfile.h,FileInventory.h,Gzip.h,PagePack.h,PageGenerations.h
 
 * Build Process:
 * --------------
@@ -39,6 +51,51 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.13 : 14 Oct 2026
+* - rendering a page counts its allocations as the publisher subsystem's in MemoryProfile
+* Ver 1.12 : 14 Oct 2026
+* - added useAnchors: type names with an anchor, the file and first line of their
+*   definition, are linked to it, page.html#L<line>, in the pass that escapes the text,
+*   and each defining line is marked; lazy pages get a table of the names they use,
+*   which ScopeHandler.js links as rows are rendered
+* Ver 1.11 : 14 Oct 2026
+* - added useGenerations: pages, and their compressed variants, are written into the
+*   generation a PageGenerations stages, not over the pages a server is reading
+* Ver 1.10 : 14 Oct 2026
+* - added usePack: pages, and their compressed variants, are added to a PagePack, one
+*   append-only file with an index, instead of being written as a file each
+* Ver 1.9 : 14 Oct 2026
+* - added precompress: pages of at least the given size are also written gzip compressed,
+*   as page.html.gz, once, as they are rendered, so a server sends them compressed without
+*   compressing anything per request
+* Ver 1.8 : 14 Oct 2026
+* - added publishCode(path, scopes), which takes a file's scope lines from the caller
+*   instead of the index given to useScopes, so pages can be rendered while the AST
+*   is still being built
+* Ver 1.7 : 14 Oct 2026
+* - added publishParallel: a producer feeds paths through a bounded BlockingQueue to
+*   renderer workers running publishCode, and done(path) is called as each page is
+*   written, so a server can send pages while the rest are still rendering
+* Ver 1.6 : 14 Oct 2026
+* - pages of files with more than lazyOver braces are published without a button
+*   and div per brace: the page holds the escaped text and a table of scope start and
+*   end lines, from the AST given to useScopes or else from matching braces, and
+*   ScopeHandler.js renders only the rows in view, with collapse controls, as the
+*   page scrolls
+* Ver 1.5 : 14 Oct 2026
+* - added useInventory: FileIteration takes directories and files from the executive's
+*   FileInventory instead of listing the repository again
+* Ver 1.4 : 14 Oct 2026
+* - publishCode times each page and counts its html bytes with RunProfile
+* Ver 1.3 : 14 Oct 2026
+* - publishCode takes the source text from a Scanner::TokenCache when the parse
+*   pass cached it, instead of reading the file again
+* Ver 1.2 : 14 Oct 2026
+* - added useSharedAssets: CSS and JS are written once to a content hashed
+*   location under root/assets instead of into every directory
+* Ver 1.1 : 14 Oct 2026
+* - publishCode reads the source in large blocks, escapes it with a lookup table
+*   and writes each page with one call; include links come from one line scan
 * Ver 1.0 : 4 April 2017
 * - first release
 *
@@ -48,15 +105,41 @@
 #pragma once
 #include <iostream>
 #include <vector>
+#include <unordered_map>
+#include <functional>
 #include "../FileSystem/FileSystem.h"
+#include "../FileMgr/FileInventory.h"
 #include "../DependencyAnalysis/DependencyAnalysis.h"
 #include "../Analyzer/TypeAnalysis.h"
+class PagePack;
+class PageGenerations;
+
 class Publisher {
 public:
+	using Scope = std::pair<size_t, size_t>;                          // first and last line
+	using ScopeIndex = std::unordered_map<std::string, std::vector<Scope>>;
+	struct Anchor {
+		std::string file;   // source file defining the type
+		size_t line;        // its first line, 0 if only the file is known
+	};
+	using AnchorIndex = std::unordered_map<std::string, Anchor>;     // by type name
 	void publisher() {};
+	using PageDone = std::function<void(const std::string& path)>;
 	void publishCode(std::string path);
+	void publishCode(const std::string& path, const std::vector<Scope>& scopes);
+	void publishParallel(const std::vector<std::string>& paths, size_t workers = 0, const PageDone& done = PageDone());
 	void StylingPublisherCSS(std::string pat);
 	void StylingPublisherJS(std::string t);
+	bool useSharedAssets(const std::string& root);
+	bool sharedAssets() const;
+	void useTokenCache(const Scanner::TokenCache* pCache) { pCache_ = pCache; }
+	void useInventory(const FileManager::FileInventory* pInventory) { pInventory_ = pInventory; }
+	void useScopes(ScopeIndex&& scopes);
+	void useAnchors(const AnchorIndex& anchors);
+	void lazyOver(size_t braces) { lazyOver_ = braces; }
+	void precompress(size_t bytes) { precompressOver_ = bytes; }
+	void usePack(PagePack* pPack) { pPack_ = pPack; }
+	void useGenerations(PageGenerations* pGenerations) { pGenerations_ = pGenerations; }
 	FileSystem::Directory directory;
 	FileSystem::Path  path ;
 	void FileIteration();
@@ -66,4 +149,36 @@ public:
 	std::vector<std::string> filecontainer;
 	DependencyAnalysis  dep;
 	TypeTable TT;
+private:
+	struct Link {
+		std::string file;     // full path of the defining file, lower case
+		std::string folder;   // its directory's name, lower case
+		size_t line;
+		std::string page;     // href from a page in the same directory
+		std::string href;     // href from a page in another directory
+	};
+	static std::string cssContent();
+	static std::string jsContent();
+	static bool writeAsset(const std::string& fileSpec, const std::string& content);
+	static std::string lazyJsContent();
+	void render(const std::string& path, const std::vector<Scope>* pScopes);
+	void appendLazyBody(const std::string& path, const std::string& source, const std::vector<Scope>* pScopes, bool linked, std::string& out);
+	const Link* linkOf(const std::string& source, size_t begin, size_t end) const;
+	void appendLinked(const std::string& path, const std::string& source, size_t from, std::string& out, int& count) const;
+	void appendLinkTable(const std::string& path, const std::string& source, std::string& out) const;
+	void writePage(const std::string& page, const std::string& html);
+	void writeCompressed(const std::string& page, const std::string& html);
+	std::string cssHref_ = "cssStyleFile.css";
+	std::string jsHref_ = "ScopeHandler.js";
+	const Scanner::TokenCache* pCache_ = nullptr;
+	const FileManager::FileInventory* pInventory_ = nullptr;
+	ScopeIndex scopes_;
+	std::unordered_map<std::string, Link> links_;                    // by type name
+	std::unordered_map<std::string, std::vector<size_t>> anchorLines_; // lines to mark, by Link::file
+	bool linkStart_[256] = {};                                         // first characters of linked names
+	size_t longestLink_ = 0;
+	size_t lazyOver_ = 2000;
+	size_t precompressOver_ = 0;
+	PagePack* pPack_ = nullptr;
+	PageGenerations* pGenerations_ = nullptr;
 };
@@ -2,7 +2,7 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.4                                                   //
+// ver 1.5                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
@@ -24,6 +24,10 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.5 : 14 Oct 2026
+ * - added enQ(T&&) and emplace(args...), and deQ now moves the
+ *   front element out, so messages are handed off without copies
+ * - move constructor and move assignment now move the queue
  * ver 1.4 : 29 Jul 2016
  * - wrapped with namespace Async
  * ver 1.3 : 04 Mar 2016
@@ -61,6 +65,9 @@ namespace Async
     BlockingQueue<T>& operator=(const BlockingQueue<T>&) = delete;
     T deQ();
     void enQ(const T& t);
+    void enQ(T&& t);
+    template <typename... Args>
+    void emplace(Args&&... args);
     T& front();
     void clear();
     size_t size();
@@ -75,9 +82,9 @@ namespace Async
   BlockingQueue<T>::BlockingQueue(BlockingQueue<T>&& bq) // need to lock so can't initialize
   {
     std::lock_guard<std::mutex> l(mtx_);
-    q_ = bq.q_;
-    while (bq.q_.size() > 0)  // clear bq
-      bq.q_.pop();
+    std::lock_guard<std::mutex> lbq(bq.mtx_);
+    q_ = std::move(bq.q_);
+    std::queue<T>().swap(bq.q_);  // leave bq empty
     /* can't copy  or move mutex or condition variable, so use default members */
   }
   //----< move assignment >----------------------------------------------
@@ -86,10 +93,11 @@ namespace Async
   BlockingQueue<T>& BlockingQueue<T>::operator=(BlockingQueue<T>&& bq)
   {
     if (this == &bq) return *this;
-    std::lock_guard<std::mutex> l(mtx_);
-    q_ = bq.q_;
-    while (bq.q_.size() > 0)  // clear bq
-      bq.q_.pop();
+    std::lock(mtx_, bq.mtx_);  // both at once, so opposite assignments can't deadlock
+    std::lock_guard<std::mutex> l(mtx_, std::adopt_lock);
+    std::lock_guard<std::mutex> lbq(bq.mtx_, std::adopt_lock);
+    q_ = std::move(bq.q_);
+    std::queue<T>().swap(bq.q_);  // leave bq empty
     /* can't move assign mutex or condition variable so use target's */
     return *this;
   }
@@ -111,7 +119,7 @@ namespace Async
      */
     if (q_.size() > 0)
     {
-      T temp = q_.front();
+      T temp = std::move(q_.front());
       q_.pop();
       return temp;
     }
@@ -119,7 +127,7 @@ namespace Async
 
     while (q_.size() == 0)
       cv_.wait(l, [this]() { return q_.size() > 0; });
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
     return temp;
   }
@@ -134,6 +142,29 @@ namespace Async
     }
     cv_.notify_one();
   }
+  //----< move element onto back of queue >------------------------------
+
+  template<typename T>
+  void BlockingQueue<T>::enQ(T&& t)
+  {
+    {
+      std::unique_lock<std::mutex> l(mtx_);
+      q_.push(std::move(t));
+    }
+    cv_.notify_one();
+  }
+  //----< construct element in place at back of queue >------------------
+
+  template<typename T>
+  template<typename... Args>
+  void BlockingQueue<T>::emplace(Args&&... args)
+  {
+    {
+      std::unique_lock<std::mutex> l(mtx_);
+      q_.emplace(std::forward<Args>(args)...);
+    }
+    cv_.notify_one();
+  }
   //----< peek at next item to be popped >-------------------------------
 
   template <typename T>
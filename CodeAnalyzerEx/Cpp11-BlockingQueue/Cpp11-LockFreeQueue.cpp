@@ -0,0 +1,148 @@
+///////////////////////////////////////////////////////////////
+// Cpp11-LockFreeQueue.cpp - Bounded lock-free MPMC Queue    //
+// ver 1.0                                                   //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
+///////////////////////////////////////////////////////////////
+
+#include <string>
+#include <iostream>
+#include <sstream>
+#include "Cpp11-LockFreeQueue.h"
+
+#ifdef TEST_LOCKFREEQUEUE
+
+using namespace Async;
+
+std::mutex ioLock;
+
+void test(LockFreeQueue<std::string>* pQ)
+{
+  std::string msg;
+  do
+  {
+    msg = pQ->deQ();
+    {
+      std::lock_guard<std::mutex> l(ioLock);
+      std::cout << "\n  thread deQed " << msg.c_str();
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  } while (msg != "quit");
+}
+
+int main()
+{
+  std::cout << "\n  Demonstrating C++11 Lock-Free Queue";
+  std::cout << "\n =====================================";
+
+  LockFreeQueue<std::string> q(8);
+  std::thread t(test, &q);
+
+  for (int i = 0; i < 15; ++i)     // more than capacity, so enQ blocks
+  {
+    std::ostringstream temp;
+    temp << i;
+    std::string msg = std::string("msg#") + temp.str();
+    {
+      std::lock_guard<std::mutex> l(ioLock);
+      std::cout << "\n   main enQing " << msg.c_str();
+    }
+    q.enQ(msg);
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  }
+  q.enQ("quit");
+  t.join();
+
+  std::cout << "\n";
+  std::cout << "\n  Batch enQ and deQAll";
+  std::cout << "\n ----------------------";
+
+  std::vector<std::string> batch = { "one", "two", "three" };
+  q.enQAll(batch);
+  std::cout << "\n  capacity = " << q.capacity() << ", size after enQAll = " << q.size();
+  std::vector<std::string> drained;
+  size_t count = q.deQAll(drained);
+  std::cout << "\n  deQAll took " << count << " elements:";
+  for (auto& msg : drained)
+    std::cout << " " << msg;
+
+  std::cout << "\n";
+  std::cout << "\n  tryDeQ with timeout on empty queue";
+  std::cout << "\n ------------------------------------";
+
+  std::string msg;
+  auto start = std::chrono::steady_clock::now();
+  bool got = q.tryDeQ(msg, std::chrono::milliseconds(50));
+  auto waited = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+  std::cout << "\n  tryDeQ returned " << std::boolalpha << got << " after " << waited.count() << " ms";
+
+  std::cout << "\n\n";
+}
+
+#endif
+
+#ifdef TEST_QUEUEBENCH
+
+#include "Cpp11-BlockingQueue.h"
+#include <iomanip>
+
+using namespace Async;
+
+//----< run producers and consumers over queue, return msgs/sec >------
+/*
+ * - each producer enQs its share of numMsgs, then one "quit" per
+ *   consumer is sent after all producers finish
+ */
+template <typename Queue>
+double run(Queue& q, size_t numProducers, size_t numConsumers, size_t numMsgs)
+{
+  std::vector<std::thread> threads;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t c = 0; c < numConsumers; ++c)
+  {
+    threads.push_back(std::thread([&q]() {
+      while (q.deQ() != "quit");
+    }));
+  }
+  std::vector<std::thread> producers;
+  for (size_t p = 0; p < numProducers; ++p)
+  {
+    producers.push_back(std::thread([&q, numMsgs, numProducers]() {
+      std::string msg = "message body";
+      for (size_t i = 0; i < numMsgs / numProducers; ++i)
+        q.enQ(msg);
+    }));
+  }
+  for (auto& producer : producers)
+    producer.join();
+  for (size_t c = 0; c < numConsumers; ++c)
+    q.enQ("quit");
+  for (auto& thread : threads)
+    thread.join();
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return numMsgs / elapsed.count();
+}
+
+int main()
+{
+  std::cout << "\n  Comparing BlockingQueue with LockFreeQueue";
+  std::cout << "\n ============================================";
+
+  const size_t numMsgs = 1000000;
+  const size_t numConsumers = 4;
+  std::cout << "\n  " << numMsgs << " messages, " << numConsumers << " consumers\n";
+  std::cout << "\n  " << std::setw(10) << "producers" << std::setw(20) << "BlockingQueue" << std::setw(20) << "LockFreeQueue";
+  size_t producerCounts[] = { 1, 4, 16 };
+  for (size_t numProducers : producerCounts)
+  {
+    BlockingQueue<std::string> bq;
+    LockFreeQueue<std::string> lfq(4096);
+    double blocking = run(bq, numProducers, numConsumers, numMsgs);
+    double lockFree = run(lfq, numProducers, numConsumers, numMsgs);
+    std::cout << "\n  " << std::setw(10) << numProducers
+      << std::setw(14) << (size_t)blocking << " msg/s"
+      << std::setw(14) << (size_t)lockFree << " msg/s";
+  }
+  std::cout << "\n\n";
+}
+
+#endif
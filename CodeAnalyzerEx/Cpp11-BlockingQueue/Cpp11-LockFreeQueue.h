@@ -0,0 +1,341 @@
+#ifndef CPP11_LOCKFREEQUEUE_H
+#define CPP11_LOCKFREEQUEUE_H
+///////////////////////////////////////////////////////////////
+// Cpp11-LockFreeQueue.h - Bounded lock-free MPMC Queue      //
+// ver 1.0                                                   //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
+///////////////////////////////////////////////////////////////
+/*
+ * Package Operations:
+ * -------------------
+ * This package contains one thread-safe class: LockFreeQueue<T>.
+ * It supports the same message passing as BlockingQueue<T>, for
+ * any number of producer and consumer threads, without taking a
+ * lock on the enQ and deQ paths.
+ *
+ * Storage is a ring of cells, each with a sequence number that tells
+ * producers and consumers whose turn it is to use the cell.  Threads
+ * claim cells with a compare-and-swap on the shared head or tail
+ * index.  The ring has a fixed capacity, rounded up to a power of 2:
+ * - enQ blocks while the queue is full, deQ blocks while it is empty
+ * - a blocked thread spins briefly, then sleeps on a condition
+ *   variable; the mutex is only used by sleeping threads and the
+ *   threads that wake them
+ *
+ * Unlike BlockingQueue there is no front(), since another consumer
+ * may take the front element while it is being inspected.
+ *
+ * Public Interface:
+ * -----------------
+ * LockFreeQueue<Msg> q(1024);          // queue holding at most 1024 messages
+ * q.enQ(msg);                          // blocks while full
+ * q.enQAll(msgs);                      // enQ each element of a vector
+ * Msg msg = q.deQ();                   // blocks while empty
+ * q.tryDeQ(msg, ms);                   // waits at most ms, false if still empty
+ * q.deQAll(msgs);                      // wait for one, then take all available
+ * size_t n = q.size();                 // approximate while threads are running
+ * q.clear();
+ *
+ * Required Files:
+ * ---------------
+ * Cpp11-LockFreeQueue.h
+ *
+ * Build Process:
+ * --------------
+ * devenv Cpp11-BlockingQueue.sln /rebuild debug
+ * - define TEST_LOCKFREEQUEUE for the test stub, TEST_QUEUEBENCH for
+ *   the comparison with BlockingQueue
+ *
+ * Maintenance History:
+ * --------------------
+ * ver 1.0 : 14 Oct 2026
+ * - first release
+ *
+ */
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include <type_traits>
+#include <new>
+
+namespace Async
+{
+  template <typename T>
+  class LockFreeQueue {
+  public:
+    LockFreeQueue(size_t capacity = 1024);
+    ~LockFreeQueue();
+    LockFreeQueue(const LockFreeQueue<T>&) = delete;
+    LockFreeQueue<T>& operator=(const LockFreeQueue<T>&) = delete;
+    T deQ();
+    bool tryDeQ(T& t, std::chrono::milliseconds timeout = std::chrono::milliseconds(0));
+    size_t deQAll(std::vector<T>& items);
+    void enQ(const T& t);
+    void enQAll(const std::vector<T>& items);
+    void clear();
+    size_t size();
+    size_t capacity();
+  private:
+    struct Cell
+    {
+      std::atomic<size_t> seq;
+      typename std::aligned_storage<sizeof(T), std::alignment_of<T>::value>::type data;
+    };
+    enum { CacheLine = 64, SpinCount = 64 };
+    bool tryPush(const T& t);
+    bool tryPop(T& t);
+    void wake(std::atomic<size_t>& sleepers, bool all = false);
+    template <typename Pred>
+    bool sleepUntil(std::atomic<size_t>& sleepers, Pred ready, std::chrono::steady_clock::time_point deadline);
+
+    std::vector<Cell> cells_;
+    size_t mask_;
+    char pad0_[CacheLine];
+    std::atomic<size_t> tail_;  // next cell to enQ
+    char pad1_[CacheLine];
+    std::atomic<size_t> head_;  // next cell to deQ
+    char pad2_[CacheLine];
+    std::atomic<size_t> waitingToDeQ_;
+    std::atomic<size_t> waitingToEnQ_;
+    std::mutex mtx_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+  };
+  //----< create empty queue, capacity is rounded up to a power of 2 >---
+
+  template <typename T>
+  LockFreeQueue<T>::LockFreeQueue(size_t capacity)
+    : cells_(0), tail_(0), head_(0), waitingToDeQ_(0), waitingToEnQ_(0)
+  {
+    size_t size = 2;
+    while (size < capacity)
+      size *= 2;
+    std::vector<Cell> cells(size);
+    cells_.swap(cells);
+    mask_ = size - 1;
+    for (size_t i = 0; i < size; ++i)
+      cells_[i].seq.store(i, std::memory_order_relaxed);
+  }
+  //----< destroy elements still in queue >------------------------------
+
+  template <typename T>
+  LockFreeQueue<T>::~LockFreeQueue()
+  {
+    clear();
+  }
+  //----< claim a free cell and store t, false if queue is full >--------
+  /*
+   * A cell is free for position pos when its seq equals pos.  After
+   * storing, seq is set to pos + 1, which hands the cell to consumers.
+   */
+  template <typename T>
+  bool LockFreeQueue<T>::tryPush(const T& t)
+  {
+    size_t pos = tail_.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)pos;
+      if (diff == 0)
+      {
+        if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          new (&cell.data) T(t);
+          cell.seq.store(pos + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  //----< claim a full cell and move its element to t, false if empty >--
+  /*
+   * A cell holds the element for position pos when its seq equals
+   * pos + 1.  After taking it, seq is advanced by the ring size, which
+   * frees the cell for the producer one lap later.
+   */
+  template <typename T>
+  bool LockFreeQueue<T>::tryPop(T& t)
+  {
+    size_t pos = head_.load(std::memory_order_relaxed);
+    while (true)
+    {
+      Cell& cell = cells_[pos & mask_];
+      size_t seq = cell.seq.load(std::memory_order_acquire);
+      ptrdiff_t diff = (ptrdiff_t)seq - (ptrdiff_t)(pos + 1);
+      if (diff == 0)
+      {
+        if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+        {
+          T* pElem = reinterpret_cast<T*>(&cell.data);
+          t = std::move(*pElem);
+          pElem->~T();
+          cell.seq.store(pos + mask_ + 1, std::memory_order_release);
+          return true;
+        }
+      }
+      else if (diff < 0)
+        return false;
+      else
+        pos = head_.load(std::memory_order_relaxed);
+    }
+  }
+  //----< notify sleeping threads, if any, after a push or pop >--------
+  /*
+   * The fence orders the push or pop before reading the sleeper count,
+   * pairing with the fence in sleepUntil, so a sleeper either sees the
+   * change when it checks again or is counted here and woken.
+   */
+  template <typename T>
+  void LockFreeQueue<T>::wake(std::atomic<size_t>& sleepers, bool all)
+  {
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (sleepers.load(std::memory_order_relaxed) == 0)
+      return;
+    std::condition_variable& cv = (&sleepers == &waitingToDeQ_) ? notEmpty_ : notFull_;
+    std::lock_guard<std::mutex> l(mtx_);
+    if (all)
+      cv.notify_all();
+    else
+      cv.notify_one();
+  }
+  //----< sleep until ready() succeeds or deadline passes >--------------
+
+  template <typename T>
+  template <typename Pred>
+  bool LockFreeQueue<T>::sleepUntil(std::atomic<size_t>& sleepers, Pred ready, std::chrono::steady_clock::time_point deadline)
+  {
+    std::condition_variable& cv = (&sleepers == &waitingToDeQ_) ? notEmpty_ : notFull_;
+    std::unique_lock<std::mutex> l(mtx_);
+    sleepers.fetch_add(1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    bool done = ready();
+    while (!done && std::chrono::steady_clock::now() < deadline)
+    {
+      if (deadline == std::chrono::steady_clock::time_point::max())
+        cv.wait(l);
+      else
+        cv.wait_until(l, deadline);
+      done = ready();
+    }
+    sleepers.fetch_sub(1, std::memory_order_relaxed);
+    return done;
+  }
+  //----< remove element from front of queue, blocks while empty >------
+
+  template <typename T>
+  T LockFreeQueue<T>::deQ()
+  {
+    T t;
+    tryDeQ(t, std::chrono::milliseconds::max());
+    return t;
+  }
+  //----< remove front element, waiting at most timeout >----------------
+
+  template <typename T>
+  bool LockFreeQueue<T>::tryDeQ(T& t, std::chrono::milliseconds timeout)
+  {
+    bool done = false;
+    for (size_t i = 0; i < SpinCount && !done; ++i)
+    {
+      done = tryPop(t);
+      if (!done)
+        std::this_thread::yield();
+    }
+    if (!done && timeout.count() > 0)
+    {
+      auto now = std::chrono::steady_clock::now();
+      auto deadline = (timeout >= std::chrono::hours(24 * 365)) ? std::chrono::steady_clock::time_point::max() : now + timeout;
+      done = sleepUntil(waitingToDeQ_, [&]() { return tryPop(t); }, deadline);
+    }
+    if (done)
+      wake(waitingToEnQ_);
+    return done;
+  }
+  //----< wait for one element, then take every element available >-----
+
+  template <typename T>
+  size_t LockFreeQueue<T>::deQAll(std::vector<T>& items)
+  {
+    size_t count = 0;
+    items.push_back(deQ());
+    ++count;
+    T t;
+    while (tryPop(t))
+    {
+      items.push_back(std::move(t));
+      ++count;
+    }
+    if (count > 1)
+      wake(waitingToEnQ_, true);
+    return count;
+  }
+  //----< push element onto back of queue, blocks while full >-----------
+
+  template <typename T>
+  void LockFreeQueue<T>::enQ(const T& t)
+  {
+    bool done = false;
+    for (size_t i = 0; i < SpinCount && !done; ++i)
+    {
+      done = tryPush(t);
+      if (!done)
+        std::this_thread::yield();
+    }
+    if (!done)
+      sleepUntil(waitingToEnQ_, [&]() { return tryPush(t); }, std::chrono::steady_clock::time_point::max());
+    wake(waitingToDeQ_);
+  }
+  //----< push each element of items, in order >-------------------------
+  /*
+   * Consumers are woken once for the batch unless the queue fills,
+   * in which case enQ wakes them so they can make room.
+   */
+  template <typename T>
+  void LockFreeQueue<T>::enQAll(const std::vector<T>& items)
+  {
+    for (auto& item : items)
+    {
+      if (!tryPush(item))
+        enQ(item);
+    }
+    wake(waitingToDeQ_, true);
+  }
+  //----< remove all elements from queue >-------------------------------
+
+  template <typename T>
+  void LockFreeQueue<T>::clear()
+  {
+    T t;
+    bool removed = false;
+    while (tryPop(t))
+      removed = true;
+    if (removed)
+      wake(waitingToEnQ_, true);
+  }
+  //----< return number of elements in queue >---------------------------
+
+  template <typename T>
+  size_t LockFreeQueue<T>::size()
+  {
+    size_t tail = tail_.load(std::memory_order_acquire);
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail > head ? tail - head : 0;
+  }
+  //----< maximum number of elements queue can hold >--------------------
+
+  template <typename T>
+  size_t LockFreeQueue<T>::capacity()
+  {
+    return mask_ + 1;
+  }
+}
+#endif
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // DependencyAnalysis.cpp: creates an Dependendency table        //
-// ver 1.0                                                       //
+// ver 1.7                                                       //
 // Application: Type Based Dependency Analysis, Spring 2017      //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project2             //
@@ -11,41 +11,348 @@
 #include "DependencyAnalysis.h"
 #include <algorithm>
 #include <iomanip>
+#include <thread>
+#include <atomic>
+#include <deque>
 #include "../HelpSession/NoSqlDb/NoSqlDb.h"
 #include "../HelpSession/DbToXml/persist.cpp"
-std::unordered_map<std::string, std::vector<std::string>> DependencyAnalysis::DependencyAnalysistable(TypeTable& tt,std::string& s) {
-	
-	std::vector<std::string> temp;
-	std::string fileSpec = s;
-	std::ifstream in(fileSpec);
-	if (!in.good()) {
-		std::cout << "\n  can't open " << fileSpec << "\n\n";
+#include "../Utilities/Trace.h"
+#include "../Utilities/MemoryProfile.h"
+
+//----< id of file, interned the first time it is seen >---------------
+
+DependencyGraph::FileId DependencyGraph::intern(const std::string& file) {
+	auto iter = ids_.find(file);
+	if (iter != ids_.end())
+		return iter->second;
+	FileId id = static_cast<FileId>(names_.size());
+	names_.push_back(file);
+	ids_[file] = id;
+	return id;
+}
+
+bool DependencyGraph::find(const std::string& file, FileId& id) const {
+	auto iter = ids_.find(file);
+	if (iter == ids_.end())
+		return false;
+	id = iter->second;
+	return true;
+}
+
+void DependencyGraph::clear() {
+	names_.clear();
+	ids_.clear();
+	offsets_.clear();
+	targets_.clear();
+	sources_ = 0;
+}
+//----< stores rows, rows[i] the targets of file i, sorted and unique >---
+/*
+*  Two counting passes sort every row at once: edges are first listed
+*  by target, then scattered back to their sources in target order, so
+*  each row comes out sorted with duplicates adjacent.  All of it is
+*  linear in files plus edges, no comparison sort is needed.
+*/
+void DependencyGraph::build(std::vector<std::vector<FileId>>& rows) {
+	size_t n = names_.size();
+	sources_ = rows.size();
+	std::vector<size_t> inOffsets(n + 1, 0);
+	for (auto& row : rows)
+		for (FileId target : row)
+			++inOffsets[target + 1];
+	for (size_t t = 0; t < n; ++t)
+		inOffsets[t + 1] += inOffsets[t];
+	std::vector<FileId> inSources(inOffsets[n]);
+	std::vector<size_t> next(inOffsets.begin(), inOffsets.end() - 1);
+	for (size_t s = 0; s < rows.size(); ++s)
+		for (FileId target : rows[s])
+			inSources[next[target]++] = static_cast<FileId>(s);
+
+	offsets_.assign(n + 1, 0);
+	for (size_t s = 0; s < rows.size(); ++s)
+		offsets_[s + 1] = offsets_[s] + rows[s].size();
+	for (size_t s = rows.size(); s < n; ++s)
+		offsets_[s + 1] = offsets_[s];
+	rows.clear();
+	targets_.resize(offsets_[n]);
+	next.assign(offsets_.begin(), offsets_.end() - 1);
+	for (size_t t = 0; t < n; ++t)
+		for (size_t k = inOffsets[t]; k < inOffsets[t + 1]; ++k)
+			targets_[next[inSources[k]]++] = static_cast<FileId>(t);
+
+	//drop duplicates in place, rows only move toward the front
+	size_t out = 0;
+	for (size_t s = 0; s < n; ++s) {
+		size_t first = offsets_[s], last = offsets_[s + 1];
+		offsets_[s] = out;
+		for (size_t k = first; k < last; ++k)
+			if (k == first || targets_[k] != targets_[k - 1])
+				targets_[out++] = targets_[k];
 	}
+	offsets_[n] = out;
+	targets_.resize(out);
+	targets_.shrink_to_fit();
+}
+//----< replaces the graph with the dependencies named in table >------
+
+void DependencyGraph::build(const DependencyTable& table) {
+	clear();
+	for (auto& item : table)
+		intern(item.first);
+	std::vector<std::vector<FileId>> rows(table.size());
+	for (auto& item : table) {
+		std::vector<FileId>& row = rows[ids_[item.first]];
+		for (auto& target : item.second)
+			row.push_back(intern(target));
+	}
+	build(rows);
+}
+
+DependencyGraph::Range DependencyGraph::dependencies(FileId id) const {
+	Range range = { nullptr, nullptr };
+	if (static_cast<size_t>(id) + 1 < offsets_.size()) {
+		range.first = targets_.data() + offsets_[id];
+		range.last = targets_.data() + offsets_[id + 1];
+	}
+	return range;
+}
+
+bool DependencyGraph::dependsOn(FileId from, FileId to) const {
+	Range range = dependencies(from);
+	return std::binary_search(range.begin(), range.end(), to);
+}
+
+std::vector<std::string> DependencyGraph::dependencyNames(FileId id) const {
+	std::vector<std::string> result;
+	Range range = dependencies(id);
+	result.reserve(range.size());
+	for (FileId target : range)
+		result.push_back(names_[target]);
+	return result;
+}
+//----< one element per file with a row, its targets as children >-----
+
+void DependencyGraph::save(NoSqlDb<std::string>& db) const {
+	for (size_t s = 0; s < sources_; ++s) {
+		Element<std::string> elem;
+		elem.name = names_[s];
+		elem.children = dependencyNames(static_cast<FileId>(s));
+		db.save(names_[s], elem);
+	}
+}
+
+namespace {
+	inline bool isIdentChar(char ch) {
+		return (ch >= 'a' && ch <= 'z') || (ch >= 'A' && ch <= 'Z') || (ch >= '0' && ch <= '9') || ch == '_';
+	}
+}
+const unsigned TypeNameScanner::Dead;
+
+//----< name to find, only identifiers can be found as whole words >---
+
+void TypeNameScanner::add(const std::string& name, Value value) {
+	if (name.empty() || !std::all_of(name.begin(), name.end(), isIdentChar))
+		return;
+	words_.push_back(std::make_pair(name, value));
+}
+//----< builds the trie breadth first from the sorted names >----------
+/*
+*  Names sharing a prefix are adjacent once sorted, so each state's
+*  children are made at once and its edges are contiguous and sorted.
+*  The first value added for a name is the one reported.
+*/
+void TypeNameScanner::build() {
+	std::stable_sort(words_.begin(), words_.end(),
+		[](const std::pair<std::string, Value>& a, const std::pair<std::string, Value>& b) { return a.first < b.first; });
+	words_.erase(std::unique(words_.begin(), words_.end(),
+		[](const std::pair<std::string, Value>& a, const std::pair<std::string, Value>& b) { return a.first == b.first; }), words_.end());
+	names_ = words_.size();
+	Node empty = { 0, 0, 0, false };
+	nodes_.assign(1, empty);
+	edges_.clear();
+	struct Span { unsigned state; size_t lo, hi, depth; };
+	std::deque<Span> spans;
+	Span all = { 0, 0, words_.size(), 0 };
+	spans.push_back(all);
+	while (!spans.empty()) {
+		Span span = spans.front();
+		spans.pop_front();
+		size_t i = span.lo;
+		if (i < span.hi && words_[i].first.size() == span.depth) {
+			nodes_[span.state].terminal = true;
+			nodes_[span.state].value = words_[i].second;
+			++i;
+		}
+		nodes_[span.state].firstEdge = static_cast<unsigned>(edges_.size());
+		while (i < span.hi) {
+			char ch = words_[i].first[span.depth];
+			size_t j = i;
+			while (j < span.hi && words_[j].first[span.depth] == ch)
+				++j;
+			Edge edge = { ch, static_cast<unsigned>(nodes_.size()) };
+			edges_.push_back(edge);
+			nodes_.push_back(empty);
+			Span child = { edge.target, i, j, span.depth + 1 };
+			spans.push_back(child);
+			i = j;
+		}
+		nodes_[span.state].edgeCount = static_cast<unsigned>(edges_.size()) - nodes_[span.state].firstEdge;
+	}
+	rootNext_.assign(256, Dead);
+	for (unsigned e = 0; e < nodes_[0].edgeCount; ++e)
+		rootNext_[static_cast<unsigned char>(edges_[e].ch)] = edges_[e].target;
+	words_.clear();
+	words_.shrink_to_fit();
+}
+//----< transition on an identifier character, Dead if no name continues >---
 
+unsigned TypeNameScanner::next(unsigned state, char ch) const {
+	const Node& node = nodes_[state];
+	const Edge* first = edges_.data() + node.firstEdge;
+	const Edge* last = first + node.edgeCount;
+	if (node.edgeCount > 8)
+		first = std::lower_bound(first, last, ch, [](const Edge& edge, char c) { return edge.ch < c; });
+	for (; first != last; ++first)
+		if (first->ch == ch)
+			return first->target;
+	return Dead;
+}
+//----< position after a comment or literal starting at pos, pos if none >---
+/*
+*  The word just before pos, text[wordStart] up to text[wordEnd], tells raw
+*  strings, R"x(...)x", and digit separators, 1'000, from other quotes.
+*/
+size_t TypeNameScanner::skipLiteral(const char* text, size_t size, size_t pos, size_t wordStart, size_t wordEnd) const {
+	char ch = text[pos];
+	char after = pos + 1 < size ? text[pos + 1] : '\0';
+	if (ch == '/' && after == '/') {
+		const char* end = std::find(text + pos, text + size, '\n');
+		return end - text;
+	}
+	if (ch == '/' && after == '*') {
+		const char close[] = "*/";
+		const char* end = std::search(text + pos + 2, text + size, close, close + 2);
+		return end == text + size ? size : end - text + 2;
+	}
+	bool wordBefore = wordEnd == pos && wordEnd > wordStart;
+	if (ch == '\'' && wordBefore && text[wordStart] >= '0' && text[wordStart] <= '9')
+		return pos;
+	if (ch == '"' && wordBefore && text[wordEnd - 1] == 'R') {
+		std::string prefix(text + wordStart, wordEnd - wordStart);
+		if (prefix == "R" || prefix == "LR" || prefix == "uR" || prefix == "UR" || prefix == "u8R") {
+			const char* open = std::find(text + pos + 1, text + size, '(');
+			std::string close = ")" + std::string(text + pos + 1, open) + "\"";
+			if (open == text + size)
+				return size;
+			const char* end = std::search(open + 1, text + size, close.begin(), close.end());
+			return end == text + size ? size : end - text + close.size();
+		}
+	}
+	if (ch != '"' && ch != '\'')
+		return pos;
+	size_t i = pos + 1;
+	while (i < size && text[i] != ch && text[i] != '\n')
+		i += text[i] == '\\' ? 2 : 1;
+	return i < size ? i + 1 : size;
+}
+//----< appends the value of each known name found as a whole word >---
+
+size_t TypeNameScanner::scan(const char* text, size_t size, std::vector<Value>& found) const {
+	size_t matches = 0;
+	if (nodes_.empty())
+		return matches;
+	unsigned state = Dead;
+	size_t wordStart = 0, wordEnd = 0;
+	bool inWord = false;
+	size_t i = 0;
+	while (i <= size) {
+		char ch = i < size ? text[i] : ' ';
+		if (isIdentChar(ch)) {
+			if (!inWord) {
+				inWord = true;
+				wordStart = i;
+				state = rootNext_[static_cast<unsigned char>(ch)];
+			}
+			else if (state != Dead)
+				state = next(state, ch);
+			++i;
+			continue;
+		}
+		if (inWord) {
+			inWord = false;
+			wordEnd = i;
+			if (state != Dead && nodes_[state].terminal) {
+				found.push_back(nodes_[state].value);
+				++matches;
+			}
+		}
+		if (i == size)
+			break;
+		size_t skip = skipLiteral(text, size, i, wordStart, wordEnd);
+		i = skip > i ? skip : i + 1;
+	}
+	return matches;
+}
+
+//----< calls onToken for each token of file s, false if it can't be read >---
+/*
+*  - tokens cached by the parse pass are used when pCache holds the file
+*  - otherwise, with bufferInput the file is read with one call and scanned in memory
+*/
+template <typename OnToken>
+bool DependencyAnalysis::scanTokens(const std::string& s, bool bufferInput, const TokenCache* pCache, OnToken onToken) {
+	const TokenCache::Entry* pEntry = pCache ? pCache->find(s) : nullptr;
+	if (pEntry != nullptr) {
+		for (auto& tok : pEntry->tokens)
+			onToken(tok);
+		return true;
+	}
+	std::ifstream in;
 	Toker toker;
 	toker.returnComments();
-	toker.attach(&in);
-	std::vector<std::pair<std::string, std::string>> tempo;
+	bool attached;
+	if (bufferInput)
+		attached = toker.attachFile(s);
+	else {
+		in.open(s);
+		attached = toker.attach(&in);
+	}
+	if (!attached) {
+		std::cout << "\n  can't open " << s << "\n\n";
+		return false;
+	}
 	do {
-		std::string tok = toker.getTok();
-		for (auto it = tt.getTypeTable().begin(); it != tt.getTypeTable().end(); ++it) {
-			if (tok == it->first) {
-				tempo = it->second;
-				temp.push_back(tempo.begin()->second);
-			}} 
-	} while (in.good());
+		onToken(toker.getTok());
+	} while (toker.canRead());
+	return true;
+}
 
-	//code to ensure that same file is printed only onces
-	std::vector<std::string>::iterator temp2;
-	temp2 = (std::unique(temp.begin(), temp.end()));
-	temp.resize(distance(temp.begin(), temp2));
+//----< returns the packages file s depends on, using hashed type lookups >---
+
+std::vector<std::string> DependencyAnalysis::fileDependencies(const TypeTable& tt, const std::string& s, bool bufferInput, const TokenCache* pCache) {
+	std::vector<std::string> temp;
+	scanTokens(s, bufferInput, pCache, [&](const std::string& tok) {
+		//one hashed lookup per token instead of walking the whole type table
+		const TypeTable::TypeEntries* entries = tt.find(tok);
+		if (entries)
+			temp.push_back(entries->begin()->second);
+	});
+	//sorted first, std::unique only removes adjacent duplicates
+	std::sort(temp.begin(), temp.end());
+	temp.erase(std::unique(temp.begin(), temp.end()), temp.end());
+	return temp;
+}
+
+//----< builds dependency table entry for file s >---------------------
+
+std::unordered_map<std::string, std::vector<std::string>> DependencyAnalysis::DependencyAnalysistable(TypeTable& tt,std::string& s) {
+	std::string fileSpec = s;
+	std::vector<std::string> temp = fileDependencies(tt, fileSpec, bufferInput_, pCache_);
 
 	depResult.insert(std::make_pair(fileSpec, temp));
+	addElement = Element<std::string>();
 	addElement.name = fileSpec;
-
-	for (auto itr = temp.begin(); itr != temp.end(); ++itr) {
-		addElement.children.getValue().push_back(*itr);
-	}
+	addElement.children = temp;
 
 	dbInst.save(addElement.name, addElement);
 	/*for (auto iteration = depTable.begin(); iteration != depTable.end(); iteration++) {
@@ -56,6 +363,247 @@ std::unordered_map<std::string, std::vector<std::string>> DependencyAnalysis::De
 	return depResult;
 }
 
+//----< analyzes files on a pool of workers sharing a read-only type table >---
+/*
+*  - files and the file of each type get their ids before the workers start,
+*    so workers only read the id tables and push ids, not copies of names
+*  - workers claim files through an atomic index, so no lock is taken per file
+*  - each file's ids go to its own slot; after the workers are joined the slots
+*    and depResult's other entries become graph_, which fills depResult and dbInst
+*  - with content hashes, only the first file of each hash is scanned, files with
+*    the same text refer to the same types, so the others take its slot's ids
+*/
+DependencyAnalysis::DependencyTable DependencyAnalysis::parallelDependencyTable(const TypeTable& tt, const std::vector<std::string>& files, size_t nThreads) {
+	Utilities::MemoryProfile::Subsystem tag("dependencies");
+	if (nThreads == 0)
+		nThreads = std::thread::hardware_concurrency();
+	if (nThreads == 0)
+		nThreads = 1;
+	if (nThreads > files.size())
+		nThreads = files.size() > 0 ? files.size() : 1;
+
+	using FileId = DependencyGraph::FileId;
+	graph_.clear();
+	std::vector<FileId> fileIds;
+	for (auto& file : files)
+		fileIds.push_back(graph_.intern(file));
+	for (auto& item : depResult)
+		graph_.intern(item.first);
+	size_t sources = graph_.size();
+	std::unordered_map<std::string, FileId> typeIds;
+	TypeNameScanner scanner;
+	for (auto& item : tt.getTypeTable()) {
+		if (item.second.empty())
+			continue;
+		typeIds[item.first] = graph_.intern(item.second.begin()->second);
+		if (scanTypeNames_)
+			scanner.add(item.first, typeIds[item.first]);
+	}
+	if (scanTypeNames_)
+		scanner.build();
+
+	std::vector<size_t> scanned, sameAs(files.size());
+	std::unordered_map<std::string, size_t> firstOf;
+	for (size_t index = 0; index < files.size(); ++index) {
+		auto hash = pHashes_ ? pHashes_->find(TokenCache::key(files[index])) : ContentHashes::const_iterator();
+		sameAs[index] = index;
+		if (pHashes_ && hash != pHashes_->end() && hash->second != "") {
+			auto first = firstOf.emplace(hash->second, index);
+			sameAs[index] = first.first->second;
+		}
+		if (sameAs[index] == index)
+			scanned.push_back(index);
+	}
+
+	std::atomic<size_t> next(0);
+	std::vector<std::vector<FileId>> found(files.size());
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < nThreads; ++i) {
+		workers.push_back(std::thread([&]() {
+			size_t claimed, index;
+			Utilities::Trace::instance().nameThread("dependency scan");
+			Utilities::MemoryProfile::Subsystem tag("dependencies");
+			while ((claimed = next++) < scanned.size()) {
+				index = scanned[claimed];
+				Utilities::Trace::Span span("file", "dependency scan", files[index]);
+				std::vector<FileId>& ids = found[index];
+				if (scanTypeNames_) {
+					const TokenCache::Entry* pEntry = pCache_ ? pCache_->find(files[index]) : nullptr;
+					std::string text;
+					if (pEntry == nullptr && !Toker::readFile(files[index], text)) {
+						std::cout << "\n  can't open " << files[index] << "\n\n";
+						continue;
+					}
+					const std::string& source = pEntry ? pEntry->source : text;
+					scanner.scan(source.data(), source.size(), ids);
+					continue;
+				}
+				scanTokens(files[index], bufferInput_, pCache_, [&](const std::string& tok) {
+					auto iter = typeIds.find(tok);
+					if (iter != typeIds.end())
+						ids.push_back(iter->second);
+				});
+			}
+		}));
+	}
+	for (auto& worker : workers)
+		worker.join();
+	for (size_t index = 0; index < files.size(); ++index) {
+		if (sameAs[index] != index)
+			found[index] = found[sameAs[index]];
+	}
+
+	std::vector<std::vector<FileId>> rows(sources);
+	for (auto& item : depResult) {
+		FileId id;
+		graph_.find(item.first, id);
+		for (auto& target : item.second)
+			rows[id].push_back(graph_.intern(target));
+	}
+	for (size_t index = 0; index < files.size(); ++index)
+		rows[fileIds[index]] = std::move(found[index]);
+	graph_.build(rows);
+	for (size_t index = 0; index < files.size(); ++index)
+		depResult[files[index]] = graph_.dependencyNames(fileIds[index]);
+	Utilities::MemoryProfile::Subsystem db("NoSqlDb");
+	graph_.save(dbInst);
+	return depResult;
+}
+
+//----< appends the names in quotes of file text's #include lines >----
+/*
+*  - one pass over the text, no line is copied: blanks may come before and
+*    after the '#', and <system> headers are skipped, they aren't published
+*  - a directive inside a block comment or a false #if is still reported, the
+*    quick pass gives way to the type based table in any case
+*/
+void DependencyAnalysis::includeNames(const std::string& text, std::vector<std::string>& names) {
+	const char* p = text.data();
+	const char* end = p + text.size();
+	while (p < end) {
+		while (p < end && (*p == ' ' || *p == '\t'))
+			++p;
+		if (p < end && *p == '#') {
+			++p;
+			while (p < end && (*p == ' ' || *p == '\t'))
+				++p;
+			if (end - p > 7 && std::equal(p, p + 7, "include")) {
+				p += 7;
+				while (p < end && (*p == ' ' || *p == '\t'))
+					++p;
+				if (p < end && *p == '"') {
+					const char* first = ++p;
+					while (p < end && *p != '"' && *p != '\n')
+						++p;
+					if (p < end && *p == '"' && p > first)
+						names.push_back(std::string(first, p));
+				}
+			}
+		}
+		p = std::find(p, end, '\n');
+		if (p < end)
+			++p;
+	}
+}
+
+namespace {
+	//lexical form of a path for comparisons: '/' separators, lower case, "." and ".." folded
+	std::string comparablePath(const std::string& spec) {
+		std::vector<std::string> parts;
+		std::string part;
+		for (size_t i = 0; i <= spec.size(); ++i) {
+			char ch = (i < spec.size()) ? spec[i] : '/';
+			if (ch != '/' && ch != '\\') {
+				part += (char)tolower((unsigned char)ch);
+				continue;
+			}
+			if (part == "..") {
+				if (!parts.empty() && parts.back() != "..")
+					parts.pop_back();
+				else
+					parts.push_back(part);
+			}
+			else if (part != "." && (part != "" || parts.empty()))
+				parts.push_back(part);
+			part.clear();
+		}
+		std::string path;
+		for (size_t i = 0; i < parts.size(); ++i)
+			path += (i > 0 ? "/" : "") + parts[i];
+		return path;
+	}
+}
+
+//----< include edges between files, read on a pool of workers, into dbInst >---
+/*
+*  - an include is resolved against the directory of the file holding it and
+*    kept only if it names one of files, as type dependencies name only files
+*    the type table holds
+*  - each file's element is saved, or updated if dbInst has it, but depResult
+*    and graph() are left for parallelDependencyTable
+*/
+DependencyAnalysis::DependencyTable DependencyAnalysis::includeTable(const std::vector<std::string>& files, size_t nThreads) {
+	Utilities::MemoryProfile::Subsystem tag("dependencies");
+	if (nThreads == 0)
+		nThreads = std::thread::hardware_concurrency();
+	if (nThreads == 0)
+		nThreads = 1;
+	if (nThreads > files.size())
+		nThreads = files.size() > 0 ? files.size() : 1;
+
+	std::unordered_map<std::string, size_t> indexOf;
+	for (size_t index = 0; index < files.size(); ++index)
+		indexOf.emplace(comparablePath(files[index]), index);
+
+	std::atomic<size_t> next(0);
+	std::vector<std::vector<size_t>> found(files.size());
+	std::vector<std::thread> workers;
+	for (size_t i = 0; i < nThreads; ++i) {
+		workers.push_back(std::thread([&]() {
+			size_t index;
+			Utilities::Trace::instance().nameThread("include scan");
+			Utilities::MemoryProfile::Subsystem tag("dependencies");
+			std::string text;
+			std::vector<std::string> names;
+			while ((index = next++) < files.size()) {
+				Utilities::Trace::Span span("file", "include scan", files[index]);
+				if (!Toker::readFile(files[index], text)) {
+					std::cout << "\n  can't open " << files[index] << "\n\n";
+					continue;
+				}
+				names.clear();
+				includeNames(text, names);
+				const std::string& file = files[index];
+				size_t dirEnd = file.find_last_of("/\\");
+				std::string dir = (dirEnd == std::string::npos) ? "" : file.substr(0, dirEnd + 1);
+				for (auto& name : names) {
+					auto iter = indexOf.find(comparablePath(dir + name));
+					if (iter != indexOf.end() && iter->second != index)
+						found[index].push_back(iter->second);
+				}
+				std::sort(found[index].begin(), found[index].end());
+				found[index].erase(std::unique(found[index].begin(), found[index].end()), found[index].end());
+			}
+		}));
+	}
+	for (auto& worker : workers)
+		worker.join();
+
+	DependencyTable table;
+	Utilities::MemoryProfile::Subsystem db("NoSqlDb");
+	for (size_t index = 0; index < files.size(); ++index) {
+		std::vector<std::string>& targets = table[files[index]];
+		for (size_t target : found[index])
+			targets.push_back(files[target]);
+		Element<std::string> elem;
+		elem.name = files[index];
+		elem.children = targets;
+		if (!dbInst.save(files[index], elem))
+			dbInst.Update(files[index], elem);
+	}
+	return table;
+}
+
 //void displayXml(NoSqlDb<std::string> dbInst) {
 //	std::string s = toXml(dbInst);
 //	std::cout << s;
@@ -119,4 +667,178 @@ int main() {
 	da.DependencyAnalysisTable(TypeTable& tt, std::string& s);
 }
 
-#endif
\ No newline at end of file
+#endif
+
+#ifdef TEST_DEPENDENCYGRAPH
+
+//----< test stub, duplicates that aren't adjacent are removed >-------
+
+int main() {
+	DependencyGraph::DependencyTable table;
+	table["Executive.cpp"] = { "Parser.h", "Tokenizer.h", "Parser.h", "Logger.h", "Tokenizer.h" };
+	table["Parser.cpp"] = { "Tokenizer.h", "Tokenizer.h" };
+	table["Tokenizer.cpp"] = {};
+	DependencyGraph graph;
+	graph.build(table);
+	std::cout << "\n  " << graph.size() << " files, " << graph.edgeCount() << " edges";
+	for (auto& item : table) {
+		DependencyGraph::FileId id;
+		graph.find(item.first, id);
+		std::cout << "\n  " << std::setw(16) << std::left << item.first << ":";
+		for (auto& dep : graph.dependencyNames(id))
+			std::cout << " " << dep;
+	}
+	DependencyGraph::FileId from, to;
+	graph.find("Executive.cpp", from);
+	graph.find("Logger.h", to);
+	std::cout << "\n  Executive.cpp depends on Logger.h: " << std::boolalpha << graph.dependsOn(from, to);
+	NoSqlDb<std::string> db;
+	graph.save(db);
+	std::cout << "\n  " << db.count() << " elements saved\n\n";
+}
+
+#endif
+
+#ifdef TEST_DEPENDENCYBENCH
+
+//////////////////////////////////////////////////////////////////////
+// Benchmark for the dependency phase
+// - seeds a type table with every class/struct name found in the
+//   TestFiles corpus, then runs the old full-table scan and the new
+//   hashed lookup over the same files
+// - reports tokens/sec and total dependency-phase time for both
+// - then runs the Toker and TypeNameScanner paths of parallelDependencyTable
+//   on one thread, after padding the table with extra synthetic types, and
+//   counts files whose dependencies the two paths disagree on
+
+#include <chrono>
+#include "../FileSystem/FileSystem.h"
+
+using Clock = std::chrono::high_resolution_clock;
+
+//----< collect class and struct names into the type table >---------
+
+size_t seedTypeTable(TypeTable& tt, const std::vector<std::string>& files)
+{
+	size_t tokens = 0;
+	for (auto file : files) {
+		std::ifstream in(file);
+		Toker toker;
+		toker.attach(&in);
+		std::string prev;
+		do {
+			std::string tok = toker.getTok();
+			++tokens;
+			if (prev == "class" || prev == "struct")
+				tt.add(tok, prev, file);
+			prev = tok;
+		} while (in.good());
+	}
+	return tokens;
+}
+
+//----< dependency pass using the pre-1.1 linear scan >----------------
+
+void linearPass(TypeTable& tt, const std::vector<std::string>& files)
+{
+	for (auto file : files) {
+		std::vector<std::string> temp;
+		std::ifstream in(file);
+		Toker toker;
+		toker.returnComments();
+		toker.attach(&in);
+		do {
+			std::string tok = toker.getTok();
+			for (auto it = tt.getTypeTable().begin(); it != tt.getTypeTable().end(); ++it) {
+				if (tok == it->first)
+					temp.push_back(it->second.begin()->second);
+			}
+		} while (in.good());
+	}
+}
+
+void report(const std::string& label, size_t tokens, double secs)
+{
+	std::cout << "\n  " << std::setw(10) << std::left << label
+		<< std::setw(12) << std::right << std::fixed << std::setprecision(3) << secs * 1000.0 << " ms"
+		<< std::setw(14) << (size_t)(tokens / (secs > 0 ? secs : 1e-9)) << " tokens/sec";
+}
+
+int main(int argc, char* argv[]) {
+	std::string path = argc > 1 ? argv[1] : "../TestFiles";
+	int reps = argc > 2 ? atoi(argv[2]) : 10;
+	size_t extraTypes = argc > 3 ? (size_t)atoi(argv[3]) : 20000;
+	std::vector<std::string> files;
+	for (auto pattern : { "*.h", "*.cpp" })
+		for (auto name : FileSystem::Directory::getFiles(path, pattern))
+			files.push_back(FileSystem::Path::fileSpec(path, name));
+
+	TypeTable tt;
+	size_t tokens = seedTypeTable(tt, files) * reps;
+	std::cout << "\n  " << files.size() << " files, " << tt.getTypeTable().size() << " types, " << reps << " reps";
+
+	auto start = Clock::now();
+	for (int i = 0; i < reps; ++i)
+		linearPass(tt, files);
+	std::chrono::duration<double> linear = Clock::now() - start;
+
+	start = Clock::now();
+	for (int i = 0; i < reps; ++i) {
+		DependencyAnalysis da;
+		da.bufferInput(false);
+		for (auto file : files)
+			da.DependencyAnalysistable(tt, file);
+	}
+	std::chrono::duration<double> hashed = Clock::now() - start;
+
+	start = Clock::now();
+	for (int i = 0; i < reps; ++i) {
+		DependencyAnalysis da;
+		for (auto file : files)
+			da.DependencyAnalysistable(tt, file);
+	}
+	std::chrono::duration<double> buffered = Clock::now() - start;
+
+	start = Clock::now();
+	for (int i = 0; i < reps; ++i) {
+		DependencyAnalysis da;
+		da.parallelDependencyTable(tt, files);
+	}
+	std::chrono::duration<double> parallel = Clock::now() - start;
+
+	report("linear", tokens, linear.count());
+	report("hashed", tokens, hashed.count());
+	report("buffered", tokens, buffered.count());
+	report("parallel", tokens, parallel.count());
+
+	//names no file uses, so the results don't change but the table grows
+	for (size_t i = 0; i < extraTypes; ++i)
+		tt.add("Synthetic" + std::to_string(i * 7919) + "Type", "class", "Synthetic.h");
+	std::cout << "\n\n  " << tt.getTypeTable().size() << " types, one thread";
+
+	DependencyAnalysis::DependencyTable tokerResult, scanResult;
+	start = Clock::now();
+	for (int i = 0; i < reps; ++i) {
+		DependencyAnalysis da;
+		tokerResult = da.parallelDependencyTable(tt, files, 1);
+	}
+	std::chrono::duration<double> tokerPath = Clock::now() - start;
+
+	start = Clock::now();
+	for (int i = 0; i < reps; ++i) {
+		DependencyAnalysis da;
+		da.scanTypeNames(true);
+		scanResult = da.parallelDependencyTable(tt, files, 1);
+	}
+	std::chrono::duration<double> scanPath = Clock::now() - start;
+
+	size_t differ = 0;
+	for (auto& item : tokerResult)
+		if (scanResult[item.first] != item.second)
+			++differ;
+	report("toker", tokens, tokerPath.count());
+	report("automaton", tokens, scanPath.count());
+	std::cout << "\n  files with different dependencies: " << differ << "\n\n";
+}
+
+#endif
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////////////////////
 // DependencyAnalysis.h:  Provides necessary declarations to create a dependency table //
-// ver 1.0                                                                             //
+// ver 1.10                                                                            //
 // Application: Type Based Dependency Analysis, Spring 2017                            //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015                                //
 // Author:      Chandra Harsha Jupalli, OOD Project2                                   //
@@ -17,10 +17,37 @@
 * Public Interface
 * --------------------
 *  void DependencyAnalysistable(TypeTable& tt,std::string& s);                      //Function  to create Dependency Table
+*  std::vector<std::string> fileDependencies(const TypeTable& tt, const std::string& s, bool bufferInput = true,
+*                                            const TokenCache* pCache = nullptr)
+*                                                                                   //dependencies of one file, touches no shared state
+*  void bufferInput(bool doBuffer)                                                  //read each file into one buffer (default) or through a stream
+*  void useTokenCache(const TokenCache* pCache)                                     //take tokens of files the parser cached instead of re-reading
+*  void scanTypeNames(bool doScan)                                                  //find type names with a TypeNameScanner instead of a Toker
+*  void useContentHashes(const ContentHashes* pHashes)                              //scan files with the same content hash once
+*  DependencyTable parallelDependencyTable(const TypeTable& tt, const std::vector<std::string>& files, size_t nThreads = 0)
+*                                                                                   //analyzes files on a worker pool and merges the results
+*  const DependencyGraph& graph()                                                   //graph of the table parallelDependencyTable built
+*  DependencyTable includeTable(const std::vector<std::string>& files, size_t nThreads = 0)
+*                                                                                   //files' quoted #include edges, saved to dbInst, without a type table
+*  static void includeNames(const std::string& text, std::vector<std::string>& names)
+*                                                                                   //appends names in quotes of text's #include lines
 *  NoSqlDb<std::string>& getDataBase()                                              //Function to return a database instance
 *  NoSqlDb<std::string> dbInst;                                                     //Using a DataBase Instance  in NoSqlDB
 *  Element<std::string> addElement;                                                 //Using an Element Class Instance in NoSqlDb
 *
+*  DependencyGraph::FileId intern(const std::string& file)                          //dense id of file name, added if new
+*  bool find(const std::string& file, FileId& id) const                             //id of a file name already interned
+*  const std::string& name(FileId id) const                                         //file name of an id
+*  void build(std::vector<std::vector<FileId>>& rows)                              //rows[i] are targets of file i, stored sorted and unique
+*  void build(const DependencyTable& table)                                         //same, from a table of file names
+*  Range dependencies(FileId id) const                                              //sorted targets of file id
+*  bool dependsOn(FileId from, FileId to) const                                     //binary search of from's targets
+*  void save(NoSqlDb<std::string>& db) const                                        //one element per file, targets as children
+*
+*  void TypeNameScanner::add(const std::string& name, Value value)                  //name to find, value reported for it
+*  void TypeNameScanner::build()                                                    //makes the automaton, call after the last add
+*  size_t TypeNameScanner::scan(text, size, found)                                  //appends values of names found as whole words
+*
 *
 * Required Files:
 * ---------------
@@ -32,6 +59,46 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.10 : 14 Oct 2026
+* - added includeTable and includeNames: a line scan of quoted #include directives,
+*   resolved against the including file's directory, gives a repository's include
+*   edges, saved to dbInst, before any file is parsed or a type table is built
+* Ver 1.9 : 14 Oct 2026
+* - parallelDependencyTable counts its allocations as the dependencies subsystem's,
+*   and those saving the graph to NoSqlDb as NoSqlDb's, in MemoryProfile
+* Ver 1.8 : 14 Oct 2026
+* - parallelDependencyTable's workers record a Trace span per file scanned
+* Ver 1.7 : 14 Oct 2026
+* - added useContentHashes: parallelDependencyTable scans one file of each content
+*   hash and gives its type references to the others, e.g., copies in other branches
+* Ver 1.6 : 14 Oct 2026
+* - added TypeNameScanner, an automaton over the type table's names that scans a
+*   file's text once, skipping comments and literals, and reports whole words;
+*   scanTypeNames(true) makes parallelDependencyTable use it instead of a Toker
+* - TEST_DEPENDENCYBENCH compares the automaton with the Toker path, optionally
+*   with extra synthetic types, and counts files whose dependencies differ
+* Ver 1.5 : 14 Oct 2026
+* - dependency lists are sorted before duplicates are removed, std::unique alone
+*   left duplicates that weren't adjacent; each file's element starts empty
+* - added DependencyGraph: file names interned once as dense ids, the edges of the
+*   whole repository in one offsets array and one sorted, unique targets array
+* - parallelDependencyTable's workers map tokens to file ids, not name copies,
+*   and the merged graph is kept for graph() and saved to dbInst
+* Ver 1.4 : 14 Oct 2026
+* - files tokenized by the parse pass are taken from a Scanner::TokenCache, set
+*   with useTokenCache, instead of being read and tokenized a second time
+* Ver 1.3 : 14 Oct 2026
+* - files are tokenized from one buffer read with Toker::attachFile, bufferInput(false)
+*   selects stream input; TEST_DEPENDENCYBENCH reports both
+* Ver 1.2 : 14 Oct 2026
+* - added parallelDependencyTable, a worker pool sized to the hardware that
+*   shares a read-only TypeTable; each worker fills its own table and the
+*   tables are merged into depResult and dbInst once per worker
+* Ver 1.1 : 14 Oct 2026
+* - DependencyAnalysistable uses TypeTable::find, one hashed lookup per
+*   token instead of a scan of the whole type table
+* - added TEST_DEPENDENCYBENCH stub reporting tokens/sec and phase time
+*   for the old and new lookup over the TestFiles corpus
 * Ver 1.0 : 11 March 2017
 * - first release
 *
@@ -52,13 +119,101 @@
 #include "../HelpSession/NoSqlDb/NoSqlDb.h"
 
 using namespace Scanner;
+
+/////////////////////////////////////////////////////////////////////
+// DependencyGraph - dependencies of every file in compressed rows
+// - each file name is stored once, edges hold its dense FileId
+// - targets of file i are targets_[offsets_[i]] up to
+//   targets_[offsets_[i+1]], sorted and unique, so a repository's
+//   graph is two flat arrays that are walked front to back
+
+class DependencyGraph {
+public:
+	using FileId = unsigned;
+	using DependencyTable = std::unordered_map<std::string, std::vector<std::string>>;
+	struct Range {
+		const FileId* first;
+		const FileId* last;
+		const FileId* begin() const { return first; }
+		const FileId* end() const { return last; }
+		size_t size() const { return last - first; }
+	};
+	FileId intern(const std::string& file);
+	bool find(const std::string& file, FileId& id) const;
+	const std::string& name(FileId id) const { return names_[id]; }
+	size_t size() const { return names_.size(); }
+	size_t edgeCount() const { return targets_.size(); }
+	void build(std::vector<std::vector<FileId>>& rows);
+	void build(const DependencyTable& table);
+	Range dependencies(FileId id) const;
+	bool dependsOn(FileId from, FileId to) const;
+	std::vector<std::string> dependencyNames(FileId id) const;
+	void save(NoSqlDb<std::string>& db) const;
+	void clear();
+private:
+	std::vector<std::string> names_;
+	std::unordered_map<std::string, FileId> ids_;
+	std::vector<size_t> offsets_;   // size() + 1 entries once built
+	std::vector<FileId> targets_;
+	size_t sources_ = 0;            // files 0 up to sources_ have rows
+};
+
+/////////////////////////////////////////////////////////////////////
+// TypeNameScanner - finds known type names in source text, in one pass
+// - an Aho-Corasick automaton anchored at word boundaries: a match must
+//   start and end a C++ identifier, so every failure link leads back to
+//   the root and is replaced by waiting for the next identifier
+// - states are a trie in breadth first order; the root's transitions
+//   are a 256 entry table, the others a sorted edge array per state
+// - comments and string and character literals are skipped whole, as
+//   the Toker returns them as single tokens that never name a type
+
+class TypeNameScanner {
+public:
+	using Value = unsigned;
+	void add(const std::string& name, Value value);
+	void build();
+	size_t scan(const char* text, size_t size, std::vector<Value>& found) const;
+	size_t size() const { return names_; }
+	size_t states() const { return nodes_.size(); }
+private:
+	struct Node {
+		unsigned firstEdge;
+		unsigned edgeCount;
+		Value value;
+		bool terminal;
+	};
+	struct Edge {
+		char ch;
+		unsigned target;
+	};
+	static const unsigned Dead = ~0u;   // inside a word that no name starts
+	unsigned next(unsigned state, char ch) const;
+	size_t skipLiteral(const char* text, size_t size, size_t pos, size_t wordStart, size_t wordEnd) const;
+	std::vector<std::pair<std::string, Value>> words_;   // added, until build
+	std::vector<Node> nodes_;
+	std::vector<Edge> edges_;
+	std::vector<unsigned> rootNext_;
+	size_t names_ = 0;
+};
+
 class DependencyAnalysis{
 public:
 	DependencyAnalysis() {
 	}
-	using DependencyTable = std::unordered_map<std::string, std::vector<std::string>>;
+	using DependencyTable = DependencyGraph::DependencyTable;
 	DependencyTable depResult;
 	std::unordered_map<std::string, std::vector<std::string>> DependencyAnalysistable(TypeTable& tt,std::string& s);
+	static std::vector<std::string> fileDependencies(const TypeTable& tt, const std::string& s, bool bufferInput = true, const TokenCache* pCache = nullptr);
+	DependencyTable parallelDependencyTable(const TypeTable& tt, const std::vector<std::string>& files, size_t nThreads = 0);
+	DependencyTable includeTable(const std::vector<std::string>& files, size_t nThreads = 0);
+	static void includeNames(const std::string& text, std::vector<std::string>& names);
+	void bufferInput(bool doBuffer = true) { bufferInput_ = doBuffer; }
+	void useTokenCache(const TokenCache* pCache) { pCache_ = pCache; }
+	void scanTypeNames(bool doScan = true) { scanTypeNames_ = doScan; }
+	using ContentHashes = std::unordered_map<std::string, std::string>;   // TokenCache::key of file, hash of its text
+	void useContentHashes(const ContentHashes* pHashes) { pHashes_ = pHashes; }
+	const DependencyGraph& graph() const { return graph_; }
 	
 	//std::unordered_map<std::string, std::vector<std::string>>& getMap() { return depResult; }
 	
@@ -69,5 +224,13 @@ public:
 	};
 	
 	~DependencyAnalysis(){}
+private:
+	template <typename OnToken>
+	static bool scanTokens(const std::string& s, bool bufferInput, const TokenCache* pCache, OnToken onToken);
+	bool bufferInput_ = true;
+	bool scanTypeNames_ = false;
+	const TokenCache* pCache_ = nullptr;
+	const ContentHashes* pHashes_ = nullptr;
+	DependencyGraph graph_;
 
 };
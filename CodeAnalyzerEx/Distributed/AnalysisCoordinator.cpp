@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////
+// AnalysisCoordinator.cpp - Shards an analysis across worker nodes      //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "AnalysisCoordinator.h"
+#include "ShardProtocol.h"
+#include "../Analyzer/Executive.h"
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <queue>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <iostream>
+
+using Clock = std::chrono::steady_clock;
+
+AnalysisCoordinator::AnalysisCoordinator(const Settings& settings) : settings_(settings) {}
+
+//----< "host:port,host:port", a missing host is localhost >---------
+
+std::vector<AnalysisCoordinator::Worker> AnalysisCoordinator::parseWorkers(const std::string& list)
+{
+	std::vector<Worker> workers;
+	std::istringstream in(list);
+	std::string item;
+	while (std::getline(in, item, ','))
+	{
+		size_t colon = item.find_last_of(':');
+		if (item.empty() || colon == std::string::npos)
+			continue;
+		Worker worker;
+		if (colon > 0)
+			worker.host = item.substr(0, colon);
+		try {
+			worker.port = std::stoul(item.substr(colon + 1));
+		}
+		catch (std::exception&) {
+			continue;
+		}
+		workers.push_back(worker);
+	}
+	return workers;
+}
+//----< largest first, each to the part with the fewest bytes so far >--
+/*
+ * - each part's indexes are sorted, so a shard is parsed in listing order
+ */
+std::vector<std::vector<size_t>> AnalysisCoordinator::partition(const std::vector<unsigned long long>& sizes, size_t parts)
+{
+	std::vector<std::vector<size_t>> result((std::max)(parts, (size_t)1));
+	std::vector<size_t> order(sizes.size());
+	for (size_t i = 0; i < order.size(); ++i)
+		order[i] = i;
+	std::stable_sort(order.begin(), order.end(), [&sizes](size_t a, size_t b) { return sizes[a] > sizes[b]; });
+	using Load = std::pair<unsigned long long, size_t>;   // bytes, part
+	std::priority_queue<Load, std::vector<Load>, std::greater<Load>> loads;
+	for (size_t part = 0; part < result.size(); ++part)
+		loads.push(Load(0, part));
+	for (size_t index : order)
+	{
+		Load least = loads.top();
+		loads.pop();
+		result[least.second].push_back(index);
+		least.first += (std::max)(sizes[index], 1ULL);
+		loads.push(least);
+	}
+	for (auto& part : result)
+		std::sort(part.begin(), part.end());
+	return result;
+}
+//----< the files the patterns match, relative to root, with sizes >--
+
+bool AnalysisCoordinator::listFiles(std::vector<unsigned long long>& sizes)
+{
+	std::vector<std::string> args = { "DistAnalyzer", settings_.root };
+	args.insert(args.end(), settings_.patterns.begin(), settings_.patterns.end());
+	std::vector<char*> argv;
+	for (auto& arg : args)
+		argv.push_back(&arg[0]);
+	argv.push_back(nullptr);
+	CodeAnalysis::CodeAnalysisExecutive exec;
+	if (!exec.ProcessCommandLine(static_cast<int>(args.size()), argv.data()))
+		return false;
+	exec.getSourceFiles();
+	std::map<std::string, unsigned long long> listed;   // sorted, so runs partition alike
+	for (auto& item : exec.getFileMap())
+	{
+		for (auto& file : item.second)
+		{
+			const FileManager::FileInventory::Item* pItem = exec.inventory().find(file);
+			listed[ShardProtocol::relative(settings_.root, file)] = pItem ? pItem->size : 0;
+		}
+	}
+	files_.clear();
+	sizes.clear();
+	for (auto& item : listed)
+	{
+		files_.push_back(item.first);
+		sizes.push_back(item.second);
+	}
+	return true;
+}
+//----< connect to each worker, a shard for each one that accepts >--
+
+size_t AnalysisCoordinator::connect()
+{
+	shards_.clear();
+	connections_.clear();
+	for (auto& worker : settings_.workers)
+	{
+		std::unique_ptr<SocketConnecter> pConnection(new SocketConnecter);
+		size_t waited = 0, delay = 10;
+		bool connected = true;
+		while (!pConnection->connect(worker.host, worker.port))
+		{
+			if (waited >= settings_.connectMs)
+			{
+				connected = false;
+				break;
+			}
+			std::this_thread::sleep_for(std::chrono::milliseconds(delay));
+			waited += delay;
+			delay = (std::min)(2 * delay, (size_t)500);
+		}
+		if (!connected)
+		{
+			std::cout << "\n  can't reach worker " << worker.host << ":" << worker.port << ", leaving it out";
+			continue;
+		}
+		Shard shard;
+		shard.worker = worker;
+		shards_.push_back(shard);
+		connections_.push_back(std::move(pConnection));
+	}
+	tables_.assign(shards_.size(), TypeTable());
+	summaries_.assign(shards_.size(), std::string());
+	return shards_.size();
+}
+//----< is reply the step expected? if not, why, for the shard table >--
+
+bool AnalysisCoordinator::expect(const HttpMessage& reply, const std::string& step, Shard& shard) const
+{
+	std::string got = ShardProtocol::step(reply);
+	if (got == step)
+		return true;
+	if (reply.attributes().size() == 0)
+		shard.error = "connection closed";
+	else if (got == "failed")
+		shard.error = reply.bodyString();
+	else
+		shard.error = "expected " + step + ", got \"" + got + "\"";
+	return false;
+}
+//----< have the shard's worker parse it, keep its types and summary >--
+
+bool AnalysisCoordinator::parseShard(size_t i)
+{
+	Shard& shard = shards_[i];
+	Socket& socket = *connections_[i];
+	auto start = Clock::now();
+	std::string patterns;
+	for (auto& pattern : settings_.patterns)
+		patterns += (patterns.empty() ? "" : " ") + pattern;
+	HttpMessage msg = ShardProtocol::message("parse", ShardProtocol::sourceLines(shard.files));
+	msg.addAttribute(HttpMessage::Attribute("patterns", patterns));
+	if (!ShardProtocol::send(msg, socket))
+	{
+		shard.error = "can't send the shard";
+		return false;
+	}
+	HttpMessage types = ShardProtocol::read(socket);
+	if (!expect(types, "types", shard))
+		return false;
+	HttpMessage summary = ShardProtocol::read(socket);
+	if (!expect(summary, "summary", shard))
+		return false;
+	std::istringstream in(types.bodyString());
+	tables_[i].load(in);
+	for (auto& file : tables_[i].files())
+		shard.types += tables_[i].inFile(file).size();
+	summaries_[i] = summary.bodyString();
+	shard.parseMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	return true;
+}
+//----< have the shard's worker publish it, collect deps and pages >--
+
+bool AnalysisCoordinator::analyzeShard(size_t i, const std::string& body)
+{
+	Shard& shard = shards_[i];
+	Socket& socket = *connections_[i];
+	auto start = Clock::now();
+	HttpMessage msg = ShardProtocol::message("analyze", body);
+	if (!ShardProtocol::send(msg, socket))
+	{
+		shard.error = "can't send the global types";
+		return false;
+	}
+	while (true)
+	{
+		HttpMessage reply = ShardProtocol::read(socket);
+		std::string step = ShardProtocol::step(reply);
+		if (step == "done")
+			break;
+		if (step == "page")
+		{
+			if (receivePage(reply))
+				++shard.pages;
+			continue;
+		}
+		if (!expect(reply, "deps", shard))
+			return false;
+		std::istringstream lines(reply.bodyString());
+		std::string line;
+		std::lock_guard<std::mutex> lock(mutex_);
+		while (std::getline(lines, line))
+			dependencies_[line.substr(0, line.find('\t'))] = line;
+	}
+	shard.analyzeMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+	return true;
+}
+//----< write a page a worker sent under root, assets only once >----
+/*
+ * - names that climb out of the root are refused
+ */
+bool AnalysisCoordinator::receivePage(const HttpMessage& msg)
+{
+	std::string file = msg.findValue("file");
+	if (file.empty() || file.find("..") != std::string::npos || file.find(':') != std::string::npos)
+		return false;
+	std::string ext = FileSystem::Path::getExt(file);
+	if (ext != "html")
+	{
+		std::lock_guard<std::mutex> lock(mutex_);
+		if (!assets_.insert(file).second)
+			return true;
+	}
+	return ShardProtocol::writeFile(ShardProtocol::under(settings_.root, file), msg.bodyString());
+}
+//----< ast.summary, every shard's summary, and the run's totals >--
+
+bool AnalysisCoordinator::writeSummary()
+{
+	totals_ = Totals();
+	std::ofstream out(settings_.root + "/ast.summary");
+	for (auto& summary : summaries_)
+	{
+		out << summary;
+		std::istringstream lines(summary);
+		std::string kind, type;
+		while (lines >> kind)
+		{
+			if (kind == "file")
+			{
+				size_t count = 0;
+				lines >> count;
+				++totals_.files;
+				totals_.lines += count;
+			}
+			else if (kind == "scope")
+			{
+				size_t first = 0, last = 0, complexity = 0;
+				lines >> type >> first >> last >> complexity;
+				if (type == "function")
+				{
+					++totals_.functions;
+					if (complexity > totals_.maxComplexity)
+					{
+						totals_.maxComplexity = complexity;
+						lines >> std::ws;
+						std::getline(lines, totals_.mostComplex);
+						continue;
+					}
+				}
+			}
+			std::getline(lines, type);   // rest of the line, a name may hold spaces
+		}
+	}
+	for (auto& file : global_.files())
+		totals_.types += global_.inFile(file).size();
+	return out.good();
+}
+
+bool AnalysisCoordinator::writeDependencies() const
+{
+	std::ofstream out(settings_.root + "/dependencies.index");
+	for (auto& item : dependencies_)
+		out << item.second << "\n";
+	return out.good();
+}
+
+void AnalysisCoordinator::quit()
+{
+	for (auto& pConnection : connections_)
+	{
+		HttpMessage msg = ShardProtocol::message("quit");
+		ShardProtocol::send(msg, *pConnection);
+		pConnection->shutDown();
+		pConnection->close();
+	}
+}
+//----< list, partition, parse on every worker, merge, then publish >--
+
+bool AnalysisCoordinator::run()
+{
+	auto start = Clock::now();
+	std::vector<unsigned long long> sizes;
+	if (!listFiles(sizes))
+		return false;
+	if (connect() == 0)
+	{
+		std::cout << "\n  no worker could be reached\n";
+		return false;
+	}
+	std::vector<std::vector<size_t>> parts = partition(sizes, shards_.size());
+	for (size_t i = 0; i < shards_.size(); ++i)
+	{
+		for (size_t index : parts[i])
+		{
+			shards_[i].files.push_back(files_[index]);
+			shards_[i].bytes += sizes[index];
+		}
+	}
+	std::cout << "\n  " << files_.size() << " files in " << shards_.size() << " shards";
+
+	auto onEveryShard = [this](const std::function<bool(size_t)>& step) {
+		std::vector<char> ok(shards_.size(), 0);
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < shards_.size(); ++i)
+			threads.push_back(std::thread([&step, &ok, i]() { ok[i] = step(i) ? 1 : 0; }));
+		for (auto& thread : threads)
+			thread.join();
+		return std::find(ok.begin(), ok.end(), 0) == ok.end();
+	};
+	if (!onEveryShard([this](size_t i) { return parseShard(i); }))
+	{
+		quit();
+		return false;
+	}
+	global_.clear();
+	for (auto& table : tables_)
+		global_.merge(table);
+	global_.save(settings_.root + "/types.index");
+	writeSummary();
+	std::ostringstream body;
+	body << ShardProtocol::sourceLines(files_);
+	global_.save(body);
+	std::string globalBody = body.str();
+	bool published = onEveryShard([this, &globalBody](size_t i) { return analyzeShard(i, globalBody); });
+	writeDependencies();
+	quit();
+	double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+	std::cout << "\n  " << (published ? "published" : "failed to publish") << " in " << std::fixed << std::setprecision(2)
+		<< seconds << " s";
+	return published;
+}
+
+std::string AnalysisCoordinator::table() const
+{
+	std::ostringstream out;
+	out << std::fixed << std::setprecision(1);
+	out << "\n  " << std::left << std::setw(24) << "worker" << std::right << std::setw(8) << "files" << std::setw(10) << "KB"
+		<< std::setw(8) << "types" << std::setw(8) << "pages" << std::setw(11) << "parse ms" << std::setw(12) << "publish ms" << "  status";
+	for (auto& s : shards_)
+	{
+		std::string name = s.worker.host + ":" + std::to_string(s.worker.port);
+		out << "\n  " << std::left << std::setw(24) << name << std::right << std::setw(8) << s.files.size()
+			<< std::setw(10) << s.bytes / 1024.0 << std::setw(8) << s.types << std::setw(8) << s.pages
+			<< std::setw(11) << s.parseMs << std::setw(12) << s.analyzeMs << "  " << (s.error.empty() ? "ok" : s.error);
+	}
+	out << "\n\n  " << totals_.files << " files, " << totals_.lines << " lines, " << totals_.types << " types, "
+		<< totals_.functions << " functions";
+	if (!totals_.mostComplex.empty())
+		out << ", most complex " << totals_.mostComplex << " (" << totals_.maxComplexity << ")";
+	return out.str();
+}
+
+#ifdef TEST_ANALYSISCOORDINATOR
+
+int main()
+{
+	std::vector<unsigned long long> sizes = { 90, 10, 40, 40, 30, 20 };
+	std::vector<std::vector<size_t>> parts = AnalysisCoordinator::partition(sizes, 2);
+	for (size_t part = 0; part < parts.size(); ++part)
+	{
+		unsigned long long bytes = 0;
+		for (size_t index : parts[part])
+			bytes += sizes[index];
+		std::cout << "\n  part " << part << ": " << parts[part].size() << " files, " << bytes << " bytes";
+	}
+	SocketSystem ss;
+	AnalysisCoordinator::Settings settings;
+	settings.patterns = { "*.h", "*.cpp" };
+	settings.workers = AnalysisCoordinator::parseWorkers("localhost:9080");
+	AnalysisCoordinator coordinator(settings);
+	coordinator.run();
+	std::cout << coordinator.table() << "\n\n";
+}
+#endif
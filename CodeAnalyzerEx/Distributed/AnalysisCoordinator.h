@@ -0,0 +1,142 @@
+#ifndef ANALYSISCOORDINATOR_H
+#define ANALYSISCOORDINATOR_H
+///////////////////////////////////////////////////////////////////////////
+// AnalysisCoordinator.h - Shards an analysis across worker nodes        //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* AnalysisCoordinator analyzes and publishes a repository on several
+* AnalysisWorkers, each a node with a checkout of the repository at a
+* root of its own:
+*
+* - the tree is listed with the patterns, as the analyzer does, and its
+*   files partitioned among the workers that could be reached, largest
+*   first, each to the worker given the fewest bytes so far
+* - every worker parses its shard at once and sends back the shard's
+*   TypeTable and a summary of its AST
+* - the tables are merged into the global type table, saved as types.index
+*   under the root, and the summaries written to ast.summary
+* - every worker is sent the global table, which names the types of every
+*   shard, and publishes its shard and finds its dependencies with it, so
+*   links and dependencies cross shards as in a single node run
+* - the pages, and their directories' CSS/JS, come back over the same
+*   connection and are written under the root, beside the sources, where
+*   the single node analyzer writes them; dependencies.index holds a line
+*   of dependencies per file
+*
+* A worker that can't be reached in connectMs is left out of the
+* partition.  A shard that fails, e.g., its worker drops, fails the run,
+* and the shard table shows which worker and why.
+*
+* Public Interface
+* --------------------
+* AnalysisCoordinator::Settings settings;
+* settings.root = "../Repository";
+* settings.patterns = { "*.h", "*.cpp" };
+* settings.workers = AnalysisCoordinator::parseWorkers("nodeA:9080,nodeB:9080");
+* AnalysisCoordinator coordinator(settings);
+* bool ok = coordinator.run();                          //needs a SocketSystem
+* std::string table = coordinator.table();              //each shard's files, times and pages
+* auto parts = AnalysisCoordinator::partition(sizes, 4);  //indexes of sizes, by part
+*
+* Required Files:
+* ---------------
+*   AnalysisCoordinator.h, AnalysisCoordinator.cpp, ShardProtocol.h, ShardProtocol.cpp
+*   Executive.h, Executive.cpp, TypeAnalysis.h, TypeAnalysis.cpp, and the files
+*   the analyzer needs
+*   HttpMessage.h, HttpMessage.cpp, Sockets.h, Sockets.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../Sockets/Sockets.h"
+#include "../HttpMessage/HttpMessage.h"
+#include "../Analyzer/TypeAnalysis.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <mutex>
+#include <memory>
+
+class AnalysisCoordinator
+{
+public:
+	struct Worker
+	{
+		std::string host = "localhost";
+		size_t port = 9080;
+	};
+	struct Settings
+	{
+		std::string root = "../Repository";
+		std::vector<std::string> patterns;
+		std::vector<Worker> workers;
+		size_t connectMs = 5000;     // longest wait for each worker to accept
+	};
+	struct Shard
+	{
+		Worker worker;
+		std::vector<std::string> files;   // relative to root
+		unsigned long long bytes = 0;
+		size_t types = 0;
+		size_t pages = 0;            // pages and assets received
+		double parseMs = 0;
+		double analyzeMs = 0;
+		std::string error;           // empty unless the shard failed
+	};
+	struct Totals
+	{
+		size_t files = 0;
+		size_t lines = 0;
+		size_t types = 0;
+		size_t functions = 0;
+		size_t maxComplexity = 0;
+		std::string mostComplex;     // function with maxComplexity
+	};
+
+	AnalysisCoordinator(const Settings& settings);
+	bool run();
+	const std::vector<Shard>& shards() const { return shards_; }
+	const Totals& totals() const { return totals_; }
+	std::string table() const;
+	static std::vector<Worker> parseWorkers(const std::string& list);
+	static std::vector<std::vector<size_t>> partition(const std::vector<unsigned long long>& sizes, size_t parts);
+private:
+	bool listFiles(std::vector<unsigned long long>& sizes);
+	size_t connect();
+	bool parseShard(size_t i);
+	bool analyzeShard(size_t i, const std::string& body);
+	bool expect(const HttpMessage& reply, const std::string& step, Shard& shard) const;
+	bool receivePage(const HttpMessage& msg);
+	bool writeSummary();
+	bool writeDependencies() const;
+	void quit();
+
+	Settings settings_;
+	std::vector<std::string> files_;
+	std::vector<Shard> shards_;
+	std::vector<std::unique_ptr<SocketConnecter>> connections_;   // by shard
+	std::vector<TypeTable> tables_;                               // by shard
+	std::vector<std::string> summaries_;                          // by shard
+	TypeTable global_;
+	Totals totals_;
+	std::mutex mutex_;                                // guards what shards report at once
+	std::map<std::string, std::string> dependencies_; // deps line by file
+	std::set<std::string> assets_;                    // CSS/JS written, each once
+};
+
+#endif
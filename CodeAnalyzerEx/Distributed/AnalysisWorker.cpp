@@ -0,0 +1,122 @@
+///////////////////////////////////////////////////////////////////////////
+// AnalysisWorker.cpp - Parses and publishes a coordinator's shard       //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "AnalysisWorker.h"
+#include "ShardProtocol.h"
+#include "ShardAnalysis.h"
+#include "../Logger/Logger.h"
+#include "../Utilities/Utilities.h"
+#include <sstream>
+#include <iostream>
+
+using Show = Logging::StaticLogger<1>;
+using namespace Utilities;
+
+AnalysisWorker::AnalysisWorker(const std::string& root) : root_(root) {}
+
+//----< one coordinator's session, parse then analyze, until quit >--
+
+void AnalysisWorker::operator()(Socket socket)
+{
+	ShardAnalysis session(root_);
+	while (true)
+	{
+		HttpMessage msg = ShardProtocol::read(socket);
+		std::string step = msg.attributes().size() > 0 ? ShardProtocol::step(msg) : "quit";
+		if (step == "quit")
+			break;
+		bool ok = false;
+		if (step == "parse")
+			ok = parse(session, msg, socket);
+		else if (step == "analyze")
+			ok = analyze(session, msg, socket);
+		else
+			ok = fail("unknown step \"" + step + "\"", socket);
+		if (!ok)
+			break;
+	}
+	Show::write("\n  coordinator's session is done");
+}
+//----< parse the body's files, answer with their types and summary >--
+/*
+ * - a shard the worker can't parse is answered with failed, and the
+ *   connection kept, so the coordinator can report why and send quit
+ */
+bool AnalysisWorker::parse(ShardAnalysis& session, HttpMessage& msg, Socket& socket)
+{
+	std::string rest, error;
+	std::vector<std::string> files = ShardProtocol::sources(msg.bodyString(), rest);
+	std::vector<std::string> patterns;
+	std::istringstream in(msg.findValue("patterns"));
+	std::string pattern;
+	while (in >> pattern)
+		patterns.push_back(pattern);
+	std::cout << "\n  parsing a shard of " << files.size() << " files";
+	if (!session.parse(files, patterns, error))
+		return fail(error, socket);
+	HttpMessage types = ShardProtocol::message("types", session.types());
+	HttpMessage summary = ShardProtocol::message("summary", session.summary());
+	return ShardProtocol::send(types, socket) && ShardProtocol::send(summary, socket);
+}
+//----< publish with the body's global types, send deps and then pages >--
+
+bool AnalysisWorker::analyze(ShardAnalysis& session, HttpMessage& msg, Socket& socket)
+{
+	std::string globalTypes, error;
+	std::vector<std::string> all = ShardProtocol::sources(msg.bodyString(), globalTypes);
+	std::cout << "\n  publishing the shard, " << all.size() << " files in the run";
+	if (!session.analyze(all, globalTypes, error))
+		return fail(error, socket);
+	HttpMessage deps = ShardProtocol::message("deps", session.dependencies());
+	if (!ShardProtocol::send(deps, socket))
+		return false;
+	size_t sent = 0;
+	for (auto& page : session.pages())
+	{
+		if (sendPage(page, socket))
+			++sent;
+	}
+	HttpMessage done = ShardProtocol::message("done");
+	done.addAttribute(HttpMessage::Attribute("pages", Converter<size_t>::toString(sent)));
+	std::cout << "\n  sent " << sent << " pages and assets";
+	return ShardProtocol::send(done, socket);
+}
+//----< a page, named relative to root, with its bytes as the body >--
+/*
+ * - a page that can't be read, e.g., an asset a directory didn't need,
+ *   is skipped, the coordinator counts the pages it received
+ */
+bool AnalysisWorker::sendPage(const std::string& page, Socket& socket) const
+{
+	std::string bytes;
+	if (!ShardProtocol::readFile(ShardProtocol::under(root_, page), bytes))
+		return false;
+	HttpMessage msg = ShardProtocol::message("page", bytes);
+	msg.addAttribute(HttpMessage::Attribute("file", page));
+	return ShardProtocol::send(msg, socket);
+}
+
+bool AnalysisWorker::fail(const std::string& reason, Socket& socket) const
+{
+	std::cout << "\n  can't analyze the shard: " << reason;
+	HttpMessage msg = ShardProtocol::message("failed", reason);
+	return ShardProtocol::send(msg, socket);
+}
+
+#ifdef TEST_ANALYSISWORKER
+
+int main()
+{
+	SocketSystem ss;
+	AnalysisWorker worker("../Repository");
+	SocketListener sl(9080, Socket::IP6);
+	sl.usePool(1);
+	sl.start(worker);
+	std::cout << "\n  worker listening on 9080, press enter to stop\n";
+	std::cin.get();
+}
+#endif
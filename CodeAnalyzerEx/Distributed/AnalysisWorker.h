@@ -0,0 +1,73 @@
+#ifndef ANALYSISWORKER_H
+#define ANALYSISWORKER_H
+///////////////////////////////////////////////////////////////////////////
+// AnalysisWorker.h - Parses and publishes a coordinator's shard         //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* AnalysisWorker is the callable object a SocketListener runs for each
+* coordinator that connects.  The worker holds a checkout of the
+* repository at its root; a session, one connection, analyzes the shard
+* of it the coordinator names with a ShardAnalysis, in two steps:
+*
+* - parse: the shard's files are parsed, and its TypeTable and a summary
+*   of the scopes and metrics of its AST are sent back.
+* - analyze: with the global type table, every worker's merged, the
+*   shard's pages are published and their dependencies found.  The
+*   dependencies, then each page, and the CSS/JS of the pages'
+*   directories, are sent back.
+*
+* The ShardAnalysis, and its AST, is kept between the steps, for the
+* session.  Sessions run one at a time, see DistAnalyzer, since the
+* analyzer's loggers and publishing are process wide.
+*
+* Public Interface
+* --------------------
+* AnalysisWorker worker("../Repository");
+* SocketListener sl(9080, Socket::IP6);
+* sl.usePool(1);                        //one coordinator's session at a time
+* sl.start(worker);
+*
+* Required Files:
+* ---------------
+*   AnalysisWorker.h, AnalysisWorker.cpp, ShardProtocol.h, ShardProtocol.cpp
+*   ShardAnalysis.h, ShardAnalysis.cpp, and the files the analyzer needs
+*   HttpMessage.h, HttpMessage.cpp, Sockets.h, Sockets.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../Sockets/Sockets.h"
+#include "../HttpMessage/HttpMessage.h"
+#include <string>
+
+class ShardAnalysis;
+
+class AnalysisWorker
+{
+public:
+	AnalysisWorker(const std::string& root);
+	void operator()(Socket socket);
+private:
+	bool parse(ShardAnalysis& session, HttpMessage& msg, Socket& socket);
+	bool analyze(ShardAnalysis& session, HttpMessage& msg, Socket& socket);
+	bool sendPage(const std::string& page, Socket& socket) const;
+	bool fail(const std::string& reason, Socket& socket) const;
+
+	std::string root_;
+};
+
+#endif
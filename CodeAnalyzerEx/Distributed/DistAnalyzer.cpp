@@ -0,0 +1,123 @@
+///////////////////////////////////////////////////////////////////////////
+// DistAnalyzer.cpp - Runs a distributed analysis coordinator or worker  //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* DistAnalyzer.exe analyzes and publishes a repository on several nodes,
+* each holding a checkout of it.  Start a worker on each node, then the
+* coordinator on one of them, or on a node of its own, with the workers'
+* addresses.  The coordinator's patterns name the files, as the analyzer's
+* do, and its root is where the published pages are collected.
+*
+* Command line:
+* -------------
+* DistAnalyzer worker <root> [/port:9080]
+* DistAnalyzer coordinator <root> <patterns> /workers:host:port,host:port [/connect:5000]
+* - e.g. DistAnalyzer coordinator ../Repository *.h *.cpp /workers:nodeA:9080,nodeB:9080
+* - /connect is how long, in ms, to wait for each worker to accept
+*
+* Required Files:
+* ---------------
+*   DistAnalyzer.cpp, AnalysisCoordinator.h, AnalysisCoordinator.cpp
+*   AnalysisWorker.h, AnalysisWorker.cpp, ShardAnalysis.h, ShardAnalysis.cpp
+*   ShardProtocol.h, ShardProtocol.cpp, and the files the analyzer needs
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "AnalysisCoordinator.h"
+#include "AnalysisWorker.h"
+#include <iostream>
+#include <string>
+#include <vector>
+
+void showUsage()
+{
+	std::cout << "\n  Usage: DistAnalyzer worker <root> [/port:9080]";
+	std::cout << "\n         DistAnalyzer coordinator <root> <patterns> /workers:host:port,host:port [/connect:5000]";
+	std::cout << "\n  - worker: analyze the shards a coordinator sends, of the checkout at root";
+	std::cout << "\n  - coordinator: partition the files at root among the workers, merge their";
+	std::cout << "\n    type tables, and collect the pages they publish under root\n\n";
+}
+//----< value of "/name:value" among args, otherwise if it's missing >--
+
+std::string option(const std::vector<std::string>& args, const std::string& name, const std::string& otherwise)
+{
+	std::string prefix = "/" + name + ":";
+	for (auto& arg : args)
+	{
+		if (arg.compare(0, prefix.size(), prefix) == 0)
+			return arg.substr(prefix.size());
+	}
+	return otherwise;
+}
+
+int runWorker(const std::vector<std::string>& args)
+{
+	size_t port = std::stoul(option(args, "port", "9080"));
+	AnalysisWorker worker(args[2]);
+	SocketListener sl(port, Socket::IP6);
+	sl.usePool(1);   // one session at a time, the analyzer's loggers and publisher are process wide
+	if (!sl.start(worker))
+	{
+		std::cout << "\n  can't listen on port " << port << "\n\n";
+		return 1;
+	}
+	std::cout << "\n  worker for \"" << args[2] << "\" listening on port " << port << ", press enter to stop\n";
+	std::cin.get();
+	sl.stop();
+	return 0;
+}
+
+int runCoordinator(const std::vector<std::string>& args)
+{
+	AnalysisCoordinator::Settings settings;
+	settings.root = args[2];
+	for (size_t i = 3; i < args.size(); ++i)
+	{
+		if (args[i].size() > 0 && args[i][0] != '/')
+			settings.patterns.push_back(args[i]);
+	}
+	settings.workers = AnalysisCoordinator::parseWorkers(option(args, "workers", ""));
+	settings.connectMs = std::stoul(option(args, "connect", "5000"));
+	if (settings.patterns.empty() || settings.workers.empty())
+	{
+		showUsage();
+		return 1;
+	}
+	AnalysisCoordinator coordinator(settings);
+	bool ok = coordinator.run();
+	std::cout << coordinator.table() << "\n\n";
+	return ok ? 0 : 1;
+}
+
+int main(int argc, char* argv[])
+{
+	std::vector<std::string> args(argv, argv + argc);
+	std::string mode = argc > 1 ? args[1] : "";
+	if (argc < 3 || (mode != "worker" && mode != "coordinator"))
+	{
+		showUsage();
+		return 1;
+	}
+	try {
+		SocketSystem ss;
+		return mode == "worker" ? runWorker(args) : runCoordinator(args);
+	}
+	catch (std::exception& except) {
+		std::cout << "\n  " << except.what() << "\n\n";
+		return 1;
+	}
+}
@@ -0,0 +1,186 @@
+///////////////////////////////////////////////////////////////////////////
+// ShardAnalysis.cpp - Analyzes one worker's shard of a repository       //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "ShardAnalysis.h"
+#include "ShardProtocol.h"
+#include "../Analyzer/Executive.h"
+#include "../Analyzer/DepAnal.h"
+#include <set>
+#include <map>
+#include <sstream>
+#include <exception>
+
+using namespace CodeAnalysis;
+
+struct ShardAnalysis::Analysis
+{
+	CodeAnalysisExecutive exec;
+	std::unique_ptr<TypeAnal> pTypes;   // refers to exec's Repository, declared after it so released first
+};
+
+ShardAnalysis::ShardAnalysis(const std::string& root) : root_(root) {}
+
+ShardAnalysis::~ShardAnalysis() {}
+
+//----< parse the files, named relative to root, and build their types >--
+/*
+ * - the executive lists the whole tree, so the inventory it shares with
+ *   TypeAnal and the publisher is the one a single node run would have
+ */
+bool ShardAnalysis::parse(const std::vector<std::string>& files, const std::vector<std::string>& patterns, std::string& error)
+{
+	pAnalysis_.reset(new Analysis);
+	shard_.clear();
+	std::vector<std::string> args = { "DistAnalyzer", root_ };
+	args.insert(args.end(), patterns.begin(), patterns.end());
+	std::vector<char*> argv;
+	for (auto& arg : args)
+		argv.push_back(&arg[0]);
+	argv.push_back(nullptr);
+	CodeAnalysisExecutive& exec = pAnalysis_->exec;
+	try {
+		if (!exec.ProcessCommandLine(static_cast<int>(args.size()), argv.data()))
+		{
+			error = "can't analyze \"" + root_ + "\" with the patterns given";
+			return false;
+		}
+		exec.getSourceFiles();
+		std::set<std::string> wanted;
+		for (auto& file : files)
+			wanted.insert(FileSystem::Path::toLower(ShardProtocol::under(root_, file)));
+		exec.keepFiles([&wanted](const std::string& file) {
+			return wanted.count(FileSystem::Path::toLower(FileSystem::Path::getFullFileSpec(file))) > 0;
+		});
+		for (auto& item : exec.getFileMap())
+			shard_.insert(shard_.end(), item.second.begin(), item.second.end());
+		exec.processSourceCodeParallel(false);
+		exec.complexityAnalysis();
+		pAnalysis_->pTypes.reset(new TypeAnal(*exec.repository()));
+		TypeAnal& ta = *pAnalysis_->pTypes;
+		ta.setTokenCache(&exec.tokenCache());
+		ta.setContentHashes(&exec.contentHashes());
+		ta.setInventory(&exec.inventory());
+		ta.buildTypes();
+	}
+	catch (std::exception& except) {
+		error = except.what();
+		return false;
+	}
+	return true;
+}
+
+std::string ShardAnalysis::types() const
+{
+	std::ostringstream out;
+	if (pAnalysis_ && pAnalysis_->pTypes)
+		pAnalysis_->pTypes->typeTable().save(out);
+	return out.str();
+}
+//----< lines of each file, then its types and functions, see ShardProtocol.h >--
+
+std::string ShardAnalysis::summary() const
+{
+	if (!pAnalysis_ || pAnalysis_->exec.repository() == nullptr)
+		return "";
+	std::map<std::string, std::vector<ASTNode*>> scopes;   // by file, so summaries are repeatable
+	ASTNode* pRoot = pAnalysis_->exec.repository()->AST().root();
+	if (pRoot != nullptr)
+	{
+		ASTWalkNoIndent(pRoot, [&scopes](ASTNode* pNode) {
+			if (pNode->path_.str().empty())
+				return;
+			if (pNode->type_ == classType || pNode->type_ == structType || pNode->type_ == interfaceType || pNode->type_ == functionType)
+				scopes[FileSystem::Path::getFullFileSpec(pNode->path_.str())].push_back(pNode);
+		});
+	}
+	std::ostringstream out;
+	for (auto& file : shard_)
+	{
+		std::string full = FileSystem::Path::getFullFileSpec(file);
+		out << "file " << pAnalysis_->exec.fileSLOCs(FileSystem::Path::getName(file)) << " " << ShardProtocol::relative(root_, file) << "\n";
+		auto iter = scopes.find(full);
+		if (iter == scopes.end())
+			continue;
+		for (ASTNode* pNode : iter->second)
+			out << "scope " << typeName(pNode->type_) << " " << pNode->startLineCount_ << " " << pNode->endLineCount_
+				<< " " << pNode->complexity_ << " " << pNode->name_ << "\n";
+	}
+	return out.str();
+}
+//----< publish the shard and find its dependencies with the global types >--
+/*
+ * - all names every file of the run, relative to root, so types parsed
+ *   on other workers are anchored to their files' pages
+ * - pages lists each page written and, once, each of their directories'
+ *   CSS and JS, for the worker to send back
+ */
+bool ShardAnalysis::analyze(const std::vector<std::string>& all, const std::string& globalTypes, std::string& error)
+{
+	if (!pAnalysis_ || !pAnalysis_->pTypes)
+	{
+		error = "no shard parsed";
+		return false;
+	}
+	dependencies_.clear();
+	pages_.clear();
+	TypeTable global;
+	std::istringstream in(globalTypes);
+	global.load(in);
+	std::vector<std::string> files;
+	for (auto& file : all)
+		files.push_back(ShardProtocol::under(root_, file));
+	TypeAnal& ta = *pAnalysis_->pTypes;
+	std::unordered_map<std::string, std::vector<std::string>> deps;
+	try {
+		deps = ta.analyzeShard(root_, shard_, files, global);
+	}
+	catch (std::exception& except) {
+		error = except.what();
+		return false;
+	}
+	std::set<std::string> directories;
+	for (auto& file : shard_)
+	{
+		if (!ta.publishes(file))
+			continue;
+		std::string rel = ShardProtocol::relative(root_, file);
+		pages_.push_back(rel + ".html");
+		std::string line = rel;
+		for (auto& dep : deps[file])
+			line += "\t" + dep;
+		dependencies_ += line + "\n";
+		size_t slash = rel.find_last_of('/');
+		directories.insert(slash == std::string::npos ? "" : rel.substr(0, slash + 1));
+	}
+	for (auto& directory : directories)
+	{
+		pages_.push_back(directory + "cssStyleFile.css");
+		pages_.push_back(directory + "ScopeHandler.Js");
+	}
+	return true;
+}
+
+#ifdef TEST_SHARDANALYSIS
+
+#include <iostream>
+
+int main()
+{
+	ShardAnalysis shard("../TestFiles");
+	std::string error;
+	if (!shard.parse({ "TypeAnalysis.h", "TypeAnalysis.cpp" }, { "*.h", "*.cpp" }, error))
+	{
+		std::cout << "\n  parse failed: " << error << "\n\n";
+		return 1;
+	}
+	std::cout << "\n  types:\n" << shard.types() << "\n  summary:\n" << shard.summary();
+	//files directly under the root aren't published, as with the analyzer, so no pages are expected
+	if (!shard.analyze({ "TypeAnalysis.h", "TypeAnalysis.cpp" }, shard.types(), error))
+		std::cout << "\n  analyze failed: " << error;
+	std::cout << "\n  dependencies:\n" << shard.dependencies() << "\n  " << shard.pages().size() << " pages and assets\n\n";
+}
+#endif
@@ -0,0 +1,81 @@
+#ifndef SHARDANALYSIS_H
+#define SHARDANALYSIS_H
+///////////////////////////////////////////////////////////////////////////
+// ShardAnalysis.h - Analyzes one worker's shard of a repository         //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* ShardAnalysis runs the analyzer's phases on part of a repository, the
+* files a distributed coordinator gave one worker, named relative to the
+* repository's root:
+*
+* - parse: a CodeAnalysisExecutive lists the tree with the patterns, as
+*   the analyzer does, then keepFiles leaves the shard's files, which are
+*   parsed on all cores and their complexities found.  TypeAnal builds the
+*   shard's type table from the AST.
+* - analyze: given every file of the run and the type table merged from
+*   all workers, TypeAnal::analyzeShard publishes the shard's pages beside
+*   its sources and finds their dependencies.
+*
+* The executive, its AST, and the TypeAnal are held from parse to analyze.
+* Neither step uses sockets, so this package is compiled apart from them:
+* DepAnal.h needs all of windows.h, Sockets.h the lean part before winsock2.
+*
+* Public Interface
+* --------------------
+* ShardAnalysis shard("../Repository");
+* bool ok = shard.parse(files, { "*.h", "*.cpp" }, error);
+* std::string types = shard.types();           //as TypeTable::save writes it
+* std::string summary = shard.summary();       //see ShardProtocol.h
+* ok = shard.analyze(allFiles, globalTypes, error);
+* std::string deps = shard.dependencies();     //a tab separated line per file
+* std::vector<std::string> pages = shard.pages();  //pages and assets written
+*
+* Required Files:
+* ---------------
+*   ShardAnalysis.h, ShardAnalysis.cpp, ShardProtocol.h, ShardProtocol.cpp
+*   Executive.h, Executive.cpp, DepAnal.h, TypeAnalysis.h, TypeAnalysis.cpp
+*   and the files the analyzer needs
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <vector>
+#include <memory>
+
+class ShardAnalysis
+{
+public:
+	ShardAnalysis(const std::string& root);
+	~ShardAnalysis();
+	bool parse(const std::vector<std::string>& files, const std::vector<std::string>& patterns, std::string& error);
+	std::string types() const;
+	std::string summary() const;
+	bool analyze(const std::vector<std::string>& all, const std::string& globalTypes, std::string& error);
+	std::string dependencies() const { return dependencies_; }
+	std::vector<std::string> pages() const { return pages_; }
+	const std::string& root() const { return root_; }
+private:
+	struct Analysis;
+	std::unique_ptr<Analysis> pAnalysis_;
+	std::string root_;
+	std::vector<std::string> shard_;    // full file specs, as the executive lists them
+	std::string dependencies_;
+	std::vector<std::string> pages_;    // relative to root
+};
+
+#endif
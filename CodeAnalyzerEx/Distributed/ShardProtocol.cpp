@@ -0,0 +1,160 @@
+///////////////////////////////////////////////////////////////////////////
+// ShardProtocol.cpp - Messages coordinator and workers exchange         //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "../Sockets/Sockets.h"
+#include "ShardProtocol.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Utilities/Utilities.h"
+#include <fstream>
+#include <sstream>
+
+using namespace Utilities;
+
+//----< a step's message, with its body's content-length >-----------
+
+HttpMessage ShardProtocol::message(const std::string& step, const std::string& body)
+{
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("SHARD", step));
+	if (body.size() > 0)
+	{
+		msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+		msg.addBody(body);
+	}
+	return msg;
+}
+
+bool ShardProtocol::send(HttpMessage& msg, Socket& socket)
+{
+	std::string head;
+	return socket.sendBuffers(msg.toBuffers(head));
+}
+//----< header lines, then content-length bytes of body >------------
+/*
+ * - a message with no attributes means the peer closed the connection
+ *   or the body couldn't be read
+ */
+HttpMessage ShardProtocol::read(Socket& socket)
+{
+	HttpMessage msg;
+	while (true)
+	{
+		std::string attribString = socket.recvString('\n');
+		if (attribString.size() <= 1)
+			break;
+		msg.addAttribute(HttpMessage::parseAttribute(attribString));
+	}
+	std::string sizeString = msg.findValue("content-length");
+	if (msg.attributes().size() > 0 && sizeString != "")
+	{
+		size_t numBytes = Converter<size_t>::toValue(sizeString);
+		HttpMessage::Body& body = msg.body();
+		body.resize(numBytes);
+		if (numBytes > 0 && !socket.recv(numBytes, &body[0]))
+			return HttpMessage();
+	}
+	return msg;
+}
+
+std::string ShardProtocol::step(const HttpMessage& msg)
+{
+	return msg.findValue("SHARD");
+}
+//----< fileSpec below root as "Dir/File.h", fileSpec if it isn't >---
+
+std::string ShardProtocol::relative(const std::string& root, const std::string& fileSpec)
+{
+	std::string full = FileSystem::Path::getFullFileSpec(fileSpec);
+	std::string base = FileSystem::Path::getFullFileSpec(root);
+	std::string rel = full;
+	if (full.size() > base.size() && FileSystem::Path::toLower(full.substr(0, base.size())) == FileSystem::Path::toLower(base))
+		rel = full.substr(base.size());
+	size_t first = rel.find_first_not_of("\\/");
+	rel = (first == std::string::npos) ? "" : rel.substr(first);
+	for (auto& ch : rel)
+	{
+		if (ch == '\\')
+			ch = '/';
+	}
+	return rel;
+}
+
+std::string ShardProtocol::under(const std::string& root, const std::string& relative)
+{
+	return FileSystem::Path::getFullFileSpec(root + "/" + relative);
+}
+//----< "source <file>" lines of a parse or analyze body >-----------
+
+std::string ShardProtocol::sourceLines(const std::vector<std::string>& files)
+{
+	std::string body;
+	for (auto& file : files)
+		body += "source " + file + "\n";
+	return body;
+}
+//----< files of the body's source lines, the lines after them in rest >--
+
+std::vector<std::string> ShardProtocol::sources(const std::string& body, std::string& rest)
+{
+	std::vector<std::string> files;
+	size_t pos = 0;
+	while (pos < body.size() && body.compare(pos, 7, "source ") == 0)
+	{
+		size_t end = body.find('\n', pos);
+		if (end == std::string::npos)
+			end = body.size();
+		files.push_back(body.substr(pos + 7, end - pos - 7));
+		pos = end + 1;
+	}
+	rest = pos < body.size() ? body.substr(pos) : "";
+	return files;
+}
+
+bool ShardProtocol::readFile(const std::string& fileSpec, std::string& bytes)
+{
+	std::ifstream in(fileSpec, std::ios::binary);
+	if (!in.good())
+		return false;
+	std::ostringstream out;
+	out << in.rdbuf();
+	bytes = out.str();
+	return true;
+}
+//----< write bytes to fileSpec, making its directories if need be >--
+
+bool ShardProtocol::writeFile(const std::string& fileSpec, const std::string& bytes)
+{
+	std::string path = FileSystem::Path::getPath(fileSpec);
+	std::vector<std::string> missing;
+	while (path.size() > 3 && !FileSystem::Directory::exists(path))
+	{
+		missing.push_back(path);
+		path = FileSystem::Path::getPath(path.substr(0, path.size() - 1));
+	}
+	for (size_t i = missing.size(); i > 0; --i)
+		FileSystem::Directory::create(missing[i - 1]);
+	std::ofstream out(fileSpec, std::ios::binary | std::ios::trunc);
+	out.write(bytes.data(), bytes.size());
+	return out.good();
+}
+
+#ifdef TEST_SHARDPROTOCOL
+
+#include <iostream>
+
+int main()
+{
+	std::string root = "../TestFiles";
+	std::string rel = ShardProtocol::relative(root, root + "/Dir/File.h");
+	std::cout << "\n  relative: " << rel << ", under: " << ShardProtocol::under(root, rel);
+	std::string rest;
+	std::vector<std::string> files = ShardProtocol::sources(ShardProtocol::sourceLines({ "A/a.h", "B/b.cpp" }) + "file a.h\n", rest);
+	std::cout << "\n  " << files.size() << " sources, then: " << rest;
+	HttpMessage msg = ShardProtocol::message("parse", ShardProtocol::sourceLines(files));
+	std::cout << "\n" << msg.toIndentedString() << "\n\n";
+}
+#endif
@@ -0,0 +1,88 @@
+#ifndef SHARDPROTOCOL_H
+#define SHARDPROTOCOL_H
+///////////////////////////////////////////////////////////////////////////
+// ShardProtocol.h - Messages coordinator and workers exchange           //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* A distributed analysis is a conversation of HttpMessages, text framed,
+* each with a "SHARD" attribute naming its step and, if it has one, a
+* content-length body:
+*
+*   coordinator                          worker
+*   SHARD: parse, patterns   -------->   parses the files of the body
+*                            <--------   SHARD: types, its TypeTable
+*                            <--------   SHARD: summary, its AST summary
+*   SHARD: analyze           -------->   publishes and analyzes its files
+*                            <--------   SHARD: deps, a line per file
+*                            <--------   SHARD: page, file, one per page
+*                            <--------   SHARD: done, pages
+*   SHARD: quit              -------->
+*
+* A worker that can't do a step answers SHARD: failed, its reason the body.
+* Messages are text framed and sent uncompressed.
+*
+* Files are named relative to the repository root, "Dir/File.h", since
+* each node has the repository at a root of its own.  Bodies of parse and
+* analyze messages list them as "source <file>" lines, the analyze body
+* followed by the global type table as TypeTable::save writes it.  A deps
+* line is the file, then each file it depends on, tab separated.
+*
+* An AST summary has, for each file, "file <lines> <file>" then a line
+* "scope <type> <first> <last> <complexity> <name>" for each class,
+* struct, interface and function the file defines.
+*
+* Public Interface
+* --------------------
+* HttpMessage msg = ShardProtocol::message("parse", body);
+* bool sent = ShardProtocol::send(msg, socket);
+* HttpMessage reply = ShardProtocol::read(socket);    //no attributes if closed
+* std::string step = ShardProtocol::step(reply);
+* std::string rel = ShardProtocol::relative(root, fileSpec);
+* std::string spec = ShardProtocol::under(root, rel);
+* std::vector<std::string> files = ShardProtocol::sources(body, rest);
+*
+* Required Files:
+* ---------------
+*   ShardProtocol.h, ShardProtocol.cpp
+*   HttpMessage.h, HttpMessage.cpp, Sockets.h, Sockets.cpp
+*   FileSystem.h, FileSystem.cpp, Utilities.h, Utilities.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../HttpMessage/HttpMessage.h"
+#include <string>
+#include <vector>
+
+class Socket;   // declared only, so analyzer sources, which need all of windows.h, may use the helpers
+
+class ShardProtocol
+{
+public:
+	static HttpMessage message(const std::string& step, const std::string& body = "");
+	static bool send(HttpMessage& msg, Socket& socket);
+	static HttpMessage read(Socket& socket);
+	static std::string step(const HttpMessage& msg);
+	static std::string relative(const std::string& root, const std::string& fileSpec);
+	static std::string under(const std::string& root, const std::string& relative);
+	static std::string sourceLines(const std::vector<std::string>& files);
+	static std::vector<std::string> sources(const std::string& body, std::string& rest);
+	static bool readFile(const std::string& fileSpec, std::string& bytes);
+	static bool writeFile(const std::string& fileSpec, const std::string& bytes);
+};
+
+#endif
@@ -0,0 +1,281 @@
+/////////////////////////////////////////////////////////////////////
+// DirWalker.cpp - list a directory tree on a pool of threads      //
+// ver 1.1                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+
+#include "DirWalker.h"
+#include <windows.h>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <atomic>
+#include <cctype>
+
+using namespace FileManager;
+
+/////////////////////////////////////////////////////////////////////
+// Node is one directory of the tree being walked
+// - children are made by the worker that enumerates this directory,
+//   before any of them is queued, so no lock guards them
+
+struct DirWalker::Node
+{
+  DirEntry entry;
+  std::vector<std::unique_ptr<Node>> children;
+};
+
+/////////////////////////////////////////////////////////////////////
+// Pool holds one deque of directories per worker
+// - pending counts directories queued or being enumerated, the walk
+//   is done when it reaches zero
+
+class DirWalker::Pool
+{
+public:
+  Pool(size_t numWorkers) : pending_(0)
+  {
+    for (size_t i = 0; i < numWorkers; ++i)
+      queues_.push_back(std::unique_ptr<Queue>(new Queue));
+  }
+  void push(size_t worker, Node* pNode);
+  Node* take(size_t worker);
+  void run(size_t worker);
+private:
+  struct Queue
+  {
+    std::mutex mtx;
+    std::deque<Node*> nodes;
+  };
+  std::vector<std::unique_ptr<Queue>> queues_;
+  std::atomic<size_t> pending_;
+};
+
+//----< queue directory on worker's deque >--------------------------
+
+void DirWalker::Pool::push(size_t worker, Node* pNode)
+{
+  ++pending_;
+  Queue& queue = *queues_[worker];
+  std::lock_guard<std::mutex> lock(queue.mtx);
+  queue.nodes.push_back(pNode);
+}
+//----< take from own back, else steal from another worker's front >-
+
+DirWalker::Node* DirWalker::Pool::take(size_t worker)
+{
+  {
+    Queue& own = *queues_[worker];
+    std::lock_guard<std::mutex> lock(own.mtx);
+    if (!own.nodes.empty())
+    {
+      Node* pNode = own.nodes.back();
+      own.nodes.pop_back();
+      return pNode;
+    }
+  }
+  for (size_t i = 1; i < queues_.size(); ++i)
+  {
+    Queue& victim = *queues_[(worker + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mtx);
+    if (!victim.nodes.empty())
+    {
+      Node* pNode = victim.nodes.front();
+      victim.nodes.pop_front();
+      return pNode;
+    }
+  }
+  return nullptr;
+}
+//----< worker: enumerate directories until none are pending >-------
+/*
+*  Subdirectories are pushed last first, so this worker goes on with
+*  the first one, as a serial search would, and thieves take the rest.
+*/
+void DirWalker::Pool::run(size_t worker)
+{
+  while (true)
+  {
+    Node* pNode = take(worker);
+    if (pNode == nullptr)
+    {
+      if (pending_.load() == 0)
+        return;
+      std::this_thread::yield();
+      continue;
+    }
+    enumerate(pNode->entry);
+    for (auto& name : pNode->entry.dirs)
+    {
+      pNode->children.push_back(std::unique_ptr<Node>(new Node));
+      pNode->children.back()->entry.path = join(pNode->entry.path, name);
+    }
+    for (size_t i = pNode->children.size(); i > 0; --i)
+      push(worker, pNode->children[i - 1].get());
+    --pending_;
+  }
+}
+//----< append name to path, with one separator >--------------------
+
+std::string DirWalker::join(const std::string& path, const std::string& name)
+{
+  if (!path.empty() && (path.back() == '\\' || path.back() == '/'))
+    return path + name;
+  return path + "\\" + name;
+}
+//----< read names of entry.path's files and subdirectories >--------
+/*
+*  An unreadable directory is listed with no contents, as
+*  FileSystem::Directory::getFiles would report it.
+*/
+void DirWalker::enumerate(DirEntry& entry)
+{
+  WIN32_FIND_DATAA data;
+  HANDLE hFind = ::FindFirstFileExA(
+    join(entry.path, "*").c_str(), FindExInfoBasic, &data,
+    FindExSearchNameMatch, NULL, FIND_FIRST_EX_LARGE_FETCH
+  );
+  if (hFind == INVALID_HANDLE_VALUE)
+    return;
+  do {
+    std::string name = data.cFileName;
+    if (data.dwFileAttributes & FILE_ATTRIBUTE_DIRECTORY)
+    {
+      if (name != "." && name != "..")
+        entry.dirs.push_back(name);
+    }
+    else
+    {
+      FileStat stat;
+      stat.size = ((unsigned long long)data.nFileSizeHigh << 32) + data.nFileSizeLow;
+      stat.lastWrite = ((unsigned long long)data.ftLastWriteTime.dwHighDateTime << 32) + data.ftLastWriteTime.dwLowDateTime;
+      entry.files.push_back(name);
+      entry.stats.push_back(stat);
+    }
+  } while (::FindNextFileA(hFind, &data));
+  ::FindClose(hFind);
+}
+//----< list tree rooted at root, root must be fully qualified >-----
+
+DirWalker::Listing DirWalker::walk(const std::string& root, size_t numThreads)
+{
+  if (numThreads == 0)
+    numThreads = 2 * std::thread::hardware_concurrency();
+  if (numThreads == 0)
+    numThreads = 2;
+
+  Node top;
+  top.entry.path = root;
+  Pool pool(numThreads);
+  pool.push(0, &top);
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < numThreads; ++i)
+    workers.push_back(std::thread([&pool, i]() { pool.run(i); }));
+  for (auto& worker : workers)
+    worker.join();
+
+  Listing listing;
+  std::vector<Node*> stack(1, &top);
+  while (!stack.empty())
+  {
+    Node* pNode = stack.back();
+    stack.pop_back();
+    listing.push_back(std::move(pNode->entry));
+    for (size_t i = pNode->children.size(); i > 0; --i)
+      stack.push_back(pNode->children[i - 1].get());
+  }
+  return listing;
+}
+//----< does name match pattern, with * and ?, ignoring case? >------
+/*
+*  "*.*" matches every name, as it does for FindFirstFile.  Unlike
+*  FindFirstFile, patterns are not matched against 8.3 short names.
+*/
+bool DirWalker::matches(const std::string& name, const std::string& pattern)
+{
+  if (pattern == "*.*")
+    return true;
+  size_t n = 0, p = 0;
+  size_t star = std::string::npos, resume = 0;
+  while (n < name.size())
+  {
+    if (p < pattern.size() && pattern[p] == '*')
+    {
+      star = p++;
+      resume = n;
+    }
+    else if (p < pattern.size() && (pattern[p] == '?' ||
+      std::tolower((unsigned char)pattern[p]) == std::tolower((unsigned char)name[n])))
+    {
+      ++p;
+      ++n;
+    }
+    else if (star != std::string::npos)
+    {
+      p = star + 1;
+      n = ++resume;
+    }
+    else
+      return false;
+  }
+  while (p < pattern.size() && pattern[p] == '*')
+    ++p;
+  return p == pattern.size();
+}
+
+#ifdef TEST_DIRWALKER
+
+#include <iostream>
+#include <chrono>
+#include "../FileSystem/FileSystem.h"
+
+//----< serial listing, made with FileSystem::Directory >------------
+
+void serialWalk(const std::string& path, DirWalker::Listing& listing)
+{
+  DirEntry entry;
+  entry.path = path;
+  entry.files = FileSystem::Directory::getFiles(path);
+  for (auto d : FileSystem::Directory::getDirectories(path))
+  {
+    if (d != "." && d != "..")
+      entry.dirs.push_back(d);
+  }
+  listing.push_back(entry);
+  for (auto d : listing.back().dirs)
+    serialWalk(DirWalker::join(path, d), listing);
+}
+
+int main(int argc, char* argv[])
+{
+  std::cout << "\n  Testing DirWalker";
+  std::cout << "\n ===================";
+
+  std::string root = FileSystem::Path::getFullFileSpec(argc > 1 ? argv[1] : "..");
+  using Clock = std::chrono::steady_clock;
+  Clock::time_point start = Clock::now();
+  DirWalker::Listing serial;
+  serialWalk(root, serial);
+  double serialMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+  start = Clock::now();
+  DirWalker::Listing listing = DirWalker::walk(root);
+  double walkMs = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+
+  bool same = listing.size() == serial.size();
+  size_t files = 0;
+  for (size_t i = 0; same && i < listing.size(); ++i)
+  {
+    same = listing[i].path == serial[i].path && listing[i].files == serial[i].files && listing[i].dirs == serial[i].dirs;
+    files += listing[i].files.size();
+  }
+  std::cout << "\n  " << listing.size() << " directories, " << files << " files under \"" << root << "\"";
+  std::cout << "\n  serial: " << serialMs << " ms, walker: " << walkMs << " ms";
+  std::cout << "\n  same listing as serial search: " << std::boolalpha << same;
+
+  std::cout << "\n  matches(\"Parser.CPP\", \"*.cpp\") = " << DirWalker::matches("Parser.CPP", "*.cpp");
+  std::cout << "\n  matches(\"Parser.cpp.html\", \"*.cpp\") = " << DirWalker::matches("Parser.cpp.html", "*.cpp");
+  std::cout << "\n  matches(\"ReadMe\", \"*.*\") = " << DirWalker::matches("ReadMe", "*.*") << "\n\n";
+  return 0;
+}
+#endif
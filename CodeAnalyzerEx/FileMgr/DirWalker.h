@@ -0,0 +1,93 @@
+#ifndef DIRWALKER_H
+#define DIRWALKER_H
+/////////////////////////////////////////////////////////////////////
+// DirWalker.h - list a directory tree on a pool of threads        //
+// ver 1.1                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides a class, DirWalker, that lists every file and
+* subdirectory of a directory tree.  Directories are enumerated
+* concurrently:
+* - each worker thread owns a deque of directories to enumerate, takes
+*   work from its back, and pushes the subdirectories it finds there
+* - an idle worker steals from the front of another worker's deque, so
+*   one deep subtree doesn't leave the rest of the pool waiting
+* - each directory is read with FindFirstFileEx, asking for basic info
+*   and large fetches, so a network share answers in few round trips
+*
+* Enumeration waits mostly on the file system, not the processor, so
+* the default pool has two threads per core.
+*
+* The result is a Listing, the directories of the tree in the order a
+* serial recursive search visits them, root first, each holding the
+* names of its files and subdirectories in the order the file system
+* returned them.  A Listing is plain data, made once and reused by
+* every later phase that needs to know what is in the tree.
+*
+* Public Interface:
+* -----------------
+* DirWalker::Listing listing = DirWalker::walk("C:\\src");
+* for (auto& entry : listing)
+*   for (auto& name : entry.files)
+*     if (DirWalker::matches(name, "*.h")) ...
+*
+* Required Files:
+* ---------------
+*   DirWalker.h, DirWalker.cpp
+*
+* Build Process:
+* --------------
+*   devenv FileMgr.sln /rebuild debug
+*
+* Maintenance History:
+* --------------------
+* ver 1.1 : 14 Oct 2026
+* - each DirEntry holds the size and last write time of its files,
+*   which FindFirstFileEx returns with their names
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+
+#include <string>
+#include <vector>
+
+namespace FileManager
+{
+  ///////////////////////////////////////////////////////////////////
+  // DirEntry holds what one directory contains
+  // - path is fully qualified, files and dirs are names, without
+  //   the "." and ".." entries
+  // - stats[i] holds size and last write time, a FILETIME, of files[i]
+
+  struct FileStat
+  {
+    unsigned long long size = 0;
+    unsigned long long lastWrite = 0;
+  };
+
+  struct DirEntry
+  {
+    std::string path;
+    std::vector<std::string> files;
+    std::vector<FileStat> stats;
+    std::vector<std::string> dirs;
+  };
+
+  class DirWalker
+  {
+  public:
+    using Listing = std::vector<DirEntry>;
+
+    static Listing walk(const std::string& root, size_t numThreads = 0);
+    static bool matches(const std::string& name, const std::string& pattern);
+    static std::string join(const std::string& path, const std::string& name);
+  private:
+    struct Node;
+    class Pool;
+    static void enumerate(DirEntry& entry);
+  };
+}
+#endif
@@ -0,0 +1,214 @@
+/////////////////////////////////////////////////////////////////////
+// DirWatcher.cpp - wait for files in a directory tree to change   //
+// ver 1.0                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+
+#include "DirWatcher.h"
+#include "DirWalker.h"
+#include <windows.h>
+#include <unordered_set>
+
+using namespace FileManager;
+
+/////////////////////////////////////////////////////////////////////
+// State holds the directory handle and the read in progress
+// - buffer is DWORDs, ReadDirectoryChangesW needs it DWORD aligned
+
+struct DirWatcher::State
+{
+  HANDLE hDir = INVALID_HANDLE_VALUE;
+  HANDLE hStop = nullptr;              // manual reset, set by stop()
+  OVERLAPPED overlapped;
+  std::vector<DWORD> buffer = std::vector<DWORD>(16 * 1024);
+  bool reading = false;
+  std::unordered_set<std::string> seen; // files of the burst being collected
+};
+
+DirWatcher::DirWatcher(const std::string& root, const std::vector<std::string>& patterns)
+  : root_(root), patterns_(patterns), pState_(new State)
+{
+  ZeroMemory(&pState_->overlapped, sizeof(OVERLAPPED));
+}
+//----< cancel the read in progress and close handles >--------------
+
+DirWatcher::~DirWatcher()
+{
+  State& state = *pState_;
+  if (state.hDir != INVALID_HANDLE_VALUE)
+  {
+    if (state.reading)
+    {
+      DWORD bytes = 0;
+      ::CancelIo(state.hDir);
+      ::GetOverlappedResult(state.hDir, &state.overlapped, &bytes, TRUE);
+    }
+    ::CloseHandle(state.hDir);
+  }
+  if (state.overlapped.hEvent != nullptr)
+    ::CloseHandle(state.overlapped.hEvent);
+  if (state.hStop != nullptr)
+    ::CloseHandle(state.hStop);
+}
+//----< open root and start reading changes, false if it can't be watched >--
+
+bool DirWatcher::start()
+{
+  State& state = *pState_;
+  if (state.hDir != INVALID_HANDLE_VALUE)
+    return state.reading;
+  state.hDir = ::CreateFileA(root_.c_str(), FILE_LIST_DIRECTORY,
+    FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, nullptr,
+    OPEN_EXISTING, FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, nullptr);
+  if (state.hDir == INVALID_HANDLE_VALUE)
+    return false;
+  state.overlapped.hEvent = ::CreateEventA(nullptr, TRUE, FALSE, nullptr);
+  state.hStop = ::CreateEventA(nullptr, TRUE, FALSE, nullptr);
+  if (state.overlapped.hEvent == nullptr || state.hStop == nullptr)
+    return false;
+  return read();
+}
+//----< start the next overlapped read of the tree's changes >-------
+
+bool DirWatcher::read()
+{
+  State& state = *pState_;
+  ::ResetEvent(state.overlapped.hEvent);
+  DWORD filter = FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE | FILE_NOTIFY_CHANGE_SIZE;
+  state.reading = ::ReadDirectoryChangesW(state.hDir, state.buffer.data(),
+    static_cast<DWORD>(state.buffer.size() * sizeof(DWORD)), TRUE, filter,
+    nullptr, &state.overlapped, nullptr) != FALSE;
+  return state.reading;
+}
+//----< wait for a burst of changes to matching files >--------------
+/*
+*  - blocks until a matching file changes, then collects changes until
+*    none arrives for debounceMs, or maxDelayMs after the first
+*  - returns false when stopped, or if the tree can no longer be read
+*/
+bool DirWatcher::wait(Changes& changes, size_t debounceMs, size_t maxDelayMs)
+{
+  State& state = *pState_;
+  changes = Changes();
+  state.seen.clear();
+  if (!state.reading)
+    return false;
+  ULONGLONG deadline = 0;
+  while (true)
+  {
+    DWORD timeout = INFINITE;
+    if (deadline != 0)
+    {
+      ULONGLONG now = ::GetTickCount64();
+      if (now >= deadline)
+        return true;
+      ULONGLONG left = deadline - now;
+      timeout = static_cast<DWORD>(left < debounceMs ? left : debounceMs);
+    }
+    HANDLE handles[] = { state.hStop, state.overlapped.hEvent };
+    DWORD result = ::WaitForMultipleObjects(2, handles, FALSE, timeout);
+    if (result == WAIT_TIMEOUT)
+      return true;
+    if (result != WAIT_OBJECT_0 + 1)
+      return false;
+
+    DWORD bytes = 0;
+    state.reading = false;
+    if (!::GetOverlappedResult(state.hDir, &state.overlapped, &bytes, FALSE))
+      return false;
+    if (bytes == 0)
+      changes.overflowed = true;   // more changed than the buffer holds
+    else
+      collect(bytes, changes);
+    if (!read())
+      return false;
+    if (deadline == 0 && (changes.overflowed || changes.files.size() > 0))
+      deadline = ::GetTickCount64() + maxDelayMs;
+  }
+}
+//----< add matching files named in the notifications to changes >---
+
+void DirWatcher::collect(size_t bytes, Changes& changes)
+{
+  State& state = *pState_;
+  const char* pBytes = reinterpret_cast<const char*>(state.buffer.data());
+  size_t offset = 0;
+  while (offset < bytes)
+  {
+    const FILE_NOTIFY_INFORMATION* pInfo = reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pBytes + offset);
+    int length = static_cast<int>(pInfo->FileNameLength / sizeof(WCHAR));
+    int size = ::WideCharToMultiByte(CP_ACP, 0, pInfo->FileName, length, nullptr, 0, nullptr, nullptr);
+    std::string name(size, '\0');
+    if (size > 0)
+      ::WideCharToMultiByte(CP_ACP, 0, pInfo->FileName, length, &name[0], size, nullptr, nullptr);
+    size_t slash = name.find_last_of("\\/");
+    if (matches(slash == std::string::npos ? name : name.substr(slash + 1)))
+    {
+      std::string file = DirWalker::join(root_, name);
+      if (state.seen.insert(file).second)
+        changes.files.push_back(file);
+    }
+    if (pInfo->NextEntryOffset == 0)
+      break;
+    offset += pInfo->NextEntryOffset;
+  }
+}
+//----< does name match one of the patterns? >-----------------------
+
+bool DirWatcher::matches(const std::string& name) const
+{
+  for (auto& pattern : patterns_)
+  {
+    if (DirWalker::matches(name, pattern))
+      return true;
+  }
+  return false;
+}
+//----< make wait return false, can be called from any thread >------
+
+void DirWatcher::stop()
+{
+  if (pState_->hStop != nullptr)
+    ::SetEvent(pState_->hStop);
+}
+
+#ifdef TEST_DIRWATCHER
+
+#include <iostream>
+#include <fstream>
+#include <thread>
+#include <chrono>
+#include "../FileSystem/FileSystem.h"
+
+int main(int argc, char* argv[])
+{
+  std::cout << "\n  Testing DirWatcher";
+  std::cout << "\n ====================";
+
+  std::string root = FileSystem::Path::getFullFileSpec(argc > 1 ? argv[1] : ".");
+  DirWatcher watcher(root, { "*.h", "*.cpp" });
+  if (!watcher.start())
+  {
+    std::cout << "\n  can't watch \"" << root << "\"\n\n";
+    return 1;
+  }
+  std::thread writer([&root] {
+    for (size_t i = 0; i < 5; ++i)
+    {
+      std::ofstream(DirWalker::join(root, "watched.h")) << "// write " << i << "\n";
+      std::ofstream(DirWalker::join(root, "ignored.html")) << "<p>" << i << "</p>\n";
+      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+  });
+  DirWatcher::Changes changes;
+  watcher.wait(changes, 250, 2000);
+  writer.join();
+  std::cout << "\n  one burst, " << changes.files.size() << " file(s), overflowed: " << std::boolalpha << changes.overflowed;
+  for (auto& file : changes.files)
+    std::cout << "\n    " << file;
+  ::DeleteFileA(DirWalker::join(root, "watched.h").c_str());
+  ::DeleteFileA(DirWalker::join(root, "ignored.html").c_str());
+  std::cout << "\n\n";
+  return 0;
+}
+#endif
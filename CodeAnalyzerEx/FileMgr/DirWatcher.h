@@ -0,0 +1,86 @@
+#ifndef DIRWATCHER_H
+#define DIRWATCHER_H
+/////////////////////////////////////////////////////////////////////
+// DirWatcher.h - wait for files in a directory tree to change     //
+// ver 1.0                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides a class, DirWatcher, that waits for files
+* matching a set of patterns to be added, written, renamed, or removed
+* anywhere in a directory tree.  Changes are read with overlapped
+* ReadDirectoryChangesW calls, so waiting takes no processor time.
+*
+* Changes come in bursts, e.g., an upload writes a file in many
+* pieces, and an editor saves several files at once.  wait(...) returns
+* one burst: it blocks for the first change, then goes on collecting
+* until no change has arrived for the debounce window, or until the
+* longest delay has passed since the first one.
+*
+* The read is started by start() and started again as soon as each
+* notification is taken, so changes made while the caller is busy
+* with the last burst are held by the system for the next wait.  If
+* more changed than the system could hold, the burst is reported as
+* overflowed and the caller should treat every file as changed.
+*
+* Files that don't match a pattern, e.g., pages a publisher writes into
+* the same tree, are ignored.
+*
+* Public Interface:
+* -----------------
+* DirWatcher watcher("C:\\src", { "*.h", "*.cpp" });
+* watcher.start();
+* DirWatcher::Changes changes;
+* while (watcher.wait(changes, 250, 2000))
+*   for (auto& file : changes.files) ...
+* watcher.stop();            // from any thread, wait returns false
+*
+* Required Files:
+* ---------------
+*   DirWatcher.h, DirWatcher.cpp, DirWalker.h, DirWalker.cpp
+*
+* Build Process:
+* --------------
+*   devenv FileMgr.sln /rebuild debug
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+
+#include <string>
+#include <vector>
+#include <memory>
+
+namespace FileManager
+{
+  class DirWatcher
+  {
+  public:
+    struct Changes
+    {
+      std::vector<std::string> files;   // fully qualified, each once, in order of first change
+      bool overflowed = false;          // the system dropped changes, any file may have changed
+    };
+
+    DirWatcher(const std::string& root, const std::vector<std::string>& patterns);
+    ~DirWatcher();
+    DirWatcher(const DirWatcher&) = delete;
+    DirWatcher& operator=(const DirWatcher&) = delete;
+    bool start();
+    bool wait(Changes& changes, size_t debounceMs, size_t maxDelayMs);
+    void stop();
+  private:
+    struct State;
+    bool read();
+    void collect(size_t bytes, Changes& changes);
+    bool matches(const std::string& name) const;
+    std::string root_;
+    std::vector<std::string> patterns_;
+    std::unique_ptr<State> pState_;
+  };
+}
+#endif
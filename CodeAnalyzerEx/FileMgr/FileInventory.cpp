@@ -0,0 +1,164 @@
+/////////////////////////////////////////////////////////////////////
+// FileInventory.cpp - every file of a tree, listed once per run   //
+// ver 1.0                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+
+#include "FileInventory.h"
+#include "../FileSystem/FileSystem.h"
+#include <sstream>
+
+using namespace FileManager;
+
+//----< last write time and size, same text as PublishManifest::stamp >--
+
+std::string FileInventory::Item::stamp() const
+{
+  FILETIME ft;
+  ft.dwLowDateTime = (DWORD)(lastWrite & 0xffffffff);
+  ft.dwHighDateTime = (DWORD)(lastWrite >> 32);
+  std::ostringstream out;
+  out << FileSystem::FileInfo::date(ft) << " " << (size_t)size;
+  return out.str();
+}
+//----< directory path without a trailing separator, except for C:\ >--
+
+std::string FileInventory::dirKey(const std::string& path)
+{
+  if (path.size() > 3 && (path.back() == '\\' || path.back() == '/'))
+    return path.substr(0, path.size() - 1);
+  return path;
+}
+//----< take listing and index its directories and files >-----------
+
+void FileInventory::build(DirWalker::Listing&& listing)
+{
+  listing_ = std::move(listing);
+  items_.clear();
+  files_.clear();
+  dirs_.clear();
+  for (size_t i = 0; i < listing_.size(); ++i)
+  {
+    DirEntry& entry = listing_[i];
+    Range range = { i, items_.size() };
+    dirs_[dirKey(entry.path)] = range;
+    for (size_t j = 0; j < entry.files.size(); ++j)
+    {
+      Item item;
+      item.path = DirWalker::join(entry.path, entry.files[j]);
+      item.name = entry.files[j];
+      item.ext = FileSystem::Path::getExt(item.name);
+      if (j < entry.stats.size())
+      {
+        item.size = entry.stats[j].size;
+        item.lastWrite = entry.stats[j].lastWrite;
+      }
+      files_[item.path] = items_.size();
+      items_.push_back(item);
+    }
+  }
+}
+//----< item for fileSpec, which may be relative, nullptr if none >--
+
+const FileInventory::Item* FileInventory::find(const std::string& fileSpec) const
+{
+  auto iter = files_.find(FileSystem::Path::getFullFileSpec(fileSpec));
+  if (iter == files_.end())
+    return nullptr;
+  return &items_[iter->second];
+}
+//----< listed directory, nullptr if path is outside the tree >------
+
+const FileInventory::Range* FileInventory::findDir(const std::string& path) const
+{
+  auto iter = dirs_.find(dirKey(FileSystem::Path::getFullFileSpec(path)));
+  if (iter == dirs_.end())
+    return nullptr;
+  return &iter->second;
+}
+//----< items of the files in directory path, false if not listed >--
+
+bool FileInventory::itemsIn(const std::string& path, std::vector<const Item*>& items) const
+{
+  const Range* pRange = findDir(path);
+  if (pRange == nullptr)
+    return false;
+  size_t count = listing_[pRange->entry].files.size();
+  for (size_t i = 0; i < count; ++i)
+    items.push_back(&items_[pRange->first + i]);
+  return true;
+}
+//----< does file exist, as of the time the tree was listed? >-------
+
+bool FileInventory::exists(const std::string& fileSpec) const
+{
+  if (find(fileSpec) != nullptr)
+    return true;
+  std::string full = FileSystem::Path::getFullFileSpec(fileSpec);
+  size_t pos = full.find_last_of("\\/");
+  if (pos != std::string::npos && findDir(full.substr(0, pos + 1)) != nullptr)
+    return false;
+  return FileSystem::File::exists(fileSpec);
+}
+//----< subdirectories of path, "." and ".." first, as NTFS returns them >--
+
+std::vector<std::string> FileInventory::getDirectories(const std::string& path) const
+{
+  const Range* pRange = findDir(path);
+  if (pRange == nullptr)
+    return FileSystem::Directory::getDirectories(path);
+  std::vector<std::string> dirs = { ".", ".." };
+  const DirEntry& entry = listing_[pRange->entry];
+  dirs.insert(dirs.end(), entry.dirs.begin(), entry.dirs.end());
+  return dirs;
+}
+//----< names of the files in directory path >-----------------------
+
+std::vector<std::string> FileInventory::getFiles(const std::string& path) const
+{
+  const Range* pRange = findDir(path);
+  if (pRange == nullptr)
+    return FileSystem::Directory::getFiles(path);
+  return listing_[pRange->entry].files;
+}
+
+#ifdef TEST_FILEINVENTORY
+
+#include <iostream>
+
+int main(int argc, char* argv[])
+{
+  std::cout << "\n  Testing FileInventory";
+  std::cout << "\n =======================";
+
+  std::string root = FileSystem::Path::getFullFileSpec(argc > 1 ? argv[1] : "..");
+  FileInventory inv;
+  inv.build(DirWalker::walk(root));
+  std::cout << "\n  " << inv.listing().size() << " directories, " << inv.size() << " files under \"" << root << "\"";
+
+  size_t stampsMatch = 0, dirsMatch = 0;
+  for (auto& item : inv.items())
+  {
+    FileSystem::FileInfo fi(item.path);
+    std::ostringstream out;
+    out << fi.date() << " " << fi.size();
+    if (out.str() == item.stamp())
+      ++stampsMatch;
+  }
+  for (auto& entry : inv.listing())
+  {
+    if (inv.getDirectories(entry.path) == FileSystem::Directory::getDirectories(entry.path)
+      && inv.getFiles(entry.path) == FileSystem::Directory::getFiles(entry.path))
+      ++dirsMatch;
+  }
+  std::cout << "\n  stamps matching FileInfo: " << stampsMatch << " of " << inv.size();
+  std::cout << "\n  directories matching FileSystem::Directory: " << dirsMatch << " of " << inv.listing().size();
+  if (inv.size() > 0)
+  {
+    const FileInventory::Item& item = inv.items().front();
+    std::cout << "\n  " << item.name << ": ext \"" << item.ext << "\", " << item.stamp();
+  }
+  std::cout << "\n\n";
+  return 0;
+}
+#endif
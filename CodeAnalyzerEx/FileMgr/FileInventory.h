@@ -0,0 +1,93 @@
+#ifndef FILEINVENTORY_H
+#define FILEINVENTORY_H
+/////////////////////////////////////////////////////////////////////
+// FileInventory.h - every file of a tree, listed once per run     //
+// ver 1.0                                                         //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
+/////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides a class, FileInventory, built once from a
+* DirWalker::Listing and then handed to every phase that would
+* otherwise list the tree again.  For each file it holds full path,
+* name, lower case extension, size, and last write time, so later
+* phases never call FindFirstFile, FileInfo, or Path::getExt for
+* files in the tree.
+*
+* getDirectories(...), getFiles(...), and exists(...) answer as the
+* FileSystem functions with the same names do, including the "." and
+* ".." entries of getDirectories, as of the time the tree was listed.
+* Paths outside the tree are passed on to FileSystem, so callers can
+* use them for any path.
+*
+* Public Interface:
+* -----------------
+* FileInventory inv;
+* inv.build(DirWalker::walk(root));
+* const FileInventory::Item* pItem = inv.find("..\\Repository\\x\\x.h");
+* std::string stamp = pItem->stamp();               // as PublishManifest::stamp
+* std::vector<std::string> dirs = inv.getDirectories("..\\Repository");
+* std::vector<const FileInventory::Item*> items;
+* inv.itemsIn("..\\Repository\\x", items);          // false if not listed
+* inv.exists("..\\Repository\\x\\x.css");            // as FileSystem::File::exists
+*
+* Required Files:
+* ---------------
+*   FileInventory.h, FileInventory.cpp, DirWalker.h, DirWalker.cpp,
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv FileMgr.sln /rebuild debug
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+
+#include <string>
+#include <vector>
+#include <unordered_map>
+#include "DirWalker.h"
+
+namespace FileManager
+{
+  class FileInventory
+  {
+  public:
+    struct Item
+    {
+      std::string path;
+      std::string name;
+      std::string ext;
+      unsigned long long size = 0;
+      unsigned long long lastWrite = 0;
+      std::string stamp() const;
+    };
+
+    void build(DirWalker::Listing&& listing);
+    const DirWalker::Listing& listing() const { return listing_; }
+    const std::vector<Item>& items() const { return items_; }
+    size_t size() const { return items_.size(); }
+    const Item* find(const std::string& fileSpec) const;
+    bool itemsIn(const std::string& path, std::vector<const Item*>& items) const;
+    bool exists(const std::string& fileSpec) const;
+    std::vector<std::string> getDirectories(const std::string& path) const;
+    std::vector<std::string> getFiles(const std::string& path) const;
+  private:
+    struct Range
+    {
+      size_t entry;
+      size_t first;
+    };
+    const Range* findDir(const std::string& path) const;
+    static std::string dirKey(const std::string& path);
+    DirWalker::Listing listing_;
+    std::vector<Item> items_;
+    std::unordered_map<std::string, size_t> files_;
+    std::unordered_map<std::string, Range> dirs_;
+  };
+}
+#endif
@@ -3,7 +3,7 @@
 /////////////////////////////////////////////////////////////////////
 // FileMgr.h - find files matching specified patterns              //
 //             on a specified path                                 //
-// ver 2.2                                                         //
+// ver 2.3                                                         //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016       //
 /////////////////////////////////////////////////////////////////////
 /*
@@ -21,9 +21,14 @@
 * The package also provides interface hooks that serve the same purpose
 * but allow multiple receivers for those events.
 *
+* searchParallel() lists the tree with DirWalker, on a pool of threads,
+* then raises the same events, in the same order, as search().  The
+* listing, which holds every file, not just those matching patterns,
+* is kept so later phases can reuse it instead of searching again.
+*
 * Required Files:
 * ---------------
-*   FileMgr.h, FileMgr.cpp, IFileMgr.h, 
+*   FileMgr.h, FileMgr.cpp, IFileMgr.h, DirWalker.h, DirWalker.cpp,
 *   FileSystem.h, FileSystem.cpp
 *
 * Build Process:
@@ -32,6 +37,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 2.3 : 14 Oct 2026
+* - added searchParallel() and listing()
 * ver 2.2 : 28 Aug 2016
 * - added more prologue comments
 * ver 2.1 : 31 Jul 2016
@@ -45,6 +52,7 @@
 */
 
 #include "IFileMgr.h"
+#include "DirWalker.h"
 #include "../FileSystem/FileSystem.h"
 
 namespace FileManager
@@ -117,6 +125,31 @@ namespace FileManager
       find(path_);
       done();
     }
+    //----< search on a pool of threads, keeping the listing >--------
+
+    void searchParallel(size_t numThreads = 0)
+    {
+      listing_ = DirWalker::walk(FileSystem::Path::getFullFileSpec(path_), numThreads);
+      for (auto& entry : listing_)
+      {
+        dir(entry.path);
+        for (auto patt : patterns_)
+        {
+          for (auto& f : entry.files)
+          {
+            if (DirWalker::matches(f, patt))
+              file(f);
+          }
+        }
+      }
+      done();
+    }
+    //----< tree listed by last searchParallel() >-------------------
+
+    DirWalker::Listing& listing()
+    {
+      return listing_;
+    }
     //----< search current path including subdirectories >-----------
 
     void find(const std::string& path)
@@ -161,6 +194,7 @@ namespace FileManager
   private:
     std::string path_;
     patterns patterns_;
+    DirWalker::Listing listing_;
     size_t numFilesProcessed = 0;
     fileSubscribers fileSubscribers_;
     dirSubscribers dirSubscribers_;
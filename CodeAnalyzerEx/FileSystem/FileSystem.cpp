@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////////
 // FileSystem.cpp - Support file and directory operations                  //
-// ver 2.6                                                                 //
+// ver 2.9                                                                 //
 // ----------------------------------------------------------------------- //
 // copyright  Jim Fawcett, 2012                                           //
 // All rights granted provided that this notice is retained                //
@@ -221,19 +221,8 @@ Block File::getBlock(size_t size)
     throw std::runtime_error("reading binary from text file");
   if(dirn_ == out)
     throw std::runtime_error("reading output file");
-  Block blk;
-  if(pIStream)
-  {
-    for(size_t i=0; i<size; ++i)
-    {
-      Byte b;
-      pIStream->get(b);
-      if(pIStream->good())
-        blk.push_back(b);
-      else
-        break;
-    }
-  }
+  Block blk(size);
+  blk.resize(read(size, blk.data()));
   return blk;
 }
 //----< writes a block of bytes to binary file >---------------------------
@@ -246,12 +235,7 @@ void File::putBlock(const Block& blk)
     throw std::runtime_error("writing binary to text file");
   if(dirn_ == in)
     throw std::runtime_error("writing input file");
-  if(!pOStream->good())
-    return;
-  for(size_t i=0; i<blk.size(); ++i)
-  {
-    pOStream->put(blk[i]);
-  }
+  write(blk.size(), blk.data());
 }
 //----< read buffer of bytes from binary file >----------------------------
 
@@ -263,16 +247,7 @@ size_t File::getBuffer(size_t bufLen, File::byte* buffer)
     throw std::runtime_error("reading binary from text file");
   if (dirn_ == out)
     throw std::runtime_error("reading output file");
-  size_t count = 0;
-  while (pIStream->good())
-  {
-    buffer[count++] = pIStream->get();
-      if (count == bufLen)
-        break;
-  }
-  if (!pIStream->good())  // don't write EOF char
-    --count;
-  return count;
+  return read(bufLen, buffer);
 }
 //----< write buffer of bytes to binary file >-------------------------------
 
@@ -284,15 +259,57 @@ void File::putBuffer(size_t bufLen, File::byte* buffer)
     throw std::runtime_error("writing binary to text file");
   if (dirn_ == in)
     throw std::runtime_error("writing input file");
-  if (!pOStream->good())
+  write(bufLen, buffer);
+}
+//----< read up to bufLen bytes with one call, fewer only at end >-----------
+/*
+ * - like the checked getters above, but leaves stream state to the caller
+ * - a short read leaves the stream not good, as getting past the end does
+ */
+size_t File::read(size_t bufLen, File::byte* buffer)
+{
+  if (pIStream == nullptr || !pIStream->good() || bufLen == 0)
+    return 0;
+  pIStream->read(buffer, bufLen);
+  return static_cast<size_t>(pIStream->gcount());
+}
+//----< write bufLen bytes with one call >-----------------------------------
+
+void File::write(size_t bufLen, const File::byte* buffer)
+{
+  if (pOStream == nullptr || !pOStream->good() || bufLen == 0)
     return;
+  pOStream->write(buffer, bufLen);
+}
+//----< read rest of binary file into blk, returns bytes read >--------------
+/*
+ * - blk is sized once from FileInfo::size(), less what has been read
+ * - if the size can't be found, or the file grew, the rest is read in
+ *   64 KB steps
+ */
+size_t File::readAll(Block& blk)
+{
+  if (pIStream == nullptr || !pIStream->good())
+    throw std::runtime_error("input stream not open");
+  if (typ_ != binary)
+    throw std::runtime_error("reading binary from text file");
+  const size_t step = 64 * 1024;
+  size_t expected = 0;
+  FileInfo fi(Path::getFullFileSpec(name_));
+  std::streamoff pos = pIStream->tellg();
+  if (fi.good() && pos >= 0 && fi.size() > static_cast<size_t>(pos))
+    expected = fi.size() - static_cast<size_t>(pos);
+  blk.resize(expected + 1);     // one spare byte finds the end without another call
   size_t count = 0;
-  while(pOStream->good())
+  while (true)
   {
-    pOStream->put(buffer[count++]);
-    if (count == bufLen)
+    count += read(blk.size() - count, blk.data() + count);
+    if (!pIStream->good())
       break;
+    blk.resize(blk.size() + step);
   }
+  blk.resize(count);
+  return count;
 }
 //----< tests for error free stream state >--------------------------------
 
@@ -392,11 +409,17 @@ std::string FileInfo::intToString(long i)
 //----< return file date >---------------------------------------------
 
 std::string FileInfo::date(dateFormat df) const
+{
+  return date(data.ftLastWriteTime, df);
+}
+//----< return date of a last write time, in local time >--------------
+
+std::string FileInfo::date(const FILETIME& lastWrite, dateFormat df)
 {
   std::string dateStr, timeStr;
   FILETIME ft;
   SYSTEMTIME st;
-  ::FileTimeToLocalFileTime(&data.ftLastWriteTime, &ft);
+  ::FileTimeToLocalFileTime(&lastWrite, &ft);
   ::FileTimeToSystemTime(&ft, &st);
   dateStr = intToString(st.wMonth) + '/' + intToString(st.wDay) + '/' + intToString(st.wYear);
   timeStr = intToString(st.wHour) + ':' + intToString(st.wMinute) + ':' + intToString(st.wSecond);
@@ -410,7 +433,8 @@ std::string FileInfo::date(dateFormat df) const
 
 size_t FileInfo::size() const
 {
-  return (size_t)(data.nFileSizeLow + (data.nFileSizeHigh << 8));
+  unsigned long long high = data.nFileSizeHigh;
+  return (size_t)((high << 32) + data.nFileSizeLow);
 }
 //----< is type archive? >---------------------------------------------
 
@@ -1100,6 +1124,18 @@ int main(int argc, char* argv[])
   }
   testAllTrue.close();
 
+  title("testing File::readAll(Block&)", '-');
+  File testBlock("../FileSystemTest.txt");
+  testBlock.open(File::in, File::binary);
+  if (testBlock.isGood())
+  {
+    Block all;
+    size_t count = testBlock.readAll(all);
+    FileInfo fi(Path::getFullFileSpec("../FileSystemTest.txt"));
+    std::cout << "\n  read " << count << " bytes of " << fi.size() << " in one call\n";
+  }
+  testBlock.close();
+
   // test reading non-text files
 
   title("test reading non-text files", '-');
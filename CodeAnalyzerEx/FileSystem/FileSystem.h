@@ -2,7 +2,7 @@
 #define FILESYSTEM_H
 /////////////////////////////////////////////////////////////////////////////
 // FileSystem.h - Support file and directory operations                    //
-// ver 2.6                                                                 //
+// ver 2.9                                                                 //
 // ----------------------------------------------------------------------- //
 // copyright  Jim Fawcett, 2012                                           //
 // All rights granted provided that this notice is retained                //
@@ -48,6 +48,9 @@
  * }
  * File h(filespec,File::in);
  * h.readLine();
+ * size_t n = f.read(bufLen, buffer);    // one istream::read, n < bufLen at end
+ * g.write(n, buffer);
+ * Block all; f.readAll(all);            // rest of a binary file, sized up front
  *
  * FileInfo fi("..\foobar.txt");
  * if(fi.good())
@@ -80,6 +83,17 @@
  *
  * Maintenance History:
  * ====================
+ * ver 2.9 : 14 Oct 2026
+ * - added File::read, write and readAll(Block&), which move bytes with one
+ *   istream::read or ostream::write call, and Block::data, resize and
+ *   reserve.  getBlock, putBlock, getBuffer and putBuffer now use them
+ *   instead of getting and putting one byte at a time.
+ * ver 2.8 : 14 Oct 2026
+ * - added static FileInfo::date(const FILETIME&, ...), which formats a
+ *   last write time read elsewhere, e.g. by FindFirstFileEx, as date() does
+ * ver 2.7 : 14 Oct 2026
+ * - fixed FileInfo::size() for files larger than 4 GB, the high word
+ *   of the size was shifted by 8 bits instead of 32
  * ver 2.6 : 04 Apr 15
  * - added File::getBuffer(...) and File::putBuffer(...) for use with
  *   Sockets package.
@@ -135,6 +149,10 @@ namespace FileSystem
     bool operator==(const Block&) const;
     bool operator!=(const Block&) const;
     size_t size() const;
+    Byte* data() { return bytes_.data(); }
+    const Byte* data() const { return bytes_.data(); }
+    void resize(size_t size) { bytes_.resize(size); }
+    void reserve(size_t size) { bytes_.reserve(size); }
   private:
     std::vector<Byte> bytes_;
   };
@@ -159,6 +177,9 @@ namespace FileSystem
     void putBlock(const Block&);
     size_t getBuffer(size_t bufLen, byte* buffer);
     void putBuffer(size_t bufLen, byte* buffer);
+    size_t read(size_t bufLen, byte* buffer);
+    void write(size_t bufLen, const byte* buffer);
+    size_t readAll(Block& blk);
     bool isGood();
     void clear();
     void flush();
@@ -188,6 +209,7 @@ namespace FileSystem
     bool good();
     std::string name() const;
     std::string date(dateFormat df=fullformat) const;
+    static std::string date(const FILETIME& lastWrite, dateFormat df=fullformat);
     size_t size() const;
     
     bool isArchive() const;
@@ -1,7 +1,7 @@
 /////////////////////////////////////////////////////////////////////
 // Window.cpp - C++\CLI implementation of WPF Application          //
 //            - Runs Code Static Analysis                          //
-// ver 3.2                                                         //
+// ver 3.3                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2016                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -82,6 +82,12 @@ WPFCppCliDemo::WPFCppCliDemo()
   createDisplayModeView();
 
   hStatus->Text = "Browse to find analysis path or enter in textbox";
+
+  // show analysis progress events as the service posts them
+
+  eventThread_ = gcnew Thread(gcnew ThreadStart(this, &WPFCppCliDemo::getEvents));
+  eventThread_->IsBackground = true;
+  eventThread_->Start();
 }
 
 WPFCppCliDemo::~WPFCppCliDemo()
@@ -651,38 +657,37 @@ void WPFCppCliDemo::setCmdLineArgs()
   if (hLogFileMode_->IsChecked)
     cmdLine_ += " /f";
 }
-//----< execute Analyzer.exe as a separate process >----------------0
-
+//----< post analysis to the resident analyzer, doesn't wait >------
+/*
+*  The analyzer stays loaded between runs and analyzes with /i, so a
+*  repeat analysis parses only the files changed since the last one.
+*/
 void WPFCppCliDemo::doExecute()
 {
   Console::Clear();
-  ProcessStartInfo^ psi = gcnew ProcessStartInfo();
-  psi->UseShellExecute = false;
-  /*
-  *  Look for Analyzer executable in directory where GUI was started.
-  */
-  String^ analyzerPath = Path::GetFullPath(Assembly::GetExecutingAssembly()->Location);
-  analyzerPath = Path::GetDirectoryName(analyzerPath);
-  if (!System::IO::Directory::Exists(analyzerPath))
+  setCmdLineArgs();
+  shim_->Analyze(cmdLine_);
+  hStatus->Text = "Analysis requested";
+  saveUserSettings();
+}
+//----< receive thread, passes service events to the UI thread >----
+
+void WPFCppCliDemo::getEvents()
+{
+  while (true)
   {
-    throw gcnew Exception("invalid analyzer path");
+    String^ progress = shim_->GetEvent();
+    array<String^>^ args = gcnew array<String^>(1);
+    args[0] = progress;
+    Action<String^>^ act = gcnew Action<String^>(this, &WPFCppCliDemo::showEvent);
+    Dispatcher->BeginInvoke(act, args);
   }
-  analyzerPath += "\\CodeAnalyzer.exe";
-  try {
-    analyzerPath = System::IO::Path::GetFullPath(analyzerPath);
-    psi->FileName = analyzerPath;
-    setCmdLineArgs();
-    psi->Arguments = cmdLine_;
-    Process^ p = Process::Start(psi);
-  }
-  catch (Exception^ ex)
-  {
-    // we get here if file spec is invalid
+}
+//----< show analysis progress in status bar, runs on UI thread >---
 
-    Console::Write("\n{0} = {1}", ex->Message, analyzerPath);
-    Console::Write("\n{0}\n", "try rebuilding CodeAnalyzer");
-  }
-  saveUserSettings();
+void WPFCppCliDemo::showEvent(String^ progress)
+{
+  hStatus->Text = "Analysis: " + progress;
 }
 //----< event handler for Start Analysis Button >--------------------
 
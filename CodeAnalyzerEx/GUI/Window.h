@@ -3,7 +3,7 @@
 /////////////////////////////////////////////////////////////////////
 // Window.h - C++\CLI implementation of WPF Application            //
 //          - Runs Code Static Analysis                            //
-// ver 3.2                                                         //
+// ver 3.3                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2016                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -27,12 +27,14 @@
 *  starting code analysis execution, setting up analysis parameters, and
 *  determining what will be displayed and logged.
 *
-*  This application provides a GUI that expects to find an analyzer program
-*  and execute it with command line parameters derived from GUI selections.
+*  This application provides a GUI that runs code analyses with command line
+*  parameters derived from GUI selections.  Analyses run in-process, on the
+*  CLI Shim's resident AnalysisService, and a background thread shows the
+*  service's progress events in the status bar through the Dispatcher.
 *
 *  Required Files:
 *  ---------------
-*  Window.h, Window.cpp, Analyzer.exe
+*  Window.h, Window.cpp, CLIShim.dll
 *
 *  Build Command:
 *  --------------
@@ -41,6 +43,9 @@
 *
 *  Maintenance History:
 *  --------------------
+*  ver 3.3 : 14 Oct 2026
+*  - Start Analysis posts the command line to the Shim's AnalysisService
+*    instead of starting CodeAnalyzer.exe, and shows its progress events
 *  ver 3.2 : 27 Oct 2016
 *  - fixed bug passing directory name to Analyzer.  Wrapped the path in
 *    quotes so Analyzer will handle directory names with spaces.
@@ -216,8 +221,12 @@ namespace CppCliWindows
     void executionTabSelected(Object^ sender, RoutedEventArgs^ args);
     void setupTabSelected(Object^ sender, RoutedEventArgs^ args);
     void procModeTabSelected(Object^ sender, RoutedEventArgs^ args);
+    void getEvents();
+    void showEvent(String^ progress);
     String^ path_;
     String^ cmdLine_;
+    Shim^ shim_ = gcnew Shim();     // resident analyzer
+    Thread^ eventThread_;
     UserSettings userSettings_;
 
     ///////////////////////////////////////////////////////
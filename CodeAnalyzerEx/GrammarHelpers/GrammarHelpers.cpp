@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
 // GrammarHelpers.cpp - Functions providing base grammatical analyses  //
-// ver 1.3                                                             //
+// ver 1.5                                                             //
 // Language:    C++, Visual Studio 2015                                //
 // Application: Support for Parsing, CSE687 - Object Oriented Design   //
 // Author:      Jim Fawcett, Syracuse University, CST 4-187            //
@@ -14,41 +14,93 @@
 #include <iostream>
 #include <iomanip>
 #include <sstream>
+#include <utility>
 
 using namespace CodeAnalysis;
+using Scanner::KeyWords;
 
-//----< is tok a control keyword for either C++ or C# ? >------------
-
-bool GrammarHelper::isControlKeyWord(const std::string& tok)
+namespace
 {
-  const static size_t numKeys = 9;
-  const static std::string keys[numKeys]
-    = { "for", "foreach", "do", "while", "switch", "if", "else", "try", "catch" };
+  //----< drop tokens past length, from the back where remove is cheap >--
 
-  for (int i = 0; i < numKeys; ++i)
+  void shrinkTo(Scanner::ITokCollection& tc, size_t length)
   {
-    if (tok == keys[i])
-      return true;
+    while (tc.length() > length)
+      tc.remove(tc.length() - 1);
   }
-  return false;
+  //----< erase tokens [first, last) moving the tail down once >-------
+  /*
+  *  remove(i) shifts every later token, so erasing k tokens one at a
+  *  time costs k passes over the tail.
+  */
+  void eraseRange(Scanner::ITokCollection& tc, size_t first, size_t last)
+  {
+    size_t length = tc.length();
+    if (last > length)
+      last = length;
+    if (first >= last)
+      return;
+    Scanner::ITokCollection::iterator iter = tc.begin();
+    std::move(iter + last, iter + length, iter + first);
+    shrinkTo(tc, length - (last - first));
+  }
+  //----< erase every token drop(i) is true for, in one pass >---------
+  /*
+  *  - decides before touching tokens, as begin() makes SemiExp
+  *    classify its tokens again
+  */
+  template <typename Drop>
+  void eraseIf(Scanner::ITokCollection& tc, Drop drop)
+  {
+    std::vector<char> dropped(tc.length());
+    bool any = false;
+    for (size_t i = 0; i < tc.length(); ++i)
+    {
+      dropped[i] = drop(i) ? 1 : 0;
+      any = any || dropped[i];
+    }
+    if (!any)
+      return;
+    Scanner::ITokCollection::iterator iter = tc.begin();
+    size_t kept = 0;
+    for (size_t i = 0; i < dropped.size(); ++i)
+    {
+      if (dropped[i])
+        continue;
+      if (kept != i)
+        iter[kept] = std::move(iter[i]);
+      ++kept;
+    }
+    shrinkTo(tc, kept);
+  }
+}
+
+//----< is tok a control keyword for either C++ or C# ? >------------
+/*
+*  for, foreach, do, while, switch, if, else, try, catch
+*/
+bool GrammarHelper::isControlKeyWord(const std::string& tok)
+{
+  return (KeyWords::of(tok) & KeyWords::Control) != 0;
+}
+//----< is nth token of semiExp a control keyword ? >----------------
+
+bool GrammarHelper::isControlKeyWord(const Scanner::ITokCollection& se, size_t n)
+{
+  return (se.keyWords(n) & KeyWords::Control) != 0;
 }
 //----< does SemiExp contain at least one control keyword ? >--------
 
 bool GrammarHelper::hasControlKeyWord(const Scanner::ITokCollection& se)
 {
-  for (size_t i = 0; i < se.length(); ++i)
-  {
-    if (GrammarHelper::isControlKeyWord(se[i]))
-      return true;
-  }
-  return false;
+  return (se.keyWordMask() & KeyWords::Control) != 0;
 }
 //----< is semiExp a function defin or declar ? >--------------------
 
 bool GrammarHelper::isFunction(const Scanner::ITokCollection& se)
 {
   size_t len = se.find("(");
-  if (0 < len && len < se.length() && !isControlKeyWord(se[len - 1]))
+  if (0 < len && len < se.length() && !isControlKeyWord(se, len - 1))
     return true;
   if (len == 0)
   {
@@ -103,32 +155,26 @@ size_t GrammarHelper::findLast(const Scanner::ITokCollection& se, const std::str
   return se.length();
 }
 //----< is tok a type qualifier keyword ? >--------------------------
-
+/*
+*  const, extern, friend, mutable, signed, static, abstract, typedef,
+*  typename, unsigned, volatile, public, protected, private,
+*  &, *, :, ++, --
+*/
 bool GrammarHelper::isQualifierKeyWord(const std::string& tok)
 {
-  const size_t numKeys = 21;            // its declar else executable.
-  const static std::string keys[numKeys] = {
-    "const", "extern", "friend", "mutable", "signed", "static", "abstract", 
-    "typedef", "typename", "unsigned", "volatile", "&", "*", /*"std",*/ /*"::",*/
-    "public", "protected", "private", ":", "typename", "typedef", "++", "--"
-  };
-  for (int i = 0; i < numKeys; ++i)
-    if (tok == keys[i])
-      return true;
-  return false;
+  return (KeyWords::of(tok) & KeyWords::Qualifier) != 0;
+}
+//----< is nth token of semiExp a type qualifier keyword ? >---------
+
+bool GrammarHelper::isQualifierKeyWord(const Scanner::ITokCollection& se, size_t n)
+{
+  return (se.keyWords(n) & KeyWords::Qualifier) != 0;
 }
 //----< strip qualifier keywords from semiExp >----------------------
 
 void GrammarHelper::removeQualifiers(Scanner::ITokCollection& tc)
 {
-  size_t i = 0;
-  while (i < tc.length())
-  {
-    if (isQualifierKeyWord(tc[i]))
-      tc.remove(i);
-    else
-      ++i;
-  }
+  eraseIf(tc, [&tc](size_t i) { return isQualifierKeyWord(tc, i); });
 }
 //----< remove calling argument qualifiers after first paren >-------
 
@@ -143,7 +189,7 @@ void GrammarHelper::removeCallingArgQualifiers(Scanner::ITokCollection& tc)
   size_t i = begin + 1;
   while (true)
   {
-    if (isQualifierKeyWord(tc[i]))
+    if (isQualifierKeyWord(tc, i))
       tc.remove(tc[i]);
     if (tc[i] == ")")
       break;
@@ -299,6 +345,49 @@ bool GrammarHelper::hasFunctionInvocation(const Scanner::ITokCollection& tc, con
   }
   return false;
 }
+//----< declaration with templates, qualifiers, inits, and args removed >--
+/*
+*  - posParen is where the first "(" was before args were removed,
+*    std::string::npos if there was none
+*  - the view of the last SemiExp condensed on this thread is kept, so
+*    a rule and its action asking about the same tokens, each with its
+*    own copy, condense them once
+*  - the returned view is valid until the next call on this thread
+*/
+const Scanner::ITokCollection& GrammarHelper::condensedDeclaration(const Scanner::ITokCollection& tc, size_t& posParen)
+{
+  struct Condensed
+  {
+    std::vector<std::string> tokens;   // tokens condensed, empty if not a SemiExp
+    Scanner::SemiExp view;
+    size_t posParen = std::string::npos;
+    bool valid = false;
+  };
+  static thread_local Condensed last;
+
+  const Scanner::SemiExp* pSe = dynamic_cast<const Scanner::SemiExp*>(&tc);
+  if (last.valid && pSe != nullptr && pSe->tokens() == last.tokens)
+  {
+    posParen = last.posParen;
+    return last.view;
+  }
+  last.valid = false;
+  last.view.clone(tc);
+  condenseTemplateTypes(last.view);
+  removeQualifiers(last.view);
+  removeCppInitializers(last.view);
+  last.posParen = last.view.find("(");
+  if (last.posParen == last.view.length())
+    last.posParen = std::string::npos;
+  removeFunctionArgs(last.view);
+  if (pSe != nullptr)
+  {
+    last.tokens = pSe->tokens();
+    last.valid = true;
+  }
+  posParen = last.posParen;
+  return last.view;
+}
 //----< is this a data declaration ? >-------------------------------
 
 bool GrammarHelper::isDataDeclaration(const Scanner::ITokCollection& tc)
@@ -320,26 +409,16 @@ bool GrammarHelper::isDataDeclaration(const Scanner::ITokCollection& tc)
   if (tc.find("<<") < tc.length() || tc.find(">>") < tc.length())
     return false;
 
-  std::string debug = tc.show();
+  size_t posParen = 0;
+  const Scanner::ITokCollection& se = condensedDeclaration(tc, posParen);
 
-  Scanner::SemiExp se;
-  se.clone(tc);
-  condenseTemplateTypes(se);
-  removeQualifiers(se);
-  removeCppInitializers(se);
-  
   // is this a function declaration ?
 
-  size_t posParen = se.find("(");
-  if (posParen < se.length() && (posParen == 2 || posParen == 3))
+  if (posParen == 2 || posParen == 3)
     return false;
 
-  removeFunctionArgs(se);
-  
   // is stripped tc of the form "type name ;" or "namespace :: type name ;"
 
-  std::string debug2 = se.show();
-
   if (se.length() == 3)
     return true;
   if (se.length() == 5 && se[1] == "::")
@@ -366,19 +445,11 @@ bool GrammarHelper::isExecutable(const Scanner::ITokCollection& tc, const std::s
 
 void GrammarHelper::removeCppInitializers(Scanner::ITokCollection& tc)
 {
-  std::string debug = tc.show();
-  for (size_t i = 0; i < tc.length(); ++i)
-  {
-    if (tc[i] == "=" || tc[i] == "{")
-    {
-      size_t j = i;
-      while (j < tc.length() && tc[j] != ";")
-      {
-        tc.remove(j);
-      }
-      break;
-    }
-  }
+  size_t i = tc.find("=");
+  size_t brace = tc.find("{");
+  if (brace < i)
+    i = brace;
+  eraseRange(tc, i, tc.find(";", i));
   if (tc.length() > 0 && tc[tc.length() - 1] != ";")
     tc.push_back(";");
 }
@@ -386,19 +457,8 @@ void GrammarHelper::removeCppInitializers(Scanner::ITokCollection& tc)
 
 void GrammarHelper::removeCSharpInitializers(Scanner::ITokCollection& tc)
 {
-  std::string debug = tc.show();
-  for (size_t i = 0; i < tc.length(); ++i)
-  {
-    if (tc[i] == "=")
-    {
-      size_t j = i;
-      while (j < tc.length() && tc[j] != ";")
-      {
-        tc.remove(j);
-      }
-      break;
-    }
-  }
+  size_t i = tc.find("=");
+  eraseRange(tc, i, tc.find(";", i));
   if (tc.length() > 0 && tc[tc.length() - 1] != ";")
     tc.push_back(";");
 }
@@ -406,14 +466,8 @@ void GrammarHelper::removeCSharpInitializers(Scanner::ITokCollection& tc)
 
 void GrammarHelper::removeComments(Scanner::ITokCollection& tc)
 {
-  size_t i = 0;
-  while (true)
-  {
-    if (tc.isComment(tc[i]))
-      tc.remove(i);
-    if (++i == tc.length())
-      break;
-  }
+  const Scanner::ITokCollection& in = tc;
+  eraseIf(tc, [&in](size_t i) { return in.isComment(in[i]); });
 }
 //----< condense template spec to single token >---------------------
 
@@ -438,8 +492,7 @@ void GrammarHelper::condenseTemplateTypes(Scanner::ITokCollection& tc)
     if (tc[i] == "typename" || tc[i] == "class")
       tok += " ";
   }
-  for (size_t i = start; i < end + 1; ++i)
-    tc.remove(start);
+  eraseRange(tc, start, end + 1);
   if (save == ">::")
   {
     tok += tc[start + 1];
@@ -458,10 +511,9 @@ void GrammarHelper::removeFunctionArgs(Scanner::ITokCollection& tc)
   size_t end = tc.find(")");
   if (start >= end || end == tc.length() || start == 0)
     return;
-  if (GrammarHelper::isControlKeyWord(tc[start - 1]))
+  if (GrammarHelper::isControlKeyWord(tc, start - 1))
     return;
-  for (size_t i = start; i < end + 1; ++i)
-    tc.remove(start);
+  eraseRange(tc, start, end + 1);
   //std::cout << "\n  -- " << tc.show();
 }
 //----< show semiExp with Dbug logger >------------------------------
@@ -518,7 +570,7 @@ std::string showQualifiers(const SemiExp& se)
 {
   std::string temp;
   for (size_t i = 0; i < se.length(); ++i)
-    if (GrammarHelper::isQualifierKeyWord(se[i]))
+    if (GrammarHelper::isQualifierKeyWord(se, i))
       temp += se[i] + " ";
   return temp;
 }
@@ -585,6 +637,9 @@ void test(const SemiExp& seIn)
   GrammarHelper::removeFunctionArgs(testSE);
   std::cout << "\n    removing function args: " << show(testSE);
 
+  size_t posParen = 0;
+  std::cout << "\n    condensed declaration: " << show(GrammarHelper::condensedDeclaration(seIn, posParen));
+
   testSE.clone(seIn);
   GrammarHelper::removeCallingArgQualifiers(testSE);
   std::cout << "\n    removing qualifiers in function calling sequence: " << show(testSE);
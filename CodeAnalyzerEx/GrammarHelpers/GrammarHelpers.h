@@ -1,7 +1,7 @@
 #pragma once
 /////////////////////////////////////////////////////////////////////////
 // GrammarHelpers.h - Functions providing base grammatical analyses    //
-// ver 1.3                                                             //
+// ver 1.5                                                             //
 // Language:    C++, Visual Studio 2015                                //
 // Application: Support for Parsing, CSE687 - Object Oriented Design   //
 // Author:      Jim Fawcett, Syracuse University, CST 4-187            //
@@ -27,8 +27,22 @@
 *
 * Build Command: devenv Analyzer.sln /rebuild debug
 *
+* condensedDeclaration(se, posParen) returns the declaration view that
+* isDataDeclaration tests: template types condensed, qualifiers,
+* initializers, and function arguments removed.  The view of the last
+* SemiExp condensed is kept for each thread, so the declaration rules
+* and their actions don't each rebuild it from their own copies.
+*
 * Maintenance History:
 * --------------------
+* ver 1.5 : 14 Oct 2026
+* - removal functions erase with one pass over the tokens instead of
+*   one remove per token, removeComments removes adjacent comments
+* - added condensedDeclaration, isDataDeclaration uses its cached view
+* ver 1.4 : 14 Oct 2026
+* - keyword tests use the KeyWords bits SemiExp computes once per token,
+*   added isControlKeyWord and isQualifierKeyWord overloads taking a
+*   token position
 * ver 1.3 : 26 Feb 2017
 * - modified isFunctionDeclaration to support a bug fix in ActionsAndRules
 *   associated with failure to detect some public data declarations
@@ -42,8 +56,8 @@
 *
 * Planned Additions and Changes:
 * ------------------------------
-* - These functions may result in scanning a SemiExp instance several times.
-*   It should be straight forward to reduce some of that.
+* - These functions may still scan a SemiExp instance several times, e.g.,
+*   isFunctionDeclaration clones it for isFirstArgDeclaration.
 */
 
 
@@ -56,6 +70,7 @@ namespace CodeAnalysis
   {
   public:
     static bool isControlKeyWord(const std::string& tok);
+    static bool isControlKeyWord(const Scanner::ITokCollection& se, size_t n);
     static bool hasControlKeyWord(const Scanner::ITokCollection& se);
     static bool isFunction(const Scanner::ITokCollection& se);
     static bool hasArgs(const Scanner::ITokCollection& se);
@@ -67,6 +82,7 @@ namespace CodeAnalysis
     static bool isExecutable(const Scanner::ITokCollection& se, const std::string& parentType);
     static size_t findLast(const Scanner::ITokCollection& se, const std::string& token);
     static bool isQualifierKeyWord(const std::string& tok);
+    static bool isQualifierKeyWord(const Scanner::ITokCollection& se, size_t n);
     static void removeQualifiers(Scanner::ITokCollection& tc);
     static void removeCallingArgQualifiers(Scanner::ITokCollection& tc);
     static bool isFirstArgDeclaration(const Scanner::ITokCollection& tc, const std::string& parentType);
@@ -76,6 +92,7 @@ namespace CodeAnalysis
     static void removeComments(Scanner::ITokCollection& tc);
     static void condenseTemplateTypes(Scanner::ITokCollection& tc);
     static void removeFunctionArgs(Scanner::ITokCollection& tc);
+    static const Scanner::ITokCollection& condensedDeclaration(const Scanner::ITokCollection& tc, size_t& posParen);
     static void showParse(const std::string& msg, const Scanner::ITokCollection& se);
     static void showParseDemo(const std::string& msg, const Scanner::ITokCollection& se);
   };
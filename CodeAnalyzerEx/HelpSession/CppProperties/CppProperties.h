@@ -12,6 +12,10 @@
  * - fixed bug in Property class by adding copy constructor that only
  *   copies data member value.  The default copy constructor copies
  *   all memebers including getter_ and setter_
+ * - added copy assignment that only copies value, for the same reason,
+ *   and ref(), a const reference to value, so readers of a large value,
+ *   e.g., a vector of children, don't copy it.  ref() doesn't call a
+ *   custom getter.
 */
 #include <iostream>
 #include <functional>
@@ -29,6 +33,7 @@ public:
 
   Property() : value(T()) {}
   Property(const Property<T>& p) : value(p.value) {}  // added this fix
+  Property<T>& operator=(const Property<T>& p) { value = p.value; return *this; }
   Property(const T& t) : value(t) {}
   virtual ~Property() {}
   
@@ -43,6 +48,7 @@ public:
   // get the property field with cast operator
 
   virtual operator const T() const { return getter_(); }
+  const T& ref() const { return value; }                // value, without a copy
   
   // define methods to customize getter and setter behaviors
 
@@ -1,15 +1,34 @@
 ///////////////////////////////////////////////////////////////////
 // Persist.cpp:  stores elements in database to XML file         //
-// ver 1.0                                                       //
+// ver 1.3                                                       //
 // Application: Key Value DataBase, Spring 2017                  //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project1             //
 //              cjupalli@syr.edu                                 //
 ///////////////////////////////////////////////////////////////////
-
+/*
+* XML made here is an export, for people and other tools to read.  To
+* save a database and load it again, use Snapshot, in NoSqlDb/Snapshot.h.
+*
+* Maintenance History:
+* --------------------
+* Ver 1.3 : 14 Oct 2026
+* - test stub times XmlDocument::toString against XmlWriter on a
+*   100,000 element database
+* - toXml doesn't pass string data through an ostringstream
+* Ver 1.2 : 14 Oct 2026
+* - toXml builds an ArenaDocument, nodes in one array, instead of an
+*   XmlDocument of shared_ptr nodes.  The XML text is the same
+* Ver 1.1 : 14 Oct 2026
+* - toXml looks up each element once, through find, instead of copying
+*   it out of the database for every field
+* Ver 1.0 : 7 February 2017
+* - first release
+*/
 
 #include "../XmlDocument/XmlDocument/XmlDocument.h"
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlDocument/ArenaDocument.h"
 #if 0
 #include "../CppProperties/CppProperties.h"
 #endif
@@ -18,6 +37,7 @@
 #include  "../NoSqlDb/NoSqlDb.h"
 #include <iostream>
 #include <fstream>
+#include <chrono>
 
 using namespace XmlProcessing;
 using SPtr = std::shared_ptr<AbstractXmlElement>;
@@ -27,50 +47,31 @@ using Key = NoSqlDb<StrData>::Key;
 using Keys = NoSqlDb<StrData>::Keys;
 
 
+//data as XML text, strings as they are, other types through Convert
+inline const std::string& dataText(const std::string& data) { return data; }
+template<typename T>
+std::string dataText(const T& data) { return Convert<T>::toString(data); }
+
 template<typename Data>
 std::string toXml(NoSqlDb<Data>& db)
 {
 	title("Creating XmlDocument and storing it in Project folder");
-	SPtr pRoot = makeTaggedElement("DataBase");
-	XmlDocument doc(XmlProcessing::makeDocElement(pRoot));
-    Keys ikeys2 = db.keys();
-  for (Key key1 : ikeys2)
-  {
-	  //std::cout << "\n" << key1 << ":";// << db.value(key1).show();
-
-		  SPtr child1 = makeTaggedElement(db.value(key1).name);
-		  SPtr TagName = makeTaggedElement("Name");
-		  TagName->addChild(makeTextElement(db.value(key1).name));
-		  child1->addChild(TagName);
-		  
-
-		  SPtr TagCategory = makeTaggedElement("Category");
-		  TagCategory->addChild(makeTextElement(db.value(key1).category));
-		  child1->addChild(TagCategory);
-
-		  SPtr TagDateAdded = makeTaggedElement("DateAdded");
-		  TagDateAdded->addChild(makeTextElement(db.value(key1).timeDate));
-		  child1->addChild(TagDateAdded);
-
-		  SPtr TagData = makeTaggedElement("Data");
-		  TagData->addChild(makeTextElement(db.value(key1).data));
-		  child1->addChild(TagData);
-
-		  SPtr ChildrenToElement = makeTaggedElement("Children");
-		  std::vector<std::string> te = db.value(key1).children;
-		  for (int i = 0; i < (int)te.size(); i++) {
-			  ChildrenToElement->addChild(makeTextElement(te[i]));
-		  }
-		  child1->addChild(ChildrenToElement);
-		  pRoot->addChild(child1);
-  }
-  
-	std::string xml = doc.toString();  
-	//std::ofstream myXmlFile;//create file
-	//myXmlFile.open("XmlPersist.xml");
-	//myXmlFile << xml;
-	//myXmlFile.close();
-   return xml;
+	using Node = ArenaDocument::Node;
+	ArenaDocument doc;
+	doc.reserve(2 + 11 * db.count(), 0);       // 11 nodes for an element with one child
+	Node root = doc.addTagged(doc.docElement(), "DataBase");
+	db.forEach([&doc, root](const Key&, const Element<Data>& elem) {
+		const std::string& name = elem.name.ref();
+		Node child1 = doc.addTagged(root, name);
+		doc.addText(doc.addTagged(child1, "Name"), name);
+		doc.addText(doc.addTagged(child1, "Category"), elem.category.ref());
+		doc.addText(doc.addTagged(child1, "DateAdded"), elem.timeDate.ref());
+		doc.addText(doc.addTagged(child1, "Data"), dataText(elem.data.ref()));
+		Node children = doc.addTagged(child1, "Children");
+		for (const std::string& child : elem.children.ref())
+			doc.addText(children, child);
+	});
+	return doc.toString();
 }
 
 
@@ -101,7 +102,7 @@ std::string toXmldemo(NoSqlDb<Data>& db)
 		child1->addChild(grandChild12);
 		pRoot->addChild(child1);
 	}
-	xml = doc.toString();
+	std::string xml = doc.toString();
 	std::ofstream myXmlFile;//create file
 	myXmlFile.open("../xml.txt");
 	myXmlFile << xml;
@@ -109,8 +110,71 @@ std::string toXmldemo(NoSqlDb<Data>& db)
 	return xml;
 }
 
+//----< time XmlDocument::toString, XmlWriter, and toXml on n elements >----
+
+void benchmarkWriters(size_t n)
+{
+	title("Serializing a " + std::to_string(n) + " element DB");
+	using Clock = std::chrono::high_resolution_clock;
+	auto ms = [](Clock::time_point t0) { return std::chrono::duration<double, std::milli>(Clock::now() - t0).count(); };
+	NoSqlDb<StrData> db;
+	db.reserve(n);
+	for (size_t i = 0; i < n; ++i) {
+		Element<StrData> elem;
+		elem.name = "elem" + std::to_string(i);
+		elem.category = "test & bench";
+		elem.timeDate = __TIMESTAMP__;
+		elem.data = "data of <elem" + std::to_string(i) + ">";
+		elem.children = std::vector<std::string>{ "elem" + std::to_string(i / 2), "elem" + std::to_string(i / 3) };
+		db.save(elem.name, elem);
+	}
+	Clock::time_point t0 = Clock::now();
+	SPtr pRoot = makeTaggedElement("DataBase");
+	XmlDocument doc(XmlProcessing::makeDocElement(pRoot));
+	db.forEach([&pRoot](const Key&, const Element<StrData>& elem) {
+		SPtr pElem = makeTaggedElement(elem.name);
+		const char* fields[] = { "Name", "Category", "DateAdded", "Data" };
+		const std::string* values[] = { &elem.name.ref(), &elem.category.ref(), &elem.timeDate.ref(), &elem.data.ref() };
+		for (int f = 0; f < 4; ++f) {
+			SPtr pField = makeTaggedElement(fields[f]);
+			pField->addChild(makeTextElement(*values[f]));
+			pElem->addChild(pField);
+		}
+		SPtr pChildren = makeTaggedElement("Children");
+		for (const std::string& child : elem.children.ref())
+			pChildren->addChild(makeTextElement(child));
+		pElem->addChild(pChildren);
+		pRoot->addChild(pElem);
+	});
+	std::cout << "\n  building the XmlDocument:      " << ms(t0) << " ms";
+	t0 = Clock::now();
+	std::string byToString = doc.toString();
+	std::cout << "\n  XmlDocument::toString:        " << ms(t0) << " ms, " << byToString.size() << " bytes";
+	t0 = Clock::now();
+	std::string byWriter;
+	byWriter.reserve(byToString.size());
+	{
+		XmlWriter writer(byWriter);
+		writer.write(*doc.docElement());
+	}
+	std::cout << "\n  XmlWriter into one string:    " << ms(t0) << " ms, same text: " << (byWriter == byToString ? "yes" : "no");
+	t0 = Clock::now();
+	{
+		std::ofstream file("../Benchmark.xml", std::ios::binary);
+		XmlWriter writer(file, true);
+		writer.write(*doc.docElement());
+		writer.flush();
+		std::cout << "\n  XmlWriter to file, escaped:   " << ms(t0) << " ms, " << writer.bytes() << " bytes";
+	}
+	t0 = Clock::now();
+	std::string byToXml = toXml(db);
+	std::cout << "\n  toXml, ArenaDocument:         " << ms(t0) << " ms, built and written";
+}
+
 int main()
 {
+	benchmarkWriters(100000);
+
 	NoSqlDb<StrData> db;
 	Element<StrData> elem1;
 	elem1.name = "elem1";
@@ -0,0 +1,327 @@
+#pragma once
+////////////////////////////////////////////////////////////////////////////////
+// ElementCodec.h: compact binary encoding of NoSqlDb elements, for messages //
+// Application: Key Value DataBase, Spring 2017                               //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                       //
+// Author:      Chandra Harsha Jupalli, CSE687 - OOD,Spring 2017              //
+//              cjupalli@syr.edu                                              //
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* This package provides template class ElementCodec, which encodes a set of
+* elements, each with its key, as a string of bytes to send in a message, and
+* decodes them again.  Snapshot is the format to restart from, laid out to
+* be checked and read in place; this one is made to be small, for query
+* answers a server sends, so it is read front to back.
+*
+*   magic        "NSE" and the format version, one byte
+*   count        varint, of elements
+*   element      key, name, category, timeDate, data, a varint count of
+*                children, and the children
+*
+* Numbers are varints, seven bits a byte, the low bits first, the high bit
+* set on every byte but the last.  Every string is a reference: 0 and then
+* the string, its length as a varint and its bytes, the first time it is
+* seen, and its index + 1 after that, strings numbered as they are met.  A
+* dependency answer names each file once, as a key or a child, however many
+* files depend on it, and refers to it with a byte or two everywhere else.
+*
+* Data must be std::string, encoded as a reference, or a trivially copyable
+* type, copied as raw bytes.  decode checks every count and reference
+* against the bytes it is given, and gives no elements unless all are good.
+*
+* PublicInterface
+* ----------------
+* std::string ElementCodec<Data>::encode(const Items& items)                 //items, in order
+* std::string ElementCodec<Data>::encode(const NoSqlDb<Data>& db, keys)      //keys db holds, in order
+* bool ElementCodec<Data>::decode(const std::string& bytes, Items& items)    //false if bytes aren't an encoding
+* void ElementCodec<Data>::putVarint(std::string& out, uint64_t value)
+* bool ElementCodec<Data>::getVarint(const char*& p, const char* end, uint64_t& value)
+*
+* Required Files:
+* ---------------
+*   - NoSqlDb.h, CppProperties.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyserEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "NoSqlDb.h"
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////
+// ElementCodec encodes and decodes keyed elements with a string
+// reference table built as they are written
+
+template<typename Data>
+class ElementCodec
+{
+public:
+  using Key = std::string;
+  using Keys = std::vector<Key>;
+  using Item = std::pair<Key, Element<Data>>;
+  using Items = std::vector<Item>;
+
+  static std::string encode(const Items& items);
+  static std::string encode(const NoSqlDb<Data>& db, const Keys& keys);
+  static bool decode(const std::string& bytes, Items& items);
+  static void putVarint(std::string& out, uint64_t value);
+  static bool getVarint(const char*& p, const char* end, uint64_t& value);
+
+  static const unsigned char formatVersion = 1;
+private:
+  /////////////////////////////////////////////////////////////////
+  // Writer refers to each distinct string by its index once written
+
+  class Writer
+  {
+  public:
+    void put(const std::string& s);
+    void put(const Key& key, const Element<Data>& elem);
+    std::string out;
+  private:
+    template<typename T>
+    void putData(const T& data);
+    void putData(const std::string& data) { put(data); }
+    std::unordered_map<std::string, uint64_t> indexes_;
+  };
+
+  /////////////////////////////////////////////////////////////////
+  // Reader takes strings and references in the order Writer wrote them
+
+  class Reader
+  {
+  public:
+    Reader(const std::string& bytes) : p_(bytes.data()), end_(bytes.data() + bytes.size()) {}
+    bool get(std::string& s);
+    bool get(Item& item);
+    bool number(uint64_t& value) { return getVarint(p_, end_, value); }
+    bool magic();
+    bool done() const { return p_ == end_; }
+  private:
+    template<typename T>
+    bool getData(Property<T>& data);
+    bool getData(Property<std::string>& data);
+    const char* p_;
+    const char* end_;
+    std::vector<std::string> strings_;
+  };
+
+  static void putMagic(std::string& out);
+};
+
+template<typename Data>
+void ElementCodec<Data>::putVarint(std::string& out, uint64_t value)
+{
+  while (value >= 0x80)
+  {
+    out += (char)((value & 0x7f) | 0x80);
+    value >>= 7;
+  }
+  out += (char)value;
+}
+
+//getVarint reads a varint from p, false if it runs past end or past 64 bits
+template<typename Data>
+bool ElementCodec<Data>::getVarint(const char*& p, const char* end, uint64_t& value)
+{
+  value = 0;
+  for (unsigned shift = 0; p < end && shift < 64; shift += 7)
+  {
+    unsigned char byte = (unsigned char)*p++;
+    value |= (uint64_t)(byte & 0x7f) << shift;
+    if ((byte & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+template<typename Data>
+void ElementCodec<Data>::putMagic(std::string& out)
+{
+  out += "NSE";
+  out += (char)formatVersion;
+}
+
+//a string is written once, later writes of it are its index + 1
+template<typename Data>
+void ElementCodec<Data>::Writer::put(const std::string& s)
+{
+  auto iter = indexes_.find(s);
+  if (iter != indexes_.end())
+  {
+    putVarint(out, iter->second + 1);
+    return;
+  }
+  indexes_.emplace(s, (uint64_t)indexes_.size());
+  putVarint(out, 0);
+  putVarint(out, s.size());
+  out += s;
+}
+
+template<typename Data>
+template<typename T>
+void ElementCodec<Data>::Writer::putData(const T& data)
+{
+  static_assert(std::is_trivially_copyable<T>::value, "ElementCodec Data must be std::string or trivially copyable");
+  out.append(reinterpret_cast<const char*>(&data), sizeof(T));
+}
+
+template<typename Data>
+void ElementCodec<Data>::Writer::put(const Key& key, const Element<Data>& elem)
+{
+  put(key);
+  put(elem.name.ref());
+  put(elem.category.ref());
+  put(elem.timeDate.ref());
+  putData(elem.data.ref());
+  const std::vector<std::string>& children = elem.children.ref();
+  putVarint(out, children.size());
+  for (const std::string& child : children)
+    put(child);
+}
+
+template<typename Data>
+bool ElementCodec<Data>::Reader::magic()
+{
+  if (end_ - p_ < 4 || std::memcmp(p_, "NSE", 3) != 0 || (unsigned char)p_[3] != formatVersion)
+    return false;
+  p_ += 4;
+  return true;
+}
+
+//get reads a reference, and the string itself the first time
+template<typename Data>
+bool ElementCodec<Data>::Reader::get(std::string& s)
+{
+  uint64_t ref, size;
+  if (!number(ref))
+    return false;
+  if (ref > 0)
+  {
+    if (ref > strings_.size())
+      return false;
+    s = strings_[(size_t)(ref - 1)];
+    return true;
+  }
+  if (!number(size) || size > (uint64_t)(end_ - p_))
+    return false;
+  s.assign(p_, (size_t)size);
+  p_ += size;
+  strings_.push_back(s);
+  return true;
+}
+
+template<typename Data>
+template<typename T>
+bool ElementCodec<Data>::Reader::getData(Property<T>& data)
+{
+  if ((size_t)(end_ - p_) < sizeof(T))
+    return false;
+  T value;
+  std::memcpy(&value, p_, sizeof(T));
+  p_ += sizeof(T);
+  data = value;
+  return true;
+}
+
+template<typename Data>
+bool ElementCodec<Data>::Reader::getData(Property<std::string>& data)
+{
+  std::string value;
+  if (!get(value))
+    return false;
+  data = value;
+  return true;
+}
+
+template<typename Data>
+bool ElementCodec<Data>::Reader::get(Item& item)
+{
+  std::string name, category, timeDate;
+  uint64_t children;
+  if (!get(item.first) || !get(name) || !get(category) || !get(timeDate) || !getData(item.second.data))
+    return false;
+  item.second.name = name;
+  item.second.category = category;
+  item.second.timeDate = timeDate;
+  if (!number(children) || children > (uint64_t)(end_ - p_))   // each child takes a byte at least
+    return false;
+  std::vector<std::string> kids((size_t)children);
+  for (std::string& child : kids)
+  {
+    if (!get(child))
+      return false;
+  }
+  item.second.children = kids;
+  return true;
+}
+
+template<typename Data>
+std::string ElementCodec<Data>::encode(const Items& items)
+{
+  Writer writer;
+  putMagic(writer.out);
+  putVarint(writer.out, items.size());
+  for (const Item& item : items)
+    writer.put(item.first, item.second);
+  return writer.out;
+}
+
+//encode writes the elements of keys db holds, in the order of keys, without copying them
+template<typename Data>
+std::string ElementCodec<Data>::encode(const NoSqlDb<Data>& db, const Keys& keys)
+{
+  std::vector<const Element<Data>*> found;
+  Keys foundKeys;
+  for (const Key& key : keys)
+  {
+    const Element<Data>* pElem = db.find(key);
+    if (pElem == nullptr)
+      continue;
+    found.push_back(pElem);
+    foundKeys.push_back(key);
+  }
+  Writer writer;
+  putMagic(writer.out);
+  putVarint(writer.out, found.size());
+  for (size_t i = 0; i < found.size(); ++i)
+    writer.put(foundKeys[i], *found[i]);
+  return writer.out;
+}
+
+//decode fills items with the encoded elements, leaving it empty if bytes aren't one encoding
+template<typename Data>
+bool ElementCodec<Data>::decode(const std::string& bytes, Items& items)
+{
+  items.clear();
+  Reader reader(bytes);
+  uint64_t count;
+  if (!reader.magic() || !reader.number(count) || count > bytes.size())   // each element takes bytes
+    return false;
+  Items decoded((size_t)count);
+  for (Item& item : decoded)
+  {
+    if (!reader.get(item))
+      return false;
+  }
+  if (!reader.done())
+    return false;
+  items = std::move(decoded);
+  return true;
+}
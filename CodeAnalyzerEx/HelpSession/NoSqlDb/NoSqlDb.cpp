@@ -11,6 +11,10 @@
 #include <iostream>
 #include "../DbToXml/persist.cpp"
 #include "../Queries/Queries.h"     
+#include "Snapshot.h"
+#include "WriteAheadLog.h"
+#include "ShardedDb.h"
+#include <thread>
 #include <fstream>
 #include <algorithm>
 
@@ -154,9 +158,64 @@ void XmlToAndFro(NoSqlDb<StrData>& db)
 	cout << "\n\n--- Creating an Xml named PersistXml.xml in location ../debug with DB elements and Displaying Xml String-----\n\n";
 	string xml = toXml(db);
 	std::cout << xml;
+	cout << "\n\n--- Saving DB elements to snapshot DataBase.snap and loading them into a new DB-----\n";
+	NoSqlDb<StrData> restored;
+	if (Snapshot<StrData>::save(db, "DataBase.snap") && Snapshot<StrData>::load(restored, "DataBase.snap")) {
+		Keys rkeys = restored.keys();
+		for (Key key : rkeys) {
+			std::cout << "\n  " << key << ":";
+			std::cout << restored.value(key).show();
+		}
+	}
+	else
+		cout << "\n  snapshot could not be saved or loaded";
+}
+
+//Function to demonstrate logging changes and recovering them after a restart
+void LogAndRecover(NoSqlDb<StrData>& db)
+{
+	cout << "\n\n--- Logging changes to DataBase.log.<n> and recovering them into a new DB-----\n";
+	{
+		NoSqlDb<StrData> logged;
+		WriteAheadLog<StrData> wal(logged, "DataBase");
+		if (!wal.open()) {
+			cout << "\n  log could not be written";
+			return;
+		}
+		Keys keys = db.keys();
+		for (Key key : keys)
+			logged.save(key, db.value(key));
+		wal.compact();
+		logged.remove(keys.empty() ? Key() : keys.front());
+	}
+	NoSqlDb<StrData> recovered;
+	WriteAheadLog<StrData> wal(recovered, "DataBase");
+	wal.open();
+	cout << "\n  recovered " << recovered.count() << " elements, " << wal.replayed() << " from the log";
 }
 
 //Function to demonstrate queries being implemented 
+void ConcurrentWriters(NoSqlDb<StrData>& db)
+{
+	cout << "\n\n--- Four threads saving copies of the DB elements into a ShardedDb-----\n";
+	ShardedDb<StrData> sharded;
+	Keys keys = db.keys();
+	std::vector<std::thread> writers;
+	for (int t = 0; t < 4; ++t)
+		writers.push_back(std::thread([&, t]() {
+			for (Key key : keys)
+				sharded.save(key + "#" + std::to_string(t), db.value(key));
+		}));
+	for (std::thread& writer : writers)
+		writer.join();
+	size_t children = 0;
+	sharded.forEach([&children](const Key&, const Element<StrData>& elem) { children += elem.children.ref().size(); });
+	cout << "\n  " << sharded.count() << " elements saved, with " << children << " children";
+	NoSqlDb<StrData> merged;
+	sharded.moveInto(merged);
+	cout << "\n  " << merged.count() << " elements moved into a NoSqlDb";
+}
+
 void queriesDemonstration(NoSqlDb<StrData>& db,Element<StrData>& elem1,Element<StrData>& elem2) {
 	Queries q;
 	cout << "\n\n\n******************** requirement7 Queries************************";
@@ -258,6 +317,8 @@ int main(){
 		UpdateAndDelete(db, elem2, count, child);
 		XmlToAndFro(db);
 		queriesDemonstration(db, elem1, elem2);
+		LogAndRecover(db);
+		ConcurrentWriters(db);
 		cout << "\n DataBase Structure Xml file is stored in location ../debug as DataBaseStructure.xml\n";
 	}
 	catch (...) {
@@ -17,9 +17,34 @@
 * ----------------
 * std::string Element<Data>::show()                                            //Display elements in database
 * bool NoSqlDb<Data>::Delete(Key key)
+* bool NoSqlDb<Data>::remove(Key key)                                         //Delete without console messages
+* void NoSqlDb<Data>::setJournal(journal)                                      //journal(op, key, pElem) after each change
 * bool NoSqlDb<Data>::save(Key key, Element<Data> elem)
 * Element<Data> NoSqlDb<Data>::value(Key key)                                  //Display Value of given key
+* const Element<Data>* NoSqlDb<Data>::find(const Key& key)                      //no copy, nullptr if no key
 * size_t NoSqlDb<Data>::count()
+* void NoSqlDb<Data>::forEach(visit)                                           //visit(key, element) for each element, in place
+* void NoSqlDb<Data>::reserve(n)                                               //room for n elements, before a bulk load
+* const NoSqlDb<Data>::Index& NoSqlDb<Data>::nameIndex()                       //name -> keys
+* const NoSqlDb<Data>::Index& NoSqlDb<Data>::categoryIndex()                   //category -> keys
+* Keys NoSqlDb<Data>::keysInTime(time1, time2)                                 //timeDate in [time1, time2]
+* size_t NoSqlDb<Data>::version()                                              //changes on every save, Update, Delete
+* Keys NoSqlDb<Data>::dependents(key)                                           //keys whose children hold key
+* Keys NoSqlDb<Data>::dependentsWithin(key, depth)                              //transitive, up to depth links
+* const std::vector<Keys>& NoSqlDb<Data>::cycles()                              //strongly connected components
+* const Keys* NoSqlDb<Data>::cycleOf(key)                                       //key's cycle, nullptr if none
+*
+* save, Update, and Delete keep the name, category, and timeDate indexes
+* current, so queries read the store in place instead of copying it.
+* The timeDate index is sorted on timeKey(timeDate), which turns the
+* __TIMESTAMP__ form, "Sun Feb  5 10:31:07 2017", into "2017-02-05 10:31:07".
+*
+* children are forward edges, e.g., the files a file depends on.  The
+* database also keeps the reverse edges, so "who depends on this" is a
+* lookup, not a scan of every element.  cycles() holds the components
+* of the children graph that have more than one key, or a key that is
+* its own child.  They are found with Tarjan's algorithm the first time
+* they are asked for after a change, and kept until the next change.
 *
 *
 *
@@ -27,6 +52,8 @@
 * ---------------
 *   - CppProperties.h,CppProperties.cpp
 *   - XmlDocument.h, XmlDocument.cpp, XmlElement.h, XmlElement.cpp
+*   - XmlParser.h, XmlParser.cpp
+*   - Utilities.h
 
 * Build Process:
 * --------------
@@ -34,12 +61,42 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.6 : 14 Oct 2026
+* - ReadFromXml's fields are trimmed with StringHelper::trimView and children
+*   split in place, instead of copying the text and each line to trim them
+* Ver 1.5 : 14 Oct 2026
+* - ReadFromXml streams the file through XmlStreamParser and saves each
+*   element as it ends, instead of reading the file into a string and
+*   building an XmlDocument of it.  Data other than strings is converted
+*   with Convert<Data>
+* Ver 1.4 : 14 Oct 2026
+* - added setJournal, called with 's', 'u', or 'd' after every save,
+*   Update, or Delete that changed the store, for WriteAheadLog
+* - added remove, Delete without its console messages
+* Ver 1.3 : 14 Oct 2026
+* - added forEach and reserve, count is const, for Snapshot
+* Ver 1.2 : 14 Oct 2026
+* - added reverse edge index, maintained by save, Update, and Delete
+* - added dependents, dependentsWithin, cycles, and cycleOf
+* - loops over the store bind its items by reference, not as copies
+* Ver 1.1 : 14 Oct 2026
+* - added find, name and category indexes, and a sorted timeDate index,
+*   all maintained by save, Update, and Delete
+* - added version, so clients can cache what they derive from the store
+* - save and Update copy construct elements into the store, Property's
+*   assignment copies the getter that refers to the source element
 * Ver 1.0 : 7 February 2017
 * - first release
 *
 */
 
 #include <unordered_map>
+#include <unordered_set>
+#include <map>
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <algorithm>
 #include <string>
 #include <sstream>
 #include <vector>
@@ -49,7 +106,9 @@
 #include "../XmlDocument/XmlDocument/XmlDocument.h"
 #include "../Convert/Convert.h"
 #include "../StrHelper.h"
+#include "../../Utilities/Utilities.h"
 #include "../XmlDocument/XmlElement/XmlElement.h"
+#include "../XmlDocument/XmlParser/XmlParser.h"
 #include <ctime>
 #include <fstream>
 
@@ -108,18 +167,134 @@ class NoSqlDb
 public:
   using Key = std::string;
   using Keys = std::vector<Key>;
+  using Index = std::unordered_map<std::string, std::unordered_set<Key>>;
+  using Journal = std::function<void(char op, const Key& key, const Element<Data>* pElem)>;
 
   Keys keys();
   bool save(Key key, Element<Data> elem);
   bool Delete(Key key);
+  bool remove(Key key);
+  void setJournal(Journal journal) { journal_ = journal; }
   void Update(Key key, Element<Data> elem);
   Element<Data> value(Key key);
-  size_t count();
+  const Element<Data>* find(const Key& key) const;
+  size_t count() const;
+  template<typename Visit>
+  void forEach(Visit visit) const;
+  void reserve(size_t n);
   void ReadFromXml(std::string xml);
+  const Index& nameIndex() const { return byName; }
+  const Index& categoryIndex() const { return byCategory; }
+  Keys keysInTime(const std::string& time1, const std::string& time2) const;
+  static std::string timeKey(const std::string& timeDate);
+  size_t version() const { return changes; }
+  Keys dependents(const Key& key) const;
+  Keys dependentsWithin(const Key& key, size_t depth) const;
+  const std::vector<Keys>& cycles() const;
+  const Keys* cycleOf(const Key& key) const;
 private:
   using Item = std::pair<Key, Element<Data>>;
+  class XmlLoader;
+
+  void index(const Key& key, const Element<Data>& elem);
+  void unindex(const Key& key, const Element<Data>& elem);
+  void changed();
+  void findCycles() const;
+
+  size_t changes = 0;
+  Journal journal_;
 
   std::unordered_map<Key,Element<Data>> store; 
+  Index byName;
+  Index byCategory;
+  std::multimap<std::string, Key> byTime;
+  Index parents;
+  mutable bool cyclesFound = false;
+  mutable std::vector<Keys> sccs;
+  mutable std::unordered_map<Key, size_t> sccOf;
+};
+
+/////////////////////////////////////////////////////////////////////
+// XmlLoader saves each <Nodes> element, ReadFromXml's format, as it
+// is parsed, so only one element is held at a time
+// - a Nodes element holds Name, Category, DateAdded, Data, Children,
+//   and Data fields, in that order, Children one child key per line
+template<typename Data>
+class NoSqlDb<Data>::XmlLoader : public XmlProcessing::IXmlHandler
+{
+public:
+  XmlLoader(NoSqlDb<Data>& db) : db_(db) {}
+  void startElement(const std::string& tag, const attribs&)
+  {
+    ++depth_;
+    if (tag == "Nodes" && nodeDepth_ == 0)
+    {
+      nodeDepth_ = depth_;
+      field_ = -1;
+      elem_ = Element<Data>();
+    }
+    else if (nodeDepth_ != 0 && depth_ == nodeDepth_ + 1)
+    {
+      ++field_;
+      text_.clear();
+    }
+  }
+  void text(const std::string& text)
+  {
+    if (nodeDepth_ != 0 && depth_ == nodeDepth_ + 1)
+      text_ += text;
+  }
+  void endElement(const std::string&)
+  {
+    if (nodeDepth_ != 0 && depth_ == nodeDepth_ + 1)
+      setField();
+    else if (depth_ == nodeDepth_)
+    {
+      nodeDepth_ = 0;
+      db_.save(elem_.name, elem_);
+    }
+    --depth_;
+  }
+private:
+  // fields are trimmed as views of text_, and children split in place, so
+  // the only strings made are the ones given to elem_'s properties
+  void setField()
+  {
+    using Utilities::StringView;
+    using Utilities::StringHelper;
+    StringView value = StringHelper::trimView(text_);
+    switch (field_)
+    {
+    case 0: elem_.name = value.str(); break;
+    case 1: elem_.category = value.str(); break;
+    case 2: elem_.timeDate = value.str(); break;
+    case 3: case 5: setData(elem_, value); break;
+    case 4:
+    {
+      std::vector<std::string> children;
+      for (size_t pos = 0; pos < value.size(); )
+      {
+        size_t end = value.find('\n', pos);
+        if (end == StringView::npos)
+          end = value.size();
+        children.push_back(StringHelper::trimView(value.substr(pos, end - pos)).str());
+        pos = end + 1;
+      }
+      elem_.children = children;
+      break;
+    }
+    }
+  }
+  static void setData(Element<std::string>& elem, Utilities::StringView value) { elem.data = value.str(); }
+  template<typename T>
+  static void setData(Element<T>& elem, Utilities::StringView value) { elem.data = Convert<T>::fromString(value.str()); }
+
+  NoSqlDb<Data>& db_;
+  Element<Data> elem_;
+  std::string text_;
+  size_t depth_ = 0;
+  size_t nodeDepth_ = 0;
+  int field_ = -1;
 };
 
 //keys of dataBase are stored in a collection 
@@ -127,7 +302,8 @@ template<typename Data>
 typename NoSqlDb<Data>::Keys NoSqlDb<Data>::keys()
 {
   Keys keys;
-  for (Item item : store)
+  keys.reserve(store.size());
+  for (const auto& item : store)
   {
     keys.push_back(item.first);
   }
@@ -139,9 +315,13 @@ template<typename Data>
 bool NoSqlDb<Data>::save(Key key, Element<Data> elem)
 {
 
-  if(store.find(key) != store.end())
+  auto result = store.emplace(key, elem);
+  if (!result.second)
     return false;
-  store[key] = elem;
+  index(key, result.first->second);
+  changed();
+  if (journal_)
+    journal_('s', key, &result.first->second);
   return true;
 }
 
@@ -149,9 +329,16 @@ bool NoSqlDb<Data>::save(Key key, Element<Data> elem)
 template<typename Data>
 void NoSqlDb<Data>::Update(Key key, Element<Data> elem)
 {
-	    if(store.find(key)!=store.end())
-		store[key] = elem;
-		
+	auto iter = store.find(key);
+	if (iter == store.end())
+		return;
+	unindex(key, iter->second);
+	store.erase(iter);
+	const Element<Data>& stored = store.emplace(key, elem).first->second;
+	index(key, stored);
+	changed();
+	if (journal_)
+		journal_('u', key, &stored);
 }
 
 
@@ -159,39 +346,316 @@ void NoSqlDb<Data>::Update(Key key, Element<Data> elem)
 template<typename Data>
 bool NoSqlDb<Data>::Delete(Key key)
 {
-	if (store.find(key) ==store.end()) {
-		cout << "\n There is no element with entered key \n";
+	if (!remove(key)) {
+		std::cout << "\n There is no element with entered key \n";
 		return false;
 	}
 	else {
-		store.erase(key);
-		cout << "\n Element was deleted";
+		std::cout << "\n Element was deleted";
 		return true;
 	}
 }
 
+//remove erases an element as Delete does, without writing to the console
+template<typename Data>
+bool NoSqlDb<Data>::remove(Key key)
+{
+	auto iter = store.find(key);
+	if (iter == store.end())
+		return false;
+	unindex(key, iter->second);
+	store.erase(iter);
+	changed();
+	if (journal_)
+		journal_('d', key, nullptr);
+	return true;
+}
+
 template<typename Data>
 Element<Data> NoSqlDb<Data>::value(Key key)
 {
-  if (store.find(key) != store.end())
-    return store[key];
+  auto iter = store.find(key);
+  if (iter != store.end())
+    return iter->second;
   return Element<Data>();
 }
 
+//find returns the stored element without copying it, nullptr if there is no such key
+template<typename Data>
+const Element<Data>* NoSqlDb<Data>::find(const Key& key) const
+{
+  auto iter = store.find(key);
+  if (iter == store.end())
+    return nullptr;
+  return &iter->second;
+}
+
 //count function returns the number of elements in the database
 template<typename Data>
-size_t NoSqlDb<Data>::count()
+size_t NoSqlDb<Data>::count() const
 {
   return store.size();
 }
 
+//reserve makes room for n elements in the store and its indexes, so a bulk load doesn't rehash
+template<typename Data>
+void NoSqlDb<Data>::reserve(size_t n)
+{
+  store.reserve(n);
+  byName.reserve(n);
+  parents.reserve(n);
+}
+
+//forEach calls visit(key, element) for every element, without copying them
+template<typename Data>
+template<typename Visit>
+void NoSqlDb<Data>::forEach(Visit visit) const
+{
+  for (const auto& item : store)
+    visit(item.first, item.second);
+}
+
+//keysInTime returns keys with timeDate in [time1, time2], an empty bound is open
+template<typename Data>
+typename NoSqlDb<Data>::Keys NoSqlDb<Data>::keysInTime(const std::string& time1, const std::string& time2) const
+{
+  Keys keys;
+  auto first = time1.empty() ? byTime.begin() : byTime.lower_bound(timeKey(time1));
+  auto last = time2.empty() ? byTime.end() : byTime.upper_bound(timeKey(time2));
+  for (auto iter = first; iter != last; ++iter)
+    keys.push_back(iter->second);
+  return keys;
+}
+
+//timeKey orders timeDates, "Sun Feb  5 10:31:07 2017" becomes "2017-02-05 10:31:07"
+//- any other form is returned unchanged, so ISO dates order as they are
+template<typename Data>
+std::string NoSqlDb<Data>::timeKey(const std::string& timeDate)
+{
+  static const std::string months = "JanFebMarAprMayJunJulAugSepOctNovDec";
+  std::string fields[5];
+  size_t count = 0, i = 0;
+  while (i < timeDate.size())
+  {
+    if (timeDate[i] == ' ') { ++i; continue; }
+    size_t end = timeDate.find(' ', i);
+    if (end == std::string::npos)
+      end = timeDate.size();
+    if (count == 5)
+      return timeDate;
+    fields[count++] = timeDate.substr(i, end - i);
+    i = end;
+  }
+  const std::string& month = fields[1];
+  const std::string& day = fields[2];
+  size_t pos = months.find(month);
+  if (count != 5 || month.size() != 3 || pos == std::string::npos || pos % 3 != 0 ||
+    day.empty() || day.size() > 2 || fields[4].size() != 4)
+    return timeDate;
+  std::string key = fields[4] + "-";
+  key += (char)('0' + (pos / 3 + 1) / 10);
+  key += (char)('0' + (pos / 3 + 1) % 10);
+  key += day.size() == 1 ? "-0" : "-";
+  key += day + " " + fields[3];
+  return key;
+}
+
+//index adds a stored element to the name, category, and timeDate indexes
+template<typename Data>
+void NoSqlDb<Data>::index(const Key& key, const Element<Data>& elem)
+{
+  byName[elem.name].insert(key);
+  byCategory[elem.category].insert(key);
+  byTime.emplace(timeKey(elem.timeDate), key);
+  std::vector<std::string> children = elem.children;
+  for (const std::string& child : children)
+    parents[child].insert(key);
+}
+
+//changed takes a version no other database in the process has had
+template<typename Data>
+void NoSqlDb<Data>::changed()
+{
+  static std::atomic<size_t> last(0);
+  changes = ++last;
+  cyclesFound = false;
+}
+
+//unindex removes an element from the indexes before it is replaced or erased
+template<typename Data>
+void NoSqlDb<Data>::unindex(const Key& key, const Element<Data>& elem)
+{
+  auto unlist = [&key](Index& idx, const std::string& value) {
+    auto iter = idx.find(value);
+    if (iter == idx.end())
+      return;
+    iter->second.erase(key);
+    if (iter->second.empty())
+      idx.erase(iter);
+  };
+  unlist(byName, elem.name);
+  unlist(byCategory, elem.category);
+  auto range = byTime.equal_range(timeKey(elem.timeDate));
+  for (auto iter = range.first; iter != range.second; ++iter)
+  {
+    if (iter->second == key)
+    {
+      byTime.erase(iter);
+      break;
+    }
+  }
+  std::vector<std::string> children = elem.children;
+  for (const std::string& child : children)
+    unlist(parents, child);
+}
+
+//dependents returns the keys that hold key in their children
+template<typename Data>
+typename NoSqlDb<Data>::Keys NoSqlDb<Data>::dependents(const Key& key) const
+{
+  auto iter = parents.find(key);
+  if (iter == parents.end())
+    return Keys();
+  return Keys(iter->second.begin(), iter->second.end());
+}
+
+//dependentsWithin returns keys that reach key in at most depth links, nearest first
+//- depth 1 gives the dependents of key, depth 0 has no limit
+template<typename Data>
+typename NoSqlDb<Data>::Keys NoSqlDb<Data>::dependentsWithin(const Key& key, size_t depth) const
+{
+  Keys result;
+  std::unordered_set<Key> seen = { key };
+  std::deque<std::pair<Key, size_t>> frontier = { { key, 0 } };
+  while (!frontier.empty())
+  {
+    std::pair<Key, size_t> current = frontier.front();
+    frontier.pop_front();
+    if (depth != 0 && current.second == depth)
+      continue;
+    auto iter = parents.find(current.first);
+    if (iter == parents.end())
+      continue;
+    for (const Key& parent : iter->second)
+    {
+      if (!seen.insert(parent).second)
+        continue;
+      result.push_back(parent);
+      frontier.push_back({ parent, current.second + 1 });
+    }
+  }
+  return result;
+}
+
+//cycles returns the strongly connected components, found once per change
+template<typename Data>
+const std::vector<typename NoSqlDb<Data>::Keys>& NoSqlDb<Data>::cycles() const
+{
+  if (!cyclesFound)
+    findCycles();
+  return sccs;
+}
+
+//cycleOf returns the component holding key, nullptr if key is on no cycle
+template<typename Data>
+const typename NoSqlDb<Data>::Keys* NoSqlDb<Data>::cycleOf(const Key& key) const
+{
+  if (!cyclesFound)
+    findCycles();
+  auto iter = sccOf.find(key);
+  if (iter == sccOf.end())
+    return nullptr;
+  return &sccs[iter->second];
+}
+
+//findCycles runs Tarjan's algorithm over the children of stored keys
+//- iterative, so long dependency chains don't exhaust the stack
+template<typename Data>
+void NoSqlDb<Data>::findCycles() const
+{
+  sccs.clear();
+  sccOf.clear();
+  std::vector<const Key*> nodes;
+  std::unordered_map<Key, size_t> number;
+  for (const auto& item : store)
+  {
+    number[item.first] = nodes.size();
+    nodes.push_back(&item.first);
+  }
+  std::vector<std::vector<size_t>> edges(nodes.size());
+  std::vector<bool> selfEdge(nodes.size(), false);
+  for (size_t n = 0; n < nodes.size(); ++n)
+  {
+    std::vector<std::string> children = store.find(*nodes[n])->second.children;
+    for (const std::string& child : children)
+    {
+      auto iter = number.find(child);
+      if (iter == number.end())
+        continue;
+      edges[n].push_back(iter->second);
+      if (iter->second == n)
+        selfEdge[n] = true;
+    }
+  }
+  const size_t none = (size_t)-1;
+  std::vector<size_t> order(nodes.size(), none), low(nodes.size(), 0);
+  std::vector<bool> onStack(nodes.size(), false);
+  std::vector<size_t> stack;
+  std::vector<std::pair<size_t, size_t>> calls;   // node, next edge
+  size_t counter = 0;
+  for (size_t root = 0; root < nodes.size(); ++root)
+  {
+    if (order[root] != none)
+      continue;
+    calls.push_back({ root, 0 });
+    while (!calls.empty())
+    {
+      size_t n = calls.back().first;
+      size_t& next = calls.back().second;
+      if (next == 0 && order[n] == none)
+      {
+        order[n] = low[n] = counter++;
+        stack.push_back(n);
+        onStack[n] = true;
+      }
+      if (next < edges[n].size())
+      {
+        size_t m = edges[n][next++];
+        if (order[m] == none)
+          calls.push_back({ m, 0 });
+        else if (onStack[m])
+          low[n] = std::min(low[n], order[m]);
+        continue;
+      }
+      calls.pop_back();
+      if (!calls.empty())
+        low[calls.back().first] = std::min(low[calls.back().first], low[n]);
+      if (low[n] != order[n])
+        continue;
+      Keys component;
+      size_t m;
+      do {
+        m = stack.back();
+        stack.pop_back();
+        onStack[m] = false;
+        component.push_back(*nodes[m]);
+      } while (m != n);
+      if (component.size() > 1 || selfEdge[n])
+      {
+        for (const Key& k : component)
+          sccOf[k] = sccs.size();
+        sccs.push_back(component);
+      }
+    }
+  }
+  cyclesFound = true;
+}
+
 template<typename Data>
 void NoSqlDb<Data>::ReadFromXml(std::string FileName)
 {
 	std::cout << "\n  Retrieving elements from XML File \n";
 	std::string x;
-	std::ifstream RawDbFile;
-	std::string RawDbString = " ";
 	// To read the data from the default database
 	if (FileName == "Default")	{
 		x = "../StringDB.xml";
@@ -199,36 +663,14 @@ void NoSqlDb<Data>::ReadFromXml(std::string FileName)
 	else{
 		x = FileName;
 	}
-	RawDbFile.open(x);
-	if (RawDbFile.is_open()){
-		std::string tp;
-		while (std::getline(RawDbFile, tp)){
-			RawDbString += tp;
-			RawDbString += "\n";
-		}
+	try {
+		XmlProcessing::XmlStreamParser parser(x);
+		XmlLoader loader(*this);
+		parser.parse(loader);
 	}
-	RawDbFile.close();
-	XmlDocument doc(RawDbString, XmlDocument::str);
-	// fetch the Node Tag from XML element
-	std::vector<SPtr> desc = doc.descendents("Nodes").select();
-	int i = 0;
-	for (auto r : desc){
-		Element<Data> NewElem;
-		NewElem.name = trim(desc[i]->children()[0]->children()[0]->value());
-		NewElem.category = trim(desc[i]->children()[1]->children()[0]->value());
-		NewElem.timeDate = trim(desc[i]->children()[2]->children()[0]->value());
-		NewElem.data = trim(desc[i]->children()[3]->children()[0]->value());
-		std::stringstream a;
-		std::string tChild = trim(desc[i]->children()[4]->children()[0]->value());
-		a << tChild;
-		tChild.clear();
-		while (std::getline(a, tChild)) {
-			tChild = trim(tChild);
-			NewElem.children(tChild);
-		}
-		NewElem.data = trim(desc[i]->children()[5]->children()[0]->value());
-		save(NewElem.name, NewElem);
-		i++;
+	catch (std::exception& ex) {
+		std::cout << "\n  " << ex.what() << "\n";
+		return;
 	}
 	std::cout << "\n Data has been retreived to the Database successfully!\n";
 }
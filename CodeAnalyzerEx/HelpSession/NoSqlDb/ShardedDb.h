@@ -0,0 +1,221 @@
+#pragma once
+////////////////////////////////////////////////////////////////////////////////
+// ShardedDb.h:  key/value store safe for many concurrent readers and writers //
+// Application: Key Value DataBase, Spring 2017                               //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                       //
+// Author:      Chandra Harsha Jupalli, CSE687 - OOD,Spring 2017              //
+//              cjupalli@syr.edu                                              //
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* This package provides template class ShardedDb, a store of the same
+* Element<Data> records as NoSqlDb that many threads may use at once, e.g.,
+* parse or dependency workers each saving their own files' elements.
+*
+* Keys are spread by hash over a fixed number of shards.  Each shard is a
+* small unordered_map with its own reader/writer lock, so writers to
+* different shards never wait on each other and readers only wait on a
+* writer of the same shard.  Each shard is allocated on its own, so locks
+* of neighbouring shards don't share a cache line.
+*
+* Reads don't copy: visit(key, f) calls f with a const reference to the
+* stored element while its shard is locked for reading, and f can read
+* large values in place with Property::ref(), e.g., elem.children.ref().
+* modify(key, f) gives f the element to change in place under the shard's
+* write lock.  f must not use the same ShardedDb, its shard is locked.
+*
+* ShardedDb keeps no secondary indexes.  moveInto(db) hands every element
+* to a NoSqlDb, which indexes them, when the concurrent phase is over.
+*
+* PublicInterface
+* ----------------
+* ShardedDb<std::string> sdb;                     // 64 shards
+* sdb.save(key, elem);                            // false if key is present
+* sdb.update(key, elem);                          // false if key is absent
+* sdb.remove(key);
+* sdb.visit(key, [](const Element<std::string>& e) { ... });   // false if absent
+* sdb.modify(key, [](Element<std::string>& e) { ... });
+* sdb.forEach([](const std::string& key, const Element<std::string>& e) { ... });
+* sdb.moveInto(db);                               // db is a NoSqlDb<std::string>
+*
+* Required Files:
+* ---------------
+*   - NoSqlDb.h, CppProperties.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyserEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "NoSqlDb.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+template<typename Data>
+class ShardedDb
+{
+public:
+  using Key = std::string;
+  using Keys = std::vector<Key>;
+
+  ShardedDb(size_t numShards = 64);
+  bool save(const Key& key, const Element<Data>& elem);
+  bool update(const Key& key, const Element<Data>& elem);
+  bool remove(const Key& key);
+  template<typename Visit>
+  bool visit(const Key& key, Visit visit) const;
+  template<typename Modify>
+  bool modify(const Key& key, Modify modify);
+  template<typename Visit>
+  void forEach(Visit visit) const;
+  Element<Data> value(const Key& key) const;
+  size_t count() const { return count_.load(); }
+  Keys keys() const;
+  void moveInto(NoSqlDb<Data>& db);
+private:
+  using Lock = std::shared_timed_mutex;
+  struct Shard
+  {
+    mutable Lock lock;
+    std::unordered_map<Key, Element<Data>> store;
+  };
+  Shard& shardOf(const Key& key) const { return *shards_[std::hash<Key>()(key) % shards_.size()]; }
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+  std::atomic<size_t> count_;
+};
+
+template<typename Data>
+ShardedDb<Data>::ShardedDb(size_t numShards) : count_(0)
+{
+  if (numShards == 0)
+    numShards = 1;
+  for (size_t i = 0; i < numShards; ++i)
+    shards_.push_back(std::unique_ptr<Shard>(new Shard));
+}
+
+//save adds elem under key, false if key is already present
+template<typename Data>
+bool ShardedDb<Data>::save(const Key& key, const Element<Data>& elem)
+{
+  Shard& shard = shardOf(key);
+  std::unique_lock<Lock> lock(shard.lock);
+  if (!shard.store.emplace(key, elem).second)
+    return false;
+  ++count_;
+  return true;
+}
+
+//update replaces the element under key, false if key is absent
+template<typename Data>
+bool ShardedDb<Data>::update(const Key& key, const Element<Data>& elem)
+{
+  Shard& shard = shardOf(key);
+  std::unique_lock<Lock> lock(shard.lock);
+  auto iter = shard.store.find(key);
+  if (iter == shard.store.end())
+    return false;
+  iter->second = elem;
+  return true;
+}
+
+//remove erases the element under key, false if key is absent
+template<typename Data>
+bool ShardedDb<Data>::remove(const Key& key)
+{
+  Shard& shard = shardOf(key);
+  std::unique_lock<Lock> lock(shard.lock);
+  if (shard.store.erase(key) == 0)
+    return false;
+  --count_;
+  return true;
+}
+
+//visit calls visit(element) with the stored element, under a read lock
+template<typename Data>
+template<typename Visit>
+bool ShardedDb<Data>::visit(const Key& key, Visit visit) const
+{
+  Shard& shard = shardOf(key);
+  std::shared_lock<Lock> lock(shard.lock);
+  auto iter = shard.store.find(key);
+  if (iter == shard.store.end())
+    return false;
+  visit(static_cast<const Element<Data>&>(iter->second));
+  return true;
+}
+
+//modify calls modify(element) to change the stored element, under a write lock
+template<typename Data>
+template<typename Modify>
+bool ShardedDb<Data>::modify(const Key& key, Modify modify)
+{
+  Shard& shard = shardOf(key);
+  std::unique_lock<Lock> lock(shard.lock);
+  auto iter = shard.store.find(key);
+  if (iter == shard.store.end())
+    return false;
+  modify(iter->second);
+  return true;
+}
+
+//forEach calls visit(key, element) for every element, one shard at a time
+//- elements saved or removed meanwhile in other shards may or may not be seen
+template<typename Data>
+template<typename Visit>
+void ShardedDb<Data>::forEach(Visit visit) const
+{
+  for (auto& pShard : shards_)
+  {
+    std::shared_lock<Lock> lock(pShard->lock);
+    for (const auto& item : pShard->store)
+      visit(item.first, item.second);
+  }
+}
+
+//value returns a copy of the element under key, a default element if absent
+template<typename Data>
+Element<Data> ShardedDb<Data>::value(const Key& key) const
+{
+  Element<Data> elem;
+  visit(key, [&elem](const Element<Data>& stored) { elem = stored; });
+  return elem;
+}
+
+template<typename Data>
+typename ShardedDb<Data>::Keys ShardedDb<Data>::keys() const
+{
+  Keys keys;
+  keys.reserve(count());
+  forEach([&keys](const Key& key, const Element<Data>&) { keys.push_back(key); });
+  return keys;
+}
+
+//moveInto saves every element into db, which indexes them, and empties this store
+template<typename Data>
+void ShardedDb<Data>::moveInto(NoSqlDb<Data>& db)
+{
+  db.reserve(db.count() + count());
+  for (auto& pShard : shards_)
+  {
+    std::unique_lock<Lock> lock(pShard->lock);
+    for (const auto& item : pShard->store)
+      db.save(item.first, item.second);
+    count_ -= pShard->store.size();
+    pShard->store.clear();
+  }
+}
@@ -0,0 +1,332 @@
+#pragma once
+////////////////////////////////////////////////////////////////////////////////
+// Snapshot.h:  binary snapshots of a NoSqlDb, loaded and saved in O(n)       //
+// Application: Key Value DataBase, Spring 2017                               //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                       //
+// Author:      Chandra Harsha Jupalli, CSE687 - OOD,Spring 2017              //
+//              cjupalli@syr.edu                                              //
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* This package provides template class Snapshot, which saves every element
+* of a NoSqlDb to one binary file and loads it back.  It is the format to
+* restart from, XML made by toXml stays as an export for people to read.
+*
+* A snapshot is one block of 32 bit words followed by one block of bytes:
+*
+*   Header       magic "NSDB", format version, data kind and size, counts,
+*                and the generation, the last WriteAheadLog it holds
+*   offsets      strings + 1 offsets into the string bytes
+*   records      per element: key, name, category, timeDate, data
+*   edgeFirst    elements + 1 indexes into edges, element i's children are
+*                edges[edgeFirst[i] .. edgeFirst[i+1])
+*   edges        string indexes of children
+*   raw data     elements * dataSize bytes, only for non string Data
+*   string bytes every distinct string once, not terminated
+*
+* Every string, key, metadata, std::string data, and children, is stored
+* once in the string table and named by its index everywhere else, so the
+* file paths that fill a dependency database's children take space once.
+* All offsets are relative to the file, so a snapshot could be mapped and
+* read in place.  load reads the whole file with one read, checks every
+* index before it touches the database, and builds each string straight
+* from the buffer.
+*
+* Data must be std::string or a trivially copyable type.
+*
+* PublicInterface
+* ----------------
+* bool Snapshot<Data>::save(const NoSqlDb<Data>& db, const std::string& fileSpec, generation = 0)
+* bool Snapshot<Data>::load(NoSqlDb<Data>& db, const std::string& fileSpec, &generation)   //false if file is not a snapshot
+* std::string Snapshot<Data>::image(const NoSqlDb<Data>& db, generation)      //the file's bytes, to write later
+* bool Snapshot<Data>::write(const std::string& image, const std::string& fileSpec)
+*
+* Required Files:
+* ---------------
+*   - NoSqlDb.h, CppProperties.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyserEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.1 : 14 Oct 2026
+* - header's reserved word holds a generation, for WriteAheadLog
+* - save is split into image and write, so an image can be made on
+*   one thread and written on another
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "NoSqlDb.h"
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unordered_map>
+#include <vector>
+
+/////////////////////////////////////////////////////////////////////
+// SnapshotData describes how a Data value is stored
+// - std::string data goes in the string table, other types are
+//   copied as raw bytes
+
+template<typename Data>
+struct SnapshotData
+{
+  static_assert(std::is_trivially_copyable<Data>::value, "Snapshot Data must be std::string or trivially copyable");
+  enum { kind = 1, size = sizeof(Data) };
+};
+
+template<>
+struct SnapshotData<std::string>
+{
+  enum { kind = 0, size = 0 };
+};
+
+/////////////////////////////////////////////////////////////////////
+// Snapshot saves and loads a NoSqlDb as a versioned binary file
+
+template<typename Data>
+class Snapshot
+{
+public:
+  static bool save(const NoSqlDb<Data>& db, const std::string& fileSpec, uint32_t generation = 0);
+  static bool load(NoSqlDb<Data>& db, const std::string& fileSpec, uint32_t* pGeneration = nullptr);
+  static std::string image(const NoSqlDb<Data>& db, uint32_t generation = 0);
+  static bool write(const std::string& image, const std::string& fileSpec);
+
+  static const uint32_t formatVersion = 1;
+private:
+  struct Header
+  {
+    char magic[4];
+    uint32_t version;
+    uint32_t dataKind;
+    uint32_t dataSize;
+    uint32_t strings;
+    uint32_t elements;
+    uint32_t edges;
+    uint32_t generation;
+    uint64_t stringBytes;
+  };
+  enum { KeyField, NameField, CategoryField, TimeField, DataField, RecordSize };
+
+  /////////////////////////////////////////////////////////////////
+  // StringTable gives each distinct string one index
+
+  class StringTable
+  {
+  public:
+    uint32_t intern(const std::string& s);
+    std::vector<uint32_t> offsets = { 0 };
+    std::string bytes;
+  private:
+    std::unordered_map<std::string, uint32_t> indexes_;
+  };
+
+  static void putData(const std::string& data, StringTable& table, std::vector<uint32_t>& record, std::string&);
+  template<typename T>
+  static void putData(const T& data, StringTable&, std::vector<uint32_t>& record, std::string& raw);
+  static void getData(Element<std::string>& elem, const uint32_t* record, const char*, const std::vector<std::string>& strings);
+  template<typename T>
+  static void getData(Element<T>& elem, const uint32_t* record, const char* raw, const std::vector<std::string>&);
+};
+
+//intern returns s's index, adding s to the table the first time it is seen
+template<typename Data>
+uint32_t Snapshot<Data>::StringTable::intern(const std::string& s)
+{
+  auto iter = indexes_.find(s);
+  if (iter != indexes_.end())
+    return iter->second;
+  uint32_t index = (uint32_t)offsets.size() - 1;
+  indexes_.emplace(s, index);
+  bytes += s;
+  offsets.push_back((uint32_t)bytes.size());
+  return index;
+}
+
+//std::string data is a string index
+template<typename Data>
+void Snapshot<Data>::putData(const std::string& data, StringTable& table, std::vector<uint32_t>& record, std::string&)
+{
+  record.push_back(table.intern(data));
+}
+
+//other data is copied into the raw block, the record holds its position
+template<typename Data>
+template<typename T>
+void Snapshot<Data>::putData(const T& data, StringTable&, std::vector<uint32_t>& record, std::string& raw)
+{
+  record.push_back((uint32_t)(raw.size() / sizeof(T)));
+  raw.append(reinterpret_cast<const char*>(&data), sizeof(T));
+}
+
+template<typename Data>
+void Snapshot<Data>::getData(Element<std::string>& elem, const uint32_t* record, const char*, const std::vector<std::string>& strings)
+{
+  elem.data = strings[record[DataField]];
+}
+
+template<typename Data>
+template<typename T>
+void Snapshot<Data>::getData(Element<T>& elem, const uint32_t* record, const char* raw, const std::vector<std::string>&)
+{
+  T value;
+  std::memcpy(&value, raw + (size_t)record[DataField] * sizeof(T), sizeof(T));
+  elem.data = value;
+}
+
+//save writes db to fileSpec with one write, false if the file can't be written
+template<typename Data>
+bool Snapshot<Data>::save(const NoSqlDb<Data>& db, const std::string& fileSpec, uint32_t generation)
+{
+  return write(image(db, generation), fileSpec);
+}
+
+//image returns the bytes of db's snapshot
+template<typename Data>
+std::string Snapshot<Data>::image(const NoSqlDb<Data>& db, uint32_t generation)
+{
+  StringTable table;
+  std::vector<uint32_t> records, edgeFirst, edges;
+  std::string raw;
+  records.reserve(RecordSize * db.count());
+  edgeFirst.reserve(db.count() + 1);
+  db.forEach([&](const std::string& key, const Element<Data>& elem) {
+    records.push_back(table.intern(key));
+    records.push_back(table.intern(elem.name));
+    records.push_back(table.intern(elem.category));
+    records.push_back(table.intern(elem.timeDate));
+    Data data = elem.data;
+    putData(data, table, records, raw);
+    edgeFirst.push_back((uint32_t)edges.size());
+    std::vector<std::string> children = elem.children;
+    for (const std::string& child : children)
+      edges.push_back(table.intern(child));
+  });
+  edgeFirst.push_back((uint32_t)edges.size());
+
+  Header header = {};
+  std::memcpy(header.magic, "NSDB", 4);
+  header.version = formatVersion;
+  header.dataKind = SnapshotData<Data>::kind;
+  header.dataSize = SnapshotData<Data>::size;
+  header.strings = (uint32_t)table.offsets.size() - 1;
+  header.elements = (uint32_t)(records.size() / RecordSize);
+  header.edges = (uint32_t)edges.size();
+  header.stringBytes = table.bytes.size();
+  header.generation = generation;
+
+  std::string image;
+  image.reserve(sizeof(Header) + 4 * (table.offsets.size() + records.size() + edgeFirst.size() + edges.size()) + raw.size() + table.bytes.size());
+  auto append = [&image](const void* src, size_t bytes) { image.append(static_cast<const char*>(src), bytes); };
+  append(&header, sizeof(Header));
+  append(table.offsets.data(), 4 * table.offsets.size());
+  append(records.data(), 4 * records.size());
+  append(edgeFirst.data(), 4 * edgeFirst.size());
+  append(edges.data(), 4 * edges.size());
+  append(raw.data(), raw.size());
+  append(table.bytes.data(), table.bytes.size());
+  return image;
+}
+
+//write puts image in fileSpec, false if the file can't be written
+template<typename Data>
+bool Snapshot<Data>::write(const std::string& image, const std::string& fileSpec)
+{
+  std::ofstream out(fileSpec, std::ios::binary | std::ios::trunc);
+  if (!out.good())
+    return false;
+  out.write(image.data(), image.size());
+  return out.good();
+}
+
+//load saves every element of the snapshot into db
+//- nothing is saved unless the whole file is a valid snapshot of this Data type
+template<typename Data>
+bool Snapshot<Data>::load(NoSqlDb<Data>& db, const std::string& fileSpec, uint32_t* pGeneration)
+{
+  std::ifstream in(fileSpec, std::ios::binary | std::ios::ate);
+  if (!in.good())
+    return false;
+  size_t fileSize = (size_t)in.tellg();
+  if (fileSize < sizeof(Header))
+    return false;
+  std::vector<uint32_t> buffer((fileSize + 3) / 4);   // words, so sections are aligned
+  const char* base = reinterpret_cast<const char*>(buffer.data());
+  in.seekg(0);
+  if (!in.read(reinterpret_cast<char*>(buffer.data()), fileSize))
+    return false;
+
+  Header header;
+  std::memcpy(&header, base, sizeof(Header));
+  if (std::memcmp(header.magic, "NSDB", 4) != 0 || header.version != formatVersion)
+    return false;
+  if (header.dataKind != (uint32_t)SnapshotData<Data>::kind || header.dataSize != (uint32_t)SnapshotData<Data>::size)
+    return false;
+  uint64_t words = (uint64_t)header.strings + 1 + (uint64_t)RecordSize * header.elements + (uint64_t)header.elements + 1 + header.edges;
+  uint64_t rawBytes = (uint64_t)header.elements * header.dataSize;
+  if (sizeof(Header) + 4 * words + rawBytes + header.stringBytes != fileSize)
+    return false;
+
+  const uint32_t* offsets = reinterpret_cast<const uint32_t*>(base + sizeof(Header));
+  const uint32_t* records = offsets + header.strings + 1;
+  const uint32_t* edgeFirst = records + (size_t)RecordSize * header.elements;
+  const uint32_t* edges = edgeFirst + header.elements + 1;
+  const char* raw = reinterpret_cast<const char*>(edges + header.edges);
+  const char* bytes = raw + rawBytes;
+
+  if (offsets[0] != 0 || offsets[header.strings] != header.stringBytes)
+    return false;
+  std::vector<std::string> strings;
+  strings.reserve(header.strings);
+  for (uint32_t i = 0; i < header.strings; ++i)
+  {
+    if (offsets[i + 1] < offsets[i])
+      return false;
+    strings.emplace_back(bytes + offsets[i], offsets[i + 1] - offsets[i]);
+  }
+  for (uint32_t i = 0; i < header.elements; ++i)
+  {
+    const uint32_t* record = records + (size_t)RecordSize * i;
+    for (int field = KeyField; field < DataField; ++field)
+      if (record[field] >= header.strings)
+        return false;
+    if (record[DataField] >= (header.dataKind == 0 ? header.strings : header.elements))
+      return false;
+    if (edgeFirst[i + 1] < edgeFirst[i] || edgeFirst[i + 1] > header.edges)
+      return false;
+  }
+  if (edgeFirst[0] != 0 || edgeFirst[header.elements] != header.edges)
+    return false;
+  for (uint32_t i = 0; i < header.edges; ++i)
+    if (edges[i] >= header.strings)
+      return false;
+
+  db.reserve(db.count() + header.elements);
+  std::vector<std::string> children;
+  for (uint32_t i = 0; i < header.elements; ++i)
+  {
+    const uint32_t* record = records + (size_t)RecordSize * i;
+    Element<Data> elem;
+    elem.name = strings[record[NameField]];
+    elem.category = strings[record[CategoryField]];
+    elem.timeDate = strings[record[TimeField]];
+    getData(elem, record, raw, strings);
+    children.clear();
+    for (uint32_t e = edgeFirst[i]; e < edgeFirst[i + 1]; ++e)
+      children.push_back(strings[edges[e]]);
+    elem.children = children;
+    db.save(strings[record[KeyField]], elem);
+  }
+  if (pGeneration != nullptr)
+    *pGeneration = header.generation;
+  return true;
+}
@@ -0,0 +1,406 @@
+#pragma once
+////////////////////////////////////////////////////////////////////////////////
+// WriteAheadLog.h:  append only log of NoSqlDb changes, with compaction      //
+// Application: Key Value DataBase, Spring 2017                               //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                       //
+// Author:      Chandra Harsha Jupalli, CSE687 - OOD,Spring 2017              //
+//              cjupalli@syr.edu                                              //
+////////////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* This package provides template class WriteAheadLog, which makes a NoSqlDb
+* durable without writing the whole database on every change.  Once open,
+* every save, Update, and Delete that changes the database appends one
+* record to a log file and flushes it, so the cost of a change depends on
+* the size of the change, not the size of the database.
+*
+* Files, for base "deps":
+*   deps.snap      Snapshot of the database, its generation is the last
+*                  log it holds
+*   deps.log.<g>   log generation g, a header then records:
+*                  length, checksum, op, key, and for save and Update the
+*                  element's name, category, timeDate, data, and children
+*
+* When the current log grows past compactBytes, compact() makes a Snapshot
+* image of the database and starts the next log generation, on the calling
+* thread, then a background thread writes the image to deps.snap.tmp,
+* renames it to deps.snap, and removes the logs the snapshot holds.
+*
+* open() recovers: it loads deps.snap, or deps.snap.tmp if a crash left the
+* rename undone, then replays every later log in order.  A record cut off
+* by a crash, or whose checksum doesn't match, ends the replay of its log.
+* Records are flushed to the operating system as they are written, so they
+* survive the process crashing, not the machine losing power.
+*
+* PublicInterface
+* ----------------
+* NoSqlDb<std::string> db;
+* WriteAheadLog<std::string> wal(db, "../deps");
+* wal.open();                    // recover db, then log its changes
+* db.save(key, elem);            // appends one record
+* wal.compact();                 // snapshot now, normally done by size
+* wal.close();                   // also done by the destructor
+*
+* Required Files:
+* ---------------
+*   - NoSqlDb.h, Snapshot.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyserEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "NoSqlDb.h"
+#include "Snapshot.h"
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+template<typename Data>
+class WriteAheadLog
+{
+public:
+  WriteAheadLog(NoSqlDb<Data>& db, const std::string& base, size_t compactBytes = 4 * 1024 * 1024);
+  WriteAheadLog(const WriteAheadLog&) = delete;
+  WriteAheadLog& operator=(const WriteAheadLog&) = delete;
+  ~WriteAheadLog();
+
+  bool open();
+  void close();
+  bool compact();
+  void wait();
+  bool good() const { return good_; }
+  size_t replayed() const { return replayed_; }
+  uint32_t generation() const { return generation_; }
+  std::string snapshotFile() const { return base_ + ".snap"; }
+  static std::string logFile(const std::string& base, uint32_t generation);
+
+  static const uint32_t formatVersion = 1;
+private:
+  /////////////////////////////////////////////////////////////////
+  // Reader takes words and strings from a record, never reading past its end
+
+  struct Reader
+  {
+    const char* pos;
+    const char* end;
+    bool word(uint32_t& w);
+    bool string(std::string& s);
+    bool bytes(void* dest, size_t n);
+  };
+
+  void append(char op, const std::string& key, const Element<Data>* pElem);
+  bool startLog(uint32_t generation);
+  bool replay(uint32_t generation);
+  bool apply(Reader& reader);
+  static uint32_t checksum(const char* p, size_t n);
+  static void putWord(std::string& out, uint32_t w);
+  static void putString(std::string& out, const std::string& s);
+  static void putData(std::string& out, const std::string& data) { putString(out, data); }
+  template<typename T>
+  static void putData(std::string& out, const T& data) { out.append(reinterpret_cast<const char*>(&data), sizeof(T)); }
+  static bool getData(Reader& reader, Element<std::string>& elem);
+  template<typename T>
+  static bool getData(Reader& reader, Element<T>& elem);
+
+  NoSqlDb<Data>& db_;
+  std::string base_;
+  size_t compactBytes_;
+  std::ofstream log_;
+  size_t logBytes_ = 0;
+  uint32_t generation_ = 0;
+  uint32_t firstLog_ = 1;
+  size_t replayed_ = 0;
+  bool good_ = false;
+  std::thread compactor_;
+};
+
+template<typename Data>
+WriteAheadLog<Data>::WriteAheadLog(NoSqlDb<Data>& db, const std::string& base, size_t compactBytes)
+  : db_(db), base_(base), compactBytes_(compactBytes) {}
+
+template<typename Data>
+WriteAheadLog<Data>::~WriteAheadLog()
+{
+  close();
+}
+
+//logFile names log generation of base
+template<typename Data>
+std::string WriteAheadLog<Data>::logFile(const std::string& base, uint32_t generation)
+{
+  return base + ".log." + std::to_string(generation);
+}
+
+//FNV-1a, enough to tell a torn or damaged record from a whole one
+template<typename Data>
+uint32_t WriteAheadLog<Data>::checksum(const char* p, size_t n)
+{
+  uint32_t hash = 2166136261u;
+  for (size_t i = 0; i < n; ++i)
+  {
+    hash ^= (unsigned char)p[i];
+    hash *= 16777619u;
+  }
+  return hash;
+}
+
+template<typename Data>
+void WriteAheadLog<Data>::putWord(std::string& out, uint32_t w)
+{
+  out.append(reinterpret_cast<const char*>(&w), sizeof(w));
+}
+
+template<typename Data>
+void WriteAheadLog<Data>::putString(std::string& out, const std::string& s)
+{
+  putWord(out, (uint32_t)s.size());
+  out += s;
+}
+
+template<typename Data>
+bool WriteAheadLog<Data>::Reader::bytes(void* dest, size_t n)
+{
+  if ((size_t)(end - pos) < n)
+    return false;
+  std::memcpy(dest, pos, n);
+  pos += n;
+  return true;
+}
+
+template<typename Data>
+bool WriteAheadLog<Data>::Reader::word(uint32_t& w)
+{
+  return bytes(&w, sizeof(w));
+}
+
+template<typename Data>
+bool WriteAheadLog<Data>::Reader::string(std::string& s)
+{
+  uint32_t size;
+  if (!word(size) || (size_t)(end - pos) < size)
+    return false;
+  s.assign(pos, size);
+  pos += size;
+  return true;
+}
+
+template<typename Data>
+bool WriteAheadLog<Data>::getData(Reader& reader, Element<std::string>& elem)
+{
+  std::string data;
+  if (!reader.string(data))
+    return false;
+  elem.data = data;
+  return true;
+}
+
+template<typename Data>
+template<typename T>
+bool WriteAheadLog<Data>::getData(Reader& reader, Element<T>& elem)
+{
+  T data;
+  if (!reader.bytes(&data, sizeof(T)))
+    return false;
+  elem.data = data;
+  return true;
+}
+
+//open recovers db from the snapshot and logs, then logs db's changes
+//- db should be empty, false if the new log can't be written
+template<typename Data>
+bool WriteAheadLog<Data>::open()
+{
+  close();
+  uint32_t covered = 0;
+  if (!Snapshot<Data>::load(db_, snapshotFile(), &covered))
+    Snapshot<Data>::load(db_, snapshotFile() + ".tmp", &covered);
+  replayed_ = 0;
+  uint32_t generation = covered + 1;
+  while (replay(generation))
+    ++generation;
+  firstLog_ = covered + 1;
+  if (!startLog(generation))
+    return false;
+  db_.setJournal([this](char op, const std::string& key, const Element<Data>* pElem) {
+    append(op, key, pElem);
+  });
+  return true;
+}
+
+//close stops logging and waits for a compaction being written
+template<typename Data>
+void WriteAheadLog<Data>::close()
+{
+  db_.setJournal(nullptr);
+  wait();
+  if (log_.is_open())
+    log_.close();
+  good_ = false;
+}
+
+//wait returns when no compaction is being written
+template<typename Data>
+void WriteAheadLog<Data>::wait()
+{
+  if (compactor_.joinable())
+    compactor_.join();
+}
+
+//startLog makes log file generation, with its header, the one appended to
+template<typename Data>
+bool WriteAheadLog<Data>::startLog(uint32_t generation)
+{
+  if (log_.is_open())
+    log_.close();
+  log_.clear();
+  log_.open(logFile(base_, generation), std::ios::binary | std::ios::trunc);
+  std::string header = "NSWL";
+  putWord(header, formatVersion);
+  putWord(header, generation);
+  log_.write(header.data(), header.size());
+  log_.flush();
+  generation_ = generation;
+  logBytes_ = header.size();
+  good_ = log_.good();
+  return good_;
+}
+
+//append writes one record for a change db has just made
+template<typename Data>
+void WriteAheadLog<Data>::append(char op, const std::string& key, const Element<Data>* pElem)
+{
+  if (!good_)
+    return;
+  std::string body(1, op);
+  putString(body, key);
+  if (pElem != nullptr)
+  {
+    putString(body, pElem->name);
+    putString(body, pElem->category);
+    putString(body, pElem->timeDate);
+    Data data = pElem->data;
+    putData(body, data);
+    std::vector<std::string> children = pElem->children;
+    putWord(body, (uint32_t)children.size());
+    for (const std::string& child : children)
+      putString(body, child);
+  }
+  std::string record;
+  putWord(record, (uint32_t)body.size());
+  putWord(record, checksum(body.data(), body.size()));
+  record += body;
+  log_.write(record.data(), record.size());
+  log_.flush();
+  logBytes_ += record.size();
+  good_ = log_.good();
+  if (good_ && logBytes_ >= compactBytes_)
+    compact();
+}
+
+//apply makes the change one record describes, false if the record is malformed
+template<typename Data>
+bool WriteAheadLog<Data>::apply(Reader& reader)
+{
+  char op;
+  std::string key;
+  if (!reader.bytes(&op, 1) || !reader.string(key))
+    return false;
+  if (op == 'd')
+  {
+    db_.remove(key);
+    return true;
+  }
+  if (op != 's' && op != 'u')
+    return false;
+  Element<Data> elem;
+  std::string name, category, timeDate;
+  uint32_t count;
+  if (!reader.string(name) || !reader.string(category) || !reader.string(timeDate) ||
+    !getData(reader, elem) || !reader.word(count))
+    return false;
+  std::vector<std::string> children;
+  children.reserve(count < 1024 ? count : 1024);
+  for (uint32_t i = 0; i < count; ++i)
+  {
+    std::string child;
+    if (!reader.string(child))
+      return false;
+    children.push_back(child);
+  }
+  elem.name = name;
+  elem.category = category;
+  elem.timeDate = timeDate;
+  elem.children = children;
+  if (op == 's')
+    db_.save(key, elem);
+  else
+    db_.Update(key, elem);
+  return true;
+}
+
+//replay applies the whole records of log generation, false if there is no such log
+template<typename Data>
+bool WriteAheadLog<Data>::replay(uint32_t generation)
+{
+  std::ifstream in(logFile(base_, generation), std::ios::binary);
+  if (!in.good())
+    return false;
+  std::string file((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+  Reader reader = { file.data(), file.data() + file.size() };
+  char magic[4];
+  uint32_t version, logGeneration;
+  if (!reader.bytes(magic, 4) || std::memcmp(magic, "NSWL", 4) != 0 || !reader.word(version) ||
+    version != formatVersion || !reader.word(logGeneration) || logGeneration != generation)
+    return false;
+  uint32_t size, sum;
+  while (reader.word(size) && reader.word(sum))
+  {
+    if ((size_t)(reader.end - reader.pos) < size || checksum(reader.pos, size) != sum)
+      break;
+    Reader record = { reader.pos, reader.pos + size };
+    reader.pos += size;
+    if (!apply(record))
+      break;
+    ++replayed_;
+  }
+  return true;
+}
+
+//compact snapshots db and starts the next log, the snapshot is written in the background
+template<typename Data>
+bool WriteAheadLog<Data>::compact()
+{
+  if (!good_)
+    return false;
+  wait();
+  std::string image = Snapshot<Data>::image(db_, generation_);
+  uint32_t covered = generation_, first = firstLog_;
+  if (!startLog(generation_ + 1))
+    return false;
+  firstLog_ = covered + 1;
+  std::string base = base_, snap = snapshotFile();
+  compactor_ = std::thread([image = std::move(image), base, snap, first, covered]() {
+    std::string tmp = snap + ".tmp";
+    if (!Snapshot<Data>::write(image, tmp))
+      return;
+    std::remove(snap.c_str());
+    if (std::rename(tmp.c_str(), snap.c_str()) != 0)
+      return;
+    for (uint32_t g = first; g <= covered; ++g)
+      std::remove(logFile(base, g).c_str());
+  });
+  return true;
+}
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // Queries.cpp:  Implemts various methods supporting Db Queries  //
-// ver 1.0                                                       //
+// ver 1.1                                                       //
 // Application: Key Value DataBase, Spring 2017                  //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015          //
 // Author:      Chandra Harsha Jupalli, OOD Project1             //
@@ -21,10 +21,68 @@ using StrData = std::string;
 using intData = int;
 using Data = std::string;
 
+//pattern compiles s once, later queries with the same s reuse it
+const Queries::Pattern& Queries::pattern(const std::string& s) {
+	auto iter = patterns_.find(s);
+	if (iter != patterns_.end())
+		return iter->second;
+	Pattern p;
+	p.regex = std::regex("[a-z1-9]*(" + s + ")[a-z1-9]*");
+	p.literal = s.find_first_of(".[]{}()*+?^$|\\") == std::string::npos;
+	return patterns_.emplace(s, p).first->second;
+}
+
+//a literal s must occur in value for the regex to match, that test is much cheaper
+bool Queries::matches(const std::string& value, const std::string& s) {
+	const Pattern& p = pattern(s);
+	if (p.literal && value.find(s) == std::string::npos)
+		return false;
+	return regex_match(value, p.regex);
+}
+
+//distinct names of db and how many elements have each, rebuilt when db changes
+const Queries::NameList& Queries::nameList(const NoSqlDb<StrData>& db) {
+	if (nameList_.pDb == &db && nameList_.version == db.version())
+		return nameList_;
+	nameList_.pDb = &db;
+	nameList_.version = db.version();
+	nameList_.names.clear();
+	nameList_.counts.clear();
+	for (auto& item : db.nameIndex()) {
+		nameList_.names.push_back(item.first);
+		nameList_.counts.push_back(item.second.size());
+	}
+	return nameList_;
+}
+
+//names of all elements whose name matches s, each distinct name is matched once
+vector<std::string> Queries::namesMatching(const NoSqlDb<StrData>& db, const std::string& s) {
+	std::vector<std::string> result;
+	const NameList& list = nameList(db);
+	for (size_t i = 0; i < list.names.size(); i++) {
+		if (matches(list.names[i], s))
+			result.insert(result.end(), list.counts[i], list.names[i]);
+	}
+	return result;
+}
+
+//names of the elements of keys whose name matches s, in the order of keys
+vector<std::string> Queries::namesOfKeysMatching(const NoSqlDb<StrData>& db, const Keys& keys, const std::string& s) {
+	std::vector<std::string> result;
+	for (const Key& k : keys) {
+		const Element<Data>* pElem = db.find(k);
+		std::string name = pElem ? std::string(pElem->name) : std::string();
+		if (matches(name, s))
+			result.push_back(name);
+	}
+	return result;
+}
+
 //Query to implement requirement 7a of finding value of given key
-void Queries::ValueOfKey(Key k, NoSqlDb<StrData> db) {
+void Queries::ValueOfKey(Key k, const NoSqlDb<StrData>& db) {
 	std::cout << "\n---- Value of Specified Key Element1's name elem1-------\n";
-		std::string temp = db.value(k).name;
+		const Element<Data>* pElem = db.find(k);
+		std::string temp = pElem ? std::string(pElem->name) : std::string();
 		if ((temp != "\0"))
 			std::cout << " Key's value is--> " << temp<<"\n";
 		if (temp == "\0")
@@ -32,10 +90,13 @@ void Queries::ValueOfKey(Key k, NoSqlDb<StrData> db) {
 }
 
 //Query to implement requirement 7b of finding children of given key
-void Queries::ChildrenOfKey(Key k, NoSqlDb<StrData> db)
+void Queries::ChildrenOfKey(Key k, const NoSqlDb<StrData>& db)
 {
 	std::cout << "\n---- Children of Specified Key Element2's elem2 name-------\n";
-	std::vector<std::string> temp = db.value(k).children;
+	const Element<Data>* pElem = db.find(k);
+	std::vector<std::string> temp;
+	if (pElem)
+		temp = pElem->children;
 	for (int i = 0; i < (int)temp.size(); i++) {
 		std::cout <<"Children of key "<<k<<"is "<< temp[i] << " ";
 		cout << "\n";
@@ -45,33 +106,22 @@ void Queries::ChildrenOfKey(Key k, NoSqlDb<StrData> db)
 }
 
 //Query to implement requirement 7c of finding all keys with specific pattern in name
-vector<std::string> Queries::SpecifiedName(NoSqlDb<StrData> db,std::string s) {
-	std::vector<std::string> result;
-	Keys k2 = db.keys();
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : k2) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::SpecifiedName(const NoSqlDb<StrData>& db,std::string s) {
+	std::vector<std::string> result = namesMatching(db, s);
 	if (result.size() == 0)
 		cout << "No element with specified name";
 	return result;
 }
 
 //Query to implement requirement 7d of finding all keys with specific pattern in category
-vector<std::string> Queries::SpecifiedCategory(NoSqlDb<StrData> db, std::string s) {
+//- each distinct category is matched once, then all of its elements are taken
+vector<std::string> Queries::SpecifiedCategory(const NoSqlDb<StrData>& db, std::string s) {
 	std::vector<std::string> result;
-	Keys k2 = db.keys();
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : k2) {
-		Element<Data> res = db.value(k);
-		std::string name = res.category;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
+	for (auto& item : db.categoryIndex()) {
+		if (!matches(item.first, s))
+			continue;
+		for (const Key& k : item.second)
+			result.push_back(db.find(k)->name);
 	}
 	if (result.size() == 0)
 		cout << "No element with similar category patern";
@@ -80,89 +130,59 @@ vector<std::string> Queries::SpecifiedCategory(NoSqlDb<StrData> db, std::string
 }
 
 //Query to implement requirement 7e of finding all keys with specific pattern in key
-vector<std::string> Queries::patternSimilarToKey(NoSqlDb<StrData> db, std::string s) {
-	std::vector<std::string> result;
-	Keys k2 = db.keys();
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : k2) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::patternSimilarToKey(const NoSqlDb<StrData>& db, std::string s) {
+	std::vector<std::string> result = namesMatching(db, s);
 	if (result.size() == 0)
 		cout << "No element with similar pattern";
 	return result;
 }
 
 //Query to implement requirement 7f of finding all keys with specific data present in value of key as queried
-vector<std::string> Queries::DataMakingSense(NoSqlDb<StrData> db, std::string s) {
-	std::vector<std::string> result;
-	Keys k2 = db.keys();
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : k2) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::DataMakingSense(const NoSqlDb<StrData>& db, std::string s) {
+	std::vector<std::string> result = namesMatching(db, s);
 	if (result.size() == 0)
 		cout << "No element with similar pattern";
 	return result;
 }
 
 //Query to implement requirement 8 of taking input from previous queries
-vector<std::string> Queries::KeysByEarlierQuery(NoSqlDb<StrData> db, Keys keys,std::string s) {
-	std::vector<std::string> result;
-	
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : keys) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::KeysByEarlierQuery(const NoSqlDb<StrData>& db, const Keys& keys,std::string s) {
+	std::vector<std::string> result = namesOfKeysMatching(db, keys, s);
 	if (result.size() == 0)
 		cout << "No element with similar pattern";
 	return result;
 }
 //Query to implement requirement 8 of taking input from previous queries
-vector<std::string> Queries::KeysByEarlierQuery2(NoSqlDb<StrData> db, Keys keys, std::string s) {
-	std::vector<std::string> result;
-
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : keys) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::KeysByEarlierQuery2(const NoSqlDb<StrData>& db, const Keys& keys, std::string s) {
+	std::vector<std::string> result = namesOfKeysMatching(db, keys, s);
 	if (result.size() == 0)
 		cout << "No element with similar pattern";
 	return result;
 }
 
 //Query to implement requirement 9 of taking input as union of keys from previous queries
-vector<std::string> Queries::unionOfKeys(NoSqlDb<StrData> db, Keys keys, std::string s) {
-	std::vector<std::string> result;
-
-	std::regex r("[a-z1-9]*(" + s + ")[a-z1-9]*");
-	for (Key k : keys) {
-		Element<Data> res = db.value(k);
-		std::string name = res.name;
-		if (regex_match(name, r)) {
-			result.push_back(res.name);
-		}
-	}
+vector<std::string> Queries::unionOfKeys(const NoSqlDb<StrData>& db, const Keys& keys, std::string s) {
+	std::vector<std::string> result = namesOfKeysMatching(db, keys, s);
 	if (result.size() == 0)
 		cout << "No element with similar pattern";
 	return result;
 }
 
+//Query to implement requirement 10 of finding keys with timeDate in [time1, time2]
+//- an empty time2 leaves the interval open, and an empty input means every key
+Keys Queries::MatchKeysWithInTimeInterval(const NoSqlDb<StrData>& db, const Keys& input, std::string time1, std::string time2) {
+	Keys inTime = db.keysInTime(time1, time2);
+	if (input.empty())
+		return inTime;
+	std::set<Key> wanted(input.begin(), input.end());
+	Keys result;
+	for (const Key& k : inTime) {
+		if (wanted.count(k) > 0)
+			result.push_back(k);
+	}
+	return result;
+}
+
 #ifdef Queries
 vector<std::string> Queries::unionOfKeys(NoSqlDb<StrData> db, Keys keys, std::string s) {
 	std::vector<std::string> result;
@@ -1,7 +1,7 @@
 #pragma once
 ///////////////////////////////////////////////////////////////////////////////////
 // Queries.h:  contains methods implementing queries supported by DataBase       //
-// ver 1.0                                                                       //
+// ver 1.1                                                                       //
 // Application: Key Value DataBase, Spring 2017                                  //
 // Platform:    LenovoFlex4, Win 10, Visual Studio 2015                          //
 // Author:      Chandra Harsha Jupalli, OOD Project1                             //
@@ -13,6 +13,15 @@
 * This package provides the interface and implementation of various queries 
 * supported by No SqlData Base.
 *
+* Queries take the database by reference and read it in place, through
+* find and the database's name, category, and timeDate indexes, so a
+* query never copies the store or its elements.  Each pattern is
+* compiled once and cached, and a pattern holding no regex operators is
+* first looked for as a substring, so most names are rejected without
+* running the regex.  Distinct names are copied into one vector, which
+* is scanned much faster than the index's nodes, and rebuilt only when
+* the database's version changes.
+*
 * Required Files:
 * ---------------
 *   - NoSqlDb.h,NoSqlDb.cpp
@@ -20,12 +29,13 @@
 *
 * PublicInterface
 * ----------------
-* SpecifiedName(NoSqlDb<StrData> db,std::string s)                
-* SpecifiedCategory(NoSqlDb<StrData> db,std::string s)             
-* patternSimilarToKey(NoSqlDb<StrData> db,std::string s)          
-* DataMakingSense(NoSqlDb<StrData> db, std::string s)
-* KeysByEarlierQuery(NoSqlDb<StrData> db, Keys keys,std::string s)
-* unionOfKeys(NoSqlDb<StrData> db, Keys keys,std::string s)
+* SpecifiedName(const NoSqlDb<StrData>& db,std::string s)                
+* SpecifiedCategory(const NoSqlDb<StrData>& db,std::string s)             
+* patternSimilarToKey(const NoSqlDb<StrData>& db,std::string s)          
+* DataMakingSense(const NoSqlDb<StrData>& db, std::string s)
+* KeysByEarlierQuery(const NoSqlDb<StrData>& db, const Keys& keys,std::string s)
+* unionOfKeys(const NoSqlDb<StrData>& db, const Keys& keys,std::string s)
+* MatchKeysWithInTimeInterval(const NoSqlDb<StrData>& db, const Keys& input, time1, time2)
 *
 *
 * Build Process:
@@ -34,11 +44,17 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.1 : 14 Oct 2026
+* - queries take the database by const reference and use its indexes
+* - compiled patterns are cached, literal patterns are prefiltered
+* - implemented MatchKeysWithInTimeInterval on the timeDate index
 * Ver 1.0 : 7 February 2017
 * - first release
 *
 */
 #include  "../NoSqlDb/NoSqlDb.h"
+#include <regex>
+#include <unordered_map>
 using StrData = std::string;
 using Key = NoSqlDb<StrData>::Key;
 using Keys = NoSqlDb<StrData>::Keys;
@@ -47,21 +63,36 @@ class Queries
 {
 public:
 	Queries()  {}
-//	Queries(NoSqlDb<StrData> db) : db_(db) {};
-	void ValueOfKey(Key k,NoSqlDb<StrData> t);
-	void ChildrenOfKey(Key k, NoSqlDb<StrData> t);
-	std::vector<std::string>  SpecifiedName(NoSqlDb<Data> db,std::string s);
-	std::vector<std::string> SpecifiedCategory(NoSqlDb<StrData> db,std::string s);
-	std::vector<std::string> patternSimilarToKey(NoSqlDb<StrData> db, std::string s);
-	std::vector<std::string> DataMakingSense(NoSqlDb<StrData> db, std::string s);
-	std::vector<std::string> KeysByEarlierQuery(NoSqlDb<StrData> db, Keys keys,std::string s);
-	std::vector<std::string> KeysByEarlierQuery2(NoSqlDb<StrData> db, Keys keys, std::string s);
-	std::vector<std::string> unionOfKeys(NoSqlDb<StrData> db, Keys keys,std::string s);
+	void ValueOfKey(Key k, const NoSqlDb<StrData>& t);
+	void ChildrenOfKey(Key k, const NoSqlDb<StrData>& t);
+	std::vector<std::string>  SpecifiedName(const NoSqlDb<Data>& db,std::string s);
+	std::vector<std::string> SpecifiedCategory(const NoSqlDb<StrData>& db,std::string s);
+	std::vector<std::string> patternSimilarToKey(const NoSqlDb<StrData>& db, std::string s);
+	std::vector<std::string> DataMakingSense(const NoSqlDb<StrData>& db, std::string s);
+	std::vector<std::string> KeysByEarlierQuery(const NoSqlDb<StrData>& db, const Keys& keys,std::string s);
+	std::vector<std::string> KeysByEarlierQuery2(const NoSqlDb<StrData>& db, const Keys& keys, std::string s);
+	std::vector<std::string> unionOfKeys(const NoSqlDb<StrData>& db, const Keys& keys,std::string s);
 
 
-	Keys MatchKeysWithInTimeInterval(NoSqlDb<StrData> db,Keys input, std::string time1, std::string time2);
+	Keys MatchKeysWithInTimeInterval(const NoSqlDb<StrData>& db, const Keys& input, std::string time1, std::string time2);
 	
 
 private:
-	NoSqlDb<StrData> db_;
+	struct Pattern {
+		std::regex regex;
+		bool literal;
+	};
+	struct NameList {
+		const void* pDb = nullptr;
+		size_t version = 0;
+		std::vector<std::string> names;
+		std::vector<size_t> counts;
+	};
+	const NameList& nameList(const NoSqlDb<StrData>& db);
+	const Pattern& pattern(const std::string& s);
+	bool matches(const std::string& value, const std::string& s);
+	std::vector<std::string> namesMatching(const NoSqlDb<StrData>& db, const std::string& s);
+	std::vector<std::string> namesOfKeysMatching(const NoSqlDb<StrData>& db, const Keys& keys, const std::string& s);
+	std::unordered_map<std::string, Pattern> patterns_;
+	NameList nameList_;
 };
\ No newline at end of file
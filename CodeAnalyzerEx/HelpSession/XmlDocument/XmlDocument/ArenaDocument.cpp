@@ -0,0 +1,298 @@
+///////////////////////////////////////////////////////////////////
+// ArenaDocument.cpp - XML document held in a few flat arrays    //
+// ver 1.0                                                       //
+// Application: Support for XmlDocument, Summer 2015             //
+// Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
+// Author:      Jim Fawcett, CST 4-187, 443-3948                 //
+//              jfawcett@twcny.rr.com                            //
+///////////////////////////////////////////////////////////////////
+
+#include "ArenaDocument.h"
+#include "../XmlParser/XmlParser.h"
+#include "../XmlElement/XmlElement.h"
+
+using namespace XmlProcessing;
+
+namespace
+{
+  /////////////////////////////////////////////////////////////////
+  // ArenaBuilder adds the elements and text XmlStreamParser finds
+
+  class ArenaBuilder : public IXmlHandler
+  {
+  public:
+    ArenaBuilder(ArenaDocument& doc) : doc_(doc), stack_(1, doc.docElement()) {}
+    void startElement(const std::string& tag, const attribs& attributes)
+    {
+      ArenaDocument::Node node = doc_.addTagged(stack_.back(), tag);
+      for (auto& at : attributes)
+        doc_.addAttrib(node, at.first, at.second);
+      stack_.push_back(node);
+    }
+    void endElement(const std::string& tag) { stack_.pop_back(); }
+    void text(const std::string& text)
+    {
+      size_t first = text.find_first_not_of(" \t\r\n");
+      size_t last = text.find_last_not_of(" \t\r\n");
+      doc_.addText(stack_.back(), text.substr(first, last - first + 1));
+    }
+  private:
+    ArenaDocument& doc_;
+    std::vector<ArenaDocument::Node> stack_;
+  };
+}
+//----< make document holding only the document element >--------------------
+
+ArenaDocument::ArenaDocument()
+{
+  clear();
+}
+//----< build document from XML file or string >-----------------------------
+
+ArenaDocument::ArenaDocument(const std::string& src, sourceType srcType)
+{
+  clear();
+  XmlStreamParser parser(src, srcType == file ? XmlParser::file : XmlParser::str);
+  ArenaBuilder builder(*this);
+  parser.parse(builder);
+}
+//----< make room for nodes and chars of text before building >--------------
+
+void ArenaDocument::reserve(size_t nodes, size_t chars)
+{
+  nodes_.reserve(nodes);
+  chars_.reserve(chars);
+}
+//----< remove everything but the document element >-------------------------
+
+void ArenaDocument::clear()
+{
+  nodes_.clear();
+  attribs_.clear();
+  names_.clear();
+  nameIds_.clear();
+  chars_.clear();
+  NodeRec docRec = { docNode, 0, 0, 0, none, none, none, none, none };
+  nodes_.push_back(docRec);
+}
+//----< number of name, adding it if new >-----------------------------------
+
+uint32_t ArenaDocument::intern(const std::string& name)
+{
+  auto iter = nameIds_.find(name);
+  if (iter != nameIds_.end())
+    return iter->second;
+  uint32_t id = (uint32_t)names_.size();
+  names_.push_back(name);
+  nameIds_[name] = id;
+  return id;
+}
+//----< number of name, false if no node or attribute uses it >--------------
+
+bool ArenaDocument::lookup(const std::string& name, uint32_t& id) const
+{
+  auto iter = nameIds_.find(name);
+  if (iter == nameIds_.end())
+    return false;
+  id = iter->second;
+  return true;
+}
+//----< append text to the character pool, returning its offset >------------
+
+uint32_t ArenaDocument::store(const std::string& text)
+{
+  uint32_t offset = (uint32_t)chars_.size();
+  chars_ += text;
+  return offset;
+}
+//----< link new node as parent's last child >-------------------------------
+
+ArenaDocument::Node ArenaDocument::add(Node parent, Kind kind, uint32_t name, const std::string& text)
+{
+  Node node = (Node)nodes_.size();
+  NodeRec rec = { kind, name, store(text), (uint32_t)text.size(), parent, none, none, none, none };
+  nodes_.push_back(rec);
+  NodeRec& parentRec = nodes_[parent];
+  if (parentRec.lastChild == none)
+    parentRec.firstChild = node;
+  else
+    nodes_[parentRec.lastChild].next = node;
+  parentRec.lastChild = node;
+  return node;
+}
+
+ArenaDocument::Node ArenaDocument::addTagged(Node parent, const std::string& tag)
+{
+  return add(parent, taggedNode, intern(tag), "");
+}
+
+ArenaDocument::Node ArenaDocument::addText(Node parent, const std::string& text)
+{
+  return add(parent, textNode, 0, text);
+}
+
+ArenaDocument::Node ArenaDocument::addComment(Node parent, const std::string& text)
+{
+  return add(parent, commentNode, 0, text);
+}
+//----< add attribute, after any node already has >--------------------------
+
+void ArenaDocument::addAttrib(Node node, const std::string& name, const std::string& value)
+{
+  uint32_t at = (uint32_t)attribs_.size();
+  AttribRec rec = { intern(name), store(value), (uint32_t)value.size(), none };
+  attribs_.push_back(rec);
+  uint32_t* pLink = &nodes_[node].firstAttrib;
+  while (*pLink != none)
+    pLink = &attribs_[*pLink].next;
+  *pLink = at;
+}
+//----< text of text or comment node, empty for others >---------------------
+
+std::string ArenaDocument::text(Node node) const
+{
+  const NodeRec& rec = nodes_[node];
+  return chars_.substr(rec.offset, rec.length);
+}
+//----< name-value pairs of node's attributes >------------------------------
+
+ArenaDocument::attribs ArenaDocument::attributes(Node node) const
+{
+  attribs result;
+  for (uint32_t at = nodes_[node].firstAttrib; at != none; at = attribs_[at].next)
+    result.push_back(attrib(names_[attribs_[at].name], chars_.substr(attribs_[at].offset, attribs_[at].length)));
+  return result;
+}
+//----< node's children, in order >------------------------------------------
+
+std::vector<ArenaDocument::Node> ArenaDocument::children(Node node) const
+{
+  std::vector<Node> result;
+  for (Node child = nodes_[node].firstChild; child != none; child = nodes_[child].next)
+    result.push_back(child);
+  return result;
+}
+//----< first tagged child of the document element, none if empty >---------
+
+ArenaDocument::Node ArenaDocument::xmlRoot() const
+{
+  for (Node child = nodes_[0].firstChild; child != none; child = nodes_[child].next)
+    if (nodes_[child].kind == taggedNode)
+      return child;
+  return none;
+}
+//----< first element with tag in DFS order under from, none if none >------
+
+ArenaDocument::Node ArenaDocument::element(const std::string& tag, Node from) const
+{
+  if (nodes_[from].kind == taggedNode && (tag.empty() || this->tag(from) == tag))
+    return from;
+  std::vector<Node> found = descendents(from, tag);
+  return found.empty() ? none : found[0];
+}
+//----< tagged elements with tag under node, DFS order, node excluded >------
+
+std::vector<ArenaDocument::Node> ArenaDocument::descendents(Node node, const std::string& tag) const
+{
+  std::vector<Node> found;
+  uint32_t id = 0;
+  bool any = tag.empty();
+  if (!any && !lookup(tag, id))
+    return found;
+  auto match = [&](const ArenaDocument&, Node current) {
+    const NodeRec& rec = nodes_[current];
+    if (current != node && rec.kind == taggedNode && (any || rec.name == id))
+      found.push_back(current);
+  };
+  DFS(node, match);
+  return found;
+}
+//----< same text as XmlDocument::toString for the same tree >---------------
+
+std::string ArenaDocument::toString() const
+{
+  std::string xml;
+  xml.reserve(chars_.size() + 32 * nodes_.size());
+  XmlWriter writer(xml);
+  write(writer);
+  return xml;
+}
+//----< write document with out, which may escape text or go to a file >----
+
+void ArenaDocument::write(XmlWriter& out) const
+{
+  for (Node child = nodes_[0].firstChild; child != none; child = nodes_[child].next)
+    write(child, 1, out);
+}
+
+void ArenaDocument::write(Node node, size_t depth, XmlWriter& out) const
+{
+  const NodeRec& rec = nodes_[node];
+  out.newLine(depth);
+  if (rec.kind == textNode)
+  {
+    out.text(chars_.data() + rec.offset, rec.length);
+    return;
+  }
+  if (rec.kind == commentNode)
+  {
+    out.raw("<!-- ", 5);
+    out.raw(chars_.data() + rec.offset, rec.length);
+    out.raw(" -->", 4);
+    return;
+  }
+  out.raw("<", 1);
+  out.raw(names_[rec.name]);
+  for (uint32_t at = rec.firstAttrib; at != none; at = attribs_[at].next)
+  {
+    out.raw(" ", 1);
+    out.raw(names_[attribs_[at].name]);
+    out.raw("=\"", 2);
+    out.attribute(chars_.data() + attribs_[at].offset, attribs_[at].length);
+    out.raw("\"", 1);
+  }
+  out.raw(">", 1);
+  for (Node child = rec.firstChild; child != none; child = nodes_[child].next)
+    write(child, depth + 1, out);
+  out.newLine(depth);
+  out.raw("</", 2);
+  out.raw(names_[rec.name]);
+  out.raw(">", 1);
+}
+
+#ifdef TEST_ARENADOCUMENT
+
+#include <iostream>
+#include "XmlDocument.h"
+
+int main()
+{
+  std::cout << "\n  Testing ArenaDocument";
+  std::cout << "\n =======================\n";
+
+  ArenaDocument doc;
+  XmlDocument::sPtr pRoot = makeTaggedElement("DataBase");
+  XmlDocument tree(makeDocElement(pRoot));
+  ArenaDocument::Node root = doc.addTagged(doc.docElement(), "DataBase");
+  for (int i = 0; i < 3; ++i)
+  {
+    std::string name = "elem" + std::to_string(i);
+    ArenaDocument::Node elem = doc.addTagged(root, "Name");
+    doc.addAttrib(elem, "id", std::to_string(i));
+    doc.addText(elem, name);
+    XmlDocument::sPtr pElem = makeTaggedElement("Name");
+    pElem->addAttrib("id", std::to_string(i));
+    pElem->addChild(makeTextElement(name));
+    pRoot->addChild(pElem);
+  }
+  std::cout << doc.toString();
+  std::cout << "\n\n  same text as XmlDocument: " << (doc.toString() == tree.toString() ? "yes" : "no");
+
+  ArenaDocument parsed(doc.toString());
+  std::vector<ArenaDocument::Node> names = parsed.descendents(parsed.xmlRoot(), "Name");
+  std::cout << "\n  parsed " << parsed.size() << " nodes, " << names.size() << " Name elements";
+  for (ArenaDocument::Node name : names)
+    std::cout << "\n    id " << parsed.attributes(name)[0].second << ": " << parsed.text(parsed.firstChild(name));
+  std::cout << "\n\n";
+}
+#endif
@@ -0,0 +1,174 @@
+#ifndef ARENADOCUMENT_H
+#define ARENADOCUMENT_H
+///////////////////////////////////////////////////////////////////
+// ArenaDocument.h - XML document held in a few flat arrays      //
+// ver 1.0                                                       //
+// Application: Support for XmlDocument, Summer 2015             //
+// Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
+// Author:      Jim Fawcett, CST 4-187, 443-3948                 //
+//              jfawcett@twcny.rr.com                            //
+///////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* ArenaDocument is a variant of XmlDocument for large documents, e.g.,
+* a database export.  XmlDocument allocates every element on its own
+* and links them with shared_ptrs, so building a tree is bound by the
+* allocator and walking or querying it by reference count updates.
+*
+* An ArenaDocument keeps all of its nodes in one vector and refers to
+* them by index, a Node.  Node 0 is the document element.  Each node
+* links to its parent, first and last child, and next sibling by index.
+* Tag and attribute names are interned, each distinct name is stored
+* once and nodes hold its number, so queries compare numbers, not
+* strings.  Text, comment text, and attribute values are appended to
+* one character pool.  Building a document of n nodes makes a handful
+* of allocations as the arrays grow, none if they are reserved first.
+*
+* Nodes are only added, never removed.  A Node stays valid for the
+* life of the document.  toString() makes the same text as
+* XmlDocument::toString() for the same tree, write(writer) sends it
+* through an XmlWriter, e.g., escaped, or straight to a file.  Parsed text is trimmed
+* of the whitespace toString() puts around it, so a document parsed
+* from its own toString() has the same tree.
+*
+* Public Interface:
+* -----------------
+* ArenaDocument doc;
+* Node root = doc.addTagged(doc.docElement(), "DataBase");
+* Node name = doc.addTagged(root, "Name");
+* doc.addText(name, "elem1");
+* doc.addAttrib(root, "version", "1");
+* std::vector<Node> names = doc.descendents(root, "Name");
+* std::string text = doc.text(doc.firstChild(names[0]));
+* std::string xml = doc.toString();
+* XmlWriter writer(file, true);                                   // escaped, see XmlElement.h
+* doc.write(writer);
+* ArenaDocument parsed("../StringDB.xml", ArenaDocument::file);  // uses XmlStreamParser
+*
+* Required Files:
+* ---------------
+*   - ArenaDocument.h, ArenaDocument.cpp,
+*     XmlParser.h, XmlParser.cpp, XmlElement.h, XmlElement.cpp
+*
+* Build Process:
+* --------------
+*   devenv AST.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace XmlProcessing
+{
+  class XmlWriter;
+
+  ///////////////////////////////////////////////////////////////////////////
+  // ArenaDocument class
+
+  class ArenaDocument
+  {
+  public:
+    using Node = uint32_t;
+    using attrib = std::pair < std::string, std::string >;
+    using attribs = std::vector < attrib >;
+    enum Kind : uint32_t { docNode, taggedNode, textNode, commentNode };
+    enum sourceType { file, str };
+    static const Node none = 0xffffffff;
+
+    // construction
+
+    ArenaDocument();
+    ArenaDocument(const std::string& src, sourceType srcType = str);
+    void reserve(size_t nodes, size_t chars);
+    void clear();
+
+    // building
+
+    Node docElement() const { return 0; }
+    Node addTagged(Node parent, const std::string& tag);
+    Node addText(Node parent, const std::string& text);
+    Node addComment(Node parent, const std::string& text);
+    void addAttrib(Node node, const std::string& name, const std::string& value);
+
+    // access
+
+    size_t size() const { return nodes_.size(); }
+    Kind kind(Node node) const { return nodes_[node].kind; }
+    const std::string& tag(Node node) const { return names_[nodes_[node].name]; }
+    std::string text(Node node) const;
+    attribs attributes(Node node) const;
+    Node parent(Node node) const { return nodes_[node].parent; }
+    Node firstChild(Node node) const { return nodes_[node].firstChild; }
+    Node nextSibling(Node node) const { return nodes_[node].next; }
+    std::vector<Node> children(Node node) const;
+    Node xmlRoot() const;
+
+    // queries, tag "" matches every tagged element
+
+    Node element(const std::string& tag, Node from = 0) const;
+    std::vector<Node> descendents(Node node, const std::string& tag = "") const;
+    template<typename CallObj>
+    void DFS(Node node, CallObj& co) const;
+    std::string toString() const;
+    void write(XmlWriter& out) const;
+  private:
+    struct NodeRec
+    {
+      Kind kind;
+      uint32_t name;       // interned tag of tagged elements
+      uint32_t offset;     // text in chars_ of text and comment elements
+      uint32_t length;
+      Node parent;
+      Node firstChild;
+      Node lastChild;
+      Node next;
+      uint32_t firstAttrib;
+    };
+    struct AttribRec
+    {
+      uint32_t name;
+      uint32_t offset;
+      uint32_t length;
+      uint32_t next;
+    };
+    Node add(Node parent, Kind kind, uint32_t name, const std::string& text);
+    uint32_t intern(const std::string& name);
+    bool lookup(const std::string& name, uint32_t& id) const;
+    uint32_t store(const std::string& text);
+    void write(Node node, size_t depth, XmlWriter& out) const;
+
+    std::vector<NodeRec> nodes_;
+    std::vector<AttribRec> attribs_;
+    std::vector<std::string> names_;
+    std::unordered_map<std::string, uint32_t> nameIds_;
+    std::string chars_;
+  };
+
+  //----< depth first walk of node's subtree, co(doc, node) for each node >--
+
+  template<typename CallObj>
+  void ArenaDocument::DFS(Node node, CallObj& co) const
+  {
+    std::vector<Node> stack(1, node);
+    while (!stack.empty())
+    {
+      Node current = stack.back();
+      stack.pop_back();
+      co(*this, current);
+      size_t mark = stack.size();
+      for (Node child = nodes_[current].firstChild; child != none; child = nodes_[child].next)
+        stack.push_back(child);
+      std::reverse(stack.begin() + mark, stack.end());
+    }
+  }
+}
+#endif
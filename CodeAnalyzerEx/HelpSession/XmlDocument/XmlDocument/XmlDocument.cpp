@@ -9,6 +9,7 @@
 
 #include <iostream>
 #include <functional>
+#include <algorithm>
 #include "XmlDocument.h"
 #include "..\XmlParser\XmlParser.h"
 #include "../Utilities/Utilities.h"
@@ -19,11 +20,13 @@ using sPtr = std::shared_ptr < AbstractXmlElement > ;
 /////////////////////////////////////////////////////////////////////////////
 // Definitions of XmlDocument methods
 
-XmlProcessing::XmlDocument::XmlDocument(const std::string& src, sourceType srcType)
+XmlProcessing::XmlDocument::XmlDocument(const std::string& src, sourceType srcType, bool index)
 {
   XmlParser parser(src, (XmlParser::sourceType) srcType);
   XmlDocument* pDoc = parser.buildDocument();
   *this = std::move(*pDoc);
+  if (index)
+    buildIndex();
 }
 //----< move constructor >---------------------------------------------------
 
@@ -31,6 +34,7 @@ XmlDocument::XmlDocument(XmlDocument&& doc)
 {
   pDocElement_ = doc.pDocElement_;
   doc.pDocElement_ = nullptr;
+  pIndex_ = std::move(doc.pIndex_);
 }
 //----< move assignment >----------------------------------------------------
 
@@ -39,6 +43,7 @@ XmlDocument& XmlDocument::operator=(XmlDocument&& doc)
   if (&doc == this) return *this;
   pDocElement_ = doc.pDocElement_;
   doc.pDocElement_ = nullptr;
+  pIndex_ = std::move(doc.pIndex_);
   return *this;
 }
 //----< return std::shared_ptr to XML root >---------------------------------
@@ -56,7 +61,59 @@ sPtr XmlDocument::xmlRoot()
 
 bool XmlDocument::xmlRoot(sPtr pRoot)
 {
-  return pDocElement_->addChild(pRoot);
+  bool added = pDocElement_->addChild(pRoot);
+  if (added && pIndex_)
+    buildIndex();
+  return added;
+}
+//----< index every element by DFS position and by tag >---------------------
+
+void XmlDocument::buildIndex()
+{
+  pIndex_.reset(new Index);
+  if (pDocElement_)
+    indexSubtree(pDocElement_);
+}
+//----< number pElem and its descendents, in the order find visits them >----
+
+void XmlDocument::indexSubtree(sPtr pElem)
+{
+  size_t pos = pIndex_->order.size();
+  pIndex_->order.push_back(pElem);
+  pIndex_->ends.push_back(pos + 1);
+  pIndex_->position[pElem.get()] = pos;
+  std::string tag = pElem->tag();
+  if (tag != "")
+    pIndex_->byTag[tag].push_back(pos);
+  for (auto pChild : pElem->children())
+    indexSubtree(pChild);
+  pIndex_->ends[pos] = pIndex_->order.size();
+}
+//----< add elements with tag in pElem's subtree to found_, from the index >--
+/*
+ *  - self false leaves out pElem, as descendents does
+ *  - returns false if pElem isn't indexed, so the caller walks instead
+ */
+bool XmlDocument::findIndexed(const std::string& tag, const AbstractXmlElement* pElem, bool self)
+{
+  auto iter = pIndex_->position.find(pElem);
+  if (iter == pIndex_->position.end())
+    return false;
+  size_t first = self ? iter->second : iter->second + 1;
+  size_t end = pIndex_->ends[iter->second];
+  if (tag == "")
+  {
+    for (size_t pos = first; pos < end; ++pos)
+      found_.push_back(pIndex_->order[pos]);
+    return true;
+  }
+  auto tagged = pIndex_->byTag.find(tag);
+  if (tagged == pIndex_->byTag.end())
+    return true;
+  const std::vector<size_t>& positions = tagged->second;
+  for (auto pos = std::lower_bound(positions.begin(), positions.end(), first); pos != positions.end() && *pos < end; ++pos)
+    found_.push_back(pIndex_->order[*pos]);
+  return true;
 }
 //----< find element(s) with this tag >--------------------------------------
 /*
@@ -69,7 +126,11 @@ bool XmlDocument::find(const std::string& tag, sPtr pElem, bool findall)
     found_.push_back(pElem);
     if (!findall)
       return true;
+    if (pIndex_ && findIndexed(tag, pElem.get(), false))
+      return true;
   }
+  else if (pIndex_ && findIndexed(tag, pElem.get(), true))
+    return (found_.size() > 0);
   for (auto pChild : pElem->children())
     find(tag, pChild);
   return (found_.size() > 0);
@@ -111,6 +172,8 @@ XmlDocument& XmlDocument::descendents(const std::string& tag)
     found_.push_back(xmlRoot());
   sPtr pElem = found_[0];
   found_.clear();
+  if (pIndex_ && findIndexed(tag, pElem.get(), false))
+    return *this;
   for (auto pChild : pElem->children())
     find(tag, pChild, true);
   return *this;
@@ -125,6 +188,8 @@ std::vector<sPtr> XmlDocument::select()
 
 size_t XmlDocument::size()
 {
+  if (pIndex_ && pIndex_->order.size() > 0)
+    return pIndex_->order.size() - 1;  // don't count docElement
   find("", pDocElement_, true);
   size_t size_ = found_.size() - 1;  // don't count docElement
   found_.clear();
@@ -292,6 +357,16 @@ int main()
   testDescendents(doc);
   testElementDescendents(doc);
 
+  title("testing indexed queries return what the walks return");
+  size_t walked = doc.descendents("child1").select().size();
+  size_t walkedAll = doc.element("child1").descendents().select().size();
+  doc.buildIndex();
+  std::cout << "\n  indexed " << doc.size() << " elements";
+  std::cout << "\n  descendents(\"child1\"): " << doc.descendents("child1").select().size() << ", walk found " << walked;
+  std::cout << "\n  element(\"child1\").descendents(): " << doc.element("child1").descendents().select().size() << ", walk found " << walkedAll;
+  testElements(doc);
+  doc.dropIndex();
+
   std::string path = "../XmlElementParts/LectureNote.xml";
   title("Attempting to build document from fileSpec: " + path);
 
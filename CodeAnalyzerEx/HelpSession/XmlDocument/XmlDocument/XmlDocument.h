@@ -33,6 +33,16 @@
 *   ProcInstrElement   - XML element with markup and attributes but no children
 *   XmlDeclarElement   - XML declaration element with attributes but no children
 *
+* Queries walk the document, comparing tags, unless it is indexed.  buildIndex,
+* or constructing from XML with index = true, numbers the elements in DFS order,
+* records where each subtree ends, and lists the positions of each tag's
+* elements, once per distinct tag.  element, elements, descendents, find, and
+* size then look up the tag and take the positions inside the subtree searched,
+* so they cost the results found rather than the whole document, and return
+* the same elements, in the same order, as the walks.  The index is rebuilt when
+* xmlRoot(pRoot) adds a root; after editing elements directly call buildIndex
+* again, or dropIndex.
+*
 * Required Files:
 * ---------------
 *   - XmlDocument.h, XmlDocument.cpp, 
@@ -44,6 +54,9 @@
 *
 * Maintenance History:
 * --------------------
+* ver 2.3 : 14 Oct 2026
+* - added buildIndex, dropIndex, and indexed, an optional index of elements by
+*   tag and DFS position that the search methods use when it's built
 * ver 2.2 : 01 Jun 2015
 * - added building document from XML file using XmlParser in constructor
 * - added test to teststub
@@ -78,6 +91,8 @@
 
 #include <memory>
 #include <string>
+#include <vector>
+#include <unordered_map>
 #include "../XmlElement/XmlElement.h"
 
 namespace XmlProcessing
@@ -94,7 +109,7 @@ namespace XmlProcessing
     // construction and assignment
 
     XmlDocument(sPtr pRoot = nullptr) : pDocElement_(pRoot) {}
-    XmlDocument(const std::string& src, sourceType srcType=str);
+    XmlDocument(const std::string& src, sourceType srcType=str, bool index=false);
     XmlDocument(const XmlDocument& doc) = delete;
     XmlDocument(XmlDocument&& doc);
     XmlDocument& operator=(const XmlDocument& doc) = delete;
@@ -116,11 +131,29 @@ namespace XmlProcessing
 
     size_t size();
     std::string toString();
+
+    // optional index of elements by tag, used by the queries above
+
+    void buildIndex();
+    void dropIndex() { pIndex_.reset(); }
+    bool indexed() const { return pIndex_ != nullptr; }
+
     template<typename CallObj>
     void DFS(sPtr pElem, CallObj& co);
   private:
     sPtr pDocElement_;         // AST that holds procInstr, comments, XML root, and more comments
     std::vector<sPtr> found_;  // query results
+
+    struct Index
+    {
+      std::vector<sPtr> order;       // every element, in DFS order
+      std::vector<size_t> ends;      // position just past the subtree of order[i]
+      std::unordered_map<const AbstractXmlElement*, size_t> position;
+      std::unordered_map<std::string, std::vector<size_t>> byTag;  // positions, ascending
+    };
+    std::unique_ptr<Index> pIndex_;  // null unless buildIndex was called
+    void indexSubtree(sPtr pElem);
+    bool findIndexed(const std::string& tag, const AbstractXmlElement* pElem, bool self);
   };
 
   //----< search subtree of XmlDocument >------------------------------------
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
 // XmlElement.cpp - define XML Element types                     //
-// ver 1.7                                                       //
+// ver 1.8                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -324,6 +324,177 @@ std::string CommentElement::toString()
   return xml;
 }
 /////////////////////////////////////////////////////////////////////////////
+// write methods, same layout as the toString methods
+
+void DocElement::write(XmlWriter& out, size_t depth)
+{
+  for (auto& pChild : children_)
+    pChild->write(out, depth);
+}
+
+void TextElement::write(XmlWriter& out, size_t depth)
+{
+  out.newLine(depth);
+  out.text(text_);
+}
+
+void TaggedElement::write(XmlWriter& out, size_t depth)
+{
+  out.newLine(depth);
+  out.raw("<", 1);
+  out.raw(tag_);
+  for (auto& at : attribs_)
+  {
+    out.raw(" ", 1);
+    out.raw(at.first);
+    out.raw("=\"", 2);
+    out.attribute(at.second);
+    out.raw("\"", 1);
+  }
+  out.raw(">", 1);
+  for (auto& pChild : children_)
+    pChild->write(out, depth + 1);
+  out.newLine(depth);
+  out.raw("</", 2);
+  out.raw(tag_);
+  out.raw(">", 1);
+}
+
+void CommentElement::write(XmlWriter& out, size_t depth)
+{
+  out.newLine(depth);
+  out.raw("<!-- ", 5);
+  out.raw(commentText_);
+  out.raw(" -->", 4);
+}
+
+void ProcInstrElement::write(XmlWriter& out, size_t depth)
+{
+  out.newLine(depth);
+  out.raw("<!", 2);
+  for (auto& at : attribs_)
+  {
+    out.raw(" ", 1);
+    out.raw(at.first);
+    out.raw("=\"", 2);
+    out.attribute(at.second);
+    out.raw("\"", 1);
+  }
+  out.raw("!>", 2);
+}
+
+void XmlDeclarElement::write(XmlWriter& out, size_t depth)
+{
+  out.newLine(depth);
+  out.raw("<?xml", 5);
+  for (auto& at : attribs_)
+  {
+    out.raw(" ", 1);
+    out.raw(at.first);
+    out.raw("=\"", 2);
+    out.attribute(at.second);
+    out.raw("\"", 1);
+  }
+  out.raw(" ?>", 3);
+}
+/////////////////////////////////////////////////////////////////////////////
+// XmlWriter methods
+
+//----< append to caller's string >------------------------------------------
+
+XmlWriter::XmlWriter(std::string& out, bool escape) : pOut_(&out), escape_(escape) {}
+
+//----< append to a buffer, written to out each time it fills >--------------
+
+XmlWriter::XmlWriter(std::ostream& out, bool escape, size_t bufferSize)
+  : pOut_(&buffer_), pStream_(&out), bufferSize_(bufferSize), escape_(escape)
+{
+  buffer_.reserve(bufferSize_ + 256);
+}
+
+XmlWriter::~XmlWriter()
+{
+  flush();
+}
+//----< write elem and its subtree, elem's markup at depth 1 >---------------
+
+void XmlWriter::write(AbstractXmlElement& elem)
+{
+  elem.write(*this, 1);
+}
+//----< write buffered text to the stream, if any >--------------------------
+
+void XmlWriter::flush()
+{
+  if (pStream_ == nullptr)
+    return;
+  pStream_->write(buffer_.data(), buffer_.size());
+  bytes_ += buffer_.size();
+  buffer_.clear();
+  pStream_->flush();
+}
+//----< empty the buffer into the stream when it is full >-------------------
+
+void XmlWriter::spill()
+{
+  if (pStream_ == nullptr || buffer_.size() < bufferSize_)
+    return;
+  pStream_->write(buffer_.data(), buffer_.size());
+  bytes_ += buffer_.size();
+  buffer_.clear();
+}
+
+void XmlWriter::raw(const char* s, size_t n)
+{
+  pOut_->append(s, n);
+  spill();
+}
+//----< new line indented to depth, as toString does >-----------------------
+
+void XmlWriter::newLine(size_t depth)
+{
+  pOut_->push_back('\n');
+  pOut_->append(AbstractXmlElement::tabSize * depth, ' ');
+  spill();
+}
+//----< append s, replacing markup characters with entities if escaping >----
+
+void XmlWriter::escaped(const char* s, size_t n, bool quote)
+{
+  if (!escape_)
+  {
+    raw(s, n);
+    return;
+  }
+  struct Table
+  {
+    const char* entity[256];
+    Table()
+    {
+      for (const char*& e : entity)
+        e = nullptr;
+      entity['&'] = "&amp;";
+      entity['<'] = "&lt;";
+      entity['>'] = "&gt;";
+      entity['"'] = "&quot;";
+    }
+  };
+  static const Table table;
+  const char* run = s;
+  const char* end = s + n;
+  for (const char* p = run; p < end; ++p)
+  {
+    const char* entity = table.entity[(unsigned char)*p];
+    if (entity == nullptr || (*p == '"' && !quote))
+      continue;
+    pOut_->append(run, p);
+    pOut_->append(entity);
+    run = p + 1;
+  }
+  pOut_->append(run, end);
+  spill();
+}
+/////////////////////////////////////////////////////////////////////////////
 // Global Helper Methods
 
 //----< helper function displays titles >------------------------------------
@@ -355,6 +526,16 @@ int main()
 
   sPtr docEl = makeDocElement(root);
   std::cout << "  " << docEl->toString();
+
+  std::string xml;
+  XmlWriter writer(xml);
+  writer.write(*docEl);
+  std::cout << "\n\n  XmlWriter makes the same text: " << (xml == docEl->toString() ? "yes" : "no");
+  child->addChild(makeTextElement("1 < 2 & \"quoted\""));
+  std::cout << "\n  escaped:";
+  XmlWriter escaping(std::cout, true);
+  escaping.write(*child);
+  escaping.flush();
   std::cout << "\n\n";
 }
 
@@ -2,7 +2,7 @@
 #define XMLELEMENT_H
 ///////////////////////////////////////////////////////////////////
 // XmlElement.h - define XML Element types                       //
-// ver 1.7                                                       //
+// ver 1.8                                                       //
 // Application: Help for CSE687 Pr#2, Spring 2015                //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -33,6 +33,25 @@
 *   ProcInstrElement   - XML element with markup and attributes but no children
 *   XmlDeclarElement   - XML declaration
 *
+* XmlWriter writes an element tree into one output buffer, either a
+* string the caller provides or a buffer it empties into a stream each
+* time it fills, e.g., straight to an XML file.  Each element type
+* appends its own markup with write(writer, depth), so no intermediate
+* strings are made and no children() vectors copied.  The layout is
+* that of toString().  With escape set, &, <, and > in text and
+* attribute values, and " in attribute values, are written as entities,
+* looked up per character in a table.  toString() doesn't escape, so
+* escape defaults to false, to write the same text.
+*
+*   std::string xml;
+*   XmlWriter writer(xml);
+*   writer.write(*pDocElement);
+*
+*   std::ofstream file("Db.xml");
+*   XmlWriter fileWriter(file, true);
+*   fileWriter.write(*pDocElement);
+*   fileWriter.flush();                  // also done by the destructor
+*
 * Required Files:
 * ---------------
 *   - XmlElement.h, XmlElement.cpp
@@ -43,6 +62,8 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.8 : 14 Oct 2026
+* - added XmlWriter and write(writer, depth) for every element type
 * ver 1.7 : 16 Mar 2015
 * - added items to ToDo list
 * ver 1.6 : 08 Mar 2015
@@ -99,9 +120,47 @@
 #include <memory>
 #include <string>
 #include <vector>
+#include <ostream>
 
 namespace XmlProcessing
 {
+  class AbstractXmlElement;
+
+  /////////////////////////////////////////////////////////////////////////////
+  // XmlWriter - appends XML markup to one buffer
+
+  class XmlWriter
+  {
+  public:
+    XmlWriter(std::string& out, bool escape = false);
+    XmlWriter(std::ostream& out, bool escape = false, size_t bufferSize = 64 * 1024);
+    XmlWriter(const XmlWriter& writer) = delete;
+    XmlWriter& operator=(const XmlWriter& writer) = delete;
+    ~XmlWriter();
+    void write(AbstractXmlElement& elem);
+    void flush();
+    size_t bytes() const { return bytes_ + pOut_->size(); }
+
+    // used by elements' write
+
+    void newLine(size_t depth);
+    void raw(const std::string& s) { raw(s.data(), s.size()); }
+    void raw(const char* s, size_t n);
+    void text(const std::string& s) { escaped(s.data(), s.size(), false); }
+    void text(const char* s, size_t n) { escaped(s, n, false); }
+    void attribute(const std::string& s) { escaped(s.data(), s.size(), true); }
+    void attribute(const char* s, size_t n) { escaped(s, n, true); }
+  private:
+    void escaped(const char* s, size_t n, bool quote);
+    void spill();
+    std::string buffer_;
+    std::string* pOut_;
+    std::ostream* pStream_ = nullptr;
+    size_t bufferSize_ = 0;
+    size_t bytes_ = 0;
+    bool escape_;
+  };
+
   /////////////////////////////////////////////////////////////////////////////
   // AbstractXmlElement - base class for all concrete element types
 
@@ -118,8 +177,10 @@ namespace XmlProcessing
     virtual std::string tag() { return ""; }
     virtual std::string value() = 0;
     virtual std::string toString() = 0;
+    virtual void write(XmlWriter& out, size_t depth) = 0;
     virtual ~AbstractXmlElement();
   protected:
+    friend class XmlWriter;
     static size_t count;
     static size_t tabSize;
   };
@@ -149,6 +210,7 @@ namespace XmlProcessing
     virtual std::vector<sPtr> children();
     virtual std::string value();
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     bool hasXmlRoot();
     std::vector<std::shared_ptr<AbstractXmlElement>> children_;
@@ -172,6 +234,7 @@ namespace XmlProcessing
     TextElement& operator=(const TextElement& te) = delete;
     virtual std::string value();
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     std::string text_;
   };
@@ -198,6 +261,7 @@ namespace XmlProcessing
     virtual std::string tag();
     virtual std::string value();
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     std::string tag_;
     std::vector<std::shared_ptr<AbstractXmlElement>> children_;
@@ -225,6 +289,7 @@ namespace XmlProcessing
     CommentElement& operator=(const CommentElement& ce) = delete;
     virtual std::string value() { return commentText_; }
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     std::string commentText_ = "to be defined";
   };
@@ -246,6 +311,7 @@ namespace XmlProcessing
     virtual bool removeAttrib(const std::string& name);
     virtual std::string value() { return type_; }
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     std::vector<std::pair<std::string, std::string>> attribs_;
     std::string type_ = "xml declaration";
@@ -267,6 +333,7 @@ namespace XmlProcessing
     virtual bool removeAttrib(const std::string& name);
     virtual std::string value() { return ""; }
     virtual std::string toString();
+    virtual void write(XmlWriter& out, size_t depth);
   private:
     std::vector<std::pair<std::string, std::string>> attribs_;
     std::string type_ = "xml declaration";
@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////
-// XmlParser.cpp - build XML parse tree                          //
-// ver 1.3                                                       //
+// XmlParser.cpp - build XML parse tree, or stream its events   //
+// ver 1.4                                                       //
 // Application: Support for XmlDocument, Summer 2015             //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -18,6 +18,7 @@
 #include <locale>
 #include <fstream>
 #include <sstream>
+#include <algorithm>
 #include "../Utilities/Utilities.h"
 
 using namespace XmlProcessing;
@@ -328,11 +329,192 @@ XmlDocument* XmlParser::buildDocument()
   return pDoc;
 }
 
+//----< open file or string for a streaming parse >-------------------------
+
+XmlStreamParser::XmlStreamParser(const std::string& src, XmlParser::sourceType type, size_t chunkSize)
+  : chunkSize_(chunkSize > 0 ? chunkSize : 1)
+{
+  if (type == XmlParser::file)
+  {
+    pIn_.reset(new std::ifstream(src));
+    if (!pIn_->good())
+      throw(std::exception(("can't open source file " + src).c_str()));
+  }
+  else
+    pIn_.reset(new std::istringstream(src));
+}
+//----< has token_, which ends with '>', reached the end of its markup? >----
+
+bool XmlStreamParser::markupEnds() const
+{
+  size_t size = token_.size();
+  if (token_.compare(0, 4, "<!--") == 0)
+    return size >= 7 && token_.compare(size - 3, 3, "-->") == 0;
+  if (token_.compare(0, 9, "<![CDATA[") == 0)
+    return size >= 12 && token_.compare(size - 3, 3, "]]>") == 0;
+  return quote_ == 0;
+}
+//----< split start tag in token_ into name and attributes >-----------------
+
+void XmlStreamParser::parseTag(std::string& tag, IXmlHandler::attribs& attributes, bool& empty)
+{
+  std::locale loc;
+  size_t end = token_.size() - 1;
+  empty = end > 1 && token_[end - 1] == '/';
+  if (empty)
+    --end;
+  size_t pos = 1;
+  while (pos < end && !isspace(token_[pos], loc))
+    ++pos;
+  tag = token_.substr(1, pos - 1);
+  if (tag.empty())
+    throw(std::exception("ill-formed XML"));
+  attributes.clear();
+  while (true)
+  {
+    while (pos < end && isspace(token_[pos], loc))
+      ++pos;
+    if (pos == end)
+      return;
+    size_t nameStart = pos;
+    while (pos < end && token_[pos] != '=' && !isspace(token_[pos], loc))
+      ++pos;
+    std::string name = token_.substr(nameStart, pos - nameStart);
+    while (pos < end && isspace(token_[pos], loc))
+      ++pos;
+    if (pos == end || token_[pos] != '=')
+      throw(std::exception("ill-formed XML"));
+    ++pos;
+    while (pos < end && isspace(token_[pos], loc))
+      ++pos;
+    if (pos == end || (token_[pos] != '\"' && token_[pos] != '\''))
+      throw(std::exception("ill-formed XML"));
+    size_t close = token_.find(token_[pos], pos + 1);
+    if (close == std::string::npos || close >= end)
+      throw(std::exception("ill-formed XML"));
+    attributes.push_back(IXmlHandler::attrib(name, token_.substr(pos + 1, close - pos - 1)));
+    pos = close + 1;
+  }
+}
+//----< report markup in token_ to handler >---------------------------------
+
+void XmlStreamParser::processMarkup(IXmlHandler& handler)
+{
+  if (token_.compare(0, 9, "<![CDATA[") == 0)
+  {
+    if (!tags_.empty())
+      handler.text(token_.substr(9, token_.size() - 12));
+    return;
+  }
+  if (token_[1] == '?' || token_[1] == '!')
+    return;
+  if (token_[1] == '/')
+  {
+    std::string tag = token_.substr(2, token_.size() - 3);
+    tag.erase(std::find_if(tag.rbegin(), tag.rend(), [](char ch) { return !isspace((unsigned char)ch); }).base(), tag.end());
+    if (tags_.empty() || tags_.back() != tag)
+      throw(std::exception("ill-formed XML"));
+    tags_.pop_back();
+    handler.endElement(tag);
+    return;
+  }
+  std::string tag;
+  bool empty;
+  parseTag(tag, attribs_, empty);
+  handler.startElement(tag, attribs_);
+  if (empty)
+    handler.endElement(tag);
+  else
+    tags_.push_back(tag);
+}
+//----< report text in token_, unless it is only whitespace >----------------
+
+void XmlStreamParser::processText(IXmlHandler& handler)
+{
+  if (tags_.empty())
+    return;
+  for (char ch : token_)
+  {
+    if (!isspace((unsigned char)ch))
+    {
+      handler.text(token_);
+      return;
+    }
+  }
+}
+//----< read source a chunk at a time, calling handler for each event >------
+
+void XmlStreamParser::parse(IXmlHandler& handler)
+{
+  std::vector<char> chunk(chunkSize_);
+  bool inMarkup = false;
+  token_.clear();
+  tags_.clear();
+  quote_ = 0;
+  while (pIn_->read(chunk.data(), chunk.size()) || pIn_->gcount() > 0)
+  {
+    const char* pos = chunk.data();
+    const char* end = pos + pIn_->gcount();
+    bytesRead_ += (size_t)pIn_->gcount();
+    while (pos < end)
+    {
+      if (!inMarkup)
+      {
+        const char* open = std::find(pos, end, '<');
+        token_.append(pos, open);
+        pos = open;
+        if (pos == end)
+          break;
+        processText(handler);
+        token_ = "<";
+        ++pos;
+        inMarkup = true;
+        continue;
+      }
+      char ch = *pos++;
+      token_ += ch;
+      if (token_[1] != '!')  // '>' may be quoted in tags, quotes mean nothing in comments
+      {
+        if (quote_ != 0)
+        {
+          if (ch == quote_)
+            quote_ = 0;
+          continue;
+        }
+        if (ch == '\"' || ch == '\'')
+        {
+          quote_ = ch;
+          continue;
+        }
+      }
+      if (ch == '>' && markupEnds())
+      {
+        processMarkup(handler);
+        token_.clear();
+        inMarkup = false;
+      }
+    }
+  }
+  if (inMarkup || !tags_.empty())
+    throw(std::exception("ill-formed XML"));
+  token_.clear();
+}
+
 #ifdef TEST_XMLPARSER
 
 using namespace::Utilities;
 using Utils = StringHelper;
 
+class TagCounter : public IXmlHandler
+{
+public:
+  void startElement(const std::string& tag, const attribs& attributes) { ++elements; }
+  void endElement(const std::string& tag) {}
+  void text(const std::string& text) { ++texts; }
+  size_t elements = 0;
+  size_t texts = 0;
+};
+
 int main()
 {
   Utils::Title("Testing XmlParser");
@@ -346,6 +528,12 @@ int main()
   XmlDocument* pDoc = parser.buildDocument();
   Utils::title("Resulting XML Parse Tree:");
   std::cout << "\n" << pDoc->toString();
+
+  Utils::title("Streaming the same file, 256 bytes at a time:");
+  XmlStreamParser stream(src, XmlParser::file, 256);
+  TagCounter counter;
+  stream.parse(counter);
+  std::cout << "\n  " << counter.elements << " elements, " << counter.texts << " texts, " << stream.bytesRead() << " bytes";
   std::cout << "\n\n";
 }
 
@@ -1,8 +1,8 @@
 #ifndef XMLPARSER_H
 #define XMLPARSER_H
 ///////////////////////////////////////////////////////////////////
-// XmlParser.h - build XML parse tree                            //
-// ver 1.3                                                       //
+// XmlParser.h - build XML parse tree, or stream its events     //
+// ver 1.4                                                       //
 // Application: Support for XmlDocument, Summer 2015             //
 // Platform:    Dell XPS 2720, Win 8.1 Pro, Visual Studio 2013   //
 // Author:      Jim Fawcett, CST 4-187, 443-3948                 //
@@ -21,6 +21,27 @@
 *
 * XmlParser objects throw if given an invalid path to an XML file.
 *
+* XmlStreamParser is the streaming mode, for documents too large to
+* hold as a string and a tree.  It reads its source a chunk at a time
+* and calls an IXmlHandler's startElement, endElement, and text as it
+* finds them, so memory is bounded by the largest single tag or text,
+* and the depth of nesting, not by the size of the document.  Text that
+* is only whitespace is not reported, other text is reported as it is,
+* CDATA sections as text.  Declarations, processing instructions,
+* comments, and DOCTYPE are skipped.  parse throws on an end tag that
+* doesn't match its start tag, or a document that ends inside markup
+* or inside an element.
+*
+* Public Interface:
+* -----------------
+* XmlParser parser("../StringDB.xml");
+* XmlDocument* pDoc = parser.buildDocument();
+*
+* class Counter : public IXmlHandler { ... };   // startElement, endElement, text
+* Counter counter;
+* XmlStreamParser stream("../StringDB.xml");
+* stream.parse(counter);
+*
 * Required Files:
 * ---------------
 *   - XmlParser.h, XmlParser.cpp, 
@@ -35,6 +56,9 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.4 : 14 Oct 2026
+* - added IXmlHandler and XmlStreamParser, event driven parsing
+*   over chunked reads of a file or string
 * Ver 1.3 : 01 Jun 15
 * - made constr src string const
 * - added src_ member string
@@ -61,6 +85,8 @@
 #include <vector>
 #include <stack>
 #include <memory>
+#include <istream>
+#include <string>
 
 namespace XmlProcessing
 {
@@ -104,6 +130,47 @@ namespace XmlProcessing
     bool good_ = false;
   };
 
+  ///////////////////////////////////////////////////////////////
+  // IXmlHandler receives the events of an XmlStreamParser
+
+  class IXmlHandler
+  {
+  public:
+    using attrib = std::pair < std::string, std::string >;
+    using attribs = std::vector < attrib >;
+    virtual ~IXmlHandler() {}
+    virtual void startElement(const std::string& tag, const attribs& attributes) = 0;
+    virtual void endElement(const std::string& tag) = 0;
+    virtual void text(const std::string& text) = 0;
+  };
+
+  ///////////////////////////////////////////////////////////////
+  // XmlStreamParser parses without building a document
+
+  class XmlStreamParser
+  {
+  public:
+    XmlStreamParser(const std::string& src, XmlParser::sourceType type = XmlParser::file, size_t chunkSize = 64 * 1024);
+    bool good();
+    void parse(IXmlHandler& handler);
+    size_t bytesRead();
+  private:
+    void processMarkup(IXmlHandler& handler);
+    void processText(IXmlHandler& handler);
+    void parseTag(std::string& tag, IXmlHandler::attribs& attributes, bool& empty);
+    bool markupEnds() const;
+    std::unique_ptr<std::istream> pIn_;
+    size_t chunkSize_;
+    size_t bytesRead_ = 0;
+    std::string token_;
+    char quote_ = 0;
+    std::vector<std::string> tags_;
+    IXmlHandler::attribs attribs_;
+  };
+
+  inline bool XmlStreamParser::good() { return pIn_ && !pIn_->bad(); }
+  inline size_t XmlStreamParser::bytesRead() { return bytesRead_; }
+
   inline bool XmlParser::good() { return good_; }
   inline XmlParser::attribs& XmlParser::attributes() { return attribs_; }
   inline bool XmlParser::verbose(bool verb) 
@@ -7,6 +7,8 @@
 #include "HttpMessage.h"
 #include "../Utilities/Utilities.h"
 #include <iostream>
+#include <cstring>
+#include <algorithm>
 
 using namespace Utilities;
 using Attribute = HttpMessage::Attribute;
@@ -16,6 +18,13 @@ using Value = HttpMessage::Value;
 using Body = HttpMessage::Body;
 using byte = HttpMessage::byte;
 
+const char* const HttpMessage::BinaryFraming = "binary";
+
+namespace
+{
+  const Value NoValue;               // findValue's result for missing names
+}
+
 class MockSocket
 {
 public:
@@ -57,30 +66,121 @@ bool MockSocket::recv(size_t bytes, byte* buffer)
 
 void HttpMessage::addAttribute(const Attribute& attrib)
 {
-  attributes_.push_back(attrib);
+  addAttribute(Attribute(attrib));
+}
+
+void HttpMessage::addAttribute(Attribute&& attrib)
+{
+  attributes_.push_back(std::move(attrib));
+  if (attributes_.size() <= InlineAttributes)
+    return;
+  if (index_.size() < 2 * attributes_.size())
+    buildIndex();
+  else
+    indexAttribute(attributes_.size() - 1);
+}
+//----< hash of name, ignoring case >--------------------------------
+
+size_t HttpMessage::hashName(const char* name, size_t size)
+{
+  size_t hash = 2166136261u;
+  for (size_t i = 0; i < size; ++i)
+  {
+    unsigned char ch = (unsigned char)name[i];
+    if ('A' <= ch && ch <= 'Z')
+      ch += 'a' - 'A';
+    hash = (hash ^ ch) * 16777619u;
+  }
+  return hash;
+}
+//----< are names equal, ignoring case ? >---------------------------
+
+bool HttpMessage::sameName(const Name& name, const char* other, size_t size)
+{
+  if (name.size() != size)
+    return false;
+  for (size_t i = 0; i < size; ++i)
+  {
+    unsigned char a = (unsigned char)name[i], b = (unsigned char)other[i];
+    if (a != b && ((a | 0x20) != (b | 0x20) || (a | 0x20) < 'a' || (a | 0x20) > 'z'))
+      return false;
+  }
+  return true;
 }
-//----< find attribute by name >-------------------------------------
+//----< add attribute at pos to index, unless an earlier one has its name >---
 
-size_t HttpMessage::findAttribute(const Name& name)
+void HttpMessage::indexAttribute(size_t pos)
 {
+  const Name& name = attributes_[pos].first;
+  size_t mask = index_.size() - 1;
+  for (size_t slot = hashName(name.data(), name.size()) & mask; ; slot = (slot + 1) & mask)
+  {
+    if (index_[slot] == 0)
+    {
+      index_[slot] = (unsigned)pos + 1;
+      return;
+    }
+    if (sameName(attributes_[index_[slot] - 1].first, name.data(), name.size()))
+      return;
+  }
+}
+//----< index every attribute, at most half the slots are used >-----
+
+void HttpMessage::buildIndex()
+{
+  index_.clear();
+  if (attributes_.size() <= InlineAttributes)
+    return;
+  size_t slots = 32;
+  while (slots < 4 * attributes_.size())
+    slots *= 2;
+  index_.resize(slots, 0);
   for (size_t i = 0; i < attributes_.size(); ++i)
-    if (attributes_[i].first == name)
-      return i;
+    indexAttribute(i);
+}
+//----< find attribute by name, returns attributes().size() if none >---
+
+size_t HttpMessage::findAttribute(const char* name, size_t size) const
+{
+  if (index_.empty())
+  {
+    for (size_t i = 0; i < attributes_.size(); ++i)
+      if (sameName(attributes_[i].first, name, size))
+        return i;
+    return attributes_.size();
+  }
+  size_t mask = index_.size() - 1;
+  for (size_t slot = hashName(name, size) & mask; index_[slot] != 0; slot = (slot + 1) & mask)
+  {
+    if (sameName(attributes_[index_[slot] - 1].first, name, size))
+      return index_[slot] - 1;
+  }
   return attributes_.size();
 }
+
+size_t HttpMessage::findAttribute(const char* name) const
+{
+  return findAttribute(name, std::strlen(name));
+}
+
+size_t HttpMessage::findAttribute(const Name& name) const
+{
+  return findAttribute(name.data(), name.size());
+}
 //----< find value of attribute with specified name >----------------
 /*
  *  returns empty string if name not found
  */
-Value HttpMessage::findValue(const Name& name)
+const Value& HttpMessage::findValue(const char* name) const
 {
-  Value val = "";
   size_t pos = findAttribute(name);
-  if (pos < attributes_.size())
-  {
-    val = attributes_[pos].second;
-  }
-  return val;
+  return pos < attributes_.size() ? attributes_[pos].second : NoValue;
+}
+
+const Value& HttpMessage::findValue(const Name& name) const
+{
+  size_t pos = findAttribute(name);
+  return pos < attributes_.size() ? attributes_[pos].second : NoValue;
 }
 //----< remove attribute by name >-----------------------------------
 
@@ -91,35 +191,49 @@ bool HttpMessage::removeAttribute(const Name& name)
     return false;
   std::vector<Attribute>::iterator iter = attributes_.begin() + pos;
   attributes_.erase(iter);
+  if (!index_.empty())
+    buildIndex();
   return true;
 }
 //----< retrieve attribute collection >------------------------------
 
-Attributes& HttpMessage::attributes()
+const Attributes& HttpMessage::attributes() const
 {
   return attributes_;
 }
+//----< parse "name : value", both trimmed of white space >----------
+
 Attribute HttpMessage::parseAttribute(const std::string& src)
 {
-  Attribute attrib("", "");
-  size_t pos = src.find(':');
-  if (pos == std::string::npos)
-    return attrib;
-  std::string first = StringHelper::trim(src.substr(0, pos));
-  std::string second = StringHelper::trim(src.substr(pos + 1, src.size() - 1));
-  attrib.first = first;
-  attrib.second = second;
-  return attrib;
+  return parseAttribute(src.data(), src.size());
+}
+
+Attribute HttpMessage::parseAttribute(const char* src)
+{
+  return parseAttribute(src, std::strlen(src));
+}
+//----< parse size chars of "name : value" >-------------------------
+/*
+ * - name and value are trimmed as views of src, so the only strings
+ *   made are the attribute's own
+ */
+Attribute HttpMessage::parseAttribute(const char* src, size_t size)
+{
+  Utilities::StringView line(src, size);
+  size_t pos = line.find(':');
+  if (pos == Utilities::StringView::npos)
+    return Attribute();
+  Utilities::StringView name = Utilities::StringHelper::trimView(line.substr(0, pos));
+  Utilities::StringView value = Utilities::StringHelper::trimView(line.substr(pos + 1));
+  return Attribute(Name(name.data(), name.size()), Value(value.data(), value.size()));
 }
 
 //----< fill body from buffer >--------------------------------------
 
 void HttpMessage::setBody(byte buffer[], size_t Buflen)
 {
-  for (size_t i = 0; i < Buflen; ++i)
-  {
-    body_.push_back(buffer[i]);
-  }
+  Body& own = body();
+  own.insert(own.end(), buffer, buffer + Buflen);
 }
 //----< fill buffer from body >--------------------------------------
 /*
@@ -128,12 +242,13 @@ void HttpMessage::setBody(byte buffer[], size_t Buflen)
  */
 size_t HttpMessage::getBody(byte buffer[], size_t& Buflen)
 {
-  if (Buflen < body_.size())
+  size_t length = bodySize();
+  if (Buflen < length)
     return 0;
-  size_t length = body_.size();
+  const byte* pBody = bodyData();
   for (size_t i = 0; i < length; ++i)
   {
-    buffer[i] = body_[i];
+    buffer[i] = pBody[i];
   }
   return length;
 }
@@ -141,35 +256,75 @@ size_t HttpMessage::getBody(byte buffer[], size_t& Buflen)
 
 void HttpMessage::addBody(const Body& body)
 {
+  shared_.reset();
   body_ = body;
 }
 //----< replace body with contents of string >-----------------------
 
 void HttpMessage::addBody(const std::string& body)
 {
-  body_.clear();
-  for (auto ch : body)
-    body_.push_back(ch);
+  shared_.reset();
+  body_.assign(body.begin(), body.end());
 }
 //----< replace body from buffer contents >--------------------------
 
 void HttpMessage::addBody(size_t numBytes, byte* pBuffer)
 {
-  for (size_t i = 0; i < numBytes; ++i)
-    body_.push_back(*(pBuffer + i));
+  Body& own = body();
+  own.insert(own.end(), pBuffer, pBuffer + numBytes);
 }
 
 //-----< retrieve body >---------------------------------------------
-
+/*
+ *  - a shared body is copied into the message's own first, since the
+ *    caller may change it
+ */
 Body& HttpMessage::body()
 {
+  if (shared_)
+  {
+    const byte* pBody = bodyData();
+    body_.assign(pBody, pBody + sharedSize_);
+    shared_.reset();
+  }
   return body_;
 }
 //----< return length of body in bytes >-----------------------------
 
 size_t HttpMessage::bodyLength()
 {
-  return body_.size()*sizeof(byte);  // may change byte to int
+  return bodySize()*sizeof(byte);  // may change byte to int
+}
+//----< body refers to count bytes of bytes from pos, not a copy >---
+/*
+ *  - pos and count are clipped to bytes, a null bytes empties the body
+ *  - many messages may share one string, e.g., a cached page, each
+ *    holds it until its body is replaced or cleared
+ */
+void HttpMessage::shareBody(const SharedBytes& bytes, size_t pos, size_t count)
+{
+  body_.clear();
+  shared_ = bytes;
+  if (!shared_)
+    return;
+  sharedPos_ = (std::min)(pos, shared_->size());
+  sharedSize_ = (std::min)(count, shared_->size() - sharedPos_);
+}
+
+bool HttpMessage::sharesBody() const
+{
+  return shared_ != nullptr;
+}
+//----< size and start of body, shared or the message's own >-------
+
+size_t HttpMessage::bodySize() const
+{
+  return shared_ ? sharedSize_ : body_.size();
+}
+
+const byte* HttpMessage::bodyData() const
+{
+  return shared_ ? shared_->data() + sharedPos_ : body_.data();
 }
 //----< convert attribute pair to string >---------------------------
 
@@ -188,19 +343,38 @@ Attribute HttpMessage::attribute(const Name& name, const Value& value)
 std::string HttpMessage::headerString() const
 {
   std::string header;
-  for (auto attrib : attributes_)
+  header.reserve(headerSize());
+  appendHeader(header);
+  return header;
+}
+//----< size of headerString, computed without building it >--------
+
+size_t HttpMessage::headerSize() const
+{
+  size_t size = term_.size();
+  for (auto& attrib : attributes_)
+    size += attrib.first.size() + attrib.second.size() + 2;
+  return size;
+}
+//----< append name:value lines and terminator, as attribString does >---
+
+void HttpMessage::appendHeader(std::string& dst) const
+{
+  for (auto& attrib : attributes_)
   {
-    header += attribString(attrib);
+    dst += attrib.first;
+    dst += ':';
+    dst += attrib.second;
+    dst += '\n';
   }
-  header += term_;
-  return header;
+  dst += term_;
 }
 //----< convert message header to indented string >------------------
 
 std::string HttpMessage::toIndentedHeaderString() const
 {
   std::string header = "  ";
-  for (auto attrib : attributes_)
+  for (auto& attrib : attributes_)
   {
     header += attribString(attrib) + "  ";
   }
@@ -211,25 +385,53 @@ std::string HttpMessage::toIndentedHeaderString() const
 
 std::string HttpMessage::bodyString() const
 {
-  std::string body;
-  for (char ch : body_)
-    body += ch;
-  return body;
+  return std::string(bodyData(), bodySize());
 }
 //----< convert body to indented string >----------------------------
 
 std::string HttpMessage::toIndentedBodyString() const
 {
   std::string body = "  ";
-  for (char ch : body_)
-    body += ch;
+  body.append(bodyData(), bodySize());
   return body;
 }
 //----< convert message to string >----------------------------------
 
+/*
+ *  - reserves the exact size, then writes header and body in place
+ */
 std::string HttpMessage::toString() const
 {
-  return headerString() + bodyString();
+  std::string msg;
+  msg.reserve(headerSize() + bodySize());
+  appendHeader(msg);
+  msg.append(bodyData(), bodySize());
+  return msg;
+}
+//----< header into head, then buffers for head and body >-----------
+/*
+ *  - the body isn't copied, a shared body is sent from where it's kept,
+ *    so one page broadcast to many clients is never copied per client
+ *  - an empty body adds no buffer
+ */
+HttpMessage::Buffers HttpMessage::toBuffers(std::string& head, bool binary) const
+{
+  head.clear();
+  if (binary)
+  {
+    head.reserve(binaryHeaderSize());
+    appendBinaryHeader(head);
+  }
+  else
+  {
+    head.reserve(headerSize());
+    appendHeader(head);
+  }
+  Buffers buffers;
+  buffers.push_back(Buffer(head.data(), head.size()));
+  if (bodySize() > 0)
+    buffers.push_back(Buffer(bodyData(), bodySize()));
+  return buffers;
 }
 //----< convert message to indented string >-------------------------
 
@@ -242,7 +444,9 @@ std::string HttpMessage::toIndentedString() const
 void HttpMessage::clear()
 {
   attributes_.clear();
+  index_.clear();
   body_.clear();
+  shared_.reset();
 }
 //----< fill buffer with char >--------------------------------------
 
@@ -251,6 +455,172 @@ void HttpMessage::fillBuffer(byte buffer[], size_t BufSize, byte fill)
   for (size_t i = 0; i < BufSize; ++i)
     buffer[i] = fill;
 }
+//----< convert message to compact binary frame >--------------------
+/*
+ *  Frame layout, integers little-endian:
+ *  - header: 'H' 'B', attribute count (2 bytes), attribute bytes (4 bytes)
+ *  - each attribute: name length, value length (2 bytes each), name, value
+ *  - body, its size given by the content-length attribute as in text
+ *  Receivers don't scan for line ends or split name:value strings.
+ *  Names and values must be shorter than 64K.
+ */
+std::string HttpMessage::toBinaryString() const
+{
+  std::string frame;
+  frame.reserve(binaryHeaderSize() + bodySize());
+  appendBinaryHeader(frame);
+  frame.append(bodyData(), bodySize());
+  return frame;
+}
+//----< size of binary frame before the body >-----------------------
+
+size_t HttpMessage::binaryHeaderSize() const
+{
+  size_t size = BinaryHeaderSize;
+  for (auto& attrib : attributes_)
+    size += 4 + attrib.first.size() + attrib.second.size();
+  return size;
+}
+//----< append binary frame header and attributes >------------------
+
+void HttpMessage::appendBinaryHeader(std::string& dst) const
+{
+  dst += "HB";
+  putBinary(dst, attributes_.size(), 2);
+  putBinary(dst, binaryHeaderSize() - BinaryHeaderSize, 4);
+  for (auto& attrib : attributes_)
+  {
+    putBinary(dst, attrib.first.size(), 2);
+    putBinary(dst, attrib.second.size(), 2);
+    dst += attrib.first;
+    dst += attrib.second;
+  }
+}
+//----< append value as little-endian bytes >------------------------
+
+void HttpMessage::putBinary(std::string& dst, size_t value, size_t bytes)
+{
+  for (size_t i = 0; i < bytes; ++i)
+    dst += (char)((value >> (8 * i)) & 0xff);
+}
+//----< read little-endian bytes as a value >------------------------
+
+size_t HttpMessage::getBinary(const byte* src, size_t bytes)
+{
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+  size_t value = 0;
+  for (size_t i = 0; i < bytes; ++i)
+    value |= (size_t)in[i] << (8 * i);
+  return value;
+}
+//----< check magic, get attribute count and size of attribute block >---
+
+bool HttpMessage::parseBinaryHeader(const byte* header, size_t& count, size_t& bytes)
+{
+  if (header[0] != 'H' || header[1] != 'B')
+    return false;
+  count = getBinary(header + 2, 2);
+  bytes = getBinary(header + 4, 4);
+  return bytes <= MaxBinaryAttributes && 4 * count <= bytes;
+}
+//----< add count attributes from binary attribute block >------------
+
+bool HttpMessage::parseBinaryAttributes(const byte* src, size_t bytes, size_t count)
+{
+  size_t pos = 0;
+  for (size_t i = 0; i < count; ++i)
+  {
+    if (bytes - pos < 4)
+      return false;
+    size_t nameSize = getBinary(src + pos, 2);
+    size_t valueSize = getBinary(src + pos + 2, 2);
+    pos += 4;
+    if (bytes - pos < nameSize + valueSize)
+      return false;
+    addAttribute(Attribute(Name(src + pos, nameSize), Value(src + pos + nameSize, valueSize)));
+    pos += nameSize + valueSize;
+  }
+  return pos == bytes;
+}
+//----< one "hash name" line per file, names may hold spaces >-------
+
+std::string HttpMessage::manifestBody(const Manifest& manifest)
+{
+  std::string body;
+  for (auto& entry : manifest)
+    body += entry.second + " " + entry.first + "\n";
+  return body;
+}
+//----< parse body made by manifestBody, a hash may be empty >-------
+
+HttpMessage::Manifest HttpMessage::parseManifest(const std::string& body)
+{
+  Manifest manifest;
+  size_t start = 0;
+  while (start < body.size())
+  {
+    size_t end = body.find('\n', start);
+    if (end == std::string::npos)
+      end = body.size();
+    std::string line = body.substr(start, end - start);
+    size_t pos = line.find(' ');
+    if (pos != std::string::npos && pos + 1 < line.size())
+      manifest.push_back(ManifestEntry(line.substr(pos + 1), line.substr(0, pos)));
+    start = end + 1;
+  }
+  return manifest;
+}
+
+//----< parse "unit=first-last", last may be left out, NoLimit then >---
+
+bool HttpMessage::parseRange(const std::string& value, std::string& unit, size_t& first, size_t& last)
+{
+  size_t eq = value.find('=');
+  size_t dash = value.find('-', eq);
+  if (eq == std::string::npos || dash == std::string::npos || eq == 0 || dash == eq + 1)
+    return false;
+  if (value.find_first_not_of("0123456789", eq + 1) != dash ||
+    value.find_first_not_of("0123456789", dash + 1) != std::string::npos)
+    return false;
+  unit.assign(value, 0, eq);
+  first = Converter<size_t>::toValue(value.data() + eq + 1, dash - eq - 1);
+  last = (dash + 1 == value.size()) ? NoLimit : Converter<size_t>::toValue(value.data() + dash + 1, value.size() - dash - 1);
+  return first <= last;
+}
+//----< "unit first-last/total", "unit */total" if count is 0 >------
+/*
+ * - a total of NoLimit is sent as *, the size isn't known
+ */
+std::string HttpMessage::contentRange(const std::string& unit, size_t first, size_t count, size_t total)
+{
+  std::string totalString = (total == NoLimit) ? "*" : Converter<size_t>::toString(total);
+  if (count == 0)
+    return unit + " */" + totalString;
+  return unit + " " + Converter<size_t>::toString(first) + "-" +
+    Converter<size_t>::toString(first + count - 1) + "/" + totalString;
+}
+//----< parse value made by contentRange >---------------------------
+
+bool HttpMessage::parseContentRange(const std::string& value, std::string& unit, size_t& first, size_t& count, size_t& total)
+{
+  size_t space = value.find(' ');
+  size_t slash = value.find('/', space);
+  if (space == std::string::npos || slash == std::string::npos)
+    return false;
+  unit = value.substr(0, space);
+  std::string totalString = value.substr(slash + 1);
+  total = (totalString == "*") ? NoLimit : Converter<size_t>::toValue(totalString);
+  std::string span = value.substr(space + 1, slash - space - 1);
+  first = count = 0;
+  if (span == "*")
+    return true;
+  std::string spanUnit;
+  size_t last;
+  if (!parseRange("r=" + span, spanUnit, first, last) || last == NoLimit)
+    return false;
+  count = last - first + 1;
+  return true;
+}
 
 using Utils = StringHelper;
 //
@@ -8,6 +8,7 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <memory>
 
 class HttpMessage
 {
@@ -19,16 +20,31 @@ public:
   using Attributes = std::vector<Attribute>;
   using Terminator = std::string;
   using Body = std::vector<byte>;
+  using SharedBytes = std::shared_ptr<const std::string>;
+  using Buffer = std::pair<const byte*, size_t>;
+  using Buffers = std::vector<Buffer>;
+  using ManifestEntry = std::pair<std::string, std::string>;   // file name, content hash
+  using Manifest = std::vector<ManifestEntry>;
 
-  // message attributes
+  // message attributes, kept in the order added
+  // - names are found ignoring case, the first of equal names wins
+  // - a message with more than InlineAttributes attributes also keeps
+  //   a hash index of their names, smaller ones are scanned
+  // - findValue's reference is valid until the attributes change
+  static const size_t InlineAttributes = 8;
   void addAttribute(const Attribute& attrib);
-  Value findValue(const Name& name);
-  size_t findAttribute(const Name& name);
+  void addAttribute(Attribute&& attrib);
+  const Value& findValue(const char* name) const;
+  const Value& findValue(const Name& name) const;
+  size_t findAttribute(const char* name) const;
+  size_t findAttribute(const Name& name) const;
   bool removeAttribute(const Name& name);
-  Attributes& attributes();
+  const Attributes& attributes() const;
   static std::string attribString(const Attribute& attrib);
   static Attribute attribute(const Name& name, const Value& value);
   static Attribute parseAttribute(const std::string& src);
+  static Attribute parseAttribute(const char* src);
+  static Attribute parseAttribute(const char* src, size_t size);   // size chars of src, no copy of them made
 
   // message body
   void setBody(byte buffer[], size_t Buflen);
@@ -39,6 +55,36 @@ public:
   Body& body();
   size_t bodyLength();
 
+  // shared immutable body, e.g., a cached page sent to many clients
+  // - shareBody refers to count bytes of bytes from pos, without copying,
+  //   the bytes are kept alive until the body is replaced or cleared
+  // - body() copies shared bytes into the message's own body first, the
+  //   other body functions read them where they are
+  void shareBody(const SharedBytes& bytes, size_t pos = 0, size_t count = NoLimit);
+  bool sharesBody() const;
+  size_t bodySize() const;
+
+  // file manifests, carried in the body of SYNC messages
+  static std::string manifestBody(const Manifest& manifest);
+  static Manifest parseManifest(const std::string& body);
+
+  // ranges of FETCH messages, "bytes=0-4095" asked, "bytes 0-4095/20000" sent
+  static const size_t NoLimit = static_cast<size_t>(-1);
+  static bool parseRange(const std::string& value, std::string& unit, size_t& first, size_t& last);
+  static std::string contentRange(const std::string& unit, size_t first, size_t count, size_t total);
+  static bool parseContentRange(const std::string& value, std::string& unit, size_t& first, size_t& count, size_t& total);
+
+  // compact binary framing, negotiated per connection, see toBinaryString
+  static const size_t BinaryHeaderSize = 8;
+  static const char* const BinaryFraming;
+  std::string toBinaryString() const;
+  template<typename Socket> bool recvBinaryHeader(Socket& socket);
+
+  // the message as a header and the body, for one vectored send
+  // - head receives the header, text or binary, and must outlive the
+  //   buffers, which point into it and the body, see Socket::sendBuffers
+  Buffers toBuffers(std::string& head, bool binary = false) const;
+
   // construct message
   //static HttpMessage parseHeader(const std::string& src);
   //static HttpMessage parseMessage(const std::string& src);
@@ -56,7 +102,46 @@ public:
   static void fillBuffer(byte buffer[], size_t BufSize, byte fill = '\0');
 
 private:
+  static const size_t MaxBinaryAttributes = 64 * 1024;
+  static void putBinary(std::string& dst, size_t value, size_t bytes);
+  static size_t getBinary(const byte* src, size_t bytes);
+  static bool parseBinaryHeader(const byte* header, size_t& count, size_t& bytes);
+  bool parseBinaryAttributes(const byte* src, size_t bytes, size_t count);
+  size_t findAttribute(const char* name, size_t size) const;
+  size_t headerSize() const;
+  void appendHeader(std::string& dst) const;
+  size_t binaryHeaderSize() const;
+  void appendBinaryHeader(std::string& dst) const;
+  const byte* bodyData() const;
+  static size_t hashName(const char* name, size_t size);
+  static bool sameName(const Name& name, const char* other, size_t size);
+  void indexAttribute(size_t pos);
+  void buildIndex();
+
   Attributes attributes_;
+  std::vector<unsigned> index_;   // open addressed, attribute position + 1, 0 if empty
   Terminator term_ = "\n";
   Body body_;
-};
\ No newline at end of file
+  SharedBytes shared_;            // body is shared_'s bytes from sharedPos_ when set
+  size_t sharedPos_ = 0;
+  size_t sharedSize_ = 0;
+};
+//----< read binary frame header and attributes, body is left on socket >---
+/*
+ *  Socket needs only bool recv(size_t bytes, byte* buffer), so tests can
+ *  use a mock.  Returns false if the connection closed or the frame is bad.
+ */
+template<typename Socket>
+bool HttpMessage::recvBinaryHeader(Socket& socket)
+{
+  byte header[BinaryHeaderSize];
+  if (!socket.recv(BinaryHeaderSize, header))
+    return false;
+  size_t count, bytes;
+  if (!parseBinaryHeader(header, count, bytes))
+    return false;
+  std::vector<byte> block(bytes + 1);
+  if (bytes > 0 && !socket.recv(bytes, &block[0]))
+    return false;
+  return parseBinaryAttributes(&block[0], bytes, count);
+}
\ No newline at end of file
@@ -84,6 +84,39 @@ int main()
   std::cout << "\n    q3.size() = " << q3.size();
   std::cout << "\n    q3 element = " << q3.deQ() << "\n";
 
+  std::cout << "\n  Bounded BlockingQueue, capacity 2";
+  std::cout << "\n -----------------------------------";
+  BlockingQueue<std::string> bounded(2);
+  std::thread producer([&]() {
+    for (int i = 0; i < 6; ++i)
+      bounded.enQ("item#" + std::to_string(i));   // waits while two are queued
+    bounded.enQ("quit");
+  });
+  std::string item;
+  do
+  {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    size_t queued = bounded.size();
+    item = bounded.deQ();
+    std::cout << "\n    deQed " << item << ", " << queued << " were queued";
+  } while (item != "quit");
+  producer.join();
+
+  std::cout << "\n\n  PriorityBlockingQueue, 3 classes, starvation limit 2";
+  std::cout << "\n -----------------------------------------------------";
+  PriorityBlockingQueue<std::string> pq(3, 2);
+  pq.enQ("background#0", 2);
+  for (int i = 0; i < 3; ++i)
+    pq.enQ("bulk#" + std::to_string(i), 1);
+  for (int i = 0; i < 4; ++i)
+    pq.enQ("interactive#" + std::to_string(i), 0);
+  while (pq.size() > 0)
+    std::cout << "\n    deQed " << pq.deQ();
+  std::vector<PriorityBlockingQueue<std::string>::Depth> depths = pq.depths();
+  for (size_t c = 0; c < depths.size(); ++c)
+    std::cout << "\n    class " << c << ": " << depths[c].taken << " taken, high water "
+              << depths[c].highWater << ", " << depths[c].promoted << " promoted";
+
   std::cout << "\n\n";
 }
 
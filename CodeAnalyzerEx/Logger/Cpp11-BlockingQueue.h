@@ -2,18 +2,31 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.4                                                   //
+// ver 1.7                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
  * Package Operations:
  * -------------------
- * This package contains one thread-safe class: BlockingQueue<T>.
+ * This package contains two thread-safe classes: BlockingQueue<T> and
+ * PriorityBlockingQueue<T>.
  * Its purpose is to support sending messages between threads.
  * It is implemented using C++11 threading constructs including 
  * std::condition_variable and std::mutex.  The underlying storage
  * is provided by the non-thread-safe std::queue<T>.
  *
+ * A queue made with a capacity is bounded: enQ and emplace block
+ * while it holds capacity elements, so a fast producer can't run
+ * ahead of its consumers.  The default queue is unbounded.
+ *
+ * PriorityBlockingQueue<T> holds one FIFO per priority class, class 0
+ * first, and deQ takes from the first class holding anything.  So a
+ * lower class isn't starved by a steady stream above it, a class that
+ * has been passed over starvationLimit times while waiting is served
+ * next.  depths() reports, for each class, the elements queued now,
+ * the most ever queued, the number taken, and how many of those were
+ * taken ahead of a higher class to end a wait.
+ *
  * Required Files:
  * ---------------
  * Cpp11-BlockingQueue.h
@@ -24,6 +37,16 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.7 : 14 Oct 2026
+ * - added PriorityBlockingQueue<T>, FIFO priority classes with
+ *   starvation protection and per class depth counts
+ * ver 1.6 : 14 Oct 2026
+ * - added BlockingQueue(capacity), a bounded queue whose enQ waits
+ *   for room
+ * ver 1.5 : 14 Oct 2026
+ * - added enQ(T&&) and emplace(args...), and deQ now moves the
+ *   front element out, so messages are handed off without copies
+ * - move constructor and move assignment now move the queue
  * ver 1.4 : 29 Jul 2016
  * - wrapped with namespace Async
  * ver 1.3 : 04 Mar 2016
@@ -45,6 +68,8 @@
 #include <mutex>
 #include <thread>
 #include <queue>
+#include <deque>
+#include <vector>
 #include <string>
 #include <iostream>
 #include <sstream>
@@ -55,19 +80,27 @@ namespace Async
   class BlockingQueue {
   public:
     BlockingQueue() {}
+    explicit BlockingQueue(size_t capacity) : capacity_(capacity) {}
     BlockingQueue(BlockingQueue<T>&& bq);
     BlockingQueue<T>& operator=(BlockingQueue<T>&& bq);
     BlockingQueue(const BlockingQueue<T>&) = delete;
     BlockingQueue<T>& operator=(const BlockingQueue<T>&) = delete;
     T deQ();
     void enQ(const T& t);
+    void enQ(T&& t);
+    template <typename... Args>
+    void emplace(Args&&... args);
     T& front();
     void clear();
     size_t size();
+    size_t capacity() { return capacity_; }
   private:
+    void waitForRoom(std::unique_lock<std::mutex>& l);
     std::queue<T> q_;
     std::mutex mtx_;
     std::condition_variable cv_;
+    std::condition_variable notFull_;   // used only when bounded
+    size_t capacity_ = 0;               // 0 means unbounded
   };
   //----< move constructor >---------------------------------------------
 
@@ -75,9 +108,10 @@ namespace Async
   BlockingQueue<T>::BlockingQueue(BlockingQueue<T>&& bq) // need to lock so can't initialize
   {
     std::lock_guard<std::mutex> l(mtx_);
-    q_ = bq.q_;
-    while (bq.q_.size() > 0)  // clear bq
-      bq.q_.pop();
+    std::lock_guard<std::mutex> lbq(bq.mtx_);
+    q_ = std::move(bq.q_);
+    std::queue<T>().swap(bq.q_);  // leave bq empty
+    capacity_ = bq.capacity_;
     /* can't copy  or move mutex or condition variable, so use default members */
   }
   //----< move assignment >----------------------------------------------
@@ -86,10 +120,13 @@ namespace Async
   BlockingQueue<T>& BlockingQueue<T>::operator=(BlockingQueue<T>&& bq)
   {
     if (this == &bq) return *this;
-    std::lock_guard<std::mutex> l(mtx_);
-    q_ = bq.q_;
-    while (bq.q_.size() > 0)  // clear bq
-      bq.q_.pop();
+    std::lock(mtx_, bq.mtx_);  // both at once, so opposite assignments can't deadlock
+    std::lock_guard<std::mutex> l(mtx_, std::adopt_lock);
+    std::lock_guard<std::mutex> lbq(bq.mtx_, std::adopt_lock);
+    q_ = std::move(bq.q_);
+    std::queue<T>().swap(bq.q_);  // leave bq empty
+    capacity_ = bq.capacity_;
+    bq.notFull_.notify_all();
     /* can't move assign mutex or condition variable so use target's */
     return *this;
   }
@@ -111,18 +148,30 @@ namespace Async
      */
     if (q_.size() > 0)
     {
-      T temp = q_.front();
+      T temp = std::move(q_.front());
       q_.pop();
+      if (capacity_ > 0)
+        notFull_.notify_one();
       return temp;
     }
     // may have spurious returns so loop on !condition
 
     while (q_.size() == 0)
       cv_.wait(l, [this]() { return q_.size() > 0; });
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
+    if (capacity_ > 0)
+      notFull_.notify_one();
     return temp;
   }
+  //----< wait until a bounded queue has room, caller holds l >----------
+
+  template<typename T>
+  void BlockingQueue<T>::waitForRoom(std::unique_lock<std::mutex>& l)
+  {
+    if (capacity_ > 0)
+      notFull_.wait(l, [this]() { return q_.size() < capacity_; });
+  }
   //----< push element onto back of queue >------------------------------
 
   template<typename T>
@@ -130,10 +179,36 @@ namespace Async
   {
     {
       std::unique_lock<std::mutex> l(mtx_);
+      waitForRoom(l);
       q_.push(t);
     }
     cv_.notify_one();
   }
+  //----< move element onto back of queue >------------------------------
+
+  template<typename T>
+  void BlockingQueue<T>::enQ(T&& t)
+  {
+    {
+      std::unique_lock<std::mutex> l(mtx_);
+      waitForRoom(l);
+      q_.push(std::move(t));
+    }
+    cv_.notify_one();
+  }
+  //----< construct element in place at back of queue >------------------
+
+  template<typename T>
+  template<typename... Args>
+  void BlockingQueue<T>::emplace(Args&&... args)
+  {
+    {
+      std::unique_lock<std::mutex> l(mtx_);
+      waitForRoom(l);
+      q_.emplace(std::forward<Args>(args)...);
+    }
+    cv_.notify_one();
+  }
   //----< peek at next item to be popped >-------------------------------
 
   template <typename T>
@@ -152,6 +227,7 @@ namespace Async
     std::lock_guard<std::mutex> l(mtx_);
     while (q_.size() > 0)
       q_.pop();
+    notFull_.notify_all();
   }
   //----< return number of elements in queue >---------------------------
 
@@ -161,5 +237,130 @@ namespace Async
     std::lock_guard<std::mutex> l(mtx_);
     return q_.size();
   }
+
+  /////////////////////////////////////////////////////////////////////
+  // PriorityBlockingQueue<T>
+  // - priority 0 is served first, priorities past the last class go
+  //   in the last class
+
+  struct QueueDepth
+  {
+    size_t queued = 0;      // now
+    size_t highWater = 0;   // most ever queued at once
+    size_t taken = 0;
+    size_t promoted = 0;    // taken ahead of a higher class, to end a wait
+  };
+
+  template <typename T>
+  class PriorityBlockingQueue {
+  public:
+    using Depth = QueueDepth;
+    explicit PriorityBlockingQueue(size_t numClasses, size_t starvationLimit = 8);
+    PriorityBlockingQueue(const PriorityBlockingQueue<T>&) = delete;
+    PriorityBlockingQueue<T>& operator=(const PriorityBlockingQueue<T>&) = delete;
+    T deQ();
+    void enQ(const T& t, size_t priority);
+    void enQ(T&& t, size_t priority);
+    size_t size();
+    std::vector<Depth> depths();
+    size_t numClasses() const { return qs_.size(); }
+  private:
+    size_t pick();
+    std::vector<std::deque<T>> qs_;
+    std::vector<size_t> passed_;      // times each waiting class was passed over
+    std::vector<Depth> depths_;
+    size_t starvationLimit_;
+    size_t size_ = 0;
+    std::mutex mtx_;
+    std::condition_variable cv_;
+  };
+
+  template<typename T>
+  PriorityBlockingQueue<T>::PriorityBlockingQueue(size_t numClasses, size_t starvationLimit)
+    : qs_(numClasses > 0 ? numClasses : 1), passed_(qs_.size()), depths_(qs_.size()),
+      starvationLimit_(starvationLimit > 0 ? starvationLimit : 1) {}
+
+  //----< class to take from next, caller holds lock, queue not empty >--
+  /*
+   * - the first class holding elements, unless a class below it has
+   *   been passed over starvationLimit times, then the one passed over
+   *   most, which takes the first class's turn
+   */
+  template<typename T>
+  size_t PriorityBlockingQueue<T>::pick()
+  {
+    size_t first = 0;
+    while (qs_[first].size() == 0)
+      ++first;
+    size_t chosen = first;
+    for (size_t c = first + 1; c < qs_.size(); ++c)
+    {
+      if (qs_[c].size() > 0 && passed_[c] >= starvationLimit_ && (chosen == first || passed_[c] > passed_[chosen]))
+        chosen = c;
+    }
+    for (size_t c = chosen + 1; c < qs_.size(); ++c)
+    {
+      if (qs_[c].size() > 0)
+        ++passed_[c];
+    }
+    passed_[chosen] = 0;
+    if (chosen != first)
+      ++depths_[chosen].promoted;
+    return chosen;
+  }
+  //----< remove element from front of the class pick chooses >---------
+
+  template<typename T>
+  T PriorityBlockingQueue<T>::deQ()
+  {
+    std::unique_lock<std::mutex> l(mtx_);
+    cv_.wait(l, [this]() { return size_ > 0; });
+    size_t c = pick();
+    T temp = std::move(qs_[c].front());
+    qs_[c].pop_front();
+    --size_;
+    --depths_[c].queued;
+    ++depths_[c].taken;
+    return temp;
+  }
+  //----< push element onto back of its priority's class >---------------
+
+  template<typename T>
+  void PriorityBlockingQueue<T>::enQ(const T& t, size_t priority)
+  {
+    enQ(T(t), priority);
+  }
+  //----< move element onto back of its priority's class >---------------
+
+  template<typename T>
+  void PriorityBlockingQueue<T>::enQ(T&& t, size_t priority)
+  {
+    {
+      std::lock_guard<std::mutex> l(mtx_);
+      size_t c = (priority < qs_.size()) ? priority : qs_.size() - 1;
+      qs_[c].push_back(std::move(t));
+      ++size_;
+      Depth& depth = depths_[c];
+      if (++depth.queued > depth.highWater)
+        depth.highWater = depth.queued;
+    }
+    cv_.notify_one();
+  }
+  //----< return number of elements in all classes >---------------------
+
+  template<typename T>
+  size_t PriorityBlockingQueue<T>::size()
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    return size_;
+  }
+  //----< return depth counts of each class >----------------------------
+
+  template<typename T>
+  std::vector<QueueDepth> PriorityBlockingQueue<T>::depths()
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    return depths_;
+  }
 }
 #endif
@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 // Logger.cpp - log text messages to std::ostream                  //
-// ver 1.2                                                         //
+// ver 1.4                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -13,18 +13,77 @@
 
 #include <functional>
 #include <fstream>
-#include <windows.h>
+#include <chrono>
 #include "Logger.h"
 #include "../Utilities/Utilities.h"
 
 using namespace Logging;
 
+//----< make ring of capacity records, rounded up to a power of two >--
+
+Logger::Logger(size_t capacity)
+  : tail_(0), written_(0), durable_(0), flushers_(0), sleeping_(false), paused_(false), _ThreadRunning(false)
+{
+  size_t size = 2;
+  while (size < capacity)
+    size *= 2;
+  ring_.reset(new Record[size]);
+  mask_ = size - 1;
+  for (size_t i = 0; i < size; ++i)
+  {
+    ring_[i].seq.store(i);
+    ring_[i].quit = false;
+    ring_[i].text.reserve(64);
+  }
+}
+//----< copy message into the next free record >----------------------
+/*
+ *  A writer owns a record once it moves tail_ past the record's
+ *  ticket, and hands it to the logging thread by advancing its seq.
+ *  A full ring makes writers yield until the logging thread frees
+ *  the record they want.
+ */
+void Logger::enQ(const std::string& msg, bool quit)
+{
+  size_t ticket = tail_.load(std::memory_order_relaxed);
+  Record* pRec;
+  while (true)
+  {
+    pRec = &ring_[ticket & mask_];
+    size_t seq = pRec->seq.load(std::memory_order_acquire);
+    if (seq == ticket)
+    {
+      if (tail_.compare_exchange_weak(ticket, ticket + 1, std::memory_order_relaxed))
+        break;
+    }
+    else
+    {
+      if (seq < ticket)
+        std::this_thread::yield();   // ring is full
+      ticket = tail_.load(std::memory_order_relaxed);
+    }
+  }
+  pRec->text.assign(msg);
+  pRec->quit = quit;
+  pRec->seq.store(ticket + 1);
+  if (sleeping_.load())
+  {
+    std::lock_guard<std::mutex> lock(wakeLock_);
+    wake_.notify_one();
+  }
+}
+//----< has the record with ticket been filled? >---------------------
+
+bool Logger::waiting(size_t ticket) const
+{
+  return ring_[ticket & mask_].seq.load() == ticket + 1;
+}
 //----< send text message to std::ostream >--------------------------
 
 void Logger::write(const std::string& msg)
 {
   if(_ThreadRunning)
-    _queue.enQ(msg);
+    enQ(msg, false);
 }
 void Logger::title(const std::string& msg, char underline)
 {
@@ -47,23 +106,69 @@ void Logger::start()
   if (_ThreadRunning)
     return;
   _ThreadRunning = true;
-  std::function<void()> tp = [=]() {
-    while (true)
+  std::function<void()> tp = [=]() { drain(); };
+  delete _pThr;
+  _pThr = new std::thread (tp);
+  //thr.detach();
+}
+//----< logging thread: write waiting messages in batches until quit >---
+/*
+ *  Each pass takes every filled record, up to a batch of about 64 KB,
+ *  frees them for writers, then writes the batch to each stream with
+ *  one call.  While a flush waits, streams are flushed after writing
+ *  and durable_ advanced, which wakes the flush.  With nothing to do,
+ *  or paused, it sleeps until a writer, flush, or resume wakes it.
+ *  Only this thread touches the streams once logging has started.
+ */
+void Logger::drain()
+{
+  const size_t BatchBytes = 64 * 1024;
+  const size_t size = mask_ + 1;
+  bool quit = false;
+  auto work = [&]() { return !paused_.load() && waiting(head_); };
+  auto flushDue = [&]() { return flushers_.load() > 0 && durable_.load() < written_.load(); };
+  while (!quit)
+  {
+    if (!work() && !flushDue())
+    {
+      std::unique_lock<std::mutex> lock(wakeLock_);
+      sleeping_.store(true);
+      wake_.wait(lock, [&]() { return work() || flushDue(); });
+      sleeping_.store(false);
+      continue;
+    }
+    if (work())
     {
-      std::string msg = _queue.deQ();
-      if (msg == "quit")
+      batch_.clear();
+      size_t taken = 0;
+      while (waiting(head_) && batch_.size() < BatchBytes)
       {
-        _ThreadRunning = false;
-        break;
+        Record& rec = ring_[head_ & mask_];
+        quit = rec.quit;
+        if (!quit)
+          batch_ += rec.text;
+        rec.seq.store(head_ + size, std::memory_order_release);
+        ++head_;
+        ++taken;
+        if (quit)
+          break;
       }
       for (auto pStrm : streams_)
-      {
-        *pStrm << msg;
-      }
+        pStrm->write(batch_.data(), batch_.size());
+      written_ += taken;
     }
-  };
-  _pThr = new std::thread (tp);
-  //thr.detach();
+    if (quit || flushers_.load() > 0)
+    {
+      for (auto pStrm : streams_)
+        pStrm->flush();
+      std::lock_guard<std::mutex> lock(wakeLock_);
+      durable_.store(written_.load());
+      flushed_.notify_all();
+    }
+  }
+  std::lock_guard<std::mutex> lock(wakeLock_);
+  _ThreadRunning = false;
+  flushed_.notify_all();
 }
 //----< has logger been started? >-----------------------------------
 
@@ -72,37 +177,40 @@ bool Logger::running()
   return _ThreadRunning;
 }
 //----< suspend logger >---------------------------------------------
-
+/*
+ *  The logging thread finishes the batch it is writing, then holds
+ *  messages until resumed, so it never stops holding a lock or in
+ *  the middle of a stream write.  Writers wait once the ring fills.
+ */
 void Logger::pause(bool doPause)
 {
-  if (doPause)
-  {
-    _Paused = true;
-    ::SuspendThread(_pThr->native_handle());
-  }
-  else
-  {
-    _Paused = false;
-    ::ResumeThread(_pThr->native_handle());
-  }
+  std::lock_guard<std::mutex> lock(wakeLock_);
+  paused_.store(doPause);
+  if (!doPause)
+    wake_.notify_one();
 }
 //----< is logger currently paused? >--------------------------------
 
 bool Logger::paused()
 {
-  return _Paused;
+  return paused_.load();
 }
-//----< wait for logging to empty input queue >----------------------
-
+//----< wait until messages written so far are flushed to the streams >---
+/*
+ *  Returns at once if the logger is stopped or paused, otherwise
+ *  sleeps until the logging thread has written and flushed every
+ *  message claimed before the call.
+ */
 void Logger::flush()
 {
-  if (_ThreadRunning && !_Paused)
-  {
-    while (_queue.size() > 0)
-      ;
-    for (auto pStream : streams_)
-      pStream->flush();
-  }
+  if (!_ThreadRunning || paused_.load())
+    return;
+  size_t target = tail_.load();
+  std::unique_lock<std::mutex> lock(wakeLock_);
+  ++flushers_;
+  wake_.notify_one();
+  flushed_.wait(lock, [&]() { return durable_.load() >= target || !_ThreadRunning; });
+  --flushers_;
 }
 //----< stop logging >-----------------------------------------------
 
@@ -112,7 +220,8 @@ void Logger::stop(const std::string& msg)
   {
     if(msg != "")
       write(msg);
-    write("quit");    // request thread to stop
+    pause(false);     // a paused thread would never reach the request
+    enQ("", true);    // request thread to stop
     if (_pThr->joinable())
       _pThr->join();  // wait for queue to empty
 
@@ -131,6 +240,7 @@ void Logger::wait()
 Logger::~Logger()
 {
   stop();
+  delete _pThr;
 }
 
 struct Cosmetic
@@ -158,6 +268,10 @@ int main()
   log.write("\n  one");
   log.write("\n  two");
   log.write("\n  fini");
+  log.write("quit");
+  log.write("\n  logged after a quit message");
+  for (size_t i = 0; i < 5000; ++i)
+    LOG_STREAM(StaticLogger<3>, "\n  never formatted, StaticLogger<3> isn't running " << i);
   log.stop();
   log.write("\n  won't get logged - stopped");
   log.start();
@@ -177,6 +291,7 @@ int main()
 
   for(size_t i=0; i<5; ++i)
     logger.write("\n  a log msg");
+  logger.flush();
   logger.write("\n  suspending logger");
   logger.pause(true);
   for (size_t i = 0; i<5; ++i)
@@ -2,7 +2,7 @@
 #define LOGGER_H
 /////////////////////////////////////////////////////////////////////
 // Logger.h - log text messages to std::ostream                    //
-// ver 1.2                                                         //
+// ver 1.4                                                         //
 //-----------------------------------------------------------------//
 // Jim Fawcett (c) copyright 2015                                  //
 // All rights granted provided this copyright notice is retained   //
@@ -17,9 +17,24 @@
 * -------------------
 * This package supports logging for multiple concurrent clients to a
 * single std::ostream.  It does this be enqueuing messages in a
-* blocking queue and dequeuing with a single thread that writes to
+* ring of records and dequeuing with a single thread that writes to
 * the std::ostream.
 *
+* The ring has a fixed number of records, allocated when the logger
+* is made, and each record's string keeps its capacity as it's reused,
+* so writing a message copies it without allocating.  Writers claim
+* records with an atomic counter, they don't take a lock.  The logging
+* thread takes every message waiting and writes them to each stream
+* with one call.  If the ring is full writers wait for it to drain.
+*
+* Messages built for a logger that isn't running are thrown away, so
+* call sites that format with + or an ostringstream should use the
+* macros, which check first and only build the message if it will be
+* logged:
+*
+*   LOG_WRITE(Demo, "\n  opening file " + name);
+*   LOG_STREAM(Dbug, "\n  " << count << " tokens");
+*
 * It provides two logging classes, a non-template Logger class with 
 * instance methods, and a template class StaticLogger<int> with static 
 * methods.
@@ -42,6 +57,17 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.4 : 14 Oct 2026
+* - pause holds messages in the logging thread instead of suspending it
+*   with SuspendThread, stop resumes a paused logger first
+* - flush sleeps until the logging thread has written and flushed the
+*   messages before it, instead of spinning, and no longer touches the
+*   streams from the calling thread
+* ver 1.3 : 14 Oct 2026
+* - messages go through a fixed ring of reused records instead of a
+*   BlockingQueue of strings, and are written to streams in batches
+* - added LOG_WRITE and LOG_STREAM, which format only for running loggers
+* - stop no longer depends on a "quit" message, which is now logged
 * ver 1.2 : 27 Aug 2016
 * - added flushing of streams in Logger::flush()
 * - call thread join on stop instead of spin locking
@@ -52,21 +78,31 @@
 *
 * Planned Additions and Changes:
 * ------------------------------
-* - fix pause locking
+* - none
 */
 
 #include <iostream>
+#include <sstream>
 #include <string>
 #include <vector>
 #include <thread>
-#include "../Cpp11-BlockingQueue/Cpp11-BlockingQueue.h"
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+
+// check before format: msg is only built if logger, a StaticLogger type, is running
+#define LOG_WRITE(logger, msg) \
+  do { if (logger::running()) logger::write(msg); } while (0)
+#define LOG_STREAM(logger, items) \
+  do { if (logger::running()) { std::ostringstream log_out_; log_out_ << items; logger::write(log_out_.str()); } } while (0)
 
 namespace Logging
 {
   class Logger
   {
   public:
-    Logger() {}
+    Logger(size_t capacity = 1024);
     void attach(std::ostream* pOut);
     void start();
     bool running();
@@ -81,11 +117,32 @@ namespace Logging
     Logger(const Logger&) = delete;
     Logger& operator=(const Logger&) = delete;
   private:
-    std::thread* _pThr;
+    struct Record
+    {
+      std::atomic<size_t> seq;   // ticket of the write that may fill it next, or +1 when full
+      bool quit;
+      std::string text;
+    };
+    void enQ(const std::string& msg, bool quit);
+    bool waiting(size_t ticket) const;
+    void drain();
+
+    std::thread* _pThr = nullptr;
     std::vector<std::ostream*> streams_;
-    Async::BlockingQueue<std::string> _queue;
-    bool _ThreadRunning = false;
-    bool _Paused = false;
+    std::unique_ptr<Record[]> ring_;
+    size_t mask_;
+    std::atomic<size_t> tail_;       // next write's ticket
+    size_t head_ = 0;                // next record to log, used by the logging thread only
+    std::atomic<size_t> written_;    // records written to the streams
+    std::atomic<size_t> durable_;    // records written and flushed
+    std::atomic<size_t> flushers_;   // flush calls waiting
+    std::atomic<bool> sleeping_;
+    std::atomic<bool> paused_;
+    std::mutex wakeLock_;
+    std::condition_variable wake_;      // logging thread waits for records, flushes, resume
+    std::condition_variable flushed_;   // flush calls wait for durable_
+    std::string batch_;
+    std::atomic<bool> _ThreadRunning;
   };
 
   template<int i>
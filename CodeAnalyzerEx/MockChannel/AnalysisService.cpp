@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// AnalysisService.cpp - Resident code analyzer behind the C++\CLI Shim              //
+// - runs CodeAnalysis::runAnalysis in-process, on one worker thread                 //
+// - reports progress as messages the client reads with getEvent()                   //
+//                                                                                   //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015                         //
+///////////////////////////////////////////////////////////////////////////////////////
+/*
+ * A GUI used to start CodeAnalyzer.exe for every analysis.  The service
+ * instead lives as long as the GUI, so a request pays no process startup,
+ * and every analysis runs with /i: the publish.manifest written by the
+ * last run supplies the types and dependencies of unchanged files, and
+ * only the files changed since then are parsed and published again.
+ *
+ * Requests posted while an analysis is running are coalesced.  When the
+ * worker is free it runs only the latest one, and reports how many it
+ * skipped.
+ *
+ * Build with ANALYSIS_SERVICE defined, so Executive.cpp leaves out main.
+ */
+
+#define IN_DLL
+#include "MockChannel.h"
+#include "../Logger/Cpp11-BlockingQueue.h"   // the analyzer's queue, same include guard as ours
+#include "../Analyzer/Executive.h"
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <iostream>
+
+using BQueue = Async::BlockingQueue < Message >;
+
+class AnalysisService : public IAnalysisService
+{
+public:
+  AnalysisService();
+  ~AnalysisService();
+  void post(const Message& cmdLine);
+  Message getEvent();
+  void stop();
+  static std::vector<std::string> split(const std::string& cmdLine);
+private:
+  void serve();
+  void analyze(size_t id, const Message& cmdLine);
+  BQueue requests_;    // command lines, an empty one stops the worker
+  BQueue events_;
+  std::thread thread_;
+};
+
+//----< start the worker >---------------------------------------------------
+
+AnalysisService::AnalysisService()
+{
+  thread_ = std::thread([this] { serve(); });
+}
+//----< stop the worker, after any analysis it is running >-----------------
+
+AnalysisService::~AnalysisService()
+{
+  stop();
+}
+
+void AnalysisService::stop()
+{
+  if (!thread_.joinable())
+    return;
+  requests_.enQ("");
+  thread_.join();
+}
+//----< queue an analysis, ignores empty command lines >--------------------
+
+void AnalysisService::post(const Message& cmdLine)
+{
+  if (cmdLine.size() > 0)
+    requests_.enQ(cmdLine);
+}
+//----< next progress message, blocks until there is one >------------------
+
+Message AnalysisService::getEvent()
+{
+  return events_.deQ();
+}
+//----< split command line at spaces, except inside double quotes >---------
+
+std::vector<std::string> AnalysisService::split(const std::string& cmdLine)
+{
+  std::vector<std::string> args;
+  std::string arg;
+  bool quoted = false, any = false;
+  for (char ch : cmdLine)
+  {
+    if (ch == '"')
+    {
+      quoted = !quoted;
+      any = true;
+    }
+    else if (ch == ' ' && !quoted)
+    {
+      if (any)
+        args.push_back(arg);
+      arg.clear();
+      any = false;
+    }
+    else
+    {
+      arg += ch;
+      any = true;
+    }
+  }
+  if (any)
+    args.push_back(arg);
+  return args;
+}
+//----< runs the latest request each time the worker is free >--------------
+
+void AnalysisService::serve()
+{
+  size_t id = 0;
+  while (true)
+  {
+    Message cmdLine = requests_.deQ();
+    size_t skipped = 0;
+    while (cmdLine.size() > 0 && requests_.size() > 0)
+    {
+      cmdLine = requests_.deQ();
+      ++skipped;
+    }
+    if (cmdLine.size() == 0)
+      return;
+    if (skipped > 0)
+      events_.enQ("superseded " + std::to_string(skipped));
+    analyze(++id, cmdLine);
+  }
+}
+//----< run one analysis with /i, reporting its phases >--------------------
+
+void AnalysisService::analyze(size_t id, const Message& cmdLine)
+{
+  std::vector<std::string> args = split(cmdLine);
+  args.insert(args.begin(), "CodeAnalyzer");
+  if (std::find(args.begin(), args.end(), "/i") == args.end())
+    args.push_back("/i");
+  std::vector<char*> argv;
+  for (auto& arg : args)
+    argv.push_back(&arg[0]);
+  argv.push_back(nullptr);
+
+  events_.enQ("started " + std::to_string(id));
+  std::string failure = "invalid command line";
+  auto start = std::chrono::steady_clock::now();
+  int result = CodeAnalysis::runAnalysis(static_cast<int>(args.size()), argv.data(), [&](const std::string& phase) {
+    if (phase.compare(0, 8, "failed: ") == 0)
+      failure = phase.substr(8);
+    else
+      events_.enQ("phase " + phase);
+  });
+  auto millis = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+  if (result == 0)
+    events_.enQ("done " + std::to_string(id) + " " + std::to_string(millis) + " ms");
+  else
+    events_.enQ("failed " + std::to_string(id) + " " + failure);
+}
+
+//----< factory function >---------------------------------------------------
+
+IAnalysisService* ObjectFactory::createAnalysisService()
+{
+  return new AnalysisService;
+}
+
+#ifdef TEST_ANALYSISSERVICE
+
+//----< test stub >----------------------------------------------------------
+
+int main(int argc, char* argv[])
+{
+  ObjectFactory objFact;
+  IAnalysisService* pService = objFact.createAnalysisService();
+  std::string cmdLine = argc > 1 ? argv[1] : "\"../TestFiles\" *.h *.cpp /r";
+  pService->post(cmdLine);
+  pService->post(cmdLine);   // runs again, only changed files are parsed
+  size_t done = 0;
+  while (done < 2)
+  {
+    Message event = pService->getEvent();
+    std::cout << "\n  event: " << event;
+    if (event.compare(0, 4, "done") == 0 || event.compare(0, 6, "failed") == 0)
+      ++done;
+    else if (event.compare(0, 10, "superseded") == 0)
+      ++done;
+  }
+  pService->stop();
+  delete pService;
+  std::cout << "\n\n";
+}
+#endif
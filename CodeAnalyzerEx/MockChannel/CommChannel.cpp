@@ -0,0 +1,317 @@
+///////////////////////////////////////////////////////////////////////////////////////
+// CommChannel.cpp - Channel from the C++\CLI Shim to a remote MsgServer             //
+// - same ISendr, IRecvr, IMockChannel interfaces as MockChannel                     //
+// - requests are carried out with MsgClient over Sockets and HttpMessage            //
+//                                                                                   //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015                         //
+///////////////////////////////////////////////////////////////////////////////////////
+/*
+ * The GUI posts requests as text messages and reads the replies:
+ *
+ *   fetch <file> [range]   ->  chunk <file> <offset> <total>\n<bytes>  (one per chunk)
+ *                              end <file>, or missing <file>
+ *   download               ->  file <name> for each page received into ../TestFiles,
+ *                              then downloaded <count>, or failed download
+ *   upload <file> ...      ->  uploaded <count>, or failed upload
+ *   search <text>          ->  hit <file> <line>\n<matching line>, or
+ *   grep <regex>               symbol <file> <line> <kind>\n<name>, for each hit,
+ *                              then searched <count>, or failed search
+ *   sync                   ->  stale <file> for each page the local cache lacks or
+ *                              holds changed, then synced <stale> <held>, or failed sync
+ *   cache <file> ...       ->  cached <fetched>, or failed cache, pages are written
+ *                              into ../TestFiles with the cache's index
+ *   subscribe [prefix ...] ->  subscribed <prefixes>, or failed subscribe, then
+ *                              at any time, as the server publishes pages:
+ *                              changed <file> <etag>, removed <file>, published <pages>
+ *   unsubscribe            ->  unsubscribed
+ *
+ * Anything else is answered with "unknown <request>".  A range is
+ * "bytes=first-last" or "lines=first-last", as for MsgClient::fetch.
+ * A search's text, or regex, is the rest of the request after one space,
+ * matched without regard to case, by the server's search index.
+ *
+ * One worker thread owns the MsgClient and its long lived connection,
+ * so the GUI's sending and receiving threads never wait on a socket.
+ * The worker takes every request already queued in one go, and each
+ * chunk of a page is posted as it arrives, so a viewer can show the
+ * first screen before the rest is read.  Nothing is written to the
+ * console while requests are served.  Notices of a subscription are
+ * posted by the client's notice thread as they come, between replies,
+ * so the GUI fetches just the pages it shows that changed.
+ *
+ * Build with COMM_CHANNEL defined, so MsgClient.cpp leaves out main.
+ */
+
+#define IN_DLL
+#include "MockChannel.h"
+#include "../MsgClient/MsgClient.h"   // brings the Async::BlockingQueue
+#include <string>
+#include <vector>
+#include <thread>
+#include <sstream>
+
+using CQueue = Async::BlockingQueue < Message >;
+
+/////////////////////////////////////////////////////////////////////////////
+// CommSendr and CommRecvr hold the queues between the client and channel
+//
+class CommSendr : public ISendr
+{
+public:
+  void postMessage(const Message& msg) { sendQ_.enQ(msg); }
+  void postMessages(std::vector<Message>& msgs);
+  CQueue& queue() { return sendQ_; }
+private:
+  CQueue sendQ_;
+};
+
+void CommSendr::postMessages(std::vector<Message>& msgs)
+{
+  for (auto& msg : msgs)
+    sendQ_.enQ(std::move(msg));
+  msgs.clear();
+}
+
+class CommRecvr : public IRecvr
+{
+public:
+  Message getMessage() { return recvQ_.deQ(); }
+  size_t getMessages(std::vector<Message>& msgs, size_t maxCount);
+  CQueue& queue() { return recvQ_; }
+private:
+  CQueue recvQ_;
+};
+
+//----< waits for one reply, then takes up to maxCount already queued >-----
+
+size_t CommRecvr::getMessages(std::vector<Message>& msgs, size_t maxCount)
+{
+  msgs.clear();
+  if (maxCount == 0)
+    return 0;
+  msgs.push_back(recvQ_.deQ());
+  while (msgs.size() < maxCount && recvQ_.size() > 0)
+    msgs.push_back(recvQ_.deQ());
+  return msgs.size();
+}
+
+/////////////////////////////////////////////////////////////////////////////
+// CommChannel
+// - serves the client's requests on one thread with a MsgClient
+//
+class CommChannel : public IMockChannel
+{
+public:
+  CommChannel(ISendr* pSendr, IRecvr* pRecvr, const std::string& host, size_t port);
+  ~CommChannel();
+  void start();
+  void stop();
+private:
+  void serve(CQueue& sendQ, CQueue& recvQ);
+  void handle(const Message& request, CQueue& recvQ);
+  ISendr* pISendr_;
+  IRecvr* pIRecvr_;
+  MsgClient client_;
+  std::thread thread_;
+  static const Message Quit;
+};
+
+const Message CommChannel::Quit = "\x1bquit";   // not a request the client can type
+
+CommChannel::CommChannel(ISendr* pSendr, IRecvr* pRecvr, const std::string& host, size_t port)
+  : pISendr_(pSendr), pIRecvr_(pRecvr), client_(host, port) {}
+
+CommChannel::~CommChannel()
+{
+  stop();
+}
+//----< start the worker, false start leaves the channel closed >-----------
+
+void CommChannel::start()
+{
+  CommSendr* pSendr = dynamic_cast<CommSendr*>(pISendr_);
+  CommRecvr* pRecvr = dynamic_cast<CommRecvr*>(pIRecvr_);
+  if (pSendr == nullptr || pRecvr == nullptr || thread_.joinable())
+    return;
+  thread_ = std::thread([this, pSendr, pRecvr] { serve(pSendr->queue(), pRecvr->queue()); });
+}
+//----< finish queued requests, then say goodbye to the server >------------
+
+void CommChannel::stop()
+{
+  if (!thread_.joinable())
+    return;
+  dynamic_cast<CommSendr*>(pISendr_)->queue().enQ(Quit);
+  thread_.join();
+  client_.close();
+}
+//----< take all queued requests at once and serve them in order >----------
+
+void CommChannel::serve(CQueue& sendQ, CQueue& recvQ)
+{
+  std::vector<Message> batch;
+  while (true)
+  {
+    batch.push_back(sendQ.deQ());
+    while (sendQ.size() > 0)
+      batch.push_back(sendQ.deQ());
+    for (auto& request : batch)
+    {
+      if (request == Quit)
+        return;
+      handle(request, recvQ);
+    }
+    batch.clear();
+  }
+}
+//----< carry out one request, replies go straight to the client >----------
+
+void CommChannel::handle(const Message& request, CQueue& recvQ)
+{
+  std::istringstream in(request);
+  std::string verb;
+  in >> verb;
+  if (verb == "fetch")
+  {
+    std::string file, range;
+    in >> file >> range;
+    auto onChunk = [&](size_t offset, const std::string& bytes, size_t total) {
+      recvQ.enQ("chunk " + file + " " + std::to_string(offset) + " " + std::to_string(total) + "\n" + bytes);
+    };
+    recvQ.enQ((file != "" && client_.fetch(file, range, onChunk) ? "end " : "missing ") + file);
+  }
+  else if (verb == "download")
+  {
+    Async::BlockingQueue<HttpMessage> msgQ;
+    if (!client_.download(msgQ))
+    {
+      recvQ.enQ("failed download");
+      return;
+    }
+    size_t count = 0;
+    for (; msgQ.size() > 0; ++count)
+      recvQ.enQ("file " + msgQ.deQ().findValue("file"));
+    recvQ.enQ("downloaded " + std::to_string(count));
+  }
+  else if (verb == "search" || verb == "grep")
+  {
+    std::string query = request.size() > verb.size() + 1 ? request.substr(verb.size() + 1) : "";
+    std::vector<MsgClient::SearchHit> hits;
+    if (query == "" || !client_.search(query, hits, verb == "grep", true))
+    {
+      recvQ.enQ("failed search");
+      return;
+    }
+    for (auto& hit : hits)
+    {
+      if (hit.symbol != "")
+        recvQ.enQ("symbol " + hit.file + " " + std::to_string(hit.line) + " " + hit.text + "\n" + hit.symbol);
+      else
+        recvQ.enQ("hit " + hit.file + " " + std::to_string(hit.line) + "\n" + hit.text);
+    }
+    recvQ.enQ("searched " + std::to_string(hits.size()));
+  }
+  else if (verb == "sync")
+  {
+    std::vector<std::string> stale;
+    if (!client_.syncCache(stale))
+    {
+      recvQ.enQ("failed sync");
+      return;
+    }
+    for (auto& page : stale)
+      recvQ.enQ("stale " + page);
+    recvQ.enQ("synced " + std::to_string(stale.size()) + " " + std::to_string(client_.cachedPages()));
+  }
+  else if (verb == "cache")
+  {
+    std::vector<std::string> pages;
+    std::string page;
+    while (in >> page)
+      pages.push_back(page);
+    size_t fetched = 0;
+    recvQ.enQ(client_.cachePages(pages, fetched) ? "cached " + std::to_string(fetched) : "failed cache");
+  }
+  else if (verb == "subscribe")
+  {
+    std::vector<std::string> prefixes;
+    std::string prefix;
+    while (in >> prefix)
+      prefixes.push_back(prefix);
+    auto onNotice = [&recvQ](const MsgClient::Notice& notice) {
+      if (notice.event == "published")
+        recvQ.enQ("published " + std::to_string(notice.pages));
+      else
+        recvQ.enQ(notice.event + " " + notice.file + (notice.etag != "" ? " " + notice.etag : ""));
+    };
+    bool ok = client_.subscribe(prefixes, onNotice);
+    recvQ.enQ(ok ? "subscribed " + std::to_string(prefixes.size()) : "failed subscribe");
+  }
+  else if (verb == "unsubscribe")
+  {
+    client_.unsubscribe();
+    recvQ.enQ("unsubscribed");
+  }
+  else if (verb == "upload")
+  {
+    std::vector<std::string> files;
+    std::string file;
+    while (in >> file)
+      files.push_back(file);
+    recvQ.enQ(client_.upload(files, 1) ? "uploaded " + std::to_string(files.size()) : "failed upload");
+  }
+  else
+    recvQ.enQ("unknown " + request);
+}
+
+//----< factory functions >--------------------------------------------------
+
+ISendr* ObjectFactory::createCommSendr() { return new CommSendr; }
+
+IRecvr* ObjectFactory::createCommRecvr() { return new CommRecvr; }
+
+IMockChannel* ObjectFactory::createCommChannel(ISendr* pISendr, IRecvr* pIRecvr, const std::string& host, size_t port)
+{
+  return new CommChannel(pISendr, pIRecvr, host, port);
+}
+
+#ifdef TEST_COMMCHANNEL
+
+//----< test stub, needs MsgServer running on localhost:8080 >--------------
+
+#include <iostream>
+
+int main()
+{
+  ObjectFactory objFact;
+  ISendr* pSendr = objFact.createCommSendr();
+  IRecvr* pRecvr = objFact.createCommRecvr();
+  IMockChannel* pChannel = objFact.createCommChannel(pSendr, pRecvr, "localhost", 8080);
+  pChannel->start();
+  pSendr->postMessage("download");
+  std::vector<std::string> pages;
+  while (true)
+  {
+    Message reply = pRecvr->getMessage();
+    std::cout << "\n  " << reply;
+    if (reply.compare(0, 5, "file ") == 0)
+      pages.push_back(reply.substr(5));
+    if (reply.compare(0, 10, "downloaded") == 0 || reply.compare(0, 6, "failed") == 0)
+      break;
+  }
+  if (pages.size() > 0)
+  {
+    pSendr->postMessage("fetch " + pages[0] + " lines=1-20");
+    while (true)
+    {
+      Message reply = pRecvr->getMessage();
+      std::cout << "\n  " << reply.substr(0, reply.find('\n'));
+      if (reply.compare(0, 4, "end ") == 0 || reply.compare(0, 8, "missing ") == 0)
+        break;
+    }
+  }
+  pChannel->stop();
+  delete pChannel;
+  std::cout << "\n\n";
+}
+#endif
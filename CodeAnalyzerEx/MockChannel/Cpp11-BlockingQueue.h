@@ -2,7 +2,7 @@
 #define CPP11_BLOCKINGQUEUE_H
 ///////////////////////////////////////////////////////////////
 // Cpp11-BlockingQueue.h - Thread-safe Blocking Queue        //
-// ver 1.2                                                   //
+// ver 1.3                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015 //
 ///////////////////////////////////////////////////////////////
 /*
@@ -24,6 +24,8 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 1.3 : 14 Oct 2026
+ * - added enQ(T&&), deQ moves the front element out
  * ver 1.2 : 15 Apr 2015
  * - deleted copy constructor and assignment operator
  * ver 1.1 : 26 Jan 2015
@@ -52,6 +54,7 @@ public:
   BlockingQueue<T>& operator=(const BlockingQueue<T>&)=delete;
   T deQ();
   void enQ(const T& t);
+  void enQ(T&& t);
   size_t size();
 private:
   std::queue<T> q_;
@@ -65,7 +68,7 @@ T BlockingQueue<T>::deQ()
   std::unique_lock<std::mutex> l(mtx_);
   if(q_.size() > 0)
   {
-    T temp = q_.front();
+    T temp = std::move(q_.front());
     q_.pop();
     return temp;
   }
@@ -73,7 +76,7 @@ T BlockingQueue<T>::deQ()
 
   while (q_.size() == 0)
     cv_.wait(l, [this] () { return q_.size() > 0; });
-  T temp = q_.front();
+  T temp = std::move(q_.front());
   q_.pop();
   return temp;
 }
@@ -88,6 +91,16 @@ void BlockingQueue<T>::enQ(const T& t)
   cv_.notify_one();
 }
 
+template<typename T>
+void BlockingQueue<T>::enQ(T&& t)
+{
+  {
+    std::lock_guard<std::mutex> l(mtx_);
+    q_.push(std::move(t));
+  }
+  cv_.notify_one();
+}
+
 template<typename T>
 size_t BlockingQueue<T>::size()
 {
@@ -23,6 +23,7 @@ class Sendr : public ISendr
 {
 public:
   void postMessage(const Message& msg);
+  void postMessages(std::vector<Message>& msgs);
   BQueue& queue();
 private:
   BQueue sendQ_;
@@ -32,6 +33,14 @@ void Sendr::postMessage(const Message& msg)
 {
   sendQ_.enQ(msg);
 }
+//----< post a batch, moving each message into the queue >-------------------
+
+void Sendr::postMessages(std::vector<Message>& msgs)
+{
+  for (auto& msg : msgs)
+    sendQ_.enQ(std::move(msg));
+  msgs.clear();
+}
 
 BQueue& Sendr::queue() { return sendQ_; }
 
@@ -43,6 +52,7 @@ class Recvr : public IRecvr
 {
 public:
   Message getMessage();
+  size_t getMessages(std::vector<Message>& msgs, size_t maxCount);
   BQueue& queue();
 private:
   BQueue recvQ_;
@@ -52,6 +62,18 @@ Message Recvr::getMessage()
 {
   return recvQ_.deQ();
 }
+//----< waits for one message, then takes up to maxCount already queued >---
+
+size_t Recvr::getMessages(std::vector<Message>& msgs, size_t maxCount)
+{
+  msgs.clear();
+  if (maxCount == 0)
+    return 0;
+  msgs.push_back(recvQ_.deQ());
+  while (msgs.size() < maxCount && recvQ_.size() > 0)
+    msgs.push_back(recvQ_.deQ());
+  return msgs.size();
+}
 
 BQueue& Recvr::queue()
 {
@@ -99,7 +121,7 @@ void MockChannel::start()
       std::cout << "\n  channel deQing message";
       Message msg = sendQ.deQ();  // will block here so send quit message when stopping
       std::cout << "\n  channel enQing message";
-      recvQ.enQ(msg);
+      recvQ.enQ(std::move(msg));
     }
     std::cout << "\n  Server stopping\n\n";
   });
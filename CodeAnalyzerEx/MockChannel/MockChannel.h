@@ -4,6 +4,7 @@
 // MockChannel.h - Demo for CSE687 Project #4, Spring 2015                           //
 // - build as static Library showing how C++\CLI client can use native code channel  //
 // - MockChannel reads from sendQ and writes to recvQ                                //
+// - AnalysisService runs code analyses in-process, see AnalysisService.cpp          //
 //                                                                                   //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2015                         //
 ///////////////////////////////////////////////////////////////////////////////////////
@@ -15,16 +16,19 @@
 #endif
 
 #include <string>
+#include <vector>
 using Message = std::string;
 
 struct ISendr
 {
   virtual void postMessage(const Message& msg) = 0;
+  virtual void postMessages(std::vector<Message>& msgs) = 0;   // moves msgs out
 };
 
 struct IRecvr
 {
   virtual std::string getMessage() = 0;
+  virtual size_t getMessages(std::vector<Message>& msgs, size_t maxCount) = 0;
 };
 
 struct IMockChannel
@@ -32,6 +36,21 @@ struct IMockChannel
 public:
   virtual void start() = 0;
   virtual void stop() = 0;
+  virtual ~IMockChannel() {}
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// IAnalysisService
+// - post queues an analysis, with the command line CodeAnalyzer.exe takes
+// - getEvent blocks until the service reports progress, e.g.,
+//   "started 3", "phase parse", "done 3 412 ms", "failed 3 <reason>"
+//
+struct IAnalysisService
+{
+  virtual void post(const Message& cmdLine) = 0;
+  virtual Message getEvent() = 0;
+  virtual void stop() = 0;
+  virtual ~IAnalysisService() {}
 };
 
 extern "C" {
@@ -40,6 +59,12 @@ extern "C" {
     DLL_DECL ISendr* createSendr();
     DLL_DECL IRecvr* createRecvr();
     DLL_DECL IMockChannel* createMockChannel(ISendr* pISendr, IRecvr* pIRecvr);
+    DLL_DECL IAnalysisService* createAnalysisService();
+
+    // channel to a MsgServer at host:port, requests are described in CommChannel.cpp
+    DLL_DECL ISendr* createCommSendr();
+    DLL_DECL IRecvr* createCommRecvr();
+    DLL_DECL IMockChannel* createCommChannel(ISendr* pISendr, IRecvr* pIRecvr, const std::string& host, size_t port);
   };
 }
 
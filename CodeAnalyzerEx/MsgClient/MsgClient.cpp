@@ -8,9 +8,17 @@
 
 
 #include "MsgClient.h"
+#include "../Sockets/Compression.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../CodePublisher/PageDiff.h"
 #include <string>
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <thread>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 
 using namespace Logging;
 using Show = StaticLogger<1>;
@@ -20,6 +28,37 @@ using Utils = StringHelper;
 
 size_t ClientCounter::clientCount = 0;
 
+//----< connect, or reuse the connection made by an earlier call >---
+/*
+ * - retries with a delay that doubles from 10 ms up to 500 ms, so a
+ *   server that is already up is reached at once
+ */
+bool ClientConnection::open(size_t timeoutMs)
+{
+  if (open_)
+    return true;
+  size_t waited = 0, delay = 10;
+  while (!socket_.connect(host_, port_))
+  {
+    if (waited >= timeoutMs)
+      return false;
+    Show::write("\n client waiting to connect");
+    ::Sleep((DWORD)delay);
+    waited += delay;
+    delay = (std::min)(2 * delay, (size_t)500);
+  }
+  open_ = true;
+  return true;
+}
+//----< close a connection that failed, the next open reconnects >---
+
+void ClientConnection::drop()
+{
+  socket_.shutDown();
+  socket_.close();
+  open_ = false;
+}
+
 HttpMessage MsgClient::makeMessage(size_t n, const std::string& body, const EndPoint& ep)
 {
   HttpMessage msg;
@@ -48,54 +87,474 @@ HttpMessage MsgClient::makeMessage(size_t n, const std::string& body, const EndP
   }
   return msg;
 }
-//----< send message using socket >----------------------------------
-
-void MsgClient::sendMessage(HttpMessage& msg, Socket& socket)
+//----< name the branch msg's upload belongs to, if one was set >-----
+/*
+ * - the server keeps a manifest of each branch's files, stored once
+ *   by content however many branches upload them
+ */
+void MsgClient::addBranch(HttpMessage& msg)
 {
-  std::string msgString = msg.toString();
-  socket.send(msgString.size(), (Socket::byte*)msgString.c_str());
+  if (branch_ != "")
+    msg.addAttribute(HttpMessage::Attribute("branch", branch_));
+}
+//----< send message using socket, framed as text or binary >--------
+/*
+ * - header and body go out in one vectored send, the body isn't copied
+ */
+bool MsgClient::sendMessage(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::string head;
+  return socket.sendBuffers(msg.toBuffers(head, binary));
 }
 //----< send file using socket >-------------------------------------
 /*
  * - Sends a message to tell receiver a file is coming.
- * - Then sends a stream of bytes until the entire file
- *   has been sent.
- * - Sends in binary mode which works for either text or binary.
+ * - Then hands the file to Socket::sendFile, which sends it with
+ *   TransmitFile, so file bytes are not copied through this process.
+ * - If the server accepts compressed bodies the file is streamed as
+ *   compressed blocks instead, content-length is still its size.
+ * - With pCredit the file goes in segments, each sent once the server
+ *   has granted credit for it, see sendCredited, or, if the server
+ *   resumes uploads, in chunks it keeps across connections, see
+ *   sendResumable.
+ * - With ack the server answers ACK once the file is stored, see postFile.
  */
-bool MsgClient::sendFile(const std::string& filename, Socket& socket)
+bool MsgClient::sendFile(const std::string& filename, Socket& socket, bool binary, Credit* pCredit, bool ack)
 {
   // assumes that socket is connected
 
-  std::string fqname = "../TestFiles/" + filename;
+  std::string fqname = localDir_ + filename;
   FileSystem::FileInfo fi(fqname);
   size_t fileSize = fi.size();
   std::string sizeString = Converter<size_t>::toString(fileSize);
-  FileSystem::File file(fqname);
-  file.open(FileSystem::File::in, FileSystem::File::binary);
-  if (!file.isGood())
+  if (!fi.good())
     return false;
-  
+
   HttpMessage msg = makeMessage(1, "", "localhost::8080");
   msg.addAttribute(HttpMessage::Attribute("file", filename));
   msg.addAttribute(HttpMessage::Attribute("content-length", sizeString));
-  sendMessage(msg, socket);
-  const size_t BlockSize = 2048;
-  Socket::byte buffer[BlockSize];
-  while (true)
+  if (ack)
+    msg.addAttribute(HttpMessage::Attribute("ack", "yes"));
+  addBranch(msg);
+  if (pCredit != nullptr && resume_)
+    return sendResumable(filename, fqname, fileSize, socket, binary, *pCredit);
+  if (pCredit != nullptr)
   {
-    FileSystem::Block blk = file.getBlock(BlockSize);
-    if (blk.size() == 0)
-      break;
-    for (size_t i = 0; i < blk.size(); ++i)
-      buffer[i] = blk[i];
-    socket.send(blk.size(), buffer);
-    if (!file.isGood())
-      break;
+    msg.addAttribute(HttpMessage::Attribute("flow", "credit"));
+    if (compress_)
+      msg.addAttribute(HttpMessage::Attribute("content-encoding", Compression::Name));
+    return sendMessage(msg, socket, binary) && sendCredited(fqname, fileSize, socket, binary, *pCredit);
+  }
+  if (compress_)
+  {
+    msg.addAttribute(HttpMessage::Attribute("content-encoding", Compression::Name));
+    return sendMessage(msg, socket, binary) && socket.sendFileCompressed(fqname, fileSize);
+  }
+  return sendMessage(msg, socket, binary) && socket.sendFile(fqname, fileSize);
+}
+//----< send file's bytes a segment at a time, within the server's credit >---
+/*
+ * - a segment is sent only when credit covers it, otherwise grants are
+ *   read until it does, so the client pauses while the server's disk
+ *   queue is full
+ * - segments are compressed on their own if the server accepts it
+ */
+bool MsgClient::sendCredited(const std::string& fqname, size_t bytes, Socket& socket, bool binary, Credit& credit)
+{
+  std::ifstream in(fqname, std::ios::binary);
+  std::vector<char> segment(creditSegment_);
+  while (bytes > 0)
+  {
+    size_t count = (std::min)(bytes, creditSegment_);
+    while (credit.available < count)
+    {
+      if (!takeGrant(socket, binary, credit))
+        return false;
+    }
+    if (!in.read(&segment[0], count))
+      return false;
+    if (!(compress_ ? socket.sendCompressed(count, &segment[0]) : socket.send(count, &segment[0])))
+      return false;
+    credit.available -= count;
+    ++credit.owed;
+    bytes -= count;
   }
-  file.close();
   return true;
 }
+//----< upload file in chunks, sending only those the server doesn't hold >---
+/*
+ * - a RESUME query gives the file's size and content hash, and the
+ *   chunk size, the credit segment; the server answers with the index
+ *   and hash of each chunk it kept from an earlier, broken off upload
+ * - the other chunks are sent as CHUNK messages within credit, then
+ *   COMMIT asks the server to put the file in place
+ * - chunks the server reports missing are sent again, MaxRetries times
+ */
+bool MsgClient::sendResumable(const std::string& filename, const std::string& fqname, size_t fileSize,
+  Socket& socket, bool binary, Credit& credit)
+{
+  const size_t MaxRetries = 3;
+  size_t chunkSize = creditSegment_;
+  std::ifstream in(fqname, std::ios::binary);
+  std::vector<std::string> hashes((fileSize + chunkSize - 1) / chunkSize);
+  std::vector<char> chunk(chunkSize);
+  for (size_t i = 0; i < hashes.size(); ++i)
+  {
+    size_t count = (std::min)(chunkSize, fileSize - i * chunkSize);
+    if (!in.read(&chunk[0], count))
+      return false;
+    hashes[i] = PublishManifest::bytesHash(&chunk[0], count);
+  }
+  if (!drainGrants(socket, binary, credit))
+    return false;
+  HttpMessage query;
+  query.addAttribute(HttpMessage::attribute("RESUME", "query"));
+  query.addAttribute(HttpMessage::Attribute("file", filename));
+  query.addAttribute(HttpMessage::Attribute("file-size", Converter<size_t>::toString(fileSize)));
+  query.addAttribute(HttpMessage::Attribute("file-hash", PublishManifest::contentHash(fqname)));
+  query.addAttribute(HttpMessage::Attribute("chunk-size", Converter<size_t>::toString(chunkSize)));
+  addBranch(query);
+  if (!sendMessage(query, socket, binary))
+    return false;
+  HttpMessage reply = readReply(socket, binary);
+  if (reply.findValue("RESUME") != "held")
+    return false;
+  std::vector<std::string> held(hashes.size());
+  for (auto& entry : HttpMessage::parseManifest(reply.bodyString()))
+  {
+    size_t index = Converter<size_t>::toValue(entry.first);
+    if (index < held.size())
+      held[index] = entry.second;
+  }
+  std::vector<size_t> toSend;
+  for (size_t i = 0; i < hashes.size(); ++i)
+  {
+    if (held[i] != hashes[i])
+      toSend.push_back(i);
+  }
+  for (size_t attempt = 0; ; ++attempt)
+  {
+    for (size_t index : toSend)
+    {
+      if (!sendChunk(filename, in, index, hashes[index], fileSize, socket, binary, credit))
+        return false;
+    }
+    if (!drainGrants(socket, binary, credit))
+      return false;
+    HttpMessage commit;
+    commit.addAttribute(HttpMessage::attribute("COMMIT", "file"));
+    commit.addAttribute(HttpMessage::Attribute("file", filename));
+    addBranch(commit);
+    if (!sendMessage(commit, socket, binary))
+      return false;
+    reply = readReply(socket, binary);
+    if (reply.findValue("COMMIT") == "done")
+      return true;
+    if (reply.findValue("COMMIT") != "missing" || attempt == MaxRetries)
+      return false;
+    toSend.clear();
+    for (auto& entry : HttpMessage::parseManifest(reply.bodyString()))
+      toSend.push_back(Converter<size_t>::toValue(entry.first));
+    if (toSend.size() == 0)
+      return false;
+  }
+}
+//----< send chunk index of file as a CHUNK message, within credit >---
+
+bool MsgClient::sendChunk(const std::string& filename, std::ifstream& in, size_t index, const std::string& hash,
+  size_t fileSize, Socket& socket, bool binary, Credit& credit)
+{
+  size_t offset = index * creditSegment_;
+  if (offset >= fileSize)
+    return false;
+  size_t count = (std::min)(creditSegment_, fileSize - offset);
+  std::vector<char> chunk(count);
+  in.clear();
+  if (!in.seekg(static_cast<std::streamoff>(offset)) || !in.read(&chunk[0], count))
+    return false;
+  while (credit.available < count)
+  {
+    if (!takeGrant(socket, binary, credit))
+      return false;
+  }
+  HttpMessage msg;
+  msg.addAttribute(HttpMessage::attribute("CHUNK", "data"));
+  msg.addAttribute(HttpMessage::Attribute("file", filename));
+  msg.addAttribute(HttpMessage::Attribute("chunk", Converter<size_t>::toString(index)));
+  msg.addAttribute(HttpMessage::Attribute("chunk-hash", hash));
+  msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(count)));
+  if (compress_)
+    msg.addAttribute(HttpMessage::Attribute("content-encoding", Compression::Name));
+  if (!sendMessage(msg, socket, binary))
+    return false;
+  if (!(compress_ ? socket.sendCompressed(count, &chunk[0]) : socket.send(count, &chunk[0])))
+    return false;
+  credit.available -= count;
+  ++credit.owed;
+  return true;
+}
+//----< read one CREDIT grant the server owes us >-------------------
+
+bool MsgClient::takeGrant(Socket& socket, bool binary, Credit& credit)
+{
+  if (credit.owed == 0)
+    return false;
+  HttpMessage grant = readReply(socket, binary);
+  if (grant.findValue("CREDIT") != "grant")
+    return false;
+  --credit.owed;
+  credit.available += Converter<size_t>::toValue(grant.findValue("credit"));
+  return true;
+}
+//----< read every grant still owed, before the socket is used for replies >---
+
+bool MsgClient::drainGrants(Socket& socket, bool binary, Credit& credit)
+{
+  while (credit.owed > 0)
+  {
+    if (!takeGrant(socket, binary, credit))
+      return false;
+  }
+  return true;
+}
+//----< open connection once, and learn if server takes compression >---
+
+bool MsgClient::connect()
+{
+  if (connection_.isOpen())
+    return true;
+  if (!connection_.open())
+    return false;
+  negotiate(connection_.socket());
+  return true;
+}
+//----< ask server which content encodings, sync and framing it accepts >---
+/*
+ * - servers that don't know OPTIONS don't answer, so after a short
+ *   wait files are sent uncompressed, and all of them, as text
+ * - returns false if the server didn't answer
+ */
+bool MsgClient::negotiate(Socket& socket)
+{
+  HttpMessage msg;
+  msg.addAttribute(HttpMessage::attribute("OPTIONS", "encodings"));
+  msg.addAttribute(HttpMessage::Attribute("accept-encoding", Compression::Name));
+  msg.addAttribute(HttpMessage::Attribute("accept-framing", HttpMessage::BinaryFraming));
+  compress_ = sync_ = binary_ = resume_ = false;
+  creditSegment_ = creditWindow_ = 0;
+  if (!sendMessage(msg, socket))
+    return false;
+  const size_t MaxWait = 2000, Check = 10;
+  for (size_t waited = 0; socket.bytesWaiting() == 0; waited += Check)
+  {
+    if (waited >= MaxWait)
+      return false;
+    ::Sleep((DWORD)Check);
+  }
+  HttpMessage reply = readReply(socket);
+  compress_ = reply.findValue("accept-encoding").find(Compression::Name) != std::string::npos;
+  sync_ = reply.findValue("accept-sync") == "manifest";
+  binary_ = reply.findValue("accept-framing") == HttpMessage::BinaryFraming;
+  std::string segment = reply.findValue("accept-credit");
+  std::string window = reply.findValue("credit-window");
+  if (segment != "" && window != "")
+  {
+    creditSegment_ = Converter<size_t>::toValue(segment);
+    creditWindow_ = Converter<size_t>::toValue(window);
+    if (creditSegment_ == 0 || creditWindow_ < creditSegment_)
+      creditSegment_ = creditWindow_ = 0;
+  }
+  resume_ = creditSegment_ > 0 && reply.findValue("accept-resume") == "chunks";
+  return true;
+}
+//----< send one message, with ack wait until the server has read it >---
+/*
+ * - without ack the message is one way, post returns once it's sent
+ * - with ack the server answers ACK when it has read the message, so
+ *   the time post takes is a round trip, as load tests measure it
+ */
+bool MsgClient::post(const std::string& body, bool ack)
+{
+  if (!connect())
+    return false;
+  HttpMessage msg = makeMessage(1, body, "localhost:8080");
+  if (ack)
+    msg.addAttribute(HttpMessage::Attribute("ack", "yes"));
+  if (!sendMessage(msg, connection_.socket(), binary_))
+  {
+    connection_.drop();
+    return false;
+  }
+  return !ack || readAck();
+}
+//----< upload one file, as is, with ack wait until it's stored >-----
+/*
+ * - unlike upload, the file is sent even if the server holds it, and
+ *   as one POST, within credit if the server grants it, not by chunks
+ */
+bool MsgClient::postFile(const std::string& file, bool ack)
+{
+  if (!connect())
+    return false;
+  Credit credit;
+  credit.available = creditWindow_;
+  Credit* pCredit = (creditSegment_ > 0 && !resume_) ? &credit : nullptr;
+  Socket& socket = connection_.socket();
+  if (!sendFile(file, socket, binary_, pCredit, ack) || (pCredit != nullptr && !drainGrants(socket, binary_, credit)))
+  {
+    connection_.drop();
+    return false;
+  }
+  return !ack || readAck();
+}
+//----< read the server's ACK of a post, false if it didn't come >----
+
+bool MsgClient::readAck()
+{
+  HttpMessage reply = readReply(connection_.socket(), binary_);
+  if (reply.attributes().size() == 0)
+  {
+    connection_.drop();
+    return false;
+  }
+  return reply.findValue("ACK") != "";
+}
+//----< read header and content-length body of a server reply >------
+
+HttpMessage MsgClient::readReply(Socket& socket, bool binary)
+{
+  HttpMessage reply;
+  if (binary && !reply.recvBinaryHeader(socket))
+    return HttpMessage();
+  while (!binary)
+  {
+    std::string attribString = socket.recvString('\n');
+    if (attribString.size() <= 1)
+      break;
+    reply.addAttribute(HttpMessage::parseAttribute(attribString));
+  }
+  std::string sizeString = reply.findValue("content-length");
+  if (sizeString != "")
+  {
+    size_t numBytes = Converter<size_t>::toValue(sizeString);
+    std::string body(numBytes, '\0');
+    if (numBytes > 0 && socket.recv(numBytes, &body[0]))
+      reply.addBody(body);
+  }
+  return reply;
+}
+//----< ask server which of files it is missing or holds changed >---
+/*
+ * - sends a SYNC manifest with the content hash of every file, the
+ *   server answers with the ones it needs, so an upload after a small
+ *   commit sends a few files instead of the whole directory
+ * - if the exchange fails every file is returned
+ */
+std::vector<std::string> MsgClient::changedFiles(const std::vector<std::string>& files)
+{
+  if (!connect() || !sync_)
+    return files;
+  HttpMessage::Manifest manifest;
+  for (auto& file : files)
+    manifest.push_back(HttpMessage::ManifestEntry(file, PublishManifest::contentHash(localDir_ + file)));
+  std::string body = HttpMessage::manifestBody(manifest);
+  HttpMessage msg;
+  msg.addAttribute(HttpMessage::attribute("SYNC", "manifest"));
+  msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+  addBranch(msg);
+  msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  msg.addBody(body);
+  if (!sendMessage(msg, connection_.socket(), binary_))
+    return files;
+  HttpMessage reply = readReply(connection_.socket(), binary_);
+  if (reply.findValue("SYNC") != "needed")
+    return files;
+  std::vector<std::string> needed;
+  for (auto& entry : HttpMessage::parseManifest(reply.bodyString()))
+    needed.push_back(entry.first);
+  return needed;
+}
+//----< upload files over streams connections, largest files first >---
+/*
+ * - each stream takes the next largest file when it finishes one, so
+ *   no stream is left sending a big file after the others are done
+ * - stream 0 is the long lived connection, the others are opened for
+ *   this upload and closed with a quit message when it's done
+ * - files the server already holds, by content hash, are skipped
+ * - if the server grants credit each stream keeps its own, and reads
+ *   the grants still owed before the stream is used for anything else
+ */
+bool MsgClient::upload(const std::vector<std::string>& files, size_t streams)
+{
+  if (!connect())
+    return false;
+  std::vector<std::string> changed = changedFiles(files);
+  if (sync_)
+    Show::write("\n\n  sync: " + Converter<size_t>::toString(changed.size()) + " of " +
+      Converter<size_t>::toString(files.size()) + " files are new or changed");
+  using SizedFile = std::pair<size_t, std::string>;
+  std::vector<SizedFile> bySize;
+  size_t totalBytes = 0;
+  for (auto& file : changed)
+  {
+    FileSystem::FileInfo fi(localDir_ + file);
+    bySize.push_back(SizedFile(fi.good() ? fi.size() : 0, file));
+    totalBytes += bySize.back().first;
+  }
+  std::sort(bySize.begin(), bySize.end(), [](const SizedFile& a, const SizedFile& b) { return a.first > b.first; });
+  streams = (std::max)((size_t)1, (std::min)(streams, bySize.size()));
+
+  std::atomic<size_t> next(0);
+  std::atomic<bool> ok(true);
+  auto sendFiles = [&](Socket& socket, bool binary) {
+    Credit credit;
+    credit.available = creditWindow_;
+    Credit* pCredit = (creditSegment_ > 0) ? &credit : nullptr;
+    for (size_t i = next++; i < bySize.size(); i = next++)
+    {
+      Show::write("\n\n  sending file " + bySize[i].second);
+      if (!sendFile(bySize[i].second, socket, binary, pCredit))
+      {
+        Show::write("\n  failed to send file " + bySize[i].second);
+        ok = false;
+      }
+    }
+    if (pCredit != nullptr && !drainGrants(socket, binary, credit))
+      ok = false;
+  };
+  std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+  std::vector<std::thread> threads;
+  for (size_t s = 1; s < streams; ++s)
+  {
+    threads.push_back(std::thread([&]() {
+      ClientConnection extra(connection_.host(), connection_.port());
+      if (!extra.open())
+        return;     // other streams take its files
+      sendFiles(extra.socket(), false);   // extra streams don't negotiate, so use text
+      HttpMessage msg = makeMessage(1, "quit", "toAddr:localhost:8080");
+      sendMessage(msg, extra.socket());
+      extra.drop();
+    }));
+  }
+  sendFiles(connection_.socket(), binary_);
+  for (auto& thread : threads)
+    thread.join();
+  double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+  double kbPerSec = (seconds > 0) ? totalBytes / 1024.0 / seconds : 0;
+  Show::write(
+    "\n\n  uploaded " + Converter<size_t>::toString(bySize.size()) + " files, " +
+    Converter<size_t>::toString(totalBytes) + " bytes over " + Converter<size_t>::toString(streams) +
+    " streams in " + Converter<double>::toString(seconds) + " sec, " + Converter<double>::toString(kbPerSec) + " KB/sec"
+  );
+  return ok;
+}
 //----< this defines the behavior of the client >--------------------
+/*
+ * - POSTs are pipelined: the server doesn't answer them, so each file
+ *   is written as soon as the last one has been handed to the socket
+ * - files go over streams_ connections, see upload
+ * - the connection stays open for download and later calls
+ */
 
 void MsgClient::execute(const size_t TimeBetweenMessages, const size_t NumMessages){
   ClientCounter counter;size_t myCount = counter.count();
@@ -107,22 +566,20 @@ void MsgClient::execute(const size_t TimeBetweenMessages, const size_t NumMessag
     "Starting HttpMessage client" + myCountString + 
     " on thread " + Utilities::Converter<std::thread::id>::toString(std::this_thread::get_id()));
   try{
-    SocketSystem ss;SocketConnecter si;
-    while (!si.connect("localhost", 8080)){
-      Show::write("\n client waiting to connect");
-      ::Sleep(100);
+    if (!connect()){
+      Show::write("\n client could not connect to server");
+      return;
     }
-    HttpMessage msg;
-    std::vector<std::string> files = FileSystem::Directory::getFiles("../TestFiles/", "*.*");
-    for (size_t i = 0; i < files.size(); ++i){
-      Show::write("\n\n  sending file " + files[i]);
-      sendFile(files[i], si);
+    for (size_t i = 0; i < NumMessages; ++i)
+    {
+      if (i > 0)
+        std::this_thread::sleep_for(std::chrono::milliseconds(TimeBetweenMessages));
+      post("message #" + Utilities::Converter<size_t>::toString(i + 1) + " from client" + myCountString);
     }
-    msg = makeMessage(1, "quit", "toAddr:localhost:8080");
-    sendMessage(msg, si);
-    Show::write("\n\n  client" + myCountString + " sent\n" + msg.toIndentedString());
+    std::vector<std::string> files = FileSystem::Directory::getFiles(localDir_, "*.*");
+    upload(files, streams_);
     Show::write("\n");
-    Show::write("\n  All done ");
+    Show::write("\n  client" + myCountString + " sent " + Utilities::Converter<size_t>::toString(files.size()) + " files");
   }
   catch (std::exception& exc){
     Show::write("\n  Exeception caught: ");
@@ -134,22 +591,27 @@ void MsgClient::execute(const size_t TimeBetweenMessages, const size_t NumMessag
 
 class ClientHandlerReceivingFromServer {
 public:
-	ClientHandlerReceivingFromServer(BlockingQueue<HttpMessage>& msgQ) : msgQ_(msgQ) {}
+	ClientHandlerReceivingFromServer(BlockingQueue<HttpMessage>& msgQ, bool binary = false, const std::string& localDir = "../TestFiles/")
+		: msgQ_(msgQ), binary_(binary), localDir_(localDir) {}
 	void operator()(Socket socket);
+	bool receive(Socket& socket);
 private:
 	bool connectionClosed_;
 	HttpMessage readMessage(Socket& socket);
-	bool readFile(const std::string& filename, size_t fileSize, Socket& socket);
+	bool readFile(const std::string& filename, size_t fileSize, Socket& socket, const std::string& encoding);
+	bool readPatch(const std::string& filename, size_t patchSize, Socket& socket, const std::string& encoding, const std::string& etag);
 	BlockingQueue<HttpMessage>& msgQ_;
+	bool binary_;               // connection negotiated binary framing
+	std::string localDir_;      // files are received into it
 };
 HttpMessage ClientHandlerReceivingFromServer::readMessage(Socket& socket){
 	connectionClosed_ = false;HttpMessage msg;
-	while (true){
+	if (binary_ && !msg.recvBinaryHeader(socket))
+		msg.clear();
+	while (!binary_){
 		std::string attribString = socket.recvString('\n');
-		if (attribString.size() > 1){
-			HttpMessage::Attribute attrib = HttpMessage::parseAttribute(attribString);
-			msg.addAttribute(attrib);
-		}
+		if (attribString.size() > 1)
+			msg.addAttribute(HttpMessage::parseAttribute(attribString));
 		else{break;}
 	}
 	if (msg.attributes().size() == 0){
@@ -164,7 +626,10 @@ HttpMessage ClientHandlerReceivingFromServer::readMessage(Socket& socket){
 				contentSize = Converter<size_t>::toValue(sizeString);
 			else
 				return msg;
-			readFile(filename, contentSize, socket);
+			if (msg.findValue("patch") != "")
+				readPatch(filename, contentSize, socket, msg.findValue("content-encoding"), msg.findValue("etag"));
+			else
+				readFile(filename, contentSize, socket, msg.findValue("content-encoding"));
 		}
 		if (filename != ""){
 			msg.removeAttribute("content-length");
@@ -177,88 +642,431 @@ HttpMessage ClientHandlerReceivingFromServer::readMessage(Socket& socket){
 			size_t numBytes = 0;size_t pos = msg.findAttribute("content-length");
 			if (pos < msg.attributes().size()){
 				numBytes = Converter<size_t>::toValue(msg.attributes()[pos].second);
-				Socket::byte* buffer = new Socket::byte[numBytes + 1];
-				socket.recv(numBytes, buffer);
-				buffer[numBytes] = '\0';
-				std::string msgBody(buffer);
-				msg.addBody(msgBody);
-				delete[] buffer;}
+				HttpMessage::Body& body = msg.body();
+				body.resize(numBytes);
+				if (numBytes > 0 && !socket.recv(numBytes, &body[0]))
+					body.clear();}
 		}
 	}
 	return msg;
 }
 
-bool ClientHandlerReceivingFromServer::readFile(const std::string& filename, size_t fileSize, Socket& socket)
+bool ClientHandlerReceivingFromServer::readFile(const std::string& filename, size_t fileSize, Socket& socket, const std::string& encoding)
 {
-	std::string fqname = "../TestFiles/" + filename;
-	FileSystem::File file(fqname);
-	file.open(FileSystem::File::out, FileSystem::File::binary);
-	if (!file.isGood()){
-		Show::write("\n\n  can't open file " + fqname);
+	std::string fqname = localDir_ + filename;
+	size_t dirEnd = filename.find_last_of('/');
+	if (dirEnd != std::string::npos && !FileSystem::Directory::exists(localDir_ + filename.substr(0, dirEnd)))
+		FileSystem::Directory::create(localDir_ + filename.substr(0, dirEnd));
+	if (encoding == Compression::Name)
+		return socket.recvFileCompressed(fqname, fileSize);
+	return socket.recvFile(fqname, fileSize);
+}
+
+//----< read a patch to the local copy of filename and apply it >---
+/*
+ * - the patched page must hash to etag, the server's hash of its page,
+ *   otherwise, or if there's no copy to patch, the copy is removed, so
+ *   the next download, holding no copy, gets the whole page
+ */
+bool ClientHandlerReceivingFromServer::readPatch(const std::string& filename, size_t patchSize, Socket& socket,
+	const std::string& encoding, const std::string& etag)
+{
+	std::string patch(patchSize, '\0');
+	bool received = (patchSize == 0) ||
+		((encoding == Compression::Name) ? socket.recvCompressed(patchSize, &patch[0]) : socket.recv(patchSize, &patch[0]));
+	if (!received)
+		return false;
+	std::string fqname = localDir_ + filename;
+	std::ifstream in(fqname, std::ios::binary);
+	std::string held((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	bool found = in.is_open();
+	in.close();
+	std::string page;
+	if (!found || !PageDiff::apply(held, patch, page) || PublishManifest::textHash(page) != etag){
+		Show::write("\n  patch to " + filename + " doesn't fit the copy held, it's removed");
+		FileSystem::File::remove(fqname);
 		return false;
 	}
+	std::ofstream out(fqname, std::ios::binary | std::ios::trunc);
+	out.write(page.data(), page.size());
+	return out.good();
+}
 
-	const size_t BlockSize = 2048;
-	Socket::byte buffer[BlockSize];
-
-	size_t bytesToRead;
+void ClientHandlerReceivingFromServer::operator()(Socket socket){
+	receive(socket);
+	Show::write("\n\n  clienthandler thread is terminating");
+}
+//----< read messages and files until quit, false if connection closed >---
+bool ClientHandlerReceivingFromServer::receive(Socket& socket){
 	while (true){
-		if (fileSize > BlockSize)
-			bytesToRead = BlockSize;
-		else
-			bytesToRead = fileSize;
-
-		socket.recv(bytesToRead, buffer);
+		HttpMessage msg = readMessage(socket);
+		if (connectionClosed_)
+			return false;
+		if (msg.bodyString() == "quit")
+			return true;
+		msgQ_.enQ(std::move(msg));
+	}
+}
+//----< ask for published files, read them on the same connection >---
+/*
+ * - the server answers GET with the published html files and shared
+ *   assets, then a quit message, so the connection stays usable
+ * - the pages and assets already in the local directory, ../TestFiles/
+ *   unless setLocalDir chose another, are listed with their
+ *   content hash, the server skips those it holds with the same etag
+ * - with accept-patch: lines, pages held with an older etag may come as
+ *   line patches, applied to the copies held, see readPatch
+ */
+bool MsgClient::download(BlockingQueue<HttpMessage>& msgQ){
+	if (!connect())
+		return false;
+	openStore();
+	HttpMessage::Manifest held = store_.manifest();
+	std::string body = HttpMessage::manifestBody(held);
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("GET", "published"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	msg.addAttribute(HttpMessage::Attribute("accept-encoding", Compression::Name));
+	msg.addAttribute(HttpMessage::Attribute("accept-patch", "lines"));
+	if (held.size() > 0){
+		msg.addAttribute(HttpMessage::Attribute("if-none-match", "manifest"));
+		msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+		msg.addBody(body);
+	}
+	if (!sendMessage(msg, connection_.socket(), binary_)){
+		connection_.drop();
+		return false;
+	}
+	ClientHandlerReceivingFromServer handler(msgQ, binary_, localDir_);
+	bool ok = handler.receive(connection_.socket());
+	if (!ok)
+		connection_.drop();
+	store_.scan();   // hashes the pages just received, once
+	store_.save();
+	return ok;
+}
+//----< read the page store's index once, then update it from the directory >---
 
-		FileSystem::Block blk;
-		for (size_t i = 0; i < bytesToRead; ++i)
-			blk.push_back(buffer[i]);
+void MsgClient::openStore(){
+	if (!storeLoaded_){
+		store_.load();
+		storeLoaded_ = true;
+	}
+	store_.scan();
+}
+//----< the server's published pages and assets, each with its etag >---
 
-		file.putBlock(blk);
-		if (fileSize < BlockSize)
-			break;
-		fileSize -= BlockSize;
+bool MsgClient::pageManifest(HttpMessage::Manifest& published){
+	published.clear();
+	if (!connect())
+		return false;
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("MANIFEST", "pages"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	if (!sendMessage(msg, connection_.socket(), binary_)){
+		connection_.drop();
+		return false;
 	}
-	file.close();
+	HttpMessage reply = readReply(connection_.socket(), binary_);
+	if (reply.attributes().size() == 0){
+		connection_.drop();
+		return false;
+	}
+	if (reply.findValue("MANIFEST") != "pages")
+		return false;
+	published = HttpMessage::parseManifest(reply.bodyString());
 	return true;
 }
-
-void ClientHandlerReceivingFromServer::operator()(Socket socket){
+//----< compare the local cache with the server's manifest >---------
+/*
+ * - pages the server no longer publishes are removed from the cache
+ * - stale gets the pages the cache lacks or holds with another hash,
+ *   the caller fetches those it shows, e.g., with cachePages
+ * - one manifest exchange, held pages are checked by stamp, not read
+ */
+bool MsgClient::syncCache(std::vector<std::string>& stale){
+	stale.clear();
+	openStore();
+	HttpMessage::Manifest published;
+	if (!pageManifest(published))
+		return false;
+	for (auto& page : store_.removedFrom(published))
+		store_.remove(page);
+	stale = store_.stale(published);
+	store_.save();
+	return true;
+}
+//----< fetch pages into the local cache, unless the copy held is current >---
+/*
+ * - each FETCH carries the held page's hash as if-none-match, so only
+ *   changed pages are sent; fetched counts the pages written
+ * - the index is saved once, after every page
+ */
+bool MsgClient::cachePages(const std::vector<std::string>& pages, size_t& fetched){
+	fetched = 0;
+	openStore();
+	bool ok = true;
+	for (auto& page : pages){
+		std::string bytes;
+		bool sent = false;
+		auto onChunk = [&](size_t, const std::string& chunk, size_t total) {
+			if (!sent)
+				bytes.reserve(total);
+			sent = true;
+			bytes += chunk;
+		};
+		if (!fetch(page, "", onChunk, 0, store_.hash(page))){
+			ok = false;
+			continue;
+		}
+		if (sent && store_.put(page, bytes, ""))
+			++fetched;
+	}
+	return store_.save() && ok;
+}
+//----< ask for a range of one published file, read it chunk by chunk >---
+/*
+ * - range is "" for the whole file, "bytes=first-last" or "lines=first-last",
+ *   lines count from 1 and without last the range runs to the end
+ * - onChunk(offset, bytes, total) is called as each chunk arrives, total
+ *   is the file's size in bytes
+ * - chunkSize 0 leaves the chunk size to the server
+ * - ifNoneMatch, if given, is the etag of the copy the caller holds,
+ *   e.g., its PublishManifest::contentHash; if the whole page is asked
+ *   for and it hasn't changed, onChunk isn't called and fetch is true
+ * - false if the server doesn't have the file or the connection fails
+ */
+bool MsgClient::fetch(const std::string& file, const std::string& range, const ChunkHandler& onChunk, size_t chunkSize,
+	const std::string& ifNoneMatch){
+	if (!connect())
+		return false;
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("FETCH", "page"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	msg.addAttribute(HttpMessage::Attribute("file", file));
+	if (range != "")
+		msg.addAttribute(HttpMessage::Attribute("range", range));
+	if (chunkSize > 0)
+		msg.addAttribute(HttpMessage::Attribute("chunk-size", Converter<size_t>::toString(chunkSize)));
+	if (ifNoneMatch != "")
+		msg.addAttribute(HttpMessage::Attribute("if-none-match", ifNoneMatch));
+	if (!sendMessage(msg, connection_.socket(), binary_)){
+		connection_.drop();
+		return false;
+	}
 	while (true){
-		HttpMessage msg = readMessage(socket);
-		if (connectionClosed_ || msg.bodyString() == "quit"){
-			Show::write("\n\n  clienthandler thread is terminating");
-			break;
+		HttpMessage reply = readReply(connection_.socket(), binary_);
+		if (reply.attributes().size() == 0){
+			connection_.drop();
+			return false;
 		}
-		msgQ_.enQ(msg);
+		if (reply.findValue("FETCH") == "not-modified")
+			return true;
+		if (reply.findValue("FETCH") != "chunk")
+			return false;
+		std::string unit;
+		size_t first = 0, count = 0, total = 0;
+		HttpMessage::parseContentRange(reply.findValue("content-range"), unit, first, count, total);
+		onChunk(first, reply.bodyString(), total);
+		if (reply.findValue("final") != "no")
+			return true;
+	}
+}
+//----< ask the server's search index for lines and symbols matching query >---
+/*
+ * - query is a substring, or with regex an ECMAScript regex, carried as
+ *   the message body so it may hold any character but a line end
+ * - limit 0 leaves the number of hits to the server
+ * - false if the regex doesn't compile or the connection fails
+ */
+bool MsgClient::search(const std::string& query, std::vector<SearchHit>& hits, bool regex, bool ignoreCase, size_t limit){
+	hits.clear();
+	if (!connect())
+		return false;
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("SEARCH", regex ? "regex" : "text"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	if (ignoreCase)
+		msg.addAttribute(HttpMessage::Attribute("ignore-case", "yes"));
+	if (limit > 0)
+		msg.addAttribute(HttpMessage::Attribute("limit", Converter<size_t>::toString(limit)));
+	msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(query.size())));
+	msg.addBody(query);
+	if (!sendMessage(msg, connection_.socket(), binary_)){
+		connection_.drop();
+		return false;
+	}
+	HttpMessage reply = readReply(connection_.socket(), binary_);
+	if (reply.attributes().size() == 0){
+		connection_.drop();
+		return false;
+	}
+	if (reply.findValue("SEARCH") != "results")
+		return false;
+	std::istringstream body(reply.bodyString());
+	std::string line;
+	while (std::getline(body, line)){
+		size_t first = line.find('\t');
+		size_t second = (first == std::string::npos) ? first : line.find('\t', first + 1);
+		size_t third = (second == std::string::npos) ? second : line.find('\t', second + 1);
+		if (third == std::string::npos)
+			continue;
+		SearchHit hit;
+		hit.file = line.substr(0, first);
+		hit.line = Converter<size_t>::toValue(line.substr(first + 1, second - first - 1));
+		hit.symbol = line.substr(second + 1, third - second - 1);
+		hit.text = line.substr(third + 1);
+		hits.push_back(hit);
 	}
+	return true;
+}
+//----< ask the server for the dependency elements reached from files >---
+/*
+ * - files are named as pages are, e.g., Parser/Parser.cpp, and items get
+ *   them first, then the files within depth links, nearest first, 0 for
+ *   no limit; with dependents the links are followed backwards
+ * - each item is a file and its element, children the files it depends on
+ * - false if the server can't answer, or its reply doesn't decode
+ */
+bool MsgClient::queryDependencies(const std::vector<std::string>& files, Dependencies& items, size_t depth,
+	bool dependents, bool* pTruncated){
+	items.clear();
+	if (!connect())
+		return false;
+	std::string body;
+	for (auto& file : files)
+		body += file + "\n";
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("QUERY", dependents ? "dependents" : "dependencies"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	msg.addAttribute(HttpMessage::Attribute("depth", Converter<size_t>::toString(depth)));
+	msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+	msg.addBody(body);
+	if (!sendMessage(msg, connection_.socket(), binary_)){
+		connection_.drop();
+		return false;
+	}
+	HttpMessage reply = readReply(connection_.socket(), binary_);
+	if (reply.attributes().size() == 0){
+		connection_.drop();
+		return false;
+	}
+	if (reply.findValue("QUERY") != "elements")
+		return false;
+	if (pTruncated != nullptr)
+		*pTruncated = (reply.findValue("truncated") == "yes");
+	return ElementCodec<std::string>::decode(reply.bodyString(), items);
+}
+//----< notices of pages the server publishes, from now on >---------
+/*
+ * - prefixes limit notices to pages whose names start with one of them,
+ *   none gets every page
+ * - the subscription has its own connection, which the server only
+ *   pushes on, and a thread that calls onNotice for each NOTIFY, so
+ *   onNotice mustn't use this client's other calls, nor wait long
+ * - false if the server didn't answer the SUBSCRIBE
+ */
+bool MsgClient::subscribe(const std::vector<std::string>& prefixes, const NoticeHandler& onNotice){
+	unsubscribe();
+	std::unique_ptr<ClientConnection> connection(new ClientConnection(connection_.host(), connection_.port()));
+	if (!connection->open())
+		return false;
+	std::string body;
+	for (auto& prefix : prefixes)
+		body += prefix + "\n";
+	HttpMessage msg;
+	msg.addAttribute(HttpMessage::attribute("SUBSCRIBE", "pages"));
+	msg.addAttribute(HttpMessage::parseAttribute("toAddr:localhost:8080"));
+	msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+	msg.addBody(body);
+	Socket& socket = connection->socket();
+	if (!sendMessage(msg, socket) || readReply(socket).findValue("SUBSCRIBE") != "ok")
+		return false;
+	subscription_ = std::move(connection);
+	notices_ = std::thread([this, &socket, onNotice] { readNotices(socket, onNotice); });
+	return true;
 }
-//----< entry point - runs two clients each on its own thread >------
+//----< hand each NOTIFY to onNotice until the connection closes >---
 
+void MsgClient::readNotices(Socket& socket, const NoticeHandler& onNotice){
+	while (true){
+		HttpMessage msg = readReply(socket);
+		if (msg.attributes().size() == 0)
+			return;
+		Notice notice;
+		notice.event = msg.findValue("NOTIFY");
+		if (notice.event == "")
+			continue;
+		notice.file = msg.findValue("file");
+		notice.etag = msg.findValue("etag");
+		std::string pages = msg.findValue("pages");
+		if (pages != "")
+			notice.pages = Converter<size_t>::toValue(pages);
+		onNotice(notice);
+	}
+}
+//----< close the subscription, waits for the notice thread >--------
+
+void MsgClient::unsubscribe(){
+	if (!subscription_)
+		return;
+	subscription_->drop();
+	if (notices_.joinable())
+		notices_.join();
+	subscription_.reset();
+}
+//----< tell server we're done, then close connection >--------------
+void MsgClient::close(){
+	unsubscribe();
+	if (!connection_.isOpen())
+		return;
+	HttpMessage msg = makeMessage(1, "quit", "toAddr:localhost:8080");
+	sendMessage(msg, connection_.socket(), binary_);
+	Show::write("\n\n  client sent\n" + msg.toIndentedString());
+	connection_.drop();
+	Show::write("\n  All done ");
+}
+//----< entry point - uploads files, then downloads published files >---
+#ifndef COMM_CHANNEL
 int main(){
+  BlockingQueue<HttpMessage> msgQ;
   MsgClient c1;
+  c1.setStreams(4);
   std::thread t1(
-    [&]() { c1.execute(100, 1); } 
+    [&]() {
+      c1.subscribe({}, [](const MsgClient::Notice& notice) {
+        std::cout << "\n\n  notice: " << notice.event << " " << notice.file;
+      });
+      c1.execute(100, 1);
+      c1.download(msgQ);
+      std::vector<std::string> pages = FileSystem::Directory::getFiles("../TestFiles/", "*.html");
+      auto show = [&](size_t offset, const std::string& bytes, size_t total) {
+        std::cout << "\n\n  fetched bytes " << offset << " to " << offset + bytes.size() << " of " << total << " of " << pages[0];
+      };
+      if (pages.size() > 0){
+        c1.fetch(pages[0], "lines=1-50", show);
+        if (c1.fetch(pages[0], "", show, 0, PublishManifest::contentHash("../TestFiles/" + pages[0])))
+          std::cout << "\n\n  fetched " << pages[0] << ", unchanged pages aren't sent again";
+      }
+      std::vector<MsgClient::SearchHit> hits;
+      if (c1.search("class \\w+Reader", hits, true))
+        for (auto& hit : hits)
+          std::cout << "\n\n  found " << hit.file << ":" << hit.line << " " << hit.text;
+      MsgClient::Dependencies deps;
+      if (c1.queryDependencies({ "MsgClient/MsgClient.cpp" }, deps, 2))
+        for (auto& item : deps)
+          std::cout << "\n\n  " << item.first << " depends on " << item.second.children.ref().size() << " files";
+      c1.close();
+    }
   );
 
   t1.join();
 
-  BlockingQueue<HttpMessage> msgQ;
-  try{
-	  SocketSystem ss;
-	  SocketListener sl(8085, Socket::IP6);
-	  ClientHandlerReceivingFromServer cp(msgQ);
-	  sl.start(cp);
-	  while (true){
-		  HttpMessage msg = msgQ.deQ();
-		  std::cout << "\n\n  client acting as server recvd message contents:\n" + msg.bodyString();
-	  }
-  }
-  catch (std::exception& exc){
-	  std::cout << "\n Exception caught";
-	  std::string exMsg = "\n  " + std::string(exc.what()) + "\n\n";
-	  std::cout << exMsg;
+  while (msgQ.size() > 0){
+	  HttpMessage msg = msgQ.deQ();
+	  std::cout << "\n\n  client recvd message contents:\n" + msg.bodyString();
   }
 }
+#endif
 
 //No Stub since it is an exe
\ No newline at end of file
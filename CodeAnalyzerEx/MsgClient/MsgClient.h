@@ -12,14 +12,70 @@
 * This package implements a client that sends HTTP style messages and
 * files to a server so that server could publish those files
 *
-* It's also Listens on port 8085 and acts as a server to help two way
-* HTTP style messages and files
+* Uploads and downloads share one long lived connection to the server,
+* managed by ClientConnection:
+* - it connects once, retrying with a growing delay, and later calls reuse it
+* - file POSTs are pipelined, each is written without waiting for the server
+* - upload can spread a file set over several connections, largest files
+*   first, and reports aggregate throughput
+* - after connecting, an OPTIONS message asks which content encodings the
+*   server accepts; if it accepts lz77, files are sent compressed
+* - if the server also accepts SYNC, upload first sends a manifest of content
+*   hashes and only sends the files the server says are missing or changed
+* - OPTIONS also asks for binary framing; if the server agrees, later messages on
+*   the long lived connection use length prefixed binary headers, not text lines
+* - download asks for the published files with a GET message and reads them
+*   back on the same connection, so no reverse connection is needed
+* - fetch asks for one published file, or a byte or line range of it, with a
+*   FETCH message and hands each chunk to the caller as it arrives, so a viewer
+*   shows the first screen of a large page before the rest is downloaded
+* - download sends the content hash of each page it already holds, and fetch may
+*   send one as if-none-match, so the server sends only pages that changed
+* - download accepts line patches: a page held with an older etag may come as
+*   a PageDiff patch to the copy held, applied and checked against its etag
+* - if the OPTIONS reply grants credit, files are sent in segments, never more
+*   than credit-window bytes ahead of the server's CREDIT grants, so a client
+*   pauses while the server's disk is behind
+* - if the server also accepts resume, files go as chunks it keeps across
+*   connections, and only the chunks it doesn't hold are sent again
+* - search sends a SEARCH message, a substring or a regex, and returns the lines
+*   and symbols the server's search index finds, without downloading any file
+* - queryDependencies sends a QUERY message naming files and returns the
+*   dependency elements the server reaches from them, a subgraph of thousands
+*   of files in one ElementCodec encoded reply
+* - pages downloaded or fetched into the local directory are kept by a PageStore,
+*   whose index of content hashes and file stamps persists across sessions, so
+*   held pages are stat'ed, not hashed again; syncCache asks for the server's
+*   MANIFEST of page etags and returns the stale pages, which cachePages fetches
+* - subscribe opens a connection of its own and sends a SUBSCRIBE message with
+*   path prefixes; a thread then hands each NOTIFY the server pushes, a page
+*   changed or removed, with its etag, to the caller, who fetches what it shows
 *
 *
 * Public Interface
 * --------------------
 * using EndPoint = std::string;                                              //variable to act as end pont
-* void execute(const size_t TimeBetweenMessages, const size_t NumMessages);  //function used to send required files to destination
+* void execute(const size_t TimeBetweenMessages, const size_t NumMessages);  //send NumMessages messages, TimeBetweenMessages ms apart, then upload files
+* bool download(BlockingQueue<HttpMessage>& msgQ);                           //get published files on the same connection
+* bool fetch(file, range, onChunk, chunkSize, etag)                           //get a range of one file, chunk by chunk
+* bool search(query, hits, regex, ignoreCase, limit)                          //lines and symbols matching query on the server
+* bool queryDependencies(files, items, depth, dependents, &truncated)         //elements within depth links of files on the server
+* bool upload(files, streams)                                                 //send files over streams connections in parallel
+* bool post(body, ack)                                                       //send one message, with ack wait for the server's ACK
+* bool postFile(file, ack)                                                   //send one file as is, with ack wait until it's stored
+* bool syncCache(stale)                                                       //pages the local cache lacks or holds stale
+* bool cachePages(pages, fetched)                                             //fetch pages not current into the local cache
+* size_t cachedPages()                                                       //pages the local cache holds
+* bool subscribe(prefixes, onNotice)                                          //onNotice(notice) for each page the server publishes
+* void unsubscribe()                                                         //close the subscription, no notices after it returns
+* void setStreams(size_t streams)                                            //connections used by execute, default 1
+* void setBranch(branch)                                                     //server records uploads under branch's manifest
+* void setLocalDir(dir)                                                      //upload from and download into dir, default ../TestFiles/
+* std::vector<std::string> changedFiles(files)                               //files the server doesn't have, by content hash
+* void close();                                                              //tell server we're done and close connection
+* MsgClient(host, port)                                                      //client of the server at host:port, default localhost:8080
+* ClientConnection(host, port)                                               //manages one connection to host:port
+* bool open(size_t timeoutMs)                                                //connect or reuse, false on timeout
 * ClientCounter()                                                            //function to compute number of clients 
 * size_t count()                                                             //returns a count of clients
 *
@@ -27,6 +83,9 @@
 * ---------------
 *   -MsgClient.cpp, MsgServer.cpp
 *   HttpMessage.h, HttpMessage.cpp
+*   PublishManifest.h, PublishManifest.cpp
+*   PageStore.h, PageStore.cpp, PageDiff.h, PageDiff.cpp
+*   ElementCodec.h, NoSqlDb.h
 *   Cpp11-BlockingQueue.h
 *   Sockets.h, Sockets.cpp
 *   FileSystem.h, FileSystem.cpp
@@ -39,6 +98,53 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.16 : 14 Oct 2026
+* - added queryDependencies, dependency subgraphs decoded from a binary QUERY reply
+* Ver 1.15 : 14 Oct 2026
+* - download asks for line patches of pages held, and applies them to the held copies
+* Ver 1.14 : 14 Oct 2026
+* - added syncCache and cachePages, a persistent PageStore of pages by content hash,
+*   validated against the server's MANIFEST; download sends the store's hashes
+* Ver 1.13 : 14 Oct 2026
+* - added subscribe and unsubscribe, notices of pages published, on a connection of their own
+* Ver 1.12 : 14 Oct 2026
+* - sendMessage sends header and body with one vectored send instead of joining them
+* Ver 1.11 : 14 Oct 2026
+* - added post and postFile, with ack they wait for the server's ACK, for LoadGenerator
+* - execute sends NumMessages messages, TimeBetweenMessages ms apart, before uploading
+* Ver 1.10 : 14 Oct 2026
+* - added setLocalDir, the directory files are uploaded from and pages are
+*   downloaded into, still ../TestFiles/ unless it's set, for Benchmark
+* Ver 1.9 : 14 Oct 2026
+* - added search, substring and regex searches answered from the server's index
+* Ver 1.8 : 14 Oct 2026
+* - added setBranch, uploads and SYNC manifests name the branch they belong to
+* Ver 1.7 : 14 Oct 2026
+* - uploads resume: chunks the server kept from a broken off upload, by chunk
+*   hash, aren't sent again, and chunks a COMMIT reports missing are retried
+* Ver 1.6 : 14 Oct 2026
+* - uploads use credit flow control when the server offers it: each stream
+*   sends segments within its credit and reads the server's grants
+* Ver 1.5 : 14 Oct 2026
+* - added MsgClient(host, port), and main is left out when built with
+*   COMM_CHANNEL, so CommChannel can use the client from the GUI's Shim
+* Ver 1.4 : 14 Oct 2026
+* - download and fetch send the etags of pages held in ../TestFiles, so pages
+*   the server hasn't republished aren't sent again
+* Ver 1.3 : 14 Oct 2026
+* - parsed attributes are moved into messages, bodies received in place
+* Ver 1.2 : 14 Oct 2026
+* - added fetch, on demand download of a page or a byte or line range of it
+* Ver 1.1 : 14 Oct 2026
+* - files received into a subdirectory, such as shared assets/, create it first
+* - received messages are moved into the message queue instead of copied
+* - added ClientConnection, uploads are pipelined and published files are
+*   downloaded on the same connection instead of a listener on port 8085
+* - added parallel upload over several connections, largest files first
+* - negotiates lz77 compression of file bodies with OPTIONS and accept-encoding
+* - uploads only files whose content hash the server doesn't have, found with
+*   a SYNC manifest exchange
+* - negotiates binary message framing with OPTIONS accept-framing
 * Ver 1.0 : 2nd May 2017
 * - first release
 *
@@ -51,6 +157,13 @@
 #include "../FileSystem/FileSystem.h"
 #include "../Logger/Logger.h"
 #include "../Utilities/Utilities.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include "PageStore.h"
+#include "../HelpSession/NoSqlDb/ElementCodec.h"
+#include <functional>
+#include <fstream>
+#include <memory>
+#include <thread>
 
 class ClientCounter
 {
@@ -61,14 +174,105 @@ private:
 	static size_t clientCount;
 };
 
+class ClientConnection
+{
+public:
+	ClientConnection(const std::string& host, size_t port) : host_(host), port_(port) {}
+	bool open(size_t timeoutMs = 30000);
+	bool isOpen() { return open_; }
+	Socket& socket() { return socket_; }
+	const std::string& host() { return host_; }
+	size_t port() { return port_; }
+	void drop();
+private:
+	std::string host_;
+	size_t port_;
+	SocketSystem ss_;           // must outlive socket_
+	SocketConnecter socket_;
+	bool open_ = false;
+};
+
 class MsgClient
 {
 public:
 	using EndPoint = std::string;
+	MsgClient(const std::string& host = "localhost", size_t port = 8080) : connection_(host, port) {}
+	~MsgClient() { unsubscribe(); }
 	void execute(const size_t TimeBetweenMessages, const size_t NumMessages);
+	using ChunkHandler = std::function<void(size_t offset, const std::string& bytes, size_t total)>;
+	bool download(Async::BlockingQueue<HttpMessage>& msgQ);
+	bool fetch(const std::string& file, const std::string& range, const ChunkHandler& onChunk, size_t chunkSize = 0,
+		const std::string& ifNoneMatch = "");
+	struct SearchHit
+	{
+		std::string file;     // as pages are named, e.g., Parser/Parser.cpp
+		size_t line = 0;      // counts from 1, 0 for a type known only by its file
+		std::string symbol;   // name of a matching symbol, "" for a line of text
+		std::string text;     // the matching line, or the symbol's kind
+	};
+	bool search(const std::string& query, std::vector<SearchHit>& hits, bool regex = false, bool ignoreCase = false,
+		size_t limit = 0);
+	using Dependencies = ElementCodec<std::string>::Items;
+	bool queryDependencies(const std::vector<std::string>& files, Dependencies& items, size_t depth = 1,
+		bool dependents = false, bool* pTruncated = nullptr);
+	bool upload(const std::vector<std::string>& files, size_t streams);
+	bool post(const std::string& body, bool ack = false);
+	bool postFile(const std::string& file, bool ack = false);
+	struct Notice
+	{
+		std::string event;    // changed, removed, or published, a batch is done
+		std::string file;     // page, named as fetch takes it, "" if published
+		std::string etag;     // content hash of a changed page
+		size_t pages = 0;     // pages in the repository, if published
+	};
+	using NoticeHandler = std::function<void(const Notice& notice)>;
+	bool subscribe(const std::vector<std::string>& prefixes, const NoticeHandler& onNotice);
+	void unsubscribe();
+	void setStreams(size_t streams) { streams_ = streams; }
+	void setBranch(const std::string& branch) { branch_ = branch; }
+	void setLocalDir(const std::string& dir) { localDir_ = dir; store_ = PageStore(dir); storeLoaded_ = false; }
+	bool syncCache(std::vector<std::string>& stale);
+	bool cachePages(const std::vector<std::string>& pages, size_t& fetched);
+	size_t cachedPages() const { return store_.size(); }
+	std::vector<std::string> changedFiles(const std::vector<std::string>& files);
+	void close();
 private:
 	HttpMessage makeMessage(size_t n, const std::string& msgBody, const EndPoint& ep);
-	void sendMessage(HttpMessage& msg, Socket& socket);
-	bool sendFile(const std::string& fqname, Socket& socket);
+	bool sendMessage(HttpMessage& msg, Socket& socket, bool binary = false);
+	void addBranch(HttpMessage& msg);
+	struct Credit
+	{
+		size_t available = 0;   // bytes we may send now
+		size_t owed = 0;        // grants the server will still send
+	};
+	bool sendFile(const std::string& fqname, Socket& socket, bool binary = false, Credit* pCredit = nullptr, bool ack = false);
+	bool sendCredited(const std::string& fqname, size_t bytes, Socket& socket, bool binary, Credit& credit);
+	bool sendResumable(const std::string& filename, const std::string& fqname, size_t fileSize,
+		Socket& socket, bool binary, Credit& credit);
+	bool sendChunk(const std::string& filename, std::ifstream& in, size_t index, const std::string& hash,
+		size_t fileSize, Socket& socket, bool binary, Credit& credit);
+	bool takeGrant(Socket& socket, bool binary, Credit& credit);
+	bool drainGrants(Socket& socket, bool binary, Credit& credit);
+	bool connect();
+	bool negotiate(Socket& socket);
+	bool readAck();
+	HttpMessage readReply(Socket& socket, bool binary = false);
+	void readNotices(Socket& socket, const NoticeHandler& onNotice);
+	bool pageManifest(HttpMessage::Manifest& published);
+	void openStore();
+	ClientConnection connection_;
+	size_t streams_ = 1;
+	bool compress_ = false;     // server accepts compressed file bodies
+	bool sync_ = false;         // server answers SYNC manifests
+	bool binary_ = false;       // connection_ uses binary framing
+	size_t creditSegment_ = 0;  // server's credit segment, 0 if it grants none
+	size_t creditWindow_ = 0;   // bytes a stream may send ahead of grants
+	bool resume_ = false;       // server keeps chunks of broken off uploads
+	std::string branch_;        // branch uploads are recorded under, "" for the sender's
+	std::string localDir_ = "../TestFiles/";  // files are uploaded from and downloaded into it, ends with '/'
+	PageStore store_;                                  // pages held in localDir_, by content hash
+	bool storeLoaded_ = false;                         // store_ read its index
+	std::unique_ptr<ClientConnection> subscription_;   // carries only NOTIFY messages
+	std::thread notices_;                              // reads them, see subscribe
 };
 
@@ -0,0 +1,174 @@
+///////////////////////////////////////////////////////////////////////////
+// PageStore.cpp - Client's persistent cache of published pages          //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "PageStore.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../FileSystem/FileSystem.h"
+#include <fstream>
+#include <set>
+
+const char* const PageStore::IndexName = "pages.cache";
+
+PageStore::PageStore(const std::string& dir) : dir_(dir) {}
+
+//----< read the index saved by an earlier session >-----------------
+/*
+ *  Each page is a "page" line followed by its stamp and hash, e.g.:
+ *    page Parser/Parser.cpp.html
+ *    stamp 10/14/2026 9:30:5 10433
+ *    hash 8c2a61e2f09b1d47
+ */
+bool PageStore::load()
+{
+	std::ifstream in(dir_ + IndexName);
+	if (!in.good())
+		return false;
+	pages_.clear();
+	Entry* pEntry = nullptr;
+	std::string line;
+	while (std::getline(in, line))
+	{
+		size_t pos = line.find(' ');
+		if (pos == std::string::npos)
+			continue;
+		std::string key = line.substr(0, pos);
+		std::string value = line.substr(pos + 1);
+		if (key == "page")
+			pEntry = &pages_[value];
+		else if (pEntry == nullptr)
+			continue;
+		else if (key == "stamp")
+			pEntry->stamp = value;
+		else if (key == "hash")
+			pEntry->hash = value;
+	}
+	return true;
+}
+//----< write the index for the next session >-----------------------
+
+bool PageStore::save() const
+{
+	std::ofstream out(dir_ + IndexName);
+	if (!out.good())
+		return false;
+	for (auto& item : pages_)
+	{
+		out << "page " << item.first << "\n";
+		out << "stamp " << item.second.stamp << "\n";
+		out << "hash " << item.second.hash << "\n";
+	}
+	return out.good();
+}
+//----< bring entry up to date with page's copy, false if it's gone >---
+
+bool PageStore::check(const std::string& page, Entry& entry)
+{
+	std::string stamp = PublishManifest::stamp(dir_ + page);
+	if (stamp == "")
+		return false;
+	if (stamp != entry.stamp || entry.hash == "")
+	{
+		entry.hash = PublishManifest::contentHash(dir_ + page);
+		entry.stamp = stamp;
+	}
+	return true;
+}
+//----< check every page held or in the directory, returns pages hashed >---
+/*
+ * - pages are the html files at the top of the directory and the shared
+ *   assets, as a download writes them, and any page put in the index
+ */
+size_t PageStore::scan()
+{
+	std::set<std::string> found;
+	for (auto& page : FileSystem::Directory::getFiles(dir_, "*.html"))
+		found.insert(page);
+	for (auto& asset : FileSystem::Directory::getFiles(dir_ + "assets/", "*.*"))
+		found.insert("assets/" + asset);
+	for (auto& item : pages_)
+		found.insert(item.first);
+	size_t hashed = 0;
+	for (auto& page : found)
+	{
+		Entry& entry = pages_[page];
+		std::string before = entry.stamp;
+		if (!check(page, entry))
+			pages_.erase(page);
+		else if (entry.stamp != before)
+			++hashed;
+	}
+	return hashed;
+}
+
+std::string PageStore::hash(const std::string& page) const
+{
+	auto iter = pages_.find(page);
+	return iter != pages_.end() ? iter->second.hash : "";
+}
+
+PageStore::Manifest PageStore::manifest() const
+{
+	Manifest held;
+	for (auto& item : pages_)
+		held.push_back(ManifestEntry(item.first, item.second.hash));
+	return held;
+}
+//----< pages of the server's manifest not held, or held with another hash >---
+
+std::vector<std::string> PageStore::stale(const Manifest& server) const
+{
+	std::vector<std::string> pages;
+	for (auto& entry : server)
+	{
+		if (hash(entry.first) != entry.second)
+			pages.push_back(entry.first);
+	}
+	return pages;
+}
+//----< pages held that aren't in the server's manifest >------------
+
+std::vector<std::string> PageStore::removedFrom(const Manifest& server) const
+{
+	std::set<std::string> published;
+	for (auto& entry : server)
+		published.insert(entry.first);
+	std::vector<std::string> pages;
+	for (auto& item : pages_)
+	{
+		if (published.count(item.first) == 0)
+			pages.push_back(item.first);
+	}
+	return pages;
+}
+//----< write a fetched page, creating its directory, and record it >---
+/*
+ * - etag is the server's hash of bytes, so the copy isn't hashed again
+ * - page names holding ".." are refused, they'd leave the directory
+ */
+bool PageStore::put(const std::string& page, const std::string& bytes, const std::string& etag)
+{
+	if (page == "" || page.find("..") != std::string::npos)
+		return false;
+	size_t dirEnd = page.find_last_of('/');
+	if (dirEnd != std::string::npos && !FileSystem::Directory::exists(dir_ + page.substr(0, dirEnd)))
+		FileSystem::Directory::create(dir_ + page.substr(0, dirEnd));
+	std::ofstream out(dir_ + page, std::ios::binary | std::ios::trunc);
+	out.write(bytes.data(), bytes.size());
+	out.close();
+	if (!out.good())
+		return false;
+	Entry& entry = pages_[page];
+	entry.stamp = PublishManifest::stamp(dir_ + page);
+	entry.hash = (etag != "") ? etag : PublishManifest::textHash(bytes);
+	return true;
+}
+
+void PageStore::remove(const std::string& page)
+{
+	if (pages_.erase(page) > 0)
+		FileSystem::File::remove(dir_ + page);
+}
@@ -0,0 +1,89 @@
+#ifndef PAGESTORE_H
+#define PAGESTORE_H
+///////////////////////////////////////////////////////////////////////////
+// PageStore.h - Client's persistent cache of published pages            //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* PageStore keeps the published pages a client has downloaded, in its
+* local directory, with an index, pages.cache, of each page's content
+* hash and the stamp, last write time and size, of the copy on disk.
+* The hash is the server's etag for the page, so comparing the index with
+* the server's MANIFEST reply finds the pages that are stale without
+* reading any local copy.
+*
+* The index is kept across sessions.  scan checks the stamp of every page
+* it holds, and of pages found in the directory, and hashes only the ones
+* whose stamp moved, e.g., a page a download just wrote, so a session
+* that starts with thousands of pages held stats them instead of reading
+* them all.  A page removed from the directory is dropped from the index.
+*
+* Public Interface
+* --------------------
+* PageStore store("../TestFiles/");                   //dir ends with '/'
+* store.load();                                       //read pages.cache, false if none
+* size_t hashed = store.scan();                       //pages whose copy changed, rehashed
+* std::string hash = store.hash("index.html");        //"" if not held
+* PageStore::Manifest held = store.manifest();        //page and hash of each held
+* std::vector<std::string> stale = store.stale(server);  //pages server has with other hashes
+* std::vector<std::string> gone = store.removedFrom(server); //held pages server no longer has
+* store.put("index.html", bytes, etag);               //write a fetched page, false on failure
+* store.remove("index.html");                         //delete the copy and forget it
+* store.save();                                       //write pages.cache
+*
+* Required Files:
+* ---------------
+*   PageStore.h, PageStore.cpp
+*   PublishManifest.h, PublishManifest.cpp
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <vector>
+#include <map>
+
+class PageStore
+{
+public:
+	using ManifestEntry = std::pair<std::string, std::string>;   // page name, content hash
+	using Manifest = std::vector<ManifestEntry>;                 // as HttpMessage::Manifest
+	static const char* const IndexName;
+
+	PageStore(const std::string& dir = "../TestFiles/");
+	bool load();
+	bool save() const;
+	size_t scan();
+	std::string hash(const std::string& page) const;
+	Manifest manifest() const;
+	std::vector<std::string> stale(const Manifest& server) const;
+	std::vector<std::string> removedFrom(const Manifest& server) const;
+	bool put(const std::string& page, const std::string& bytes, const std::string& etag);
+	void remove(const std::string& page);
+	size_t size() const { return pages_.size(); }
+	const std::string& dir() const { return dir_; }
+private:
+	struct Entry
+	{
+		std::string stamp;
+		std::string hash;
+	};
+	bool check(const std::string& page, Entry& entry);
+	std::string dir_;
+	std::map<std::string, Entry> pages_;
+};
+#endif
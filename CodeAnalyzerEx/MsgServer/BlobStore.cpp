@@ -0,0 +1,164 @@
+///////////////////////////////////////////////////////////////////////////
+// BlobStore.cpp - Stores uploaded files once each, by content hash      //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "BlobStore.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../FileSystem/FileSystem.h"
+#include <windows.h>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <cctype>
+
+BlobStore::BlobStore(const std::string& root) : root_(root), received_(0)
+{
+	FileSystem::Directory::create(root_ + "blobs");
+	FileSystem::Directory::create(root_ + "blobs/incoming");
+	FileSystem::Directory::create(root_ + "manifests");
+}
+//----< a file name no other upload is received into >---------------
+
+std::string BlobStore::incoming()
+{
+	std::ostringstream name;
+	name << root_ << "blobs/incoming/" << std::this_thread::get_id() << "-" << ++received_ << ".tmp";
+	return name.str();
+}
+//----< keep the file received as owner's name, returns its hash >----
+/*
+ * - content already stored is dropped, and name linked to its blob
+ * - received may be name itself, e.g., a resumed upload renamed into
+ *   place, then it becomes the blob if its content is new
+ * - returns "" if the name couldn't be linked, received is removed
+ *   unless it is name
+ */
+BlobStore::Hash BlobStore::add(const std::string& owner, const std::string& name, const std::string& received)
+{
+	std::string fqname = root_ + name;
+	if (!FileSystem::File::exists(received))
+		return "";
+	Hash hash = PublishManifest::contentHash(received);
+	std::string blob = blobName(hash);
+	bool fresh = !FileSystem::File::exists(blob) && ::CreateHardLinkA(blob.c_str(), received.c_str(), NULL);
+	if (!fresh && !FileSystem::File::exists(blob))
+		fresh = FileSystem::File::copy(received, blob, true);
+	bool ok = FileSystem::File::exists(blob);
+	if (ok && !(fresh && received == fqname))
+		ok = linkName(name, hash);
+	if (received != fqname)
+		::DeleteFileA(received.c_str());
+	if (!ok)
+		return "";
+	record(owner, name, hash);
+	std::lock_guard<std::mutex> lock(mtx_);
+	if (fresh)
+		++stats_.blobs;
+	else
+	{
+		++stats_.shared;
+		stats_.bytesSaved += FileSystem::FileInfo(blob).size();
+	}
+	return hash;
+}
+//----< is content with this hash stored? >--------------------------
+
+bool BlobStore::has(const Hash& hash)
+{
+	return hash != "" && hash.find_first_of("/\\.") == std::string::npos && FileSystem::File::exists(blobName(hash));
+}
+//----< make owner's name hold the stored blob, without an upload >---
+
+bool BlobStore::link(const std::string& owner, const std::string& name, const Hash& hash)
+{
+	if (!has(hash) || !linkName(name, hash))
+		return false;
+	record(owner, name, hash);
+	std::lock_guard<std::mutex> lock(mtx_);
+	++stats_.shared;
+	stats_.bytesSaved += FileSystem::FileInfo(blobName(hash)).size();
+	return true;
+}
+//----< point name at blob, by renaming a new link over it >---------
+/*
+ * - a reader of name sees all of the old file or all of the blob
+ */
+bool BlobStore::linkName(const std::string& name, const Hash& hash)
+{
+	std::string fqname = root_ + name;
+	std::string blob = blobName(hash);
+	std::string link = fqname + ".link";
+	::DeleteFileA(link.c_str());
+	if (!::CreateHardLinkA(link.c_str(), blob.c_str(), NULL) && !FileSystem::File::copy(blob, link))
+		return false;
+	if (::MoveFileExA(link.c_str(), fqname.c_str(), MOVEFILE_REPLACE_EXISTING))
+		return true;
+	::DeleteFileA(link.c_str());
+	return false;
+}
+//----< hash of owner's name, as last linked >-----------------------
+
+BlobStore::Hash BlobStore::hashOf(const std::string& owner, const std::string& name)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	Names& held = names(owner);
+	auto iter = held.find(name);
+	return iter != held.end() ? iter->second : "";
+}
+//----< add name to owner's manifest, in memory and on disk >--------
+
+void BlobStore::record(const std::string& owner, const std::string& name, const Hash& hash)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	Names& held = names(owner);
+	auto iter = held.find(name);
+	if (iter != held.end() && iter->second == hash)
+		return;
+	held[name] = hash;
+	HttpMessage::Manifest line(1, HttpMessage::ManifestEntry(name, hash));
+	std::ofstream out(root_ + "manifests/" + owner + ".manifest", std::ios::out | std::ios::app | std::ios::binary);
+	out << HttpMessage::manifestBody(line);
+}
+//----< owner's names, read from its manifest the first time >-------
+/*
+ * - mtx_ must be held
+ */
+BlobStore::Names& BlobStore::names(const std::string& owner)
+{
+	auto iter = owners_.find(owner);
+	if (iter != owners_.end())
+		return iter->second;
+	Names& held = owners_[owner];
+	std::ifstream in(root_ + "manifests/" + owner + ".manifest", std::ios::binary);
+	std::string body((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+	for (auto& entry : HttpMessage::parseManifest(body))
+		held[entry.first] = entry.second;
+	return held;
+}
+
+BlobStore::Stats BlobStore::stats()
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	return stats_;
+}
+//----< owner of msg's upload: its branch, else its sender, else shared >--
+/*
+ * - characters that can't be in a file name become '_'
+ */
+std::string BlobStore::ownerOf(const HttpMessage& msg)
+{
+	std::string owner = msg.findValue("branch");
+	if (owner == "")
+		owner = msg.findValue("fromAddr");
+	if (owner == "")
+		return "shared";
+	for (char& ch : owner)
+	{
+		if (!isalnum(static_cast<unsigned char>(ch)) && ch != '-' && ch != '_' && ch != '.')
+			ch = '_';
+	}
+	return owner;
+}
@@ -0,0 +1,104 @@
+#ifndef BLOBSTORE_H
+#define BLOBSTORE_H
+///////////////////////////////////////////////////////////////////////////
+// BlobStore.h - Stores uploaded files once each, by content hash        //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* BlobStore keeps each distinct file content clients upload once, as a
+* blob named by its content hash, PublishManifest::contentHash, under
+* the Repository's blobs/ directory.  Many clients pushing branches of
+* the same project upload the same files again and again, so the disk
+* a Repository takes grows with the content that differs, not with the
+* number of uploads.
+*
+* The name a file was uploaded as, e.g., Repository/Parser.cpp, is a hard
+* link to its blob, so the analyzer and publisher read the Repository as
+* before.  A name is only ever replaced by a new link, renamed over it,
+* never written through, so a blob shared by many names can't change.
+* Where hard links aren't supported the blob is copied to the name.
+*
+* Each owner, a client or a branch, has a manifest, manifests/owner.manifest,
+* of the names it uploaded and the hash of each, in the form made by
+* HttpMessage::manifestBody.  Lines are appended as names are linked, a
+* later line for a name replaces an earlier one.
+*
+* A file is received into a file named by incoming(), then add hashes
+* it, keeps it as a new blob or drops it for the blob already stored,
+* and links the name to that blob.  has and link let a SYNC exchange
+* link a name to content some other upload already stored, with no
+* upload at all.
+*
+* Public Interface
+* --------------------
+* BlobStore store("../Repository/");
+* std::string fqname = store.incoming();                  //where to receive the next upload
+* std::string hash = store.add(owner, name, fqname);      //"" if it couldn't be stored
+* bool stored = store.has(hash);                          //a blob with this content exists
+* bool linked = store.link(owner, name, hash);            //name now holds the blob
+* std::string hash = store.hashOf(owner, name);           //"" if owner has no such name
+* std::string owner = BlobStore::ownerOf(msg);            //branch, else sender, else "shared"
+* BlobStore::Stats stats = store.stats();                 //blobs added, uploads deduplicated
+*
+* Required Files:
+* ---------------
+*   BlobStore.h, BlobStore.cpp
+*   HttpMessage.h, HttpMessage.cpp
+*   PublishManifest.h, PublishManifest.cpp
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../HttpMessage/HttpMessage.h"
+#include <string>
+#include <mutex>
+#include <atomic>
+#include <unordered_map>
+
+class BlobStore
+{
+public:
+	using Hash = std::string;
+	using Names = std::unordered_map<std::string, Hash>;   // name, hash
+	struct Stats
+	{
+		size_t blobs = 0;      // new content stored
+		size_t shared = 0;     // names linked to a blob already stored
+		size_t bytesSaved = 0; // bytes not stored again
+	};
+
+	BlobStore(const std::string& root);
+	std::string incoming();
+	Hash add(const std::string& owner, const std::string& name, const std::string& received);
+	bool has(const Hash& hash);
+	bool link(const std::string& owner, const std::string& name, const Hash& hash);
+	Hash hashOf(const std::string& owner, const std::string& name);
+	Stats stats();
+	static std::string ownerOf(const HttpMessage& msg);
+private:
+	std::string blobName(const Hash& hash) { return root_ + "blobs/" + hash; }
+	bool linkName(const std::string& name, const Hash& hash);
+	void record(const std::string& owner, const std::string& name, const Hash& hash);
+	Names& names(const std::string& owner);
+
+	std::string root_;
+	std::atomic<size_t> received_;
+	std::mutex mtx_;      // guards owners_ and stats_
+	std::unordered_map<std::string, Names> owners_;
+	Stats stats_;
+};
+#endif
@@ -0,0 +1,117 @@
+///////////////////////////////////////////////////////////////////////////
+// DependencyQuery.cpp - Answers queries for dependency subgraphs        //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "DependencyQuery.h"
+#include "../HelpSession/NoSqlDb/Snapshot.h"
+#include "../HelpSession/NoSqlDb/ElementCodec.h"
+#include "../CodePublisher/PagePack.h"
+#include <unordered_set>
+
+DependencyReader::DependencyReader(const std::string& root)
+	: file_(PagePack::withSlash(root) + "deps.snapshot"), fullRoot_(PagePack::fullRootOf(root)) {}
+
+//----< name of a file as pages are named, its full name if it isn't under the root >---
+
+std::string DependencyReader::nameOf(const std::string& fileSpec) const
+{
+	std::string name = PagePack::nameUnder(fullRoot_, fileSpec);
+	return name != "" ? name : fileSpec;
+}
+//----< the saved database, loaded again when deps.snapshot moves >---
+/*
+ * - keys, names and children are renamed as they're loaded, so queries
+ *   and answers use page names
+ * - a snapshot that can't be read, e.g., while it is being replaced,
+ *   leaves the last one loaded in use
+ */
+std::shared_ptr<const DependencyReader::Snapshot> DependencyReader::current()
+{
+	FileSystem::FileInfo now(file_);
+	std::lock_guard<std::mutex> lock(mtx_);
+	if (!now.good() || (snapshot_ && !snapshot_->saved.earlier(now) && !now.earlier(snapshot_->saved) &&
+		snapshot_->saved.size() == now.size()))
+		return snapshot_;
+	NoSqlDb<std::string> saved;
+	if (!::Snapshot<std::string>::load(saved, file_))
+		return snapshot_;
+	std::shared_ptr<Snapshot> loaded = std::make_shared<Snapshot>(file_);
+	loaded->db.reserve(saved.count());
+	saved.forEach([&](const std::string& key, const Element<std::string>& elem) {
+		Element<std::string> renamed = elem;
+		renamed.name = nameOf(elem.name.ref());
+		std::vector<std::string> children;
+		children.reserve(elem.children.ref().size());
+		for (auto& child : elem.children.ref())
+			children.push_back(nameOf(child));
+		renamed.children = children;
+		loaded->db.save(nameOf(key), renamed);
+	});
+	snapshot_ = loaded;
+	return snapshot_;
+}
+//----< has a snapshot been read? >----------------------------------
+
+bool DependencyReader::loaded()
+{
+	return current() != nullptr;
+}
+//----< encode the elements reached from query's files, returns how many >---
+/*
+ * - a breadth first walk, each file once, so an element's links are only
+ *   followed if it's within depth links of a named file
+ * - files the database doesn't hold are neither answered nor walked from
+ */
+size_t DependencyReader::query(const Query& query, std::string& encoded, bool& truncated)
+{
+	truncated = false;
+	std::shared_ptr<const Snapshot> snapshot = current();
+	if (!snapshot)
+	{
+		encoded = ElementCodec<std::string>::encode(ElementCodec<std::string>::Items());
+		return 0;
+	}
+	const NoSqlDb<std::string>& db = snapshot->db;
+	Keys reached;
+	std::unordered_set<std::string> seen;
+	for (auto& file : query.files)
+	{
+		if (reached.size() == ElementLimit)
+		{
+			truncated = true;
+			break;
+		}
+		if (db.find(file) != nullptr && seen.insert(file).second)
+			reached.push_back(file);
+	}
+	size_t first = 0;
+	for (size_t depth = 0; !truncated && (query.depth == 0 || depth < query.depth); ++depth)
+	{
+		size_t last = reached.size();
+		if (first == last)
+			break;
+		for (size_t i = first; i < last && !truncated; ++i)
+		{
+			Keys next = query.dependents ? db.dependents(reached[i]) : db.find(reached[i])->children.ref();
+			for (auto& key : next)
+			{
+				if (db.find(key) == nullptr || !seen.insert(key).second)
+					continue;
+				if (reached.size() == ElementLimit)
+				{
+					truncated = true;
+					break;
+				}
+				reached.push_back(key);
+			}
+		}
+		if (truncated)
+			break;
+		first = last;
+	}
+	encoded = ElementCodec<std::string>::encode(db, reached);
+	return reached.size();
+}
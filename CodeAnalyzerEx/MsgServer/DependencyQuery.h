@@ -0,0 +1,95 @@
+#ifndef DEPENDENCYQUERY_H
+#define DEPENDENCYQUERY_H
+///////////////////////////////////////////////////////////////////////////
+// DependencyQuery.h - Answers queries for dependency subgraphs          //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* DependencyReader is the server's side of the analyzer's dependency
+* database.  The analyzer saves it as deps.snapshot under the repository
+* after each batch, see Snapshot, and the reader loads it again when the
+* file moves, with every key and child named as pages are, relative to the
+* repository with '/' separators, e.g., Parser/Parser.cpp.  Files outside
+* the repository keep their full names.
+*
+* A query names files and walks from them, to the files they depend on or,
+* with dependents, to the files depending on them, up to depth links, 0 for
+* no limit.  The answer is every element reached, the named files first,
+* then the rest nearest first, as one ElementCodec encoding, so a client
+* gets a subgraph of thousands of files in one small message:
+*
+*   QUERY: dependencies    depth: 2    body: a file per line
+*   QUERY: elements    count: 1520    truncated: no    body: the encoding
+*
+* An answer holds at most ElementLimit elements, truncated says it's cut.
+* Elements are read in place, shared with queries made while a newer
+* snapshot loads.
+*
+* Public Interface
+* --------------------
+* DependencyReader reader("../Repository/");
+* DependencyReader::Query query;                  //files, depth, dependents
+* bool truncated;
+* size_t n = reader.query(query, encoded, truncated);   //elements in encoded
+* bool any = reader.loaded();                     //false until a snapshot is read
+*
+* Required Files:
+* ---------------
+*   DependencyQuery.h, DependencyQuery.cpp
+*   NoSqlDb.h, Snapshot.h, ElementCodec.h, PagePack.h, FileSystem.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../HelpSession/NoSqlDb/NoSqlDb.h"
+#include "../FileSystem/FileSystem.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+
+class DependencyReader
+{
+public:
+	using Keys = std::vector<std::string>;
+	struct Query
+	{
+		Keys files;               // named as pages are
+		size_t depth = 1;         // links walked, 0 for no limit
+		bool dependents = false;  // walk to the files depending on files
+	};
+	static const size_t ElementLimit = 100000;   // most elements one answer holds
+
+	DependencyReader(const std::string& root);
+	size_t query(const Query& query, std::string& encoded, bool& truncated);
+	bool loaded();
+private:
+	struct Snapshot
+	{
+		Snapshot(const std::string& file) : saved(file) {}
+		FileSystem::FileInfo saved;   // deps.snapshot, as it was when loaded
+		NoSqlDb<std::string> db;      // keyed by names under the root
+	};
+	std::shared_ptr<const Snapshot> current();
+	std::string nameOf(const std::string& fileSpec) const;
+
+	std::string file_;       // root's deps.snapshot
+	std::string fullRoot_;   // full path, ends with '\'
+	std::mutex mtx_;
+	std::shared_ptr<const Snapshot> snapshot_;
+};
+
+#endif
@@ -0,0 +1,183 @@
+///////////////////////////////////////////////////////////////////////////
+// MsgDispatcher.cpp - Routes server messages to handlers on workers     //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "MsgDispatcher.h"
+#include "../Utilities/Trace.h"
+#include <algorithm>
+#include <exception>
+
+MsgDispatcher::MsgDispatcher(size_t quickWorkers, size_t longWorkers)
+{
+	workerCounts_[Quick] = (std::max)(quickWorkers, (size_t)1);
+	workerCounts_[Long] = (std::max)(longWorkers, (size_t)1);
+	for (size_t lane = 0; lane < NumLanes; ++lane)
+	{
+		lanes_[lane].reset(new LaneQueue(NumPriorities, StarvationLimit));
+		pending_[lane] = 0;
+	}
+	unhandled_.lane = Quick;
+	unhandled_.priority = Interactive;
+}
+
+MsgDispatcher::~MsgDispatcher()
+{
+	stop();
+}
+//----< handle messages with command in lane, register before start >--
+
+void MsgDispatcher::on(const std::string& command, Handler handler, Lane lane, Priority priority)
+{
+	Route route = { handler, lane, priority };
+	routes_[command] = route;
+}
+//----< handle messages no other handler is registered for >---------
+
+void MsgDispatcher::onUnhandled(Handler handler, Lane lane, Priority priority)
+{
+	unhandled_.handler = handler;
+	unhandled_.lane = lane;
+	unhandled_.priority = priority;
+}
+//----< start every lane's workers >---------------------------------
+
+void MsgDispatcher::start()
+{
+	if (workers_.size() > 0)
+		return;
+	for (size_t lane = 0; lane < NumLanes; ++lane)
+		for (size_t i = 0; i < workerCounts_[lane]; ++i)
+			workers_.push_back(std::thread([this, lane] { work(static_cast<Lane>(lane)); }));
+}
+//----< command a message is routed by >-----------------------------
+
+std::string MsgDispatcher::commandOf(const HttpMessage& msg)
+{
+	std::string command = msg.findValue("command");
+	if (command != "")
+		return command;
+	return msg.findValue("file") != "" ? "upload" : "message";
+}
+
+const char* MsgDispatcher::priorityName(Priority priority)
+{
+	static const char* names[NumPriorities] = { "interactive", "bulk", "background" };
+	return priority < NumPriorities ? names[priority] : "";
+}
+//----< priority msg's "priority" attribute names, else byDefault >--
+
+MsgDispatcher::Priority MsgDispatcher::priorityOf(const HttpMessage& msg, Priority byDefault)
+{
+	const std::string& name = msg.findValue("priority");
+	for (size_t priority = 0; name != "" && priority < NumPriorities; ++priority)
+	{
+		if (name == priorityName(static_cast<Priority>(priority)))
+			return static_cast<Priority>(priority);
+	}
+	return byDefault;
+}
+//----< queue msg in its handler's lane and priority, without waiting >--
+
+void MsgDispatcher::dispatch(HttpMessage&& msg)
+{
+	Job job;
+	job.command = commandOf(msg);
+	auto iter = routes_.find(job.command);
+	job.pRoute = (iter != routes_.end()) ? &iter->second : &unhandled_;
+	if (!job.pRoute->handler)
+		return;
+	job.priority = priorityOf(msg, job.pRoute->priority);
+	job.msg = std::move(msg);
+	job.queued = Clock::now();
+	Priority priority = job.priority;
+	Lane lane = job.pRoute->lane;
+	++pending_[lane];
+	lanes_[lane]->enQ(std::move(job), priority);
+}
+//----< run the handler of each job taken from lane, until told to quit >--
+/*
+ * - a handler that throws is counted as failed, the worker goes on
+ *   with the next message
+ */
+void MsgDispatcher::work(Lane laneId)
+{
+	LaneQueue& lane = *lanes_[laneId];
+	Utilities::Trace& trace = Utilities::Trace::instance();
+	trace.nameThread(laneId == Quick ? "quick lane worker" : "long lane worker");
+	while (true)
+	{
+		Job job = lane.deQ();
+		if (job.pRoute == nullptr)
+			return;
+		--pending_[laneId];
+		Clock::time_point started = Clock::now();
+		bool failed = false;
+		try
+		{
+			job.pRoute->handler(job.msg);
+		}
+		catch (std::exception&)
+		{
+			failed = true;
+		}
+		Clock::time_point finished = Clock::now();
+		trace.record("dispatch", "lane wait", job.queued, started, job.command);
+		trace.record("dispatch", job.command, started, finished);
+		record(job.command,
+			std::chrono::duration<double, std::milli>(started - job.queued).count(),
+			std::chrono::duration<double, std::milli>(finished - started).count(), failed);
+	}
+}
+//----< add one message's times to its command's stats >-------------
+
+void MsgDispatcher::record(const std::string& command, double waitMs, double runMs, bool failed)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	Stats& stats = stats_[command];
+	++stats.calls;
+	if (failed)
+		++stats.failed;
+	stats.waitMs += waitMs;
+	stats.runMs += runMs;
+	stats.maxWaitMs = (std::max)(stats.maxWaitMs, waitMs);
+	stats.maxRunMs = (std::max)(stats.maxRunMs, runMs);
+}
+
+MsgDispatcher::StatsMap MsgDispatcher::stats()
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	return stats_;
+}
+//----< messages each priority of lane holds, and has held at most >--
+
+MsgDispatcher::Depths MsgDispatcher::depths(Lane lane)
+{
+	return lanes_[lane]->depths();
+}
+//----< finish every message dispatched so far, then join workers >--
+/*
+ * - a quit job could be taken ahead of its turn to end a wait, so quit
+ *   jobs are queued, one per worker, once every message has started
+ */
+void MsgDispatcher::stop()
+{
+	if (workers_.size() == 0)
+		return;
+	for (size_t lane = 0; lane < NumLanes; ++lane)
+		while (pending_[lane] > 0)
+			std::this_thread::sleep_for(std::chrono::milliseconds(10));
+	for (size_t lane = 0; lane < NumLanes; ++lane)
+		for (size_t i = 0; i < workerCounts_[lane]; ++i)
+		{
+			Job quit;
+			quit.pRoute = nullptr;
+			quit.priority = Background;
+			lanes_[lane]->enQ(std::move(quit), Background);
+		}
+	for (auto& worker : workers_)
+		worker.join();
+	workers_.clear();
+}
@@ -0,0 +1,155 @@
+#ifndef MSGDISPATCHER_H
+#define MSGDISPATCHER_H
+///////////////////////////////////////////////////////////////////////////
+// MsgDispatcher.h - Routes server messages to handlers on worker lanes  //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* MsgDispatcher takes the messages ClientHandlers queue for the server,
+* e.g., upload notifications, and hands each to the handler registered
+* for its command.  A message's command is the value of its "command"
+* attribute, or "upload" for a message naming a received file, or
+* "message" for any other.  Messages with no handler go to the handler
+* set with onUnhandled, if any, and are dropped otherwise.
+*
+* Handlers run on worker threads, in one of two lanes.  Quick handlers,
+* e.g., logging an upload, share a few workers.  Long handlers, e.g.,
+* publishing to a client, run on workers of their own, so however long
+* they take they never hold up quick ones.
+*
+* Within a lane, messages wait in priority classes: Interactive, e.g.,
+* a user's request, ahead of Bulk, e.g., the upload notifications of a
+* push of thousands of files, ahead of Background, e.g., republishing.
+* A message takes its handler's priority, or the one its "priority"
+* attribute names: interactive, bulk, or background.  Messages of one
+* class are started in the order dispatched.  So a burst of bulk
+* messages can't keep the classes below it waiting forever, a class
+* passed over StarvationLimit times while waiting is served next.
+*
+* For each command the dispatcher records the number of messages
+* handled, the number whose handler threw, and the time they waited in
+* their lane and ran, in total and at most.  depths(lane) reports the
+* messages each class of a lane holds now and at most, and how many were
+* started ahead of their turn to end a wait.
+*
+* Handlers are registered before start, and dispatch may be called from
+* any thread after it.  stop lets the workers finish every message
+* already dispatched, then joins them.
+*
+* Public Interface
+* --------------------
+* MsgDispatcher dispatcher(4, 1);                     //quick and long workers
+* dispatcher.on("stats", handler);                    //quick lane, interactive
+* dispatcher.on("upload", handler, MsgDispatcher::Quick, MsgDispatcher::Bulk);
+* dispatcher.on("publish", handler, MsgDispatcher::Long, MsgDispatcher::Background);
+* dispatcher.onUnhandled(handler);                    //messages nobody handles
+* dispatcher.start();
+* dispatcher.dispatch(std::move(msg));                //returns at once
+* MsgDispatcher::StatsMap stats = dispatcher.stats(); //per command
+* MsgDispatcher::Depths depths = dispatcher.depths(MsgDispatcher::Quick);  //per priority
+* dispatcher.stop();                                  //finish queued, join
+*
+* Required Files:
+* ---------------
+*   MsgDispatcher.h, MsgDispatcher.cpp
+*   HttpMessage.h, HttpMessage.cpp
+*   Cpp11-BlockingQueue.h, Trace.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.2 : 14 Oct 2026
+* - workers record a Trace span of each message's wait in its lane and of
+*   its handler, named by command
+* Ver 1.1 : 14 Oct 2026
+* - each lane holds Interactive, Bulk, and Background priority classes in a
+*   PriorityBlockingQueue with starvation protection, added depths(lane)
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../HttpMessage/HttpMessage.h"
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <unordered_map>
+#include <functional>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <memory>
+#include <atomic>
+
+class MsgDispatcher
+{
+public:
+	using Handler = std::function<void(HttpMessage&)>;
+	enum Lane { Quick, Long, NumLanes };
+	enum Priority { Interactive, Bulk, Background, NumPriorities };
+	using Depths = std::vector<Async::QueueDepth>;
+	static const size_t StarvationLimit = 8;
+	struct Stats
+	{
+		size_t calls = 0;
+		size_t failed = 0;     // handler threw
+		double waitMs = 0.0;   // dispatch to start, total
+		double runMs = 0.0;    // start to finish, total
+		double maxWaitMs = 0.0;
+		double maxRunMs = 0.0;
+	};
+	using StatsMap = std::map<std::string, Stats>;
+
+	MsgDispatcher(size_t quickWorkers = 4, size_t longWorkers = 1);
+	~MsgDispatcher();
+	MsgDispatcher(const MsgDispatcher&) = delete;
+	MsgDispatcher& operator=(const MsgDispatcher&) = delete;
+	void on(const std::string& command, Handler handler, Lane lane = Quick, Priority priority = Interactive);
+	void onUnhandled(Handler handler, Lane lane = Quick, Priority priority = Interactive);
+	void start();
+	void dispatch(HttpMessage&& msg);
+	void stop();
+	StatsMap stats();
+	Depths depths(Lane lane);
+	static std::string commandOf(const HttpMessage& msg);
+	static const char* priorityName(Priority priority);
+private:
+	using Clock = std::chrono::steady_clock;
+	struct Route
+	{
+		Handler handler;
+		Lane lane;
+		Priority priority;
+	};
+	struct Job
+	{
+		const Route* pRoute;   // nullptr tells the worker to quit
+		std::string command;
+		Priority priority;
+		HttpMessage msg;
+		Clock::time_point queued;
+	};
+	using LaneQueue = Async::PriorityBlockingQueue<Job>;
+	Priority priorityOf(const HttpMessage& msg, Priority byDefault);
+	void work(Lane lane);
+	void record(const std::string& command, double waitMs, double runMs, bool failed);
+
+	std::unordered_map<std::string, Route> routes_;
+	Route unhandled_;
+	size_t workerCounts_[NumLanes];
+	std::unique_ptr<LaneQueue> lanes_[NumLanes];
+	std::atomic<size_t> pending_[NumLanes];   // messages queued, not yet started
+	std::vector<std::thread> workers_;
+	std::mutex mtx_;      // guards stats_
+	StatsMap stats_;
+};
+#endif
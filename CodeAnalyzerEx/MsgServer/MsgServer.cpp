@@ -8,37 +8,89 @@
 
 
 #include"MsgServer.h"
+#include "../Sockets/Compression.h"
+#include "../CodePublisher/PublishSignal.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../CodePublisher/PageDiff.h"
+#include "MsgDispatcher.h"
+#include "UploadWriter.h"
+#include "PartialUploads.h"
+#include "BlobStore.h"
+#include "StaticHttp.h"
+#include "PageNotifier.h"
+#include "../Utilities/Trace.h"
 #include <string>
 #include <iostream>
+#include <vector>
+#include <sstream>
+#include <unordered_map>
+#include <algorithm>
+#include <chrono>
 using namespace Logging;
 using Show = StaticLogger<1>;
 using namespace Utilities;
 using namespace Async;
 
+const unsigned long PublishWaitMs = 60000;   // longest wait for the analyzer to finish a batch
+const size_t CreditWindow = 8 * UploadWriter::SegmentSize;   // bytes a client may send ahead of grants
+const size_t SearchLimit = 5000;   // most hits one SEARCH may ask for
+const size_t QueryFilesLimit = 1024 * 1024;   // longest body of file names one QUERY may send
+
 class ClientHandler
 {
 public:
-  ClientHandler(BlockingQueue<HttpMessage>& msgQ) : msgQ_(msgQ) {}
+  ClientHandler(BlockingQueue<HttpMessage>& msgQ, UploadWriter& writer, PartialUploads& parts, BlobStore& store, StaticHttp& http)
+    : msgQ_(msgQ), writer_(writer), parts_(parts), store_(store), http_(http) {}
   void operator()(Socket socket);
 private:
   bool connectionClosed_;
-  HttpMessage readMessage(Socket& socket);
-  bool readFile(const std::string& filename, size_t fileSize, Socket& socket);
+  HttpMessage readMessage(Socket& socket, bool binary);
+  void readBody(HttpMessage& msg, Socket& socket);
+  bool readFile(const std::string& fqname, size_t fileSize, Socket& socket, const std::string& encoding);
+  bool readFileCredited(const std::string& fqname, size_t fileSize, Socket& socket, const std::string& encoding, bool binary);
+  void sendGrant(Socket& socket, size_t bytes, bool binary);
+  void replyResume(HttpMessage& msg, Socket& socket, bool binary);
+  void readChunk(HttpMessage& msg, Socket& socket, bool binary);
+  void replyCommit(HttpMessage& msg, Socket& socket, bool binary);
+  HttpMessage uploadNotice(const std::string& filename);
+  bool replyOptions(HttpMessage& msg, Socket& socket);
+  void replySync(HttpMessage& msg, Socket& socket, bool binary);
+  void replyFetch(HttpMessage& msg, Socket& socket, bool binary);
+  void replySearch(HttpMessage& msg, Socket& socket, bool binary);
+  void replyQuery(HttpMessage& msg, Socket& socket, bool binary);
+  void replyAck(HttpMessage& msg, Socket& socket, bool binary);
+  void subscribe(HttpMessage& msg, Socket& socket, bool binary);
+  void replyManifest(Socket& socket, bool binary);
   BlockingQueue<HttpMessage>& msgQ_;
+  UploadWriter& writer_;
+  PartialUploads& parts_;
+  BlobStore& store_;
+  StaticHttp& http_;
+  MsgClientFromServer publisher_;
 };
 //----< this defines processing to frame messages >------------------
-
-HttpMessage ClientHandler::readMessage(Socket& socket){
+/*
+ * - binary is true once the client negotiated binary framing, then
+ *   the header is one fixed size block and length prefixed attributes
+ * - a file is received apart, then kept by the blob store, which links
+ *   its name to content already stored instead of keeping it twice
+ * - a browser's request line is kept as the attribute "HTTP", its
+ *   headers follow as attributes
+ */
+HttpMessage ClientHandler::readMessage(Socket& socket, bool binary){
   connectionClosed_ = false;
   HttpMessage msg;
-  while (true)  {
+  while (!binary)  {
     std::string attribString = socket.recvString('\n');
-    if (attribString.size() > 1){
-      HttpMessage::Attribute attrib = HttpMessage::parseAttribute(attribString);
-      msg.addAttribute(attrib);
-    }
-    else{break;}
+    if (attribString.size() <= 1)
+      break;
+    if (msg.attributes().size() == 0 && StaticHttp::isRequestLine(attribString))
+      msg.addAttribute(HttpMessage::attribute("HTTP", attribString.substr(0, attribString.find_last_not_of("\r") + 1)));
+    else
+      msg.addAttribute(HttpMessage::parseAttribute(attribString));
   }
+  if (binary && !msg.recvBinaryHeader(socket))
+    msg.clear();
   if (msg.attributes().size() == 0){
     connectionClosed_ = true;
     return msg;
@@ -52,7 +104,12 @@ HttpMessage ClientHandler::readMessage(Socket& socket){
         contentSize = Converter<size_t>::toValue(sizeString);
       else
         return msg;
-      readFile(filename, contentSize, socket);
+      std::string received = store_.incoming();
+      bool ok = (msg.findValue("flow") == "credit") ?
+        readFileCredited(received, contentSize, socket, msg.findValue("content-encoding"), binary) :
+        readFile(received, contentSize, socket, msg.findValue("content-encoding"));
+      if (!ok || store_.add(BlobStore::ownerOf(msg), filename, received) == "")
+        FileSystem::File::remove(received);
     }
     if (filename != ""){
       msg.removeAttribute("content-length");
@@ -62,72 +119,505 @@ HttpMessage ClientHandler::readMessage(Socket& socket){
       msg.addBody(bodyString);
     }
     else{  // read message body
-      size_t numBytes = 0;
-      size_t pos = msg.findAttribute("content-length");
-      if (pos < msg.attributes().size()){
-        numBytes = Converter<size_t>::toValue(msg.attributes()[pos].second);
-        Socket::byte* buffer = new Socket::byte[numBytes + 1];
-        socket.recv(numBytes, buffer);
-        buffer[numBytes] = '\0';
-        std::string msgBody(buffer);
-        msg.addBody(msgBody);
-        delete[] buffer;}
+      readBody(msg, socket);
     }
   }
+  else if (msg.attributes()[0].first == "SYNC" || msg.attributes()[0].first == "GET" || msg.attributes()[0].first == "SEARCH" ||
+    msg.attributes()[0].first == "QUERY")
+    readBody(msg, socket);
   return msg;
 }
+//----< read content-length bytes of message body, if any >----------
+/*
+ * - bytes are received straight into the message body
+ */
+void ClientHandler::readBody(HttpMessage& msg, Socket& socket){
+  size_t pos = msg.findAttribute("content-length");
+  if (pos < msg.attributes().size()){
+    size_t numBytes = Converter<size_t>::toValue(msg.attributes()[pos].second);
+    HttpMessage::Body& body = msg.body();
+    body.resize(numBytes);
+    if (numBytes > 0 && !socket.recv(numBytes, &body[0]))
+      body.clear();
+  }
+}
 //----< read a binary file from socket and save >--------------------
 /*
  * This function expects the sender to have already send a file message, 
  * and when this function is running, continuosly send bytes until
  * fileSize bytes have been sent.
+ * - bytes are received directly into the file's write buffer
+ * - a compressed file arrives as compressed blocks, fileSize is
+ *   its original size
+ */
+bool ClientHandler::readFile(const std::string& fqname, size_t fileSize, Socket& socket, const std::string& encoding)
+{
+  if (encoding == Compression::Name)
+    return socket.recvFileCompressed(fqname, fileSize);
+  return socket.recvFile(fqname, fileSize);
+}
+//----< read a file sent against credit, a segment at a time >-------
+/*
+ * - each segment is handed to the upload writer, and a grant of its
+ *   bytes is sent once the writer takes it, so when the disk queue is
+ *   full grants wait and the client stops sending
+ * - a file that can't be created is still read, and granted, so the
+ *   connection stays in step with the client
+ * - returns once the file is written, so it is complete when announced
  */
-bool ClientHandler::readFile(const std::string& filename, size_t fileSize, Socket& socket)
+bool ClientHandler::readFileCredited(const std::string& fqname, size_t fileSize, Socket& socket, const std::string& encoding, bool binary)
 {
-  std::string fqname = "../Repository/" + filename;
-  FileSystem::File file(fqname);
-  file.open(FileSystem::File::out, FileSystem::File::binary);
-  if (!file.isGood()){
-    Show::write("\n\n  can't open file " + fqname);
-    return false;
+  UploadWriter::FilePtr file = writer_.open(fqname);
+  bool compressed = (encoding == Compression::Name);
+  bool ok = true;
+  while (fileSize > 0)
+  {
+    size_t count = (std::min)(fileSize, UploadWriter::SegmentSize);
+    std::vector<char> bytes(count);
+    if (!(compressed ? socket.recvCompressed(count, &bytes[0]) : socket.recv(count, &bytes[0])))
+    {
+      ok = false;
+      break;
+    }
+    fileSize -= count;
+    if (file)
+      writer_.write(file, std::move(bytes));
+    sendGrant(socket, count, binary);
   }
+  return writer_.close(file) && ok;
+}
+//----< give the client credit for bytes more >----------------------
 
-  const size_t BlockSize = 2048;
-  Socket::byte buffer[BlockSize];
-
-  size_t bytesToRead;
-  while (true){
-    if (fileSize > BlockSize)
-      bytesToRead = BlockSize;
-    else
-      bytesToRead = fileSize;
-
-    socket.recv(bytesToRead, buffer);
-
-    FileSystem::Block blk;
-    for (size_t i = 0; i < bytesToRead; ++i)
-      blk.push_back(buffer[i]);
+void ClientHandler::sendGrant(Socket& socket, size_t bytes, bool binary)
+{
+  HttpMessage grant;
+  grant.addAttribute(HttpMessage::attribute("CREDIT", "grant"));
+  grant.addAttribute(HttpMessage::Attribute("credit", Converter<size_t>::toString(bytes)));
+  grant.addAttribute(HttpMessage::Attribute("disk-queue", Converter<size_t>::toString(writer_.queued())));
+  std::string grantString = binary ? grant.toBinaryString() : grant.toString();
+  socket.send(grantString.size(), (Socket::byte*)grantString.c_str());
+}
+//----< answer a RESUME query with the chunks of the file we hold >--
+/*
+ * - the query gives the file's size, content hash, and chunk size, a
+ *   part of another upload of the file is started again
+ * - the reply's body is a manifest of chunk index and chunk hash
+ */
+void ClientHandler::replyResume(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::string file = msg.findValue("file");
+  size_t size = Converter<size_t>::toValue(msg.findValue("file-size"));
+  size_t chunkSize = Converter<size_t>::toValue(msg.findValue("chunk-size"));
+  PartialUploads::Chunks held = parts_.begin(file, size, msg.findValue("file-hash"), chunkSize);
+  HttpMessage::Manifest manifest;
+  for (auto& chunk : held)
+    manifest.push_back(HttpMessage::ManifestEntry(Converter<size_t>::toString(chunk.first), chunk.second));
+  std::string body = HttpMessage::manifestBody(manifest);
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("RESUME", "held"));
+  reply.addAttribute(HttpMessage::Attribute("file", file));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  reply.addBody(body);
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  if (held.size() > 0)
+    Show::write("\n\n  resuming " + file + ", " + Converter<size_t>::toString(held.size()) + " chunks held");
+}
+//----< read one CHUNK of a resumable upload, and grant it back >----
+/*
+ * - a chunk that doesn't check out is dropped, the commit reports it
+ *   missing, it is granted all the same so the client stays in step
+ */
+void ClientHandler::readChunk(HttpMessage& msg, Socket& socket, bool binary)
+{
+  size_t count = Converter<size_t>::toValue(msg.findValue("content-length"));
+  std::vector<char> bytes(count);
+  bool compressed = (msg.findValue("content-encoding") == Compression::Name);
+  if (count > 0 && !(compressed ? socket.recvCompressed(count, &bytes[0]) : socket.recv(count, &bytes[0])))
+    return;
+  size_t index = Converter<size_t>::toValue(msg.findValue("chunk"));
+  if (!parts_.put(msg.findValue("file"), index, msg.findValue("chunk-hash"), std::move(bytes)))
+    Show::write("\n\n  dropped chunk " + Converter<size_t>::toString(index) + " of " + msg.findValue("file"));
+  sendGrant(socket, count, binary);
+}
+//----< finish a resumable upload, or tell the client what's missing >--
+/*
+ * - COMMIT done once the file is renamed into place, then the upload
+ *   is announced like any other
+ * - COMMIT missing lists the chunks to send again, with no chunks the
+ *   part could not be put in place
+ */
+void ClientHandler::replyCommit(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::string file = msg.findValue("file");
+  PartialUploads::Missing missing;
+  bool done = parts_.commit(file, missing);
+  HttpMessage::Manifest manifest;
+  for (size_t index : missing)
+    manifest.push_back(HttpMessage::ManifestEntry(Converter<size_t>::toString(index), ""));
+  std::string body = HttpMessage::manifestBody(manifest);
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("COMMIT", done ? "done" : "missing"));
+  reply.addAttribute(HttpMessage::Attribute("file", file));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  reply.addBody(body);
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  if (done && store_.add(BlobStore::ownerOf(msg), file, "../Repository/" + file) != "")
+    msgQ_.enQ(uploadNotice(file));
+}
+//----< message announcing a file received by chunks >---------------
 
-    file.putBlock(blk);
-    if (fileSize < BlockSize)
-      break;
-    fileSize -= BlockSize;
+HttpMessage ClientHandler::uploadNotice(const std::string& filename)
+{
+  HttpMessage msg;
+  msg.addAttribute(HttpMessage::attribute("POST", "Message"));
+  msg.addAttribute(HttpMessage::Attribute("file", filename));
+  std::string bodyString = "<file>" + filename + "</file>";
+  msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(bodyString.size())));
+  msg.addBody(bodyString);
+  return msg;
+}
+//----< tell client which content encodings and framings we accept >---
+/*
+ * - the reply is always text, returns true if the client asked for
+ *   binary framing, which both sides use from the next message on
+ */
+bool ClientHandler::replyOptions(HttpMessage& msg, Socket& socket)
+{
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("OPTIONS", "reply"));
+  reply.addAttribute(HttpMessage::Attribute("accept-encoding", Compression::Name));
+  reply.addAttribute(HttpMessage::Attribute("accept-sync", "manifest"));
+  reply.addAttribute(HttpMessage::Attribute("accept-framing", HttpMessage::BinaryFraming));
+  reply.addAttribute(HttpMessage::Attribute("accept-ranges", "bytes, lines"));
+  reply.addAttribute(HttpMessage::Attribute("accept-credit", Converter<size_t>::toString(UploadWriter::SegmentSize)));
+  reply.addAttribute(HttpMessage::Attribute("credit-window", Converter<size_t>::toString(CreditWindow)));
+  reply.addAttribute(HttpMessage::Attribute("accept-resume", "chunks"));
+  reply.addAttribute(HttpMessage::Attribute("accept-subscribe", "pages"));
+  reply.addAttribute(HttpMessage::Attribute("accept-manifest", "pages"));
+  std::string replyString = reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  return msg.findValue("accept-framing") == HttpMessage::BinaryFraming;
+}
+//----< answer a client's manifest with the files we need >----------
+/*
+ * - the client sends a content hash for every file it would upload
+ * - a file is needed if the repository doesn't have it or holds
+ *   different content; the reply lists those with our hash, if any
+ * - a file whose content the blob store holds, e.g., uploaded for
+ *   another branch, is linked in place and isn't needed
+ */
+void ClientHandler::replySync(HttpMessage& msg, Socket& socket, bool binary)
+{
+  HttpMessage::Manifest offered = HttpMessage::parseManifest(msg.bodyString());
+  HttpMessage::Manifest needed;
+  std::string owner = BlobStore::ownerOf(msg);
+  size_t linked = 0;
+  for (auto& entry : offered)
+  {
+    std::string fqname = "../Repository/" + entry.first;
+    std::string hash = FileSystem::File::exists(fqname) ? PublishManifest::contentHash(fqname) : "";
+    if (hash == entry.second)
+      continue;
+    if (store_.link(owner, entry.first, entry.second))
+    {
+      ++linked;
+      msgQ_.enQ(uploadNotice(entry.first));
+      continue;
+    }
+    needed.push_back(HttpMessage::ManifestEntry(entry.first, hash));
+  }
+  std::string body = HttpMessage::manifestBody(needed);
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("SYNC", "needed"));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  reply.addBody(body);
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  Show::write("\n  sync: client offered " + Converter<size_t>::toString(offered.size()) +
+    " files, " + Converter<size_t>::toString(needed.size()) + " needed, " +
+    Converter<size_t>::toString(linked) + " linked to stored content");
+}
+//----< answer a FETCH with the part of the file it asks for >-------
+/*
+ * - chunk-size, if given, is bounded so one chunk can't be made to
+ *   hold a whole large file in memory
+ */
+void ClientHandler::replyFetch(HttpMessage& msg, Socket& socket, bool binary)
+{
+  size_t chunkSize = MsgClientFromServer::FetchChunkSize;
+  std::string sizeString = msg.findValue("chunk-size");
+  if (sizeString != "")
+    chunkSize = (std::min)((std::max)(Converter<size_t>::toValue(sizeString), (size_t)1024), (size_t)(4 * 1024 * 1024));
+  publisher_.sendRange(socket, msg.findValue("file"), msg.findValue("range"), chunkSize, binary, msg.findValue("if-none-match"));
+}
+//----< answer a SEARCH with the lines and symbols matching its body >---
+/*
+ * - "SEARCH: text" finds the body as a substring, "SEARCH: regex" as an
+ *   ECMAScript regex, ignore-case: yes for either, limit bounds the hits
+ * - the reply's body has a line for each hit, its file and line, then
+ *   the symbol's name and kind, or "" and the matching text, tab separated
+ * - files are those the analyzer's search.index holds, see SearchIndex,
+ *   only files holding the query's trigrams are read
+ * - a regex that doesn't compile gets a SEARCH invalid message
+ */
+void ClientHandler::replySearch(HttpMessage& msg, Socket& socket, bool binary)
+{
+  SearchIndex::Query query;
+  query.text = msg.bodyString();
+  query.regex = (msg.findValue("SEARCH") == "regex");
+  query.ignoreCase = (msg.findValue("ignore-case") == "yes");
+  std::string limitString = msg.findValue("limit");
+  if (limitString != "")
+    query.limit = (std::min)((std::max)(Converter<size_t>::toValue(limitString), (size_t)1), SearchLimit);
+  auto start = std::chrono::steady_clock::now();
+  SearchIndex::Hits hits;
+  bool ok = MsgClientFromServer::searchIndex().search(query, hits);
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  std::string body;
+  for (auto& hit : hits)
+    body += hit.file + "\t" + Converter<size_t>::toString(hit.line) + "\t" + hit.symbol + "\t" + hit.text + "\n";
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("SEARCH", ok ? "results" : "invalid"));
+  reply.addAttribute(HttpMessage::Attribute("count", Converter<size_t>::toString(hits.size())));
+  reply.addAttribute(HttpMessage::Attribute("truncated", hits.size() < query.limit ? "no" : "yes"));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  reply.addBody(body);
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  std::ostringstream out;
+  out << "\n  search for " << query.text << ": " << hits.size() << " hits in " << ms << " ms";
+  Show::write(out.str());
+}
+//----< answer a QUERY with the dependency elements reached from its body's files >---
+/*
+ * - "QUERY: dependencies" walks to the files each file depends on,
+ *   "QUERY: dependents" to the files depending on it, depth bounds the
+ *   links walked, 1 if not given, 0 for no limit
+ * - files are named as pages are, e.g., Parser/Parser.cpp, one a line
+ * - the reply's body is an ElementCodec encoding of the elements, see
+ *   DependencyReader, with their count, and truncated: yes if it holds
+ *   only the first DependencyReader::ElementLimit
+ * - a body longer than QueryFilesLimit, or another QUERY, gets a QUERY
+ *   invalid message
+ */
+void ClientHandler::replyQuery(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::string kind = msg.findValue("QUERY");
+  std::string body = msg.bodyString();
+  bool ok = (kind == "dependencies" || kind == "dependents") && body.size() <= QueryFilesLimit;
+  DependencyReader::Query query;
+  query.dependents = (kind == "dependents");
+  std::string depthString = msg.findValue("depth");
+  if (depthString != "")
+    query.depth = Converter<size_t>::toValue(depthString);
+  std::istringstream files(ok ? body : "");
+  std::string file;
+  while (std::getline(files, file))
+  {
+    if (file.size() > 0 && file.back() == '\r')
+      file.pop_back();
+    if (file != "")
+      query.files.push_back(file);
+  }
+  auto start = std::chrono::steady_clock::now();
+  std::string encoded;
+  bool truncated = false;
+  size_t count = ok ? MsgClientFromServer::dependencies().query(query, encoded, truncated) : 0;
+  double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("QUERY", ok ? "elements" : "invalid"));
+  reply.addAttribute(HttpMessage::Attribute("count", Converter<size_t>::toString(count)));
+  reply.addAttribute(HttpMessage::Attribute("truncated", truncated ? "yes" : "no"));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(encoded.size())));
+  reply.addBody(encoded);
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+  std::ostringstream out;
+  out << "\n  " << kind << " of " << query.files.size() << " files: " << count << " elements, "
+    << encoded.size() << " bytes in " << ms << " ms";
+  Show::write(out.str());
+}
+//----< tell the sender its POST is read, and its file stored >-----
+/*
+ * - sent for a POST with ack: yes, so a client can time each message
+ *   and upload to the point the server has taken it
+ */
+void ClientHandler::replyAck(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::string file = msg.findValue("file");
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("ACK", file != "" ? "file" : "message"));
+  if (file != "")
+    reply.addAttribute(HttpMessage::Attribute("file", file));
+  std::string replyString = binary ? reply.toBinaryString() : reply.toString();
+  socket.send(replyString.size(), (Socket::byte*)replyString.c_str());
+}
+//----< answer a MANIFEST with every published page and its etag >---
+/*
+ * - the body is a manifest, see HttpMessage::manifestBody, of the pages
+ *   and shared assets, so a client's cache fetches only those it holds
+ *   with another etag
+ * - etags come from the page cache, which reads only pages that changed
+ *   since it last hashed them, packed pages' from the pack's index
+ */
+void ClientHandler::replyManifest(Socket& socket, bool binary)
+{
+  HttpMessage::Manifest manifest;
+  PageCache& pages = MsgClientFromServer::pages();
+  std::vector<std::string> files = MsgClientFromServer::publishedPages();
+  for (auto& asset : FileSystem::Directory::getFiles("../Repository/assets/", "*.*"))
+    files.push_back("assets/" + asset);
+  for (auto& file : files)
+  {
+    std::string etag = pages.etag(file);
+    if (etag != "")
+      manifest.push_back(HttpMessage::ManifestEntry(file, etag));
+  }
+  std::string body = HttpMessage::manifestBody(manifest);
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("MANIFEST", "pages"));
+  reply.addAttribute(HttpMessage::Attribute("pages", Converter<size_t>::toString(manifest.size())));
+  reply.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(body.size())));
+  reply.addBody(body);
+  std::string head;
+  socket.sendBuffers(reply.toBuffers(head, binary));
+}
+//----< answer a SUBSCRIBE, then hand the connection to the notifier >---
+/*
+ * - the body is a path prefix per line, none subscribes to every page
+ * - the connection then carries only NOTIFY messages, see PageNotifier,
+ *   so this handler's thread goes back to the pool
+ */
+void ClientHandler::subscribe(HttpMessage& msg, Socket& socket, bool binary)
+{
+  std::vector<std::string> prefixes;
+  std::istringstream body(msg.bodyString());
+  std::string line;
+  while (std::getline(body, line))
+  {
+    if (line.size() > 0 && line.back() == '\r')
+      line.pop_back();
+    if (line != "")
+      prefixes.push_back(line);
   }
-  file.close();
-  return true;
+  HttpMessage reply;
+  reply.addAttribute(HttpMessage::attribute("SUBSCRIBE", "ok"));
+  reply.addAttribute(HttpMessage::Attribute("prefixes", Converter<size_t>::toString(prefixes.size())));
+  std::string head;
+  if (!socket.sendBuffers(reply.toBuffers(head, binary)))
+    return;
+  Show::write("\n\n  client subscribed to " + (prefixes.empty() ? std::string("every page") :
+    Converter<size_t>::toString(prefixes.size()) + " path prefixes"));
+  MsgClientFromServer::notifier().subscribe(std::move(socket), prefixes, binary);
 }
 //----< receiver functionality is defined by this function >---------
-
+/*
+ * - a GET message is answered on this connection with the published
+ *   files, so clients don't need to listen for a reverse connection,
+ *   a GET with an if-none-match manifest only with those that changed
+ * - an OPTIONS message is answered with the encodings we accept, and
+ *   files are compressed for a GET that accepts our encoding
+ * - a SYNC message is answered with the files the client should send
+ * - a FETCH message is answered with a range of one file, in chunks
+ * - a SEARCH message is answered with the matching lines and symbols
+ * - a QUERY message is answered with the dependency elements it asks for
+ * - framing is per connection, text until OPTIONS agrees on binary
+ * - a file POSTed with flow: credit is read a segment at a time and
+ *   each segment granted back, see readFileCredited
+ * - RESUME, CHUNK, and COMMIT messages upload a file by chunks that
+ *   survive a dropped connection, see PartialUploads
+ * - a browser's HTTP/1.1 request is answered with a published page, and
+ *   the connection kept while it is busy, see StaticHttp
+ * - a POST with ack: yes is answered with an ACK once it's read and its
+ *   file, if any, stored, then queued as any other
+ * - a MANIFEST message is answered with every page's name and etag
+ * - a SUBSCRIBE message is answered, then the connection is given to the
+ *   PageNotifier, which pushes a NOTIFY for each page published after it
+ */
 void ClientHandler::operator()(Socket socket){
+  Utilities::Trace::instance().nameThread("client handler");
+  bool binary = false;
+  size_t httpRequests = 0;
   while (true)
   {
-    HttpMessage msg = readMessage(socket);
+    if (httpRequests > 0 && !http_.waitForRequest(socket))
+      break;
+    HttpMessage msg = readMessage(socket, binary);
     if (connectionClosed_ || msg.bodyString() == "quit")
     {
       Show::write("\n\n  clienthandler thread is terminating");
       break;
     }
-    msgQ_.enQ(msg);
+    if (msg.attributes()[0].first == "HTTP")
+    {
+      if (!http_.serve(msg, socket, ++httpRequests))
+        break;
+      continue;
+    }
+    if (msg.attributes()[0].first == "OPTIONS")
+    {
+      binary = replyOptions(msg, socket);
+      continue;
+    }
+    if (msg.attributes()[0].first == "SYNC")
+    {
+      replySync(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "FETCH")
+    {
+      replyFetch(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "SEARCH")
+    {
+      replySearch(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "QUERY")
+    {
+      replyQuery(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "MANIFEST")
+    {
+      replyManifest(socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "SUBSCRIBE")
+    {
+      subscribe(msg, socket, binary);
+      break;
+    }
+    if (msg.attributes()[0].first == "RESUME")
+    {
+      replyResume(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "CHUNK")
+    {
+      readChunk(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "COMMIT")
+    {
+      replyCommit(msg, socket, binary);
+      continue;
+    }
+    if (msg.attributes()[0].first == "GET")
+    {
+      bool compress = msg.findValue("accept-encoding").find(Compression::Name) != std::string::npos;
+      HttpMessage::Manifest held;
+      if (msg.findValue("if-none-match") == "manifest")
+        held = HttpMessage::parseManifest(msg.bodyString());
+      publisher_.sendPublished(socket, compress, binary, held, msg.findValue("accept-patch") == "lines");
+      continue;
+    }
+    if (msg.attributes()[0].first == "POST" && msg.findValue("ack") == "yes")
+      replyAck(msg, socket, binary);
+    msgQ_.enQ(std::move(msg));
   }
 }
 
@@ -160,41 +650,279 @@ HttpMessage MsgClientFromServer::makeMessage(size_t n, const std::string& body,
 	return msg;
 }
 
+//----< pages sent by every connection's publisher >-----------------
+
+PageCache& MsgClientFromServer::pages()
+{
+	static PageCache cache("../Repository/", PageCache::DefaultBudget, &packs(), &generations());
+	return cache;
+}
+//----< notifier of published pages, shared by all connections >---
+/*
+ * - lists the published pages with the page cache's etags
+ */
+PageNotifier& MsgClientFromServer::notifier()
+{
+	static PageNotifier notifier([] {
+		PageNotifier::Etags etags;
+		for (auto& file : publishedPages()) {
+			PageCache::PagePtr page = pages().get(file);
+			if (page)
+				etags[file] = page->etag;
+		}
+		return etags;
+	});
+	return notifier;
+}
+//----< the analyzer's page pack, mapped, shared by all connections >--
+
+PackReader& MsgClientFromServer::packs()
+{
+	static PackReader reader("../Repository/");
+	return reader;
+}
+//----< the analyzer's committed page generation, shared by all connections >--
+
+GenerationReader& MsgClientFromServer::generations()
+{
+	static GenerationReader reader("../Repository/");
+	return reader;
+}
+//----< the analyzer's search index, shared by all connections >---
+
+SearchReader& MsgClientFromServer::searchIndex()
+{
+	static SearchReader reader("../Repository/");
+	return reader;
+}
+//----< the analyzer's dependency snapshot, shared by all connections >---
+
+DependencyReader& MsgClientFromServer::dependencies()
+{
+	static DependencyReader reader("../Repository/");
+	return reader;
+}
+//----< html pages to send: Repository files, packed and committed pages >--
+
+std::vector<std::string> MsgClientFromServer::publishedPages()
+{
+	std::vector<std::string> files = FileSystem::Directory::getFiles("../Repository/", "*.html");
+	std::vector<std::string> packed = packs().names(".html");
+	std::vector<std::string> staged = generations().names(".html");
+	if (packed.empty() && staged.empty())
+		return files;
+	files.insert(files.end(), packed.begin(), packed.end());
+	files.insert(files.end(), staged.begin(), staged.end());
+	std::sort(files.begin(), files.end());
+	files.erase(std::unique(files.begin(), files.end()), files.end());
+	return files;
+}
+
 //Method to  send files when client is listening
-bool MsgClientFromServer::sendFile(const std::string& filename, Socket& socket){
-	std::string fqname = "../Repository/" + filename;
-	FileSystem::FileInfo fi(fqname);
-	size_t fileSize = fi.size();
-	std::string sizeString = Converter<size_t>::toString(fileSize);
-	FileSystem::File file(fqname);
-	file.open(FileSystem::File::in, FileSystem::File::binary);
-	if (!file.isGood())
+/*
+ * - shared assets under assets/ are named by content hash, so their
+ *   content never changes and clients may cache them for a year
+ * - compressed files keep their original content-length
+ * - the file is sent from the page cache, with its etag
+ * - an uncompressed page is the message's shared body, sent with its
+ *   header in one vectored send, so sending a page to many clients
+ *   never copies it
+ * - held is the etag of the copy the client has, if the page cache
+ *   still has that version and its PageDiff patch is smaller than the
+ *   page, the patch is sent, with patch: held, instead
+ */
+bool MsgClientFromServer::sendFile(const std::string& filename, Socket& socket, bool compress, bool binary, const std::string& held){
+	PageCache::PagePtr page = pages().get(filename);
+	if (!page)
 		return false;
+	if (held != "" && held != page->etag && sendPatch(filename, page, held, socket, compress, binary))
+		return true;
+	size_t fileSize = page->bytes.size();
 
 	HttpMessage msg = makeMessage(1, "", "localhost::8085"); //8085 acts as server from client side 
 	msg.addAttribute(HttpMessage::Attribute("file", filename));
-	msg.addAttribute(HttpMessage::Attribute("content-length", sizeString));
-	sendMessage(msg, socket);
-	const size_t BlockSize = 2048;
-	Socket::byte buffer[BlockSize];
-	while (true)
-	{
-		FileSystem::Block blk = file.getBlock(BlockSize);
-		if (blk.size() == 0)
-			break;
-		for (size_t i = 0; i < blk.size(); ++i)
-			buffer[i] = blk[i];
-		socket.send(blk.size(), buffer);
-		if (!file.isGood())
-			break;
+	msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(fileSize)));
+	msg.addAttribute(HttpMessage::Attribute("etag", page->etag));
+	if (filename.find("assets/") == 0)
+		msg.addAttribute(HttpMessage::Attribute("Cache-Control", "public, max-age=31536000, immutable"));
+	if (compress)
+		msg.addAttribute(HttpMessage::Attribute("content-encoding", Compression::Name));
+	if (!compress) {
+		msg.shareBody(HttpMessage::SharedBytes(page, &page->bytes));
+		return sendMessage(msg, socket, binary);
 	}
-	file.close();
-	return true;
+	if (!sendMessage(msg, socket, binary))
+		return false;
+	return fileSize == 0 || socket.sendCompressed(fileSize, page->bytes.data());
+}
+//----< send the patch from the held version of page to page, false if it's no smaller >---
+/*
+ * - false, with nothing sent, when the held version isn't in the cache
+ */
+bool MsgClientFromServer::sendPatch(const std::string& filename, const PageCache::PagePtr& page, const std::string& held,
+	Socket& socket, bool compress, bool binary){
+	PageCache::PagePtr base = pages().previous(filename, held);
+	if (!base)
+		return false;
+	std::string patch = PageDiff::make(base->bytes, page->bytes);
+	if (patch.size() >= page->bytes.size())
+		return false;
+	HttpMessage msg = makeMessage(1, "", "localhost::8085");
+	msg.addAttribute(HttpMessage::Attribute("file", filename));
+	msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(patch.size())));
+	msg.addAttribute(HttpMessage::Attribute("etag", page->etag));
+	msg.addAttribute(HttpMessage::Attribute("patch", held));
+	Show::write("\n  " + Converter<size_t>::toString(patch.size()) + " byte patch instead of " +
+		Converter<size_t>::toString(page->bytes.size()) + " bytes");
+	if (compress)
+		msg.addAttribute(HttpMessage::Attribute("content-encoding", Compression::Name));
+	else {
+		msg.addBody(patch);
+		return sendMessage(msg, socket, binary);
+	}
+	return sendMessage(msg, socket, binary) && (patch.size() == 0 || socket.sendCompressed(patch.size(), patch.data()));
+}
+//----< send header and body, text or binary, in one vectored send >---
+
+bool MsgClientFromServer::sendMessage(HttpMessage& msg, Socket& socket, bool binary)
+{
+	std::string head;
+	return socket.sendBuffers(msg.toBuffers(head, binary));
+}
+//----< send published html files and shared assets, then quit >-----
+/*
+ * - used on a reverse connection by execute, and on a client's own
+ *   connection in answer to its GET message
+ * - held lists the files and etags the client already has, files it
+ *   holds with the current etag are skipped
+ * - with patches, files it holds with an older etag may be sent as
+ *   patches to its copies, see sendFile
+ */
+bool MsgClientFromServer::sendPublished(Socket& socket, bool compress, bool binary, const HttpMessage::Manifest& held, bool patches){
+	bool ok = true;
+	std::unordered_map<std::string, std::string> etags(held.begin(), held.end());
+	size_t unchanged = 0;
+	auto send = [&](const std::string& file, const std::string& what) {
+		auto iter = etags.find(file);
+		if (iter != etags.end() && pages().etag(file) == iter->second) {
+			++unchanged;
+			return;
+		}
+		Show::write("\n\n  sending " + what + file);
+		ok = sendFile(file, socket, compress, binary, (patches && iter != etags.end()) ? iter->second : "") && ok;
+	};
+	std::vector<std::string> files = publishedPages();
+	for (size_t i = 0; i < files.size(); ++i)
+		send(files[i], "file ");
+	std::vector<std::string> assets = FileSystem::Directory::getFiles("../Repository/assets/", "*.*");
+	for (size_t i = 0; i < assets.size(); ++i)
+		send("assets/" + assets[i], "shared asset ");
+	if (held.size() > 0)
+		Show::write("\n\n  " + Converter<size_t>::toString(unchanged) + " files not modified since the client got them");
+	HttpMessage msg = makeMessage(1, "quit", "toAddr:localhost:8084");
+	sendMessage(msg, socket, binary);
+	Show::write("\n\n  server sent\n" + msg.toIndentedString());
+	return ok;
 }
-void MsgClientFromServer::sendMessage(HttpMessage& msg, Socket& socket)
+//----< send html pages not sent yet, or changed since, while publishing >---
+/*
+ * - sent maps each page sent to its etag then
+ * - a page still being written may be sent part done, its stamp then
+ *   moves, so a later pass, or the batch's sendPublished, sends it again
+ */
+size_t MsgClientFromServer::sendChangedPages(Socket& socket, std::unordered_map<std::string, std::string>& sent){
+	size_t count = 0;
+	std::vector<std::string> files = publishedPages();
+	for (size_t i = 0; i < files.size(); ++i){
+		PageCache::PagePtr page = pages().get(files[i]);
+		auto iter = sent.find(files[i]);
+		if (!page || (iter != sent.end() && iter->second == page->etag))
+			continue;
+		Show::write("\n\n  sending finished page " + files[i]);
+		if (sendFile(files[i], socket)){
+			sent[files[i]] = page->etag;
+			++count;
+		}
+	}
+	return count;
+}
+//----< byte offsets where firstLine and the line after lastLine start >---
+/*
+ * - lines count from 1, scanning stops at the end of lastLine, so the
+ *   first screen of a large page is found without searching all of it
+ */
+static void lineBounds(const std::string& bytes, size_t firstLine, size_t lastLine, size_t& begin, size_t& end)
 {
-	std::string msgString = msg.toString();
-	socket.send(msgString.size(), (Socket::byte*)msgString.c_str());
+	size_t total = bytes.size();
+	begin = (firstLine <= 1) ? 0 : total;
+	end = total;
+	size_t line = 1;
+	for (size_t i = bytes.find('\n'); i != std::string::npos && line <= lastLine; i = bytes.find('\n', i + 1)) {
+		++line;
+		if (line == firstLine)
+			begin = i + 1;
+		else if (line == lastLine + 1)
+			end = i + 1;
+	}
+	begin = (std::min)(begin, end);
+}
+//----< send part of a published file in chunks, for FETCH >---------
+/*
+ * - range is "bytes=first-last" or "lines=first-last", lines count
+ *   from 1, without last it runs to the end of the file, without a
+ *   range the whole file is sent
+ * - each chunk is a FETCH chunk message whose content-range gives its
+ *   bytes and the file's size, the last one has final: yes, so a
+ *   viewer can show the first chunk while the rest arrive
+ * - a file that isn't there, or a name outside the repository, gets a
+ *   FETCH missing message
+ * - chunks carry the page's etag, a whole page asked for with the
+ *   etag it has now as ifNoneMatch gets a FETCH not-modified message
+ */
+bool MsgClientFromServer::sendRange(Socket& socket, const std::string& filename, const std::string& range, size_t chunkSize, bool binary, const std::string& ifNoneMatch){
+	PageCache::PagePtr page = pages().get(filename);
+	if (!page || (range == "" && ifNoneMatch == page->etag)) {
+		HttpMessage msg;
+		msg.addAttribute(HttpMessage::attribute("FETCH", page ? "not-modified" : "missing"));
+		msg.addAttribute(HttpMessage::Attribute("file", filename));
+		if (page)
+			msg.addAttribute(HttpMessage::Attribute("etag", page->etag));
+		sendMessage(msg, socket, binary);
+		return page != nullptr;
+	}
+	const std::string& bytes = page->bytes;
+	size_t total = bytes.size();
+	std::string unit = "bytes";
+	size_t first = 0, last = HttpMessage::NoLimit;
+	if (range != "" && !HttpMessage::parseRange(range, unit, first, last)) {
+		unit = "bytes";
+		first = 0;
+		last = HttpMessage::NoLimit;
+	}
+	size_t begin, end;
+	if (unit == "lines")
+		lineBounds(bytes, first, last, begin, end);
+	else {
+		end = (last == HttpMessage::NoLimit) ? total : (std::min)(last + 1, total);
+		begin = (std::min)(first, end);
+	}
+	if (chunkSize == 0)
+		chunkSize = FetchChunkSize;
+	size_t pos = begin;
+	do {
+		size_t count = (std::min)(chunkSize, end - pos);
+		HttpMessage msg;
+		msg.addAttribute(HttpMessage::attribute("FETCH", "chunk"));
+		msg.addAttribute(HttpMessage::Attribute("file", filename));
+		msg.addAttribute(HttpMessage::Attribute("etag", page->etag));
+		msg.addAttribute(HttpMessage::Attribute("content-range", HttpMessage::contentRange("bytes", pos, count, total)));
+		msg.addAttribute(HttpMessage::Attribute("content-length", Converter<size_t>::toString(count)));
+		pos += count;
+		msg.addAttribute(HttpMessage::Attribute("final", pos < end ? "no" : "yes"));
+		msg.shareBody(HttpMessage::SharedBytes(page, &page->bytes), pos - count, count);
+		sendMessage(msg, socket, binary);
+	} while (pos < end);
+	return true;
 }
 ////Method where execution of sending files when client is listening
 void MsgClientFromServer::execute(const size_t TimeBetweenMessages, const size_t NumMessages){
@@ -203,6 +931,7 @@ void MsgClientFromServer::execute(const size_t TimeBetweenMessages, const size_t
 	Show::title(
 		"Starting HttpMessage From Server to client on thread " + Utilities::Converter<std::thread::id>::toString(std::this_thread::get_id())
 	);
+	size_t seen = notifier().events();   // taken before connecting so an early raise is kept
 	try{
 		SocketSystem ss;
 		SocketConnecter si;
@@ -211,22 +940,14 @@ void MsgClientFromServer::execute(const size_t TimeBetweenMessages, const size_t
 			::Sleep(100);
 		}
 
-		HttpMessage msg;
-		for (int i = 0; i < 10000; i++) {
-			for (int j = 0; j < 10000; j++) {
-				for (int k = 0; k < 15; k++) {
-
-				}
-			}
-		}
-		std::vector<std::string> files = FileSystem::Directory::getFiles("../Repository/", "*.html");
-		for (size_t i = 0; i < files.size(); ++i){
-			Show::write("\n\n  sending file " + files[i]);
-			sendFile(files[i], si);
-		}
-		msg = makeMessage(1, "quit", "toAddr:localhost:8084");
-		sendMessage(msg, si);
-		Show::write("\n\n  client sent\n" + msg.toIndentedString());
+		// pages go out as the analyzer writes them, the rest when the batch is done
+		std::unordered_map<std::string, std::string> sent;
+		PublishSignal::Event event;
+		while ((event = notifier().waitAny(seen, PublishWaitMs)) == PublishSignal::Page)
+			sendChangedPages(si, sent);   // one look at the repository covers every page signaled so far
+		if (event == PublishSignal::None)
+			Show::write("\n  no publish batch finished in time, sending current files");
+		sendPublished(si, false, false, HttpMessage::Manifest(sent.begin(), sent.end()));
 		Show::write("\n");
 		Show::write("\n  All done ");
 	}
@@ -237,27 +958,109 @@ void MsgClientFromServer::execute(const size_t TimeBetweenMessages, const size_t
 	}
 }
 
-//----< test stub >--------------------------------------------------
+//----< log each command's count and latencies >--------------------
+/*
+ * - while tracing, also writes every span recorded so far
+ */
 
-int main(){
+static void showDispatchStats(MsgDispatcher& dispatcher)
+{
+  MsgDispatcher::StatsMap stats = dispatcher.stats();
+  Show::write("\n\n  dispatched messages:");
+  for (auto& item : stats)
+  {
+    const MsgDispatcher::Stats& s = item.second;
+    std::ostringstream out;
+    out << "\n    " << item.first << ": " << s.calls << " handled, " << s.failed << " failed, wait "
+      << (s.calls > 0 ? s.waitMs / s.calls : 0.0) << " ms mean " << s.maxWaitMs << " ms max, run "
+      << (s.calls > 0 ? s.runMs / s.calls : 0.0) << " ms mean " << s.maxRunMs << " ms max";
+    Show::write(out.str());
+  }
+  const char* laneNames[MsgDispatcher::NumLanes] = { "quick", "long" };
+  for (size_t lane = 0; lane < MsgDispatcher::NumLanes; ++lane)
+  {
+    MsgDispatcher::Depths depths = dispatcher.depths(static_cast<MsgDispatcher::Lane>(lane));
+    for (size_t priority = 0; priority < depths.size(); ++priority)
+    {
+      const Async::QueueDepth& d = depths[priority];
+      std::ostringstream out;
+      out << "\n    " << laneNames[lane] << " lane, " << MsgDispatcher::priorityName(static_cast<MsgDispatcher::Priority>(priority))
+        << ": " << d.queued << " queued, " << d.highWater << " at most, " << d.taken << " started, " << d.promoted << " ahead of their turn";
+      Show::write(out.str());
+    }
+  }
+  PageNotifier::Stats notices = MsgClientFromServer::notifier().stats();
+  std::ostringstream out;
+  out << "\n    page notices: " << notices.subscribers << " subscribers, " << notices.subscribed << " since start, "
+    << notices.notices << " notices sent, " << notices.dropped << " subscribers dropped";
+  Show::write(out.str());
+  Utilities::Trace& trace = Utilities::Trace::instance();
+  if (trace.enabled())
+  {
+    bool ok = trace.writeChromeJson("MsgServer.trace.json", "MsgServer", 2);
+    Show::write(std::string("\n    ") + (ok ? "wrote" : "couldn't write") + " MsgServer.trace.json");
+  }
+}
+//----< handlers for messages ClientHandlers queue >-----------------
+/*
+ * - publish connects back to the client and sends pages as the analyzer
+ *   writes them, which can take minutes, so it runs in the long lane
+ * - uploads come in bursts of thousands from a push, so they are bulk,
+ *   behind messages and stats requests, and ahead of republishing
+ */
+static void registerHandlers(MsgDispatcher& dispatcher)
+{
+  dispatcher.on("upload", [](HttpMessage& msg) {
+    Show::write("\n\n  server received file " + msg.findValue("file"));
+  }, MsgDispatcher::Quick, MsgDispatcher::Bulk);
+  dispatcher.on("message", [](HttpMessage& msg) {
+    Show::write("\n\n  server recvd message contents:\n" + msg.bodyString());
+  });
+  dispatcher.on("stats", [&dispatcher](HttpMessage&) { showDispatchStats(dispatcher); });
+  dispatcher.on("publish", [](HttpMessage&) {
+    MsgClientFromServer publisher;
+    publisher.execute(0, 0);
+  }, MsgDispatcher::Long, MsgDispatcher::Background);
+  dispatcher.onUnhandled([](HttpMessage& msg) {
+    Show::write("\n\n  no handler for command " + MsgDispatcher::commandOf(msg));
+  });
+}
+
+//----< test stub >--------------------------------------------------
+/*
+ * - with /e every thread records Trace spans, and each stats message
+ *   writes them, pid 2 so they load beside the analyzer's trace.json
+ */
+int main(int argc, char* argv[]){
+  Show::attach(&std::cout);
+  Show::start();
+  for (int i = 1; i < argc; ++i)
+  {
+    if (std::string(argv[i]) == "/e")
+      Utilities::Trace::instance().enable();
+  }
+  Utilities::Trace::instance().nameThread("dispatcher");
   BlockingQueue<HttpMessage> msgQ;
+  MsgDispatcher dispatcher;
+  registerHandlers(dispatcher);
+  dispatcher.start();
   try{
     SocketSystem ss;
     SocketListener sl(8080, Socket::IP6);
-    ClientHandler cp(msgQ);
+    UploadWriter writer;
+    PartialUploads parts("../Repository/", writer);
+    BlobStore store("../Repository/");
+    StaticHttp http("../Repository/", &MsgClientFromServer::packs(), &MsgClientFromServer::generations());
+    ClientHandler cp(msgQ, writer, parts, store, http);
+    MsgClientFromServer::notifier().start();   // before clients subscribe, so no signal is missed
+    sl.usePool(16, 64);   // bounded workers, so many pushing clients don't each get a thread
     sl.start(cp);
 	
-	MsgClientFromServer c1;
-	std::thread t1(
-		[&]() { c1.execute(100, 20); } 
-	);
+    // published files go back to clients on their own connections,
+    // in answer to GET messages, so no reverse connection is made here
 
-	t1.join();
-	
-    while (true){
-      HttpMessage msg = msgQ.deQ();
-	  std::cout << "\n\n  server recvd message contents:\n" + msg.bodyString();
-    }
+    while (true)
+      dispatcher.dispatch(msgQ.deQ());
   }
   catch (std::exception& exc){
     std::string exMsg = "\n  " + std::string(exc.what()) + "\n\n";
@@ -14,12 +14,64 @@
 *
 * It also Listens on port 8080 and acts as a server and it receives files send from clients
 * publishes the html files based on dependencies using HTTP Style messages and files
+* A client that sends a "GET published" message gets the published html files and
+* shared assets back on the same connection, followed by a "quit" message
+* A client that sends a "SYNC manifest" message with the content hash of each file it
+* has gets back the names of the files the Repository is missing or holds changed
+* A client that asks for binary framing in its OPTIONS message, and every message after it
+* on that connection, uses length prefixed binary headers instead of text lines
+* A client that sends a "FETCH page" message naming a file, and optionally a byte or line
+* range, gets just that part back in FETCH chunk messages, each with a content-range
+* Pages are sent from a PageCache, with an etag, their content hash.  A FETCH whose
+* if-none-match is the page's etag gets a FETCH not-modified message instead of the
+* page, and a GET whose body is a manifest of the etags a client holds gets only the
+* pages that changed
+* Messages ClientHandlers don't answer themselves, e.g., upload notifications,
+* are routed by command to handlers a MsgDispatcher runs on its worker lanes, where
+* interactive messages go ahead of bulk uploads, and uploads ahead of republishing
+* A client told credit-window in the OPTIONS reply sends files in segments, no more
+* than the window ahead of the CREDIT grants the server sends as an UploadWriter,
+* shared by every connection, takes each segment to write, so uploads pause while
+* the disk queue is full instead of growing the server's memory
+* A client told accept-resume: chunks sends files as RESUME, CHUNK, and COMMIT
+* messages, PartialUploads keeps the chunks written and a checkpoint of them on
+* disk, so an upload broken off resumes with the chunks the server doesn't hold
+* Uploads are kept by a BlobStore, once for each distinct content, the names
+* clients and branches upload are hard links to blobs named by content hash, and
+* a SYNC offering content already stored links the name without an upload
+* Browsers are answered on the same port: StaticHttp serves the published pages,
+* CSS, and JS for HTTP/1.1 GET and HEAD, with keep-alive, Content-Length, ETags
+* for conditional GETs, and bodies sent with TransmitFile
+* Pages the analyzer publishes into its PagePack, pages.index, are listed from the
+* index, not by scanning the Repository, and sent from the pack, mapped by packs()
+* Pages of the generation the analyzer last committed, generations/N, are listed
+* and sent through generations(), so a publish in progress isn't seen until it's done
+* A client that sends a "SEARCH text" or "SEARCH regex" message gets the lines and
+* symbols matching its body, found from the analyzer's trigram index, search.index,
+* through searchIndex(), so only the files that can match are read
+* A POST message or file carrying ack: yes is answered with an ACK message once it
+* is read, and its file stored, so load tests can time each one
+* A client that sends a "MANIFEST pages" message gets back every published page and
+* shared asset with its etag, from the page cache's etags, so a client holding a
+* persistent cache of pages fetches only those whose etag changed
+* A client that sends a "SUBSCRIBE pages" message, its body path prefixes, gets an
+* answer and then a NOTIFY message naming each page, and its etag, as the analyzer
+* publishes it, or removes it.  The connection is kept by a PageNotifier, so GUIs
+* fetch only the pages they show, when they change, instead of a push of all pages
+* A GET with accept-patch: lines, whose manifest holds a page with an etag the page
+* cache still has the last version of, gets a PageDiff patch from that version, with
+* patch: its etag, when the patch is smaller than the page
+* A client that sends a "QUERY dependencies" or "QUERY dependents" message, its body
+* a file per line, gets the dependency elements reached from them within depth links,
+* from the analyzer's deps.snapshot through dependencies(), as one ElementCodec body
 *
 *
 * Public Interface
 * --------------------
 *  using EndPoint = std::string;                                               //variable to act as end pont
 *  void execute(const size_t TimeBetweenMessages, const size_t NumMessages);   //function used to send required files to destination
+*  bool sendPublished(Socket& socket, bool compress, bool binary, held, patches); //send published files the client doesn't hold, then quit
+*  bool sendRange(Socket& socket, file, range, chunkSize, binary, etag);       //send a range of a published file in chunks
 *
 *
 *
@@ -28,10 +80,21 @@
 *   -MsgClient.cpp, MsgServer.cpp
 *   HttpMessage.h, HttpMessage.cpp
 *   Cpp11-BlockingQueue.h
+*   PublishSignal.h, PublishManifest.h, PublishManifest.cpp
+*   PageCache.h, PageCache.cpp, PageDiff.h, PageDiff.cpp
+*   PagePack.h, PagePack.cpp, PageGenerations.h, PageGenerations.cpp
+*   SearchIndex.h, SearchIndex.cpp
+*   DependencyQuery.h, DependencyQuery.cpp, ElementCodec.h, Snapshot.h, NoSqlDb.h
+*   PageNotifier.h, PageNotifier.cpp
+*   MsgDispatcher.h, MsgDispatcher.cpp
+*   UploadWriter.h, UploadWriter.cpp
+*   PartialUploads.h, PartialUploads.cpp
+*   BlobStore.h, BlobStore.cpp
+*   StaticHttp.h, StaticHttp.cpp
 *   Sockets.h, Sockets.cpp
 *   FileSystem.h, FileSystem.cpp
 *   Logger.h, Logger.cpp
-*   Utilities.h, Utilities.cpp
+*   Utilities.h, Utilities.cpp, Trace.h
 
 * Build Process:
 * --------------
@@ -39,6 +102,76 @@
 *
 * Maintenance History:
 * --------------------
+* Ver 1.21 : 14 Oct 2026
+* - answers QUERY messages with dependency subgraphs, binary encoded with ElementCodec
+* Ver 1.20 : 14 Oct 2026
+* - pages a client holds an older version of are sent as line patches when smaller
+* Ver 1.19 : 14 Oct 2026
+* - answers MANIFEST with the etag of every page, and GET manifests are compared with
+*   PageCache::etag, so pages a client holds aren't read to be hashed again
+* Ver 1.18 : 14 Oct 2026
+* - answers SUBSCRIBE, a PageNotifier then pushes a NOTIFY per page published, and is
+*   the one waiter on PublishSignal, the reverse push waits on the notifier instead
+* Ver 1.17 : 14 Oct 2026
+* - messages go out with one vectored send of header and body, and pages and FETCH
+*   chunks are sent as shared bodies referring to the page cache, not copies
+* Ver 1.16 : 14 Oct 2026
+* - POSTs with ack: yes are answered with an ACK message once read and stored
+* Ver 1.15 : 14 Oct 2026
+* - run with /e, records Trace spans of socket I/O, lane waits and handlers on every
+*   thread, and each stats message writes them to MsgServer.trace.json
+* Ver 1.14 : 14 Oct 2026
+* - answers SEARCH messages, substring or regex, from the analyzer's search index
+* Ver 1.13 : 14 Oct 2026
+* - published pages include the analyzer's committed page generation, which the page
+*   cache and StaticHttp read instead of pages being written in place
+* Ver 1.12 : 14 Oct 2026
+* - published pages include those in the analyzer's PagePack, which the page cache
+*   and StaticHttp read from the mapped pack
+* Ver 1.11 : 14 Oct 2026
+* - a connection starting with an HTTP request line is served published pages
+*   by StaticHttp, so browsers read them from the server with no client copy
+* Ver 1.10 : 14 Oct 2026
+* - uploads are received apart and kept by a BlobStore, and each owner's names are
+*   recorded in its manifest; SYNC links names to stored content instead of asking
+* Ver 1.9 : 14 Oct 2026
+* - added resumable uploads: RESUME answers with the chunks held for a file,
+*   CHUNK messages are checked and written at their offset, COMMIT renames
+*   the finished file into place or lists the chunks missing
+* Ver 1.8 : 14 Oct 2026
+* - OPTIONS offers accept-credit and credit-window, POSTs with flow: credit are
+*   read a segment at a time, written by an UploadWriter, and granted back
+* Ver 1.7 : 14 Oct 2026
+* - upload notifications are dispatched as bulk and publish as background, so
+*   interactive messages don't wait behind a push; stats show each class's depth
+* Ver 1.6 : 14 Oct 2026
+* - queued messages are dispatched by command to handlers on a MsgDispatcher's
+*   worker lanes, publish in a long lane of its own, instead of printed by main
+* Ver 1.5 : 14 Oct 2026
+* - execute sends each page as the analyzer signals it written, with PublishSignal::pageDone,
+*   and the pages it hasn't sent yet when the batch is done
+* Ver 1.4 : 14 Oct 2026
+* - published pages are served from an LRU PageCache, revalidated by file stamp,
+*   so repeated views don't read the page from disk again
+* - pages carry an etag, FETCH answers if-none-match with not-modified, and GET
+*   skips pages whose etag is in the client's manifest
+* Ver 1.3 : 14 Oct 2026
+* - parsed attributes are moved into messages, bodies received in place
+* Ver 1.2 : 14 Oct 2026
+* - answers FETCH messages with a byte or line range of one file, in chunks,
+*   so viewers download only the pages and parts of pages they show
+* Ver 1.1 : 14 Oct 2026
+* - sends shared assets from ../Repository/assets with a long lived Cache-Control attribute
+* - received messages are moved into the message queue instead of copied
+* - connections are handled by a pool of 16 workers instead of a thread each
+* - published files are sent back on the client's own connection when it asks
+*   with a GET message, instead of on a reverse connection to port 8085
+* - answers OPTIONS with accepted content encodings, receives and sends
+*   files compressed with content-encoding lz77
+* - execute waits on PublishSignal for the analyzer to finish a batch instead of
+*   spinning through an empty loop
+* - answers SYNC manifest messages so clients upload only changed files
+* - binary message framing, negotiated per connection with OPTIONS accept-framing
 * Ver 1.0 : 2nd May 2017
 * - first release
 *
@@ -51,14 +184,36 @@
 #include "../Logger/Cpp11-BlockingQueue.h"
 #include "../Logger/Logger.h"
 #include "../Utilities/Utilities.h"
+#include "PageCache.h"
+#include "../CodePublisher/PagePack.h"
+#include "../CodePublisher/PageGenerations.h"
+#include "../CodePublisher/SearchIndex.h"
+#include "DependencyQuery.h"
+#include <unordered_map>
 
+class PageNotifier;
 
 class MsgClientFromServer {
 public:
 	using EndPoint = std::string;
 	void execute(const size_t TimeBetweenMessages, const size_t NumMessages);
+	bool sendPublished(Socket& socket, bool compress = false, bool binary = false,
+		const HttpMessage::Manifest& held = HttpMessage::Manifest(), bool patches = false);
+	bool sendRange(Socket& socket, const std::string& filename, const std::string& range,
+		size_t chunkSize = FetchChunkSize, bool binary = false, const std::string& ifNoneMatch = "");
+	static const size_t FetchChunkSize = 64 * 1024;
+	static PageCache& pages();
+	static PackReader& packs();
+	static GenerationReader& generations();
+	static SearchReader& searchIndex();
+	static DependencyReader& dependencies();
+	static PageNotifier& notifier();
+	static std::vector<std::string> publishedPages();
 private:
 	HttpMessage makeMessage(size_t n, const std::string& msgBody, const EndPoint& ep);
-	void sendMessage(HttpMessage& msg, Socket& socket);
-	bool sendFile(const std::string& fqname, Socket& socket);
+	bool sendMessage(HttpMessage& msg, Socket& socket, bool binary = false);
+	bool sendFile(const std::string& fqname, Socket& socket, bool compress = false, bool binary = false, const std::string& held = "");
+	bool sendPatch(const std::string& filename, const PageCache::PagePtr& page, const std::string& held,
+		Socket& socket, bool compress, bool binary);
+	size_t sendChangedPages(Socket& socket, std::unordered_map<std::string, std::string>& sent);
 };
\ No newline at end of file
@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////
+// PageCache.cpp - Keeps recently served published pages in memory       //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "PageCache.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../CodePublisher/PagePack.h"
+#include "../CodePublisher/PageGenerations.h"
+#include <fstream>
+
+PageCache::PageCache(const std::string& root, size_t maxBytes, PackReader* pPack, GenerationReader* pGenerations)
+	: root_(root), maxBytes_(maxBytes), pPack_(pPack), pGenerations_(pGenerations) {}
+
+//----< page for file, from memory if it hasn't changed on disk >----
+/*
+ * - nullptr if the file isn't there, or the name is outside the root
+ * - the file is read without holding the lock, so a miss doesn't hold
+ *   up threads sending other pages
+ */
+PageCache::PagePtr PageCache::get(const std::string& file)
+{
+	if (file == "" || file.find("..") != std::string::npos)
+		return nullptr;
+	PackReader::Page packed = pPack_ ? pPack_->find(file) : PackReader::Page();
+	if (packed.found)
+	{
+		std::string stamp = "packed " + packed.etag;
+		PagePtr page = cached(file, stamp);
+		if (page)
+			return page;
+		std::shared_ptr<Page> copy = std::make_shared<Page>();
+		copy->bytes.assign(packed.bytes, packed.size);
+		copy->etag = packed.etag;
+		copy->stamp = stamp;
+		keep(file, copy);
+		return copy;
+	}
+	std::string fqname = pGenerations_ ? pGenerations_->find(file) : root_ + file;
+	std::string stamp = PublishManifest::stamp(fqname);
+	if (stamp == "")
+	{
+		remove(file);
+		return nullptr;
+	}
+	PagePtr page = cached(file, stamp);
+	if (page)
+		return page;
+	page = load(fqname, stamp);
+	if (page)
+		keep(file, page);
+	return page;
+}
+//----< etag of file's page, "" if missing, reads it only if it changed >---
+/*
+ * - a packed page's etag is in the pack's index, others are remembered
+ *   with the stamp they had when read, kept or not
+ */
+std::string PageCache::etag(const std::string& file)
+{
+	if (file == "" || file.find("..") != std::string::npos)
+		return "";
+	PackReader::Page packed = pPack_ ? pPack_->find(file) : PackReader::Page();
+	if (packed.found)
+		return packed.etag;
+	std::string fqname = pGenerations_ ? pGenerations_->find(file) : root_ + file;
+	std::string stamp = PublishManifest::stamp(fqname);
+	if (stamp == "")
+	{
+		remove(file);
+		return "";
+	}
+	{
+		std::lock_guard<std::mutex> lock(mtx_);
+		auto iter = etags_.find(file);
+		if (iter != etags_.end() && iter->second.first == stamp)
+			return iter->second.second;
+	}
+	PagePtr page = get(file);
+	return page ? page->etag : "";
+}
+//----< version of file's page before the one kept, if its etag is etag >---
+
+PageCache::PagePtr PageCache::previous(const std::string& file, const std::string& etag)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto iter = entries_.find(file);
+	if (iter == entries_.end() || !iter->second.previous || iter->second.previous->etag != etag)
+		return nullptr;
+	return iter->second.previous;
+}
+//----< page kept for file with this stamp, as most recently used >--
+
+PageCache::PagePtr PageCache::cached(const std::string& file, const std::string& stamp)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto iter = entries_.find(file);
+	if (iter == entries_.end() || iter->second.page->stamp != stamp)
+		return nullptr;
+	lru_.splice(lru_.begin(), lru_, iter->second.pos);
+	++hits_;
+	return iter->second.page;
+}
+//----< read whole file and hash it >--------------------------------
+
+PageCache::PagePtr PageCache::load(const std::string& fqname, const std::string& stamp)
+{
+	std::ifstream in(fqname, std::ios::binary);
+	if (!in.good())
+		return nullptr;
+	in.seekg(0, std::ios::end);
+	size_t size = (size_t)in.tellg();
+	in.seekg(0);
+	std::shared_ptr<Page> page = std::make_shared<Page>();
+	page->bytes.resize(size);
+	if (size > 0 && !in.read(&page->bytes[0], size))
+		return nullptr;
+	page->etag = PublishManifest::textHash(page->bytes);
+	page->stamp = stamp;
+	return page;
+}
+//----< keep page as most recently used, evicting past the budget >--
+/*
+ * - a page replacing one with another etag keeps it as its previous version
+ */
+
+void PageCache::keep(const std::string& file, const PagePtr& page)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	++misses_;
+	etags_[file] = std::make_pair(page->stamp, page->etag);
+	PagePtr older;
+	auto iter = entries_.find(file);
+	if (iter != entries_.end())
+	{
+		if (iter->second.page->etag != page->etag)
+			older = iter->second.page;
+		else
+			older = iter->second.previous;
+		forget(iter);
+	}
+	if (page->bytes.size() > maxBytes_ / 8)
+		return;
+	lru_.push_front(file);
+	Entry entry = { page, older, lru_.begin() };
+	entries_[file] = entry;
+	bytes_ += page->bytes.size() + (older ? older->bytes.size() : 0);
+	while (bytes_ > maxBytes_ && !lru_.empty())
+		forget(entries_.find(lru_.back()));
+}
+//----< forget page, e.g., one that was removed from the repository >--
+
+void PageCache::remove(const std::string& file)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	etags_.erase(file);
+	auto iter = entries_.find(file);
+	if (iter != entries_.end())
+		forget(iter);
+}
+//----< drop entry, caller holds the lock >--------------------------
+
+void PageCache::forget(std::unordered_map<std::string, Entry>::iterator iter)
+{
+	bytes_ -= iter->second.page->bytes.size();
+	if (iter->second.previous)
+		bytes_ -= iter->second.previous->bytes.size();
+	lru_.erase(iter->second.pos);
+	entries_.erase(iter);
+}
+
+PageCache::Stats PageCache::stats()
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	Stats stats = { hits_, misses_, entries_.size(), bytes_ };
+	return stats;
+}
@@ -0,0 +1,146 @@
+#ifndef PAGECACHE_H
+#define PAGECACHE_H
+///////////////////////////////////////////////////////////////////////////
+// PageCache.h - Keeps recently served published pages in memory         //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* PageCache holds the bytes of the published pages and assets MsgServer
+* sends most often, with an etag for each, the 64 bit FNV-1a hash of its
+* content made by PublishManifest::textHash.  A client holding a page
+* with the same etag, e.g., one that hashed its local copy with
+* PublishManifest::contentHash, doesn't need it sent again.
+*
+* The analyzer publishes pages into the Repository from another process,
+* so get(file) checks the page's stamp, its last write time and size, on
+* every call.  A page whose stamp hasn't moved is served from memory, a
+* new or republished page is read once, hashed, and kept.  When the pages
+* kept hold more than the byte budget, the least recently used go first.
+* Pages larger than an eighth of the budget are read and returned but
+* not kept, so one large page can't flush everything else.
+*
+* Given a PackReader, get looks for the page in the analyzer's PagePack
+* first.  A packed page's stamp is its content hash, so it is copied out
+* of the mapped pack only when a commit has changed it.
+*
+* Given a GenerationReader, other pages are read from the generation the
+* analyzer last committed, if it holds them.  Pages hard linked forward
+* into a new generation keep their stamp, so they stay cached.
+*
+* etag(file) gives a page's etag alone.  The etag of every page read is
+* remembered with its stamp, beyond the byte budget, so listing the etags
+* of a whole repository reads only the pages that changed since, and a
+* packed page's etag is taken from the pack's index.
+*
+* A kept page that is read again with another etag keeps its last version
+* too, counted in the byte budget and evicted with it, so previous(file,
+* etag) gives the bytes a client holding that etag has, to diff against.
+*
+* The cache is shared by the server's worker threads.  Pages are handed
+* out as shared pointers to const, so a page being sent stays valid if
+* another thread evicts or replaces it.
+*
+* Public Interface
+* --------------------
+* PageCache cache("../Repository/");                //default budget 64 MB
+* PageCache cache("../Repository/", budget, &packs); //pages in packs, a PackReader, first
+* PageCache cache("../Repository/", budget, &packs, &gens); //then in gens, a GenerationReader
+* PageCache::PagePtr page = cache.get("index.html"); //nullptr if missing
+* page->bytes, page->etag, page->stamp
+* std::string etag = cache.etag("index.html");     //"" if missing, reads the page only if it changed
+* PageCache::PagePtr old = cache.previous("index.html", etag); //last version, nullptr unless its etag is etag
+* cache.remove("index.html");                      //forget a page
+* PageCache::Stats stats = cache.stats();          //hits, misses, pages, bytes
+*
+* Required Files:
+* ---------------
+*   PageCache.h, PageCache.cpp
+*   PublishManifest.h, PublishManifest.cpp
+*   PagePack.h, PagePack.cpp
+*   PageGenerations.h, PageGenerations.cpp
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.4 : 14 Oct 2026
+* - added previous, the version a kept page had before it was read again
+* Ver 1.3 : 14 Oct 2026
+* - added etag, from the etags remembered by stamp for every page read
+* Ver 1.2 : 14 Oct 2026
+* - pages are read from a GenerationReader's committed generation, when one is given
+* Ver 1.1 : 14 Oct 2026
+* - pages are taken from a PackReader, when one is given, before the file system
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include <string>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class PackReader;
+class GenerationReader;
+
+class PageCache
+{
+public:
+	struct Page
+	{
+		std::string bytes;
+		std::string etag;    // content hash
+		std::string stamp;   // last write time and size when read
+	};
+	using PagePtr = std::shared_ptr<const Page>;
+	struct Stats
+	{
+		size_t hits;
+		size_t misses;
+		size_t pages;
+		size_t bytes;
+	};
+	static const size_t DefaultBudget = 64 * 1024 * 1024;
+
+	PageCache(const std::string& root, size_t maxBytes = DefaultBudget, PackReader* pPack = nullptr,
+		GenerationReader* pGenerations = nullptr);
+	PagePtr get(const std::string& file);
+	std::string etag(const std::string& file);
+	PagePtr previous(const std::string& file, const std::string& etag);
+	void remove(const std::string& file);
+	Stats stats();
+private:
+	struct Entry
+	{
+		PagePtr page;
+		PagePtr previous;                        // version before page, may be nullptr
+		std::list<std::string>::iterator pos;   // in lru_
+	};
+	PagePtr load(const std::string& fqname, const std::string& stamp);
+	PagePtr cached(const std::string& file, const std::string& stamp);
+	void keep(const std::string& file, const PagePtr& page);
+	void forget(std::unordered_map<std::string, Entry>::iterator iter);
+
+	std::string root_;
+	size_t maxBytes_;
+	PackReader* pPack_;
+	GenerationReader* pGenerations_;
+	std::mutex mtx_;
+	std::list<std::string> lru_;                     // most recently used first
+	std::unordered_map<std::string, Entry> entries_;
+	std::unordered_map<std::string, std::pair<std::string, std::string>> etags_;   // stamp and etag by file
+	size_t bytes_ = 0;
+	size_t hits_ = 0;
+	size_t misses_ = 0;
+};
+#endif
@@ -0,0 +1,198 @@
+///////////////////////////////////////////////////////////////////////////
+// PageNotifier.cpp - Tells subscribed clients of published pages        //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "PageNotifier.h"
+#include "../Utilities/Utilities.h"
+#include "../Utilities/Trace.h"
+#include <chrono>
+
+using namespace Utilities;
+
+PageNotifier::PageNotifier(const ListPages& listPages) : listPages_(listPages), stop_(false) {}
+
+PageNotifier::~PageNotifier()
+{
+	stop();
+}
+//----< open PublishSignal, so no signal is lost, and start waiting >---
+
+void PageNotifier::start()
+{
+	if (thread_.joinable())
+		return;
+	PublishSignal::open();
+	stop_ = false;
+	thread_ = std::thread([this] { run(); });
+}
+//----< stop waiting and close every subscription >------------------
+
+void PageNotifier::stop()
+{
+	stop_ = true;
+	eventCv_.notify_all();
+	if (thread_.joinable())
+		thread_.join();
+	std::lock_guard<std::mutex> lock(mtx_);
+	pending_.clear();
+	stats_.subscribers = 0;
+}
+//----< take over a connection whose SUBSCRIBE was answered >--------
+/*
+ * - sends to it time out after SendTimeoutMs, so a client that stops
+ *   reading doesn't hold up the others' notices
+ */
+void PageNotifier::subscribe(Socket&& socket, const std::vector<std::string>& prefixes, bool binary)
+{
+	DWORD timeout = SendTimeoutMs;
+	::setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, (const char*)&timeout, sizeof(timeout));
+	SubscriberPtr subscriber(new Subscriber{ std::move(socket), prefixes, binary });
+	std::lock_guard<std::mutex> lock(mtx_);
+	pending_.push_back(std::move(subscriber));
+	++stats_.subscribers;
+	++stats_.subscribed;
+}
+//----< signals handled so far, a starting point for waitAny >-------
+
+size_t PageNotifier::events()
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	return events_;
+}
+//----< wait for a signal handled after seen, as PublishSignal::waitAny >---
+/*
+ * - Batch if a batch finished since seen, even if pages followed it,
+ *   then seen moves past every signal handled so far
+ */
+PublishSignal::Event PageNotifier::waitAny(size_t& seen, unsigned long timeoutMs)
+{
+	std::unique_lock<std::mutex> lock(mtx_);
+	eventCv_.wait_for(lock, std::chrono::milliseconds(timeoutMs), [&] { return events_ > seen || stop_; });
+	PublishSignal::Event event = (lastBatch_ > seen) ? PublishSignal::Batch :
+		(events_ > seen ? PublishSignal::Page : PublishSignal::None);
+	seen = events_;
+	return event;
+}
+
+PageNotifier::Stats PageNotifier::stats()
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	return stats_;
+}
+//----< wait for the analyzer's signals and notify subscribers >-----
+/*
+ * - the first listing is the baseline, pages already published then
+ *   aren't announced, subscribers fetch what they show when they start
+ */
+void PageNotifier::run()
+{
+	Trace::instance().nameThread("page notifier");
+	etags_ = listPages_();
+	while (!stop_)
+	{
+		PublishSignal::Event event = PublishSignal::waitAny(PollMs);
+		if (event == PublishSignal::Page)
+			PublishSignal::clearPages();   // one listing covers every page signaled so far
+		{
+			std::lock_guard<std::mutex> lock(mtx_);
+			for (auto& subscriber : pending_)
+				subscribers_.push_back(std::move(subscriber));
+			pending_.clear();
+		}
+		if (event == PublishSignal::None)
+			continue;
+		publish(event);
+		{
+			std::lock_guard<std::mutex> lock(mtx_);
+			++events_;
+			if (event == PublishSignal::Batch)
+				lastBatch_ = events_;
+		}
+		eventCv_.notify_all();
+	}
+	subscribers_.clear();
+}
+//----< notices for pages changed or removed since the last listing >---
+
+void PageNotifier::publish(PublishSignal::Event event)
+{
+	Trace::Span span("notify", "publish");
+	Etags current = listPages_();
+	for (auto& page : current)
+	{
+		auto iter = etags_.find(page.first);
+		if (iter != etags_.end() && iter->second == page.second)
+			continue;
+		HttpMessage msg;
+		msg.addAttribute(HttpMessage::attribute("NOTIFY", "changed"));
+		msg.addAttribute(HttpMessage::Attribute("file", page.first));
+		msg.addAttribute(HttpMessage::Attribute("etag", page.second));
+		notify(msg, page.first);
+	}
+	for (auto& page : etags_)
+	{
+		if (current.find(page.first) != current.end())
+			continue;
+		HttpMessage msg;
+		msg.addAttribute(HttpMessage::attribute("NOTIFY", "removed"));
+		msg.addAttribute(HttpMessage::Attribute("file", page.first));
+		notify(msg, page.first);
+	}
+	etags_.swap(current);
+	if (event == PublishSignal::Batch)
+	{
+		HttpMessage msg;
+		msg.addAttribute(HttpMessage::attribute("NOTIFY", "published"));
+		msg.addAttribute(HttpMessage::Attribute("pages", Converter<size_t>::toString(etags_.size())));
+		notify(msg, "");
+	}
+}
+//----< send msg to the subscribers that want page, "" for all >-----
+/*
+ * - the message is framed once for each framing, not per subscriber
+ * - a subscriber whose send fails is dropped, closing its connection
+ */
+void PageNotifier::notify(const HttpMessage& msg, const std::string& page)
+{
+	std::string textHead, binaryHead;
+	HttpMessage::Buffers text = msg.toBuffers(textHead);
+	HttpMessage::Buffers binary = msg.toBuffers(binaryHead, true);
+	size_t sent = 0, dropped = 0;
+	for (size_t i = 0; i < subscribers_.size(); )
+	{
+		Subscriber& subscriber = *subscribers_[i];
+		if (page != "" && !wants(subscriber, page))
+		{
+			++i;
+			continue;
+		}
+		if (subscriber.socket.sendBuffers(subscriber.binary ? binary : text))
+		{
+			++sent;
+			++i;
+			continue;
+		}
+		subscribers_.erase(subscribers_.begin() + i);
+		++dropped;
+	}
+	std::lock_guard<std::mutex> lock(mtx_);
+	stats_.notices += sent;
+	stats_.dropped += dropped;
+	stats_.subscribers -= dropped;
+}
+//----< does one of subscriber's prefixes start page's name ? >------
+
+bool PageNotifier::wants(const Subscriber& subscriber, const std::string& page)
+{
+	if (subscriber.prefixes.empty())
+		return true;
+	for (auto& prefix : subscriber.prefixes)
+	{
+		if (page.compare(0, prefix.size(), prefix) == 0)
+			return true;
+	}
+	return false;
+}
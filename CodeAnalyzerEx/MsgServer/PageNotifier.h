@@ -0,0 +1,125 @@
+#ifndef PAGENOTIFIER_H
+#define PAGENOTIFIER_H
+///////////////////////////////////////////////////////////////////////////
+// PageNotifier.h - Tells subscribed clients which pages were published  //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* PageNotifier pushes a small NOTIFY message to each subscribed client as
+* the analyzer finishes a page, instead of the pages themselves, so a GUI
+* fetches only the pages it shows, and only once they've changed.
+*
+* A client subscribes with a SUBSCRIBE message on its own connection, its
+* body a path prefix per line, e.g., "Parser/", none for every page.  The
+* server answers "SUBSCRIBE: ok" and hands the connection to subscribe, so
+* no handler thread is held by it.  From then on the connection carries
+* only notices, in the framing the client negotiated:
+*
+*   NOTIFY: changed    file: Parser/Parser.cpp.html   etag: <content hash>
+*   NOTIFY: removed    file: Parser/Parser.cpp.html
+*   NOTIFY: published  pages: <pages in the batch's repository>
+*
+* The notifier's thread is the server's one waiter on PublishSignal.  On
+* each page or batch signal it lists the published pages with their etags,
+* and notices go for the pages whose etag differs from the last listing,
+* to the subscribers with a prefix of the page's name.  A subscriber that
+* closes its connection, or doesn't read its notices for SendTimeoutMs, is
+* dropped.  Other threads that followed PublishSignal, e.g., a reverse push,
+* wait on waitAny instead, which reports the signals the thread has seen.
+*
+* Public Interface
+* --------------------
+* PageNotifier notifier(listPages);               //listPages gives each page's name and etag
+* notifier.start();                               //takes the first listing, then waits for signals
+* notifier.subscribe(std::move(socket), prefixes, binary);
+* size_t seen = notifier.events();                //signals seen so far
+* PublishSignal::Event e = notifier.waitAny(seen, timeoutMs);  //Page, Batch, or None
+* PageNotifier::Stats stats = notifier.stats();   //subscribers, notices sent and dropped
+* notifier.stop();                                //closes every subscription
+*
+* Required Files:
+* ---------------
+*   PageNotifier.h, PageNotifier.cpp
+*   HttpMessage.h, HttpMessage.cpp
+*   Sockets.h, Sockets.cpp, PublishSignal.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../Sockets/Sockets.h"
+#include "../HttpMessage/HttpMessage.h"
+#include "../CodePublisher/PublishSignal.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <atomic>
+#include <functional>
+
+class PageNotifier
+{
+public:
+	using Etags = std::map<std::string, std::string>;   // etag by page name
+	using ListPages = std::function<Etags()>;
+	struct Stats
+	{
+		size_t subscribers = 0;
+		size_t subscribed = 0;     // since start
+		size_t notices = 0;        // messages sent to subscribers
+		size_t dropped = 0;        // subscribers whose connection failed
+	};
+	static const unsigned long PollMs = 500;          // stop is noticed at most this late
+	static const unsigned long SendTimeoutMs = 5000;  // subscriber not reading is dropped
+
+	PageNotifier(const ListPages& listPages);
+	~PageNotifier();
+	PageNotifier(const PageNotifier&) = delete;
+	PageNotifier& operator=(const PageNotifier&) = delete;
+	void start();
+	void stop();
+	void subscribe(Socket&& socket, const std::vector<std::string>& prefixes, bool binary);
+	size_t events();
+	PublishSignal::Event waitAny(size_t& seen, unsigned long timeoutMs);
+	Stats stats();
+private:
+	struct Subscriber
+	{
+		Socket socket;
+		std::vector<std::string> prefixes;   // empty for every page
+		bool binary;
+	};
+	using SubscriberPtr = std::unique_ptr<Subscriber>;
+	void run();
+	void publish(PublishSignal::Event event);
+	void notify(const HttpMessage& msg, const std::string& page);
+	static bool wants(const Subscriber& subscriber, const std::string& page);
+
+	ListPages listPages_;
+	Etags etags_;                            // as last listed, only run's thread uses it
+	std::vector<SubscriberPtr> subscribers_; // only run's thread uses it
+	std::vector<SubscriberPtr> pending_;     // subscribed, not yet taken by run
+	std::mutex mtx_;                         // guards pending_, events and stats_
+	std::condition_variable eventCv_;
+	size_t events_ = 0;                      // signals handled
+	size_t lastBatch_ = 0;                   // events_ after the last batch
+	Stats stats_;
+	std::atomic<bool> stop_;
+	std::thread thread_;
+};
+#endif
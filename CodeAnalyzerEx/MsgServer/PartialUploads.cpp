@@ -0,0 +1,194 @@
+///////////////////////////////////////////////////////////////////////////
+// PartialUploads.cpp - Tracks the chunks of resumable uploads           //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "PartialUploads.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../FileSystem/FileSystem.h"
+#include <windows.h>
+#include <fstream>
+#include <algorithm>
+
+/////////////////////////////////////////////////////////////////////
+// Part holds one file's upload
+// - held and ckpt are updated by the writer thread as chunks are written
+
+struct PartialUploads::Part
+{
+	std::string fileName;     // where the file belongs
+	std::string partName;     // where it is received
+	size_t size = 0;
+	std::string hash;
+	size_t chunkSize = 0;
+	UploadWriter::FilePtr out;
+	std::mutex mtx;           // guards held and ckpt
+	Chunks held;
+	std::ofstream ckpt;
+	size_t numChunks() const { return (size + chunkSize - 1) / chunkSize; }
+	std::string ckptName() const { return partName + ".ckpt"; }
+};
+//----< start or continue file's upload, returns chunks already held >--
+/*
+ * - an upload of the same file with another size, hash, or chunk size
+ *   starts the part again
+ * - a checkpoint left by an earlier connection, or an earlier run of
+ *   the server, is picked up if it describes the same upload
+ */
+PartialUploads::Chunks PartialUploads::begin(const std::string& file, size_t size, const std::string& hash, size_t chunkSize)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto iter = parts_.find(file);
+	if (iter != parts_.end())
+	{
+		Part& old = *iter->second;
+		if (old.size == size && old.hash == hash && old.chunkSize == chunkSize)
+		{
+			std::lock_guard<std::mutex> partLock(old.mtx);
+			return old.held;
+		}
+		writer_.close(old.out);
+		parts_.erase(iter);
+	}
+	if (chunkSize == 0 || file == "" || file.find("..") != std::string::npos)
+		return Chunks();
+	PartPtr part = std::make_shared<Part>();
+	part->fileName = root_ + file;
+	part->partName = part->fileName + ".part";
+	part->size = size;
+	part->hash = hash;
+	part->chunkSize = chunkSize;
+	bool resumed = FileSystem::File::exists(part->partName) && loadCheckpoint(*part);
+	if (resumed)
+	{
+		part->out = writer_.open(part->partName, true);
+		part->ckpt.open(part->ckptName(), std::ios::out | std::ios::app);
+	}
+	if (!resumed || !part->out || !part->ckpt.good())
+	{
+		if (!restart(*part))
+			return Chunks();
+	}
+	parts_[file] = part;
+	return part->held;
+}
+//----< empty the part and its checkpoint, caller's writes are done >--
+
+bool PartialUploads::restart(Part& part)
+{
+	std::lock_guard<std::mutex> lock(part.mtx);
+	part.held.clear();
+	part.out = writer_.open(part.partName);
+	part.ckpt.close();
+	part.ckpt.clear();
+	part.ckpt.open(part.ckptName(), std::ios::out | std::ios::trunc);
+	part.ckpt << part.size << " " << part.hash << " " << part.chunkSize << "\n";
+	part.ckpt.flush();
+	return part.out != nullptr && part.ckpt.good();
+}
+//----< chunks recorded by part's checkpoint, false if it's of another upload >--
+/*
+ * - a line cut short by a crash can give a chunk a wrong hash, the
+ *   client then finds it doesn't match its own and sends it again
+ */
+bool PartialUploads::loadCheckpoint(Part& part)
+{
+	std::ifstream in(part.ckptName());
+	size_t size = 0, chunkSize = 0;
+	std::string hash;
+	if (!(in >> size >> hash >> chunkSize) || size != part.size || hash != part.hash || chunkSize != part.chunkSize)
+		return false;
+	size_t index;
+	std::string chunkHash;
+	while (in >> index >> chunkHash)
+	{
+		if (index < part.numChunks())
+			part.held[index] = chunkHash;
+	}
+	return true;
+}
+
+PartialUploads::PartPtr PartialUploads::find(const std::string& file)
+{
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto iter = parts_.find(file);
+	return iter != parts_.end() ? iter->second : nullptr;
+}
+//----< hand chunk index of file to the writer, false if dropped >---
+/*
+ * - dropped if the upload wasn't begun, the chunk is out of range or
+ *   of the wrong size, or its bytes don't hash to hash
+ * - recorded in the checkpoint once it is written
+ */
+bool PartialUploads::put(const std::string& file, size_t index, const std::string& hash, std::vector<char>&& bytes)
+{
+	PartPtr part = find(file);
+	if (!part || index >= part->numChunks())
+		return false;
+	size_t offset = index * part->chunkSize;
+	if (bytes.size() != (std::min)(part->chunkSize, part->size - offset))
+		return false;
+	if (PublishManifest::bytesHash(&bytes[0], bytes.size()) != hash)
+		return false;
+	writer_.writeAt(part->out, offset, std::move(bytes), [part, index, hash](bool ok) {
+		if (!ok)
+			return;
+		std::lock_guard<std::mutex> lock(part->mtx);
+		part->held[index] = hash;
+		part->ckpt << index << " " << hash << "\n";
+		part->ckpt.flush();
+	});
+	return true;
+}
+//----< rename the finished part to file, or say which chunks are missing >--
+/*
+ * - waits for the chunks handed to the writer to be written
+ * - a part holding every chunk that doesn't hash to the file's hash,
+ *   e.g., one whose checkpoint outlived its bytes in a crash, is
+ *   started again, and every chunk is missing
+ * - returns false with no chunks missing if the part can't be renamed
+ */
+bool PartialUploads::commit(const std::string& file, Missing& missing)
+{
+	missing.clear();
+	PartPtr part = find(file);
+	if (!part)
+		return false;
+	bool written = writer_.close(part->out);
+	{
+		std::lock_guard<std::mutex> lock(part->mtx);
+		for (size_t i = 0; i < part->numChunks(); ++i)
+		{
+			if (part->held.find(i) == part->held.end())
+				missing.push_back(i);
+		}
+	}
+	if (missing.size() > 0)
+	{
+		part->out = writer_.open(part->partName, true);
+		return false;
+	}
+	if (!written || PublishManifest::contentHash(part->partName) != part->hash)
+	{
+		restart(*part);
+		for (size_t i = 0; i < part->numChunks(); ++i)
+			missing.push_back(i);
+		return false;
+	}
+	part->ckpt.close();
+	if (!::MoveFileExA(part->partName.c_str(), part->fileName.c_str(), MOVEFILE_REPLACE_EXISTING | MOVEFILE_WRITE_THROUGH))
+	{
+		part->ckpt.clear();
+		part->ckpt.open(part->ckptName(), std::ios::out | std::ios::app);
+		part->out = writer_.open(part->partName, true);
+		return false;
+	}
+	::DeleteFileA(part->ckptName().c_str());
+	std::lock_guard<std::mutex> lock(mtx_);
+	auto iter = parts_.find(file);
+	if (iter != parts_.end() && iter->second == part)
+		parts_.erase(iter);
+	return true;
+}
@@ -0,0 +1,91 @@
+#ifndef PARTIALUPLOADS_H
+#define PARTIALUPLOADS_H
+///////////////////////////////////////////////////////////////////////////
+// PartialUploads.h - Tracks the chunks of resumable uploads             //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* PartialUploads receives files as numbered chunks, so an upload broken
+* off by a dropped connection resumes where it stopped.  Chunk i holds
+* the file's bytes from i * chunkSize, and carries the FNV-1a hash of
+* its bytes.
+*
+* A file is received into file.part, beside where it belongs, and each
+* chunk written is recorded in a checkpoint, file.part.ckpt: a line
+* with the file's size, content hash, and chunk size, then a line with
+* the index and hash of each chunk, appended once the UploadWriter has
+* written it.  The checkpoint is kept on disk, so a resume still works
+* after the server restarts.
+*
+* begin starts or continues a file's upload and returns the chunks held
+* for it, if the part and checkpoint are of the same size, content hash,
+* and chunk size; otherwise the part is started again.  put hands one
+* chunk to the writer, a chunk whose hash doesn't match its bytes is
+* dropped.  commit waits for the file's chunks to be written, and, when
+* every chunk is there and the part hashes to the file's content hash,
+* renames the part to the file, replacing any old one in a single step,
+* and removes the checkpoint.  Otherwise commit returns the chunks still
+* missing.
+*
+* Public Interface
+* --------------------
+* PartialUploads parts("../Repository/", writer);
+* PartialUploads::Chunks held = parts.begin(file, size, hash, chunkSize);   //chunks already written
+* bool taken = parts.put(file, index, hash, std::move(bytes));             //false if dropped
+* PartialUploads::Missing missing;
+* bool done = parts.commit(file, missing);                                 //renamed, or chunks missing
+*
+* Required Files:
+* ---------------
+*   PartialUploads.h, PartialUploads.cpp
+*   UploadWriter.h, UploadWriter.cpp
+*   PublishManifest.h, PublishManifest.cpp
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "UploadWriter.h"
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+
+class PartialUploads
+{
+public:
+	using Chunks = std::map<size_t, std::string>;   // chunk index, hash
+	using Missing = std::vector<size_t>;
+
+	PartialUploads(const std::string& root, UploadWriter& writer) : root_(root), writer_(writer) {}
+	Chunks begin(const std::string& file, size_t size, const std::string& hash, size_t chunkSize);
+	bool put(const std::string& file, size_t index, const std::string& hash, std::vector<char>&& bytes);
+	bool commit(const std::string& file, Missing& missing);
+private:
+	struct Part;
+	using PartPtr = std::shared_ptr<Part>;
+	PartPtr find(const std::string& file);
+	bool restart(Part& part);
+	bool loadCheckpoint(Part& part);
+
+	std::string root_;
+	UploadWriter& writer_;
+	std::mutex mtx_;      // guards parts_
+	std::unordered_map<std::string, PartPtr> parts_;
+};
+#endif
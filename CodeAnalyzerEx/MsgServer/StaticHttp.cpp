@@ -0,0 +1,312 @@
+///////////////////////////////////////////////////////////////////////////
+// StaticHttp.cpp - Serves published pages to browsers over HTTP/1.1     //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "StaticHttp.h"
+#include "../CodePublisher/PublishManifest.h"
+#include "../FileSystem/FileSystem.h"
+#include "../Utilities/Utilities.h"
+#include <sstream>
+#include <algorithm>
+#include <cctype>
+
+using namespace Utilities;
+
+namespace
+{
+	// compressed variants, most preferred first: Content-Encoding, file name suffix
+	const std::pair<const char*, const char*> Variants[] = { { "br", ".br" }, { "gzip", ".gz" } };
+}
+
+//----< is line "METHOD target HTTP/1.x", a browser's request line? >--
+
+bool StaticHttp::isRequestLine(const std::string& line)
+{
+	size_t method = line.find(' ');
+	if (method == std::string::npos || method == 0)
+		return false;
+	for (size_t i = 0; i < method; ++i)
+	{
+		if (!isupper(static_cast<unsigned char>(line[i])))
+			return false;
+	}
+	size_t version = line.rfind(' ');
+	return version > method && line.compare(version + 1, 7, "HTTP/1.") == 0;
+}
+//----< value of header name, compared without case, "" if none >----
+
+std::string StaticHttp::header(const HttpMessage& msg, const std::string& name)
+{
+	for (auto& attrib : msg.attributes())
+	{
+		if (attrib.first.size() == name.size() && std::equal(name.begin(), name.end(), attrib.first.begin(),
+			[](char a, char b) { return tolower(static_cast<unsigned char>(a)) == tolower(static_cast<unsigned char>(b)); }))
+			return attrib.second;
+	}
+	return "";
+}
+//----< Repository file a request target names, false if not served >--
+/*
+ * - the query and fragment are dropped and %XX escapes decoded
+ * - only pages, .html or .htm, and .css and .js files, in the
+ *   Repository or one directory below it, e.g., assets/ or a
+ *   package's directory of published pages
+ */
+bool StaticHttp::resolve(const std::string& target, std::string& file)
+{
+	std::string path = target.substr(0, target.find_first_of("?#"));
+	file.clear();
+	for (size_t i = 0; i < path.size(); ++i)
+	{
+		if (path[i] == '%' && i + 2 < path.size() && isxdigit(static_cast<unsigned char>(path[i + 1])) &&
+			isxdigit(static_cast<unsigned char>(path[i + 2])))
+		{
+			file += static_cast<char>(std::stoi(path.substr(i + 1, 2), nullptr, 16));
+			i += 2;
+		}
+		else
+			file += path[i];
+	}
+	if (file.size() == 0 || file[0] != '/')
+		return false;
+	file.erase(0, 1);
+	if (file == "")
+		file = "index.html";
+	if (file.find("..") != std::string::npos || file.find_first_of("\\:") != std::string::npos)
+		return false;
+	size_t slash = file.find('/');
+	if (slash == 0 || (slash != std::string::npos && file.find('/', slash + 1) != std::string::npos))
+		return false;
+	return contentType(file) != "";
+}
+//----< media type of a served file, "" if it isn't served >---------
+
+std::string StaticHttp::contentType(const std::string& file)
+{
+	std::string ext = FileSystem::Path::toLower(FileSystem::Path::getExt(file));
+	if (ext == "html" || ext == "htm")
+		return "text/html; charset=utf-8";
+	if (ext == "css")
+		return "text/css";
+	if (ext == "js")
+		return "application/javascript";
+	return "";
+}
+//----< does an Accept-Encoding value accept coding, without q=0? >--
+
+bool StaticHttp::accepts(const std::string& acceptEncoding, const std::string& coding)
+{
+	std::string value = FileSystem::Path::toLower(acceptEncoding);
+	size_t pos = 0;
+	while (pos < value.size())
+	{
+		size_t end = value.find(',', pos);
+		if (end == std::string::npos)
+			end = value.size();
+		std::string item = value.substr(pos, end - pos);
+		pos = end + 1;
+		size_t params = item.find(';');
+		std::string name = Utilities::StringHelper::trim(item.substr(0, params));
+		if (name != coding)
+			continue;
+		if (params == std::string::npos)
+			return true;
+		std::string q = item.substr(params + 1);
+		q.erase(std::remove(q.begin(), q.end(), ' '), q.end());
+		return q.compare(0, 2, "q=") != 0 || q.find_first_not_of("0.", 2) != std::string::npos;
+	}
+	return false;
+}
+//----< the file sent for fqname: itself, or a variant the browser accepts >--
+/*
+ * - a variant, fqname.br or fqname.gz, is written after the page it
+ *   compresses, one older than the page is left over and isn't sent
+ * - encoding is set to the variant's Content-Encoding, "" for none
+ */
+std::string StaticHttp::variant(const std::string& fqname, const std::string& acceptEncoding, std::string& encoding)
+{
+	encoding = "";
+	if (acceptEncoding == "")
+		return fqname;
+	for (auto& v : Variants)
+	{
+		std::string compressed = fqname + v.second;
+		if (!accepts(acceptEncoding, v.first) || !FileSystem::File::exists(compressed))
+			continue;
+		FileSystem::FileInfo info(compressed);
+		if (!info.good() || info.earlier(FileSystem::FileInfo(fqname)))
+			continue;
+		encoding = v.first;
+		return compressed;
+	}
+	return fqname;
+}
+//----< packed page sent for file: itself, or a packed variant accepted >--
+
+PackReader::Page StaticHttp::packedVariant(const std::string& file, const PackReader::Page& page,
+	const std::string& acceptEncoding, std::string& encoding)
+{
+	encoding = "";
+	for (auto& v : Variants)
+	{
+		if (acceptEncoding == "" || !accepts(acceptEncoding, v.first))
+			continue;
+		PackReader::Page compressed = pPack_->find(file + v.second);
+		if (compressed.found)
+		{
+			encoding = v.first;
+			return compressed;
+		}
+	}
+	return page;
+}
+//----< page listing the published pages, for "/" without index.html >--
+
+std::string StaticHttp::listing()
+{
+	std::vector<std::string> pages = FileSystem::Directory::getFiles(root_, "*.html");
+	if (pPack_ != nullptr)
+	{
+		std::vector<std::string> packed = pPack_->names(".html");
+		pages.insert(pages.end(), packed.begin(), packed.end());
+	}
+	if (pGenerations_ != nullptr)
+	{
+		std::vector<std::string> staged = pGenerations_->names(".html");
+		pages.insert(pages.end(), staged.begin(), staged.end());
+	}
+	std::sort(pages.begin(), pages.end());
+	pages.erase(std::unique(pages.begin(), pages.end()), pages.end());
+	std::ostringstream out;
+	out << "<!DOCTYPE html>\n<html>\n<head><title>Published pages</title></head>\n<body>\n<h3>Published pages</h3>\n<ul>\n";
+	for (auto& page : pages)
+		out << "<li><a href=\"/" << page << "\">" << page << "</a></li>\n";
+	out << "</ul>\n</body>\n</html>\n";
+	return out.str();
+}
+//----< send status line, headers, and a body held in memory >-------
+
+bool StaticHttp::reply(Socket& socket, const std::string& status, const std::string& headers, const std::string& body,
+	bool keepAlive, bool withBody)
+{
+	std::string response = "HTTP/1.1 " + status + "\r\n" + headers +
+		"Content-Length: " + Converter<size_t>::toString(body.size()) + "\r\n" +
+		(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") + "\r\n";
+	if (withBody)
+	{
+		response += body;
+		bytes_ += body.size();
+	}
+	return socket.send(response.size(), (Socket::byte*)response.c_str());
+}
+//----< answer one request, true if the connection is kept for more >--
+/*
+ * - count is the number of requests on this connection, this one too
+ * - GET and HEAD only, other methods are answered 405 and the
+ *   connection closed, as any body they carry isn't read
+ * - If-None-Match with the file's etag, or "*", is answered 304
+ * - a page in the pack is sent from its mapping, its etag is its
+ *   content hash, other files are sent with TransmitFile, from the
+ *   committed generation if it holds them
+ */
+bool StaticHttp::serve(HttpMessage& request, Socket& socket, size_t count)
+{
+	++requests_;
+	std::istringstream line(request.findValue("HTTP"));
+	std::string method, target, version;
+	line >> method >> target >> version;
+	std::string connection = FileSystem::Path::toLower(header(request, "Connection"));
+	bool keepAlive = (version == "HTTP/1.1") ? connection.find("close") == std::string::npos
+		: connection.find("keep-alive") != std::string::npos;
+	keepAlive = keepAlive && count < MaxRequests;
+	bool head = (method == "HEAD");
+	if (method != "GET" && !head)
+	{
+		reply(socket, "405 Method Not Allowed", "Allow: GET, HEAD\r\n", "", false, false);
+		return false;
+	}
+	std::string kept = keepAlive ? "Keep-Alive: timeout=" + Converter<size_t>::toString(size_t(KeepAliveMs / 1000)) +
+		", max=" + Converter<size_t>::toString(size_t(MaxRequests)) + "\r\n" : "";
+	std::string file;
+	if (!resolve(target, file))
+	{
+		++notFound_;
+		return reply(socket, "404 Not Found", kept + "Content-Type: text/plain\r\n", "not found\n", keepAlive, !head) && keepAlive;
+	}
+	std::string fqname = pGenerations_ ? pGenerations_->find(file) : root_ + file;
+	PackReader::Page packed = pPack_ ? pPack_->find(file) : PackReader::Page();
+	std::string stamp = packed.found ? "" : PublishManifest::stamp(fqname);
+	if (!packed.found && stamp == "")
+	{
+		if (file == "index.html")
+			return reply(socket, "200 OK", kept + "Content-Type: text/html; charset=utf-8\r\nCache-Control: no-cache\r\n",
+				listing(), keepAlive, !head) && keepAlive;
+		++notFound_;
+		return reply(socket, "404 Not Found", kept + "Content-Type: text/plain\r\n", "not found\n", keepAlive, !head) && keepAlive;
+	}
+	std::string encoding, sent, etag;
+	if (packed.found)
+	{
+		packed = packedVariant(file, packed, header(request, "Accept-Encoding"), encoding);
+		etag = "W/\"" + packed.etag + "\"";
+	}
+	else
+	{
+		sent = variant(fqname, header(request, "Accept-Encoding"), encoding);
+		if (sent != fqname)
+			stamp = PublishManifest::stamp(sent);
+		etag = "W/\"" + PublishManifest::textHash(stamp) + "\"";
+	}
+	if (encoding != "")
+		++compressed_;
+	std::string headers = kept + "ETag: " + etag + "\r\nCache-Control: no-cache\r\nVary: Accept-Encoding\r\n" +
+		(encoding != "" ? "Content-Encoding: " + encoding + "\r\n" : "");
+	std::string ifNoneMatch = header(request, "If-None-Match");
+	if (ifNoneMatch != "" && (ifNoneMatch.find(etag) != std::string::npos || ifNoneMatch == "*"))
+	{
+		++notModified_;
+		std::string response = "HTTP/1.1 304 Not Modified\r\n" + headers +
+			(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") + "\r\n";
+		return socket.send(response.size(), (Socket::byte*)response.c_str()) && keepAlive;
+	}
+	size_t size = packed.found ? packed.size : FileSystem::FileInfo(sent).size();
+	std::string response = "HTTP/1.1 200 OK\r\n" + headers + "Content-Type: " + contentType(file) + "\r\n" +
+		"Content-Length: " + Converter<size_t>::toString(size) + "\r\n" +
+		(keepAlive ? "Connection: keep-alive\r\n" : "Connection: close\r\n") + "\r\n";
+	if (!socket.send(response.size(), (Socket::byte*)response.c_str()))
+		return false;
+	if (head || size == 0)
+		return keepAlive;
+	bool sentBody = packed.found ? socket.send(size, const_cast<Socket::byte*>(packed.bytes)) : socket.sendFile(sent, size);
+	if (!sentBody)
+		return false;
+	bytes_ += size;
+	return keepAlive;
+}
+//----< wait for the next request on a kept connection >-------------
+
+bool StaticHttp::waitForRequest(Socket& socket)
+{
+	const size_t Check = 10;
+	for (size_t waited = 0; socket.bytesWaiting() == 0; waited += Check)
+	{
+		if (waited >= KeepAliveMs)
+			return false;
+		::Sleep((DWORD)Check);
+	}
+	return true;
+}
+
+StaticHttp::Stats StaticHttp::stats()
+{
+	Stats stats;
+	stats.requests = requests_;
+	stats.notModified = notModified_;
+	stats.notFound = notFound_;
+	stats.bytes = bytes_;
+	stats.compressed = compressed_;
+	return stats;
+}
@@ -0,0 +1,136 @@
+#ifndef STATICHTTP_H
+#define STATICHTTP_H
+///////////////////////////////////////////////////////////////////////////
+// StaticHttp.h - Serves published pages to browsers over HTTP/1.1       //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* StaticHttp answers browsers' HTTP/1.1 GET and HEAD requests for the
+* pages the analyzer publishes into the Repository, and the shared CSS
+* and JS under assets/, on MsgServer's own port.  A browser's request
+* line, e.g., "GET /Parser.cpp.html HTTP/1.1", is told apart from a
+* client's messages by isRequestLine, so browsers and MsgClients use the
+* same listener.
+*
+* Only .html, .htm, .css, and .js files in the Repository or one
+* directory below it, e.g., assets/ or a package's pages, are served, so
+* sources and server files can't be fetched.  "/" is index.html, or a
+* list of the published pages if there is none.
+*
+* Each reply has Content-Length and a weak ETag made from the file's
+* last write time and size, so a conditional GET, If-None-Match, is
+* answered 304 without the file being read.  The body is sent with
+* Socket::sendFile, TransmitFile, from the file system cache, without
+* being copied through the server.
+*
+* A file may have compressed variants beside it, written when it was
+* published, e.g., Parser.cpp.html.gz by the analyzer's /z option, or a
+* .br made by another tool.  A browser whose Accept-Encoding accepts one
+* is sent it, with Content-Encoding and its own ETag, so serving costs
+* no compression per request.  Replies say Vary: Accept-Encoding.
+*
+* Given a PackReader, pages the analyzer published into its PagePack,
+* the /k option, are found there first and sent from the mapped pack,
+* with their content hash as ETag, and so are their packed variants.
+*
+* Given a GenerationReader, other pages, and their variants, are sent
+* from the generation the analyzer last committed, the /g option, so a
+* run in progress can't hand browsers pages half written or a mix of
+* two runs.  Files the generation doesn't hold, e.g., CSS and JS, are
+* sent from the Repository as before.
+*
+* Connections are kept alive, HTTP/1.1 unless the browser sends
+* Connection: close, HTTP/1.0 only if it asks, for up to MaxRequests
+* requests each.  A kept connection holds one of the listener's workers,
+* so waitForRequest lets it go after KeepAliveMs without a request.
+*
+* Public Interface
+* --------------------
+* StaticHttp http("../Repository/", &packs);      //packs, a PackReader, may be nullptr
+* StaticHttp http("../Repository/", &packs, &gens); //gens, a GenerationReader, may be nullptr
+* bool browser = StaticHttp::isRequestLine(line);  //"METHOD target HTTP/1.x"
+* bool keep = http.serve(request, socket, count);  //request's attribute "HTTP" is the request line
+* bool more = http.waitForRequest(socket);         //false once the connection is idle too long
+* StaticHttp::Stats stats = http.stats();          //requests, not modified, not found, bytes, compressed
+*
+* Required Files:
+* ---------------
+*   StaticHttp.h, StaticHttp.cpp
+*   HttpMessage.h, HttpMessage.cpp
+*   Sockets.h, Sockets.cpp
+*   PublishManifest.h, PublishManifest.cpp, PagePack.h, PagePack.cpp
+*   PageGenerations.h, PageGenerations.cpp
+*   FileSystem.h, FileSystem.cpp
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.3 : 14 Oct 2026
+* - serves pages from the committed generation of a GenerationReader
+* Ver 1.2 : 14 Oct 2026
+* - serves pages from a PackReader's mapped pack, before loose files
+* Ver 1.1 : 14 Oct 2026
+* - sends a page's .br or .gz variant to browsers that accept it
+* - serves files one directory below the Repository, where pages are published
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../HttpMessage/HttpMessage.h"
+#include "../Sockets/Sockets.h"
+#include "../CodePublisher/PagePack.h"
+#include "../CodePublisher/PageGenerations.h"
+#include <string>
+#include <atomic>
+
+class StaticHttp
+{
+public:
+	static const size_t KeepAliveMs = 5000;   // idle time before a kept connection is closed
+	static const size_t MaxRequests = 100;    // requests on one connection
+	struct Stats
+	{
+		size_t requests = 0;
+		size_t notModified = 0;
+		size_t notFound = 0;
+		size_t bytes = 0;       // body bytes sent
+		size_t compressed = 0;  // replies with a compressed variant
+	};
+
+	StaticHttp(const std::string& root, PackReader* pPack = nullptr, GenerationReader* pGenerations = nullptr)
+		: root_(root), pPack_(pPack), pGenerations_(pGenerations) {}
+	static bool isRequestLine(const std::string& line);
+	bool serve(HttpMessage& request, Socket& socket, size_t count);
+	bool waitForRequest(Socket& socket);
+	Stats stats();
+private:
+	static std::string header(const HttpMessage& msg, const std::string& name);
+	static bool resolve(const std::string& target, std::string& file);
+	static std::string contentType(const std::string& file);
+	static bool accepts(const std::string& acceptEncoding, const std::string& coding);
+	static std::string variant(const std::string& fqname, const std::string& acceptEncoding, std::string& encoding);
+	PackReader::Page packedVariant(const std::string& file, const PackReader::Page& page,
+		const std::string& acceptEncoding, std::string& encoding);
+	std::string listing();
+	bool reply(Socket& socket, const std::string& status, const std::string& headers, const std::string& body,
+		bool keepAlive, bool withBody);
+
+	std::string root_;
+	PackReader* pPack_;
+	GenerationReader* pGenerations_;
+	std::atomic<size_t> requests_{ 0 };
+	std::atomic<size_t> notModified_{ 0 };
+	std::atomic<size_t> notFound_{ 0 };
+	std::atomic<size_t> bytes_{ 0 };
+	std::atomic<size_t> compressed_{ 0 };
+};
+#endif
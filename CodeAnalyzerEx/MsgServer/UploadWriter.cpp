@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////
+// UploadWriter.cpp - Writes uploaded files a segment at a time          //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+#include "UploadWriter.h"
+#include <fstream>
+#include <mutex>
+#include <condition_variable>
+
+/////////////////////////////////////////////////////////////////////
+// File holds the stream and the count of segments not yet written
+
+struct UploadWriter::File
+{
+	std::ofstream out;
+	std::mutex mtx;
+	std::condition_variable written;
+	size_t pending = 0;
+	bool ok = true;
+};
+
+UploadWriter::UploadWriter(size_t maxQueued)
+	: queue_(maxQueued > 0 ? maxQueued : 1), writer_([this] { run(); }) {}
+
+//----< write what's queued, then stop the writer >------------------
+
+UploadWriter::~UploadWriter()
+{
+	Segment quit;
+	queue_.enQ(std::move(quit));
+	writer_.join();
+}
+//----< create fqname for writing, with keep, open it as it is >-----
+/*
+ * - with keep a file that isn't there is created
+ */
+UploadWriter::FilePtr UploadWriter::open(const std::string& fqname, bool keep)
+{
+	FilePtr file = std::make_shared<File>();
+	if (keep)
+	{
+		std::ofstream(fqname, std::ios::out | std::ios::binary | std::ios::app);
+		file->out.open(fqname, std::ios::in | std::ios::out | std::ios::binary);
+	}
+	else
+		file->out.open(fqname, std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!file->out.good())
+		return nullptr;
+	return file;
+}
+//----< queue a segment of file, waits while the queue is full >------
+
+void UploadWriter::write(const FilePtr& file, std::vector<char>&& bytes)
+{
+	enQ(file, Append, std::move(bytes), nullptr);
+}
+//----< queue a segment to be written at offset in file >------------
+
+void UploadWriter::writeAt(const FilePtr& file, size_t offset, std::vector<char>&& bytes, const Written& written)
+{
+	enQ(file, offset, std::move(bytes), written);
+}
+
+void UploadWriter::enQ(const FilePtr& file, size_t offset, std::vector<char>&& bytes, const Written& written)
+{
+	{
+		std::lock_guard<std::mutex> lock(file->mtx);
+		++file->pending;
+	}
+	Segment segment;
+	segment.file = file;
+	segment.bytes = std::move(bytes);
+	segment.offset = offset;
+	segment.written = written;
+	queue_.enQ(std::move(segment));
+}
+//----< wait for file's segments to be written, then close it >------
+
+bool UploadWriter::close(const FilePtr& file)
+{
+	if (!file)
+		return false;
+	std::unique_lock<std::mutex> lock(file->mtx);
+	file->written.wait(lock, [&file] { return file->pending == 0; });
+	file->out.close();
+	return file->ok && !file->out.fail();
+}
+//----< writer thread, segments in the order they were queued >------
+
+void UploadWriter::run()
+{
+	while (true)
+	{
+		Segment segment = queue_.deQ();
+		if (!segment.file)
+			return;
+		File& file = *segment.file;
+		if (segment.offset != Append)
+			file.out.seekp(static_cast<std::streamoff>(segment.offset));
+		bool ok = file.out.good() && (segment.bytes.size() == 0 ||
+			file.out.write(&segment.bytes[0], segment.bytes.size()).good());
+		if (segment.written)
+			segment.written(ok && file.out.flush().good());   // on its way to disk before it's recorded
+		std::lock_guard<std::mutex> lock(file.mtx);
+		file.ok = file.ok && ok;
+		if (--file.pending == 0)
+			file.written.notify_all();
+	}
+}
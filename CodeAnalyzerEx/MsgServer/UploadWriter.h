@@ -0,0 +1,98 @@
+#ifndef UPLOADWRITER_H
+#define UPLOADWRITER_H
+///////////////////////////////////////////////////////////////////////////
+// UploadWriter.h - Writes uploaded files a segment at a time            //
+// ChandraHarsha, CSE687 - Object Oriented Design, Spring 2017           //
+// Application: Remote Code Publisher                                    //
+// Platform:    LenovoFlex4, Win 10, Visual Studio 2015                  //
+///////////////////////////////////////////////////////////////////////////
+
+/*
+* Package Operations:
+* -------------------
+* UploadWriter writes the files clients upload, for every connection, on
+* one writer thread.  A connection receives a segment of a file, hands it
+* to write, and goes on receiving.  At most maxQueued segments wait to be
+* written, write blocks while that many are queued, so the memory held
+* for uploads is bounded however many clients push at once.
+*
+* MsgServer grants a client credit for each segment once write returns,
+* so when the disk falls behind, grants are held back and clients pause
+* instead of filling the server's memory.  queued(), the disk queue's
+* depth, goes out with each grant.
+*
+* Segments of one file are written in the order they were handed over,
+* each at the end of the last, or, with writeAt, at a given offset, so
+* the chunks of a resumed upload go where they belong.  A writeAt can
+* name a callable the writer thread calls once the segment is written,
+* e.g., to record a checkpoint.  close waits until every segment of the
+* file is written, and says if all of them were.
+*
+* Public Interface
+* --------------------
+* UploadWriter writer;                                     //default 64 segments queued
+* UploadWriter::FilePtr file = writer.open(fqname);        //nullptr if it can't be created
+* writer.open(fqname, true);                               //keep what fqname holds, to resume
+* writer.write(file, std::move(bytes));                    //waits while the queue is full
+* writer.writeAt(file, offset, std::move(bytes), written); //written(ok) once on disk
+* bool ok = writer.close(file);                            //waits for file's segments
+* size_t depth = writer.queued();                          //segments waiting to be written
+*
+* Required Files:
+* ---------------
+*   UploadWriter.h, UploadWriter.cpp
+*   Cpp11-BlockingQueue.h
+*
+* Build Process:
+* --------------
+*   devenv CodeAnalyzerEx.sln /debug rebuild
+*
+* Maintenance History:
+* --------------------
+* Ver 1.1 : 14 Oct 2026
+* - added writeAt, and open(fqname, true), which keeps the file's contents
+* Ver 1.0 : 14 Oct 2026
+* - first release
+*
+*/
+
+#include "../Logger/Cpp11-BlockingQueue.h"
+#include <string>
+#include <vector>
+#include <memory>
+#include <thread>
+#include <functional>
+
+class UploadWriter
+{
+public:
+	struct File;
+	using FilePtr = std::shared_ptr<File>;
+	using Written = std::function<void(bool ok)>;
+	static const size_t SegmentSize = 256 * 1024;   // a multiple of Compression::MaxBlockSize
+	static const size_t MaxQueued = 64;
+
+	UploadWriter(size_t maxQueued = MaxQueued);
+	~UploadWriter();
+	UploadWriter(const UploadWriter&) = delete;
+	UploadWriter& operator=(const UploadWriter&) = delete;
+	FilePtr open(const std::string& fqname, bool keep = false);
+	void write(const FilePtr& file, std::vector<char>&& bytes);
+	void writeAt(const FilePtr& file, size_t offset, std::vector<char>&& bytes, const Written& written = nullptr);
+	bool close(const FilePtr& file);
+	size_t queued() { return queue_.size(); }
+private:
+	struct Segment
+	{
+		FilePtr file;                  // nullptr tells the writer to quit
+		std::vector<char> bytes;
+		size_t offset;                 // Append writes after the last segment
+		Written written;
+	};
+	static const size_t Append = static_cast<size_t>(-1);
+	void enQ(const FilePtr& file, size_t offset, std::vector<char>&& bytes, const Written& written);
+	void run();
+	Async::BlockingQueue<Segment> queue_;
+	std::thread writer_;
+};
+#endif
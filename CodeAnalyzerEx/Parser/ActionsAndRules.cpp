@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 //  ActionsAndRules.cpp - implements new parsing rules and actions //
-//  ver 3.3                                                        //
+//  ver 3.4                                                        //
 //  Language:      Visual C++ 2008, SP1                            //
 //  Platform:      Dell Precision T7400, Vista Ultimate SP1        //
 //  Application:   Prototype for CSE687 Pr1, Sp09                  //
@@ -13,8 +13,6 @@
 
 using namespace CodeAnalysis;
 
-Repository* Repository::instance;
-
 #ifdef TEST_ACTIONSANDRULES
 
 #include <iostream>
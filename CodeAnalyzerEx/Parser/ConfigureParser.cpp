@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 //  ConfigureParser.cpp - builds and configures parsers            //
-//  ver 3.2                                                        //
+//  ver 3.9                                                        //
 //                                                                 //
 //  Lanaguage:     Visual C++ 2005                                 //
 //  Platform:      Dell Dimension 9150, Windows XP SP2             //
@@ -10,6 +10,7 @@
 /////////////////////////////////////////////////////////////////////
 
 #include <fstream>
+#include <cctype>
 #include "Parser.h"
 #include "../SemiExp/SemiExp.h"
 #include "../Tokenizer/Tokenizer.h"
@@ -19,6 +20,17 @@
 using namespace CodeAnalysis;
 using namespace Scanner;
 
+namespace
+{
+  const unsigned CppRules = 1u << Language::Cpp;
+  const unsigned CSharpRules = 1u << Language::CSharp;
+
+  // units of rules parse may reorder, see Build, other rules are Pinned
+
+  const size_t DefinitionUnit = 1;
+  const size_t CppStatementUnit = 2;
+}
+
 //----< destructor releases all parts >------------------------------
 
 ConfigParseForCodeAnal::~ConfigParseForCodeAnal()
@@ -58,12 +70,28 @@ ConfigParseForCodeAnal::~ConfigParseForCodeAnal()
     pIn->close();
   delete pIn;
 }
-//----< attach toker to a file stream or stringstream >------------
-
+//----< attach toker to a file buffer or file stream >-------------
+/*
+ * - in buffer mode the toker reads the whole file with one call and
+ *   skips a Byte Order Mark itself; with a token cache the text and
+ *   tokens are kept there for later passes
+ * - the parser applies the rules of the language of name's extension
+ */
 bool ConfigParseForCodeAnal::Attach(const std::string& name, bool isFile)
 {
   if(pToker == 0)
     return false;
+  useLanguage(languageOf(name));
+  if (pIn != nullptr)
+  {
+    pIn->close();
+    delete pIn;
+    pIn = nullptr;
+  }
+  if (bufferInput_ && pCache_ != nullptr)
+    return pToker->attachFile(name, *pCache_);
+  if (bufferInput_)
+    return pToker->attachFile(name);
   pIn = new std::ifstream(name);
   if (!pIn->good())
     return false;
@@ -83,8 +111,72 @@ bool ConfigParseForCodeAnal::Attach(const std::string& name, bool isFile)
   }
   return pToker->attach(pIn);
 }
-//----< Here's where all the parts get assembled >-----------------
+//----< attach toker to text of file name that was read ahead >----
+/*
+ * - text is as Toker::readFile reads it; the toker scans it instead of
+ *   reading the file, and with a token cache it becomes name's entry
+ * - in stream mode text isn't used, the file is opened as before
+ */
+bool ConfigParseForCodeAnal::Attach(const std::string& name, std::string&& text)
+{
+  if (pToker == 0)
+    return false;
+  if (!bufferInput_)
+    return Attach(name);
+  useLanguage(languageOf(name));
+  if (pIn != nullptr)
+  {
+    pIn->close();
+    delete pIn;
+    pIn = nullptr;
+  }
+  if (pCache_ != nullptr)
+    return pToker->attachText(name, std::move(text), *pCache_);
+  return pToker->attachText(std::move(text));
+}
+//----< language of a file, C# for .cs files, C++ for the rest >---
 
+Language ConfigParseForCodeAnal::languageOf(const std::string& fileSpec)
+{
+  size_t dot = fileSpec.find_last_of('.');
+  if (dot != std::string::npos && fileSpec.size() - dot == 3 &&
+    std::tolower((unsigned char)fileSpec[dot + 1]) == 'c' && std::tolower((unsigned char)fileSpec[dot + 2]) == 's')
+    return Language::CSharp;
+  return Language::Cpp;
+}
+//----< parse with language's rule chain, and tell the rules >-----
+
+void ConfigParseForCodeAnal::useLanguage(Language language)
+{
+  if (pParser == nullptr)
+    return;
+  pParser->useChain(language);
+  pRepo->language() = language;
+}
+//----< Here's where all the parts get assembled >-----------------
+/*
+ * Rule order dependencies, kept when the parser reorders rules:
+ * - BeginScope and EndScope are pinned first, they return Continue on
+ *   a match so the head that opened a scope is still named by a later
+ *   rule, and PreprocStatement stays ahead of every definition
+ * - the namespace, class, struct, function and control rules are one
+ *   unit: a template struct head has class in it too, function and
+ *   control heads both hold "(", as does "f() try {", and a head left
+ *   after a multiline macro may hold any of them, e.g.,
+ *   "while (0) namespace X {", so which claims a head is the order.
+ *   Each only matches a SemiExp ending in "{"
+ * - CppDeclaration must come before CppExecutable, which also matches
+ *   declarations, so they're one unit.  They only match SemiExps ending
+ *   in ";" or starting with using, and a using head ending in "{",
+ *   e.g., "using S = ref struct Settings {", could be claimed by both
+ *   units, so it's tested in the order added.  The access CppDeclaration
+ *   sets on a class or struct head it doesn't match is set again by the
+ *   head's own action
+ * - CSharpDeclaration is tested on every SemiExp, and sets public
+ *   access even when it doesn't match, e.g. on a member function's
+ *   head, so it and CSharpExecutable are pinned after the definitions
+ * - Default matches everything, so it's pinned last
+ */
 Parser* ConfigParseForCodeAnal::Build()
 {
   try
@@ -122,54 +214,57 @@ Parser* ConfigParseForCodeAnal::Build()
     pNamespaceDefinition = new NamespaceDefinition;
     pHandleNamespaceDefinition = new HandleNamespaceDefinition(pRepo);
     pNamespaceDefinition->addAction(pHandleNamespaceDefinition);
-    pParser->addRule(pNamespaceDefinition);
+    pParser->addRule(pNamespaceDefinition, Parser::AllChains, DefinitionUnit);
 
     pClassDefinition = new ClassDefinition;
     pHandleClassDefinition = new HandleClassDefinition(pRepo);
     pClassDefinition->addAction(pHandleClassDefinition);
-    pParser->addRule(pClassDefinition);
+    pParser->addRule(pClassDefinition, Parser::AllChains, DefinitionUnit);
 
     pStructDefinition = new StructDefinition;
     pHandleStructDefinition = new HandleStructDefinition(pRepo);
     pStructDefinition->addAction(pHandleStructDefinition);
-    pParser->addRule(pStructDefinition);
+    pParser->addRule(pStructDefinition, Parser::AllChains, DefinitionUnit);
 
-    pCppFunctionDefinition = new CppFunctionDefinition;
+    pCppFunctionDefinition = new CppFunctionDefinition(pRepo);
     pHandleCppFunctionDefinition = new HandleCppFunctionDefinition(pRepo);  // no action
     pCppFunctionDefinition->addAction(pHandleCppFunctionDefinition);
-    pParser->addRule(pCppFunctionDefinition);
+    pParser->addRule(pCppFunctionDefinition, CppRules, DefinitionUnit);
 
-    pCSharpFunctionDefinition = new CSharpFunctionDefinition;
+    pCSharpFunctionDefinition = new CSharpFunctionDefinition(pRepo);
     pHandleCSharpFunctionDefinition = new HandleCSharpFunctionDefinition(pRepo);  // no action
     pCSharpFunctionDefinition->addAction(pHandleCSharpFunctionDefinition);
-    pParser->addRule(pCSharpFunctionDefinition);
+    pParser->addRule(pCSharpFunctionDefinition, CSharpRules, DefinitionUnit);
 
     // configure to detect and act on declarations and Executables
 
     pControlDefinition = new ControlDefinition;
     pHandleControlDefinition = new HandleControlDefinition(pRepo);
     pControlDefinition->addAction(pHandleControlDefinition);
-    pParser->addRule(pControlDefinition);
+    pParser->addRule(pControlDefinition, Parser::AllChains, DefinitionUnit);
 
-    pCppDeclaration = new CppDeclaration;
+    pCppDeclaration = new CppDeclaration(pRepo);
     pHandleCppDeclaration = new HandleCppDeclaration(pRepo);
     pCppDeclaration->addAction(pHandleCppDeclaration);
-    pParser->addRule(pCppDeclaration);
+    pParser->addRule(pCppDeclaration, CppRules, CppStatementUnit);
 
-    pCSharpDeclaration = new CSharpDeclaration;
+    pCSharpDeclaration = new CSharpDeclaration(pRepo);
     pHandleCSharpDeclaration = new HandleCSharpDeclaration(pRepo);
     pCSharpDeclaration->addAction(pHandleCSharpDeclaration);
-    pParser->addRule(pCSharpDeclaration);
+    pParser->addRule(pCSharpDeclaration, CSharpRules);
 
-    pCppExecutable = new CppExecutable;
+    pCppExecutable = new CppExecutable(pRepo);
     pHandleCppExecutable = new HandleCppExecutable(pRepo);
     pCppExecutable->addAction(pHandleCppExecutable);
-    pParser->addRule(pCppExecutable);
+    pParser->addRule(pCppExecutable, CppRules, CppStatementUnit);
 
-    pCSharpExecutable = new CSharpExecutable;
+    pCSharpExecutable = new CSharpExecutable(pRepo);
     pHandleCSharpExecutable = new HandleCSharpExecutable(pRepo);
     pCSharpExecutable->addAction(pHandleCSharpExecutable);
-    pParser->addRule(pCSharpExecutable);
+    pParser->addRule(pCSharpExecutable, CSharpRules);
+
+    pParser->unitMatches(DefinitionUnit, TokenSignature::EndsWithOpenBrace);
+    pParser->unitMatches(CppStatementUnit, TokenSignature::EndsWithSemicolon | TokenSignature::StartsWithUsing);
 
     pDefault = new Default;
     pHandleDefault = new HandleDefault(pRepo);
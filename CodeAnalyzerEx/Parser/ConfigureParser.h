@@ -2,7 +2,7 @@
 #define CONFIGUREPARSER_H
 /////////////////////////////////////////////////////////////////////
 //  ConfigureParser.h - builds and configures parsers              //
-//  ver 3.2                                                        //
+//  ver 3.9                                                        //
 //                                                                 //
 //  Lanaguage:     Visual C++ 2005                                 //
 //  Platform:      Dell Dimension 9150, Windows XP SP2             //
@@ -21,6 +21,28 @@
   ConfigParseForCodeAnal config;
   config.Build();
   config.Attach(someFileName);
+  config.Attach(someFileName, std::move(text));  // text Toker::readFile read ahead
+  config.bufferInput(false);   // read through a stream, default is one buffer per file
+  config.useTokenCache(&cache); // record text and tokens of attached files in cache
+  config.useLanguage(Language::CSharp);  // parse with C# rules, Attach picks by extension
+  config.repository();         // Repository holding the AST built by this parser
+
+  Build registers the rules of both languages once.  Scope, namespace,
+  class, struct, and control rules are shared, the C++ and C# rules for
+  function definitions, declarations, and executables each go in their
+  own language's rule chain.  Attach selects the chain, and sets the
+  Repository's language, from the file's extension, so each SemiExp is
+  only tested by its own language's rules.
+
+  Rules are added in units, so a parser told to order rules by cost,
+  Parser::adaptiveOrder, only moves rules whose order doesn't matter.
+  Build's comment lists the dependencies that decided the units.
+
+  Each builder is one parse session: it owns its Toker, SemiExp,
+  Parser, and Repository, and the Repository holds the session's AST
+  and ScopeStack.  Rules and actions are handed the Repository when
+  built, so builders used side by side, on one thread or many, never
+  see each other's state.
 
   Build Process:
   ==============
@@ -36,6 +58,29 @@
 
   Maintenance History:
   ====================
+  ver 3.9 : 14 Oct 2026
+  - added Attach(name, text), the file's text already read, e.g., by
+    the executive's ReadAhead, so the parse doesn't wait on the disk
+  ver 3.8 : 14 Oct 2026
+  - rules are added in the units Parser::adaptiveOrder may reorder,
+    with the order dependencies between rules documented in Build
+  ver 3.7 : 14 Oct 2026
+  - added repository(), rules are built with the session's Repository
+    instead of finding it with Repository::getInstance
+  ver 3.6 : 14 Oct 2026
+  - C++ and C# rules are registered in per language rule chains, and
+    Attach selects the chain of the file's language, so a C++ file is
+    no longer tested against the C# grammar, nor a C# file against C++
+  - added useLanguage and languageOf
+  ver 3.5 : 14 Oct 2026
+  - added useTokenCache(...), the parse pass fills a Scanner::TokenCache
+    that later passes read instead of tokenizing files again
+  ver 3.4 : 14 Oct 2026
+  - Attach(...) reads the whole file into the toker's buffer unless
+    bufferInput(false) selects the stream input used before
+  ver 3.3 : 14 Oct 2026
+  - Attach(...) releases the previously attached stream, so one builder
+    can parse many files without leaking a stream per file
   ver 3.2 : 29 Oct 2016
   - added check for Byte Order Mark (BOM) in attach(...)
   ver 3.1 : 27 Aug 16
@@ -69,16 +114,24 @@ namespace CodeAnalysis
     ConfigParseForCodeAnal() : pIn(nullptr) {};
     ~ConfigParseForCodeAnal();
     bool Attach(const std::string& name, bool isFile = true);
+    bool Attach(const std::string& name, std::string&& text);
+    void bufferInput(bool doBuffer = true) { bufferInput_ = doBuffer; }
+    void useTokenCache(Scanner::TokenCache* pCache) { pCache_ = pCache; }
+    void useLanguage(Language language);
+    static Language languageOf(const std::string& fileSpec);
     Parser* Build();
+    Repository* repository() { return pRepo; }
 
   private:
     // Builder must hold onto all the pieces
 
     std::ifstream* pIn;
-    Scanner::Toker* pToker;
-    Scanner::SemiExp* pSemi;
-    Parser* pParser;
-    Repository* pRepo;
+    bool bufferInput_ = true;
+    Scanner::TokenCache* pCache_ = nullptr;
+    Scanner::Toker* pToker = nullptr;
+    Scanner::SemiExp* pSemi = nullptr;
+    Parser* pParser = nullptr;
+    Repository* pRepo = nullptr;
 
     // add Rules and Actions
 
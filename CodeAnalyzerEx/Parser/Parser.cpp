@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 //  Parser.cpp - Analyzes C++ language constructs                  //
-//  ver 1.5                                                        //
+//  ver 2.0                                                        //
 //  Language:      Visual C++ 2008, SP1                            //
 //  Platform:      Dell XPS 8900, Windows 10                       //
 //  Application:   Prototype for CSE687 Pr1, Sp09, ...             //
@@ -9,7 +9,13 @@
 /////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <sstream>
+#include <iomanip>
+#include <typeinfo>
 #include <string>
+#include <chrono>
+#include <limits>
+#include <algorithm>
 #include "../Utilities/Utilities.h"
 #include "../Tokenizer/Tokenizer.h"
 #include "../SemiExp/SemiExp.h"
@@ -22,11 +28,206 @@ using namespace Scanner;
 using namespace Utilities;
 using Demo = Logging::StaticLogger<1>;
 
-//----< register parsing rule >--------------------------------
-
-void Parser::addRule(IRule* pRule)
+//----< register parsing rule, in the chains whose bits are set >--
+/*
+* - unit is Pinned, or the unit of rules the rule moves with when
+*   parse orders rules adaptively, see Parser.h
+*/
+void Parser::addRule(IRule* pRule, unsigned ruleChains, size_t unit)
 {
   rules.push_back(pRule);
+  triggers.push_back(pRule->triggers());
+  chains.push_back(ruleChains);
+  pRule->timeActions(timed_);
+  RuleStats ruleStats;
+  ruleStats.unit = unit;
+  ruleStats.rule = typeid(*pRule).name();
+  size_t pos = ruleStats.rule.rfind("::");
+  if (pos < ruleStats.rule.size())
+    ruleStats.rule = ruleStats.rule.substr(pos + 2);
+  stats.push_back(ruleStats);
+  selectRules();
+}
+//----< compute which tokens rules look for, in one pass >-----
+
+unsigned TokenSignature::of(Scanner::ITokCollection& tc)
+{
+  if (tc.length() == 0)
+    return All;
+  using Scanner::KeyWords;
+  const Scanner::ITokCollection& tokens = tc;
+  unsigned keys = tokens.keyWordMask();
+  unsigned signature = 0;
+  if (keys & KeyWords::OpenBrace)
+    signature |= OpenBrace;
+  if (keys & KeyWords::CloseBrace)
+    signature |= CloseBrace;
+  if (keys & KeyWords::Colon)
+    signature |= Colon;
+  if (keys & KeyWords::Hash)
+    signature |= Hash;
+  if (keys & KeyWords::Namespace)
+    signature |= NamespaceKeyword;
+  if (keys & KeyWords::Class)
+    signature |= ClassKeyword;
+  if (keys & KeyWords::Struct)
+    signature |= StructKeyword;
+  if (keys & KeyWords::Access)
+    signature |= AccessKeyword;
+  size_t last = tokens.length() - 1;
+  if (tokens.keyWords(last) & KeyWords::OpenBrace)
+    signature |= EndsWithOpenBrace;
+  if (tokens.find(";", last) == last)
+    signature |= (last == 0) ? (EndsWithSemicolon | LoneSemicolon) : EndsWithSemicolon;
+  if (tokens[0] == "using")
+    signature |= StartsWithUsing;
+  return signature;
+}
+//----< apply only the rules in chain, for chain < 32 >--------
+
+void Parser::useChain(size_t chain)
+{
+  if (chain == chain_ || chain >= 32)
+    return;
+  chain_ = chain;
+  selectRules();
+}
+//----< rules of the chain in use, ordered by stats if adaptive >--
+
+void Parser::selectRules()
+{
+  added.clear();
+  units.clear();
+  for (size_t i = 0; i < rules.size(); ++i)
+  {
+    if (chain_ != AllChains && (chains[i] & (1u << chain_)) == 0)
+      continue;
+    added.push_back(i);
+    size_t unit = stats[i].unit;
+    if (unit != Pinned && std::find(units.begin(), units.end(), unit) == units.end())
+      units.push_back(unit);
+  }
+  active = added;
+  if (period_ > 0)
+    reorder();
+}
+//----< rules of unit only match SemiExps with one of signature's bits >--
+
+void Parser::unitMatches(size_t unit, unsigned signature)
+{
+  if (unit == Pinned)
+    return;
+  if (unitSignatures.size() <= unit)
+    unitSignatures.resize(unit + 1, TokenSignature::All);
+  unitSignatures[unit] = signature;
+}
+//----< could rules of more than one active unit match signature? >--
+
+bool Parser::contested(unsigned signature) const
+{
+  size_t claimants = 0;
+  for (size_t unit : units)
+  {
+    unsigned matches = (unit < unitSignatures.size()) ? unitSignatures[unit] : TokenSignature::All;
+    if ((signature & matches) != 0 && ++claimants > 1)
+      return true;
+  }
+  return false;
+}
+//----< add each test's time, less its actions, to rule stats >--
+
+void Parser::timeRules(bool doTime)
+{
+  timed_ = doTime;
+  for (auto pRule : rules)
+    pRule->timeActions(doTime);
+}
+//----< reorder rule units every period SemiExps, 0 to stop >----
+/*
+* - ordering needs test times, so rules are timed from now on
+* - period 0 restores the order rules were added in
+*/
+void Parser::adaptiveOrder(size_t period)
+{
+  period_ = period;
+  untilReorder_ = period;
+  if (period > 0)
+    timeRules(true);
+  selectRules();
+}
+//----< order units between pinned rules by ms of tests per match >--
+/*
+* - each run of unpinned rules is ordered on its own, so no rule
+*   crosses a pinned one
+* - a unit's rules are gathered in the order they were added, units
+*   are placed cheapest first, with units that haven't matched last
+*   and ties kept in their current order
+*/
+void Parser::reorder()
+{
+  std::vector<size_t> ordered;
+  size_t begin = 0;
+  while (begin < active.size())
+  {
+    if (stats[active[begin]].unit == Pinned)
+    {
+      ordered.push_back(active[begin++]);
+      continue;
+    }
+    size_t end = begin;
+    while (end < active.size() && stats[active[end]].unit != Pinned)
+      ++end;
+
+    std::vector<size_t> runUnits;
+    std::vector<double> cost;
+    for (size_t i = begin; i < end; ++i)
+    {
+      const RuleStats& ruleStats = stats[active[i]];
+      size_t u = std::find(runUnits.begin(), runUnits.end(), ruleStats.unit) - runUnits.begin();
+      if (u == runUnits.size())
+      {
+        runUnits.push_back(ruleStats.unit);
+        cost.push_back(0.0);
+      }
+      cost[u] += ruleStats.millis;
+    }
+    for (size_t u = 0; u < runUnits.size(); ++u)
+    {
+      size_t matches = 0;
+      for (size_t i = begin; i < end; ++i)
+      {
+        if (stats[active[i]].unit == runUnits[u])
+          matches += stats[active[i]].matches;
+      }
+      cost[u] = (matches > 0) ? cost[u] / matches : std::numeric_limits<double>::infinity();
+    }
+    std::vector<size_t> byCost(runUnits.size());
+    for (size_t u = 0; u < runUnits.size(); ++u)
+      byCost[u] = u;
+    std::stable_sort(byCost.begin(), byCost.end(), [&](size_t a, size_t b) { return cost[a] < cost[b]; });
+
+    std::vector<size_t> run(active.begin() + begin, active.begin() + end);
+    std::sort(run.begin(), run.end());   // rule indices are the order rules were added in
+    for (size_t u : byCost)
+    {
+      for (size_t rule : run)
+      {
+        if (stats[rule].unit == runUnits[u])
+          ordered.push_back(rule);
+      }
+    }
+    begin = end;
+  }
+  active.swap(ordered);
+}
+//----< names of the rules parse applies, in the order tested >--
+
+std::vector<std::string> Parser::ruleOrder() const
+{
+  std::vector<std::string> names;
+  for (size_t i : active)
+    names.push_back(stats[i].rule);
+  return names;
 }
 //----< get next ITokCollection >------------------------------
 
@@ -38,7 +239,6 @@ bool Parser::next()
   {
     return false;
   }
-  std::string debug = pTokColl->show();
   //GrammarHelper::showParseDemo("get SemiExp: ", *pTokColl);
 
   pTokColl->trim();
@@ -46,20 +246,76 @@ bool Parser::next()
   return true;
 }
 
-//----< parse the SemiExp by applying all rules to it >--------
-
+//----< parse the SemiExp by applying the chain's rules to it >--
+/*
+* - rules are tested in adaptive order unless rules of two units
+*   could match the SemiExp, then in the order they were added
+*/
 bool Parser::parse()
 {
-  for (size_t i = 0; i<rules.size(); ++i)
+  if (period_ > 0 && --untilReorder_ == 0)
   {
-    std::string debug = pTokColl->show();
-
-    bool doWhat = rules[i]->doTest(pTokColl);
+    reorder();
+    untilReorder_ = period_;
+  }
+  unsigned signature = TokenSignature::of(*pTokColl);
+  const std::vector<size_t>& order = (period_ > 0 && contested(signature)) ? added : active;
+  for (size_t i : order)
+  {
+    if ((signature & triggers[i]) == 0)
+    {
+      ++stats[i].skips;
+      continue;
+    }
+    size_t matches = rules[i]->matches();
+    ++stats[i].tests;
+    bool doWhat;
+    if (timed_)
+    {
+      using Clock = std::chrono::steady_clock;
+      double actions = rules[i]->actionMillis();
+      Clock::time_point start = Clock::now();
+      doWhat = rules[i]->doTest(pTokColl);
+      double millis = std::chrono::duration<double, std::milli>(Clock::now() - start).count();
+      stats[i].millis += millis - (rules[i]->actionMillis() - actions);
+    }
+    else
+      doWhat = rules[i]->doTest(pTokColl);
+    stats[i].matches += rules[i]->matches() - matches;
     if (doWhat == IRule::Stop)
       break;
   }
   return true;
 }
+//----< zero the counts of rule tests, skips, and matches >----
+
+void Parser::resetRuleStats()
+{
+  for (auto& ruleStats : stats)
+  {
+    ruleStats.tests = ruleStats.skips = ruleStats.matches = 0;
+    ruleStats.millis = 0.0;
+  }
+}
+//----< one line per rule with its tests, skips, and matches >-
+/*
+* - while rules are timed, each line ends with the rule's test ms
+*/
+
+std::string Parser::showRuleStats() const
+{
+  std::ostringstream out;
+  for (auto& ruleStats : stats)
+  {
+    out << "\n  " << std::setw(26) << std::left << ruleStats.rule << std::right
+      << std::setw(8) << ruleStats.tests << " tests"
+      << std::setw(8) << ruleStats.skips << " skips"
+      << std::setw(8) << ruleStats.matches << " matches";
+    if (timed_)
+      out << std::fixed << std::setprecision(3) << std::setw(10) << ruleStats.millis << " ms";
+  }
+  return out.str();
+}
 //----< register action with a rule >--------------------------
 
 void IRule::addAction(IAction *pAction)
@@ -70,9 +326,15 @@ void IRule::addAction(IAction *pAction)
 
 void IRule::doActions(const ITokCollection* pTokColl)
 {
+  ++matches_;
+  std::chrono::steady_clock::time_point start;
+  if (timeActions_)
+    start = std::chrono::steady_clock::now();
   if(actions.size() > 0)
     for(size_t i=0; i<actions.size(); ++i)
       actions[i]->doAction(pTokColl);
+  if (timeActions_)
+    actionMillis_ += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
 }
 
 //----< test stub >--------------------------------------------
@@ -123,14 +385,21 @@ int main(int argc, char* argv[])
         std::cout << "\n\n  Parser not built\n\n";
         return 1;
       }
-      // now that parser is built, use it
+      // now that parser is built, use it, ordering rules as it goes
 
+      pParser->adaptiveOrder(64);
       while(pParser->next())
         pParser->parse();
       std::cout << "\n";
+      std::cout << "\n  rule tests for this file:" << pParser->showRuleStats() << "\n";
+      std::cout << "\n  rules tested in order:";
+      for (auto& rule : pParser->ruleOrder())
+        std::cout << " " << rule;
+      std::cout << "\n";
+      pParser->resetRuleStats();
 
       // show AST
-      Repository* pRepo = Repository::getInstance();
+      Repository* pRepo = configure.repository();
       ASTNode* pGlobalScope = pRepo->getGlobalScope();
       TreeWalk(pGlobalScope);
     }
@@ -143,3 +412,222 @@ int main(int argc, char* argv[])
 }
 
 #endif
+
+#ifdef TEST_PARSERBENCH
+
+/////////////////////////////////////////////////////////////////////
+// Benchmark for the front end of the analyzer
+// - runs Toker::getTok, SemiExp::get and Parser::parse over every .h
+//   and .cpp file in a corpus directory, reps times, to scale it up
+// - reports MB/sec, tokens/sec, semis/sec and heap allocations per
+//   token for each stage, then the same numbers as csv lines, to
+//   stdout or to a file, so they can be tracked across releases
+//
+//   usage: Parser [corpusPath [reps [csvFile]]]
+
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <atomic>
+#include <new>
+
+using Clock = std::chrono::high_resolution_clock;
+
+std::atomic<size_t> allocations(0);
+
+//----< count every heap allocation made while benchmarking >--------
+
+void* operator new(size_t size)
+{
+  ++allocations;
+  void* p = std::malloc(size > 0 ? size : 1);
+  if (p == nullptr)
+    throw std::bad_alloc();
+  return p;
+}
+
+void operator delete(void* p) noexcept
+{
+  std::free(p);
+}
+
+struct Stage
+{
+  std::string name;
+  size_t bytes = 0;
+  size_t tokens = 0;
+  size_t semis = 0;
+  size_t allocs = 0;
+  double secs = 0;
+};
+
+//----< tokens only >------------------------------------------------
+
+Stage runToker(const std::vector<std::string>& files, int reps)
+{
+  Stage stage;
+  stage.name = "toker";
+  size_t start = allocations;
+  auto t0 = Clock::now();
+  for (int i = 0; i < reps; ++i)
+  {
+    for (auto& file : files)
+    {
+      Toker toker;
+      if (!toker.attachFile(file))
+        continue;
+      while (toker.getTok() != "")
+        ++stage.tokens;
+    }
+  }
+  stage.secs = std::chrono::duration<double>(Clock::now() - t0).count();
+  stage.allocs = allocations - start;
+  return stage;
+}
+//----< tokens grouped into semi-expressions >-----------------------
+
+Stage runSemiExp(const std::vector<std::string>& files, int reps)
+{
+  Stage stage;
+  stage.name = "semiexp";
+  size_t start = allocations;
+  auto t0 = Clock::now();
+  for (int i = 0; i < reps; ++i)
+  {
+    for (auto& file : files)
+    {
+      Toker toker;
+      if (!toker.attachFile(file))
+        continue;
+      SemiExp semi(&toker);
+      bool more = true;
+      while (more)
+      {
+        more = semi.get();
+        if (semi.length() == 0)
+          continue;
+        ++stage.semis;
+        stage.tokens += semi.length();
+      }
+    }
+  }
+  stage.secs = std::chrono::duration<double>(Clock::now() - t0).count();
+  stage.allocs = allocations - start;
+  return stage;
+}
+//----< semi-expressions run through the analyzer's rules >----------
+
+Stage runParser(const std::vector<std::string>& files, int reps)
+{
+  Stage stage;
+  stage.name = "parser";
+  size_t start = allocations;
+  auto t0 = Clock::now();
+  for (int i = 0; i < reps; ++i)
+  {
+    ConfigParseForCodeAnal configure;
+    Parser* pParser = configure.Build();
+    if (pParser == nullptr)
+      break;
+    for (auto& file : files)
+    {
+      if (!configure.Attach(file))
+        continue;
+      try
+      {
+        while (pParser->next())
+        {
+          pParser->parse();
+          ++stage.semis;
+        }
+      }
+      catch (std::exception& ex)
+      {
+        if (i == 0)
+          std::cout << "\n  parsing " << file << ": " << ex.what();
+      }
+    }
+    if (i == 0)
+      std::cout << "\n\n  rule tests for one pass over the corpus:" << pParser->showRuleStats() << "\n";
+  }
+  stage.secs = std::chrono::duration<double>(Clock::now() - t0).count();
+  stage.allocs = allocations - start;
+  return stage;
+}
+//----< rates, guarding against a stage too fast to time >-----------
+
+double perSec(double amount, double secs)
+{
+  return amount / (secs > 0 ? secs : 1e-9);
+}
+
+void report(const Stage& s)
+{
+  std::cout << "\n  " << std::setw(8) << std::left << s.name << std::right << std::fixed
+    << std::setprecision(2) << std::setw(10) << perSec(s.bytes / (1024.0 * 1024.0), s.secs) << " MB/sec"
+    << std::setw(12) << (size_t)perSec((double)s.tokens, s.secs) << " tokens/sec"
+    << std::setw(10) << (size_t)perSec((double)s.semis, s.secs) << " semis/sec"
+    << std::setw(8) << (double)s.allocs / (s.tokens > 0 ? s.tokens : 1) << " allocs/token";
+}
+
+void writeCsv(std::ostream& out, const std::vector<Stage>& stages, size_t files, int reps)
+{
+  out << std::defaultfloat << std::setprecision(6);
+  out << "stage,files,reps,bytes,tokens,semis,seconds,mb_per_sec,tokens_per_sec,semis_per_sec,allocs_per_token\n";
+  for (auto& s : stages)
+  {
+    out << s.name << "," << files << "," << reps << "," << s.bytes << "," << s.tokens << ","
+      << s.semis << "," << s.secs << ","
+      << perSec(s.bytes / (1024.0 * 1024.0), s.secs) << ","
+      << perSec((double)s.tokens, s.secs) << "," << perSec((double)s.semis, s.secs) << ","
+      << (double)s.allocs / (s.tokens > 0 ? s.tokens : 1) << "\n";
+  }
+}
+
+int main(int argc, char* argv[])
+{
+  std::string path = argc > 1 ? argv[1] : "../TestFiles";
+  int reps = argc > 2 ? atoi(argv[2]) : 10;
+  if (reps < 1)
+    reps = 1;
+  std::vector<std::string> files;
+  size_t bytes = 0;
+  for (auto pattern : { "*.h", "*.cpp" })
+  {
+    for (auto name : FileSystem::Directory::getFiles(path, pattern))
+    {
+      files.push_back(FileSystem::Path::fileSpec(path, name));
+      std::ifstream in(files.back(), std::ios::binary | std::ios::ate);
+      if (in.good())
+        bytes += (size_t)in.tellg();
+    }
+  }
+  std::cout << "\n  " << files.size() << " files, " << bytes << " bytes, " << reps << " reps";
+
+  std::vector<Stage> stages;
+  stages.push_back(runToker(files, reps));
+  stages.push_back(runSemiExp(files, reps));
+  stages.push_back(runParser(files, reps));
+  for (auto& s : stages)
+  {
+    s.bytes = bytes * reps;
+    if (s.name == "parser")
+      s.tokens = stages[0].tokens;   // parser sees the same tokens as toker
+    report(s);
+  }
+  std::cout << "\n\n";
+
+  if (argc > 3)
+  {
+    std::ofstream csv(argv[3]);
+    writeCsv(csv, stages, files.size(), reps);
+  }
+  else
+  {
+    writeCsv(std::cout, stages, files.size(), reps);
+  }
+  std::cout << "\n";
+}
+
+#endif
@@ -2,7 +2,7 @@
 #define PARSER_H
 /////////////////////////////////////////////////////////////////////
 //  Parser.h - Analyzes C++ and C# language constructs             //
-//  ver 1.5                                                        //
+//  ver 2.0                                                        //
 //  Language:      Visual C++, Visual Studio 2015                  //
 //  Platform:      Dell XPS 8900, Windows 10                       //
 //  Application:   Prototype for CSE687 Pr1, Sp09, ...             //
@@ -28,6 +28,47 @@
   parser.addRule(&r1);            // register rule with parser
   while(se.getSemiExp())          // get semi-expression
     parser.parse();               //   and parse it
+  parser.ruleStats();             // tests, skips and matches per rule
+  parser.resetRuleStats();        // start counting again, e.g., per file
+  parser.addRule(&r2, 1 << 2);    // register rule in chain 2 only
+  parser.useChain(2);             // parse tests chain 2's rules, and rules in every chain
+  parser.addRule(&r3, Parser::AllChains, 1);  // register rule in reorderable unit 1
+  parser.unitMatches(1, TokenSignature::EndsWithOpenBrace);  // unit 1 only matches heads
+  parser.timeRules();             // ruleStats also hold ms spent testing each rule
+  parser.adaptiveOrder(256);      // every 256 SemiExps, order units by cost per match
+
+  Each SemiExp's TokenSignature is computed once, and a rule is only
+  tested if the signature has one of the bits its triggers() names.
+  Rules that don't override triggers() are tested on every SemiExp.
+
+  A rule may be registered in some chains only, e.g. the rules for one
+  language.  useChain selects the chain parse applies, keeping the
+  order rules were added in.  Until useChain is called every rule is
+  applied.
+
+  With timeRules, each test's time, less the time of the actions it
+  ran, is added to the rule's stats.  adaptiveOrder times rules and,
+  every period SemiExps, and when useChain selects a chain, orders the
+  units of the rules parse applies by ms of tests per match, cheapest
+  first, units that haven't matched last.  Rules mostly match and stop
+  early, so this tests the rules likely to claim a SemiExp, cheaply,
+  before the ones that rarely do.
+
+  Reordering must not change what's parsed, so addRule and unitMatches
+  say which rules may move, and when:
+  - a rule added to unit Pinned, the default, never moves, and no rule
+    moves past it, e.g. rules that must run first, that return Continue
+    on a match, or that change state when they don't match
+  - rules added with the same unit keep the order they were added in,
+    and move together, so rules whose order matters go in one unit
+  - unitMatches gives the signature bits of which a SemiExp has one if
+    the unit's rules can match it.  A SemiExp that rules of two units
+    could match, or that a unit not given to unitMatches could, is
+    tested in the order rules were added in, so the reordered order is
+    only used where at most one unit can claim the SemiExp
+  - testing a rule that doesn't match must leave what rules of other
+    units see unchanged
+  Parsers that never call adaptiveOrder test rules in the order added.
 
   Build Process:
   ==============
@@ -40,9 +81,32 @@
     - devenv Parser.sln
     - cl /EHsc /DTEST_PARSER parser.cpp semiexpression.cpp tokenizer.cpp \
          ActionsAndRules.cpp ConfigureParser.cpp /link setargv.obj
+  Benchmark
+    - build as above with /DTEST_PARSERBENCH /O2 instead of /DTEST_PARSER
+    - Parser [corpusPath [reps [csvFile]]] times Toker, SemiExp and
+      Parser over corpusPath, reps times, and writes csv results
 
   Maintenance History:
   ====================
+  ver 2.0 : 14 Oct 26
+  - added rule units, timeRules and adaptiveOrder, so rules that don't
+    depend on each other's order are tested cheapest per match first,
+    and test time per rule is kept in RuleStats
+  ver 1.9 : 14 Oct 26
+  - added rule chains: addRule takes a mask of the chains a rule is in,
+    and useChain selects the rules parse applies, so a configuration can
+    hold the rules of several languages and test only one language's
+  ver 1.8 : 14 Oct 26
+  - TokenSignature is built from the SemiExp's KeyWords bits, without
+    iterating, so those bits are computed once for signature and rules
+  ver 1.7 : 14 Oct 26
+  - added TokenSignature and IRule::triggers, so parse tests only the
+    rules that can match, and tests, skips and matches per rule
+  - next and parse no longer build debug strings
+  ver 1.6 : 14 Oct 26
+  - added TEST_PARSERBENCH benchmark stub reporting MB/sec, tokens/sec,
+    semis/sec and allocations per token for tokenizing, collecting
+    semi-expressions and parsing
   ver 1.5 : 19 Aug 16
   - added trimming of semis in Parser::next()
   - changed IRule interface to accept const pointer
@@ -97,9 +161,37 @@ namespace CodeAnalysis
     virtual void doAction(const Scanner::ITokCollection* pTc) = 0;
   };
 
+  ///////////////////////////////////////////////////////////////
+  // signature of a token collection, computed once per SemiExp
+  //   - each bit records a token, or token position, that some
+  //     rule needs before it can match
+
+  struct TokenSignature
+  {
+    enum : unsigned
+    {
+      OpenBrace = 1 << 0,          // has {
+      CloseBrace = 1 << 1,         // has }
+      Colon = 1 << 2,              // has :
+      Hash = 1 << 3,               // has #
+      EndsWithOpenBrace = 1 << 4,
+      EndsWithSemicolon = 1 << 5,
+      LoneSemicolon = 1 << 6,      // just ;
+      NamespaceKeyword = 1 << 7,
+      ClassKeyword = 1 << 8,       // class or interface
+      StructKeyword = 1 << 9,
+      AccessKeyword = 1 << 10,     // public, protected, or private
+      StartsWithUsing = 1 << 11,
+      All = ~0u                    // empty collections, and rules always tested
+    };
+    static unsigned of(Scanner::ITokCollection& tc);
+  };
+
   ///////////////////////////////////////////////////////////////
   // abstract base class for parser language construct detections
   //   - rules are registered with the parser for use
+  //   - triggers returns the signature bits of which at least one
+  //     must be present for doTest to possibly match
 
   class IRule
   {
@@ -110,21 +202,61 @@ namespace CodeAnalysis
     void addAction(IAction* pAction);
     void doActions(const Scanner::ITokCollection* pTc);
     virtual bool doTest(const Scanner::ITokCollection* pTc) = 0;
+    virtual unsigned triggers() const { return TokenSignature::All; }
+    size_t matches() const { return matches_; }
+    void timeActions(bool doTime) { timeActions_ = doTime; }
+    double actionMillis() const { return actionMillis_; }
   protected:
     std::vector<IAction*> actions;
+    size_t matches_ = 0;
+    bool timeActions_ = false;
+    double actionMillis_ = 0.0;   // ms in actions, while timed
   };
 
   class Parser
   {
   public:
+    struct RuleStats
+    {
+      std::string rule;
+      size_t tests = 0;
+      size_t skips = 0;     // not tested, signature had none of its triggers
+      size_t matches = 0;   // tests that invoked the rule's actions
+      double millis = 0.0;  // ms in tests, less their actions, while timed
+      size_t unit = 0;      // Pinned, or the unit the rule moves with
+    };
+    static const unsigned AllChains = ~0u;
+    static const size_t Pinned = 0;
     Parser(Scanner::ITokCollection* pTokCollection);
     ~Parser();
-    void addRule(IRule* pRule);
+    void addRule(IRule* pRule, unsigned chains = AllChains, size_t unit = Pinned);
+    void useChain(size_t chain);
+    void timeRules(bool doTime = true);
+    void adaptiveOrder(size_t period = 256);
+    void unitMatches(size_t unit, unsigned signature);
+    std::vector<std::string> ruleOrder() const;
     bool parse();
     bool next();
+    const std::vector<RuleStats>& ruleStats() const { return stats; }
+    void resetRuleStats();
+    std::string showRuleStats() const;
   private:
+    void selectRules();
+    void reorder();
+    bool contested(unsigned signature) const;
     Scanner::ITokCollection* pTokColl;
     std::vector<IRule*> rules;
+    std::vector<unsigned> triggers;
+    std::vector<unsigned> chains;
+    std::vector<size_t> active;     // indices of the rules parse applies, in test order
+    std::vector<size_t> added;      // the same rules, in the order added
+    std::vector<size_t> units;      // units of the active rules, Pinned excluded
+    std::vector<unsigned> unitSignatures;  // by unit, All for units not given
+    size_t chain_ = AllChains;      // chain in use, AllChains until useChain
+    std::vector<RuleStats> stats;
+    bool timed_ = false;
+    size_t period_ = 0;             // SemiExps between reorders, 0 for order added
+    size_t untilReorder_ = 0;
   };
 
   inline Parser::Parser(Scanner::ITokCollection* pTokCollection) : pTokColl(pTokCollection) {}
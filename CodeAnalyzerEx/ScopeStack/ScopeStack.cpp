@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////////////
 // ScopeStack.cpp - implements template stack holding specified element type //
-// ver 2.2                                                                   //
+// ver 2.3                                                                   //
 // Language:      Visual C++ 2010, SP1                                       //
 // Platform:      Dell Precision T7400, Win 7 Pro SP1                        //
 // Application:   Code Analysis Research                                     //
@@ -123,3 +123,89 @@ int main()
 }
 
 #endif
+
+#ifdef TEST_SCOPESTACKBENCH
+
+#include "ScopeStack.h"
+#include "../Tokenizer/Tokenizer.h"
+#include "../FileSystem/FileSystem.h"
+#include <chrono>
+#include <iomanip>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace CodeAnalysis;
+
+struct element
+{
+  size_t startLineCount = 0;
+  std::string show() { return "(" + std::to_string(startLineCount) + ")"; }
+};
+
+//----< replay brace trace on stack, return pushes and pops per sec >--
+/*
+ * - trace holds the line of each "{" the parser pushes and a 0 for each
+ *   "}" it pops, unmatched closing braces are skipped, as the parser does
+ */
+template <typename Stack>
+double run(const std::vector<size_t>& trace, size_t passes)
+{
+  std::vector<element> elements(trace.size());
+  size_t ops = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (size_t pass = 0; pass < passes; ++pass)
+  {
+    Stack stack;
+    for (size_t i = 0; i < trace.size(); ++i)
+    {
+      if (trace[i] > 0)
+      {
+        elements[i].startLineCount = trace[i];
+        stack.push(&elements[i]);
+      }
+      else if (stack.size() > 0)
+        stack.pop();
+      ++ops;
+    }
+  }
+  std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+  return ops / elapsed.count();
+}
+
+int main(int argc, char* argv[])
+{
+  std::cout << "\n  Comparing vector and list backed ScopeStacks";
+  std::cout << "\n ==============================================";
+
+  std::string path = argc > 1 ? argv[1] : "../TestFiles";
+  std::vector<std::string> files = FileSystem::Directory::getFiles(path, "*.h");
+  std::vector<std::string> cpps = FileSystem::Directory::getFiles(path, "*.cpp");
+  files.insert(files.end(), cpps.begin(), cpps.end());
+
+  std::vector<size_t> trace;
+  for (auto& file : files)
+  {
+    Scanner::Toker toker;
+    if (!toker.attachFile(FileSystem::Path::fileSpec(path, file)))
+      continue;
+    std::string tok;
+    while ((tok = toker.getTok()) != "")
+    {
+      if (tok == "{")
+        trace.push_back(toker.currentLineCount());
+      else if (tok == "}")
+        trace.push_back(0);
+    }
+  }
+  std::cout << "\n  " << files.size() << " files in " << path << ", " << trace.size() << " pushes and pops per pass\n";
+
+  const size_t passes = 2000;
+  double vec = run<ScopeStack<element*>>(trace, passes);
+  double lst = run<ListScopeStack<element*>>(trace, passes);
+  std::cout << "\n  " << std::setw(8) << "vector" << std::setw(14) << (size_t)vec << " ops/s";
+  std::cout << "\n  " << std::setw(8) << "list" << std::setw(14) << (size_t)lst << " ops/s";
+  std::cout << "\n\n";
+}
+
+#endif
@@ -2,7 +2,7 @@
 #define SCOPESTACK_H
 /////////////////////////////////////////////////////////////////////////////
 // ScopeStack.h - implements template stack holding specified element type //
-// ver 2.2                                                                 //
+// ver 2.4                                                                 //
 // Language:      Visual C++ 2010, SP1                                     //
 // Platform:      Dell Precision T7400, Win 7 Pro SP1                      //
 // Application:   Code Analysis Research                                   //
@@ -16,6 +16,13 @@
   is an application specific type designed to hold whatever information you
   need to stack.
 
+  The stack is held in a std::vector by default, so pushes and pops after
+  the first few reuse the same contiguous storage instead of allocating a
+  list node each.  ScopeStack<element, std::list<element>>, also named
+  ListScopeStack<element>, keeps the earlier list layout.  Either container
+  is fine for element pointers, but with the vector a reference returned by
+  top() or predOfTop() is only good until the next push.
+
   Throws std::exception if stack is popped or peeked when empty.
 
   Public Interface:
@@ -25,6 +32,7 @@
   element elem;
   stack.push(elem);
   element popped = stack.pop();
+  ListScopeStack<element> listStack;     // same interface, std::list storage
 
   Required Files:
   ===============
@@ -33,9 +41,16 @@
   Build Command:
   ==============
   devenv ScopeStack.sln /rebuild debug
+  - define TEST_SCOPESTACK for the test stub, TEST_SCOPESTACKBENCH for the
+    vector and list comparison, it also needs Tokenizer and FileSystem
 
   Maintenance History:
   ====================
+  ver 2.4 : 14 Oct 2026
+  - stack is held in a reserved std::vector by default, container is now
+    a second template argument
+  ver 2.3 : 14 Oct 2026
+  - stack size messages are formatted only when the Dbug logger is running
   ver 2.2 : 29 Oct 2016
   - added throw when popping or peeking empty stack
   ver 2.1 : 02 Jun 2011
@@ -47,7 +62,9 @@
   ver 1.0 : 31 Jan 2011
   - first release
 */
+#include <iterator>
 #include <list>
+#include <vector>
 #include "../Logger/Logger.h"
 #include "../Utilities/Utilities.h"
 
@@ -57,13 +74,13 @@
 
 namespace CodeAnalysis
 {
-  template<typename element>
+  template<typename element, typename Container = std::vector<element>>
   class ScopeStack {
   public:
     using Rslt = Logging::StaticLogger<0>;    // show program results
     using Demo = Logging::StaticLogger<1>;    // show demonstration outputs
     using Dbug = Logging::StaticLogger<2>;    // show debugging outputs
-    typename typedef std::list<element>::iterator iterator;
+    typename typedef Container::iterator iterator;
 
     ScopeStack();
     void push(const element& item);
@@ -74,33 +91,44 @@ namespace CodeAnalysis
     iterator begin();
     iterator end();
   private:
-    std::list<element> stack;
+    Container stack;
     element dbElement;
   };
 
   template<typename element>
-  ScopeStack<element>::ScopeStack() {}
+  using ListScopeStack = ScopeStack<element, std::list<element>>;
 
-  template<typename element>
-  typename inline size_t ScopeStack<element>::size() { return stack.size(); }
+  //----< room for a typical nesting depth, vector only >--------------
 
   template<typename element>
-  typename inline ScopeStack<element>::iterator ScopeStack<element>::begin() { return stack.begin(); }
+  void reserveScopes(std::vector<element>& stack) { stack.reserve(32); }
 
-  template<typename element>
-  typename inline ScopeStack<element>::iterator ScopeStack<element>::end() { return stack.end(); }
+  template<typename Container>
+  void reserveScopes(Container&) {}
 
-  template<typename element>
-  void ScopeStack<element>::push(const element& item)
+  template<typename element, typename Container>
+  ScopeStack<element, Container>::ScopeStack() { reserveScopes(stack); }
+
+  template<typename element, typename Container>
+  typename inline size_t ScopeStack<element, Container>::size() { return stack.size(); }
+
+  template<typename element, typename Container>
+  typename inline ScopeStack<element, Container>::iterator ScopeStack<element, Container>::begin() { return stack.begin(); }
+
+  template<typename element, typename Container>
+  typename inline ScopeStack<element, Container>::iterator ScopeStack<element, Container>::end() { return stack.end(); }
+
+  template<typename element, typename Container>
+  void ScopeStack<element, Container>::push(const element& item)
   {
     Demo::flush();
     stack.push_back(item);
-    Dbug::write("\n--- stack size = " + Utilities::Converter<size_t>::toString(size()) + " ---");
+    LOG_WRITE(Dbug, "\n--- stack size = " + Utilities::Converter<size_t>::toString(size()) + " ---");
     Dbug::flush();
   }
 
-  template<typename element>
-  element ScopeStack<element>::pop()
+  template<typename element, typename Container>
+  element ScopeStack<element, Container>::pop()
   {
     if (stack.size() == 0)
     {
@@ -108,14 +136,14 @@ namespace CodeAnalysis
     }
     element item = stack.back();
     stack.pop_back();    
-    Dbug::write("\n--- stack size = " + Utilities::Converter<size_t>::toString(size()) + " ---");
+    LOG_WRITE(Dbug, "\n--- stack size = " + Utilities::Converter<size_t>::toString(size()) + " ---");
     Dbug::flush();
 
     return item;
   }
 
-  template<typename element>
-  element& ScopeStack<element>::top()
+  template<typename element, typename Container>
+  element& ScopeStack<element, Container>::top()
   {
     if (stack.size() == 0)
     {
@@ -124,26 +152,26 @@ namespace CodeAnalysis
     return stack.back();
   }
 
-  template<typename element>
-  element& ScopeStack<element>::predOfTop()
+  template<typename element, typename Container>
+  element& ScopeStack<element, Container>::predOfTop()
   {
     if (size() < 2)
     {
       throw std::exception("-- predOfTop() called on stack with less than two elements --");
     }
-    iterator iter = --(--end());
+    iterator iter = std::prev(end(), 2);
     return *iter;
   }
 
-  template<typename element>
-  void showStack(ScopeStack<element>& stack, bool indent = true)
+  template<typename element, typename Container>
+  void showStack(ScopeStack<element, Container>& stack, bool indent = true)
   {
     if (stack.size() == 0)
     {
       std::cout << "\n  ScopeStack is empty";
       return;
     }
-    ScopeStack<element>::iterator iter = stack.begin();
+    auto iter = stack.begin();
     while (iter != stack.end())
     {
       std::string strIndent = std::string(2 * stack.size(), ' ');
@@ -155,15 +183,15 @@ namespace CodeAnalysis
     }
   }
 
-  template<typename element>
-  void showStack(ScopeStack<element*>& stack, bool indent = true)
+  template<typename element, typename Container>
+  void showStack(ScopeStack<element*, Container>& stack, bool indent = true)
   {
     if (stack.size() == 0)
     {
       std::cout << "\n  ScopeStack is empty";
       return;
     }
-    ScopeStack<element*>::iterator iter = stack.begin();
+    auto iter = stack.begin();
     while (iter != stack.end())
     {
       std::string strIndent = std::string(2 * stack.size(), ' ');
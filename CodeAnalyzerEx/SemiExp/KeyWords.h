@@ -0,0 +1,151 @@
+#ifndef KEYWORDS_H
+#define KEYWORDS_H
+///////////////////////////////////////////////////////////////////////
+// KeyWords.h - classify tokens the parser rules look for            //
+// ver 1.0                                                           //
+// Language:    C++, Visual Studio 2015                              //
+// Application: Parser component, CSE687 - Object Oriented Design    //
+// Author:      Jim Fawcett, Syracuse University, CST 4-187          //
+//              jfawcett@twcny.rr.com                                //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* KeyWords::of(tok) returns a bitmask saying which of the keyword and
+* punctuator sets used by GrammarHelper and the parsing rules tok is
+* in, e.g., Control for "while", Qualifier | Access for "public".
+* It switches on the token's length, then on its first character, so
+* a token is compared with at most two or three keywords of its own
+* length instead of with every entry of a keyword list.
+*
+* SemiExp keeps these bits per token, computed once, so rules and
+* GrammarHelper ask ITokCollection::keyWords(n) or keyWordMask()
+* instead of classifying the same tokens again on every test.
+*
+* Public Interface:
+* -----------------
+* unsigned bits = KeyWords::of("while");          // KeyWords::Control
+* if (se.keyWords(i) & KeyWords::Qualifier) ...
+* if (se.keyWordMask() & KeyWords::Control) ...
+*
+* Required Files:
+* ---------------
+* KeyWords.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+
+#include <string>
+#include <cstring>
+
+namespace Scanner
+{
+  struct KeyWords
+  {
+    enum : unsigned
+    {
+      Control = 1 << 0,      // for, foreach, do, while, switch, if, else, try, catch
+      Qualifier = 1 << 1,    // const, static, ..., access keywords, &, *, :, ++, --
+      Access = 1 << 2,       // public, protected, private
+      Namespace = 1 << 3,
+      Class = 1 << 4,        // class or interface
+      Struct = 1 << 5,
+      OpenBrace = 1 << 6,
+      CloseBrace = 1 << 7,
+      Colon = 1 << 8,
+      Hash = 1 << 9,
+      Unknown = 1 << 15      // not classified yet, used by token collections
+    };
+    static unsigned of(const char* pTok, size_t size);
+    static unsigned of(const std::string& tok) { return of(tok.data(), tok.size()); }
+  private:
+    template<size_t N>
+    static bool is(const char* pTok, const char(&key)[N]) { return std::memcmp(pTok, key, N - 1) == 0; }
+  };
+
+  //----< keyword and punctuator sets tok belongs to, 0 if none >------
+
+  inline unsigned KeyWords::of(const char* pTok, size_t size)
+  {
+    switch (size)
+    {
+    case 1:
+      switch (pTok[0])
+      {
+      case '{': return OpenBrace;
+      case '}': return CloseBrace;
+      case ':': return Colon | Qualifier;
+      case '#': return Hash;
+      case '&': case '*': return Qualifier;
+      }
+      return 0;
+    case 2:
+      if (is(pTok, "if") || is(pTok, "do"))
+        return Control;
+      if (is(pTok, "++") || is(pTok, "--"))
+        return Qualifier;
+      return 0;
+    case 3:
+      return (is(pTok, "for") || is(pTok, "try")) ? Control : 0;
+    case 4:
+      return is(pTok, "else") ? Control : 0;
+    case 5:
+      switch (pTok[0])
+      {
+      case 'w': return is(pTok, "while") ? Control : 0;
+      case 'c':
+        if (is(pTok, "catch"))
+          return Control;
+        if (is(pTok, "const"))
+          return Qualifier;
+        return is(pTok, "class") ? Class : 0;
+      }
+      return 0;
+    case 6:
+      switch (pTok[0])
+      {
+      case 's':
+        if (is(pTok, "switch"))
+          return Control;
+        if (is(pTok, "static") || is(pTok, "signed"))
+          return Qualifier;
+        return is(pTok, "struct") ? Struct : 0;
+      case 'e': return is(pTok, "extern") ? Qualifier : 0;
+      case 'f': return is(pTok, "friend") ? Qualifier : 0;
+      case 'p': return is(pTok, "public") ? Qualifier | Access : 0;
+      }
+      return 0;
+    case 7:
+      switch (pTok[0])
+      {
+      case 'f': return is(pTok, "foreach") ? Control : 0;
+      case 'm': return is(pTok, "mutable") ? Qualifier : 0;
+      case 't': return is(pTok, "typedef") ? Qualifier : 0;
+      case 'p': return is(pTok, "private") ? Qualifier | Access : 0;
+      }
+      return 0;
+    case 8:
+      switch (pTok[0])
+      {
+      case 'a': return is(pTok, "abstract") ? Qualifier : 0;
+      case 't': return is(pTok, "typename") ? Qualifier : 0;
+      case 'u': return is(pTok, "unsigned") ? Qualifier : 0;
+      case 'v': return is(pTok, "volatile") ? Qualifier : 0;
+      }
+      return 0;
+    case 9:
+      switch (pTok[0])
+      {
+      case 'p': return is(pTok, "protected") ? Qualifier | Access : 0;
+      case 'n': return is(pTok, "namespace") ? Namespace : 0;
+      case 'i': return is(pTok, "interface") ? Class : 0;
+      }
+      return 0;
+    }
+    return 0;
+  }
+}
+#endif
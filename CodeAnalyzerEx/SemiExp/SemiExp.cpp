@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////
 // SemiExpression.cpp - collect tokens for analysis                  //
-// ver 3.9                                                           //
+// ver 4.1                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Platform:    Dell XPS 8900, Windows 10                            //
 // Application: Parser component, CSE687 - Object Oriented Design    //
@@ -16,6 +16,9 @@
 #include <algorithm>
 #include <unordered_map>
 #include <exception>
+#include <stdexcept>
+#include <cstring>
+#include <cctype>
 #include <locale>
 #include "SemiExp.h"
 #include "../Tokenizer/Tokenizer.h"
@@ -35,6 +38,8 @@ SemiExp::SemiExp(Toker* pToker) : _pToker(pToker) {}
 SemiExp::SemiExp(const SemiExp& se)
 {
   _tokens = se._tokens;
+  _keyWords = se._keyWords;
+  _keyWordsValid = se._keyWordsValid;
   _pToker = nullptr;
   hasFor = false;
 }
@@ -42,10 +47,13 @@ SemiExp::SemiExp(const SemiExp& se)
 
 SemiExp::SemiExp(SemiExp&& se)
 {
-  _tokens = se._tokens;
+  _tokens = std::move(se._tokens);
+  _keyWords = std::move(se._keyWords);
+  _keyWordsValid = se._keyWordsValid;
   _pToker = se._pToker;
   hasFor = se.hasFor;
   se._tokens.clear();
+  se._keyWordsValid = false;
   se._pToker = nullptr;
 }
 //----< assigns tokens but does not assign pointer to toker >--------
@@ -55,6 +63,8 @@ SemiExp& SemiExp::operator=(const SemiExp& se)
   if (this != &se)
   {
     _tokens = se._tokens;
+    _keyWords = se._keyWords;
+    _keyWordsValid = se._keyWordsValid;
     _pToker = nullptr;
   }
   return *this;
@@ -65,26 +75,38 @@ SemiExp& SemiExp::operator=(SemiExp&& se)
 {
   if (this != &se)
   {
-    _tokens = se._tokens;
+    _tokens = std::move(se._tokens);
+    _keyWords = std::move(se._keyWords);
+    _keyWordsValid = se._keyWordsValid;
     _pToker = se._pToker;
     se._tokens.clear();
+    se._keyWordsValid = false;
     se._pToker = nullptr;
   }
   return *this;
 }
 //----< return iterator pointing to first token >--------------------
-
-SemiExp::iterator SemiExp::begin() { return _tokens.begin(); }
-
+/*
+*  Tokens may be changed through the iterators, so their KeyWords
+*  bits are computed again on the next query.
+*/
+SemiExp::iterator SemiExp::begin()
+{
+  _keyWordsValid = false;
+  return _tokens.begin();
+}
 //----< return iterator pointing one past last token >---------------
 
-SemiExp::iterator SemiExp::end() { return _tokens.end(); }
+SemiExp::iterator SemiExp::end()
+{
+  _keyWordsValid = false;
+  return _tokens.end();
+}
 
 //----< returns position of tok in semiExpression >------------------
 
 size_t SemiExp::find(const std::string& tok, size_t offSet) const
 {
-  std::string debug = this->show();
   for (size_t i = offSet; i < length(); ++i)
     if (_tokens[i] == tok)
       return i;
@@ -95,6 +117,8 @@ size_t SemiExp::find(const std::string& tok, size_t offSet) const
 void SemiExp::push_back(const std::string& tok)
 {
   _tokens.push_back(tok);
+  if (_keyWordsValid)
+    _keyWords.push_back((unsigned short)KeyWords::of(tok));
 }
 //----< removes token passed as argument >---------------------------
 
@@ -105,6 +129,8 @@ bool SemiExp::remove(const std::string& tok)
   {
     if (tok == *iter)
     {
+      if (_keyWordsValid)
+        _keyWords.erase(_keyWords.begin() + (iter - _tokens.begin()));
       _tokens.erase(iter);
       return true;
     }
@@ -120,6 +146,8 @@ bool SemiExp::remove(size_t n)
     return false;
   std::vector<Token>::iterator iter = _tokens.begin() + n;
   _tokens.erase(iter);
+  if (_keyWordsValid)
+    _keyWords.erase(_keyWords.begin() + n);
   return true;
 }
 //----< removes newlines from front of semiExpression >--------------
@@ -163,12 +191,15 @@ void SemiExp::trim(bool removeComments)
 
   std::vector<std::string>::iterator new_end;
   new_end = std::remove(_tokens.begin(), _tokens.end(), "\n");
+  if (new_end != _tokens.end())
+    _keyWordsValid = false;
   _tokens.erase(new_end, _tokens.end());
 }
 //----< transform all tokens to lower case >-------------------------
 
 void SemiExp::toLower()
 {
+  _keyWordsValid = false;
   for (auto& token : _tokens)
   {
     for (auto& chr : token)
@@ -182,11 +213,14 @@ void SemiExp::toLower()
 void SemiExp::clear()
 {
   _tokens.clear();
+  _keyWordsValid = false;
 }
 //----< is this token a comment? >-----------------------------------
 
 bool SemiExp::isComment(const std::string& tok) const
 {
+  if (_pToker == nullptr)
+    return tok.find("//") < tok.size() || tok.find("/*") < tok.size();
   return _pToker->isComment(tok);
 }
 //----< return count of newlines retrieved by Toker >----------------
@@ -265,6 +299,7 @@ bool SemiExp::isTerminator(const std::string& token) const
 bool SemiExp::getHelper(bool clear)
 {
   hasFor = false;
+  _keyWordsValid = false;
   if (_pToker == nullptr)
     throw(std::logic_error("no Toker reference"));
   if(clear)
@@ -303,6 +338,7 @@ ITokCollection* SemiExp::clone() const
 void SemiExp::clone(const ITokCollection& se, size_t offSet)
 {
   _tokens.clear();
+  _keyWordsValid = false;
   for (size_t i = offSet; i < se.length(); ++i)
   {
     push_back(se[i]);
@@ -322,8 +358,46 @@ Token& SemiExp::operator[](size_t n)
 {
   if (n < 0 || n >= _tokens.size())
     throw(std::invalid_argument("index out of range"));
+  if (_keyWordsValid)
+    _keyWords[n] = KeyWords::Unknown;
   return _tokens[n];
 }
+//----< compute KeyWords bits of every token >-----------------------
+
+void SemiExp::classify() const
+{
+  _keyWords.resize(_tokens.size());
+  for (size_t i = 0; i < _tokens.size(); ++i)
+    _keyWords[i] = (unsigned short)KeyWords::of(_tokens[i]);
+  _keyWordsValid = true;
+}
+//----< KeyWords bits of nth token >---------------------------------
+
+unsigned SemiExp::keyWords(size_t n) const
+{
+  if (n < 0 || n >= _tokens.size())
+    throw(std::invalid_argument("index out of range"));
+  if (!_keyWordsValid)
+    classify();
+  if (_keyWords[n] & KeyWords::Unknown)
+    _keyWords[n] = (unsigned short)KeyWords::of(_tokens[n]);
+  return _keyWords[n];
+}
+//----< union of the KeyWords bits of all tokens >-------------------
+
+unsigned SemiExp::keyWordMask() const
+{
+  if (!_keyWordsValid)
+    classify();
+  unsigned mask = 0;
+  for (size_t i = 0; i < _keyWords.size(); ++i)
+  {
+    if (_keyWords[i] & KeyWords::Unknown)
+      _keyWords[i] = (unsigned short)KeyWords::of(_tokens[i]);
+    mask |= _keyWords[i];
+  }
+  return mask;
+}
 //----< return number of tokens in semiExpression >------------------
 
 size_t SemiExp::length() const
@@ -344,6 +418,232 @@ std::string SemiExp::show(bool showNewLines) const
     out << "\n";
   return out.str();
 }
+//----< assign copy of tokens >--------------------------------------
+
+CompactSemi& CompactSemi::operator=(const CompactSemi& cs)
+{
+  if (this != &cs)
+    clone(cs);
+  return *this;
+}
+//----< append token to packed storage, moving to heap if full >-----
+
+void CompactSemi::pack(const char* pTok, size_t size)
+{
+  if (!_charsOnHeap && _size + size > InlineChars)
+  {
+    _heapChars.assign(_inlineChars, _inlineChars + _size);
+    _charsOnHeap = true;
+  }
+  if (!_endsOnHeap && _count == InlineTokens)
+  {
+    _heapEnds.assign(_inlineEnds, _inlineEnds + _count);
+    _endsOnHeap = true;
+  }
+  if (_charsOnHeap)
+    _heapChars.insert(_heapChars.end(), pTok, pTok + size);
+  else if (size > 0)
+    std::memcpy(_inlineChars + _size, pTok, size);
+  _size += size;
+  if (_endsOnHeap)
+    _heapEnds.push_back((unsigned)_size);
+  else
+    _inlineEnds[_count] = (unsigned)_size;
+  ++_count;
+}
+//----< move tokens into a SemiExp, for operations that modify them >--
+
+SemiExp& CompactSemi::unpack()
+{
+  if (!_pWide)
+  {
+    const CompactSemi& packed = *this;
+    std::unique_ptr<SemiExp> pWide(new SemiExp);
+    for (size_t i = 0; i < _count; ++i)
+      pWide->push_back(packed[i]);
+    _pWide = std::move(pWide);
+    _heapChars.clear();
+    _heapEnds.clear();
+  }
+  return *_pWide;
+}
+//----< iterators, these unpack the tokens >-------------------------
+
+CompactSemi::iterator CompactSemi::begin() { return unpack().begin(); }
+
+CompactSemi::iterator CompactSemi::end() { return unpack().end(); }
+
+//----< a copy has no Toker to get tokens from >---------------------
+
+bool CompactSemi::get(bool)
+{
+  throw(std::logic_error("no Toker reference"));
+}
+//----< return copy on heap, application is responsible for deleting >--
+
+ITokCollection* CompactSemi::clone() const
+{
+  return new CompactSemi(*this);
+}
+//----< replace tokens with tokens of argument, starting at offSet >-
+
+void CompactSemi::clone(const ITokCollection& tc, size_t offSet)
+{
+  if (&tc == this)
+  {
+    CompactSemi temp(*this);
+    clone(temp, offSet);
+    return;
+  }
+  clear();
+  const CompactSemi* pCompact = dynamic_cast<const CompactSemi*>(&tc);
+  if (pCompact != nullptr && pCompact->isPacked())
+  {
+    for (size_t i = offSet; i < pCompact->_count; ++i)
+    {
+      size_t start = pCompact->offset(i);
+      pack(pCompact->chars() + start, pCompact->ends()[i] - start);
+    }
+    return;
+  }
+  if (pCompact != nullptr)
+  {
+    clone(*pCompact->_pWide, offSet);
+    return;
+  }
+  const SemiExp* pSemi = dynamic_cast<const SemiExp*>(&tc);
+  if (pSemi != nullptr)
+  {
+    const std::vector<std::string>& tokens = pSemi->tokens();
+    for (size_t i = offSet; i < tokens.size(); ++i)
+      pack(tokens[i]);
+    return;
+  }
+  for (size_t i = offSet; i < tc.length(); ++i)
+    pack(tc[i]);
+}
+//----< return number of tokens >------------------------------------
+
+size_t CompactSemi::length() const
+{
+  return _pWide ? _pWide->length() : _count;
+}
+//----< writeable indexing, unpacks the tokens >---------------------
+
+Token& CompactSemi::operator[](size_t n)
+{
+  return unpack()[n];
+}
+//----< read only indexing >-----------------------------------------
+
+Token CompactSemi::operator[](size_t n) const
+{
+  if (_pWide)
+    return (*static_cast<const SemiExp*>(_pWide.get()))[n];
+  if (n >= _count)
+    throw(std::invalid_argument("index out of range"));
+  size_t start = offset(n);
+  return Token(chars() + start, ends()[n] - start);
+}
+//----< returns position of tok, compared in place in packed chars >-
+
+size_t CompactSemi::find(const std::string& tok, size_t offSet) const
+{
+  if (_pWide)
+    return _pWide->find(tok, offSet);
+  const char* pChars = chars();
+  const unsigned* pEnds = ends();
+  for (size_t i = offSet; i < _count; ++i)
+  {
+    size_t start = offset(i);
+    if (pEnds[i] - start == tok.size() && std::memcmp(pChars + start, tok.data(), tok.size()) == 0)
+      return i;
+  }
+  return _count;
+}
+//----< push token onto back end, stays packed until unpacked >------
+
+void CompactSemi::push_back(const std::string& tok)
+{
+  if (_pWide)
+    _pWide->push_back(tok);
+  else
+    pack(tok);
+}
+//----< operations that modify tokens work on the unpacked SemiExp >-
+
+bool CompactSemi::remove(const std::string& tok) { return unpack().remove(tok); }
+
+bool CompactSemi::remove(size_t n) { return unpack().remove(n); }
+
+void CompactSemi::toLower() { unpack().toLower(); }
+
+void CompactSemi::trimFront() { unpack().trimFront(); }
+
+void CompactSemi::trim(bool removeComments) { unpack().trim(removeComments); }
+
+//----< remove all tokens, leaving an empty packed collection >------
+
+void CompactSemi::clear()
+{
+  _pWide.reset();
+  _heapChars.clear();
+  _heapEnds.clear();
+  _charsOnHeap = false;
+  _endsOnHeap = false;
+  _count = 0;
+  _size = 0;
+}
+//----< display tokens, the same way as SemiExp::show >--------------
+
+std::string CompactSemi::show(bool showNewLines) const
+{
+  if (_pWide)
+    return _pWide->show(showNewLines);
+  std::ostringstream out;
+  if (showNewLines)
+    out << "\n  ";
+  for (size_t i = 0; i < _count; ++i)
+  {
+    size_t start = offset(i);
+    size_t size = ends()[i] - start;
+    if (size == 1 && chars()[start] == '\n' && !showNewLines)
+      continue;
+    out.write(chars() + start, size);
+    out << " ";
+  }
+  if (showNewLines)
+    out << "\n";
+  return out.str();
+}
+//----< is this token a comment? >-----------------------------------
+
+bool CompactSemi::isComment(const std::string& tok) const
+{
+  return tok.find("//") < tok.size() || tok.find("/*") < tok.size();
+}
+//----< KeyWords bits of nth token, classified in the packed chars >--
+
+unsigned CompactSemi::keyWords(size_t n) const
+{
+  if (_pWide)
+    return _pWide->keyWords(n);
+  if (n >= _count)
+    throw(std::invalid_argument("index out of range"));
+  size_t start = offset(n);
+  return KeyWords::of(chars() + start, ends()[n] - start);
+}
+//----< union of the KeyWords bits of all tokens >-------------------
+
+unsigned CompactSemi::keyWordMask() const
+{
+  if (_pWide)
+    return _pWide->keyWordMask();
+  unsigned mask = 0;
+  for (size_t i = 0; i < _count; ++i)
+    mask |= keyWords(i);
+  return mask;
+}
 
 #ifdef TEST_SEMIEXP
 
@@ -383,6 +683,30 @@ int main()
     std::cout << "\n  -- semiExpression --";
     std::cout << semi.show(true);
   }
+
+  std::cout << "\n\n  Testing CompactSemi copies";
+  std::cout << "\n ----------------------------";
+  std::ifstream again(fileSpec);
+  Toker copyToker;
+  copyToker.attach(&again);
+  SemiExp source(&copyToker);
+  size_t copies = 0, mismatches = 0;
+  bool more = true;
+  while (more)
+  {
+    more = source.get();
+    if (source.length() == 0)
+      continue;
+    CompactSemi copy(source);
+    if (copy.show(true) != source.show(true) || copy.find(";") != source.find(";"))
+      ++mismatches;
+    source.trim();
+    copy.trim();
+    if (copy.show() != source.show() || copy.length() != source.length())
+      ++mismatches;
+    ++copies;
+  }
+  std::cout << "\n  " << copies << " copies, " << mismatches << " mismatches";
   std::cout << "\n\n";
   return 0;
 }
@@ -2,7 +2,7 @@
 #define SEMIEXPRESSION_H
 ///////////////////////////////////////////////////////////////////////
 // SemiExpression.h - collect tokens for analysis                    //
-// ver 3.9                                                           //
+// ver 4.0                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Platform:    Dell XPS 8900, Windows 10                            //
 // Application: Parser component, CSE687 - Object Oriented Design    //
@@ -23,6 +23,19 @@
 * Each semiexpression returns just the right tokens to analyze one
 * C++ grammatical construct, e.g., class definition, function definition,
 * declaration, etc.
+*
+* CompactSemi is a copy of a token collection kept for later use, like
+* the statements and declarations stored in the AST.  Its token chars
+* are packed end to end with one end offset per token, inline for short
+* collections, so a copy is one or two block copies instead of a string
+* per token.  Operations that need a std::string& or iterator unpack it
+* into a SemiExp first.
+*
+* keyWords(n) and keyWordMask() return the KeyWords bits of tokens.
+* SemiExp classifies its tokens once, on the first query after they
+* are collected, and keeps the bits in step with push_back and remove.
+* A token written through operator[] is classified again on its next
+* query, other changes classify all tokens again.
 * 
 * Build Process:
 * --------------
@@ -34,6 +47,13 @@
 *
 * Maintenance History:
 * --------------------
+* ver 4.1 : 14 Oct 2026
+* - added per token KeyWords bits, keyWords(n) and keyWordMask()
+* ver 4.0 : 14 Oct 2026
+* - added CompactSemi
+* - find no longer builds a debug string on every call
+* - move constructor and assignment move tokens instead of copying
+* - isComment works without an attached Toker, as clones have none
 * ver 3.9 : 26 Feb 2017
 * - converted all uses of std::isspace from <cctype> to std::isspace from <locale>
 * ver 3.8 : 27 Aug 2016
@@ -80,6 +100,7 @@
 
 #include <vector>
 #include <string>
+#include <memory>
 #include "../Tokenizer/Tokenizer.h"
 #include "../SemiExp/itokcollection.h"
 
@@ -111,15 +132,75 @@ namespace Scanner
     void push_back(const std::string& tok);
     void clear();
     bool isComment(const std::string& tok) const;
+    unsigned keyWords(size_t n) const override;
+    unsigned keyWordMask() const override;
     std::string show(bool showNewLines = false) const;
     size_t currentLineCount() const;
+    const std::vector<std::string>& tokens() const { return _tokens; }
   private:
     bool isTerminator(const std::string& tok) const;
     bool getHelper(bool clear = false);
     bool isSemiColonBetweenParens() const;
+    void classify() const;
     bool hasFor = false;
     std::vector<std::string> _tokens;
+    mutable std::vector<unsigned short> _keyWords;   // KeyWords bits, one per token
+    mutable bool _keyWordsValid = false;
     Toker* _pToker;
   };
+
+  ///////////////////////////////////////////////////////////////////
+  // CompactSemi holds a copy of a token collection in flat storage
+  // - read only operations work on the packed chars
+  // - the first operation that needs a std::string& or iterator
+  //   unpacks the tokens into a SemiExp, used from then on
+
+  class CompactSemi : public ITokCollection
+  {
+  public:
+    CompactSemi() {}
+    CompactSemi(const ITokCollection& tc) { clone(tc); }
+    CompactSemi(const CompactSemi& cs) { clone(cs); }
+    CompactSemi& operator=(const CompactSemi& cs);
+    iterator begin() override;
+    iterator end() override;
+    bool get(bool clear = true) override;
+    ITokCollection* clone() const override;
+    void clone(const ITokCollection& tc, size_t offSet = 0) override;
+    size_t length() const override;
+    std::string& operator[](size_t n) override;
+    std::string operator[](size_t n) const override;
+    size_t find(const std::string& tok, size_t offSet = 0) const override;
+    void push_back(const std::string& tok) override;
+    bool remove(const std::string& tok) override;
+    bool remove(size_t n) override;
+    void toLower() override;
+    void trimFront() override;
+    void trim(bool removeComments = true) override;
+    void clear() override;
+    std::string show(bool showNewLines = false) const override;
+    bool isComment(const std::string& tok) const override;
+    unsigned keyWords(size_t n) const override;
+    unsigned keyWordMask() const override;
+    bool isPacked() const { return !_pWide; }
+  private:
+    static const size_t InlineChars = 64;
+    static const size_t InlineTokens = 16;
+    void pack(const std::string& tok) { pack(tok.data(), tok.size()); }
+    void pack(const char* pTok, size_t size);
+    SemiExp& unpack();
+    const char* chars() const { return _charsOnHeap ? _heapChars.data() : _inlineChars; }
+    const unsigned* ends() const { return _endsOnHeap ? _heapEnds.data() : _inlineEnds; }
+    size_t offset(size_t n) const { return n == 0 ? 0 : ends()[n - 1]; }
+    char _inlineChars[InlineChars];
+    unsigned _inlineEnds[InlineTokens];
+    std::vector<char> _heapChars;      // used when tokens outgrow the inline arrays
+    std::vector<unsigned> _heapEnds;
+    bool _charsOnHeap = false;
+    bool _endsOnHeap = false;
+    size_t _count = 0;
+    size_t _size = 0;
+    std::unique_ptr<SemiExp> _pWide;   // unpacked tokens, once mutated
+  };
 }
 #endif
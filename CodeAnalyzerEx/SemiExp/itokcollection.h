@@ -20,6 +20,9 @@
 
   Maintenance History:
   ====================
+  ver 1.5 : 14 Oct 2026
+  - added keyWords(n) and keyWordMask(), with defaults that classify
+    tokens on each call, see KeyWords.h
   ver 1.4 : 28 Aug 2016
   - added default parameter to trim for comment removal
   ver 1.3 : 25 Aug 2016
@@ -33,6 +36,7 @@
 */
 #include <string> 
 #include <vector>
+#include "KeyWords.h"
 
 namespace Scanner
 {
@@ -57,6 +61,14 @@ namespace Scanner
     virtual void clear() = 0;
     virtual std::string show(bool showNewLines = false) const = 0;
     virtual bool isComment(const std::string& tok) const = 0;
+    virtual unsigned keyWords(size_t n) const { return KeyWords::of((*this)[n]); }
+    virtual unsigned keyWordMask() const
+    {
+      unsigned mask = 0;
+      for (size_t i = 0; i < length(); ++i)
+        mask |= keyWords(i);
+      return mask;
+    }
     virtual ~ITokCollection() {};
   };
 }
@@ -0,0 +1,322 @@
+/////////////////////////////////////////////////////////////////////////
+// AsyncSockets.cpp - overlapped socket I/O on a completion port       //
+// ver 1.0                                                             //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
+//---------------------------------------------------------------------//
+// Application: OOD Project #4                                         //
+// Platform:    Visual Studio 2015, Dell XPS 8900, Windows 10 pro      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "AsyncSockets.h"
+#include <iostream>
+#include "../Utilities/Utilities.h"
+
+using namespace Logging;
+template<typename T>
+using Conv = Utilities::Converter<T>;
+using Show = StaticLogger<1>;
+
+//----< create completion port and the threads that service it >-------------
+
+IoEngine::IoEngine(size_t numThreads) : pending_(0)
+{
+  if (numThreads == 0)
+    numThreads = 1;
+  port_ = ::CreateIoCompletionPort(INVALID_HANDLE_VALUE, NULL, 0, (DWORD)numThreads);
+  if (port_ == NULL)
+  {
+    Show::write("\n  CreateIoCompletionPort failed with error = " + Conv<DWORD>::toString(::GetLastError()));
+    return;
+  }
+  for (size_t i = 0; i < numThreads; ++i)
+    threads_.push_back(std::thread([this]() { run(); }));
+}
+//----< stop threads and release completion port >----------------------------
+
+IoEngine::~IoEngine()
+{
+  stop();
+  if (port_ != NULL)
+    ::CloseHandle(port_);
+}
+//----< ask each engine thread to quit, then wait for them >------------------
+/*
+*  Close sockets with outstanding operations first, so their completions
+*  are delivered before the threads quit.
+*/
+void IoEngine::stop()
+{
+  for (size_t i = 0; i < threads_.size(); ++i)
+    ::PostQueuedCompletionStatus(port_, 0, StopKey, NULL);
+  for (auto& thread : threads_)
+    thread.join();
+  threads_.clear();
+}
+//----< route completions for socket to this engine >-------------------------
+
+bool IoEngine::attach(Socket& socket)
+{
+  HANDLE handle = reinterpret_cast<HANDLE>((::SOCKET)socket);
+  if (::CreateIoCompletionPort(handle, port_, IoKey, 0) == NULL)
+  {
+    Show::write("\n  attach to completion port failed with error = " + Conv<DWORD>::toString(::GetLastError()));
+    return false;
+  }
+  return true;
+}
+//----< start sending bytes from buffer, done is called when all are sent >--
+
+bool IoEngine::asyncSend(Socket& socket, const byte* buffer, size_t bytes, Completion done)
+{
+  Operation* pOp = new Operation;
+  pOp->kind = Send;
+  pOp->socket = (::SOCKET)socket;
+  pOp->buffer = const_cast<byte*>(buffer);  // WSABUF isn't const, WSASend doesn't write
+  pOp->bytes = bytes;
+  pOp->done = 0;
+  pOp->completion = done;
+  return begin(pOp);
+}
+//----< start receiving bytes into buffer, done is called when it's full >---
+/*
+*  Bytes already held in the Socket's receive buffer are taken first.
+*  If they satisfy the request, completion is posted straight to the port
+*  so done still runs on an engine thread.
+*/
+bool IoEngine::asyncRecv(Socket& socket, byte* buffer, size_t bytes, Completion done)
+{
+  Operation* pOp = new Operation;
+  pOp->kind = Recv;
+  pOp->socket = (::SOCKET)socket;
+  pOp->buffer = buffer;
+  pOp->bytes = bytes;
+  pOp->done = socket.drainRecvBuffer(bytes, buffer);
+  pOp->completion = done;
+  return begin(pOp);
+}
+//----< future returning versions, the future holds bytes transferred >-----
+
+std::future<size_t> IoEngine::asyncSend(Socket& socket, const byte* buffer, size_t bytes)
+{
+  Completion done;
+  std::future<size_t> result = promised(done);
+  asyncSend(socket, buffer, bytes, done);
+  return result;
+}
+
+std::future<size_t> IoEngine::asyncRecv(Socket& socket, byte* buffer, size_t bytes)
+{
+  Completion done;
+  std::future<size_t> result = promised(done);
+  asyncRecv(socket, buffer, bytes, done);
+  return result;
+}
+//----< make completion that fulfills a promise, return its future >---------
+
+std::future<size_t> IoEngine::promised(Completion& done)
+{
+  auto pPromise = std::make_shared<std::promise<size_t>>();
+  done = [pPromise](bool ok, size_t bytes) { pPromise->set_value(bytes); };
+  return pPromise->get_future();
+}
+//----< number of operations started and not yet completed >-----------------
+
+size_t IoEngine::pending()
+{
+  return pending_.load();
+}
+//----< count new operation and issue it, or post it if already satisfied >--
+/*
+*  A failed start still calls the completion function, on an engine
+*  thread, so callers have a single place to handle errors.
+*/
+bool IoEngine::begin(Operation* pOp)
+{
+  ++pending_;
+  if (pOp->done == pOp->bytes)
+  {
+    ZeroMemory(static_cast<OVERLAPPED*>(pOp), sizeof(OVERLAPPED));
+    return ::PostQueuedCompletionStatus(port_, 0, ReadyKey, pOp) != FALSE;
+  }
+  if (issue(pOp))
+    return true;
+  ZeroMemory(static_cast<OVERLAPPED*>(pOp), sizeof(OVERLAPPED));
+  ::PostQueuedCompletionStatus(port_, 0, ReadyKey, pOp);  // completes with ok == false
+  return false;
+}
+//----< issue overlapped WSASend or WSARecv for the bytes still to move >----
+
+bool IoEngine::issue(Operation* pOp)
+{
+  ZeroMemory(static_cast<OVERLAPPED*>(pOp), sizeof(OVERLAPPED));
+  WSABUF wsaBuf;
+  wsaBuf.buf = pOp->buffer + pOp->done;
+  wsaBuf.len = (ULONG)(pOp->bytes - pOp->done);
+  int result;
+  if (pOp->kind == Send)
+  {
+    result = ::WSASend(pOp->socket, &wsaBuf, 1, NULL, 0, pOp, NULL);
+  }
+  else
+  {
+    DWORD flags = 0;
+    result = ::WSARecv(pOp->socket, &wsaBuf, 1, NULL, &flags, pOp, NULL);
+  }
+  if (result == SOCKET_ERROR && ::WSAGetLastError() != WSA_IO_PENDING)
+  {
+    Show::write("\n  overlapped socket operation failed with error = " + Conv<int>::toString(::WSAGetLastError()));
+    return false;
+  }
+  return true;
+}
+//----< call completion function and retire operation >----------------------
+
+void IoEngine::complete(Operation* pOp, bool ok)
+{
+  if (pOp->completion)
+    pOp->completion(ok, pOp->done);
+  delete pOp;
+  --pending_;
+}
+//----< engine thread processing >-------------------------------------------
+/*
+*  Partial transfers are reissued for the remaining bytes.  A receive
+*  that completes with zero bytes means the peer closed the connection.
+*/
+void IoEngine::run()
+{
+  while (true)
+  {
+    DWORD transferred = 0;
+    ULONG_PTR key = 0;
+    OVERLAPPED* pOverlapped = NULL;
+    BOOL ok = ::GetQueuedCompletionStatus(port_, &transferred, &key, &pOverlapped, INFINITE);
+    if (pOverlapped == NULL)
+    {
+      if (key == StopKey || !ok)
+        break;
+      continue;
+    }
+    Operation* pOp = static_cast<Operation*>(pOverlapped);
+    if (key == ReadyKey)
+    {
+      complete(pOp, pOp->done == pOp->bytes);
+      continue;
+    }
+    if (!ok || transferred == 0)
+    {
+      complete(pOp, false);
+      continue;
+    }
+    pOp->done += transferred;
+    if (pOp->done < pOp->bytes && issue(pOp))
+      continue;
+    complete(pOp, pOp->done == pOp->bytes);
+  }
+}
+
+#ifdef TEST_ASYNCSOCKETS
+
+//----< test stub >----------------------------------------------------------
+/*
+*  Many clients each send a fixed size request.  The server echoes every
+*  request back using two engine threads, however many clients there are.
+*/
+const size_t MsgSize = 32;
+const size_t NumClients = 50;
+
+/////////////////////////////////////////////////////////////////////////////
+// EchoSession - owns one accepted socket while its transfers run
+
+struct EchoSession
+{
+  EchoSession(Socket&& s) : socket(std::move(s)) {}
+  Socket socket;
+  Socket::byte buffer[MsgSize];
+};
+
+/////////////////////////////////////////////////////////////////////////////
+// EchoHandler - callable object passed to SocketListener::start
+// - hands each connection to the engine and returns at once
+
+class EchoHandler
+{
+public:
+  EchoHandler(IoEngine& engine) : engine_(engine) {}
+  void operator()(Socket socket);
+private:
+  IoEngine& engine_;
+};
+
+void EchoHandler::operator()(Socket socket)
+{
+  EchoSession* pSession = new EchoSession(std::move(socket));
+  engine_.attach(pSession->socket);
+  IoEngine& engine = engine_;
+  engine_.asyncRecv(pSession->socket, pSession->buffer, MsgSize,
+    [&engine, pSession](bool ok, size_t bytes) {
+      if (!ok)
+      {
+        delete pSession;
+        return;
+      }
+      engine.asyncSend(pSession->socket, pSession->buffer, MsgSize,
+        [pSession](bool ok, size_t bytes) { delete pSession; }
+      );
+    }
+  );
+}
+
+int main()
+{
+  Show::attach(&std::cout);
+  Show::start();
+  Show::title("Testing AsyncSockets", '=');
+
+  try
+  {
+    SocketSystem ss;
+    IoEngine engine(2);
+    SocketListener sl(9071, Socket::IP6);
+    EchoHandler handler(engine);
+    sl.usePool(1, NumClients);   // one thread hands every connection to the engine
+    sl.start(handler);
+
+    std::vector<std::unique_ptr<SocketConnecter>> clients;
+    for (size_t i = 0; i < NumClients; ++i)
+    {
+      clients.push_back(std::unique_ptr<SocketConnecter>(new SocketConnecter));
+      while (!clients.back()->connect("localhost", 9071))
+        ::Sleep(100);
+    }
+    IoEngine clientEngine(2);
+    std::vector<std::string> requests(NumClients);
+    std::vector<std::vector<Socket::byte>> replies(NumClients, std::vector<Socket::byte>(MsgSize));
+    std::vector<std::future<size_t>> received;
+    for (size_t i = 0; i < NumClients; ++i)
+    {
+      requests[i] = "request #" + Conv<size_t>::toString(i);
+      requests[i].resize(MsgSize, '.');
+      clientEngine.attach(*clients[i]);
+      clientEngine.asyncSend(*clients[i], requests[i].data(), MsgSize);
+      received.push_back(clientEngine.asyncRecv(*clients[i], replies[i].data(), MsgSize));
+    }
+    size_t matched = 0;
+    for (size_t i = 0; i < NumClients; ++i)
+    {
+      if (received[i].get() == MsgSize && std::string(replies[i].begin(), replies[i].end()) == requests[i])
+        ++matched;
+    }
+    Show::write("\n  " + Conv<size_t>::toString(matched) + " of " + Conv<size_t>::toString(NumClients) + " echoes matched");
+    sl.stop();
+  }
+  catch (std::exception& ex)
+  {
+    std::cout << "\n  Exception caught:";
+    std::cout << "\n  " << ex.what() << "\n\n";
+  }
+  Show::write("\n\n");
+  Show::stop();
+}
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef ASYNCSOCKETS_H
+#define ASYNCSOCKETS_H
+/////////////////////////////////////////////////////////////////////////
+// AsyncSockets.h - overlapped socket I/O on a completion port         //
+// ver 1.0                                                             //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
+//---------------------------------------------------------------------//
+// Application: OOD Project #4                                         //
+// Platform:    Visual Studio 2015, Dell XPS 8900, Windows 10 pro      //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  Provides one class, IoEngine, that runs socket sends and receives
+*  asynchronously using Win32 overlapped I/O and an I/O completion port:
+*  - asyncSend and asyncRecv start a transfer and return immediately.
+*    The engine keeps reissuing the operation until all the requested
+*    bytes have moved, then calls the completion function on one of its
+*    threads, or fulfills the returned future.
+*  - a few engine threads can service any number of sockets, so a slow
+*    client no longer holds a thread of its own.
+*  - asyncRecv first takes bytes the Socket has already buffered, so a
+*    connection can switch from blocking reads to async reads.
+*
+*  Sockets must be attached before their first async operation.  While
+*  operations are outstanding the Socket and buffers must stay alive, and
+*  the socket must not be used for blocking reads.  Closing the socket
+*  completes its outstanding operations with ok == false.
+*
+*  Public Interface:
+*  -----------------
+*  IoEngine engine(4);                      // four completion threads
+*  engine.attach(socket);
+*  engine.asyncSend(socket, buf, n, [](bool ok, size_t bytes) { ... });
+*  std::future<size_t> f = engine.asyncRecv(socket, buf, n);
+*  size_t bytes = f.get();                  // less than n if connection failed
+*  size_t n = engine.pending();             // operations not yet completed
+*  engine.stop();                           // also done by destructor
+*
+*  Required Files:
+*  ---------------
+*  AsyncSockets.h, AsyncSockets.cpp,
+*  Sockets.h, Sockets.cpp,
+*  Logger.h, Logger.cpp,
+*  Utilities.h, Utililties.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 14 Oct 2026
+*  - first release
+*/
+
+#include "Sockets.h"
+#include <functional>
+#include <future>
+#include <memory>
+
+class IoEngine
+{
+public:
+  using byte = Socket::byte;
+  using Completion = std::function<void(bool ok, size_t bytes)>;
+
+  IoEngine(const IoEngine&) = delete;
+  IoEngine& operator=(const IoEngine&) = delete;
+
+  IoEngine(size_t numThreads = 2);
+  ~IoEngine();
+
+  bool attach(Socket& socket);
+  bool asyncSend(Socket& socket, const byte* buffer, size_t bytes, Completion done);
+  bool asyncRecv(Socket& socket, byte* buffer, size_t bytes, Completion done);
+  std::future<size_t> asyncSend(Socket& socket, const byte* buffer, size_t bytes);
+  std::future<size_t> asyncRecv(Socket& socket, byte* buffer, size_t bytes);
+  size_t pending();
+  void stop();
+private:
+  enum Kind { Send, Recv };
+  enum Key : ULONG_PTR { IoKey = 0, ReadyKey = 1, StopKey = 2 };
+
+  struct Operation : OVERLAPPED
+  {
+    Kind kind;
+    ::SOCKET socket;
+    byte* buffer;
+    size_t bytes;
+    size_t done;
+    Completion completion;
+  };
+
+  static std::future<size_t> promised(Completion& done);
+  bool begin(Operation* pOp);
+  bool issue(Operation* pOp);
+  void complete(Operation* pOp, bool ok);
+  void run();
+
+  HANDLE port_;
+  std::vector<std::thread> threads_;
+  std::atomic<size_t> pending_;
+};
+
+#endif
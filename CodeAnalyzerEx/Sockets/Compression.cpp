@@ -0,0 +1,158 @@
+/////////////////////////////////////////////////////////////////////////
+// Compression.cpp - fast LZ77 block compression for socket transfers  //
+// ver 1.0                                                             //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
+//---------------------------------------------------------------------//
+// Application: OOD Project #4                                         //
+// Platform:    Visual Studio 2015, Dell XPS 8900, Windows 10 pro      //
+/////////////////////////////////////////////////////////////////////////
+
+#include "Compression.h"
+#include <cstring>
+
+const char* const Compression::Name = "lz77";
+
+//----< append extra length bytes for a length that didn't fit in 4 bits >--
+
+void Compression::putLength(size_t length, std::vector<byte>& dst)
+{
+  while (length >= 255)
+  {
+    dst.push_back((byte)255);
+    length -= 255;
+  }
+  dst.push_back((byte)length);
+}
+//----< compress block into dst, returns compressed size >-------------------
+/*
+*  - bytes must not exceed MaxBlockSize, so every offset fits in 16 bits
+*  - a hash of the next four bytes finds the last position that started
+*    with them; a match is kept if those bytes really are equal
+*/
+size_t Compression::compress(const byte* src, size_t bytes, std::vector<byte>& dst)
+{
+  dst.clear();
+  dst.reserve(bytes + bytes / 255 + 16);
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+  std::vector<size_t> table((size_t)1 << HashBits, (size_t)-1);
+  size_t anchor = 0;   // first literal not yet written
+  size_t pos = 0;
+  while (bytes >= MinMatch && pos <= bytes - MinMatch)
+  {
+    unsigned int quad;
+    std::memcpy(&quad, in + pos, sizeof(quad));
+    size_t hash = (quad * 2654435761u) >> (32 - HashBits);
+    size_t candidate = table[hash];
+    table[hash] = pos;
+    if (candidate == (size_t)-1 || std::memcmp(in + candidate, in + pos, MinMatch) != 0)
+    {
+      ++pos;
+      continue;
+    }
+    size_t length = MinMatch;
+    while (pos + length < bytes && in[candidate + length] == in[pos + length])
+      ++length;
+
+    size_t literals = pos - anchor;
+    size_t extra = length - MinMatch;
+    dst.push_back((byte)(((literals < 15 ? literals : 15) << 4) | (extra < 15 ? extra : 15)));
+    if (literals >= 15)
+      putLength(literals - 15, dst);
+    dst.insert(dst.end(), src + anchor, src + pos);
+    size_t offset = pos - candidate;
+    dst.push_back((byte)(offset & 0xff));
+    dst.push_back((byte)(offset >> 8));
+    if (extra >= 15)
+      putLength(extra - 15, dst);
+
+    pos += length;
+    anchor = pos;
+  }
+  size_t literals = bytes - anchor;
+  dst.push_back((byte)((literals < 15 ? literals : 15) << 4));
+  if (literals >= 15)
+    putLength(literals - 15, dst);
+  dst.insert(dst.end(), src + anchor, src + bytes);
+  return dst.size();
+}
+//----< expand compressed block into exactly dstBytes bytes >----------------
+/*
+*  returns false if the block is malformed or doesn't expand to dstBytes
+*/
+bool Compression::expand(const byte* src, size_t bytes, byte* dst, size_t dstBytes)
+{
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(src);
+  size_t ip = 0, op = 0;
+  while (ip < bytes)
+  {
+    unsigned char token = in[ip++];
+    size_t literals = token >> 4;
+    if (literals == 15)
+    {
+      unsigned char more;
+      do {
+        if (ip >= bytes)
+          return false;
+        more = in[ip++];
+        literals += more;
+      } while (more == 255);
+    }
+    if (literals > bytes - ip || literals > dstBytes - op)
+      return false;
+    std::memcpy(dst + op, src + ip, literals);
+    ip += literals;
+    op += literals;
+    if (ip == bytes)
+      break;            // last sequence has no match
+
+    if (bytes - ip < 2)
+      return false;
+    size_t offset = in[ip] | ((size_t)in[ip + 1] << 8);
+    ip += 2;
+    size_t length = (token & 0x0f);
+    if (length == 15)
+    {
+      unsigned char more;
+      do {
+        if (ip >= bytes)
+          return false;
+        more = in[ip++];
+        length += more;
+      } while (more == 255);
+    }
+    length += MinMatch;
+    if (offset == 0 || offset > op || length > dstBytes - op)
+      return false;
+    for (size_t i = 0; i < length; ++i, ++op)   // may overlap, so copy forward
+      dst[op] = dst[op - offset];
+  }
+  return op == dstBytes;
+}
+
+#ifdef TEST_COMPRESSION
+
+#include <iostream>
+
+int main()
+{
+  std::cout << "\n  Testing Compression";
+  std::cout << "\n =====================";
+
+  std::string html;
+  for (int i = 0; i < 200; ++i)
+    html += "<input type='button' value='-' onclick='toggle(div" + std::to_string(i) + ")'>\n";
+  std::vector<Compression::byte> packed;
+  Compression::compress(html.data(), html.size(), packed);
+  std::string restored(html.size(), ' ');
+  bool ok = Compression::expand(&packed[0], packed.size(), &restored[0], restored.size());
+  std::cout << "\n  " << html.size() << " bytes compressed to " << packed.size() << " bytes";
+  std::cout << "\n  expanded correctly: " << std::boolalpha << (ok && restored == html);
+
+  std::string tiny = "abc";
+  Compression::compress(tiny.data(), tiny.size(), packed);
+  std::string tinyOut(tiny.size(), ' ');
+  ok = Compression::expand(&packed[0], packed.size(), &tinyOut[0], tinyOut.size());
+  std::cout << "\n  short block expanded correctly: " << (ok && tinyOut == tiny) << "\n\n";
+}
+
+#endif
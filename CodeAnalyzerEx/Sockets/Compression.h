@@ -0,0 +1,61 @@
+#ifndef COMPRESSION_H
+#define COMPRESSION_H
+/////////////////////////////////////////////////////////////////////////
+// Compression.h - fast LZ77 block compression for socket transfers    //
+// ver 1.0                                                             //
+// Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
+//---------------------------------------------------------------------//
+// Application: OOD Project #4                                         //
+// Platform:    Visual Studio 2015, Dell XPS 8900, Windows 10 pro      //
+/////////////////////////////////////////////////////////////////////////
+/*
+*  Package Operations:
+*  -------------------
+*  Provides one class, Compression, with static functions that compress
+*  and expand blocks of at most MaxBlockSize bytes.  Each block is
+*  encoded on its own, so a file can be streamed block by block.
+*
+*  The encoding is a sequence of (literals, match) pairs, the same
+*  layout LZ4 uses:
+*  - a token byte holds literal count and match length - MinMatch,
+*    four bits each, 15 meaning more length bytes follow
+*  - literal bytes, then a two byte little-endian match offset
+*  - the last sequence has literals only
+*  Repetitive text, like published html, typically shrinks 3 to 6 times.
+*
+*  Public Interface:
+*  -----------------
+*  std::vector<char> packed;
+*  Compression::compress(src, srcBytes, packed);  // packed is replaced
+*  Compression::expand(&packed[0], packed.size(), dst, srcBytes);
+*  Compression::Name                              // "lz77", for content-encoding
+*
+*  Required Files:
+*  ---------------
+*  Compression.h, Compression.cpp
+*
+*  Maintenance History:
+*  --------------------
+*  ver 1.0 : 14 Oct 2026
+*  - first release
+*/
+
+#include <vector>
+#include <string>
+
+class Compression
+{
+public:
+  using byte = char;
+  static const size_t MaxBlockSize = 64 * 1024;
+  static const char* const Name;
+
+  static size_t compress(const byte* src, size_t bytes, std::vector<byte>& dst);
+  static bool expand(const byte* src, size_t bytes, byte* dst, size_t dstBytes);
+private:
+  static const size_t MinMatch = 4;
+  static const size_t HashBits = 12;
+  static void putLength(size_t length, std::vector<byte>& dst);
+};
+
+#endif
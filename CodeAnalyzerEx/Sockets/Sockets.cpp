@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////////
 // Sockets.cpp - C++ wrapper for Win32 socket api                      //
-// ver 5.1                                                             //
+// ver 5.2                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -12,13 +12,17 @@
 /////////////////////////////////////////////////////////////////////////
 
 #include "Sockets.h"
+#include "Compression.h"
 #include <iostream>
 #include <sstream>
 #include <thread>
 #include <memory>
 #include <functional>
 #include <exception>
+#include <cstring>
+#include <algorithm>
 #include "../Utilities/Utilities.h"
+#include "../Utilities/Trace.h"
 
 using namespace Logging;
 using Util = Utilities::StringHelper;
@@ -82,6 +86,7 @@ Socket::Socket(Socket&& s)
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
+  moveRecvBuffer(s);
 }
 //----< transfer socket ownership with move assignment >---------------------
 
@@ -94,8 +99,19 @@ Socket& Socket::operator=(Socket&& s)
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
+  moveRecvBuffer(s);
   return *this;
 }
+//----< move buffered, unread bytes along with the socket handle >-----------
+
+void Socket::moveRecvBuffer(Socket& s)
+{
+  recvBuf_ = std::move(s.recvBuf_);
+  recvHead_ = s.recvHead_;
+  recvCount_ = s.recvCount_;
+  s.recvHead_ = 0;
+  s.recvCount_ = 0;
+}
 //----< get, set IP version >------------------------------------------------
 /*
 *  Note: 
@@ -155,6 +171,7 @@ Socket::~Socket() {
 */
 bool Socket::send(size_t bytes, byte* buffer)
 {
+  Utilities::Trace::Span span("comm", "send");
   size_t bytesSent = 0, bytesLeft = bytes;
   byte* pBuf = buffer;
   while (bytesLeft > 0)
@@ -167,20 +184,125 @@ bool Socket::send(size_t bytes, byte* buffer)
   }
   return true;
 }
+//----< send buffers in order, as one stream, with WSASend >------------------
+/*
+*  - the kernel gathers the buffers, so a header and a large body go out
+*    in one call without being copied into one string first
+*  - a partial send resumes from the first byte not sent
+*  - doesn't return until all bytes have been sent
+*/
+bool Socket::sendBuffers(const std::vector<Buffer>& buffers)
+{
+  Utilities::Trace::Span span("comm", "send");
+  std::vector<WSABUF> wsaBufs;
+  wsaBufs.reserve(buffers.size());
+  for (auto& buffer : buffers)
+  {
+    if (buffer.second == 0)
+      continue;
+    WSABUF wsaBuf;
+    wsaBuf.len = (ULONG)buffer.second;
+    wsaBuf.buf = const_cast<CHAR*>(buffer.first);
+    wsaBufs.push_back(wsaBuf);
+  }
+  size_t first = 0;
+  while (first < wsaBufs.size())
+  {
+    DWORD bytesSent = 0;
+    iResult = ::WSASend(socket_, &wsaBufs[first], (DWORD)(wsaBufs.size() - first), &bytesSent, 0, NULL, NULL);
+    if (socket_ == INVALID_SOCKET || iResult == SOCKET_ERROR || bytesSent == 0)
+      return false;
+    while (first < wsaBufs.size() && bytesSent >= wsaBufs[first].len)
+      bytesSent -= wsaBufs[first++].len;
+    if (first < wsaBufs.size())
+    {
+      wsaBufs[first].buf += bytesSent;
+      wsaBufs[first].len -= bytesSent;
+    }
+  }
+  return true;
+}
+//----< read whatever is available into free space of recv buffer >---------
+/*
+*  - blocks until at least one byte arrives
+*  - returns number of bytes added, zero if connection closed or failed
+*/
+size_t Socket::fillRecvBuffer()
+{
+  if (recvBuf_.size() == 0)
+    recvBuf_.resize(RecvBufferSize);
+  if (recvCount_ == 0)
+    recvHead_ = 0;  // empty, so make all of buffer contiguous
+  size_t capacity = recvBuf_.size();
+  if (recvCount_ == capacity)
+    return 0;
+  size_t tail = (recvHead_ + recvCount_) % capacity;
+  size_t space = (tail >= recvHead_) ? capacity - tail : recvHead_ - tail;
+  Utilities::Trace::Span span("comm", "recv");
+  iResult = ::recv(socket_, &recvBuf_[tail], (int)space, 0);
+  if (iResult == 0 || iResult == SOCKET_ERROR)
+    return 0;
+  recvCount_ += iResult;
+  return (size_t)iResult;
+}
+//----< discard bytes from front of recv buffer >----------------------------
+
+void Socket::consumeRecvBuffer(size_t bytes)
+{
+  recvHead_ = (recvHead_ + bytes) % recvBuf_.size();
+  recvCount_ -= bytes;
+}
+//----< copy up to bytes from recv buffer, returns number copied >-----------
+
+size_t Socket::drainRecvBuffer(size_t bytes, byte* pBuf)
+{
+  size_t copied = 0;
+  while (copied < bytes && recvCount_ > 0)
+  {
+    size_t contiguous = recvBuf_.size() - recvHead_;
+    if (contiguous > recvCount_)
+      contiguous = recvCount_;
+    size_t count = bytes - copied;
+    if (count > contiguous)
+      count = contiguous;
+    std::memcpy(pBuf + copied, &recvBuf_[recvHead_], count);
+    consumeRecvBuffer(count);
+    copied += count;
+  }
+  return copied;
+}
 //----< recv buffer >--------------------------------------------------------
 /*
 *  - bytes must be less than or equal to the size of buffer
 *  - doesn't return until buffer has been filled with requested bytes
+*  - takes bytes already in the recv buffer first, then reads large
+*    requests directly into caller's buffer
 */
 bool Socket::recv(size_t bytes, byte* buffer)
 {
-  size_t bytesRecvd = 0, bytesLeft = bytes;
+  size_t bytesLeft = bytes;
   byte* pBuf = buffer;
+  size_t bytesRecvd = drainRecvBuffer(bytesLeft, pBuf);
+  bytesLeft -= bytesRecvd;
+  pBuf += bytesRecvd;
   while (bytesLeft > 0)
   {
-    bytesRecvd = ::recv(socket_, pBuf, bytesLeft, 0);
-    if (socket_ == INVALID_SOCKET || bytesRecvd == 0)
+    if (socket_ == INVALID_SOCKET)
       return false;
+    if (bytesLeft >= RecvBufferSize)
+    {
+      Utilities::Trace::Span span("comm", "recv");
+      iResult = ::recv(socket_, pBuf, (int)bytesLeft, 0);
+      if (iResult == 0 || iResult == SOCKET_ERROR)
+        return false;
+      bytesRecvd = (size_t)iResult;
+    }
+    else
+    {
+      if (fillRecvBuffer() == 0)
+        return false;
+      bytesRecvd = drainRecvBuffer(bytesLeft, pBuf);
+    }
     bytesLeft -= bytesRecvd;
     pBuf += bytesRecvd;
   }
@@ -209,26 +331,33 @@ bool Socket::sendString(const std::string& str, byte terminator)
 //----< receives terminator terminated string >------------------------------
 /*
  * Doesn't return until a terminator byte as been received.
- *
- * ToDo:
- * - needs reads of one byte to be replaced by bulk reads into a
- *   stream buffer to improve efficiency.
- * - That will require building a circular buffer.
- * - performance seems acceptable, so won't do this now
+ * - reads everything available into the circular recv buffer and scans
+ *   it for the terminator
+ * - bytes after the terminator stay buffered for the next recv call
  */
 std::string Socket::recvString(byte terminator)
 {
-  static const int buflen = 1;
-  char buffer[1];
   std::string str;
   while (true)
   {
-    iResult = ::recv(socket_, buffer, buflen, 0);
-    if (iResult == 0 || iResult == INVALID_SOCKET)
-      break;
-    if (buffer[0] == terminator)
+    while (recvCount_ > 0)
+    {
+      size_t contiguous = recvBuf_.size() - recvHead_;
+      if (contiguous > recvCount_)
+        contiguous = recvCount_;
+      const byte* pStart = &recvBuf_[recvHead_];
+      const byte* pTerm = static_cast<const byte*>(std::memchr(pStart, terminator, contiguous));
+      if (pTerm != nullptr)
+      {
+        str.append(pStart, pTerm - pStart);
+        consumeRecvBuffer(pTerm - pStart + 1);
+        return str;
+      }
+      str.append(pStart, contiguous);
+      consumeRecvBuffer(contiguous);
+    }
+    if (socket_ == INVALID_SOCKET || fillRecvBuffer() == 0)
       break;
-    str += buffer[0];
   }
   return str;
 }
@@ -243,18 +372,253 @@ size_t Socket::sendStream(size_t bytes, byte* pBuf)
 //----< attempt to recv specified number of bytes, but may not send all >----
 /*
 * returns number of bytes actually received
+* - returns buffered bytes, if any, before reading from the socket
 */
 size_t Socket::recvStream(size_t bytes, byte* pBuf)
 {
+  if (recvCount_ > 0)
+    return drainRecvBuffer(bytes, pBuf);
   return ::recv(socket_, pBuf, bytes, 0);
 }
+//----< send bytes of file without copying through user buffers >-----------
+/*
+*  - TransmitFile lets the kernel read the file and send it
+*  - falls back to large ReadFile/send blocks if TransmitFile fails
+*  - TransmitFile is limited to 2 GB per call, so big files go in chunks
+*/
+bool Socket::sendFile(const std::string& fileSpec, size_t bytes)
+{
+  Utilities::Trace::Span span("comm", "send file", fileSpec);
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  const size_t MaxTransmit = 1 << 30;
+  size_t sent = 0;
+  bool ok = true;
+  while (ok && sent < bytes)
+  {
+    size_t chunk = bytes - sent;
+    if (chunk > MaxTransmit)
+      chunk = MaxTransmit;
+    LARGE_INTEGER offset;
+    offset.QuadPart = (LONGLONG)sent;
+    ::SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+    if (::TransmitFile(socket_, hFile, (DWORD)chunk, 0, NULL, NULL, 0))
+    {
+      sent += chunk;
+      continue;
+    }
+    Show::write("\n  TransmitFile failed with error = " + Conv<int>::toString(WSAGetLastError()));
+    ::SetFilePointerEx(hFile, offset, NULL, FILE_BEGIN);
+    std::vector<byte> block(FileBlockSize);
+    while (sent < bytes)
+    {
+      DWORD toRead = (DWORD)((bytes - sent < FileBlockSize) ? bytes - sent : FileBlockSize);
+      DWORD bytesRead = 0;
+      if (!::ReadFile(hFile, &block[0], toRead, &bytesRead, NULL) || bytesRead == 0 || !send(bytesRead, &block[0]))
+      {
+        ok = false;
+        break;
+      }
+      sent += bytesRead;
+    }
+  }
+  ::CloseHandle(hFile);
+  return ok;
+}
+//----< recv bytes from socket directly into file write buffer >-------------
+/*
+*  - bytes already in the recv buffer are written first
+*  - each block is received straight into the buffer handed to WriteFile
+*/
+bool Socket::recvFile(const std::string& fileSpec, size_t bytes, size_t blockSize)
+{
+  Utilities::Trace::Span span("comm", "recv file", fileSpec);
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    Show::write("\n\n  can't open file " + fileSpec);
+    return false;
+  }
+  if (blockSize == 0)
+    blockSize = FileBlockSize;
+  std::vector<byte> block(blockSize);
+  bool ok = true;
+  while (bytes > 0)
+  {
+    size_t count = drainRecvBuffer(bytes < blockSize ? bytes : blockSize, &block[0]);
+    if (count == 0)
+    {
+      iResult = ::recv(socket_, &block[0], (int)(bytes < blockSize ? bytes : blockSize), 0);
+      if (iResult == 0 || iResult == SOCKET_ERROR)
+      {
+        ok = false;
+        break;
+      }
+      count = (size_t)iResult;
+    }
+    DWORD written = 0;
+    if (!::WriteFile(hFile, &block[0], (DWORD)count, &written, NULL) || written != count)
+    {
+      ok = false;
+      break;
+    }
+    bytes -= count;
+  }
+  ::CloseHandle(hFile);
+  return ok;
+}
+//----< send file as a stream of compressed blocks >-------------------------
+/*
+*  - each block has an eight byte header: packed size then original size,
+*    both 32 bit little-endian, followed by the packed bytes
+*  - a block that doesn't shrink is sent as is, with packed size equal
+*    to original size
+*  - bytes is the file size, the receiver expects that many bytes back
+*/
+bool Socket::sendFileCompressed(const std::string& fileSpec, size_t bytes)
+{
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+    return false;
+
+  std::vector<byte> block(Compression::MaxBlockSize);
+  std::vector<byte> packed;
+  size_t sent = 0;
+  bool ok = true;
+  while (ok && sent < bytes)
+  {
+    DWORD toRead = (DWORD)((bytes - sent < block.size()) ? bytes - sent : block.size());
+    DWORD bytesRead = 0;
+    if (!::ReadFile(hFile, &block[0], toRead, &bytesRead, NULL) || bytesRead == 0)
+    {
+      ok = false;
+      break;
+    }
+    ok = sendCompressedBlock(&block[0], bytesRead, packed);
+    sent += bytesRead;
+  }
+  ::CloseHandle(hFile);
+  return ok;
+}
+//----< send bytes held in memory as sendFileCompressed sends a file >-------
+
+bool Socket::sendCompressed(size_t bytes, const byte* buffer)
+{
+  std::vector<byte> packed;
+  bool ok = true;
+  for (size_t sent = 0; ok && sent < bytes; sent += Compression::MaxBlockSize)
+  {
+    size_t count = (bytes - sent < Compression::MaxBlockSize) ? bytes - sent : Compression::MaxBlockSize;
+    ok = sendCompressedBlock(buffer + sent, count, packed);
+  }
+  return ok;
+}
+//----< send one block, packed if that makes it smaller, with its header >---
+/*
+ *  header holds the packed and original sizes, 4 bytes each, low first,
+ *  packed size equal to original size means the block is stored
+ */
+bool Socket::sendCompressedBlock(const byte* block, size_t bytes, std::vector<byte>& packed)
+{
+  Compression::compress(block, bytes, packed);
+  bool stored = packed.size() >= bytes;
+  size_t packedSize = stored ? bytes : packed.size();
+  byte header[8];
+  for (size_t i = 0; i < 4; ++i)
+  {
+    header[i] = (byte)((packedSize >> (8 * i)) & 0xff);
+    header[4 + i] = (byte)((bytes >> (8 * i)) & 0xff);
+  }
+  return send(sizeof(header), header) && send(packedSize, stored ? const_cast<byte*>(block) : &packed[0]);
+}
+//----< receive file sent by sendFileCompressed, bytes is original size >----
+
+bool Socket::recvFileCompressed(const std::string& fileSpec, size_t bytes)
+{
+  HANDLE hFile = ::CreateFileA(
+    fileSpec.c_str(), GENERIC_WRITE, 0, NULL, CREATE_ALWAYS, FILE_FLAG_SEQUENTIAL_SCAN, NULL
+  );
+  if (hFile == INVALID_HANDLE_VALUE)
+  {
+    Show::write("\n\n  can't open file " + fileSpec);
+    return false;
+  }
+  std::vector<byte> block(Compression::MaxBlockSize);
+  std::vector<byte> packed(Compression::MaxBlockSize);
+  bool ok = true;
+  while (ok && bytes > 0)
+  {
+    size_t blockSize = 0;
+    DWORD written = 0;
+    if (!recvCompressedBlock(&block[0], bytes, blockSize, packed, fileSpec) ||
+      !::WriteFile(hFile, &block[0], (DWORD)blockSize, &written, NULL) || written != blockSize)
+    {
+      ok = false;
+      break;
+    }
+    bytes -= blockSize;
+  }
+  ::CloseHandle(hFile);
+  return ok;
+}
+//----< receive bytes sent by sendCompressed into buffer >-------------------
+/*
+*  - bytes is the original size, the blocks must end at that size, as
+*    they do when the sender calls sendCompressed with the same count
+*/
+bool Socket::recvCompressed(size_t bytes, byte* buffer)
+{
+  std::vector<byte> packed(Compression::MaxBlockSize);
+  size_t recvd = 0;
+  while (recvd < bytes)
+  {
+    size_t blockSize = 0;
+    if (!recvCompressedBlock(buffer + recvd, bytes - recvd, blockSize, packed, "compressed bytes"))
+      return false;
+    recvd += blockSize;
+  }
+  return true;
+}
+//----< receive one block, of at most maxBytes original bytes >--------------
+
+bool Socket::recvCompressedBlock(byte* block, size_t maxBytes, size_t& blockSize, std::vector<byte>& packed, const std::string& what)
+{
+  byte header[8];
+  if (!recv(sizeof(header), header))
+    return false;
+  size_t packedSize = 0;
+  blockSize = 0;
+  for (size_t i = 0; i < 4; ++i)
+  {
+    packedSize |= (size_t)(unsigned char)header[i] << (8 * i);
+    blockSize |= (size_t)(unsigned char)header[4 + i] << (8 * i);
+  }
+  if (blockSize == 0 || blockSize > Compression::MaxBlockSize || blockSize > maxBytes || packedSize > blockSize)
+  {
+    Show::write("\n\n  bad compressed block header receiving " + what);
+    return false;
+  }
+  if (packedSize == blockSize)
+    return recv(blockSize, block);
+  if (packed.size() < packedSize)
+    packed.resize(packedSize);
+  return recv(packedSize, &packed[0]) && Compression::expand(&packed[0], packedSize, block, blockSize);
+}
 //----< returns bytes available in recv buffer >-----------------------------
 
 size_t Socket::bytesWaiting()
 {
   unsigned long int ret;
   ::ioctlsocket(socket_, FIONREAD, &ret);
-  return (size_t)ret;
+  return (size_t)ret + recvCount_;
 }
 //----< waits for server data, checking every timeToCheck millisec >---------
 
@@ -290,6 +654,7 @@ SocketConnecter::SocketConnecter(SocketConnecter&& s) : Socket()
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
+  moveRecvBuffer(s);
 }
 //----< move assignment transfers ownership of Win32 socket_ member >--------
 
@@ -302,6 +667,7 @@ SocketConnecter& SocketConnecter::operator=(SocketConnecter&& s)
   hints.ai_family = s.hints.ai_family;
   hints.ai_socktype = s.hints.ai_socktype;
   hints.ai_protocol = s.hints.ai_protocol;
+  moveRecvBuffer(s);
   return *this;
 }
 //----< destructor announces destruction if Verbose(true) >------------------
@@ -499,6 +865,8 @@ Socket SocketListener::accept()
     );
     return clientSocket;
   }
+  std::lock_guard<std::mutex> l(statsMtx_);
+  ++stats_.accepted;
   return clientSocket;
 }
 //----< request SocketListener to stop accepting connections >---------------
@@ -506,8 +874,92 @@ Socket SocketListener::accept()
 void SocketListener::stop()
 {
   stop_.exchange(true);
+  {
+    std::lock_guard<std::mutex> l(statsMtx_);
+    roomCv_.notify_all();    // listener may be waiting for queue room
+  }
+  for (size_t i = 0; i < workers_; ++i)
+    pendingQ_.enQ(Pending());  // invalid socket tells a worker to quit
   sendString("Stop!");
 }
+//----< handle connections with a fixed number of worker threads >-----------
+/*
+*  - call before start(...)
+*  - workers == 0 restores the default thread per connection
+*  - when maxQueued accepted connections are waiting for a worker, the
+*    listener stops accepting until a worker takes one
+*/
+void SocketListener::usePool(size_t workers, size_t maxQueued)
+{
+  workers_ = workers;
+  maxQueued_ = (maxQueued > 0) ? maxQueued : 1;
+}
+//----< snapshot of connection statistics >----------------------------------
+
+SocketListener::Stats SocketListener::stats()
+{
+  std::lock_guard<std::mutex> l(statsMtx_);
+  return stats_;
+}
+//----< pooled mode: block listener while pending queue is full >------------
+/*
+*  returns false if the listener was stopped while waiting
+*/
+bool SocketListener::waitForRoom()
+{
+  if (workers_ == 0)
+    return true;
+  std::unique_lock<std::mutex> l(statsMtx_);
+  if (stats_.queued >= maxQueued_)
+  {
+    ++stats_.throttled;
+    roomCv_.wait(l, [this]() { return stats_.queued < maxQueued_ || stop_.load(); });
+  }
+  return !stop_.load();
+}
+//----< pooled mode: queue accepted connection for the next free worker >-----
+
+void SocketListener::dispatch(Socket&& socket)
+{
+  Pending pending;
+  pending.socket = std::move(socket);
+  pending.accepted = Clock::now();
+  {
+    std::lock_guard<std::mutex> l(statsMtx_);
+    ++stats_.queued;
+    stats_.maxQueued = (std::max)(stats_.maxQueued, stats_.queued);
+  }
+  pendingQ_.enQ(std::move(pending));
+}
+//----< worker takes next connection, false when listener is stopping >------
+
+bool SocketListener::nextConnection(Pending& pending)
+{
+  pending = pendingQ_.deQ();
+  if (!pending.socket.validState())
+    return false;
+  double waitMs = std::chrono::duration<double, std::milli>(Clock::now() - pending.accepted).count();
+  {
+    std::lock_guard<std::mutex> l(statsMtx_);
+    --stats_.queued;
+    ++stats_.active;
+    stats_.totalWaitMs += waitMs;
+    stats_.maxWaitMs = (std::max)(stats_.maxWaitMs, waitMs);
+  }
+  roomCv_.notify_one();
+  return true;
+}
+//----< worker finished with a connection it took at started >---------------
+
+void SocketListener::finished(Clock::time_point started)
+{
+  double serviceMs = std::chrono::duration<double, std::milli>(Clock::now() - started).count();
+  std::lock_guard<std::mutex> l(statsMtx_);
+  --stats_.active;
+  ++stats_.completed;
+  stats_.totalServiceMs += serviceMs;
+  stats_.maxServiceMs = (std::max)(stats_.maxServiceMs, serviceMs);
+}
 
 #ifdef TEST_SOCKETS
 
@@ -775,6 +1227,7 @@ int main(int argc, char* argv[])
     SocketConnecter si;
     SocketListener sl(9070, Socket::IP6);
     ClientHandler cp;
+    sl.usePool(2, 4);
     sl.start(cp);
     while (!si.connect("localhost", 9070))
     {
@@ -792,6 +1245,11 @@ int main(int argc, char* argv[])
     Show::write("\n\n  client calling send shutdown\n");
     si.shutDownSend();
     sl.stop();
+
+    SocketListener::Stats stats = sl.stats();
+    Show::write("\n  listener accepted " + Conv<size_t>::toString(stats.accepted) +
+      " connections, max queued " + Conv<size_t>::toString(stats.maxQueued) +
+      ", max wait " + Conv<double>::toString(stats.maxWaitMs) + " ms\n");
   }
   catch (std::exception& ex)
   {
@@ -2,7 +2,7 @@
 #define SOCKETS_H
 /////////////////////////////////////////////////////////////////////////
 // Sockets.h - C++ wrapper for Win32 socket api                        //
-// ver 5.1                                                             //
+// ver 5.8                                                             //
 // Jim Fawcett, CSE687 - Object Oriented Design, Spring 2016           //
 // CST 4-187, Syracuse University, 315 443-3948, jfawcett@twcny.rr.com //
 //---------------------------------------------------------------------//
@@ -24,6 +24,12 @@
 *  - adds the ability to connect to a server
 *  SocketListener:
 *  - adds the ability to listen for connections on a dedicated thread
+*  - by default each connection is handled on its own thread.  After
+*    usePool(workers, maxQueued) connections are handed to a fixed set
+*    of worker threads.  When maxQueued connections are waiting for a
+*    worker the listener stops accepting until one is picked up, so
+*    further clients wait in the OS listen backlog.  stats() reports
+*    queue depth and per-connection wait and service times.
 *  - instances of this class are the only ones influenced by ipVer().
 *    clients will use whatever protocol the server provides.
 *  SocketSystem:
@@ -33,12 +39,40 @@
 *  Required Files:
 *  ---------------
 *  Sockets.h, Sockets.cpp, 
+*  Compression.h, Compression.cpp,
 *  Logger.h, Logger.cpp, 
 *  Utilities.h, Utililties.cpp, 
 *  WindowsHelpers.h, WindowsHelpers.cpp
 *
 *  Maintenance History:
 *  --------------------
+*  ver 5.8 : 14 Oct 2026
+*  - added sendBuffers, which sends several buffers, e.g., a message's
+*    header and body, with one WSASend, without joining them first
+*  ver 5.7 : 14 Oct 2026
+*  - send, the blocking recvs, sendFile and recvFile record Trace spans
+*  ver 5.6 : 14 Oct 2026
+*  - added recvCompressed, which receives bytes sent by sendCompressed into
+*    memory, so a body can be received a segment at a time
+*  ver 5.5 : 14 Oct 2026
+*  - added sendCompressed, which sends bytes already in memory in the
+*    blocks sendFileCompressed makes, so recvFileCompressed reads either
+*  ver 5.4 : 14 Oct 2026
+*  - added sendFileCompressed and recvFileCompressed, which stream a file
+*    as independently compressed blocks, see Compression.h
+*  ver 5.3 : 14 Oct 2026
+*  - added pooled connection handling to SocketListener, with a bounded
+*    queue of accepted connections and connection statistics
+*  - IoEngine, in AsyncSockets.h, is a friend of Socket so async reads
+*    can take bytes already held in the receive buffer
+*  ver 5.2 : 14 Oct 2026
+*  - added a circular receive buffer to Socket.  recvString, recv, and
+*    recvStream all draw from it, so bytes read ahead while looking for a
+*    string terminator are returned by the next buffer read.
+*  - recvString now does bulk reads instead of one ::recv per byte
+*  - bytesWaiting includes bytes already held in the receive buffer
+*  - added sendFile, which hands the file to the kernel with TransmitFile,
+*    and recvFile, which receives directly into a large file write buffer
 *  ver 5.1 : 10 Apr 16
 *  - Added sendStream and recvStream to support sending and receiving
 *    file streams.  These simply wrap the native sockets send and recv.
@@ -99,10 +133,6 @@
 /*
 * ToDo:
 * - make SocketSystem a reference counted instance of Socket
-* - write buffered recv which efficiently returns string or line
-*   - reads and concatenates everything available into circular buffer
-*   - parses out first string or line and moves start of buffer pointer
-*     to begining of next
 * -----------------------------------------------------------------------
 *  Wait for The next items until Students have submitted their code
 * -----------------------------------------------------------------------
@@ -119,17 +149,24 @@
 #include <winsock2.h>     // Windows sockets, ver 2
 #include <WS2tcpip.h>     // support for IPv6 and other things
 #include <IPHlpApi.h>     // ip helpers
+#include <mswsock.h>      // TransmitFile
 
 #include <vector>
 #include <string>
 #include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
+#include <thread>
 
 #include "../WindowsHelpers/WindowsHelpers.h"
 #include "../Utilities/Utilities.h"
 #include "../Logger/Logger.h"
+#include "../Cpp11-BlockingQueue/Cpp11-BlockingQueue.h"
 
 #pragma warning(disable:4522)
 #pragma comment(lib, "Ws2_32.lib")
+#pragma comment(lib, "Mswsock.lib")
 
 /////////////////////////////////////////////////////////////////////////////
 // SocketSystem class - manages loading and unloading Winsock library
@@ -154,6 +191,9 @@ class Socket
 public:
   enum IpVer { IP4, IP6 };
   using byte = char;
+  using Buffer = std::pair<const byte*, size_t>;
+  static const size_t RecvBufferSize = 8192;
+  static const size_t FileBlockSize = 64 * 1024;
 
   // disable copy construction and assignment
   Socket(const Socket& s) = delete;
@@ -168,9 +208,16 @@ public:
 
   IpVer& ipVer();
   bool send(size_t bytes, byte* buffer);
+  bool sendBuffers(const std::vector<Buffer>& buffers);
   bool recv(size_t bytes, byte* buffer);
   size_t sendStream(size_t bytes, byte* buffer);
   size_t recvStream(size_t bytes, byte* buffer);
+  bool sendFile(const std::string& fileSpec, size_t bytes);
+  bool recvFile(const std::string& fileSpec, size_t bytes, size_t blockSize = FileBlockSize);
+  bool sendFileCompressed(const std::string& fileSpec, size_t bytes);
+  bool sendCompressed(size_t bytes, const byte* buffer);
+  bool recvFileCompressed(const std::string& fileSpec, size_t bytes);
+  bool recvCompressed(size_t bytes, byte* buffer);
   bool sendString(const std::string& str, byte terminator='\0');
   std::string recvString(byte terminator='\0');
   size_t bytesWaiting();
@@ -183,11 +230,22 @@ public:
   bool validState() { return socket_ != INVALID_SOCKET; }
 
 protected:
+  friend class IoEngine;  // async reads take bytes already in recv buffer
   WSADATA wsaData;
   ::SOCKET socket_;
   struct addrinfo *result = NULL, *ptr = NULL, hints;
   int iResult;
   IpVer ipver_ = IP4;
+  void moveRecvBuffer(Socket& s);
+private:
+  size_t fillRecvBuffer();
+  size_t drainRecvBuffer(size_t bytes, byte* pBuf);
+  void consumeRecvBuffer(size_t bytes);
+  bool sendCompressedBlock(const byte* block, size_t bytes, std::vector<byte>& packed);
+  bool recvCompressedBlock(byte* block, size_t maxBytes, size_t& blockSize, std::vector<byte>& packed, const std::string& what);
+  std::vector<byte> recvBuf_;   // circular, allocated on first read
+  size_t recvHead_ = 0;
+  size_t recvCount_ = 0;
 };
 
 /////////////////////////////////////////////////////////////////////////////
@@ -211,7 +269,8 @@ public:
 /////////////////////////////////////////////////////////////////////////////
 // SocketListener class
 // - listens for incoming connections
-// - each connection is handled on its own thread
+// - each connection is handled on its own thread, or by a pool of
+//   worker threads after usePool(...)
 
 class SocketListener : public Socket
 {
@@ -224,16 +283,50 @@ public:
   SocketListener& operator=(SocketListener&& s);
   virtual ~SocketListener();
 
+  struct Stats
+  {
+    size_t accepted = 0;       // connections accepted
+    size_t queued = 0;         // accepted, waiting for a worker
+    size_t maxQueued = 0;
+    size_t active = 0;         // being handled by a worker
+    size_t completed = 0;
+    size_t throttled = 0;      // times listener paused because queue was full
+    double totalWaitMs = 0;    // accept until a worker picks connection up
+    double maxWaitMs = 0;
+    double totalServiceMs = 0; // time spent in the callable object
+    double maxServiceMs = 0;
+  };
+
   template<typename CallObj>
   bool start(CallObj& co);
   void stop();
+  void usePool(size_t workers, size_t maxQueued = 64);
+  Stats stats();
 private:
+  using Clock = std::chrono::steady_clock;
+  struct Pending
+  {
+    Socket socket{ INVALID_SOCKET };
+    Clock::time_point accepted;
+  };
   bool bind();
   bool listen();
   Socket accept();
+  template<typename CallObj>
+  void serve(CallObj& co);
+  bool waitForRoom();
+  void dispatch(Socket&& socket);
+  bool nextConnection(Pending& pending);
+  void finished(Clock::time_point started);
   std::atomic<bool> stop_ = false;
   size_t port_;
   bool acceptFailed_ = false;
+  size_t workers_ = 0;
+  size_t maxQueued_ = 0;
+  Async::BlockingQueue<Pending> pendingQ_;
+  std::mutex statsMtx_;
+  std::condition_variable roomCv_;
+  Stats stats_;
 };
 
 //----< SocketListener start function runs listener on its own thread >------
@@ -242,6 +335,8 @@ private:
 *    to handle client requests.
 *  - You will find an example Callable Object, ClientProc,
 *    used in the test stub below
+*  - in pooled mode the worker threads are started here and each
+*    calls co for one connection at a time
 */
 template<typename CallObj>
 bool SocketListener::start(CallObj& co)
@@ -255,6 +350,11 @@ bool SocketListener::start(CallObj& co)
   {
     return false;
   }
+  for (size_t i = 0; i < workers_; ++i)
+  {
+    std::thread worker([this, &co]() { serve(co); });
+    worker.detach();
+  }
   // listen on a dedicated thread so server's main thread won't block
 
   std::thread ListenThread(
@@ -268,6 +368,11 @@ bool SocketListener::start(CallObj& co)
         if (stop_.load())
           break;
 
+        // in pooled mode, wait while the queue of accepted connections is full
+
+        if (!waitForRoom())
+          break;
+
         // Accept a client socket - blocking call
 
         Socket clientSocket = accept();    // uses move ctor
@@ -277,6 +382,12 @@ bool SocketListener::start(CallObj& co)
         //Verbose::show("server accepted connection");
         StaticLogger<1>::write("\n  server accepted connection");
 
+        if (workers_ > 0)
+        {
+          dispatch(std::move(clientSocket));
+          continue;
+        }
+
         // start thread to handle client request
 
         std::thread clientThread(std::ref(co), std::move(clientSocket));
@@ -289,6 +400,19 @@ bool SocketListener::start(CallObj& co)
   ListenThread.detach();
   return true;
 }
+//----< worker thread processing, handles one connection at a time >---------
+
+template<typename CallObj>
+void SocketListener::serve(CallObj& co)
+{
+  Pending pending;
+  while (nextConnection(pending))
+  {
+    Clock::time_point started = Clock::now();
+    co(std::move(pending.socket));
+    finished(started);
+  }
+}
 
 #endif
 
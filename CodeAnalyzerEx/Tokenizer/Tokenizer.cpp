@@ -1,6 +1,6 @@
 /////////////////////////////////////////////////////////////////////
 // Tokenizer.cpp - read words from a std::stream                   //
-// ver 4.2                                                         //
+// ver 4.6                                                         //
 // Language:    C++, Visual Studio 2015                            //
 // Platform:    Dell XPS 8900, Windows 10                          //
 // Application: Parser component, CSE687 - Object Oriented Design  //
@@ -9,14 +9,138 @@
 /////////////////////////////////////////////////////////////////////
 
 #include <iostream>
+#include <fstream>
+#include <cstdlib>
 #include <locale>
 #include <string>
 #include <vector>
+#include <bitset>
 #include "Tokenizer.h"
 #include "..\Utilities\Utilities.h"
 
+#if defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2) || defined(__SSE2__)
+#define TOKENIZER_SSE2
+#include <emmintrin.h>
+#endif
+
 namespace Scanner
 {
+  ///////////////////////////////////////////////////////////////////
+  // Source supplies chars from an attached stream or buffer
+  /*
+   * - in buffer mode it behaves like a stream over the buffer: get()
+   *   and peek() at the end return EOF and good() is false until
+   *   clear(), so the states work the same on either input
+   * - buffer reads are one compare and one pointer increment
+   */
+  class Source
+  {
+  public:
+    void attach(std::istream* pIn)
+    {
+      _pStream = pIn;
+      _pos = _end = _curr = nullptr;
+      _eof = false;
+    }
+    void attach(const char* pBuffer, size_t size)
+    {
+      _pStream = nullptr;
+      _pos = pBuffer;
+      _end = pBuffer + size;
+      _curr = nullptr;
+      _eof = false;
+    }
+    bool good() { return _pStream ? _pStream->good() : !_eof; }
+    int get()
+    {
+      if (_pStream)
+        return _pStream->get();
+      if (_pos < _end)
+      {
+        _curr = _pos;
+        return (unsigned char)*_pos++;
+      }
+      _curr = _end;
+      _eof = true;
+      return EOF;
+    }
+    int peek()
+    {
+      if (_pStream)
+        return _pStream->peek();
+      if (_pos < _end)
+        return (unsigned char)*_pos;
+      _eof = true;
+      return EOF;
+    }
+    void clear()
+    {
+      if (_pStream)
+        _pStream->clear();
+      else
+        _eof = false;
+    }
+    // position of the char get last returned, nullptr for streams
+    const char* current() { return _curr; }
+    const char* end() { return _end; }
+    // buffer only: position of next char, skip to a later one, find chars
+    bool isBuffer() { return _pStream == nullptr; }
+    const char* next() { return _pos; }
+    void skipTo(const char* pos) { _curr = pos - 1; _pos = pos; }
+    const char* find(char ch, size_t& newlines);
+  private:
+    std::istream* _pStream = nullptr;
+    const char* _pos = nullptr;
+    const char* _end = nullptr;
+    const char* _curr = nullptr;
+    bool _eof = true;
+  };
+  //----< count bits set in a 16 bit mask >----------------------------
+
+  inline unsigned bitCount(unsigned mask)
+  {
+    mask = mask - ((mask >> 1) & 0x5555);
+    mask = (mask & 0x3333) + ((mask >> 2) & 0x3333);
+    mask = (mask + (mask >> 4)) & 0x0f0f;
+    return (mask + (mask >> 8)) & 0x1f;
+  }
+  //----< next position holding ch, or end of buffer >----------------
+  /*
+   * - adds the newlines passed over to newlines
+   * - with SSE2 compares 16 chars at a time, the scalar loop does the
+   *   rest and is all there is without SSE2
+   */
+  const char* Source::find(char ch, size_t& newlines)
+  {
+    const char* p = _pos;
+#ifdef TOKENIZER_SSE2
+    const __m128i vCh = _mm_set1_epi8(ch);
+    const __m128i vNewline = _mm_set1_epi8('\n');
+    while (_end - p >= 16)
+    {
+      __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+      unsigned found = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vCh));
+      unsigned lines = _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, vNewline));
+      if (found != 0)
+      {
+        unsigned before = (found & (0u - found)) - 1;   // bits below first found
+        newlines += bitCount(lines & before);
+        return p + bitCount(before);
+      }
+      newlines += bitCount(lines);
+      p += 16;
+    }
+#endif
+    for (; p < _end; ++p)
+    {
+      if (*p == ch)
+        break;
+      if (*p == '\n')
+        ++newlines;
+    }
+    return p;
+  }
+
   ///////////////////////////////////////////////////////////////////
   // Context is a shared data storage facility.
   /*
@@ -32,7 +156,9 @@ namespace Scanner
     Context();
     ~Context();
     std::string token;
-    std::istream* _pIn;
+    Source _in;
+    std::string _buffer;    // file contents read by Toker::attachFile
+    TokenCache::Entry* _pTee = nullptr;  // records tokens if not null
     std::vector<std::string> _oneCharTokens =
     {
       "\n", "<", ">", "{", "}", "[", "]", "(", ")", ":", ";", " = ", " + ", " - ", "*", ".", ",", "@"
@@ -41,6 +167,11 @@ namespace Scanner
     {
       "<<", ">>", "::", "++", "--", "==", "+=", "-=", "*=", "/="
     };
+    bool _oneCharTable[256];           // indexed by unsigned char
+    std::bitset<256 * 256> _twoCharTable;  // indexed by first * 256 + second
+    void indexSpecialTokens();
+    const char* _tokStart = nullptr;   // buffer position of current token
+    TokenKind _kind = TokenKind::None;
     int prevChar;
     int currChar;
     bool _doReturnComments;
@@ -78,12 +209,14 @@ namespace Scanner
     ConsumeState& operator=(const ConsumeState&) = delete;
     virtual ~ConsumeState();
     void attach(std::istream* pIn);
+    void attach(const char* pBuffer, size_t size);
     virtual void eatChars() = 0;
     void consumeChars() {
+      _pContext->_tokStart = _pContext->_in.current();
       _pContext->_pState->eatChars();
       _pContext->_pState = nextState();
     }
-    bool canRead() { return _pContext->_pIn->good(); }
+    bool canRead() { return _pContext->_in.good(); }
     std::string getTok() { return _pContext->token; }
     bool hasTok() { return _pContext->token.size() > 0; }
     ConsumeState* nextState();
@@ -94,8 +227,14 @@ namespace Scanner
   protected:
     Context* _pContext;
     bool collectChar();
+    void collectUntil(char stop, bool keep);
+    void collectBlanks();
     bool isOneCharToken(Token tok);
     bool isTwoCharToken(Token tok);
+    bool isOneCharToken(int ch) { return _pContext->_oneCharTable[(unsigned char)ch]; }
+    bool isTwoCharToken(int first, int second) {
+      return _pContext->_twoCharTable[(unsigned char)first * 256 + (unsigned char)second];
+    }
     Token makeString(int ch);
   };
 }
@@ -115,22 +254,46 @@ void ConsumeState::attach(std::istream* pIn)
 {
   _pContext->_pState = _pContext->_pEatWhitespace;
   _pContext->_lineCount = 0;
-  _pContext->_pIn = pIn;
+  _pContext->_in.attach(pIn);
+}
+//----< attach or re-attach to buffer >------------------------------
+
+void ConsumeState::attach(const char* pBuffer, size_t size)
+{
+  _pContext->_pState = _pContext->_pEatWhitespace;
+  _pContext->_lineCount = 0;
+  _pContext->_in.attach(pBuffer, size);
 }
 //----< replace one and two char tokens >----------------------------
 
 void ConsumeState::setSpecialTokens(const std::string& commaSeparatedTokens)
 {
-  std::vector<Token> result = Utilities::StringHelper::split(commaSeparatedTokens);
   _pContext->_oneCharTokens.clear();
   _pContext->_twoCharTokens.clear();
-  for (std::string item : result)
+  for (Utilities::StringView item : Utilities::StringHelper::splitView(commaSeparatedTokens))
   {
-    if (item.size() == 1 || item == "\n")
-      _pContext->_oneCharTokens.push_back(item);
+    if (item.size() == 1)
+      _pContext->_oneCharTokens.push_back(item.str());
     if (item.size() >= 2)
-      _pContext->_twoCharTokens.push_back(item);
+      _pContext->_twoCharTokens.push_back(item.str());
   }
+  _pContext->indexSpecialTokens();
+}
+//----< build constant time lookup tables from special token lists >---
+/*
+ * - only one and two char entries can ever match, as before
+ */
+void Context::indexSpecialTokens()
+{
+  for (size_t i = 0; i < 256; ++i)
+    _oneCharTable[i] = false;
+  for (auto& tok : _oneCharTokens)
+    if (tok.size() == 1)
+      _oneCharTable[(unsigned char)tok[0]] = true;
+  _twoCharTable.reset();
+  for (auto& tok : _twoCharTokens)
+    if (tok.size() == 2)
+      _twoCharTable[(unsigned char)tok[0] * 256 + (unsigned char)tok[1]] = true;
 }
 //----< return number of newlines collected from stream >------------
 
@@ -140,10 +303,10 @@ size_t ConsumeState::currentLineCount() { return _pContext->_lineCount; }
 
 bool ConsumeState::collectChar()
 {
-  if (_pContext->_pIn->good())
+  if (_pContext->_in.good())
   {
     _pContext->prevChar = _pContext->currChar;
-    _pContext->currChar = _pContext->_pIn->get();
+    _pContext->currChar = _pContext->_in.get();
     if (_pContext->currChar == '\n')
       ++(_pContext->_lineCount);
     return true;
@@ -151,6 +314,51 @@ bool ConsumeState::collectChar()
   return false;
 }
 
+//----< collect chars up to, not including, the next stop char >----
+/*
+ * - same as repeating "if keep, append currChar, then collectChar()"
+ *   while the next char isn't stop, but in one pass over the buffer
+ * - leaves currChar at the last char collected, so the caller's loop
+ *   goes on as if it had collected them one at a time
+ * - does nothing for stream input
+ */
+void ConsumeState::collectUntil(char stop, bool keep)
+{
+  Source& in = _pContext->_in;
+  if (!in.isBuffer() || !in.good())
+    return;
+  const char* next = in.next();
+  size_t newlines = 0;
+  const char* found = in.find(stop, newlines);
+  if (found == next)
+    return;
+  if (keep)
+  {
+    _pContext->token += (char)_pContext->currChar;
+    _pContext->token.append(next, found - 1);
+  }
+  _pContext->prevChar = (found - next >= 2) ? (unsigned char)found[-2] : _pContext->currChar;
+  _pContext->currChar = (unsigned char)found[-1];
+  _pContext->_lineCount += newlines;
+  in.skipTo(found);
+}
+//----< collect following spaces and tabs, for buffer input >--------
+
+void ConsumeState::collectBlanks()
+{
+  Source& in = _pContext->_in;
+  if (!in.isBuffer() || !in.good())
+    return;
+  const char* next = in.next();
+  const char* stop = next;
+  while (stop < in.end() && (*stop == ' ' || *stop == '\t'))
+    ++stop;
+  if (stop == next)
+    return;
+  _pContext->prevChar = (stop - next >= 2) ? (unsigned char)stop[-2] : _pContext->currChar;
+  _pContext->currChar = (unsigned char)stop[-1];
+  in.skipTo(stop);
+}
 //----< logs to console if TEST_LOG is defined >---------------------
 
 void testLog(const std::string& msg);  // forward declaration
@@ -165,19 +373,13 @@ void ConsumeState::returnComments(bool doReturnComments)
 
 bool ConsumeState::isOneCharToken(Token tok)
 {
-  for (size_t i = 0; i < _pContext->_oneCharTokens.size(); ++i)
-    if (_pContext->_oneCharTokens[i] == tok)
-      return true;
-  return false;
+  return tok.size() == 1 && isOneCharToken(tok[0]);
 }
 //----< is tok one of the special two character tokens? >------------
 
 bool ConsumeState::isTwoCharToken(Token tok)
 {
-  for (size_t i = 0; i < _pContext->_twoCharTokens.size(); ++i)
-    if (_pContext->_twoCharTokens[i] == tok)
-      return true;
-  return false;
+  return tok.size() == 2 && isTwoCharToken(tok[0], tok[1]);
 }
 //----< make a string with this one integer >------------------------
 
@@ -192,16 +394,16 @@ ConsumeState* ConsumeState::nextState()
 {
   std::locale loc;
 
-  if (!(_pContext->_pIn->good()))
+  if (!(_pContext->_in.good()))
   {
     return nullptr;
   }
-  int chNext = _pContext->_pIn->peek();
+  int chNext = _pContext->_in.peek();
   if (chNext == EOF)
   {
-    _pContext->_pIn->clear();
+    _pContext->_in.clear();
     // if peek() reads end of file character, EOF, then eofbit is set and
-    // _pIn->good() will return false.  clear() restores state to good
+    // _in.good() will return false.  clear() restores state to good
   }
   //---------------------------------------------------------
   // The following tests must come first
@@ -239,7 +441,7 @@ ConsumeState* ConsumeState::nextState()
   //---------------------------------------------------------
   // The following tests must come after those above
 
-  if (isOneCharToken(makeString(_pContext->currChar)))
+  if (isOneCharToken(_pContext->currChar))
   {
     testLog("state: eatSpecialCharacters");
     return _pContext->_pEatSpecialCharacters;
@@ -259,7 +461,7 @@ ConsumeState* ConsumeState::nextState()
     testLog("state: eatPunctuator");
     return _pContext->_pEatPunctuator;
   }
-  if (!_pContext->_pIn->good())
+  if (!_pContext->_in.good())
   {
     testLog("state: eatWhitespace");
     return _pContext->_pEatWhitespace;
@@ -284,6 +486,7 @@ public:
     std::locale loc;
     _pContext->token.clear();
     do {
+      collectBlanks();
       if (!collectChar())
         return;
     } while (std::isspace(_pContext->currChar, loc) && _pContext->currChar != '\n');
@@ -301,7 +504,9 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::Comment;
     do {
+      collectUntil('\n', _pContext->_doReturnComments);
       if (_pContext->_doReturnComments)
         _pContext->token += _pContext->currChar;
       if (!collectChar())
@@ -321,12 +526,14 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::Comment;
     do {
+      collectUntil('*', _pContext->_doReturnComments);
       if (_pContext->_doReturnComments)
         _pContext->token += _pContext->currChar;
       if (!collectChar())
         return;
-    } while (_pContext->currChar != '*' || _pContext->_pIn->peek() != '/');
+    } while (_pContext->currChar != '*' || _pContext->_in.peek() != '/');
     if (_pContext->_doReturnComments)
       _pContext->token += _pContext->currChar;
     if (!collectChar())      // get terminating '/'
@@ -348,7 +555,8 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
-    int chNext = _pContext->_pIn->peek();
+    _pContext->_kind = TokenKind::Punctuator;
+    int chNext = _pContext->_in.peek();
     do {
       if (_pContext->currChar == '\"' && _pContext->prevChar != '\\')    // start of double quoted string
       {
@@ -362,13 +570,12 @@ public:
       {
         return;
       }
-      Token temp = makeString(_pContext->currChar);
-      if (isOneCharToken(temp))
+      if (isOneCharToken(_pContext->currChar))
       {
         return;
       }
       _pContext->token += _pContext->currChar;
-      if (!_pContext->_pIn->good())  // end of stream
+      if (!_pContext->_in.good())  // end of stream
       {
         return;
       }
@@ -391,7 +598,7 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
-    int chNext = _pContext->_pIn->peek();
+    _pContext->_kind = TokenKind::Alphanum;
     do {
       _pContext->token += _pContext->currChar;
       if (!collectChar())
@@ -411,9 +618,9 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = (_pContext->currChar == '\n') ? TokenKind::Newline : TokenKind::Special;
     _pContext->token += _pContext->currChar;
-    Token temp = makeString(_pContext->currChar) += _pContext->_pIn->peek();
-    if (isTwoCharToken(temp))
+    if (isTwoCharToken(_pContext->currChar, _pContext->_in.peek()))
     {
       collectChar();
       _pContext->token += _pContext->currChar;
@@ -446,8 +653,10 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::String;
     do
     {
+      collectUntil('\"', true);
       _pContext->token += _pContext->currChar;
       if (!collectChar())
         return;
@@ -469,6 +678,7 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::String;
     do
     {
       _pContext->token += _pContext->currChar;
@@ -491,6 +701,7 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::String;
     do
     {
       _pContext->token += _pContext->currChar;
@@ -513,8 +724,10 @@ public:
   virtual void eatChars()
   {
     _pContext->token.clear();
+    _pContext->_kind = TokenKind::String;
     do
     {
+      collectUntil('\'', true);
       _pContext->token += _pContext->currChar;
       if (!collectChar())
         return;
@@ -540,6 +753,7 @@ Context::Context()
   _pState = _pEatWhitespace;
   _lineCount = 0;
   _doReturnComments = false;
+  indexSpecialTokens();
 }
 //----< return shared resources >------------------------------------
 
@@ -592,25 +806,162 @@ bool Toker::attach(std::istream* pIn)
 {
   if (pIn != nullptr && pIn->good())
   {
+    _pContext->_pTee = nullptr;
     pConsumer->attach(pIn);
-    //_pContext->_pIn = pIn;
     return true;
   }
   return false;
 }
+//----< attach tokenizer to buffer, which must outlive the scan >----
+/*
+ * - tokens are the same as for a stream holding the buffer's chars
+ * - use canRead(), not the state of a stream, to find the end
+ */
+bool Toker::attach(const char* pBuffer, size_t size)
+{
+  if (pBuffer == nullptr && size > 0)
+    return false;
+  _pContext->_pTee = nullptr;
+  pConsumer->attach(pBuffer, size);
+  return true;
+}
+//----< read whole file into text, CR LF read as LF >----------------
+/*
+ * - one read replaces a stream call per character
+ * - text is what a text mode stream returns, so line counts and
+ *   published pages don't change
+ */
+bool Toker::readFile(const std::string& fileSpec, std::string& text)
+{
+  std::ifstream in(fileSpec, std::ios::binary);
+  if (!in.good())
+    return false;
+  in.seekg(0, std::ios::end);
+  std::streamoff size = in.tellg();
+  in.seekg(0, std::ios::beg);
+  text.resize(size > 0 ? (size_t)size : 0);
+  if (text.size() > 0)
+    in.read(&text[0], text.size());
+  text.resize((size_t)in.gcount());
+  size_t out = 0;
+  for (size_t i = 0; i < text.size(); ++i)
+  {
+    if (text[i] == '\r' && i + 1 < text.size() && text[i + 1] == '\n')
+      continue;
+    text[out++] = text[i];
+  }
+  text.resize(out);
+  return true;
+}
+//----< number of bytes in a leading Byte Order Mark >---------------
+
+static size_t bomSize(const std::string& text)
+{
+  if (text.size() >= 3 && text.compare(0, 3, "\xEF\xBB\xBF") == 0)
+    return 3;
+  return 0;
+}
+//----< read whole file into one buffer and attach to it >-----------
+/*
+ * - a UTF-8 Byte Order Mark is skipped
+ */
+bool Toker::attachFile(const std::string& fileSpec)
+{
+  std::string& buffer = _pContext->_buffer;
+  if (!readFile(fileSpec, buffer))
+    return false;
+  size_t start = bomSize(buffer);
+  return attach(buffer.data() + start, buffer.size() - start);
+}
+//----< attach to file's text in cache, record tokens as they're read >---
+/*
+ * - replaces any earlier entry for the file
+ * - the entry is complete when getTok reaches the end of the file
+ */
+bool Toker::attachFile(const std::string& fileSpec, TokenCache& cache)
+{
+  TokenCache::Entry& entry = cache.open(fileSpec);
+  if (!readFile(fileSpec, entry.source))
+    return false;
+  size_t start = bomSize(entry.source);
+  attach(entry.source.data() + start, entry.source.size() - start);
+  _pContext->_pTee = &entry;
+  return true;
+}
+//----< attach to text readFile read, without reading the file >----
+/*
+ * - text is moved into the Toker's buffer, a Byte Order Mark skipped,
+ *   so tokens are those attachFile finds
+ */
+bool Toker::attachText(std::string&& text)
+{
+  std::string& buffer = _pContext->_buffer;
+  buffer = std::move(text);
+  size_t start = bomSize(buffer);
+  return attach(buffer.data() + start, buffer.size() - start);
+}
+//----< attach to text readFile read, recorded as fileSpec's cache entry >---
+/*
+ * - as attachFile(fileSpec, cache), with the text moved into the entry
+ */
+bool Toker::attachText(const std::string& fileSpec, std::string&& text, TokenCache& cache)
+{
+  TokenCache::Entry& entry = cache.open(fileSpec);
+  entry.source = std::move(text);
+  size_t start = bomSize(entry.source);
+  attach(entry.source.data() + start, entry.source.size() - start);
+  _pContext->_pTee = &entry;
+  return true;
+}
 //----< collect token generated by ConsumeState >--------------------
 
 std::string Toker::getTok()
+{
+  TokenView tok;
+  if (!nextTok(tok))
+    return "";
+  return tok.str();
+}
+//----< get next token as a view, false when there are no more >----
+/*
+ * - with a buffer attached the view points into the buffer, so it
+ *   stays valid as long as the buffer does
+ * - with a stream attached, or for a token that ran into end of
+ *   input, the view holds the Toker's token and is valid until the
+ *   next call
+ */
+bool Toker::nextTok(TokenView& tok)
 {
   while(true) 
   {
     if (!pConsumer->canRead())
-      return "";
+    {
+      if (_pContext->_pTee != nullptr)
+      {
+        _pContext->_pTee->complete = true;
+        _pContext->_pTee = nullptr;
+      }
+      tok = TokenView();
+      return false;
+    }
     pConsumer->consumeChars();
     if (pConsumer->hasTok())
       break;
   }
-  return pConsumer->getTok();
+  const std::string& token = _pContext->token;
+  if (_pContext->_pTee != nullptr)
+  {
+    _pContext->_pTee->tokens.push_back(token);
+    _pContext->_pTee->lines.push_back(_pContext->_lineCount);
+  }
+  const char* start = _pContext->_tokStart;
+  if (start != nullptr && token.size() <= (size_t)(_pContext->_in.end() - start))
+    tok.text = start;
+  else
+    tok.text = token.data();
+  tok.size = token.size();
+  tok.kind = _pContext->_kind;
+  return true;
 }
 //----< has toker reached the end of its stream? >-------------------
 
@@ -642,6 +993,60 @@ void Toker::setSpecialTokens(const std::string& commaSeparatedTokens)
 {
   pConsumer->setSpecialTokens(commaSeparatedTokens);
 }
+//----< full path of file, used as cache key >-----------------------
+
+std::string TokenCache::key(const std::string& fileSpec)
+{
+#ifdef _WIN32
+  char full[_MAX_PATH];
+  if (_fullpath(full, fileSpec.c_str(), _MAX_PATH) != nullptr)
+    return full;
+#else
+  char* full = realpath(fileSpec.c_str(), nullptr);
+  if (full != nullptr)
+  {
+    std::string result(full);
+    free(full);
+    return result;
+  }
+#endif
+  return fileSpec;
+}
+//----< make new empty entry for file, replacing any earlier one >---
+
+TokenCache::Entry& TokenCache::open(const std::string& fileSpec)
+{
+  std::string name = key(fileSpec);
+  std::lock_guard<std::mutex> lock(mtx_);
+  std::unique_ptr<Entry>& pEntry = entries_[name];
+  pEntry.reset(new Entry);
+  return *pEntry;
+}
+//----< entry for file if it was tokenized to the end, else nullptr >---
+
+const TokenCache::Entry* TokenCache::find(const std::string& fileSpec) const
+{
+  std::string name = key(fileSpec);
+  std::lock_guard<std::mutex> lock(mtx_);
+  auto iter = entries_.find(name);
+  if (iter == entries_.end() || !iter->second->complete)
+    return nullptr;
+  return iter->second.get();
+}
+//----< number of files held >---------------------------------------
+
+size_t TokenCache::size() const
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  return entries_.size();
+}
+//----< release all entries >----------------------------------------
+
+void TokenCache::clear()
+{
+  std::lock_guard<std::mutex> lock(mtx_);
+  entries_.clear();
+}
 //----< debugging output to console if TEST_LOG is #defined >--------
 
 void testLog(const std::string& msg)
@@ -715,6 +1120,83 @@ int main()
     } while (in.good());
     std::cout << "\n  current line count = " << toker.currentLineCount() << "\n";
 
+    putline();
+    Helper::title("Testing attachFile, tokens must match stream input");
+    {
+      std::ifstream again(fileSpec);
+      Toker streamToker, bufferToker;
+      streamToker.attach(&again);
+      bufferToker.attachFile(fileSpec);
+      size_t count = 0, mismatches = 0;
+      do
+      {
+        if (streamToker.getTok() != bufferToker.getTok())
+          ++mismatches;
+        ++count;
+      } while (again.good());
+      if (bufferToker.canRead() || streamToker.currentLineCount() != bufferToker.currentLineCount())
+        ++mismatches;
+      std::cout << "\n  " << count << " tokens, " << mismatches << " mismatches\n";
+    }
+
+    putline();
+    Helper::title("Testing attachText, tokens must match attachFile");
+    {
+      Toker fileToker, textToker;
+      std::string text;
+      fileToker.attachFile(fileSpec);
+      if (Toker::readFile(fileSpec, text))
+        textToker.attachText(std::move(text));
+      size_t count = 0, mismatches = 0;
+      std::string tok;
+      do
+      {
+        tok = fileToker.getTok();
+        if (tok != textToker.getTok())
+          ++mismatches;
+        ++count;
+      } while (tok != "");
+      if (fileToker.currentLineCount() != textToker.currentLineCount())
+        ++mismatches;
+      std::cout << "\n  " << count << " tokens, " << mismatches << " mismatches\n";
+    }
+
+    putline();
+    Helper::title("Testing TokenCache");
+    {
+      TokenCache cache;
+      Toker cachingToker;
+      cachingToker.attachFile(fileSpec, cache);
+      while (cachingToker.getTok() != "");
+      const TokenCache::Entry* pEntry = cache.find(fileSpec);
+      if (pEntry != nullptr)
+        std::cout << "\n  cached " << pEntry->tokens.size() << " tokens, "
+                  << pEntry->source.size() << " chars, last line " << pEntry->lines.back() << "\n";
+      else
+        std::cout << "\n  file wasn't cached\n";
+    }
+
+    putline();
+    Helper::title("Testing nextTok, views must match getTok");
+    {
+      Toker stringToker, viewToker;
+      stringToker.attachFile(fileSpec);
+      viewToker.attachFile(fileSpec);
+      size_t count = 0, mismatches = 0, strings = 0;
+      TokenView tok;
+      while (viewToker.nextTok(tok))
+      {
+        if (tok != stringToker.getTok())
+          ++mismatches;
+        if (tok.kind == TokenKind::String)
+          ++strings;
+        ++count;
+      }
+      if (stringToker.getTok() != "")
+        ++mismatches;
+      std::cout << "\n  " << count << " tokens, " << strings << " strings, " << mismatches << " mismatches\n";
+    }
+
     //Helper::title("Testing re-attach:");
     //std::string path = "../Tokenizer/Tokenizer.h";
     //std::ifstream inAgain(path);
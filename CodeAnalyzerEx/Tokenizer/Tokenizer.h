@@ -4,7 +4,7 @@
 #define TOKENIZER_H
 ///////////////////////////////////////////////////////////////////////
 // Tokenizer.h - read words from a std::stream                       //
-// ver 4.2                                                           //
+// ver 4.9                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Platform:    Dell XPS 8900, Windows 10                            //
 // Application: Parser component, CSE687 - Object Oriented Design    //
@@ -18,8 +18,26 @@
  * Toker reads words from a std::stream, throws away whitespace and optionally
  * throws away comments.
  *
+ * Toker can also scan a buffer in memory.  attachFile reads a whole file
+ * into one buffer, so characters are taken with a pointer instead of
+ * a stream call each.  Tokens and line counts are the same either way.
+ * With a buffer, comments and quoted strings are skipped to their next
+ * terminating char in one search, 16 chars at a time where SSE2 is
+ * available, and runs of blanks without a locale call per char.
+ *
+ * TokenCache keeps, for each file, its text and the tokens one Toker pass
+ * found in it.  A Toker attached with attachFile(fileSpec, cache) fills
+ * the file's entry as it is read, so later passes over the same file, like
+ * dependency analysis and publishing, need not read or tokenize it again.
+ * attachText takes text readFile already read, e.g., on another thread, and
+ * scans it as attachFile would have.
+ *
  * Toker returns words from the stream in the order encountered.  Quoted
  * strings and certain punctuators and newlines are returned as single tokens.
+ * nextTok returns the same tokens as TokenViews, a pointer, size and kind,
+ * without copying each into a new std::string.  Special one and two char
+ * tokens are found with lookup tables, so the cost doesn't grow with the
+ * number of special tokens.
  *
  * This is a new version, based on the State Design Pattern.  Older versions
  * exist, based on an informal state machine design.
@@ -32,6 +50,26 @@
  *
  * Maintenance History:
  * --------------------
+ * ver 4.9 : 14 Oct 2026
+ * - added attachText, attaches to a file's text read ahead with readFile
+ * ver 4.8 : 14 Oct 2026
+ * - setSpecialTokens reads its list with StringHelper::splitView, no token
+ *   vector is built
+ * ver 4.7 : 14 Oct 2026
+ * - TokenCache::key is public, for other tables kept by file
+ * ver 4.6 : 14 Oct 2026
+ * - comment, quoted string and whitespace states take runs of chars in
+ *   one step for buffer input, counting the newlines they pass
+ * ver 4.5 : 14 Oct 2026
+ * - added TokenView, TokenKind and nextTok(view)
+ * - special one and two char tokens are looked up in tables built by
+ *   setSpecialTokens, instead of searching vectors of strings
+ * ver 4.4 : 14 Oct 2026
+ * - added TokenCache and attachFile(fileSpec, cache), which records each
+ *   token returned, with its line count, in the file's cache entry
+ * ver 4.3 : 14 Oct 2026
+ * - added attach(buffer, size) and attachFile(fileSpec).  States read chars
+ *   through a Source that holds either a stream or a buffer.
  * ver 4.2 : 26 Feb 2017
  * - converted all uses of std::isspace from <cctype> to std::isspace from <locale>
  * ver 4.1 : 19 Aug 2016
@@ -84,17 +122,62 @@
  * ------------------------------
  * - merge the oneCharacter and twoCharacter special Tokens into a
  *   single collection with a single setter method.
- * - consider replacing std::vector containers for special characteres
- *   with an unordered_map (hash table).
  */
 #include <iosfwd>
 #include <string>
+#include <vector>
+#include <unordered_map>
+#include <memory>
+#include <mutex>
 
 namespace Scanner
 {
   class ConsumeState;    // private worker class
   struct Context;        // private shared data storage
 
+  enum class TokenKind { None, Alphanum, Punctuator, Special, Newline, String, Comment };
+
+  ///////////////////////////////////////////////////////////////////
+  // TokenView refers to a token's chars without owning them
+  // - see Toker::nextTok for how long the chars stay valid
+
+  struct TokenView
+  {
+    const char* text = nullptr;
+    size_t size = 0;
+    TokenKind kind = TokenKind::None;
+    std::string str() const { return std::string(text, size); }
+    bool operator==(const std::string& s) const { return s.size() == size && s.compare(0, size, text, size) == 0; }
+    bool operator!=(const std::string& s) const { return !(*this == s); }
+  };
+
+  ///////////////////////////////////////////////////////////////////
+  // TokenCache holds the text and tokens of files already tokenized
+  // - entries are keyed by full path, so relative and absolute names
+  //   of a file find the same entry
+  // - open and find may be called from several threads; an entry is
+  //   only filled by the Toker that opened it, and found by later passes
+
+  class TokenCache
+  {
+  public:
+    struct Entry
+    {
+      std::string source;               // file text, CR LF read as LF
+      std::vector<std::string> tokens;  // tokens in order, comments only if Toker returns them
+      std::vector<size_t> lines;        // line count when each token was read
+      bool complete = false;            // Toker reached end of file
+    };
+    Entry& open(const std::string& fileSpec);
+    const Entry* find(const std::string& fileSpec) const;
+    size_t size() const;
+    void clear();
+    static std::string key(const std::string& fileSpec);
+  private:
+    mutable std::mutex mtx_;
+    std::unordered_map<std::string, std::unique_ptr<Entry>> entries_;
+  };
+
   class Toker
   {
   public:
@@ -103,7 +186,14 @@ namespace Scanner
     ~Toker();
     Toker& operator=(const Toker&) = delete;
     bool attach(std::istream* pIn);
+    bool attach(const char* pBuffer, size_t size);
+    bool attachFile(const std::string& fileSpec);
+    bool attachFile(const std::string& fileSpec, TokenCache& cache);
+    bool attachText(std::string&& text);
+    bool attachText(const std::string& fileSpec, std::string&& text, TokenCache& cache);
+    static bool readFile(const std::string& fileSpec, std::string& text);
     std::string getTok();
+    bool nextTok(TokenView& tok);
     bool canRead();
     void returnComments(bool doReturnComments = true);
     bool isComment(const std::string& tok);
@@ -0,0 +1,109 @@
+///////////////////////////////////////////////////////////////////////
+// MemoryHooks.cpp - global operator new and delete for MemoryProfile//
+// ver 1.0                                                           //
+// Language:    C++, Visual Studio 2015                              //
+// Platform:    Dell XPS 8900, Windows 10                            //
+// Application: Most Projects, CSE687 - Object Oriented Design       //
+// Author:      Jim Fawcett, Syracuse University, CST 4-187          //
+//              jfawcett@twcny.rr.com                                //
+///////////////////////////////////////////////////////////////////////
+/*
+* Replaces the global operator new and delete, scalar, array, sized
+* and nothrow, with ones that allocate from malloc and tell
+* MemoryProfile each block's size.  Link this file into a program, as
+* Executive does, to profile its allocations; it must be linked only
+* once per program.
+*
+* Blocks are sized by _msize, so no header is added to blocks and a
+* program whose profile is never enabled allocates as before.  Hooks
+* only use MemoryProfile's static functions, never instance(), as
+* constructing the profile may itself allocate.
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+#include "MemoryProfile.h"
+#include <new>
+#include <cstdlib>
+#include <malloc.h>
+
+using Utilities::MemoryProfile;
+
+namespace
+{
+  //----< malloc size bytes, calling the new handler while it fails >--
+
+  void* allocate(size_t size)
+  {
+    if (size == 0)
+      size = 1;
+    void* pBlock;
+    while ((pBlock = std::malloc(size)) == nullptr)
+    {
+      std::new_handler handler = std::get_new_handler();
+      if (handler == nullptr)
+        throw std::bad_alloc();
+      handler();
+    }
+    if (MemoryProfile::counting())
+      MemoryProfile::allocated(_msize(pBlock));
+    return pBlock;
+  }
+  //----< free a block allocate returned >-----------------------------
+
+  void release(void* pBlock)
+  {
+    if (pBlock == nullptr)
+      return;
+    if (MemoryProfile::counting())
+      MemoryProfile::freed(_msize(pBlock));
+    std::free(pBlock);
+  }
+
+  void* allocateNoThrow(size_t size)
+  {
+    try
+    {
+      return allocate(size);
+    }
+    catch (std::bad_alloc&)
+    {
+      return nullptr;
+    }
+  }
+}
+
+void* operator new(size_t size) { return allocate(size); }
+void* operator new[](size_t size) { return allocate(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocateNoThrow(size); }
+void operator delete(void* pBlock) noexcept { release(pBlock); }
+void operator delete[](void* pBlock) noexcept { release(pBlock); }
+void operator delete(void* pBlock, size_t) noexcept { release(pBlock); }
+void operator delete[](void* pBlock, size_t) noexcept { release(pBlock); }
+void operator delete(void* pBlock, const std::nothrow_t&) noexcept { release(pBlock); }
+void operator delete[](void* pBlock, const std::nothrow_t&) noexcept { release(pBlock); }
+
+#ifdef TEST_MEMORYHOOKS
+
+#include <iostream>
+#include <vector>
+#include <string>
+
+int main()
+{
+  MemoryProfile& memory = MemoryProfile::instance();
+  memory.enable();
+  {
+    MemoryProfile::Phase phase("fill");
+    MemoryProfile::Subsystem tag("vectors");
+    std::vector<std::string> strings;
+    for (size_t i = 0; i < 1000; ++i)
+      strings.push_back(std::string(100, 'x'));
+  }
+  std::cout << "\n  hooked: " << std::boolalpha << memory.hooked();
+  std::cout << memory.summary() << "\n\n";
+}
+#endif
@@ -0,0 +1,545 @@
+#ifndef MEMORYPROFILE_H
+#define MEMORYPROFILE_H
+///////////////////////////////////////////////////////////////////////
+// MemoryProfile.h - allocation counts per phase and per subsystem   //
+// ver 1.0                                                           //
+// Language:    C++, Visual Studio 2015                              //
+// Platform:    Dell XPS 8900, Windows 10                            //
+// Application: Most Projects, CSE687 - Object Oriented Design       //
+// Author:      Jim Fawcett, Syracuse University, CST 4-187          //
+//              jfawcett@twcny.rr.com                                //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides class MemoryProfile, one per process, which
+* counts heap allocations, bytes allocated and freed, and live bytes
+* with their peak:
+* - per phase, e.g., parse or dependencyTable, counting every thread's
+*   allocations while the phase runs, with the live bytes the phase
+*   left behind and the peak live bytes reached while it ran
+* - per subsystem, e.g., parser, typeTable, NoSqlDb, by the subsystem
+*   the allocating thread is working for
+* and writes them as a JSON or CSV report.
+*
+* Counts come from the global operator new and delete replacements
+* in MemoryHooks.cpp, which a program links to be profiled.  They call
+* allocated and freed only while counting, i.e., once it is enabled,
+* so a linked program costs a test of one flag per allocation when
+* nobody is looking.  Live bytes count from when profiling was enabled.
+*
+* MemoryProfile::Subsystem names the subsystem the calling thread is
+* working for until it ends, then restores the one before it.  Thread
+* pools must name theirs on each worker.  Allocations made by no named
+* subsystem are counted as "other".  A block is counted as freed by
+* the subsystem of the thread that frees it, so a subsystem's live and
+* peak bytes are what it allocated less what it freed itself.
+*
+* MemoryProfile::Phase counts from its construction to its end on
+* any thread.  RunProfile::Scope makes one for each phase it times,
+* even with RunProfile disabled.
+* Phases may nest, an outer phase's peak includes an inner one's.
+*
+* Everything hooks touch is constant initialized, so allocations made
+* before main, or by static destructors, are safe to count.
+*
+* Public Interface:
+* -----------------
+* MemoryProfile& memory = MemoryProfile::instance();
+* memory.enable();
+* {
+*   MemoryProfile::Phase phase("parse");
+*   MemoryProfile::Subsystem tag("parser");
+*   ... allocations counted in parse and in parser
+* }
+* MemoryProfile::Usage total = memory.total();
+* bool linked = memory.hooked();
+* memory.writeJson("memory.json");
+* memory.writeCsv("memory.csv");
+* std::string table = memory.summary();
+*
+* Build Process:
+* --------------
+* Required Files: MemoryProfile.h, MemoryHooks.cpp
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+#include <string>
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstring>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+namespace Utilities
+{
+  class MemoryProfile
+  {
+  public:
+    static const size_t MaxSubsystems = 32;   // later names count as "other"
+
+    struct Usage
+    {
+      long long allocated = 0;     // bytes
+      long long allocations = 0;
+      long long freed = 0;         // bytes
+      long long frees = 0;
+      long long live = 0;          // bytes, for a phase those it left behind
+      long long peak = 0;          // most live bytes at once
+    };
+    struct PhaseRecord
+    {
+      std::string name;
+      size_t calls = 0;
+      Usage usage;
+    };
+    struct SubsystemRecord
+    {
+      std::string name;
+      Usage usage;
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // Subsystem names what the calling thread allocates for
+
+    class Subsystem
+    {
+    public:
+      Subsystem(const char* name);
+      Subsystem(const Subsystem&) = delete;
+      Subsystem& operator=(const Subsystem&) = delete;
+      ~Subsystem();
+    private:
+      bool active_;
+      size_t outer_;
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // Phase counts every thread's allocations during its lifetime
+
+    class Phase
+    {
+    public:
+      Phase(const std::string& name);
+      Phase(const Phase&) = delete;
+      Phase& operator=(const Phase&) = delete;
+      ~Phase();
+    private:
+      bool active_;
+      std::string name_;
+      Usage start_;
+      long long outerPeak_ = 0;
+    };
+
+    static MemoryProfile& instance();
+    void enable(bool doEnable = true) { counters().enabled = doEnable; }
+    bool enabled() const { return counters().enabled; }
+    static bool counting() { return counters().enabled.load(std::memory_order_relaxed); }
+    static void allocated(size_t bytes);
+    static void freed(size_t bytes);
+    bool hooked() const { return counters().total.allocations > 0; }
+    Usage total() const;
+    std::vector<PhaseRecord> phases();
+    std::vector<SubsystemRecord> subsystems() const;
+    void clear();
+    bool writeJson(const std::string& fileSpec);
+    bool writeCsv(const std::string& fileSpec);
+    std::string summary();
+  private:
+    struct Tally
+    {
+      std::atomic<long long> allocated;
+      std::atomic<long long> allocations;
+      std::atomic<long long> freed;
+      std::atomic<long long> frees;
+      std::atomic<long long> live;
+      std::atomic<long long> peak;
+      void add(long long bytes);
+      void remove(long long bytes);
+      Usage usage() const;
+      void reset();
+    };
+    struct Slot
+    {
+      std::atomic<const char*> name;   // a string literal, nullptr for "other"
+      Tally tally;
+    };
+    struct Counters
+    {
+      std::atomic<bool> enabled;
+      Tally total;
+      std::atomic<long long> phasePeak;   // peak live bytes of the innermost phase
+      std::atomic<size_t> slotCount;
+      Slot slots[MaxSubsystems];
+    };
+    MemoryProfile() {}
+    static Counters& counters();
+    static size_t& currentSlot();
+    static size_t slotOf(const char* name);
+    static void raise(std::atomic<long long>& peak, long long live);
+    static std::string jsonString(const std::string& src);
+    static std::string csvString(const std::string& src);
+    std::mutex mtx_;
+    std::vector<PhaseRecord> phases_;
+  };
+
+  //----< the process's one profile >----------------------------------
+
+  inline MemoryProfile& MemoryProfile::instance()
+  {
+    static MemoryProfile profile;
+    return profile;
+  }
+  //----< counters, zero before any code runs, so hooks can't race >---
+
+  inline MemoryProfile::Counters& MemoryProfile::counters()
+  {
+    static Counters counters;
+    return counters;
+  }
+  //----< slot of the subsystem the calling thread works for >---------
+
+  inline size_t& MemoryProfile::currentSlot()
+  {
+    static thread_local size_t slot = 0;
+    return slot;
+  }
+  //----< slot holding name, taking a free one for a new name >--------
+  /*
+  *  Two threads naming a new subsystem at once may take two slots,
+  *  subsystems() adds slots with the same name together.
+  */
+  inline size_t MemoryProfile::slotOf(const char* name)
+  {
+    Counters& c = counters();
+    size_t count = (std::min)(c.slotCount.load(), (size_t)MaxSubsystems);
+    for (size_t i = 1; i < count; ++i)
+    {
+      const char* held = c.slots[i].name;
+      if (held != nullptr && std::strcmp(held, name) == 0)
+        return i;
+    }
+    size_t slot = c.slotCount.fetch_add(1);
+    if (slot == 0)
+      slot = c.slotCount.fetch_add(1);   // slot 0 is "other"
+    if (slot >= MaxSubsystems)
+      return 0;
+    c.slots[slot].name = name;
+    return slot;
+  }
+  //----< raise peak to live if live is higher >-----------------------
+
+  inline void MemoryProfile::raise(std::atomic<long long>& peak, long long live)
+  {
+    long long seen = peak.load(std::memory_order_relaxed);
+    while (live > seen && !peak.compare_exchange_weak(seen, live, std::memory_order_relaxed))
+      ;
+  }
+  //----< count one block allocated, called by operator new >----------
+
+  inline void MemoryProfile::Tally::add(long long bytes)
+  {
+    allocated.fetch_add(bytes, std::memory_order_relaxed);
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    raise(peak, live.fetch_add(bytes, std::memory_order_relaxed) + bytes);
+  }
+  //----< count one block freed, called by operator delete >-----------
+
+  inline void MemoryProfile::Tally::remove(long long bytes)
+  {
+    freed.fetch_add(bytes, std::memory_order_relaxed);
+    frees.fetch_add(1, std::memory_order_relaxed);
+    live.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+
+  inline MemoryProfile::Usage MemoryProfile::Tally::usage() const
+  {
+    Usage u;
+    u.allocated = allocated;
+    u.allocations = allocations;
+    u.freed = freed;
+    u.frees = frees;
+    u.live = live;
+    u.peak = peak;
+    return u;
+  }
+
+  inline void MemoryProfile::Tally::reset()
+  {
+    allocated = 0;
+    allocations = 0;
+    freed = 0;
+    frees = 0;
+    peak = live.load();
+  }
+  //----< count an allocation of bytes, if profiling is enabled >------
+
+  inline void MemoryProfile::allocated(size_t bytes)
+  {
+    Counters& c = counters();
+    if (!c.enabled.load(std::memory_order_relaxed))
+      return;
+    c.total.add((long long)bytes);
+    raise(c.phasePeak, c.total.live.load(std::memory_order_relaxed));
+    c.slots[currentSlot()].tally.add((long long)bytes);
+  }
+  //----< count bytes freed, if profiling is enabled >-----------------
+
+  inline void MemoryProfile::freed(size_t bytes)
+  {
+    Counters& c = counters();
+    if (!c.enabled.load(std::memory_order_relaxed))
+      return;
+    c.total.remove((long long)bytes);
+    c.slots[currentSlot()].tally.remove((long long)bytes);
+  }
+  //----< whole process's counts since enabled or cleared >------------
+
+  inline MemoryProfile::Usage MemoryProfile::total() const
+  {
+    return counters().total.usage();
+  }
+  //----< phases in the order they first ended >-----------------------
+
+  inline std::vector<MemoryProfile::PhaseRecord> MemoryProfile::phases()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return phases_;
+  }
+  //----< each named subsystem, then "other" if it allocated >---------
+
+  inline std::vector<MemoryProfile::SubsystemRecord> MemoryProfile::subsystems() const
+  {
+    const Counters& c = counters();
+    std::vector<SubsystemRecord> records;
+    size_t count = (std::max)((std::min)(c.slotCount.load(), (size_t)MaxSubsystems), (size_t)1);
+    for (size_t i = 1; i <= count; ++i)
+    {
+      size_t slot = i < count ? i : 0;
+      const char* name = c.slots[slot].name;
+      Usage u = c.slots[slot].tally.usage();
+      if (slot != 0 && name == nullptr)
+        continue;
+      if (slot == 0 && u.allocations == 0 && u.frees == 0)
+        continue;
+      std::string named = slot == 0 ? "other" : name;
+      auto same = records.begin();
+      for (; same != records.end() && same->name != named; ++same)
+        ;
+      if (same == records.end())
+      {
+        records.push_back(SubsystemRecord());
+        records.back().name = named;
+        records.back().usage = u;
+        continue;
+      }
+      same->usage.allocated += u.allocated;
+      same->usage.allocations += u.allocations;
+      same->usage.freed += u.freed;
+      same->usage.frees += u.frees;
+      same->usage.live += u.live;
+      same->usage.peak += u.peak;
+    }
+    return records;
+  }
+  //----< discard phases and restart counts, live bytes are kept >-----
+
+  inline void MemoryProfile::clear()
+  {
+    Counters& c = counters();
+    c.total.reset();
+    c.phasePeak = c.total.live.load();
+    for (auto& slot : c.slots)
+      slot.tally.reset();
+    std::lock_guard<std::mutex> lock(mtx_);
+    phases_.clear();
+  }
+  //----< quote and escape src for JSON >------------------------------
+
+  inline std::string MemoryProfile::jsonString(const std::string& src)
+  {
+    std::string out = "\"";
+    for (char ch : src)
+    {
+      switch (ch)
+      {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:   out += ch;
+      }
+    }
+    return out + "\"";
+  }
+  //----< quote src for CSV if it holds a separator or quote >---------
+
+  inline std::string MemoryProfile::csvString(const std::string& src)
+  {
+    if (src.find_first_of(",\"\n") == std::string::npos)
+      return src;
+    std::string out = "\"";
+    for (char ch : src)
+    {
+      if (ch == '"')
+        out += '"';
+      out += ch;
+    }
+    return out + "\"";
+  }
+  //----< write total, phases and subsystems as one JSON object >------
+  /*
+  *  { "total": { "allocated", "allocations", "freed", "frees", "live", "peak" },
+  *    "phases":     [ { "name", "calls", usage... }, ... ],
+  *    "subsystems": [ { "name", usage... }, ... ] }
+  */
+  inline bool MemoryProfile::writeJson(const std::string& fileSpec)
+  {
+    std::vector<PhaseRecord> phaseList = phases();
+    std::vector<SubsystemRecord> subsystemList = subsystems();
+    std::ofstream out(fileSpec);
+    if (!out.good())
+      return false;
+    auto usage = [&out](const Usage& u) {
+      out << "\"allocated\": " << u.allocated << ", \"allocations\": " << u.allocations
+        << ", \"freed\": " << u.freed << ", \"frees\": " << u.frees
+        << ", \"live\": " << u.live << ", \"peak\": " << u.peak;
+    };
+    out << "{\n  \"total\": { ";
+    usage(total());
+    out << " },\n  \"phases\": [";
+    for (size_t i = 0; i < phaseList.size(); ++i)
+    {
+      out << (i == 0 ? "\n" : ",\n") << "    { \"name\": " << jsonString(phaseList[i].name)
+        << ", \"calls\": " << phaseList[i].calls << ", ";
+      usage(phaseList[i].usage);
+      out << " }";
+    }
+    out << "\n  ],\n  \"subsystems\": [";
+    for (size_t i = 0; i < subsystemList.size(); ++i)
+    {
+      out << (i == 0 ? "\n" : ",\n") << "    { \"name\": " << jsonString(subsystemList[i].name) << ", ";
+      usage(subsystemList[i].usage);
+      out << " }";
+    }
+    out << "\n  ]\n}\n";
+    return out.good();
+  }
+  //----< write a phase table, a blank line, then a subsystem table >--
+
+  inline bool MemoryProfile::writeCsv(const std::string& fileSpec)
+  {
+    std::vector<PhaseRecord> phaseList = phases();
+    std::vector<SubsystemRecord> subsystemList = subsystems();
+    std::ofstream out(fileSpec);
+    if (!out.good())
+      return false;
+    auto usage = [&out](const Usage& u) {
+      out << "," << u.allocated << "," << u.allocations << "," << u.freed << "," << u.frees
+        << "," << u.live << "," << u.peak << "\n";
+    };
+    out << "phase,calls,allocated,allocations,freed,frees,live,peak\n";
+    for (auto& phase : phaseList)
+    {
+      out << csvString(phase.name) << "," << phase.calls;
+      usage(phase.usage);
+    }
+    out << "total,1";
+    usage(total());
+    out << "\nsubsystem,allocated,allocations,freed,frees,live,peak\n";
+    for (auto& subsystem : subsystemList)
+    {
+      out << csvString(subsystem.name);
+      usage(subsystem.usage);
+    }
+    return out.good();
+  }
+  //----< phases and subsystems as a table of KB and counts >----------
+
+  inline std::string MemoryProfile::summary()
+  {
+    std::ostringstream out;
+    auto row = [&out](const std::string& name, const Usage& u) {
+      out << "\n    " << std::left << std::setw(34) << name << std::right
+        << std::setw(12) << u.allocated / 1024 << std::setw(12) << u.allocations
+        << std::setw(12) << u.live / 1024 << std::setw(12) << u.peak / 1024;
+    };
+    out << "\n    " << std::left << std::setw(34) << "memory" << std::right << std::setw(12) << "alloc KB"
+      << std::setw(12) << "allocs" << std::setw(12) << "live KB" << std::setw(12) << "peak KB";
+    for (auto& phase : phases())
+      row(phase.name, phase.usage);
+    row("total", total());
+    for (auto& subsystem : subsystems())
+      row("[" + subsystem.name + "]", subsystem.usage);
+    return out.str();
+  }
+  //----< work for name on this thread, if profiling is enabled >------
+
+  inline MemoryProfile::Subsystem::Subsystem(const char* name)
+    : active_(MemoryProfile::instance().enabled()), outer_(0)
+  {
+    if (!active_)
+      return;
+    outer_ = currentSlot();
+    currentSlot() = slotOf(name);
+  }
+  //----< go back to the subsystem this thread worked for before >-----
+
+  inline MemoryProfile::Subsystem::~Subsystem()
+  {
+    if (active_)
+      currentSlot() = outer_;
+  }
+  //----< start counting a phase, if profiling is enabled >------------
+  /*
+  *  A phase named "" counts nothing.
+  */
+  inline MemoryProfile::Phase::Phase(const std::string& name)
+    : active_(MemoryProfile::instance().enabled() && name != "")
+  {
+    if (!active_)
+      return;
+    name_ = name;
+    Counters& c = counters();
+    start_ = c.total.usage();
+    outerPeak_ = c.phasePeak.exchange(start_.live);
+  }
+  //----< add the phase's counts to its record >-----------------------
+  /*
+  *  The outer phase's peak becomes the higher of its own and this one's.
+  */
+  inline MemoryProfile::Phase::~Phase()
+  {
+    if (!active_)
+      return;
+    Counters& c = counters();
+    Usage now = c.total.usage();
+    long long peak = c.phasePeak.exchange(outerPeak_);
+    raise(c.phasePeak, peak);
+    MemoryProfile& profile = MemoryProfile::instance();
+    std::lock_guard<std::mutex> lock(profile.mtx_);
+    auto iter = profile.phases_.begin();
+    for (; iter != profile.phases_.end() && iter->name != name_; ++iter)
+      ;
+    if (iter == profile.phases_.end())
+    {
+      profile.phases_.push_back(PhaseRecord());
+      iter = profile.phases_.end() - 1;
+      iter->name = name_;
+    }
+    ++iter->calls;
+    iter->usage.allocated += now.allocated - start_.allocated;
+    iter->usage.allocations += now.allocations - start_.allocations;
+    iter->usage.freed += now.freed - start_.freed;
+    iter->usage.frees += now.frees - start_.frees;
+    iter->usage.live += now.live - start_.live;
+    iter->usage.peak = (std::max)(iter->usage.peak, peak);
+  }
+}
+#endif
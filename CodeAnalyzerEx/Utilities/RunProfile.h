@@ -0,0 +1,455 @@
+#ifndef RUNPROFILE_H
+#define RUNPROFILE_H
+///////////////////////////////////////////////////////////////////////
+// RunProfile.h - phase timers and per file counters for one run     //
+// ver 1.3                                                           //
+// Language:    C++, Visual Studio 2015                              //
+// Platform:    Dell XPS 8900, Windows 10                            //
+// Application: Most Projects, CSE687 - Object Oriented Design       //
+// Author:      Jim Fawcett, Syracuse University, CST 4-187          //
+//              jfawcett@twcny.rr.com                                //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides class RunProfile, one per process, which
+* collects:
+* - wall clock time of named phases, e.g., scan, parse, publish, each
+*   in the order the phase first ran, with the number of times it ran
+* - per file counters: bytes, tokens, SemiExps, AST nodes, and html
+*   bytes written, plus wall clock time of named per file timers
+* - per parser rule tests, skips, matches, and test time, summed over
+*   every parser that reports them, so rule hit rates are seen with
+*   the phases they cost
+* and writes them as a JSON or CSV report.
+*
+* RunProfile::Scope is a scoped timer.  A Scope made while profiling
+* is disabled does nothing, not even read the clock, so instrumented
+* code costs a test of one flag when nobody is looking.  While Trace
+* is enabled a Scope also records a span, named by its phase or timer,
+* with its file as the span's detail.  While MemoryProfile is enabled
+* a phase Scope also counts the phase's allocations.
+*
+* All functions are thread safe, so parse workers may count and time
+* files concurrently.  Callers should name files by full file spec so
+* counts made by different packages land in the same record.
+*
+* Public Interface:
+* -----------------
+* RunProfile& prof = RunProfile::instance();
+* prof.enable();
+* prof.live([](const std::string& line) { std::cout << line; });
+* {
+*   RunProfile::Scope phase("parse");             // phase timer
+*   RunProfile::Scope perFile("parse", file);     // per file timer
+*   prof.count(file, RunProfile::Tokens, n);
+* }
+* prof.rule("CppExecutable", tests, skips, matches, ms);
+* prof.writeJson("profile.json");
+* prof.writeCsv("profile.csv");
+*
+* Build Process:
+* --------------
+* Required Files: RunProfile.h, Trace.h, MemoryProfile.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.3 : 14 Oct 2026
+* - added rule records, written after the files in both reports
+* ver 1.2 : 14 Oct 2026
+* - a phase Scope counts the phase's allocations in MemoryProfile
+* ver 1.1 : 14 Oct 2026
+* - Scope records a Trace span while tracing is enabled, even with
+*   profiling disabled
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <chrono>
+#include <functional>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include "Trace.h"
+#include "MemoryProfile.h"
+
+namespace Utilities
+{
+  class RunProfile
+  {
+  public:
+    enum Counter { Bytes, Tokens, SemiExps, AstNodes, HtmlBytes, NumCounters };
+    using Sink = std::function<void(const std::string&)>;
+
+    struct PhaseRecord
+    {
+      std::string name;
+      double millis = 0.0;
+      size_t calls = 0;
+    };
+    struct FileRecord
+    {
+      size_t counts[NumCounters] = {};
+      std::map<std::string, double> millis;
+    };
+    struct RuleRecord
+    {
+      std::string name;
+      size_t tests = 0;
+      size_t skips = 0;
+      size_t matches = 0;
+      double millis = 0.0;
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // Scope times its lifetime into a phase, or into a file's timer
+
+    class Scope
+    {
+    public:
+      Scope(const std::string& phase);
+      Scope(const std::string& timer, const std::string& file);
+      Scope(const Scope&) = delete;
+      Scope& operator=(const Scope&) = delete;
+      ~Scope();
+    private:
+      using Clock = std::chrono::steady_clock;
+      bool active_;
+      bool traced_;
+      std::string name_;
+      std::string file_;
+      Clock::time_point start_;
+      MemoryProfile::Phase memory_;
+    };
+
+    static RunProfile& instance();
+    void enable(bool doEnable = true) { enabled_ = doEnable; }
+    bool enabled() const { return enabled_; }
+    void live(Sink sink);
+    void count(const std::string& file, Counter counter, size_t n);
+    void time(const std::string& phase, double millis);
+    void time(const std::string& timer, const std::string& file, double millis);
+    void rule(const std::string& rule, size_t tests, size_t skips, size_t matches, double millis);
+    std::vector<PhaseRecord> phases();
+    std::map<std::string, FileRecord> files();
+    std::vector<RuleRecord> rules();
+    void clear();
+    bool writeJson(const std::string& fileSpec);
+    bool writeCsv(const std::string& fileSpec);
+    static const char* counterName(Counter counter);
+  private:
+    RunProfile() {}
+    std::vector<std::string> timerNames();
+    static std::string jsonString(const std::string& src);
+    static std::string csvString(const std::string& src);
+    bool enabled_ = false;
+    Sink sink_;
+    std::mutex mtx_;
+    std::vector<PhaseRecord> phases_;
+    std::map<std::string, FileRecord> files_;
+    std::vector<RuleRecord> rules_;
+  };
+
+  //----< the process's one profile >----------------------------------
+
+  inline RunProfile& RunProfile::instance()
+  {
+    static RunProfile profile;
+    return profile;
+  }
+  //----< name used for counter in reports >---------------------------
+
+  inline const char* RunProfile::counterName(Counter counter)
+  {
+    static const char* names[NumCounters] = {
+      "bytes", "tokens", "semiExps", "astNodes", "htmlBytes"
+    };
+    return counter < NumCounters ? names[counter] : "";
+  }
+  //----< send a line to sink each time a phase ends >-----------------
+
+  inline void RunProfile::live(Sink sink)
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    sink_ = sink;
+  }
+  //----< add n to one of file's counters >----------------------------
+
+  inline void RunProfile::count(const std::string& file, Counter counter, size_t n)
+  {
+    if (!enabled_ || counter >= NumCounters)
+      return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    files_[file].counts[counter] += n;
+  }
+  //----< add a run of phase, phases are kept in order of first run >--
+
+  inline void RunProfile::time(const std::string& phase, double millis)
+  {
+    if (!enabled_)
+      return;
+    Sink sink;
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      size_t i = 0;
+      while (i < phases_.size() && phases_[i].name != phase)
+        ++i;
+      if (i == phases_.size())
+      {
+        phases_.push_back(PhaseRecord());
+        phases_.back().name = phase;
+      }
+      phases_[i].millis += millis;
+      ++phases_[i].calls;
+      sink = sink_;
+    }
+    if (sink)
+    {
+      std::ostringstream out;
+      out << "\n  phase " << phase << ": " << std::fixed << std::setprecision(3) << millis << " ms";
+      sink(out.str());
+    }
+  }
+  //----< add time to one of file's timers >---------------------------
+
+  inline void RunProfile::time(const std::string& timer, const std::string& file, double millis)
+  {
+    if (!enabled_)
+      return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    files_[file].millis[timer] += millis;
+  }
+  //----< add a parser's counts for rule, rules are kept in order of first report >--
+
+  inline void RunProfile::rule(const std::string& rule, size_t tests, size_t skips, size_t matches, double millis)
+  {
+    if (!enabled_)
+      return;
+    std::lock_guard<std::mutex> lock(mtx_);
+    size_t i = 0;
+    while (i < rules_.size() && rules_[i].name != rule)
+      ++i;
+    if (i == rules_.size())
+    {
+      rules_.push_back(RuleRecord());
+      rules_.back().name = rule;
+    }
+    rules_[i].tests += tests;
+    rules_[i].skips += skips;
+    rules_[i].matches += matches;
+    rules_[i].millis += millis;
+  }
+  //----< copies, so callers don't hold the lock >---------------------
+
+  inline std::vector<RunProfile::PhaseRecord> RunProfile::phases()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return phases_;
+  }
+
+  inline std::map<std::string, RunProfile::FileRecord> RunProfile::files()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return files_;
+  }
+
+  inline std::vector<RunProfile::RuleRecord> RunProfile::rules()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    return rules_;
+  }
+  //----< discard everything recorded so far >-------------------------
+
+  inline void RunProfile::clear()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    phases_.clear();
+    files_.clear();
+    rules_.clear();
+  }
+  //----< names of every per file timer, sorted >----------------------
+
+  inline std::vector<std::string> RunProfile::timerNames()
+  {
+    std::map<std::string, bool> names;
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& item : files_)
+    {
+      for (auto& timer : item.second.millis)
+        names[timer.first] = true;
+    }
+    std::vector<std::string> result;
+    for (auto& name : names)
+      result.push_back(name.first);
+    return result;
+  }
+  //----< quote and escape src for JSON >------------------------------
+
+  inline std::string RunProfile::jsonString(const std::string& src)
+  {
+    std::string out = "\"";
+    for (char ch : src)
+    {
+      switch (ch)
+      {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\t': out += "\\t"; break;
+      default:   out += ch;
+      }
+    }
+    return out + "\"";
+  }
+  //----< quote src for CSV if it holds a separator or quote >---------
+
+  inline std::string RunProfile::csvString(const std::string& src)
+  {
+    if (src.find_first_of(",\"\n") == std::string::npos)
+      return src;
+    std::string out = "\"";
+    for (char ch : src)
+    {
+      if (ch == '"')
+        out += '"';
+      out += ch;
+    }
+    return out + "\"";
+  }
+  //----< write phases and files as one JSON object >------------------
+  /*
+  *  { "phases": [ { "name", "ms", "calls" }, ... ],
+  *    "files":  [ { "file", counters..., "ms": { timer: ms, ... } }, ... ],
+  *    "rules":  [ { "rule", "tests", "skips", "matches", "hitRate", "ms" }, ... ] }
+  *  - hitRate is matches per test, 0 for rules never tested
+  */
+  inline bool RunProfile::writeJson(const std::string& fileSpec)
+  {
+    std::vector<PhaseRecord> phaseList = phases();
+    std::map<std::string, FileRecord> fileList = files();
+    std::vector<RuleRecord> ruleList = rules();
+    std::ofstream out(fileSpec);
+    if (!out.good())
+      return false;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"phases\": [";
+    for (size_t i = 0; i < phaseList.size(); ++i)
+    {
+      out << (i == 0 ? "\n" : ",\n") << "    { \"name\": " << jsonString(phaseList[i].name);
+      out << ", \"ms\": " << phaseList[i].millis << ", \"calls\": " << phaseList[i].calls << " }";
+    }
+    out << "\n  ],\n  \"files\": [";
+    bool first = true;
+    for (auto& item : fileList)
+    {
+      out << (first ? "\n" : ",\n") << "    { \"file\": " << jsonString(item.first);
+      first = false;
+      for (int c = 0; c < NumCounters; ++c)
+        out << ", \"" << counterName(Counter(c)) << "\": " << item.second.counts[c];
+      out << ", \"ms\": {";
+      bool firstTimer = true;
+      for (auto& timer : item.second.millis)
+      {
+        out << (firstTimer ? " " : ", ") << jsonString(timer.first) << ": " << timer.second;
+        firstTimer = false;
+      }
+      out << " } }";
+    }
+    out << "\n  ],\n  \"rules\": [";
+    for (size_t i = 0; i < ruleList.size(); ++i)
+    {
+      const RuleRecord& rule = ruleList[i];
+      out << (i == 0 ? "\n" : ",\n") << "    { \"rule\": " << jsonString(rule.name);
+      out << ", \"tests\": " << rule.tests << ", \"skips\": " << rule.skips << ", \"matches\": " << rule.matches;
+      out << ", \"hitRate\": " << (rule.tests > 0 ? double(rule.matches) / rule.tests : 0.0) << ", \"ms\": " << rule.millis << " }";
+    }
+    out << "\n  ]\n}\n";
+    return out.good();
+  }
+  //----< write phase, file, and rule tables, with a blank line between >--
+  /*
+  *  The file table has one column for each counter and one for each
+  *  per file timer any file used, e.g., "parse ms".
+  */
+  inline bool RunProfile::writeCsv(const std::string& fileSpec)
+  {
+    std::vector<std::string> timers = timerNames();
+    std::vector<PhaseRecord> phaseList = phases();
+    std::map<std::string, FileRecord> fileList = files();
+    std::vector<RuleRecord> ruleList = rules();
+    std::ofstream out(fileSpec);
+    if (!out.good())
+      return false;
+    out << std::fixed << std::setprecision(3);
+    out << "phase,ms,calls\n";
+    for (auto& phase : phaseList)
+      out << csvString(phase.name) << "," << phase.millis << "," << phase.calls << "\n";
+    out << "\nfile";
+    for (int c = 0; c < NumCounters; ++c)
+      out << "," << counterName(Counter(c));
+    for (auto& timer : timers)
+      out << "," << csvString(timer + " ms");
+    out << "\n";
+    for (auto& item : fileList)
+    {
+      out << csvString(item.first);
+      for (int c = 0; c < NumCounters; ++c)
+        out << "," << item.second.counts[c];
+      for (auto& timer : timers)
+      {
+        auto iter = item.second.millis.find(timer);
+        out << "," << (iter != item.second.millis.end() ? iter->second : 0.0);
+      }
+      out << "\n";
+    }
+    out << "\nrule,tests,skips,matches,hit rate,ms\n";
+    for (auto& rule : ruleList)
+    {
+      out << csvString(rule.name) << "," << rule.tests << "," << rule.skips << "," << rule.matches << ","
+        << (rule.tests > 0 ? double(rule.matches) / rule.tests : 0.0) << "," << rule.millis << "\n";
+    }
+    return out.good();
+  }
+  //----< start timing a phase, if profiling is enabled >--------------
+
+  inline RunProfile::Scope::Scope(const std::string& phase)
+    : active_(RunProfile::instance().enabled()), traced_(Trace::instance().enabled()), memory_(phase)
+  {
+    if (!active_ && !traced_)
+      return;
+    name_ = phase;
+    start_ = Clock::now();
+  }
+  //----< start timing one file, if profiling is enabled >-------------
+
+  inline RunProfile::Scope::Scope(const std::string& timer, const std::string& file)
+    : active_(RunProfile::instance().enabled()), traced_(Trace::instance().enabled()), memory_("")
+  {
+    if (!active_ && !traced_)
+      return;
+    name_ = timer;
+    file_ = file;
+    start_ = Clock::now();
+  }
+  //----< record elapsed time >----------------------------------------
+
+  inline RunProfile::Scope::~Scope()
+  {
+    if (!active_ && !traced_)
+      return;
+    Clock::time_point end = Clock::now();
+    if (traced_)
+      Trace::instance().record(file_.empty() ? "phase" : "file", name_, start_, end, file_);
+    if (!active_)
+      return;
+    double millis = std::chrono::duration<double, std::milli>(end - start_).count();
+    if (file_.empty())
+      RunProfile::instance().time(name_, millis);
+    else
+      RunProfile::instance().time(name_, file_, millis);
+  }
+}
+#endif
@@ -0,0 +1,293 @@
+#ifndef TRACE_H
+#define TRACE_H
+///////////////////////////////////////////////////////////////////////
+// Trace.h - spans of work on every thread, as a Chrome trace        //
+// ver 1.0                                                           //
+// Language:    C++, Visual Studio 2015                              //
+// Platform:    Dell XPS 8900, Windows 10                            //
+// Application: Most Projects, CSE687 - Object Oriented Design       //
+// Author:      Jim Fawcett, Syracuse University, CST 4-187          //
+//              jfawcett@twcny.rr.com                                //
+///////////////////////////////////////////////////////////////////////
+/*
+* Package Operations:
+* -------------------
+* This package provides class Trace, one per process, which records
+* spans, a name, a category, an optional detail such as a file name,
+* and the thread, start and length of a piece of work, e.g., parsing
+* a file, rendering a page, a socket recv, or a wait on a queue, and
+* writes them as Chrome trace JSON, which chrome://tracing and
+* Perfetto show as one timeline row per thread.
+*
+* Each thread appends to a buffer of its own, found through a
+* thread_local pointer, so spans on different threads never contend
+* for a lock; a buffer's lock is only shared with writeChromeJson.
+* Buffers live as long as the process, so spans of threads that have
+* ended are still written.  A thread keeps at most MaxEvents spans,
+* later ones are counted as dropped.
+*
+* Trace::Span is a scoped span, named by string literals.  A Span made
+* while tracing is disabled does nothing, not even read the clock, so
+* traced code costs a test of one flag when nobody is looking.
+* RunProfile::Scope also records a span, so every profiled phase and
+* per file timer is traced.
+*
+* Times are steady_clock ticks since its epoch, which on Windows is
+* QueryPerformanceCounter's, shared by every process on the machine,
+* so traces written by the analyzer and by MsgServer line up when
+* loaded together.
+*
+* Public Interface:
+* -----------------
+* Trace& trace = Trace::instance();
+* trace.enable();
+* trace.nameThread("parser");
+* {
+*   Trace::Span span("parse", "parse file", file);   // category, name, detail
+* }
+* trace.record("queue", "render queue wait", start, Trace::Clock::now());
+* trace.writeChromeJson("trace.json", "CodeAnalyzer", 1);
+*
+* Build Process:
+* --------------
+* Required Files: Trace.h
+*
+* Maintenance History:
+* --------------------
+* ver 1.0 : 14 Oct 2026
+* - first release
+*/
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <iomanip>
+
+namespace Utilities
+{
+  class Trace
+  {
+  public:
+    using Clock = std::chrono::steady_clock;
+    static const size_t MaxEvents = 1 << 20;   // spans kept per thread
+
+    struct Event
+    {
+      const char* category;   // a string literal, e.g., "comm"
+      std::string name;
+      std::string detail;
+      Clock::time_point start;
+      Clock::duration length;
+    };
+
+    /////////////////////////////////////////////////////////////////
+    // Span records its lifetime on the thread that made it
+
+    class Span
+    {
+    public:
+      Span(const char* category, const char* name, const std::string& detail = std::string());
+      Span(const Span&) = delete;
+      Span& operator=(const Span&) = delete;
+      ~Span();
+    private:
+      bool active_;
+      const char* category_;
+      const char* name_;
+      std::string detail_;
+      Clock::time_point start_;
+    };
+
+    static Trace& instance();
+    void enable(bool doEnable = true) { enabled_ = doEnable; }
+    bool enabled() const { return enabled_; }
+    void record(const char* category, const std::string& name, Clock::time_point start, Clock::time_point end,
+      const std::string& detail = "");
+    void nameThread(const std::string& name);
+    size_t dropped();
+    void clear();
+    bool writeChromeJson(const std::string& fileSpec, const std::string& process = "", size_t pid = 1);
+  private:
+    struct Buffer
+    {
+      size_t tid = 0;
+      std::string threadName;
+      std::vector<Event> events;
+      size_t dropped = 0;
+      std::mutex mtx;
+    };
+    Trace() : enabled_(false) {}
+    Buffer& buffer();
+    static std::string jsonString(const std::string& src);
+    static double micros(Clock::time_point time);
+    std::atomic<bool> enabled_;
+    std::mutex mtx_;
+    std::vector<std::unique_ptr<Buffer>> buffers_;
+  };
+
+  //----< the process's one trace >------------------------------------
+
+  inline Trace& Trace::instance()
+  {
+    static Trace trace;
+    return trace;
+  }
+  //----< this thread's buffer, made on its first span >---------------
+
+  inline Trace::Buffer& Trace::buffer()
+  {
+    static thread_local Buffer* pBuffer = nullptr;
+    if (pBuffer == nullptr)
+    {
+      std::lock_guard<std::mutex> lock(mtx_);
+      buffers_.push_back(std::unique_ptr<Buffer>(new Buffer));
+      pBuffer = buffers_.back().get();
+      pBuffer->tid = buffers_.size();
+    }
+    return *pBuffer;
+  }
+  //----< add a span of this thread from start to end >----------------
+
+  inline void Trace::record(const char* category, const std::string& name, Clock::time_point start, Clock::time_point end,
+    const std::string& detail)
+  {
+    if (!enabled_)
+      return;
+    Buffer& buf = buffer();
+    std::lock_guard<std::mutex> lock(buf.mtx);
+    if (buf.events.size() >= MaxEvents)
+    {
+      ++buf.dropped;
+      return;
+    }
+    Event event = { category, name, detail, start, end - start };
+    buf.events.push_back(std::move(event));
+  }
+  //----< name the calling thread's row in the trace >-----------------
+
+  inline void Trace::nameThread(const std::string& name)
+  {
+    if (!enabled_)
+      return;
+    Buffer& buf = buffer();
+    std::lock_guard<std::mutex> lock(buf.mtx);
+    buf.threadName = name;
+  }
+  //----< spans not kept because a thread's buffer was full >----------
+
+  inline size_t Trace::dropped()
+  {
+    size_t count = 0;
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& pBuf : buffers_)
+    {
+      std::lock_guard<std::mutex> bufLock(pBuf->mtx);
+      count += pBuf->dropped;
+    }
+    return count;
+  }
+  //----< discard every span, buffers stay with their threads >--------
+
+  inline void Trace::clear()
+  {
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& pBuf : buffers_)
+    {
+      std::lock_guard<std::mutex> bufLock(pBuf->mtx);
+      pBuf->events.clear();
+      pBuf->dropped = 0;
+    }
+  }
+  //----< quote and escape src for JSON >------------------------------
+
+  inline std::string Trace::jsonString(const std::string& src)
+  {
+    std::string out = "\"";
+    for (char ch : src)
+    {
+      switch (ch)
+      {
+      case '"':  out += "\\\""; break;
+      case '\\': out += "\\\\"; break;
+      case '\n': out += "\\n"; break;
+      case '\r': out += "\\r"; break;
+      case '\t': out += "\\t"; break;
+      default:   out += ch;
+      }
+    }
+    return out + "\"";
+  }
+  //----< microseconds since the clock's epoch >-----------------------
+
+  inline double Trace::micros(Clock::time_point time)
+  {
+    return std::chrono::duration<double, std::micro>(time.time_since_epoch()).count();
+  }
+  //----< write every thread's spans as Chrome trace JSON >------------
+  /*
+  *  { "traceEvents": [ { "name", "cat", "ph": "X", "ts", "dur", "pid", "tid",
+  *                       "args": { "detail" } }, ... ], "displayTimeUnit": "ms" }
+  *  with "M" events naming the process and each named thread
+  */
+  inline bool Trace::writeChromeJson(const std::string& fileSpec, const std::string& process, size_t pid)
+  {
+    std::ofstream out(fileSpec);
+    if (!out.good())
+      return false;
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"traceEvents\": [";
+    bool first = true;
+    auto separate = [&out, &first]() { out << (first ? "\n" : ",\n"); first = false; };
+    if (process != "")
+    {
+      separate();
+      out << "    { \"name\": \"process_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": 0, \"args\": { \"name\": "
+        << jsonString(process) << " } }";
+    }
+    std::lock_guard<std::mutex> lock(mtx_);
+    for (auto& pBuf : buffers_)
+    {
+      std::lock_guard<std::mutex> bufLock(pBuf->mtx);
+      if (pBuf->threadName != "")
+      {
+        separate();
+        out << "    { \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": " << pid << ", \"tid\": " << pBuf->tid
+          << ", \"args\": { \"name\": " << jsonString(pBuf->threadName) << " } }";
+      }
+      for (auto& event : pBuf->events)
+      {
+        separate();
+        out << "    { \"name\": " << jsonString(event.name) << ", \"cat\": " << jsonString(event.category)
+          << ", \"ph\": \"X\", \"ts\": " << micros(event.start)
+          << ", \"dur\": " << std::chrono::duration<double, std::micro>(event.length).count()
+          << ", \"pid\": " << pid << ", \"tid\": " << pBuf->tid;
+        if (event.detail != "")
+          out << ", \"args\": { \"detail\": " << jsonString(event.detail) << " }";
+        out << " }";
+      }
+    }
+    out << "\n  ],\n  \"displayTimeUnit\": \"ms\"\n}\n";
+    return out.good();
+  }
+  //----< start a span, if tracing is enabled >------------------------
+
+  inline Trace::Span::Span(const char* category, const char* name, const std::string& detail)
+    : active_(Trace::instance().enabled()), category_(category), name_(name)
+  {
+    if (!active_)
+      return;
+    detail_ = detail;
+    start_ = Clock::now();
+  }
+  //----< record the span on this thread >-----------------------------
+
+  inline Trace::Span::~Span()
+  {
+    if (active_)
+      Trace::instance().record(category_, name_, start_, Clock::now(), detail_);
+  }
+}
+#endif
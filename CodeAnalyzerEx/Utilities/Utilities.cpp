@@ -1,6 +1,6 @@
 ///////////////////////////////////////////////////////////////////////
 // Utilities.cpp - small, generally usefule, helper classes          //
-// ver 1.4                                                           //
+// ver 1.6                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Platform:    Dell XPS 8900, Windows 10                            //
 // Application: Most Projects, CSE687 - Object Oriented Design       //
@@ -72,25 +72,8 @@ void StringHelper::sTitle(std::string src, size_t offset, size_t width, std::ost
 std::vector<std::string> StringHelper::split(const std::string& src)
 {
   std::vector<std::string> accum;
-  std::string temp;
-  std::locale loc;
-  size_t index = 0;
-  do
-  {
-    while ((isspace(src[index], loc) || src[index] == ',') && src[index] != '\n')
-    {
-      ++index;
-      if (temp.size() > 0)
-      {
-        accum.push_back(temp);
-        temp.clear();
-      }
-    }
-    if(src[index] != '\0')
-      temp += src[index];
-  } while (index++ < src.size());
-  if(temp.size() > 0)
-    accum.push_back(temp);
+  for (StringView token : splitView(src))
+    accum.push_back(token.str());
   return accum;
 }
 
@@ -98,26 +81,7 @@ std::vector<std::string> StringHelper::split(const std::string& src)
 
 std::string StringHelper::trim(const std::string& src)
 {
-	std::locale loc;
-	std::string trimmed = src;
-	size_t first = 0;
-	while (true)
-	{
-		if (std::isspace(trimmed[first], loc))
-			++first;
-		else
-			break;
-	}
-	size_t last = trimmed.size() - 1;
-	while (true)
-	{
-		if (std::isspace(trimmed[last], loc) && last > 0)
-			--last;
-		else
-			break;
-
-	}
-	return trimmed.substr(first, last - first + 1);
+  return trimView(src).str();
 }
 
 void Utilities::putline()
@@ -152,6 +116,14 @@ int main()
   }
   std::cout << "\n";
 
+  Utils::title("test StringHelper::tokenize and trimView, no allocations");
+
+  std::string fields = "  name : value ;; next:  ;last  ";
+  for (StringView field : StringHelper::tokenize(fields, ";"))
+    std::cout << "\n  \"" << StringHelper::trimView(field).str() << "\"";
+  std::cout << "\n  trim(\"   \") = \"" << StringHelper::trim("   ") << "\"";
+  std::cout << "\n";
+
   Utils::title("test std::string Converter<T>::toString(T)");
 
   std::string conv1 = Converter<double>::toString(3.1415927);
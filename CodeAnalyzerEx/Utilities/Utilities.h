@@ -2,7 +2,7 @@
 #define UTILITIES_H
 ///////////////////////////////////////////////////////////////////////
 // Utilities.h - small, generally useful, helper classes             //
-// ver 1.4                                                           //
+// ver 1.6                                                           //
 // Language:    C++, Visual Studio 2015                              //
 // Platform:    Dell XPS 8900, Windows 10                            //
 // Application: Most Projects, CSE687 - Object Oriented Design       //
@@ -16,6 +16,20 @@
 * function putline().  This class will be extended continuously for 
 * awhile to provide convenience functions for general C++ applications.
 *
+* Converter<T> converts integers, e.g., content-length values, with its
+* own decimal code, no stream, locale, or heap buffer, and reads them as
+* operator>> would: leading white space and a sign are skipped, reading
+* stops at the first non-digit, 0 if there are no digits, and the
+* largest or smallest value if the number is too big.  Other types use
+* string streams.
+*
+* StringView refers to chars held elsewhere, as C++17's std::string_view
+* does, which Visual Studio 2015 doesn't have.  splitView, tokenize, and
+* trimView return views into their argument instead of new strings, and
+* Tokens finds each token as it is iterated, so nothing is allocated
+* unless the caller keeps a token with str().  split and trim are built
+* on them.
+*
 * Build Process:
 * --------------
 * Required Files: Utilities.h, Utilities.cpp
@@ -24,6 +38,13 @@
 *
 * Maintenance History:
 * --------------------
+* ver 1.6 : 14 Oct 2026
+* - added StringView, Tokens, and StringHelper::splitView, tokenize, and
+*   trimView, which don't allocate
+* - split and trim use them, trim of an empty string returns ""
+* ver 1.5 : 14 Oct 2026
+* - Converter<T> converts integer types without string streams
+* - added Converter<T>::toValue(const char*, size_t)
 * ver 1.4 : 26 Feb 2017
 * - changed StringHelper::split to use isspace from <locale> instead of <cctype>
 * ver 1.3 : 12 Aug 2016
@@ -48,6 +69,10 @@
 #include <sstream>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <type_traits>
+#include <iterator>
+#include <cstring>
 namespace Utilities
 {
   class test
@@ -55,6 +80,90 @@ namespace Utilities
   public:
   };
 
+  /////////////////////////////////////////////////////////////////////
+  // StringView refers to size chars it doesn't own
+  // - the chars must outlive the view, e.g., a view of a temporary
+  //   string is only good until the end of the full expression
+
+  class StringView
+  {
+  public:
+    static const size_t npos = static_cast<size_t>(-1);
+    StringView() {}
+    StringView(const char* pText) : pText_(pText), size_(std::strlen(pText)) {}
+    StringView(const char* pText, size_t size) : pText_(pText), size_(size) {}
+    StringView(const std::string& text) : pText_(text.data()), size_(text.size()) {}
+    const char* data() const { return pText_; }
+    size_t size() const { return size_; }
+    bool empty() const { return size_ == 0; }
+    const char* begin() const { return pText_; }
+    const char* end() const { return pText_ + size_; }
+    char operator[](size_t pos) const { return pText_[pos]; }
+    std::string str() const { return std::string(pText_, size_); }
+    StringView substr(size_t pos, size_t count = npos) const
+    {
+      if (pos > size_)
+        pos = size_;
+      return StringView(pText_ + pos, (count < size_ - pos) ? count : size_ - pos);
+    }
+    size_t find(char ch, size_t pos = 0) const
+    {
+      for (; pos < size_; ++pos)
+      {
+        if (pText_[pos] == ch)
+          return pos;
+      }
+      return npos;
+    }
+    bool operator==(StringView other) const
+    {
+      return size_ == other.size_ && (size_ == 0 || std::memcmp(pText_, other.pText_, size_) == 0);
+    }
+    bool operator!=(StringView other) const { return !(*this == other); }
+  private:
+    const char* pText_ = "";
+    size_t size_ = 0;
+  };
+
+  /////////////////////////////////////////////////////////////////////
+  // Tokens is a lazy range of the non-empty pieces of src between
+  // separator chars, each found as the range is iterated
+  // - iterators refer to their Tokens, which must outlive them
+
+  class Tokens
+  {
+  public:
+    class iterator
+    {
+    public:
+      using iterator_category = std::forward_iterator_tag;
+      using value_type = StringView;
+      using difference_type = std::ptrdiff_t;
+      using pointer = const StringView*;
+      using reference = const StringView&;
+
+      iterator(const Tokens* pTokens, const char* pos) : pTokens_(pTokens) { next(pos); }
+      const StringView& operator*() const { return token_; }
+      const StringView* operator->() const { return &token_; }
+      iterator& operator++() { next(token_.end()); return *this; }
+      iterator operator++(int) { iterator prior = *this; next(token_.end()); return prior; }
+      bool operator==(const iterator& other) const { return token_.data() == other.token_.data(); }
+      bool operator!=(const iterator& other) const { return !(*this == other); }
+    private:
+      void next(const char* pos);
+      const Tokens* pTokens_;
+      StringView token_;
+    };
+
+    Tokens(StringView src, StringView separators);
+    iterator begin() const { return iterator(this, src_.begin()); }
+    iterator end() const { return iterator(this, src_.end()); }
+    bool isSeparator(char ch) const { return separators_[(unsigned char)ch]; }
+  private:
+    StringView src_;
+    bool separators_[256];
+  };
+
   class StringHelper
   {
   public:
@@ -64,6 +173,9 @@ namespace Utilities
     static void title(std::string src, std::ostream& out = std::cout);
     static void title(std::string src, std::ostringstream& out);
 	static std::string trim(const std::string& src);
+    static Tokens splitView(StringView src);                         // split's tokens, as views
+    static Tokens tokenize(StringView src, StringView separators);   // pieces between any of separators
+    static StringView trimView(StringView src);                      // src without leading and trailing white space
     static void sTitle(
       std::string src, size_t offset, size_t width, std::ostream& out = std::cout, char underline = '-'
     );
@@ -72,31 +184,170 @@ namespace Utilities
     );
   };
 
+  //----< mark each separator char >-----------------------------------
+
+  inline Tokens::Tokens(StringView src, StringView separators) : src_(src)
+  {
+    std::memset(separators_, 0, sizeof(separators_));
+    for (char ch : separators)
+      separators_[(unsigned char)ch] = true;
+  }
+  //----< find the first token at or after pos, end if none >----------
+
+  inline void Tokens::iterator::next(const char* pos)
+  {
+    const char* pEnd = pTokens_->src_.end();
+    while (pos < pEnd && pTokens_->isSeparator(*pos))
+      ++pos;
+    const char* pLast = pos;
+    while (pLast < pEnd && !pTokens_->isSeparator(*pLast))
+      ++pLast;
+    token_ = StringView(pos, pLast - pos);
+  }
+  //----< tokens separated by white space or commas, newlines kept >---
+  /*
+   *  - newline is a token, e.g., "a, \n, bc" gives "a", "\n", and "bc",
+   *    and nulls separate, as split drops them
+   */
+  inline Tokens StringHelper::splitView(StringView src)
+  {
+    return Tokens(src, StringView(" \t\v\f\r,\0", 7));
+  }
+
+  inline Tokens StringHelper::tokenize(StringView src, StringView separators)
+  {
+    return Tokens(src, separators);
+  }
+  //----< view of src without leading and trailing white space >-------
+  /*
+   *  - white space as isspace in the "C" locale
+   */
+  inline StringView StringHelper::trimView(StringView src)
+  {
+    auto isWhiteSpace = [](char ch) { return ch == ' ' || ('\t' <= ch && ch <= '\r'); };
+    const char* pFirst = src.begin();
+    const char* pLast = src.end();
+    while (pFirst < pLast && isWhiteSpace(*pFirst))
+      ++pFirst;
+    while (pLast > pFirst && isWhiteSpace(pLast[-1]))
+      --pLast;
+    return StringView(pFirst, pLast - pFirst);
+  }
+
   void putline();
 
+  // integer types Converter handles without streams, char types are
+  // still read and written as characters
+
+  template <typename T> struct IsFastNumber : std::false_type {};
+  template <> struct IsFastNumber<short> : std::true_type {};
+  template <> struct IsFastNumber<unsigned short> : std::true_type {};
+  template <> struct IsFastNumber<int> : std::true_type {};
+  template <> struct IsFastNumber<unsigned int> : std::true_type {};
+  template <> struct IsFastNumber<long> : std::true_type {};
+  template <> struct IsFastNumber<unsigned long> : std::true_type {};
+  template <> struct IsFastNumber<long long> : std::true_type {};
+  template <> struct IsFastNumber<unsigned long long> : std::true_type {};
+
   template <typename T>
   class Converter
   {
   public:
     static std::string toString(const T& t);
     static T toValue(const std::string& src);
+    static T toValue(const char* pSrc, size_t size);
+  private:
+    static std::string toString(const T& t, std::true_type);
+    static std::string toString(const T& t, std::false_type);
+    static T toValue(const char* pSrc, size_t size, std::true_type);
+    static T toValue(const char* pSrc, size_t size, std::false_type);
   };
 
   template <typename T>
   std::string Converter<T>::toString(const T& t)
+  {
+    return toString(t, IsFastNumber<T>());
+  }
+
+  template <typename T>
+  std::string Converter<T>::toString(const T& t, std::false_type)
   {
     std::ostringstream out;
     out << t;
     return out.str();
   }
 
+  //----< write digits from the back of a local buffer >---------------
+
+  template <typename T>
+  std::string Converter<T>::toString(const T& t, std::true_type)
+  {
+    using U = typename std::make_unsigned<T>::type;
+    char buffer[24];
+    char* pEnd = buffer + sizeof(buffer);
+    char* p = pEnd;
+    bool negative = std::is_signed<T>::value && t < T(0);
+    U value = negative ? U(U(0) - U(t)) : U(t);
+    do
+    {
+      *--p = char('0' + value % 10);
+      value /= 10;
+    } while (value != 0);
+    if (negative)
+      *--p = '-';
+    return std::string(p, pEnd);
+  }
+
   template<typename T>
   T Converter<T>::toValue(const std::string& src)
   {
+    if (IsFastNumber<T>::value)
+      return toValue(src.data(), src.size());
     std::istringstream in(src);
     T t;
     in >> t;
     return t;
   }
+
+  template<typename T>
+  T Converter<T>::toValue(const char* pSrc, size_t size)
+  {
+    return toValue(pSrc, size, IsFastNumber<T>());
+  }
+
+  template<typename T>
+  T Converter<T>::toValue(const char* pSrc, size_t size, std::false_type)
+  {
+    std::istringstream in(std::string(pSrc, size));
+    T t;
+    in >> t;
+    return t;
+  }
+
+  //----< read decimal digits in place, as operator>> would >----------
+
+  template<typename T>
+  T Converter<T>::toValue(const char* pSrc, size_t size, std::true_type)
+  {
+    using U = typename std::make_unsigned<T>::type;
+    const char* p = pSrc;
+    const char* pEnd = pSrc + size;
+    while (p < pEnd && (*p == ' ' || ('\t' <= *p && *p <= '\r')))
+      ++p;
+    bool negative = false;
+    if (p < pEnd && (*p == '+' || *p == '-'))
+      negative = (*p++ == '-');
+    bool lowest = negative && std::is_signed<T>::value;
+    U limit = U(std::numeric_limits<T>::max()) + (lowest ? 1 : 0);
+    U value = 0;
+    for (; p < pEnd && '0' <= *p && *p <= '9'; ++p)
+    {
+      U digit = U(*p - '0');
+      if (value > (limit - digit) / 10)
+        return lowest ? std::numeric_limits<T>::min() : std::numeric_limits<T>::max();
+      value = U(value * 10 + digit);
+    }
+    return static_cast<T>(negative ? U(U(0) - value) : value);
+  }
 }
 #endif